@@ -24,17 +24,42 @@
 #include "ladybug.h"
 #include <cstring>
 #include <sstream>
+#include <string>
 #include <cassert>
 
 using namespace std;
 
 struct GeneralConfiguration
 {
-    // TODO: General application configuration
+    unsigned int realtimePriority; // SCHED_FIFO priority of the grab thread, 0 to disable
+    int grabThreadCpu; // -1 to leave unpinned
+    int writerThreadCpu; // -1 to leave unpinned
+    bool lockMemory;
+    bool numaLocalBuffers;
+    unsigned int latencyCheckMs; // 0 to skip the startup self-check
 
     GeneralConfiguration()
     {
-        // TODO: Initialize as needed
+        realtimePriority = 0;
+        grabThreadCpu = -1;
+        writerThreadCpu = -1;
+        lockMemory = false;
+        numaLocalBuffers = false;
+        latencyCheckMs = 0;
+    }
+
+    std::string ToString()
+    {
+        std::stringstream output;
+        output << "General Configuration" << endl;
+        output << " Realtime priority: " << (realtimePriority > 0 ? std::to_string(realtimePriority) : std::string("Disabled")) << endl;
+        output << " Grab thread CPU: " << (grabThreadCpu >= 0 ? std::to_string(grabThreadCpu) : std::string("Any")) << endl;
+        output << " Writer thread CPU: " << (writerThreadCpu >= 0 ? std::to_string(writerThreadCpu) : std::string("Any")) << endl;
+        output << " Lock memory: " << (lockMemory ? "Yes" : "No") << endl;
+        output << " NUMA-local buffers: " << (numaLocalBuffers ? "Yes" : "No") << endl;
+        output << " Latency check (ms): " << latencyCheckMs << endl;
+
+        return output.str();
     }
 };
 
@@ -47,6 +72,20 @@ struct CameraConfiguration
 	bool isJpegQualityAuto;
 	unsigned int jpegBufferPercentage; // Range from 0 - 127
 
+    // Closed-loop control of JPEG quality and frame rate from the measured
+    // write throughput. The configured quality and frame rate are the upper
+    // bounds, the values below are the lower bounds.
+    bool useAdaptiveQuality;
+    unsigned int minJpegQualityPercentage;
+    float minFrameRate;
+
+    // Image buffers passed to ladybugInitializePlus(). 0 uses the SDK
+    // default. With auto tuning, a count stored by an earlier run for this
+    // host and camera model takes precedence.
+    unsigned int numberOfBuffers;
+    bool autoTuneBuffers;
+    unsigned int bufferTuningSeconds;
+
     // TODO: Trigger configuration?
 
     CameraConfiguration()
@@ -57,11 +96,24 @@ struct CameraConfiguration
         jpegQualityPercentage = 80;
 	    isJpegQualityAuto = true;
 	    jpegBufferPercentage = 110;
+        useAdaptiveQuality = false;
+        minJpegQualityPercentage = 50;
+        minFrameRate = 5.0f;
+        numberOfBuffers = 0;
+        autoTuneBuffers = false;
+        bufferTuningSeconds = 10;
     }
 
     /** Better initialization for the type of camera. */
     CameraConfiguration(LadybugDeviceType deviceType)
     {
+        useAdaptiveQuality = false;
+        minJpegQualityPercentage = 50;
+        minFrameRate = 5.0f;
+        numberOfBuffers = 0;
+        autoTuneBuffers = false;
+        bufferTuningSeconds = 10;
+
         switch (deviceType)
         {
         case LADYBUG_DEVICE_COMPRESSOR:
@@ -121,6 +173,14 @@ struct CameraConfiguration
         output << " JPEG quality: " << jpegQualityPercentage << "%" << endl;
         output << " Use auto JPEG quality: " << (isJpegQualityAuto ? "Yes" : "No") << endl;
         output << " JPEG buffer percentage: " << jpegBufferPercentage << endl;
+        output << " Use adaptive quality: " << (useAdaptiveQuality ? "Yes" : "No") << endl;
+        if (useAdaptiveQuality)
+        {
+            output << " Minimum JPEG quality: " << minJpegQualityPercentage << "%" << endl;
+            output << " Minimum frame rate: " << minFrameRate << endl;
+        }
+        output << " Number of buffers: " << numberOfBuffers << endl;
+        output << " Auto tune buffers: " << (autoTuneBuffers ? "Yes" : "No") << endl;
 
         return output.str();
     }
@@ -160,10 +220,22 @@ struct GpsConfiguration
 struct StreamConfiguration
 {
     std::string destinationDirectory;
+    unsigned int writerQueueLength;
+
+    // Flush the stream in chunks and keep it out of the page cache
+    bool useManagedWriteback;
+    unsigned int writebackChunkMB;
+
+    // Seconds between durable checkpoints for crash recovery, 0 disables
+    unsigned int checkpointIntervalSeconds;
 
     StreamConfiguration()
     {
         destinationDirectory = ".";
+        writerQueueLength = 8;
+        useManagedWriteback = false;
+        writebackChunkMB = 16;
+        checkpointIntervalSeconds = 5;
     }
 
     std::string ToString()
@@ -171,6 +243,13 @@ struct StreamConfiguration
         std::stringstream output;
         output << "Stream Configuration" << endl;
         output << " Destination directory: " << destinationDirectory << endl;
+        output << " Writer queue length: " << writerQueueLength << endl;
+        output << " Use managed writeback: " << (useManagedWriteback ? "Yes" : "No") << endl;
+        if (useManagedWriteback)
+        {
+            output << " Writeback chunk (MB): " << writebackChunkMB << endl;
+        }
+        output << " Checkpoint interval (s): " << checkpointIntervalSeconds << endl;
 
         return output.str();
     }
@@ -203,7 +282,7 @@ struct ConfigurationProperties
     {
         std::stringstream output;
         output << "*** Configuration ***" << endl;
-        output << camera.ToString() << gps.ToString() << stream.ToString() << endl;
+        output << general.ToString() << camera.ToString() << gps.ToString() << stream.ToString() << endl;
 
         return output.str();
     }
@@ -56,6 +56,35 @@ ConfigurationProperties ConfigurationLoader::Parse( std::string fileToLoad )
     ConfigurationProperties outputProps;
 
     // General
+    if (pRawConfig->getGeneral().getRealtimePriority())
+    {
+        outputProps.general.realtimePriority = *pRawConfig->getGeneral().getRealtimePriority();
+    }
+
+    if (pRawConfig->getGeneral().getGrabThreadCpu())
+    {
+        outputProps.general.grabThreadCpu = *pRawConfig->getGeneral().getGrabThreadCpu();
+    }
+
+    if (pRawConfig->getGeneral().getWriterThreadCpu())
+    {
+        outputProps.general.writerThreadCpu = *pRawConfig->getGeneral().getWriterThreadCpu();
+    }
+
+    if (pRawConfig->getGeneral().getLockMemory())
+    {
+        outputProps.general.lockMemory = *pRawConfig->getGeneral().getLockMemory();
+    }
+
+    if (pRawConfig->getGeneral().getNumaLocalBuffers())
+    {
+        outputProps.general.numaLocalBuffers = *pRawConfig->getGeneral().getNumaLocalBuffers();
+    }
+
+    if (pRawConfig->getGeneral().getLatencyCheckMs())
+    {
+        outputProps.general.latencyCheckMs = *pRawConfig->getGeneral().getLatencyCheckMs();
+    }
 
     // Camera
     outputProps.camera.dataFormat = dataFormat::fromString(std::string(pRawConfig->getCamera().getDataFormat().c_str()));
@@ -65,6 +94,36 @@ ConfigurationProperties ConfigurationLoader::Parse( std::string fileToLoad )
     outputProps.camera.isJpegQualityAuto = pRawConfig->getCamera().getIsJpegQualityAuto();
     outputProps.camera.jpegBufferPercentage = pRawConfig->getCamera().getJpegBufferPercentage();
 
+    if (pRawConfig->getCamera().getUseAdaptiveQuality())
+    {
+        outputProps.camera.useAdaptiveQuality = *pRawConfig->getCamera().getUseAdaptiveQuality();
+    }
+
+    if (pRawConfig->getCamera().getMinJpegQualityPercentage())
+    {
+        outputProps.camera.minJpegQualityPercentage = *pRawConfig->getCamera().getMinJpegQualityPercentage();
+    }
+
+    if (pRawConfig->getCamera().getMinFrameRate())
+    {
+        outputProps.camera.minFrameRate = *pRawConfig->getCamera().getMinFrameRate();
+    }
+
+    if (pRawConfig->getCamera().getNumberOfBuffers())
+    {
+        outputProps.camera.numberOfBuffers = *pRawConfig->getCamera().getNumberOfBuffers();
+    }
+
+    if (pRawConfig->getCamera().getAutoTuneBuffers())
+    {
+        outputProps.camera.autoTuneBuffers = *pRawConfig->getCamera().getAutoTuneBuffers();
+    }
+
+    if (pRawConfig->getCamera().getBufferTuningSeconds())
+    {
+        outputProps.camera.bufferTuningSeconds = *pRawConfig->getCamera().getBufferTuningSeconds();
+    }
+
     // GPS
     outputProps.gps.useGps = pRawConfig->getGPS().getUseGps();
     outputProps.gps.port = pRawConfig->getGPS().getPort();
@@ -74,6 +133,26 @@ ConfigurationProperties ConfigurationLoader::Parse( std::string fileToLoad )
 
     // Stream
     outputProps.stream.destinationDirectory = std::string(pRawConfig->getStream().getDestinationDirectory().c_str());
+
+    if (pRawConfig->getStream().getWriterQueueLength())
+    {
+        outputProps.stream.writerQueueLength = *pRawConfig->getStream().getWriterQueueLength();
+    }
+
+    if (pRawConfig->getStream().getManagedWriteback())
+    {
+        outputProps.stream.useManagedWriteback = *pRawConfig->getStream().getManagedWriteback();
+    }
+
+    if (pRawConfig->getStream().getWritebackChunkMB())
+    {
+        outputProps.stream.writebackChunkMB = *pRawConfig->getStream().getWritebackChunkMB();
+    }
+
+    if (pRawConfig->getStream().getCheckpointIntervalSeconds())
+    {
+        outputProps.stream.checkpointIntervalSeconds = *pRawConfig->getStream().getCheckpointIntervalSeconds();
+    }
     
     return outputProps;
 }
@@ -20,13 +20,15 @@
 
 #include "stdafx.h"
 #include "ImageGrabber.h"
+#include "BufferCountTuner.h"
 #include <iostream>
 
 using namespace std;
 
 ImageGrabber::ImageGrabber() : 
 m_camConfig(), 
-m_gpsConfig()
+m_gpsConfig(),
+m_numberOfBuffers(0)
 {    
     LadybugError error;
     error = ladybugCreateContext(&m_context);    
@@ -68,12 +70,34 @@ LadybugError ImageGrabber::Init()
         return LADYBUG_FAILED;
     }
     
-    error = ladybugInitializeFromIndex(m_context, 0);
+    // A buffer count tuned by an earlier run on this host takes precedence
+    unsigned int numberOfBuffers = m_camConfig.numberOfBuffers;
+    if (m_camConfig.autoTuneBuffers)
+    {
+        BufferCountTuner tuner(enumeratedCameras[0].pszModelName, m_camConfig.bufferTuningSeconds);
+        if (tuner.loadBufferCount(numberOfBuffers))
+        {
+            cout << "Using tuned buffer count from " << tuner.getStoragePath() << endl;
+        }
+    }
+
+    if (numberOfBuffers > 0)
+    {
+        cout << "Number of buffers: " << numberOfBuffers << endl;
+        error = ladybugInitializePlus(m_context, 0, numberOfBuffers, NULL, 0);
+    }
+    else
+    {
+        error = ladybugInitializeFromIndex(m_context, 0);
+    }
+
     if (error != LADYBUG_OK)
     {
         return error;
     }
 
+    m_numberOfBuffers = numberOfBuffers;
+
     LadybugCameraInfo camInfo;
     error = ladybugGetCameraInfo(m_context, &camInfo);
     if (error != LADYBUG_OK)
@@ -149,7 +173,9 @@ LadybugError ImageGrabber::Start()
         return error;
     }
 
-    error = ladybugSetAutoJPEGQualityControlFlag(m_context, m_camConfig.isJpegQualityAuto);
+    // The adaptive quality controller owns the JPEG quality, so the SDK's
+    // own buffer-usage based control must not fight it.
+    error = ladybugSetAutoJPEGQualityControlFlag(m_context, m_camConfig.isJpegQualityAuto && !m_camConfig.useAdaptiveQuality);
     if (error != LADYBUG_OK)
     {
         return error;
@@ -212,3 +238,18 @@ LadybugError ImageGrabber::Unlock( unsigned int bufferIndex )
 {
     return ladybugUnlock(m_context, bufferIndex);
 }
+
+LadybugError ImageGrabber::SetJpegQuality( unsigned int jpegQualityPercentage )
+{
+    return ladybugSetJPEGQuality(m_context, jpegQualityPercentage);
+}
+
+LadybugError ImageGrabber::SetFrameRate( float frameRate )
+{
+    return ladybugSetAbsPropertyEx(m_context, LADYBUG_FRAME_RATE, false, true, false, frameRate);
+}
+
+LadybugError ImageGrabber::GetFrameRate( float& frameRate )
+{
+    return ladybugGetAbsProperty(m_context, LADYBUG_FRAME_RATE, &frameRate);
+}
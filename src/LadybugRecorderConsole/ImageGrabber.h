@@ -29,6 +29,7 @@ public:
     ImageGrabber();
     ~ImageGrabber();
 
+    /** Call SetConfiguration() first, it determines the number of buffers. */
     LadybugError Init();
 
     LadybugError GetCameraInfo(LadybugCameraInfo& camInfo);
@@ -41,14 +42,23 @@ public:
     LadybugError Acquire(LadybugImage& image);
     LadybugError Unlock(unsigned int bufferIndex);
 
+    LadybugError SetJpegQuality(unsigned int jpegQualityPercentage);
+    LadybugError SetFrameRate(float frameRate);
+    LadybugError GetFrameRate(float& frameRate);
+
     LadybugContext GetCameraContext() const { return m_context; }
 
+    /** Number of buffers passed to the SDK, 0 if the SDK default is used. */
+    unsigned int GetNumberOfBuffers() const { return m_numberOfBuffers; }
+
 private:
     LadybugContext m_context;
     LadybugGPSContext m_gpsContext;
 
     CameraConfiguration m_camConfig;
     GpsConfiguration m_gpsConfig;
+
+    unsigned int m_numberOfBuffers;
 };
 
 #endif // ImageGrabber_h__
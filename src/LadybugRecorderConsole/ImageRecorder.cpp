@@ -21,11 +21,24 @@
 #include "stdafx.h"
 #include "ImageRecorder.h"
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <chrono>
 #include <iostream>
 
 using namespace std;
 
-ImageRecorder::ImageRecorder(const StreamConfiguration& streamConfig) : m_streamConfig(streamConfig)
+namespace
+{
+    // Write latency in 100 us bins up to one second; longer writes are
+    // counted together, with the exact maximum
+    const double k_writeLatencyBinUs = 100.0;
+    const unsigned int k_writeLatencyBins = 10000;
+}
+
+ImageRecorder::ImageRecorder(const StreamConfiguration& streamConfig) : 
+m_isWritebackManaged(false),
+m_imagesWritten(0),
+m_writeLatency(k_writeLatencyBinUs, k_writeLatencyBins),
+m_streamConfig(streamConfig)
 {
     const LadybugError error = ladybugCreateStreamContext(&m_streamContext);
     if (error != LADYBUG_OK)
@@ -48,7 +61,7 @@ LadybugError ImageRecorder::Init( LadybugContext cameraContext, unsigned int ser
     char uniqueFilename[128] = {0};
     sprintf(
         uniqueFilename, 
-        "ladybug_%u_%04d%02d%02d_%02d%02d%02d.pgr",
+        "ladybug_%u_%04d%02d%02d_%02d%02d%02d",
         serialNumber, 
         (int)currDate.year(),
         (int)currDate.month(),
@@ -57,7 +70,8 @@ LadybugError ImageRecorder::Init( LadybugContext cameraContext, unsigned int ser
         (int)currTod.minutes(),
         (int)currTod.seconds());
 
-    const std::string baseFileName = m_streamConfig.destinationDirectory + "/" + uniqueFilename;
+    m_baseFileName = m_streamConfig.destinationDirectory + "/" + uniqueFilename;
+    const std::string baseFileName = m_baseFileName + ".pgr";
 
     char openedFileName[256] = {0};
     const LadybugError error = ladybugInitializeStreamForWriting(m_streamContext, baseFileName.c_str(), cameraContext, openedFileName, true);
@@ -68,20 +82,107 @@ LadybugError ImageRecorder::Init( LadybugContext cameraContext, unsigned int ser
 
     cout << "Opened stream file: " << openedFileName << endl;
 
+    m_writeLatency.reset();
+
+    m_isWritebackManaged = false;
+    if (m_streamConfig.useManagedWriteback)
+    {
+        std::string errorMessage;
+        m_isWritebackManaged = m_writeback.open(openedFileName, m_streamConfig.writebackChunkMB, errorMessage);
+        if (!m_isWritebackManaged)
+        {
+            cerr << "Warning: Unable to manage stream writeback (" << errorMessage << ")" << endl;
+        }
+    }
+
+    m_imagesWritten = 0;
+    if (m_streamConfig.checkpointIntervalSeconds > 0)
+    {
+        std::string errorMessage;
+        if (m_journal.open(openedFileName, m_streamConfig.checkpointIntervalSeconds, errorMessage))
+        {
+            cout << "Stream journal: " << StreamJournal::getJournalPath(openedFileName) << endl;
+        }
+        else
+        {
+            cerr << "Warning: Unable to start stream journal (" << errorMessage << ")" << endl;
+        }
+    }
+
     return error;
 }
 
 LadybugError ImageRecorder::Stop()
 {
-    return ladybugStopStream(m_streamContext);
+    const LadybugError error = ladybugStopStream(m_streamContext);
+
+    if (m_isWritebackManaged)
+    {
+        m_writeback.close();
+        m_isWritebackManaged = false;
+    }
+
+    // Only a cleanly stopped stream is marked complete in the journal
+    std::string errorMessage;
+    if (error == LADYBUG_OK && !m_journal.close(m_imagesWritten, errorMessage))
+    {
+        cerr << "Warning: Unable to close stream journal (" << errorMessage << ")" << endl;
+    }
+
+    PrintWriteLatency();
+
+    return error;
 }
 
 LadybugError ImageRecorder::Write( const LadybugImage& image )
 {
-    return ladybugWriteImageToStream(m_streamContext, &image, NULL, NULL);
+    return TimedWrite(image, NULL, NULL);
 }
 
 LadybugError ImageRecorder::Write( const LadybugImage& image, double& mbWritten, unsigned long& imagesWritten )
 {
-    return ladybugWriteImageToStream(m_streamContext, &image, &mbWritten, &imagesWritten);
+    return TimedWrite(image, &mbWritten, &imagesWritten);
+}
+
+LadybugError ImageRecorder::TimedWrite( const LadybugImage& image, double* pMbWritten, unsigned long* pImagesWritten )
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    const LadybugError error = ladybugWriteImageToStream(m_streamContext, &image, pMbWritten, pImagesWritten);
+    if (m_isWritebackManaged)
+    {
+        m_writeback.update();
+    }
+
+    if (error == LADYBUG_OK)
+    {
+        m_imagesWritten++;
+
+        std::string errorMessage;
+        if (!m_journal.update(m_imagesWritten, errorMessage))
+        {
+            cerr << "Warning: Stream checkpoint failed (" << errorMessage << ")" << endl;
+        }
+    }
+
+    m_writeLatency.add(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+    return error;
+}
+
+void ImageRecorder::PrintWriteLatency()
+{
+    if (m_writeLatency.getCount() == 0)
+    {
+        return;
+    }
+
+    // Compare runs with and without ManagedWriteback to see the effect on the tail
+    cout << "Write latency (" << (m_streamConfig.useManagedWriteback ? "managed writeback" : "page cache") << "): "
+        << m_writeLatency.getCount() << " writes, median " << m_writeLatency.getPercentile(0.5) / 1000.0
+        << " ms, p99 " << m_writeLatency.getPercentile(0.99) / 1000.0
+        << " ms, p99.9 " << m_writeLatency.getPercentile(0.999) / 1000.0
+        << " ms, max " << m_writeLatency.getMax() / 1000.0 << " ms" << endl;
+
+    m_writeLatency.reset();
 }
@@ -21,6 +21,9 @@
 #define ImageRecorder_h__
 
 #include "Configuration.h"
+#include "LatencyHistogram.h"
+#include "StreamJournal.h"
+#include "StreamWriteback.h"
 
 class ImageRecorder
 {
@@ -34,8 +37,24 @@ public:
     LadybugError Write(const LadybugImage& image);
     LadybugError Write(const LadybugImage& image, double& mbWritten, unsigned long& imagesWritten);
 
+    /** Path of the stream without the extension, for files recorded alongside it. */
+    std::string GetBaseFileName() const { return m_baseFileName; }
+
 private:
+    LadybugError TimedWrite(const LadybugImage& image, double* pMbWritten, unsigned long* pImagesWritten);
+    void PrintWriteLatency();
+
     LadybugStreamContext m_streamContext;    
+    std::string m_baseFileName;
+
+    StreamWriteback m_writeback;
+    bool m_isWritebackManaged;
+
+    StreamJournal m_journal;
+    unsigned long m_imagesWritten;
+
+    // Duration of the writes, summarized when the stream stops
+    LatencyHistogram m_writeLatency;
 
     StreamConfiguration m_streamConfig;
 };
@@ -0,0 +1,255 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+#include "stdafx.h"
+#include "JpegQualityController.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+namespace
+{
+    // Queue occupancy above which the writer is considered to be falling behind
+    const double k_congestedOccupancy = 0.5;
+
+    // Queue occupancy below which the writer is considered to be keeping up
+    const double k_idleOccupancy = 0.125;
+
+    // Consecutive healthy windows required before stepping back up
+    const unsigned int k_healthyWindowsBeforeImprove = 5;
+
+    // Windows to wait after a change so the effect can be measured
+    const unsigned int k_holdWindowsAfterChange = 2;
+
+    // Fraction of the saturated throughput that must not be exceeded when stepping up
+    const double k_throughputHeadroom = 0.85;
+
+    const unsigned int k_qualityStep = 5;
+    const unsigned int k_severeQualityStep = 10;
+    const float k_frameRateStepFactor = 0.8f;
+}
+
+JpegQualityController::JpegQualityController( ImageGrabber& grabber, const CameraConfiguration& camConfig ) :
+m_grabber(grabber),
+m_camConfig(camConfig),
+m_isCompressed(camConfig.dataFormat == LADYBUG_DATAFORMAT_ANY || dataFormat::isJpeg(camConfig.dataFormat)),
+m_maxJpegQuality(camConfig.jpegQualityPercentage),
+m_minJpegQuality(std::min(camConfig.minJpegQualityPercentage, camConfig.jpegQualityPercentage)),
+m_maxFrameRate(camConfig.frameRate),
+m_minFrameRate(camConfig.minFrameRate),
+m_jpegQuality(camConfig.jpegQualityPercentage),
+m_frameRate(camConfig.frameRate),
+m_lastDroppedFrames(0),
+m_healthyWindows(0),
+m_holdWindows(0),
+m_saturatedMbPerSecond(0.0)
+{
+}
+
+JpegQualityController::~JpegQualityController()
+{
+}
+
+LadybugError JpegQualityController::Start( const std::string& logFileName )
+{
+    // With an automatic frame rate the camera picks the highest rate for the
+    // data format, which then becomes the upper bound.
+    float currentFrameRate = 0.0f;
+    const LadybugError frameRateError = m_grabber.GetFrameRate(currentFrameRate);
+    if (frameRateError != LADYBUG_OK)
+    {
+        return frameRateError;
+    }
+
+    if (m_camConfig.isFrameRateAuto)
+    {
+        m_maxFrameRate = currentFrameRate;
+    }
+
+    m_frameRate = currentFrameRate;
+    m_minFrameRate = std::min(m_minFrameRate, m_maxFrameRate);
+
+    if (m_isCompressed)
+    {
+        const LadybugError qualityError = m_grabber.SetJpegQuality(m_jpegQuality);
+        if (qualityError != LADYBUG_OK)
+        {
+            return qualityError;
+        }
+    }
+
+    m_log.open(logFileName.c_str(), ios::out | ios::trunc);
+    if (!m_log.is_open())
+    {
+        cerr << "Error: Unable to open quality log " << logFileName << endl;
+        return LADYBUG_COULD_NOT_OPEN_FILE;
+    }
+
+    m_log << "# frame\tjpegQuality\tframeRate\tmbPerSecond\tqueueLength\tdroppedFrames\treason" << endl;
+    Log(0, WriterStatistics(), "start");
+
+    cout << "Adaptive quality enabled. Quality " << m_minJpegQuality << "-" << m_maxJpegQuality
+        << "%, frame rate " << m_minFrameRate << "-" << m_maxFrameRate << " fps" << endl;
+    cout << "Quality changes are logged to " << logFileName << endl;
+
+    return LADYBUG_OK;
+}
+
+void JpegQualityController::Update( const WriterStatistics& statistics, unsigned long droppedFrames, unsigned long frameNumber )
+{
+    const unsigned long newlyDropped = droppedFrames - m_lastDroppedFrames;
+    m_lastDroppedFrames = droppedFrames;
+
+    const double occupancy = statistics.capacity > 0 ? (double)statistics.maxQueueLength / statistics.capacity : 0.0;
+    const bool congested = newlyDropped > 0 || occupancy >= k_congestedOccupancy;
+
+    if (congested)
+    {
+        m_saturatedMbPerSecond = std::max(m_saturatedMbPerSecond, statistics.mbPerSecond);
+        m_healthyWindows = 0;
+    }
+    else if (occupancy <= k_idleOccupancy)
+    {
+        m_healthyWindows++;
+    }
+    else
+    {
+        m_healthyWindows = 0;
+    }
+
+    if (m_holdWindows > 0)
+    {
+        m_holdWindows--;
+
+        // Dropping frames cannot wait for the previous change to settle
+        if (newlyDropped == 0)
+        {
+            return;
+        }
+    }
+
+    if (congested)
+    {
+        if (Degrade(newlyDropped > 0))
+        {
+            m_holdWindows = k_holdWindowsAfterChange;
+            Log(frameNumber, statistics, newlyDropped > 0 ? "frames dropped" : "writer queue backing up");
+        }
+        return;
+    }
+
+    if (m_healthyWindows >= k_healthyWindowsBeforeImprove)
+    {
+        // Without a saturation estimate the disk has never been the bottleneck
+        const bool hasHeadroom = m_saturatedMbPerSecond <= 0.0 || statistics.mbPerSecond < k_throughputHeadroom * m_saturatedMbPerSecond;
+        if (hasHeadroom && Improve())
+        {
+            m_healthyWindows = 0;
+            m_holdWindows = k_holdWindowsAfterChange;
+            Log(frameNumber, statistics, "writer keeping up");
+        }
+    }
+}
+
+bool JpegQualityController::Degrade( bool severe )
+{
+    if (m_isCompressed && m_jpegQuality > m_minJpegQuality)
+    {
+        const unsigned int step = severe ? k_severeQualityStep : k_qualityStep;
+        const unsigned int newQuality = m_jpegQuality > m_minJpegQuality + step ? m_jpegQuality - step : m_minJpegQuality;
+
+        const LadybugError error = m_grabber.SetJpegQuality(newQuality);
+        if (error != LADYBUG_OK)
+        {
+            cerr << "Error: Unable to set JPEG quality (" << ladybugErrorToString(error) << ")" << endl;
+            return false;
+        }
+
+        m_jpegQuality = newQuality;
+        return true;
+    }
+
+    if (m_frameRate > m_minFrameRate)
+    {
+        const float newFrameRate = std::max(m_minFrameRate, m_frameRate * k_frameRateStepFactor);
+
+        const LadybugError error = m_grabber.SetFrameRate(newFrameRate);
+        if (error != LADYBUG_OK)
+        {
+            cerr << "Error: Unable to set frame rate (" << ladybugErrorToString(error) << ")" << endl;
+            return false;
+        }
+
+        m_frameRate = newFrameRate;
+        return true;
+    }
+
+    return false;
+}
+
+bool JpegQualityController::Improve()
+{
+    if (m_frameRate < m_maxFrameRate)
+    {
+        const float newFrameRate = std::min(m_maxFrameRate, m_frameRate / k_frameRateStepFactor);
+
+        const LadybugError error = m_grabber.SetFrameRate(newFrameRate);
+        if (error != LADYBUG_OK)
+        {
+            cerr << "Error: Unable to set frame rate (" << ladybugErrorToString(error) << ")" << endl;
+            return false;
+        }
+
+        m_frameRate = newFrameRate;
+        return true;
+    }
+
+    if (m_isCompressed && m_jpegQuality < m_maxJpegQuality)
+    {
+        const unsigned int newQuality = std::min(m_maxJpegQuality, m_jpegQuality + k_qualityStep);
+
+        const LadybugError error = m_grabber.SetJpegQuality(newQuality);
+        if (error != LADYBUG_OK)
+        {
+            cerr << "Error: Unable to set JPEG quality (" << ladybugErrorToString(error) << ")" << endl;
+            return false;
+        }
+
+        m_jpegQuality = newQuality;
+        return true;
+    }
+
+    return false;
+}
+
+void JpegQualityController::Log( unsigned long frameNumber, const WriterStatistics& statistics, const char* reason )
+{
+    m_log << frameNumber << "\t"
+        << m_jpegQuality << "\t"
+        << fixed << setprecision(2) << m_frameRate << "\t"
+        << statistics.mbPerSecond << "\t"
+        << statistics.maxQueueLength << "/" << statistics.capacity << "\t"
+        << m_lastDroppedFrames << "\t"
+        << reason << endl;
+
+    cout << "Adaptive quality: JPEG quality " << m_jpegQuality << "%, frame rate " << m_frameRate << " fps (" << reason << ")" << endl;
+}
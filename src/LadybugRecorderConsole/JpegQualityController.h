@@ -0,0 +1,88 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+#ifndef JpegQualityController_h__
+#define JpegQualityController_h__
+
+#include "Configuration.h"
+#include "ImageGrabber.h"
+#include "WriterQueue.h"
+
+#include <fstream>
+
+/**
+ * Closed-loop control of the JPEG quality and frame rate.
+ *
+ * Once per measurement window the controller looks at the writer queue
+ * occupancy, the frames dropped since the last window and the sustained
+ * write throughput. Under back pressure it lowers the JPEG quality first
+ * and the frame rate second; once the queue has stayed near empty for a
+ * while it restores the frame rate first and the quality second, but only
+ * while the current throughput leaves headroom below the highest rate the
+ * disk was seen to sustain. The configured quality and frame rate are the
+ * upper bounds.
+ */
+class JpegQualityController
+{
+public:
+    JpegQualityController(ImageGrabber& grabber, const CameraConfiguration& camConfig);
+    ~JpegQualityController();
+
+    /**
+     * Takes over the JPEG quality and frame rate of a started camera.
+     * Every change is appended to logFileName.
+     */
+    LadybugError Start(const std::string& logFileName);
+
+    /** Runs one control step. Call once per measurement window. */
+    void Update(const WriterStatistics& statistics, unsigned long droppedFrames, unsigned long frameNumber);
+
+    unsigned int GetJpegQuality() const { return m_jpegQuality; }
+    float GetFrameRate() const { return m_frameRate; }
+
+private:
+    bool Degrade(bool severe);
+    bool Improve();
+    void Log(unsigned long frameNumber, const WriterStatistics& statistics, const char* reason);
+
+    ImageGrabber& m_grabber;
+    const CameraConfiguration m_camConfig;
+    const bool m_isCompressed;
+
+    unsigned int m_maxJpegQuality;
+    unsigned int m_minJpegQuality;
+    float m_maxFrameRate;
+    float m_minFrameRate;
+
+    unsigned int m_jpegQuality;
+    float m_frameRate;
+
+    unsigned long m_lastDroppedFrames;
+    unsigned int m_healthyWindows;
+    unsigned int m_holdWindows;
+
+    // Highest throughput observed while the queue was backing up, i.e. an
+    // estimate of what the destination can sustain.
+    double m_saturatedMbPerSecond;
+
+    std::ofstream m_log;
+};
+
+#endif // JpegQualityController_h__
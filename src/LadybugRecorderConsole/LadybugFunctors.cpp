@@ -56,6 +56,21 @@ std::string dataFormat::toPrettyString( LadybugDataFormat format )
     }
 }
 
+bool dataFormat::isJpeg( LadybugDataFormat format )
+{
+    switch (format)
+    {
+    case LADYBUG_DATAFORMAT_JPEG8:
+    case LADYBUG_DATAFORMAT_COLOR_SEP_JPEG8:
+    case LADYBUG_DATAFORMAT_COLOR_SEP_HALF_HEIGHT_JPEG8:
+    case LADYBUG_DATAFORMAT_COLOR_SEP_JPEG12:
+    case LADYBUG_DATAFORMAT_COLOR_SEP_HALF_HEIGHT_JPEG12:
+        return true;
+    default:
+        return false;
+    }
+}
+
 std::string ladybugCameraInfo::toString( const LadybugCameraInfo& cameraInfo )
 {
     std::stringstream output;
@@ -26,6 +26,7 @@ namespace dataFormat
 {    
     LadybugDataFormat fromString(std::string format);
     std::string toPrettyString(LadybugDataFormat format);
+    bool isJpeg(LadybugDataFormat format);
 };
 
 namespace ladybugCameraInfo
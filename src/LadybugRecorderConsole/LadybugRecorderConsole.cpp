@@ -25,6 +25,10 @@
 #include "ConfigurationLoader.h"
 #include "ImageGrabber.h"
 #include "ImageRecorder.h"
+#include "BufferCountTuner.h"
+#include "JpegQualityController.h"
+#include "RealtimeSupport.h"
+#include "WriterQueue.h"
 
 #ifdef _WIN32
 #include <conio.h>
@@ -34,12 +38,16 @@
 #include <unistd.h>
 #endif
 
+#include <chrono>
 #include <iostream>
 
 using namespace std;
 
 namespace
 {
+// Buffers the writer queue leaves for the camera to fill and the grab loop to hold
+const size_t k_buffersNotQueued = 2;
+
 #ifndef _WIN32
 
 int kbhit()
@@ -75,11 +83,73 @@ bool WasKeyPressed()
 #endif
 }
 
+/** Memory settings must be in place before the camera allocates its buffers. */
+void PrepareMemory(const GeneralConfiguration& generalConfig)
+{
+    std::string errorMessage;
+
+    if (generalConfig.lockMemory && !realtime::lockAllMemory(errorMessage))
+    {
+        cerr << "Warning: Unable to lock memory (" << errorMessage << ")" << endl;
+    }
+
+    if (generalConfig.numaLocalBuffers)
+    {
+        if (generalConfig.grabThreadCpu < 0)
+        {
+            cerr << "Warning: NUMA-local buffers require a grab thread CPU" << endl;
+        }
+        else if (!realtime::preferNumaNodeOfCpu(generalConfig.grabThreadCpu, errorMessage))
+        {
+            cerr << "Warning: Unable to allocate buffers NUMA-locally (" << errorMessage << ")" << endl;
+        }
+    }
+}
+
+/**
+ * Scheduling settings are applied once the camera is started so that the
+ * threads the SDK creates internally keep the default policy.
+ */
+void PrepareGrabThread(const GeneralConfiguration& generalConfig)
+{
+    std::string errorMessage;
+
+    if (generalConfig.grabThreadCpu >= 0 && !realtime::pinCurrentThreadToCpu(generalConfig.grabThreadCpu, errorMessage))
+    {
+        cerr << "Warning: Unable to pin grab thread (" << errorMessage << ")" << endl;
+    }
+
+    if (generalConfig.realtimePriority > 0 && !realtime::setCurrentThreadFifoPriority(generalConfig.realtimePriority, errorMessage))
+    {
+        cerr << "Warning: Unable to set realtime priority (" << errorMessage << ")" << endl;
+    }
+
+    // The check only says something about the scheduling settings, and the
+    // camera streams unattended while it runs
+    const bool isScheduled = generalConfig.grabThreadCpu >= 0 || generalConfig.realtimePriority > 0;
+    if (generalConfig.latencyCheckMs > 0 && isScheduled)
+    {
+        const realtime::LatencyReport report = realtime::measureWakeupLatency(generalConfig.latencyCheckMs);
+        cout << "Grab thread wake-up latency: " << realtime::toString(report) << endl;
+    }
 }
 
-void GrabLoop( ImageGrabber &grabber, ImageRecorder &recorder )
+}
+
+void GrabLoop( ImageGrabber &grabber, WriterQueue &writerQueue, JpegQualityController* pQualityController, BufferCountTuner* pBufferTuner )
 {
     LadybugImage currentImage;
+    unsigned long framesAcquired = 0;
+    unsigned long framesAcquiredAtLastUpdate = 0;
+    unsigned long framesDropped = 0;
+    unsigned int lastSequenceId = 0;
+
+    // Frames dropped in a row because the writer queue was full
+    unsigned int overflowFrames = 0;
+    std::chrono::steady_clock::time_point overflowStart;
+
+    std::chrono::steady_clock::time_point nextUpdate = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
     while (!WasKeyPressed())
     {
         const LadybugError acquisitionError = grabber.Acquire(currentImage);
@@ -90,21 +160,74 @@ void GrabLoop( ImageGrabber &grabber, ImageRecorder &recorder )
             continue;
         }
 
-        cout << "Image acquired - " << currentImage.timeStamp.ulCycleSeconds << ":" << currentImage.timeStamp.ulCycleCount << endl;
-
-        double mbWritten = 0.0;
-        unsigned long imagesWritten = 0;
-        const LadybugError writeError = recorder.Write(currentImage, mbWritten, imagesWritten);
-        if (writeError != LADYBUG_OK)
+        // Gaps in the sequence ID are frames the camera or driver dropped
+        const unsigned int sequenceId = currentImage.imageInfo.ulSequenceId;
+        if (framesAcquired > 0 && sequenceId > lastSequenceId + 1)
         {
-            // Error
-            cerr << "Failed to write image to stream (" << ladybugErrorToString(writeError) << ")" << endl;
-            continue;
+            framesDropped += sequenceId - lastSequenceId - 1;
         }
+        lastSequenceId = sequenceId;
+        framesAcquired++;
 
-        cout << imagesWritten << " images - " << mbWritten << "MB" << endl;
+        if (!writerQueue.Push(currentImage))
+        {
+            // The writer is behind, give the buffer back to the camera
+            grabber.Unlock(currentImage.uiBufferIndex);
+            framesDropped++;
+
+            if (overflowFrames++ == 0)
+            {
+                overflowStart = std::chrono::steady_clock::now();
+            }
+        }
+        else if (overflowFrames > 0)
+        {
+            // More buffers would have kept these frames until the writer caught up
+            if (pBufferTuner != NULL)
+            {
+                const double overflowSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - overflowStart).count();
+                pBufferTuner->addOverflow((unsigned int)writerQueue.GetCapacity(), overflowFrames, overflowSeconds);
+            }
+            overflowFrames = 0;
+        }
 
-        grabber.Unlock(currentImage.uiBufferIndex);
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now >= nextUpdate)
+        {
+            nextUpdate = now + std::chrono::seconds(1);
+
+            const WriterStatistics statistics = writerQueue.GetStatistics();
+
+            cout << statistics.imagesWritten << " images - " << statistics.mbWritten << "MB"
+                << " (" << statistics.mbPerSecond << " MB/s, queue " << statistics.maxQueueLength << "/" << statistics.capacity
+                << ", " << framesDropped << " dropped)" << endl;
+
+            if (pQualityController != NULL)
+            {
+                pQualityController->Update(statistics, framesDropped, framesAcquired);
+            }
+
+            if (pBufferTuner != NULL)
+            {
+                pBufferTuner->addSamples(framesAcquired - framesAcquiredAtLastUpdate, statistics.maxBufferHoldSeconds);
+                if (pBufferTuner->isWarmupComplete())
+                {
+                    const unsigned int bufferCount = pBufferTuner->computeBufferCount();
+                    cout << "Tuned buffer count: " << bufferCount << " (worst stall " << pBufferTuner->getWorstStallSeconds() * 1000.0
+                        << " ms at " << pBufferTuner->getObservedFrameRate() << " fps, worst backlog " << pBufferTuner->getWorstBacklog()
+                        << " frames), used from the next start" << endl;
+
+                    if (!pBufferTuner->saveBufferCount(bufferCount))
+                    {
+                        cerr << "Warning: Unable to store tuned buffer count in " << pBufferTuner->getStoragePath() << endl;
+                    }
+
+                    pBufferTuner = NULL;
+                }
+            }
+
+            framesAcquiredAtLastUpdate = framesAcquired;
+        }
     }
 }
 
@@ -131,8 +254,12 @@ int main(int /*argc*/, char** /*argv*/)
 
     cout << config.ToString() << endl;
 
+    PrepareMemory(config.general);
+
     // Initialize grabber
     ImageGrabber grabber;
+    grabber.SetConfiguration(config.camera, config.gps);
+
     const LadybugError grabberInitError = grabber.Init();
     if (grabberInitError != LADYBUG_OK)
     {
@@ -140,8 +267,6 @@ int main(int /*argc*/, char** /*argv*/)
         return -1;
     }
 
-    grabber.SetConfiguration(config.camera, config.gps);
-
     // Get the camera information
     LadybugCameraInfo camInfo;
     grabber.GetCameraInfo(camInfo);
@@ -171,11 +296,46 @@ int main(int /*argc*/, char** /*argv*/)
 
     cout << "Successfully started camera and stream" << endl;
 
-    GrabLoop(grabber, recorder);
+    PrepareGrabThread(config.general);
+
+    JpegQualityController qualityController(grabber, config.camera);
+    if (config.camera.useAdaptiveQuality)
+    {
+        const LadybugError controllerError = qualityController.Start(recorder.GetBaseFileName() + "_quality.log");
+        if (controllerError != LADYBUG_OK)
+        {
+            cerr << "Error: " << "Failed to start adaptive quality control (" << ladybugErrorToString(controllerError) << ")" << endl;
+            return -1;
+        }
+    }
+
+    // With a tuned buffer count the queue may hold every buffer but the one
+    // the camera fills and the one the grab loop holds, otherwise frames are
+    // dropped at the configured length however many buffers were tuned
+    size_t writerQueueLength = config.stream.writerQueueLength;
+    if (config.camera.autoTuneBuffers && grabber.GetNumberOfBuffers() > writerQueueLength + k_buffersNotQueued)
+    {
+        writerQueueLength = grabber.GetNumberOfBuffers() - k_buffersNotQueued;
+        cout << "Writer queue length: " << writerQueueLength << " (from the buffer count)" << endl;
+    }
+
+    WriterQueue writerQueue(grabber, recorder, writerQueueLength, config.general);
+    writerQueue.Start();
+
+    // Measure how long the writer holds on to buffers and store the count
+    // that covers it for the next start
+    BufferCountTuner bufferTuner(camInfo.pszModelName, config.camera.bufferTuningSeconds);
+    if (config.camera.autoTuneBuffers)
+    {
+        bufferTuner.start();
+    }
+
+    GrabLoop(grabber, writerQueue, config.camera.useAdaptiveQuality ? &qualityController : NULL, config.camera.autoTuneBuffers ? &bufferTuner : NULL);
 
     cout << "Stopping..." << endl;
 
-    // Shutdown
+    // Shutdown. Flush the queued images before the camera releases its buffers.
+    writerQueue.Stop();
     grabber.Stop();
     recorder.Stop();
 
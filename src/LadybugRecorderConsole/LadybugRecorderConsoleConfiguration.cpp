@@ -21,6 +21,150 @@ namespace LRCConfig
   // General
   // 
 
+  const General::RealtimePriorityOptional& General::
+  getRealtimePriority () const
+  {
+    return this->RealtimePriority_;
+  }
+
+  General::RealtimePriorityOptional& General::
+  getRealtimePriority ()
+  {
+    return this->RealtimePriority_;
+  }
+
+  void General::
+  setRealtimePriority (const RealtimePriorityType& x)
+  {
+    this->RealtimePriority_.set (x);
+  }
+
+  void General::
+  setRealtimePriority (const RealtimePriorityOptional& x)
+  {
+    this->RealtimePriority_ = x;
+  }
+
+  const General::GrabThreadCpuOptional& General::
+  getGrabThreadCpu () const
+  {
+    return this->GrabThreadCpu_;
+  }
+
+  General::GrabThreadCpuOptional& General::
+  getGrabThreadCpu ()
+  {
+    return this->GrabThreadCpu_;
+  }
+
+  void General::
+  setGrabThreadCpu (const GrabThreadCpuType& x)
+  {
+    this->GrabThreadCpu_.set (x);
+  }
+
+  void General::
+  setGrabThreadCpu (const GrabThreadCpuOptional& x)
+  {
+    this->GrabThreadCpu_ = x;
+  }
+
+  const General::WriterThreadCpuOptional& General::
+  getWriterThreadCpu () const
+  {
+    return this->WriterThreadCpu_;
+  }
+
+  General::WriterThreadCpuOptional& General::
+  getWriterThreadCpu ()
+  {
+    return this->WriterThreadCpu_;
+  }
+
+  void General::
+  setWriterThreadCpu (const WriterThreadCpuType& x)
+  {
+    this->WriterThreadCpu_.set (x);
+  }
+
+  void General::
+  setWriterThreadCpu (const WriterThreadCpuOptional& x)
+  {
+    this->WriterThreadCpu_ = x;
+  }
+
+  const General::LockMemoryOptional& General::
+  getLockMemory () const
+  {
+    return this->LockMemory_;
+  }
+
+  General::LockMemoryOptional& General::
+  getLockMemory ()
+  {
+    return this->LockMemory_;
+  }
+
+  void General::
+  setLockMemory (const LockMemoryType& x)
+  {
+    this->LockMemory_.set (x);
+  }
+
+  void General::
+  setLockMemory (const LockMemoryOptional& x)
+  {
+    this->LockMemory_ = x;
+  }
+
+  const General::NumaLocalBuffersOptional& General::
+  getNumaLocalBuffers () const
+  {
+    return this->NumaLocalBuffers_;
+  }
+
+  General::NumaLocalBuffersOptional& General::
+  getNumaLocalBuffers ()
+  {
+    return this->NumaLocalBuffers_;
+  }
+
+  void General::
+  setNumaLocalBuffers (const NumaLocalBuffersType& x)
+  {
+    this->NumaLocalBuffers_.set (x);
+  }
+
+  void General::
+  setNumaLocalBuffers (const NumaLocalBuffersOptional& x)
+  {
+    this->NumaLocalBuffers_ = x;
+  }
+
+  const General::LatencyCheckMsOptional& General::
+  getLatencyCheckMs () const
+  {
+    return this->LatencyCheckMs_;
+  }
+
+  General::LatencyCheckMsOptional& General::
+  getLatencyCheckMs ()
+  {
+    return this->LatencyCheckMs_;
+  }
+
+  void General::
+  setLatencyCheckMs (const LatencyCheckMsType& x)
+  {
+    this->LatencyCheckMs_.set (x);
+  }
+
+  void General::
+  setLatencyCheckMs (const LatencyCheckMsOptional& x)
+  {
+    this->LatencyCheckMs_ = x;
+  }
+
 
   // Camera
   // 
@@ -151,6 +295,150 @@ namespace LRCConfig
     this->JpegBufferPercentage_.set (std::move (x));
   }
 
+  const Camera::UseAdaptiveQualityOptional& Camera::
+  getUseAdaptiveQuality () const
+  {
+    return this->UseAdaptiveQuality_;
+  }
+
+  Camera::UseAdaptiveQualityOptional& Camera::
+  getUseAdaptiveQuality ()
+  {
+    return this->UseAdaptiveQuality_;
+  }
+
+  void Camera::
+  setUseAdaptiveQuality (const UseAdaptiveQualityType& x)
+  {
+    this->UseAdaptiveQuality_.set (x);
+  }
+
+  void Camera::
+  setUseAdaptiveQuality (const UseAdaptiveQualityOptional& x)
+  {
+    this->UseAdaptiveQuality_ = x;
+  }
+
+  const Camera::MinJpegQualityPercentageOptional& Camera::
+  getMinJpegQualityPercentage () const
+  {
+    return this->MinJpegQualityPercentage_;
+  }
+
+  Camera::MinJpegQualityPercentageOptional& Camera::
+  getMinJpegQualityPercentage ()
+  {
+    return this->MinJpegQualityPercentage_;
+  }
+
+  void Camera::
+  setMinJpegQualityPercentage (const MinJpegQualityPercentageType& x)
+  {
+    this->MinJpegQualityPercentage_.set (x);
+  }
+
+  void Camera::
+  setMinJpegQualityPercentage (const MinJpegQualityPercentageOptional& x)
+  {
+    this->MinJpegQualityPercentage_ = x;
+  }
+
+  const Camera::MinFrameRateOptional& Camera::
+  getMinFrameRate () const
+  {
+    return this->MinFrameRate_;
+  }
+
+  Camera::MinFrameRateOptional& Camera::
+  getMinFrameRate ()
+  {
+    return this->MinFrameRate_;
+  }
+
+  void Camera::
+  setMinFrameRate (const MinFrameRateType& x)
+  {
+    this->MinFrameRate_.set (x);
+  }
+
+  void Camera::
+  setMinFrameRate (const MinFrameRateOptional& x)
+  {
+    this->MinFrameRate_ = x;
+  }
+
+  const Camera::NumberOfBuffersOptional& Camera::
+  getNumberOfBuffers () const
+  {
+    return this->NumberOfBuffers_;
+  }
+
+  Camera::NumberOfBuffersOptional& Camera::
+  getNumberOfBuffers ()
+  {
+    return this->NumberOfBuffers_;
+  }
+
+  void Camera::
+  setNumberOfBuffers (const NumberOfBuffersType& x)
+  {
+    this->NumberOfBuffers_.set (x);
+  }
+
+  void Camera::
+  setNumberOfBuffers (const NumberOfBuffersOptional& x)
+  {
+    this->NumberOfBuffers_ = x;
+  }
+
+  const Camera::AutoTuneBuffersOptional& Camera::
+  getAutoTuneBuffers () const
+  {
+    return this->AutoTuneBuffers_;
+  }
+
+  Camera::AutoTuneBuffersOptional& Camera::
+  getAutoTuneBuffers ()
+  {
+    return this->AutoTuneBuffers_;
+  }
+
+  void Camera::
+  setAutoTuneBuffers (const AutoTuneBuffersType& x)
+  {
+    this->AutoTuneBuffers_.set (x);
+  }
+
+  void Camera::
+  setAutoTuneBuffers (const AutoTuneBuffersOptional& x)
+  {
+    this->AutoTuneBuffers_ = x;
+  }
+
+  const Camera::BufferTuningSecondsOptional& Camera::
+  getBufferTuningSeconds () const
+  {
+    return this->BufferTuningSeconds_;
+  }
+
+  Camera::BufferTuningSecondsOptional& Camera::
+  getBufferTuningSeconds ()
+  {
+    return this->BufferTuningSeconds_;
+  }
+
+  void Camera::
+  setBufferTuningSeconds (const BufferTuningSecondsType& x)
+  {
+    this->BufferTuningSeconds_.set (x);
+  }
+
+  void Camera::
+  setBufferTuningSeconds (const BufferTuningSecondsOptional& x)
+  {
+    this->BufferTuningSeconds_ = x;
+  }
+
 
   // GPS
   // 
@@ -279,6 +567,102 @@ namespace LRCConfig
     this->DestinationDirectory_.set (std::move (x));
   }
 
+  const Stream::WriterQueueLengthOptional& Stream::
+  getWriterQueueLength () const
+  {
+    return this->WriterQueueLength_;
+  }
+
+  Stream::WriterQueueLengthOptional& Stream::
+  getWriterQueueLength ()
+  {
+    return this->WriterQueueLength_;
+  }
+
+  void Stream::
+  setWriterQueueLength (const WriterQueueLengthType& x)
+  {
+    this->WriterQueueLength_.set (x);
+  }
+
+  void Stream::
+  setWriterQueueLength (const WriterQueueLengthOptional& x)
+  {
+    this->WriterQueueLength_ = x;
+  }
+
+  const Stream::ManagedWritebackOptional& Stream::
+  getManagedWriteback () const
+  {
+    return this->ManagedWriteback_;
+  }
+
+  Stream::ManagedWritebackOptional& Stream::
+  getManagedWriteback ()
+  {
+    return this->ManagedWriteback_;
+  }
+
+  void Stream::
+  setManagedWriteback (const ManagedWritebackType& x)
+  {
+    this->ManagedWriteback_.set (x);
+  }
+
+  void Stream::
+  setManagedWriteback (const ManagedWritebackOptional& x)
+  {
+    this->ManagedWriteback_ = x;
+  }
+
+  const Stream::WritebackChunkMBOptional& Stream::
+  getWritebackChunkMB () const
+  {
+    return this->WritebackChunkMB_;
+  }
+
+  Stream::WritebackChunkMBOptional& Stream::
+  getWritebackChunkMB ()
+  {
+    return this->WritebackChunkMB_;
+  }
+
+  void Stream::
+  setWritebackChunkMB (const WritebackChunkMBType& x)
+  {
+    this->WritebackChunkMB_.set (x);
+  }
+
+  void Stream::
+  setWritebackChunkMB (const WritebackChunkMBOptional& x)
+  {
+    this->WritebackChunkMB_ = x;
+  }
+
+  const Stream::CheckpointIntervalSecondsOptional& Stream::
+  getCheckpointIntervalSeconds () const
+  {
+    return this->CheckpointIntervalSeconds_;
+  }
+
+  Stream::CheckpointIntervalSecondsOptional& Stream::
+  getCheckpointIntervalSeconds ()
+  {
+    return this->CheckpointIntervalSeconds_;
+  }
+
+  void Stream::
+  setCheckpointIntervalSeconds (const CheckpointIntervalSecondsType& x)
+  {
+    this->CheckpointIntervalSeconds_.set (x);
+  }
+
+  void Stream::
+  setCheckpointIntervalSeconds (const CheckpointIntervalSecondsOptional& x)
+  {
+    this->CheckpointIntervalSeconds_ = x;
+  }
+
 
   // Configuration
   // 
@@ -442,7 +826,13 @@ namespace LRCConfig
 
   General::
   General ()
-  : ::xml_schema::Type ()
+  : ::xml_schema::Type (),
+    RealtimePriority_ (this),
+    GrabThreadCpu_ (this),
+    WriterThreadCpu_ (this),
+    LockMemory_ (this),
+    NumaLocalBuffers_ (this),
+    LatencyCheckMs_ (this)
   {
   }
 
@@ -450,7 +840,13 @@ namespace LRCConfig
   General (const General& x,
            ::xml_schema::Flags f,
            ::xml_schema::Container* c)
-  : ::xml_schema::Type (x, f, c)
+  : ::xml_schema::Type (x, f, c),
+    RealtimePriority_ (x.RealtimePriority_, f, this),
+    GrabThreadCpu_ (x.GrabThreadCpu_, f, this),
+    WriterThreadCpu_ (x.WriterThreadCpu_, f, this),
+    LockMemory_ (x.LockMemory_, f, this),
+    NumaLocalBuffers_ (x.NumaLocalBuffers_, f, this),
+    LatencyCheckMs_ (x.LatencyCheckMs_, f, this)
   {
   }
 
@@ -458,32 +854,123 @@ namespace LRCConfig
   General (const xercesc::DOMElement& e,
            ::xml_schema::Flags f,
            ::xml_schema::Container* c)
-  : ::xml_schema::Type (e, f, c)
+  : ::xml_schema::Type (e, f | ::xml_schema::Flags::base, c),
+    RealtimePriority_ (this),
+    GrabThreadCpu_ (this),
+    WriterThreadCpu_ (this),
+    LockMemory_ (this),
+    NumaLocalBuffers_ (this),
+    LatencyCheckMs_ (this)
   {
+    if ((f & ::xml_schema::Flags::base) == 0)
+    {
+      ::xsd::cxx::xml::dom::parser< char > p (e, true, false, false);
+      this->parse (p, f);
+    }
   }
 
-  General::
-  General (const xercesc::DOMAttr& a,
-           ::xml_schema::Flags f,
-           ::xml_schema::Container* c)
-  : ::xml_schema::Type (a, f, c)
+  void General::
+  parse (::xsd::cxx::xml::dom::parser< char >& p,
+         ::xml_schema::Flags f)
   {
+    for (; p.more_content (); p.next_content (false))
+    {
+      const xercesc::DOMElement& i (p.cur_element ());
+      const ::xsd::cxx::xml::qualified_name< char > n (
+        ::xsd::cxx::xml::dom::name< char > (i));
+
+      // RealtimePriority
+      //
+      if (n.name () == "RealtimePriority" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->RealtimePriority_)
+        {
+          this->RealtimePriority_.set (RealtimePriorityTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // GrabThreadCpu
+      //
+      if (n.name () == "GrabThreadCpu" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->GrabThreadCpu_)
+        {
+          this->GrabThreadCpu_.set (GrabThreadCpuTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // WriterThreadCpu
+      //
+      if (n.name () == "WriterThreadCpu" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->WriterThreadCpu_)
+        {
+          this->WriterThreadCpu_.set (WriterThreadCpuTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // LockMemory
+      //
+      if (n.name () == "LockMemory" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->LockMemory_)
+        {
+          this->LockMemory_.set (LockMemoryTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // NumaLocalBuffers
+      //
+      if (n.name () == "NumaLocalBuffers" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->NumaLocalBuffers_)
+        {
+          this->NumaLocalBuffers_.set (NumaLocalBuffersTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // LatencyCheckMs
+      //
+      if (n.name () == "LatencyCheckMs" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->LatencyCheckMs_)
+        {
+          this->LatencyCheckMs_.set (LatencyCheckMsTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      break;
+    }
   }
 
-  General::
-  General (const ::std::string& s,
-           const xercesc::DOMElement* e,
-           ::xml_schema::Flags f,
-           ::xml_schema::Container* c)
-  : ::xml_schema::Type (s, e, f, c)
+  General* General::
+  _clone (::xml_schema::Flags f,
+          ::xml_schema::Container* c) const
   {
+    return new class General (*this, f, c);
   }
 
-  General* General::
-  _clone (::xml_schema::Flags f,
-          ::xml_schema::Container* c) const
-  {
-    return new class General (*this, f, c);
+  General& General::
+  operator= (const General& x)
+  {
+    if (this != &x)
+    {
+      static_cast< ::xml_schema::Type& > (*this) = x;
+      this->RealtimePriority_ = x.RealtimePriority_;
+      this->GrabThreadCpu_ = x.GrabThreadCpu_;
+      this->WriterThreadCpu_ = x.WriterThreadCpu_;
+      this->LockMemory_ = x.LockMemory_;
+      this->NumaLocalBuffers_ = x.NumaLocalBuffers_;
+      this->LatencyCheckMs_ = x.LatencyCheckMs_;
+    }
+
+    return *this;
   }
 
   General::
@@ -507,7 +994,13 @@ namespace LRCConfig
     IsFrameRateAuto_ (IsFrameRateAuto, this),
     JpegQualityPercentage_ (JpegQualityPercentage, this),
     IsJpegQualityAuto_ (IsJpegQualityAuto, this),
-    JpegBufferPercentage_ (JpegBufferPercentage, this)
+    JpegBufferPercentage_ (JpegBufferPercentage, this),
+    UseAdaptiveQuality_ (this),
+    MinJpegQualityPercentage_ (this),
+    MinFrameRate_ (this),
+    NumberOfBuffers_ (this),
+    AutoTuneBuffers_ (this),
+    BufferTuningSeconds_ (this)
   {
   }
 
@@ -521,7 +1014,13 @@ namespace LRCConfig
     IsFrameRateAuto_ (x.IsFrameRateAuto_, f, this),
     JpegQualityPercentage_ (x.JpegQualityPercentage_, f, this),
     IsJpegQualityAuto_ (x.IsJpegQualityAuto_, f, this),
-    JpegBufferPercentage_ (x.JpegBufferPercentage_, f, this)
+    JpegBufferPercentage_ (x.JpegBufferPercentage_, f, this),
+    UseAdaptiveQuality_ (x.UseAdaptiveQuality_, f, this),
+    MinJpegQualityPercentage_ (x.MinJpegQualityPercentage_, f, this),
+    MinFrameRate_ (x.MinFrameRate_, f, this),
+    NumberOfBuffers_ (x.NumberOfBuffers_, f, this),
+    AutoTuneBuffers_ (x.AutoTuneBuffers_, f, this),
+    BufferTuningSeconds_ (x.BufferTuningSeconds_, f, this)
   {
   }
 
@@ -535,7 +1034,13 @@ namespace LRCConfig
     IsFrameRateAuto_ (this),
     JpegQualityPercentage_ (this),
     IsJpegQualityAuto_ (this),
-    JpegBufferPercentage_ (this)
+    JpegBufferPercentage_ (this),
+    UseAdaptiveQuality_ (this),
+    MinJpegQualityPercentage_ (this),
+    MinFrameRate_ (this),
+    NumberOfBuffers_ (this),
+    AutoTuneBuffers_ (this),
+    BufferTuningSeconds_ (this)
   {
     if ((f & ::xml_schema::Flags::base) == 0)
     {
@@ -629,6 +1134,72 @@ namespace LRCConfig
         }
       }
 
+      // UseAdaptiveQuality
+      //
+      if (n.name () == "UseAdaptiveQuality" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->UseAdaptiveQuality_)
+        {
+          this->UseAdaptiveQuality_.set (UseAdaptiveQualityTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // MinJpegQualityPercentage
+      //
+      if (n.name () == "MinJpegQualityPercentage" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->MinJpegQualityPercentage_)
+        {
+          this->MinJpegQualityPercentage_.set (MinJpegQualityPercentageTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // MinFrameRate
+      //
+      if (n.name () == "MinFrameRate" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->MinFrameRate_)
+        {
+          this->MinFrameRate_.set (MinFrameRateTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // NumberOfBuffers
+      //
+      if (n.name () == "NumberOfBuffers" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->NumberOfBuffers_)
+        {
+          this->NumberOfBuffers_.set (NumberOfBuffersTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // AutoTuneBuffers
+      //
+      if (n.name () == "AutoTuneBuffers" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->AutoTuneBuffers_)
+        {
+          this->AutoTuneBuffers_.set (AutoTuneBuffersTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // BufferTuningSeconds
+      //
+      if (n.name () == "BufferTuningSeconds" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->BufferTuningSeconds_)
+        {
+          this->BufferTuningSeconds_.set (BufferTuningSecondsTraits::create (i, f, this));
+          continue;
+        }
+      }
+
       break;
     }
 
@@ -694,6 +1265,12 @@ namespace LRCConfig
       this->JpegQualityPercentage_ = x.JpegQualityPercentage_;
       this->IsJpegQualityAuto_ = x.IsJpegQualityAuto_;
       this->JpegBufferPercentage_ = x.JpegBufferPercentage_;
+      this->UseAdaptiveQuality_ = x.UseAdaptiveQuality_;
+      this->MinJpegQualityPercentage_ = x.MinJpegQualityPercentage_;
+      this->MinFrameRate_ = x.MinFrameRate_;
+      this->NumberOfBuffers_ = x.NumberOfBuffers_;
+      this->AutoTuneBuffers_ = x.AutoTuneBuffers_;
+      this->BufferTuningSeconds_ = x.BufferTuningSeconds_;
     }
 
     return *this;
@@ -894,7 +1471,11 @@ namespace LRCConfig
   Stream::
   Stream (const DestinationDirectoryType& DestinationDirectory)
   : ::xml_schema::Type (),
-    DestinationDirectory_ (DestinationDirectory, this)
+    DestinationDirectory_ (DestinationDirectory, this),
+    WriterQueueLength_ (this),
+    ManagedWriteback_ (this),
+    WritebackChunkMB_ (this),
+    CheckpointIntervalSeconds_ (this)
   {
   }
 
@@ -903,7 +1484,11 @@ namespace LRCConfig
           ::xml_schema::Flags f,
           ::xml_schema::Container* c)
   : ::xml_schema::Type (x, f, c),
-    DestinationDirectory_ (x.DestinationDirectory_, f, this)
+    DestinationDirectory_ (x.DestinationDirectory_, f, this),
+    WriterQueueLength_ (x.WriterQueueLength_, f, this),
+    ManagedWriteback_ (x.ManagedWriteback_, f, this),
+    WritebackChunkMB_ (x.WritebackChunkMB_, f, this),
+    CheckpointIntervalSeconds_ (x.CheckpointIntervalSeconds_, f, this)
   {
   }
 
@@ -912,7 +1497,11 @@ namespace LRCConfig
           ::xml_schema::Flags f,
           ::xml_schema::Container* c)
   : ::xml_schema::Type (e, f | ::xml_schema::Flags::base, c),
-    DestinationDirectory_ (this)
+    DestinationDirectory_ (this),
+    WriterQueueLength_ (this),
+    ManagedWriteback_ (this),
+    WritebackChunkMB_ (this),
+    CheckpointIntervalSeconds_ (this)
   {
     if ((f & ::xml_schema::Flags::base) == 0)
     {
@@ -945,6 +1534,50 @@ namespace LRCConfig
         }
       }
 
+      // WriterQueueLength
+      //
+      if (n.name () == "WriterQueueLength" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->WriterQueueLength_)
+        {
+          this->WriterQueueLength_.set (WriterQueueLengthTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // ManagedWriteback
+      //
+      if (n.name () == "ManagedWriteback" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->ManagedWriteback_)
+        {
+          this->ManagedWriteback_.set (ManagedWritebackTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // WritebackChunkMB
+      //
+      if (n.name () == "WritebackChunkMB" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->WritebackChunkMB_)
+        {
+          this->WritebackChunkMB_.set (WritebackChunkMBTraits::create (i, f, this));
+          continue;
+        }
+      }
+
+      // CheckpointIntervalSeconds
+      //
+      if (n.name () == "CheckpointIntervalSeconds" && n.namespace_ () == "http://www.ptgrey.com")
+      {
+        if (!this->CheckpointIntervalSeconds_)
+        {
+          this->CheckpointIntervalSeconds_.set (CheckpointIntervalSecondsTraits::create (i, f, this));
+          continue;
+        }
+      }
+
       break;
     }
 
@@ -970,6 +1603,10 @@ namespace LRCConfig
     {
       static_cast< ::xml_schema::Type& > (*this) = x;
       this->DestinationDirectory_ = x.DestinationDirectory_;
+      this->WriterQueueLength_ = x.WriterQueueLength_;
+      this->ManagedWriteback_ = x.ManagedWriteback_;
+      this->WritebackChunkMB_ = x.WritebackChunkMB_;
+      this->CheckpointIntervalSeconds_ = x.CheckpointIntervalSeconds_;
     }
 
     return *this;
@@ -1365,8 +2002,32 @@ namespace LRCConfig
 namespace LRCConfig
 {
   ::std::ostream&
-  operator<< (::std::ostream& o, const General&)
+  operator<< (::std::ostream& o, const General& i)
   {
+    if (i.getRealtimePriority ())
+    {
+      o << ::std::endl << "RealtimePriority: " << *i.getRealtimePriority ();
+    }
+    if (i.getGrabThreadCpu ())
+    {
+      o << ::std::endl << "GrabThreadCpu: " << *i.getGrabThreadCpu ();
+    }
+    if (i.getWriterThreadCpu ())
+    {
+      o << ::std::endl << "WriterThreadCpu: " << *i.getWriterThreadCpu ();
+    }
+    if (i.getLockMemory ())
+    {
+      o << ::std::endl << "LockMemory: " << *i.getLockMemory ();
+    }
+    if (i.getNumaLocalBuffers ())
+    {
+      o << ::std::endl << "NumaLocalBuffers: " << *i.getNumaLocalBuffers ();
+    }
+    if (i.getLatencyCheckMs ())
+    {
+      o << ::std::endl << "LatencyCheckMs: " << *i.getLatencyCheckMs ();
+    }
     return o;
   }
 
@@ -1379,6 +2040,30 @@ namespace LRCConfig
     o << ::std::endl << "JpegQualityPercentage: " << i.getJpegQualityPercentage ();
     o << ::std::endl << "IsJpegQualityAuto: " << i.getIsJpegQualityAuto ();
     o << ::std::endl << "JpegBufferPercentage: " << i.getJpegBufferPercentage ();
+    if (i.getUseAdaptiveQuality ())
+    {
+      o << ::std::endl << "UseAdaptiveQuality: " << *i.getUseAdaptiveQuality ();
+    }
+    if (i.getMinJpegQualityPercentage ())
+    {
+      o << ::std::endl << "MinJpegQualityPercentage: " << *i.getMinJpegQualityPercentage ();
+    }
+    if (i.getMinFrameRate ())
+    {
+      o << ::std::endl << "MinFrameRate: " << *i.getMinFrameRate ();
+    }
+    if (i.getNumberOfBuffers ())
+    {
+      o << ::std::endl << "NumberOfBuffers: " << *i.getNumberOfBuffers ();
+    }
+    if (i.getAutoTuneBuffers ())
+    {
+      o << ::std::endl << "AutoTuneBuffers: " << *i.getAutoTuneBuffers ();
+    }
+    if (i.getBufferTuningSeconds ())
+    {
+      o << ::std::endl << "BufferTuningSeconds: " << *i.getBufferTuningSeconds ();
+    }
     return o;
   }
 
@@ -1397,6 +2082,22 @@ namespace LRCConfig
   operator<< (::std::ostream& o, const Stream& i)
   {
     o << ::std::endl << "DestinationDirectory: " << i.getDestinationDirectory ();
+    if (i.getWriterQueueLength ())
+    {
+      o << ::std::endl << "WriterQueueLength: " << *i.getWriterQueueLength ();
+    }
+    if (i.getManagedWriteback ())
+    {
+      o << ::std::endl << "ManagedWriteback: " << *i.getManagedWriteback ();
+    }
+    if (i.getWritebackChunkMB ())
+    {
+      o << ::std::endl << "WritebackChunkMB: " << *i.getWritebackChunkMB ();
+    }
+    if (i.getCheckpointIntervalSeconds ())
+    {
+      o << ::std::endl << "CheckpointIntervalSeconds: " << *i.getCheckpointIntervalSeconds ();
+    }
     return o;
   }
 
@@ -1870,17 +2571,84 @@ namespace LRCConfig
   operator<< (xercesc::DOMElement& e, const General& i)
   {
     e << static_cast< const ::xml_schema::Type& > (i);
-  }
 
-  void
-  operator<< (xercesc::DOMAttr&, const General&)
-  {
-  }
+    // RealtimePriority
+    //
+    if (i.getRealtimePriority ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "RealtimePriority",
+          "http://www.ptgrey.com",
+          e));
 
-  void
-  operator<< (::xml_schema::ListStream&,
-              const General&)
-  {
+      s << *i.getRealtimePriority ();
+    }
+
+    // GrabThreadCpu
+    //
+    if (i.getGrabThreadCpu ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "GrabThreadCpu",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getGrabThreadCpu ();
+    }
+
+    // WriterThreadCpu
+    //
+    if (i.getWriterThreadCpu ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "WriterThreadCpu",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getWriterThreadCpu ();
+    }
+
+    // LockMemory
+    //
+    if (i.getLockMemory ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "LockMemory",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getLockMemory ();
+    }
+
+    // NumaLocalBuffers
+    //
+    if (i.getNumaLocalBuffers ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "NumaLocalBuffers",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getNumaLocalBuffers ();
+    }
+
+    // LatencyCheckMs
+    //
+    if (i.getLatencyCheckMs ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "LatencyCheckMs",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getLatencyCheckMs ();
+    }
   }
 
   void
@@ -1959,6 +2727,84 @@ namespace LRCConfig
 
       s << i.getJpegBufferPercentage ();
     }
+
+    // UseAdaptiveQuality
+    //
+    if (i.getUseAdaptiveQuality ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "UseAdaptiveQuality",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getUseAdaptiveQuality ();
+    }
+
+    // MinJpegQualityPercentage
+    //
+    if (i.getMinJpegQualityPercentage ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "MinJpegQualityPercentage",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getMinJpegQualityPercentage ();
+    }
+
+    // MinFrameRate
+    //
+    if (i.getMinFrameRate ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "MinFrameRate",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getMinFrameRate ();
+    }
+
+    // NumberOfBuffers
+    //
+    if (i.getNumberOfBuffers ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "NumberOfBuffers",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getNumberOfBuffers ();
+    }
+
+    // AutoTuneBuffers
+    //
+    if (i.getAutoTuneBuffers ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "AutoTuneBuffers",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getAutoTuneBuffers ();
+    }
+
+    // BufferTuningSeconds
+    //
+    if (i.getBufferTuningSeconds ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "BufferTuningSeconds",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getBufferTuningSeconds ();
+    }
   }
 
   void
@@ -2043,6 +2889,58 @@ namespace LRCConfig
 
       s << i.getDestinationDirectory ();
     }
+
+    // WriterQueueLength
+    //
+    if (i.getWriterQueueLength ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "WriterQueueLength",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getWriterQueueLength ();
+    }
+
+    // ManagedWriteback
+    //
+    if (i.getManagedWriteback ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "ManagedWriteback",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getManagedWriteback ();
+    }
+
+    // WritebackChunkMB
+    //
+    if (i.getWritebackChunkMB ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "WritebackChunkMB",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getWritebackChunkMB ();
+    }
+
+    // CheckpointIntervalSeconds
+    //
+    if (i.getCheckpointIntervalSeconds ())
+    {
+      xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "CheckpointIntervalSeconds",
+          "http://www.ptgrey.com",
+          e));
+
+      s << *i.getCheckpointIntervalSeconds ();
+    }
   }
 
   void
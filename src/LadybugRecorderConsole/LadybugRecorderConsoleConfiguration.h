@@ -635,136 +635,819 @@ namespace LRCConfig
   class General: public ::xml_schema::Type
   {
     public:
+    /**
+     * @name RealtimePriority
+     *
+     * @brief Accessor and modifier functions for the %RealtimePriority
+     * optional element.
+     *
+     * SCHED_FIFO priority (1-99) of the acquisition thread. 0 keeps the
+     * default scheduling policy. Linux only.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::UnsignedInt RealtimePriorityType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< RealtimePriorityType > RealtimePriorityOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< RealtimePriorityType, char > RealtimePriorityTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const RealtimePriorityOptional&
+    getRealtimePriority () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    RealtimePriorityOptional&
+    getRealtimePriority ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setRealtimePriority (const RealtimePriorityType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setRealtimePriority (const RealtimePriorityOptional& x);
+
+    //@}
+
+    /**
+     * @name GrabThreadCpu
+     *
+     * @brief Accessor and modifier functions for the %GrabThreadCpu
+     * optional element.
+     *
+     * CPU to pin the acquisition thread to. -1 leaves the thread unpinned.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Int GrabThreadCpuType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< GrabThreadCpuType > GrabThreadCpuOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< GrabThreadCpuType, char > GrabThreadCpuTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const GrabThreadCpuOptional&
+    getGrabThreadCpu () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    GrabThreadCpuOptional&
+    getGrabThreadCpu ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setGrabThreadCpu (const GrabThreadCpuType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setGrabThreadCpu (const GrabThreadCpuOptional& x);
+
+    //@}
+
+    /**
+     * @name WriterThreadCpu
+     *
+     * @brief Accessor and modifier functions for the %WriterThreadCpu
+     * optional element.
+     *
+     * CPU to pin the stream writer thread to. -1 leaves the thread unpinned.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Int WriterThreadCpuType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< WriterThreadCpuType > WriterThreadCpuOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< WriterThreadCpuType, char > WriterThreadCpuTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const WriterThreadCpuOptional&
+    getWriterThreadCpu () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    WriterThreadCpuOptional&
+    getWriterThreadCpu ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setWriterThreadCpu (const WriterThreadCpuType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setWriterThreadCpu (const WriterThreadCpuOptional& x);
+
+    //@}
+
+    /**
+     * @name LockMemory
+     *
+     * @brief Accessor and modifier functions for the %LockMemory
+     * optional element.
+     *
+     * Whether to lock all current and future memory of the process into RAM
+     * so that the acquisition path never takes a page fault.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Boolean LockMemoryType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< LockMemoryType > LockMemoryOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< LockMemoryType, char > LockMemoryTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const LockMemoryOptional&
+    getLockMemory () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    LockMemoryOptional&
+    getLockMemory ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setLockMemory (const LockMemoryType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setLockMemory (const LockMemoryOptional& x);
+
+    //@}
+
+    /**
+     * @name NumaLocalBuffers
+     *
+     * @brief Accessor and modifier functions for the %NumaLocalBuffers
+     * optional element.
+     *
+     * Whether to allocate the image buffers on the NUMA node of the
+     * acquisition CPU. Requires GrabThreadCpu.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Boolean NumaLocalBuffersType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< NumaLocalBuffersType > NumaLocalBuffersOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< NumaLocalBuffersType, char > NumaLocalBuffersTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const NumaLocalBuffersOptional&
+    getNumaLocalBuffers () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    NumaLocalBuffersOptional&
+    getNumaLocalBuffers ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setNumaLocalBuffers (const NumaLocalBuffersType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setNumaLocalBuffers (const NumaLocalBuffersOptional& x);
+
+    //@}
+
+    /**
+     * @name LatencyCheckMs
+     *
+     * @brief Accessor and modifier functions for the %LatencyCheckMs
+     * optional element.
+     *
+     * Duration of the startup wake-up latency self-check in milliseconds. 0
+     * disables the check.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::UnsignedInt LatencyCheckMsType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< LatencyCheckMsType > LatencyCheckMsOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< LatencyCheckMsType, char > LatencyCheckMsTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const LatencyCheckMsOptional&
+    getLatencyCheckMs () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    LatencyCheckMsOptional&
+    getLatencyCheckMs ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setLatencyCheckMs (const LatencyCheckMsType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setLatencyCheckMs (const LatencyCheckMsOptional& x);
+
+    //@}
+
     /**
      * @name Constructors
      */
     //@{
 
     /**
-     * @brief Create an instance from the ultimate base and
-     * initializers for required elements and attributes.
+     * @brief Create an instance from the ultimate base and
+     * initializers for required elements and attributes.
+     */
+    General ();
+
+    /**
+     * @brief Create an instance from a DOM element.
+     *
+     * @param e A DOM element to extract the data from.
+     * @param f Flags to create the new instance with.
+     * @param c A pointer to the object that will contain the new
+     * instance.
+     */
+    General (const xercesc::DOMElement& e,
+             ::xml_schema::Flags f = 0,
+             ::xml_schema::Container* c = 0);
+
+    /**
+     * @brief Copy constructor.
+     *
+     * @param x An instance to make a copy of.
+     * @param f Flags to create the copy with.
+     * @param c A pointer to the object that will contain the copy.
+     *
+     * For polymorphic object models use the @c _clone function instead.
+     */
+    General (const General& x,
+             ::xml_schema::Flags f = 0,
+             ::xml_schema::Container* c = 0);
+
+    /**
+     * @brief Copy the instance polymorphically.
+     *
+     * @param f Flags to create the copy with.
+     * @param c A pointer to the object that will contain the copy.
+     * @return A pointer to the dynamically allocated copy.
+     *
+     * This function ensures that the dynamic type of the instance is
+     * used for copying and should be used for polymorphic object
+     * models instead of the copy constructor.
+     */
+    virtual General*
+    _clone (::xml_schema::Flags f = 0,
+            ::xml_schema::Container* c = 0) const;
+
+    /**
+     * @brief Copy assignment operator.
+     *
+     * @param x An instance to make a copy of.
+     * @return A reference to itself.
+     *
+     * For polymorphic object models use the @c _clone function instead.
+     */
+    General&
+    operator= (const General& x);
+
+    //@}
+
+    /**
+     * @brief Destructor.
+     */
+    virtual 
+    ~General ();
+
+    // Implementation.
+    //
+
+    //@cond
+
+    protected:
+    void
+    parse (::xsd::cxx::xml::dom::parser< char >&,
+           ::xml_schema::Flags);
+
+    protected:
+    RealtimePriorityOptional RealtimePriority_;
+    GrabThreadCpuOptional GrabThreadCpu_;
+    WriterThreadCpuOptional WriterThreadCpu_;
+    LockMemoryOptional LockMemory_;
+    NumaLocalBuffersOptional NumaLocalBuffers_;
+    LatencyCheckMsOptional LatencyCheckMs_;
+
+    //@endcond
+  };
+
+  /**
+   * @brief Class corresponding to the %Camera schema type.
+   *
+   * @nosubgrouping
+   */
+  class Camera: public ::xml_schema::Type
+  {
+    public:
+    /**
+     * @name DataFormat
+     *
+     * @brief Accessor and modifier functions for the %DataFormat
+     * required element.
+     *
+     * Data format to start the camera in. Not all cameras support all data
+     * formats. See ladybug.h for further information about each data format.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::LRCConfig::DataFormat DataFormatType;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< DataFormatType, char > DataFormatTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element.
+     *
+     * @return A constant reference to the element.
+     */
+    const DataFormatType&
+    getDataFormat () const;
+
+    /**
+     * @brief Return a read-write reference to the element.
+     *
+     * @return A reference to the element.
+     */
+    DataFormatType&
+    getDataFormat ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setDataFormat (const DataFormatType& x);
+
+    /**
+     * @brief Set the element value without copying.
+     *
+     * @param p A new value to use.
+     *
+     * This function will try to use the passed value directly
+     * instead of making a copy.
+     */
+    void
+    setDataFormat (::std::unique_ptr< DataFormatType > p);
+
+    //@}
+
+    /**
+     * @name FrameRate
+     *
+     * @brief Accessor and modifier functions for the %FrameRate
+     * required element.
+     *
+     * The frame rate to set to the camera.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Float FrameRateType;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< FrameRateType, char > FrameRateTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element.
+     *
+     * @return A constant reference to the element.
+     */
+    const FrameRateType&
+    getFrameRate () const;
+
+    /**
+     * @brief Return a read-write reference to the element.
+     *
+     * @return A reference to the element.
+     */
+    FrameRateType&
+    getFrameRate ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setFrameRate (const FrameRateType& x);
+
+    //@}
+
+    /**
+     * @name IsFrameRateAuto
+     *
+     * @brief Accessor and modifier functions for the %IsFrameRateAuto
+     * required element.
+     *
+     * Whether to set the camera's frame rate automatically for the specified
+     * data format. This overrides the manual frame rate set above.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Boolean IsFrameRateAutoType;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< IsFrameRateAutoType, char > IsFrameRateAutoTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element.
+     *
+     * @return A constant reference to the element.
+     */
+    const IsFrameRateAutoType&
+    getIsFrameRateAuto () const;
+
+    /**
+     * @brief Return a read-write reference to the element.
+     *
+     * @return A reference to the element.
+     */
+    IsFrameRateAutoType&
+    getIsFrameRateAuto ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setIsFrameRateAuto (const IsFrameRateAutoType& x);
+
+    //@}
+
+    /**
+     * @name JpegQualityPercentage
+     *
+     * @brief Accessor and modifier functions for the %JpegQualityPercentage
+     * required element.
+     *
+     * JPEG compression quality to use. Range is from 0-100. This setting
+     * ignored for uncompressed data formats.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
      */
-    General ();
+    typedef ::LRCConfig::JpegQualityPercentage JpegQualityPercentageType;
 
     /**
-     * @brief Create an instance from a DOM element.
-     *
-     * @param e A DOM element to extract the data from.
-     * @param f Flags to create the new instance with.
-     * @param c A pointer to the object that will contain the new
-     * instance.
+     * @brief Element traits type.
      */
-    General (const xercesc::DOMElement& e,
-             ::xml_schema::Flags f = 0,
-             ::xml_schema::Container* c = 0);
+    typedef ::xsd::cxx::tree::traits< JpegQualityPercentageType, char > JpegQualityPercentageTraits;
 
     /**
-     * @brief Create an instance from a DOM attribute.
+     * @brief Return a read-only (constant) reference to the element.
      *
-     * @param a A DOM attribute to extract the data from.
-     * @param f Flags to create the new instance with.
-     * @param c A pointer to the object that will contain the new
-     * instance.
+     * @return A constant reference to the element.
      */
-    General (const xercesc::DOMAttr& a,
-             ::xml_schema::Flags f = 0,
-             ::xml_schema::Container* c = 0);
+    const JpegQualityPercentageType&
+    getJpegQualityPercentage () const;
 
     /**
-     * @brief Create an instance from a string fragment.
+     * @brief Return a read-write reference to the element.
      *
-     * @param s A string fragment to extract the data from.
-     * @param e A pointer to DOM element containing the string fragment.
-     * @param f Flags to create the new instance with.
-     * @param c A pointer to the object that will contain the new
-     * instance.
+     * @return A reference to the element.
      */
-    General (const ::std::string& s,
-             const xercesc::DOMElement* e,
-             ::xml_schema::Flags f = 0,
-             ::xml_schema::Container* c = 0);
+    JpegQualityPercentageType&
+    getJpegQualityPercentage ();
 
     /**
-     * @brief Copy constructor.
+     * @brief Set the element value.
      *
-     * @param x An instance to make a copy of.
-     * @param f Flags to create the copy with.
-     * @param c A pointer to the object that will contain the copy.
+     * @param x A new value to set.
      *
-     * For polymorphic object models use the @c _clone function instead.
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
      */
-    General (const General& x,
-             ::xml_schema::Flags f = 0,
-             ::xml_schema::Container* c = 0);
+    void
+    setJpegQualityPercentage (const JpegQualityPercentageType& x);
 
     /**
-     * @brief Copy the instance polymorphically.
+     * @brief Set the element value without copying.
      *
-     * @param f Flags to create the copy with.
-     * @param c A pointer to the object that will contain the copy.
-     * @return A pointer to the dynamically allocated copy.
+     * @param p A new value to use.
      *
-     * This function ensures that the dynamic type of the instance is
-     * used for copying and should be used for polymorphic object
-     * models instead of the copy constructor.
+     * This function will try to use the passed value directly
+     * instead of making a copy.
      */
-    virtual General*
-    _clone (::xml_schema::Flags f = 0,
-            ::xml_schema::Container* c = 0) const;
+    void
+    setJpegQualityPercentage (::std::unique_ptr< JpegQualityPercentageType > p);
 
     //@}
 
     /**
-     * @brief Destructor.
+     * @name IsJpegQualityAuto
+     *
+     * @brief Accessor and modifier functions for the %IsJpegQualityAuto
+     * required element.
+     *
+     * Whether to set the JPEG compression quality automatically based on the
+     * percentage of the image buffer to be used for JPEG image data. This
+     * overrides the manual JPEG quality percentage set above.
      */
-    virtual 
-    ~General ();
-  };
+    //@{
 
-  /**
-   * @brief Class corresponding to the %Camera schema type.
-   *
-   * @nosubgrouping
-   */
-  class Camera: public ::xml_schema::Type
-  {
-    public:
     /**
-     * @name DataFormat
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Boolean IsJpegQualityAutoType;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< IsJpegQualityAutoType, char > IsJpegQualityAutoTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element.
      *
-     * @brief Accessor and modifier functions for the %DataFormat
+     * @return A constant reference to the element.
+     */
+    const IsJpegQualityAutoType&
+    getIsJpegQualityAuto () const;
+
+    /**
+     * @brief Return a read-write reference to the element.
+     *
+     * @return A reference to the element.
+     */
+    IsJpegQualityAutoType&
+    getIsJpegQualityAuto ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setIsJpegQualityAuto (const IsJpegQualityAutoType& x);
+
+    //@}
+
+    /**
+     * @name JpegBufferPercentage
+     *
+     * @brief Accessor and modifier functions for the %JpegBufferPercentage
      * required element.
      *
-     * Data format to start the camera in. Not all cameras support all data
-     * formats. See ladybug.h for further information about each data format.
+     * The percentage of the image buffer to be used for JPEG image data.
+     * Range is from 0-128 where 128 represents the entire image buffer.
      */
     //@{
 
     /**
      * @brief Element type.
      */
-    typedef ::LRCConfig::DataFormat DataFormatType;
+    typedef ::LRCConfig::JpegBufferPercentage JpegBufferPercentageType;
 
     /**
      * @brief Element traits type.
      */
-    typedef ::xsd::cxx::tree::traits< DataFormatType, char > DataFormatTraits;
+    typedef ::xsd::cxx::tree::traits< JpegBufferPercentageType, char > JpegBufferPercentageTraits;
 
     /**
      * @brief Return a read-only (constant) reference to the element.
      *
      * @return A constant reference to the element.
      */
-    const DataFormatType&
-    getDataFormat () const;
+    const JpegBufferPercentageType&
+    getJpegBufferPercentage () const;
 
     /**
      * @brief Return a read-write reference to the element.
      *
      * @return A reference to the element.
      */
-    DataFormatType&
-    getDataFormat ();
+    JpegBufferPercentageType&
+    getJpegBufferPercentage ();
 
     /**
      * @brief Set the element value.
@@ -775,7 +1458,7 @@ namespace LRCConfig
      * the new value of the element.
      */
     void
-    setDataFormat (const DataFormatType& x);
+    setJpegBufferPercentage (const JpegBufferPercentageType& x);
 
     /**
      * @brief Set the element value without copying.
@@ -786,45 +1469,52 @@ namespace LRCConfig
      * instead of making a copy.
      */
     void
-    setDataFormat (::std::unique_ptr< DataFormatType > p);
+    setJpegBufferPercentage (::std::unique_ptr< JpegBufferPercentageType > p);
 
     //@}
 
     /**
-     * @name FrameRate
+     * @name UseAdaptiveQuality
      *
-     * @brief Accessor and modifier functions for the %FrameRate
-     * required element.
+     * @brief Accessor and modifier functions for the %UseAdaptiveQuality
+     * optional element.
      *
-     * The frame rate to set to the camera.
+     * Whether to adjust the JPEG quality and frame rate automatically based
+     * on the measured write throughput. This overrides IsJpegQualityAuto.
      */
     //@{
 
     /**
      * @brief Element type.
      */
-    typedef ::xml_schema::Float FrameRateType;
+    typedef ::xml_schema::Boolean UseAdaptiveQualityType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< UseAdaptiveQualityType > UseAdaptiveQualityOptional;
 
     /**
      * @brief Element traits type.
      */
-    typedef ::xsd::cxx::tree::traits< FrameRateType, char > FrameRateTraits;
+    typedef ::xsd::cxx::tree::traits< UseAdaptiveQualityType, char > UseAdaptiveQualityTraits;
 
     /**
-     * @brief Return a read-only (constant) reference to the element.
+     * @brief Return a read-only (constant) reference to the element
+     * container.
      *
-     * @return A constant reference to the element.
+     * @return A constant reference to the optional container.
      */
-    const FrameRateType&
-    getFrameRate () const;
+    const UseAdaptiveQualityOptional&
+    getUseAdaptiveQuality () const;
 
     /**
-     * @brief Return a read-write reference to the element.
+     * @brief Return a read-write reference to the element container.
      *
-     * @return A reference to the element.
+     * @return A reference to the optional container.
      */
-    FrameRateType&
-    getFrameRate ();
+    UseAdaptiveQualityOptional&
+    getUseAdaptiveQuality ();
 
     /**
      * @brief Set the element value.
@@ -835,46 +1525,64 @@ namespace LRCConfig
      * the new value of the element.
      */
     void
-    setFrameRate (const FrameRateType& x);
+    setUseAdaptiveQuality (const UseAdaptiveQualityType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setUseAdaptiveQuality (const UseAdaptiveQualityOptional& x);
 
     //@}
 
     /**
-     * @name IsFrameRateAuto
+     * @name MinJpegQualityPercentage
      *
-     * @brief Accessor and modifier functions for the %IsFrameRateAuto
-     * required element.
+     * @brief Accessor and modifier functions for the %MinJpegQualityPercentage
+     * optional element.
      *
-     * Whether to set the camera's frame rate automatically for the specified
-     * data format. This overrides the manual frame rate set above.
+     * Lowest JPEG compression quality the adaptive controller may select.
+     * Range is from 0-100.
      */
     //@{
 
     /**
      * @brief Element type.
      */
-    typedef ::xml_schema::Boolean IsFrameRateAutoType;
+    typedef ::xml_schema::UnsignedInt MinJpegQualityPercentageType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< MinJpegQualityPercentageType > MinJpegQualityPercentageOptional;
 
     /**
      * @brief Element traits type.
      */
-    typedef ::xsd::cxx::tree::traits< IsFrameRateAutoType, char > IsFrameRateAutoTraits;
+    typedef ::xsd::cxx::tree::traits< MinJpegQualityPercentageType, char > MinJpegQualityPercentageTraits;
 
     /**
-     * @brief Return a read-only (constant) reference to the element.
+     * @brief Return a read-only (constant) reference to the element
+     * container.
      *
-     * @return A constant reference to the element.
+     * @return A constant reference to the optional container.
      */
-    const IsFrameRateAutoType&
-    getIsFrameRateAuto () const;
+    const MinJpegQualityPercentageOptional&
+    getMinJpegQualityPercentage () const;
 
     /**
-     * @brief Return a read-write reference to the element.
+     * @brief Return a read-write reference to the element container.
      *
-     * @return A reference to the element.
+     * @return A reference to the optional container.
      */
-    IsFrameRateAutoType&
-    getIsFrameRateAuto ();
+    MinJpegQualityPercentageOptional&
+    getMinJpegQualityPercentage ();
 
     /**
      * @brief Set the element value.
@@ -885,46 +1593,132 @@ namespace LRCConfig
      * the new value of the element.
      */
     void
-    setIsFrameRateAuto (const IsFrameRateAutoType& x);
+    setMinJpegQualityPercentage (const MinJpegQualityPercentageType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setMinJpegQualityPercentage (const MinJpegQualityPercentageOptional& x);
 
     //@}
 
     /**
-     * @name JpegQualityPercentage
+     * @name MinFrameRate
      *
-     * @brief Accessor and modifier functions for the %JpegQualityPercentage
-     * required element.
+     * @brief Accessor and modifier functions for the %MinFrameRate
+     * optional element.
+     *
+     * Lowest frame rate the adaptive controller may select once the JPEG
+     * quality has reached its minimum.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Float MinFrameRateType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< MinFrameRateType > MinFrameRateOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< MinFrameRateType, char > MinFrameRateTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const MinFrameRateOptional&
+    getMinFrameRate () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    MinFrameRateOptional&
+    getMinFrameRate ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setMinFrameRate (const MinFrameRateType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setMinFrameRate (const MinFrameRateOptional& x);
+
+    //@}
+
+    /**
+     * @name NumberOfBuffers
      *
-     * JPEG compression quality to use. Range is from 0-100. This setting
-     * ignored for uncompressed data formats.
+     * @brief Accessor and modifier functions for the %NumberOfBuffers
+     * optional element.
+     *
+     * Number of image buffers to allocate for grabbing. 0 uses the SDK
+     * default.
      */
     //@{
 
     /**
      * @brief Element type.
      */
-    typedef ::LRCConfig::JpegQualityPercentage JpegQualityPercentageType;
+    typedef ::xml_schema::UnsignedInt NumberOfBuffersType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< NumberOfBuffersType > NumberOfBuffersOptional;
 
     /**
      * @brief Element traits type.
      */
-    typedef ::xsd::cxx::tree::traits< JpegQualityPercentageType, char > JpegQualityPercentageTraits;
+    typedef ::xsd::cxx::tree::traits< NumberOfBuffersType, char > NumberOfBuffersTraits;
 
     /**
-     * @brief Return a read-only (constant) reference to the element.
+     * @brief Return a read-only (constant) reference to the element
+     * container.
      *
-     * @return A constant reference to the element.
+     * @return A constant reference to the optional container.
      */
-    const JpegQualityPercentageType&
-    getJpegQualityPercentage () const;
+    const NumberOfBuffersOptional&
+    getNumberOfBuffers () const;
 
     /**
-     * @brief Return a read-write reference to the element.
+     * @brief Return a read-write reference to the element container.
      *
-     * @return A reference to the element.
+     * @return A reference to the optional container.
      */
-    JpegQualityPercentageType&
-    getJpegQualityPercentage ();
+    NumberOfBuffersOptional&
+    getNumberOfBuffers ();
 
     /**
      * @brief Set the element value.
@@ -935,58 +1729,64 @@ namespace LRCConfig
      * the new value of the element.
      */
     void
-    setJpegQualityPercentage (const JpegQualityPercentageType& x);
+    setNumberOfBuffers (const NumberOfBuffersType& x);
 
     /**
-     * @brief Set the element value without copying.
+     * @brief Set the element value.
      *
-     * @param p A new value to use.
+     * @param x An optional container with the new value to set.
      *
-     * This function will try to use the passed value directly
-     * instead of making a copy.
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
      */
     void
-    setJpegQualityPercentage (::std::unique_ptr< JpegQualityPercentageType > p);
+    setNumberOfBuffers (const NumberOfBuffersOptional& x);
 
     //@}
 
     /**
-     * @name IsJpegQualityAuto
+     * @name AutoTuneBuffers
      *
-     * @brief Accessor and modifier functions for the %IsJpegQualityAuto
-     * required element.
+     * @brief Accessor and modifier functions for the %AutoTuneBuffers
+     * optional element.
      *
-     * Whether to set the JPEG compression quality automatically based on the
-     * percentage of the image buffer to be used for JPEG image data. This
-     * overrides the manual JPEG quality percentage set above.
+     * Whether to measure the worst writer stall at startup and store the
+     * smallest sufficient buffer count for this host and camera model.
      */
     //@{
 
     /**
      * @brief Element type.
      */
-    typedef ::xml_schema::Boolean IsJpegQualityAutoType;
+    typedef ::xml_schema::Boolean AutoTuneBuffersType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< AutoTuneBuffersType > AutoTuneBuffersOptional;
 
     /**
      * @brief Element traits type.
      */
-    typedef ::xsd::cxx::tree::traits< IsJpegQualityAutoType, char > IsJpegQualityAutoTraits;
+    typedef ::xsd::cxx::tree::traits< AutoTuneBuffersType, char > AutoTuneBuffersTraits;
 
     /**
-     * @brief Return a read-only (constant) reference to the element.
+     * @brief Return a read-only (constant) reference to the element
+     * container.
      *
-     * @return A constant reference to the element.
+     * @return A constant reference to the optional container.
      */
-    const IsJpegQualityAutoType&
-    getIsJpegQualityAuto () const;
+    const AutoTuneBuffersOptional&
+    getAutoTuneBuffers () const;
 
     /**
-     * @brief Return a read-write reference to the element.
+     * @brief Return a read-write reference to the element container.
      *
-     * @return A reference to the element.
+     * @return A reference to the optional container.
      */
-    IsJpegQualityAutoType&
-    getIsJpegQualityAuto ();
+    AutoTuneBuffersOptional&
+    getAutoTuneBuffers ();
 
     /**
      * @brief Set the element value.
@@ -997,46 +1797,63 @@ namespace LRCConfig
      * the new value of the element.
      */
     void
-    setIsJpegQualityAuto (const IsJpegQualityAutoType& x);
+    setAutoTuneBuffers (const AutoTuneBuffersType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setAutoTuneBuffers (const AutoTuneBuffersOptional& x);
 
     //@}
 
     /**
-     * @name JpegBufferPercentage
+     * @name BufferTuningSeconds
      *
-     * @brief Accessor and modifier functions for the %JpegBufferPercentage
-     * required element.
+     * @brief Accessor and modifier functions for the %BufferTuningSeconds
+     * optional element.
      *
-     * The percentage of the image buffer to be used for JPEG image data.
-     * Range is from 0-128 where 128 represents the entire image buffer.
+     * Length of the warm-up window used by AutoTuneBuffers, in seconds.
      */
     //@{
 
     /**
      * @brief Element type.
      */
-    typedef ::LRCConfig::JpegBufferPercentage JpegBufferPercentageType;
+    typedef ::xml_schema::UnsignedInt BufferTuningSecondsType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< BufferTuningSecondsType > BufferTuningSecondsOptional;
 
     /**
      * @brief Element traits type.
      */
-    typedef ::xsd::cxx::tree::traits< JpegBufferPercentageType, char > JpegBufferPercentageTraits;
+    typedef ::xsd::cxx::tree::traits< BufferTuningSecondsType, char > BufferTuningSecondsTraits;
 
     /**
-     * @brief Return a read-only (constant) reference to the element.
+     * @brief Return a read-only (constant) reference to the element
+     * container.
      *
-     * @return A constant reference to the element.
+     * @return A constant reference to the optional container.
      */
-    const JpegBufferPercentageType&
-    getJpegBufferPercentage () const;
+    const BufferTuningSecondsOptional&
+    getBufferTuningSeconds () const;
 
     /**
-     * @brief Return a read-write reference to the element.
+     * @brief Return a read-write reference to the element container.
      *
-     * @return A reference to the element.
+     * @return A reference to the optional container.
      */
-    JpegBufferPercentageType&
-    getJpegBufferPercentage ();
+    BufferTuningSecondsOptional&
+    getBufferTuningSeconds ();
 
     /**
      * @brief Set the element value.
@@ -1047,18 +1864,19 @@ namespace LRCConfig
      * the new value of the element.
      */
     void
-    setJpegBufferPercentage (const JpegBufferPercentageType& x);
+    setBufferTuningSeconds (const BufferTuningSecondsType& x);
 
     /**
-     * @brief Set the element value without copying.
+     * @brief Set the element value.
      *
-     * @param p A new value to use.
+     * @param x An optional container with the new value to set.
      *
-     * This function will try to use the passed value directly
-     * instead of making a copy.
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
      */
     void
-    setJpegBufferPercentage (::std::unique_ptr< JpegBufferPercentageType > p);
+    setBufferTuningSeconds (const BufferTuningSecondsOptional& x);
 
     //@}
 
@@ -1154,6 +1972,12 @@ namespace LRCConfig
     ::xsd::cxx::tree::one< JpegQualityPercentageType > JpegQualityPercentage_;
     ::xsd::cxx::tree::one< IsJpegQualityAutoType > IsJpegQualityAuto_;
     ::xsd::cxx::tree::one< JpegBufferPercentageType > JpegBufferPercentage_;
+    UseAdaptiveQualityOptional UseAdaptiveQuality_;
+    MinJpegQualityPercentageOptional MinJpegQualityPercentage_;
+    MinFrameRateOptional MinFrameRate_;
+    NumberOfBuffersOptional NumberOfBuffers_;
+    AutoTuneBuffersOptional AutoTuneBuffers_;
+    BufferTuningSecondsOptional BufferTuningSeconds_;
 
     //@endcond
   };
@@ -1586,6 +2410,279 @@ namespace LRCConfig
 
     //@}
 
+    /**
+     * @name WriterQueueLength
+     *
+     * @brief Accessor and modifier functions for the %WriterQueueLength
+     * optional element.
+     *
+     * Maximum number of acquired images waiting to be written to disk.
+     * Images acquired while the queue is full are dropped.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::UnsignedInt WriterQueueLengthType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< WriterQueueLengthType > WriterQueueLengthOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< WriterQueueLengthType, char > WriterQueueLengthTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const WriterQueueLengthOptional&
+    getWriterQueueLength () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    WriterQueueLengthOptional&
+    getWriterQueueLength ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setWriterQueueLength (const WriterQueueLengthType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setWriterQueueLength (const WriterQueueLengthOptional& x);
+
+    //@}
+
+    /**
+     * @name ManagedWriteback
+     *
+     * @brief Accessor and modifier functions for the %ManagedWriteback
+     * optional element.
+     *
+     * Whether to flush the stream to disk in fixed-size chunks as it is
+     * written and drop it from the page cache, instead of leaving writeback
+     * to the kernel.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Boolean ManagedWritebackType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< ManagedWritebackType > ManagedWritebackOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< ManagedWritebackType, char > ManagedWritebackTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const ManagedWritebackOptional&
+    getManagedWriteback () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    ManagedWritebackOptional&
+    getManagedWriteback ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setManagedWriteback (const ManagedWritebackType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setManagedWriteback (const ManagedWritebackOptional& x);
+
+    //@}
+
+    /**
+     * @name WritebackChunkMB
+     *
+     * @brief Accessor and modifier functions for the %WritebackChunkMB
+     * optional element.
+     *
+     * Size of the chunks flushed by ManagedWriteback, in MB.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::UnsignedInt WritebackChunkMBType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< WritebackChunkMBType > WritebackChunkMBOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< WritebackChunkMBType, char > WritebackChunkMBTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const WritebackChunkMBOptional&
+    getWritebackChunkMB () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    WritebackChunkMBOptional&
+    getWritebackChunkMB ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setWritebackChunkMB (const WritebackChunkMBType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setWritebackChunkMB (const WritebackChunkMBOptional& x);
+
+    //@}
+
+    /**
+     * @name CheckpointIntervalSeconds
+     *
+     * @brief Accessor and modifier functions for the %CheckpointIntervalSeconds
+     * optional element.
+     *
+     * Interval between durable checkpoints of the stream, in seconds. Each
+     * checkpoint flushes the stream to disk and updates a journal that
+     * ladybugStreamRecover uses after a power loss. 0 disables checkpoints.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::UnsignedInt CheckpointIntervalSecondsType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< CheckpointIntervalSecondsType > CheckpointIntervalSecondsOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< CheckpointIntervalSecondsType, char > CheckpointIntervalSecondsTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const CheckpointIntervalSecondsOptional&
+    getCheckpointIntervalSeconds () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    CheckpointIntervalSecondsOptional&
+    getCheckpointIntervalSeconds ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    setCheckpointIntervalSeconds (const CheckpointIntervalSecondsType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    setCheckpointIntervalSeconds (const CheckpointIntervalSecondsOptional& x);
+
+    //@}
+
     /**
      * @name Constructors
      */
@@ -1668,6 +2765,10 @@ namespace LRCConfig
 
     protected:
     ::xsd::cxx::tree::one< DestinationDirectoryType > DestinationDirectory_;
+    WriterQueueLengthOptional WriterQueueLength_;
+    ManagedWritebackOptional ManagedWriteback_;
+    WritebackChunkMBOptional WritebackChunkMB_;
+    CheckpointIntervalSecondsOptional CheckpointIntervalSeconds_;
 
     //@endcond
   };
@@ -2859,13 +3960,6 @@ namespace LRCConfig
   void
   operator<< (xercesc::DOMElement&, const General&);
 
-  void
-  operator<< (xercesc::DOMAttr&, const General&);
-
-  void
-  operator<< (::xml_schema::ListStream&,
-              const General&);
-
   void
   operator<< (xercesc::DOMElement&, const Camera&);
 
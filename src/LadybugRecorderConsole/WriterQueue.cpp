@@ -0,0 +1,171 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+#include "stdafx.h"
+#include "WriterQueue.h"
+#include "RealtimeSupport.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+WriterQueue::WriterQueue( ImageGrabber& grabber, ImageRecorder& recorder, size_t capacity, const GeneralConfiguration& generalConfig ) :
+m_grabber(grabber),
+m_recorder(recorder),
+m_capacity(capacity > 0 ? capacity : 1),
+m_generalConfig(generalConfig),
+m_stopRequested(false),
+m_mbWrittenAtWindowStart(0.0),
+m_windowStart(std::chrono::steady_clock::now())
+{
+    m_statistics.capacity = m_capacity;
+}
+
+WriterQueue::~WriterQueue()
+{
+    Stop();
+}
+
+void WriterQueue::Start()
+{
+    m_stopRequested = false;
+    m_windowStart = std::chrono::steady_clock::now();
+    m_thread = std::thread(&WriterQueue::WriterThread, this);
+}
+
+void WriterQueue::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_queueNotEmpty.notify_one();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+bool WriterQueue::Push( const LadybugImage& image )
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue.size() >= m_capacity)
+        {
+            m_statistics.maxQueueLength = m_capacity;
+            return false;
+        }
+
+        QueuedImage queuedImage;
+        queuedImage.image = image;
+        queuedImage.acquired = std::chrono::steady_clock::now();
+        m_queue.push_back(queuedImage);
+        m_statistics.maxQueueLength = std::max(m_statistics.maxQueueLength, m_queue.size());
+    }
+    m_queueNotEmpty.notify_one();
+
+    return true;
+}
+
+WriterStatistics WriterQueue::GetStatistics()
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const double elapsedSeconds = std::chrono::duration<double>(now - m_windowStart).count();
+    m_statistics.mbPerSecond = elapsedSeconds > 0.0 ? (m_statistics.mbWritten - m_mbWrittenAtWindowStart) / elapsedSeconds : 0.0;
+    m_statistics.queueLength = m_queue.size();
+
+    const WriterStatistics current = m_statistics;
+
+    m_mbWrittenAtWindowStart = m_statistics.mbWritten;
+    m_windowStart = now;
+    m_statistics.maxQueueLength = m_queue.size();
+    m_statistics.maxBufferHoldSeconds = 0.0;
+
+    return current;
+}
+
+void WriterQueue::WriterThread()
+{
+    // The thread inherits the realtime policy and affinity of the grab
+    // thread that created it. Disk writes must not compete with acquisition.
+    std::string errorMessage;
+    if (m_generalConfig.realtimePriority > 0 && !realtime::setCurrentThreadNormalPriority(errorMessage))
+    {
+        cerr << "Warning: Unable to reset writer thread priority (" << errorMessage << ")" << endl;
+    }
+
+    if ((m_generalConfig.writerThreadCpu >= 0 || m_generalConfig.grabThreadCpu >= 0) &&
+        !realtime::pinCurrentThreadToCpu(m_generalConfig.writerThreadCpu, errorMessage))
+    {
+        cerr << "Warning: Unable to set writer thread CPU (" << errorMessage << ")" << endl;
+    }
+
+    while (true)
+    {
+        QueuedImage queuedImage;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queueNotEmpty.wait(lock, [this] { return m_stopRequested || !m_queue.empty(); });
+
+            // Drain the queue before honouring a stop request
+            if (m_queue.empty())
+            {
+                break;
+            }
+
+            queuedImage = m_queue.front();
+        }
+
+        const LadybugImage& image = queuedImage.image;
+
+        double mbWritten = 0.0;
+        unsigned long imagesWritten = 0;
+        const LadybugError writeError = m_recorder.Write(image, mbWritten, imagesWritten);
+
+        m_grabber.Unlock(image.uiBufferIndex);
+
+        const double holdSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - queuedImage.acquired).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.pop_front();
+            m_statistics.maxBufferHoldSeconds = std::max(m_statistics.maxBufferHoldSeconds, holdSeconds);
+
+            if (writeError == LADYBUG_OK)
+            {
+                m_statistics.mbWritten = mbWritten;
+                m_statistics.imagesWritten = imagesWritten;
+            }
+            else
+            {
+                m_statistics.writeErrors++;
+            }
+        }
+
+        if (writeError != LADYBUG_OK)
+        {
+            cerr << "Failed to write image to stream (" << ladybugErrorToString(writeError) << ")" << endl;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+#ifndef WriterQueue_h__
+#define WriterQueue_h__
+
+#include "ImageGrabber.h"
+#include "ImageRecorder.h"
+
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+struct WriterStatistics
+{
+    unsigned long imagesWritten;
+    double mbWritten;
+    unsigned long writeErrors;
+
+    // Sustained write throughput since the previous call to GetStatistics()
+    double mbPerSecond;
+
+    // Queue occupancy, current and highest since the previous call to GetStatistics()
+    size_t queueLength;
+    size_t maxQueueLength;
+    size_t capacity;
+
+    // Longest time an image buffer stayed locked between acquisition and
+    // the end of its write, since the previous call to GetStatistics()
+    double maxBufferHoldSeconds;
+
+    WriterStatistics()
+    {
+        imagesWritten = 0;
+        mbWritten = 0.0;
+        writeErrors = 0;
+        mbPerSecond = 0.0;
+        queueLength = 0;
+        maxQueueLength = 0;
+        capacity = 0;
+        maxBufferHoldSeconds = 0.0;
+    }
+};
+
+/**
+ * Decouples acquisition from disk writes. Acquired images stay locked in
+ * the grabber's buffers while they wait in the queue; the writer thread
+ * writes them to the stream and unlocks them afterwards.
+ */
+class WriterQueue
+{
+public:
+    WriterQueue(ImageGrabber& grabber, ImageRecorder& recorder, size_t capacity, const GeneralConfiguration& generalConfig);
+    ~WriterQueue();
+
+    void Start();
+
+    /** Writes out all queued images and stops the writer thread. */
+    void Stop();
+
+    /**
+     * Queues an acquired image for writing. Returns false if the queue is
+     * full, in which case the caller still owns the image buffer.
+     */
+    bool Push(const LadybugImage& image);
+
+    size_t GetCapacity() const { return m_capacity; }
+
+    /** Returns the current statistics and starts a new measurement window. */
+    WriterStatistics GetStatistics();
+
+private:
+    void WriterThread();
+
+    ImageGrabber& m_grabber;
+    ImageRecorder& m_recorder;
+    const size_t m_capacity;
+    const GeneralConfiguration m_generalConfig;
+
+    struct QueuedImage
+    {
+        LadybugImage image;
+        std::chrono::steady_clock::time_point acquired;
+    };
+
+    std::deque<QueuedImage> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_queueNotEmpty;
+    std::thread m_thread;
+    bool m_stopRequested;
+
+    WriterStatistics m_statistics;
+    double m_mbWrittenAtWindowStart;
+    std::chrono::steady_clock::time_point m_windowStart;
+};
+
+#endif // WriterQueue_h__
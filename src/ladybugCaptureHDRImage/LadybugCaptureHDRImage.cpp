@@ -32,7 +32,8 @@
 //
 // captureImages() - This function captures images directly from a Ladybug camera.
 //
-// processImages() - This function actually computes the panoramic images
+// processImages() - This function merges the images into one high dynamic
+//    range panorama
 //
 //
 // The Ladybug has a bank of 4 gain and shutter registers in addition to its 
@@ -46,39 +47,26 @@
 // INI_FILE_NAME. If you find the shutter and gain settings are not 
 // appropriate, change the data in this file. 
 //
-// Once these images have been captured, the program process the images and
-// outputs a configuration file containing exposure data suitable for input
-// into a program such as 'pfstools' and 'pfscalibration'.
+// Once these images have been captured, the program color processes them
+// to 16 bit images with gamma off, and merges the 4 exposures of each camera
+// into one radiance image, using the shutter and gain recorded with each
+// image (see HdrMerger). The merged images are stitched once, and the 
+// panorama is written as:
 //
-// Having captured the images, the user should then run the 'pfsinhdrgen' program in
-// the image directory with a command line similar to the following:
+//    <serial>_hdr.hdr   Radiance RGBE
+//    <serial>_hdr.exr   OpenEXR, 32 bit float
+//    <serial>_hdr.jpg   tone mapped for display (see ToneMapper)
 //
-//    pfsinhdrgen  HDRDescription.hdrgen | pfshdrcalibrate -v | pfsout output.hdr
+// The .hdr and .exr files can be viewed with pfsview, Photoshop and most
+// other HDR tools.
 //
-// Where 'HDRDescription.hdrgen' is the name of the configuration file output by this
-// program and 'output.hdr' is the name of the output image.
+// Run as 'LadybugCaptureHDRImage SECONDS STREAM_NAME' to record a stream in
+// HDR mode for that long instead. Every frame is tagged with its bracket
+// and bracket sequence in a bracket file (STREAM_NAME.hdrb, see 
+// HdrBrackets.h) next to the stream, which also keeps the shutter and gain
+// of each bracket. ladybugProcessHDRStream merges and stitches the 
+// sequences of such a stream.
 //
-// Then the output file can be viewed using pfsview ( or pfsv)
-//
-//    pfsv output.hdr
-//
-// You can also make HDR image out of 4 output images using Adobe Photoshop CS3, easyHDR, etc.
-// In this case, you don't need to provide additional exposure data.
-//
-// ----------------------------------------------------------------------------
-// 'pfstools' is available at:
-//
-//   http://www.mpi-inf.mpg.de/resources/pfstools/
-//
-// 'pfscalibration' is available at:
-//
-//   http://www.mpi-inf.mpg.de/resources/hdr/calibration/pfs.html
-//
-// You will also need Cygwin to use these tools. Cygwin is available at:
-//
-//   http://www.cygwin.com/
-//
-// ----------------------------------------------------------------------------
 
 //=============================================================================
 // System Includes
@@ -93,6 +81,10 @@
 #include <stdlib.h> 
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
 
 //=============================================================================
 // PGR Includes
@@ -100,6 +92,16 @@
 #include "ladybug.h"
 #include "ladybuggeom.h"
 #include "ladybugrenderer.h"
+#include "ladybugstream.h"
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CameraClock.h"
+#include "HdrBrackets.h"
+#include "HdrFile.h"
+#include "HdrMerge.h"
+#include "ToneMapper.h"
 
 //=============================================================================
 // Macro Definitions
@@ -140,7 +142,8 @@
 
 #define BUS_INDEX	      0		  /* The index of Ladybug camera on the IEEE-1394 bus. This has to be 0 if you have only one camera */
 #define IMAGES_TO_CAPTURE     4          /*Number of HDR settings available */
-#define HDR_IMAGE_FILE        "HDRDescription.hdrgen" /* HDR Descriptor file */
+#define HDR_JPEG_QUALITY      95         /*Quality of the tone mapped panorama */
+#define RECORD_STATUS_SECONDS 5          /*Interval of the status lines while recording */
 
 // Define the output image type. It may be LADYBUG_PANORAMIC or LADYBUG_DOME
 #define OUTPUT_IMAGE_TYPE	LADYBUG_PANORAMIC
@@ -461,13 +464,13 @@ enableHDR( bool enable)
 // captureImages()
 //
 // This function acquires images from Ladybug camera and then converts them
-// to RGBA buffers.
+// to 16 bit BGRU buffers.
 //
 //=============================================================================
 int
 captureImages(
               LadybugImageInfo* parImageInfo,
-              unsigned char*    arpColorImageData[IMAGES_TO_CAPTURE][LADYBUG_NUM_CAMERAS])
+              unsigned short*   arpColorImageData[IMAGES_TO_CAPTURE][LADYBUG_NUM_CAMERAS])
 {
     LadybugError   error;
     LadybugImage   images[IMAGES_TO_CAPTURE];
@@ -506,7 +509,8 @@ captureImages(
         // for each buffer.
         //
         ladybugSetAlphaMasking( context, true );
-        error = ladybugConvertImage(context, &images[nImage], arpColorImageData[nImage]);
+        error = ladybugConvertImage(
+            context, &images[nImage], reinterpret_cast<unsigned char**>(arpColorImageData[nImage]), LADYBUG_BGRU16);
         parImageInfo[nImage] = images[nImage].imageInfo;
         printf("Sequence-ID:%d \n", parImageInfo[nImage].ulSequenceId );
         CHECK_ERROR(error);
@@ -517,123 +521,282 @@ captureImages(
     return 0;
 }
 
+//=============================================================================
+//
+// getExposure()
+//
+// Description:
+//   This function returns the exposure of an image, as its shutter in ms 
+//   times its gain as a factor.
+//
+//=============================================================================
+int
+getExposure( const LadybugImageInfo& imageInfo, double& dExposure )
+{
+    LadybugError error;
+
+    // obtain the actual absolute value from the register value in the image
+    error = ladybugSetProperty( context, LADYBUG_SHUTTER, imageInfo.ulShutter[ 0] & 0xfff, 0, false);
+    CHECK_ERROR(error);
+    error = ladybugSetProperty( context, LADYBUG_GAIN, imageInfo.arulGainAdjust[ 0] & 0xfff, 0, false);
+    CHECK_ERROR(error);
+
+    float fShutter = 0.0f;
+    float fGain = 0.0f;
+    error = ladybugGetAbsProperty( context, LADYBUG_SHUTTER, &fShutter);
+    CHECK_ERROR(error);
+    error = ladybugGetAbsProperty( context, LADYBUG_GAIN, &fGain);
+    CHECK_ERROR(error);
+
+    printf( "Actual shutter: %3.3lf ms, gain:%3.3lf dB\n", fShutter, fGain);
+    dExposure = fShutter * pow( 10.0, fGain / 20.0 );
+    return 0;
+}
+
 //=============================================================================
 //
 // processImages()
 //
 // Description:
-//   This function does the image stitching and blending and then outputs a 
-//   series of the stitched images to disk and the necessary information to 
-//   create a high dynamic range image.
+//   This function merges the exposures of each camera into radiance, 
+//   stitches the merged images into one panorama and writes it to disk as 
+//   HDR files and as a tone mapped JPEG.
 //
 //=============================================================================
 int
 processImages(
               LadybugImageInfo* parImageInfo,
-              unsigned char*    arpColorImageData[IMAGES_TO_CAPTURE][LADYBUG_NUM_CAMERAS])
+              unsigned short*   arpColorImageData[IMAGES_TO_CAPTURE][LADYBUG_NUM_CAMERAS])
 {
     LadybugError error;
     LadybugProcessedImage processedImage;
     char szOutputFileName[256] = {0};
-    FILE* pHDRDescFile = NULL;
+    std::string errorMessage;
+
+    //
+    // Merge the exposures of every camera
+    //
+    std::vector<HdrMerger::Exposure> exposures( IMAGES_TO_CAPTURE );
+    for (int i = 0; i < IMAGES_TO_CAPTURE; i++)
+    {
+        if ( getExposure( parImageInfo[ i], exposures[ i].exposure ))
+        {
+            return 1;
+        }
+        for (int nCamera = 0; nCamera < LADYBUG_NUM_CAMERAS; nCamera++)
+        {
+            exposures[ i].textures[ nCamera] = arpColorImageData[ i][ nCamera];
+        }
+    }
 
-    double dRealGainValue = 0.0, dRealShutter = 0.0;
+    HdrMerger merger;
+    std::vector<unsigned short> mergedData( (size_t)LADYBUG_NUM_CAMERAS * textureRows * textureCols * 4 );
+    unsigned short* arpMergedImageData[LADYBUG_NUM_CAMERAS];
+    for (int nCamera = 0; nCamera < LADYBUG_NUM_CAMERAS; nCamera++)
+    {
+        arpMergedImageData[ nCamera] = &mergedData[ (size_t)nCamera * textureRows * textureCols * 4 ];
+    }
 
-    // Open the hdr description file
-    printf("Open HDR description file...\n");
-    pHDRDescFile = fopen(HDR_IMAGE_FILE,"w");
-    if( pHDRDescFile == NULL )
+    printf("Merge %d exposures on %u threads...\n", IMAGES_TO_CAPTURE, merger.getNumThreads());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if ( !merger.merge( exposures, textureCols, textureRows, arpMergedImageData ))
     {
-        printf("Failed to open HDR description file.\n");
-        printf("This may be caused by permission issues with the current directory. Try moving the program and configuration file to a location that does not require admin privilege.\n");
+        printf("Failed to merge the exposures.\n");
         return 1;
     }
+    printf("Merged %.1f stops in %.1f ms\n", merger.getRangeStops(), 
+        std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count());
 
+    //
+    // Stitch the merged images
+    //
     printf("Set off-screen panoramic image size:%dx%d image...\n", 
         PANORAMIC_IMAGE_COLS, PANORAMIC_IMAGE_ROWS );
     error = ladybugSetOffScreenImageSize(
         context, OUTPUT_IMAGE_TYPE,  
         PANORAMIC_IMAGE_COLS, PANORAMIC_IMAGE_ROWS );
-    if (error != LADYBUG_OK)
+    CHECK_ERROR(error);
+
+    error = ladybugSetPanoramicMappingType( context, LADYBUG_MAP_RADIAL);
+    CHECK_ERROR(error);
+
+    printf("Update merged images for rendering...\n");
+    error = ladybugUpdateTextures( 
+        context, 
+        LADYBUG_NUM_CAMERAS,
+        const_cast<const unsigned char**>(reinterpret_cast<unsigned char**>(arpMergedImageData)),
+        LADYBUG_BGRU16);
+    CHECK_ERROR(error);
+
+    printf("Render and get off-screen stitched image...\n");
+    error = ladybugRenderOffScreenImage(
+        context, 
+        OUTPUT_IMAGE_TYPE, 
+        LADYBUG_BGR16,
+        &processedImage);
+    CHECK_ERROR(error);
+
+    const size_t pixelCount = (size_t)processedImage.uiCols * processedImage.uiRows;
+    std::vector<float> radiance( pixelCount * 3 );
+    merger.decode( reinterpret_cast<const unsigned short*>(processedImage.pData), pixelCount, &radiance[0] );
+
+    //
+    // Write the HDR files and the tone mapped image
+    //
+    sprintf( szOutputFileName, "%u_hdr.hdr", cameraInfo.serialHead );
+    printf("Write image %s to disk...\n", szOutputFileName);
+    if ( !hdrFile::writeRadiance( szOutputFileName, &radiance[0], processedImage.uiCols, processedImage.uiRows, errorMessage ))
     {
-        fclose(pHDRDescFile);
-        CHECK_ERROR(error);
+        printf("%s\n", errorMessage.c_str());
+        printf("This may be caused by permission issues with the current directory. Try moving the program and configuration file to a location that does not require admin privilege.\n");
+        return 1;
     }
-    
 
-    error = ladybugSetPanoramicMappingType( context, LADYBUG_MAP_RADIAL);
+    sprintf( szOutputFileName, "%u_hdr.exr", cameraInfo.serialHead );
+    printf("Write image %s to disk...\n", szOutputFileName);
+    if ( !hdrFile::writeOpenExr( szOutputFileName, &radiance[0], processedImage.uiCols, processedImage.uiRows, errorMessage ))
+    {
+        printf("%s\n", errorMessage.c_str());
+        return 1;
+    }
+
+    ToneMapper toneMapper;
+    std::vector<unsigned char> toneMapped( pixelCount * 3 );
+    start = std::chrono::steady_clock::now();
+    toneMapper.map( &radiance[0], pixelCount, ToneMapper::getDefaultSettings(), &toneMapped[0] );
+    printf("Tone mapped in %.1f ms\n", 
+        std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count());
+
+    LadybugProcessedImage toneMappedImage;
+    memset( &toneMappedImage, 0, sizeof( toneMappedImage ) );
+    toneMappedImage.uiCols = processedImage.uiCols;
+    toneMappedImage.uiRows = processedImage.uiRows;
+    toneMappedImage.pData = &toneMapped[0];
+    toneMappedImage.pixelFormat = LADYBUG_BGR;
+
+    sprintf( szOutputFileName, "%u_hdr.jpg", cameraInfo.serialHead );
+    printf("Write image %s to disk...\n", szOutputFileName);
+    error = ladybugSetImageSavingJpegQuality( context, HDR_JPEG_QUALITY);
+    error = ladybugSaveImage( context, &toneMappedImage, szOutputFileName, LADYBUG_FILEFORMAT_JPG);
     CHECK_ERROR(error);
 
+    // Release the off-screen image rendering resources. 
+    printf("Release off-screen image rendering resources...\n");
+    error = ladybugReleaseOffScreenImage( context, OUTPUT_IMAGE_TYPE );
+    CHECK_ERROR(error);
+
+    return 0;
+}
+
+//=============================================================================
+//
+// recordStream()
+//
+// Description:
+//   This function records the images of the running camera to a stream for
+//   dSeconds and tags every image with its bracket in a bracket file next
+//   to the stream.
+//
+//=============================================================================
+int
+recordStream( double dSeconds, const char* pszStreamName )
+{
+    LadybugError error;
+    LadybugStreamContext streamContext = NULL;
+    char pszStreamNameOpened[256] = {0};
+
+    std::vector<HdrBracketLevel> levels( IMAGES_TO_CAPTURE );
     for (int i = 0; i < IMAGES_TO_CAPTURE; i++)
     {
-        // Get the panoramic image.
-        printf("Update image %d for rendering...\n", i);
-        error = ladybugUpdateTextures( 
-            context, 
-            LADYBUG_NUM_CAMERAS,
-            const_cast<const unsigned char**>(&(arpColorImageData[i][0])));
-        CHECK_ERROR(error);
+        levels[ i].shutterRegister = (unsigned int)lShutterValue[ i];
+        levels[ i].gainRegister = (unsigned int)lGainValue[ i];
+        levels[ i].shutterMs = fShutterValue[ i];
+        levels[ i].gainDb = fGainValue[ i];
+    }
 
-        printf("Render and get off-screen stitched image %d...\n", i);
-        error = ladybugRenderOffScreenImage(
-            context, 
-            OUTPUT_IMAGE_TYPE, 
-            LADYBUG_BGR,
-            &processedImage);
-        CHECK_ERROR(error);
+    HdrBracketTagger tagger;
+    tagger.setLevels( levels );
+    if ( tagger.getLevels().size() < levels.size() )
+    {
+        printf("Warning: some brackets have the same shutter and gain. They are recorded as one.\n");
+    }
 
-        sprintf( szOutputFileName, "%u_image_hdr%d.jpg", cameraInfo.serialHead, i );
-        printf("Write image %s to disk...\n",szOutputFileName);
+    error = ladybugCreateStreamContext( &streamContext );
+    CHECK_ERROR(error);
 
-        error = ladybugSetImageSavingJpegQuality( context, 95);
-        error = ladybugSaveImage( context, &processedImage, szOutputFileName, LADYBUG_FILEFORMAT_JPG);
+    error = ladybugInitializeStreamForWriting( 
+        streamContext, pszStreamName, context, pszStreamNameOpened, true );
+    if ( error != LADYBUG_OK )
+    {
+        ladybugDestroyStreamContext( &streamContext );
         CHECK_ERROR(error);
+    }
+    printf("Recording to %s for %.1f seconds...\n", pszStreamNameOpened, dSeconds );
+
+    CameraClock cameraClock;
+    std::vector<HdrBracketEntry> entries;
+    double dMBWritten = 0.0;
+    unsigned long ulImagesWritten = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double dNextStatus = RECORD_STATUS_SECONDS;
+    double dElapsed = 0.0;
+    while ( dElapsed < dSeconds )
+    {
+        LadybugImage image;
+        error = ladybugLockNext( context, &image );
+        if ( error != LADYBUG_OK )
+        {
+            break;
+        }
 
-        // obtain the actual absolute value from the register value in the image
-        dRealShutter = 0.0;
-        dRealGainValue = 0.0;
-
-        error = ladybugSetProperty( context, LADYBUG_SHUTTER, parImageInfo[ i].ulShutter[ 0] & 0xfff, 0, false);
-        CHECK_ERROR(error);
-        error = ladybugSetProperty( context, LADYBUG_GAIN, parImageInfo[ i].arulGainAdjust[ 0] & 0xfff, 0, false);
-        CHECK_ERROR(error);
+        const HdrBracketEntry entry = tagger.tag( image.imageInfo, cameraClock.addImage( image ) );
+        error = ladybugWriteImageToStream( streamContext, &image, &dMBWritten, &ulImagesWritten );
+        ladybugUnlock( context, image.uiBufferIndex );
+        if ( error != LADYBUG_OK )
+        {
+            break;
+        }
+        entries.push_back( entry );
 
-        float fAbsValue;
-        error = ladybugGetAbsProperty( context, LADYBUG_SHUTTER, &fAbsValue);
-        CHECK_ERROR(error);
-        if ( error == LADYBUG_OK)
-            dRealShutter = fAbsValue;
+        dElapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        if ( dElapsed >= dNextStatus )
+        {
+            printf("%.0f s: %lu images, %.1f MB, %u sequences\n", 
+                dElapsed, ulImagesWritten, dMBWritten, tagger.getNumSequences() );
+            dNextStatus += RECORD_STATUS_SECONDS;
+        }
+    }
 
-        error = ladybugGetAbsProperty( context, LADYBUG_GAIN, &fAbsValue);
-        CHECK_ERROR(error);
-        if ( error == LADYBUG_OK)
-            dRealGainValue = fAbsValue;
+    if ( error != LADYBUG_OK )
+    {
+        printf("Recording stopped - %s\n", ladybugErrorToString( error ) );
+    }
 
-        printf( "Actual shutter: %3.3lf ms, gain:%3.3lf dB\n", dRealShutter, dRealGainValue);
+    ladybugStopStream( streamContext );
+    ladybugDestroyStreamContext( &streamContext );
 
-        // output pointers to image files in format accepted by pfstools
-        // (imageFileName.ppm)(inverse of exposure time)(aperture)(gain)(neutral density)
-        fprintf(pHDRDescFile,
-            "%s %10.3lf 8.0 %10.3lf 0.0\n", 
-            szOutputFileName, 
-            1000.0 / dRealShutter, 
-            dRealGainValue);
+    // The images written so far are tagged even if recording failed
+    std::string errorMessage;
+    const std::string bracketPath = hdrBrackets::getBracketPath( pszStreamNameOpened );
+    if ( !hdrBrackets::write( bracketPath, tagger.getLevels(), entries, errorMessage ))
+    {
+        printf("%s\n", errorMessage.c_str());
+        return 1;
     }
 
-    // Release the off-screen image rendering resources. 
-    printf("Release off-screen image rendering resources...\n");
-    error = ladybugReleaseOffScreenImage( context, OUTPUT_IMAGE_TYPE );
-    CHECK_ERROR(error);
+    printf("Recorded %lu images in %u sequences to %s\n", 
+        ulImagesWritten, tagger.getNumSequences(), pszStreamNameOpened );
+    printf("Bracket file %s: %u images missing from their sequence, %u of no known bracket\n", 
+        bracketPath.c_str(), tagger.getNumMissing(), tagger.getNumUnknown() );
 
-    fclose(pHDRDescFile); 
-    return 0;
+    return error == LADYBUG_OK ? 0 : 1;
 }
 
 int 
-main( int /* argc */, char* /* argv[] */ )
+main( int argc, char* argv[] )
 {
     LadybugError      error = LADYBUG_FAILED;
-    unsigned char*    arpBGRUImageData[IMAGES_TO_CAPTURE][LADYBUG_NUM_CAMERAS];
+    unsigned short*   arpBGRUImageData[IMAGES_TO_CAPTURE][LADYBUG_NUM_CAMERAS];
     LadybugImageInfo  arImageInfo[IMAGES_TO_CAPTURE];
     LadybugImage      image;
 
@@ -644,6 +807,20 @@ main( int /* argc */, char* /* argv[] */ )
     bool bAutoShutterFlag;
     bool bAutoGainFlag;
 
+    // Record a stream instead of a single panorama?
+    double dRecordSeconds = 0.0;
+    const char* pszStreamName = NULL;
+    if ( argc == 3 )
+    {
+        dRecordSeconds = atof( argv[ 1] );
+        pszStreamName = argv[ 2];
+    }
+    if ( argc == 2 || argc > 3 || ( pszStreamName != NULL && dRecordSeconds <= 0.0 ))
+    {
+        printf("Usage: %s [SECONDS STREAM_NAME]\n", argv[ 0] );
+        return 1;
+    }
+
     // Create the ladybug context
     printf("Create context...\n");
     error = ladybugCreateContext( &context );
@@ -704,10 +881,13 @@ main( int /* argc */, char* /* argv[] */ )
 
     // Start streaming
 
+    // 12 bit images where the camera has them, for the darks of the merge
     printf("Starting camera...\n");
+    const bool b12Bit = 
+        cameraInfo.deviceType == LADYBUG_DEVICE_LADYBUG5 || cameraInfo.deviceType == LADYBUG_DEVICE_LADYBUG5P;
     error = ::ladybugStartLockNext(
         context,
-        LADYBUG_DATAFORMAT_COLOR_SEP_JPEG8);
+        b12Bit ? LADYBUG_DATAFORMAT_COLOR_SEP_JPEG12 : LADYBUG_DATAFORMAT_COLOR_SEP_JPEG8);
     CHECK_ERROR(error);
 
     if (cameraInfo.deviceType == LADYBUG_DEVICE_LADYBUG3)
@@ -737,6 +917,24 @@ main( int /* argc */, char* /* argv[] */ )
     }
     CHECK_ERROR(error);
 
+    if ( pszStreamName != NULL )
+    {
+        const int iResult = recordStream( dRecordSeconds, pszStreamName );
+
+        printf("Stop camera...\n");
+        ladybugStop( context );
+        enableHDR( false);
+
+        printf("Restoring the previous master values...\n");
+        ladybugSetProperty( context, LADYBUG_SHUTTER,
+            ulCurretMasterShutter, lDontCare, bAutoShutterFlag );
+        ladybugSetProperty( context, LADYBUG_GAIN,
+            ulCurretMasterGain, lDontCare, bAutoGainFlag );
+
+        ladybugDestroyContext( &context );
+        return iResult;
+    }
+
     // Determine texture size based on the captured image
     textureRows = image.uiRows;
     textureCols = image.uiCols;
@@ -747,7 +945,7 @@ main( int /* argc */, char* /* argv[] */ )
         for(int nCamera = 0; nCamera<LADYBUG_NUM_CAMERAS;nCamera++)
         {
             arpBGRUImageData[nImage][nCamera] = 
-                new unsigned char[textureRows * textureCols * 4 ];
+                new unsigned short[textureRows * textureCols * 4 ];
         }
     }
 
@@ -805,8 +1003,13 @@ main( int /* argc */, char* /* argv[] */ )
     error  = ladybugDestroyContext( &context );
     CHECK_ERROR( error );
 
-    // Display the exit message
-    printf("You can now use a utility like 'pfstools' to create an HDR image.\n");
+    for(int nImage = 0; nImage< IMAGES_TO_CAPTURE; nImage++)
+    {
+        for(int nCamera = 0; nCamera<LADYBUG_NUM_CAMERAS;nCamera++)
+        {
+            delete [] arpBGRUImageData[nImage][nCamera];
+        }
+    }
 
     return 0;
 }
@@ -0,0 +1,125 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cerrno>
+#include <cstdio>
+
+#include <zlib.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "BinaryFile.h"
+
+namespace
+{
+    std::string describeErrno( const std::string& what, int errorNumber )
+    {
+        return what + ": " + strerror( errorNumber );
+    }
+
+#ifndef _WIN32
+    std::string getDirectory( const std::string& path )
+    {
+        const size_t separator = path.find_last_of( '/' );
+        return separator == std::string::npos ? std::string( "." ) : path.substr( 0, separator + 1 );
+    }
+#endif
+}
+
+unsigned int 
+binaryFile::computeCrc( const void* pData, size_t size )
+{
+    // zlib takes the length as a uInt, so feed large buffers in pieces
+    const unsigned char* pBytes = (const unsigned char*)pData;
+    uLong crc = crc32( 0, Z_NULL, 0 );
+    while ( size > 0 )
+    {
+        const uInt chunk = size > 0x40000000 ? 0x40000000 : (uInt)size;
+        crc = crc32( crc, pBytes, chunk );
+        pBytes += chunk;
+        size -= chunk;
+    }
+    return (unsigned int)crc;
+}
+
+bool 
+binaryFile::writeAtomically( 
+    const std::string& path, 
+    const void* pData, 
+    size_t size, 
+    bool isDurable, 
+    std::string& errorMessage )
+{
+    const std::string tempPath = path + ".tmp";
+    FILE* pFile = fopen( tempPath.c_str(), "wb" );
+    if ( pFile == NULL )
+    {
+        errorMessage = describeErrno( "Unable to create " + tempPath, errno );
+        return false;
+    }
+
+    bool isWritten = size == 0 || fwrite( pData, 1, size, pFile ) == size;
+#ifndef _WIN32
+    if ( isWritten && isDurable )
+    {
+        isWritten = fflush( pFile ) == 0 && fdatasync( fileno( pFile ) ) == 0;
+    }
+#endif
+    const int writeErrno = errno;
+    if ( fclose( pFile ) != 0 || !isWritten )
+    {
+        errorMessage = describeErrno( "Unable to write " + tempPath, isWritten ? errno : writeErrno );
+        remove( tempPath.c_str() );
+        return false;
+    }
+
+#ifdef _WIN32
+    remove( path.c_str() );
+#endif
+    if ( rename( tempPath.c_str(), path.c_str() ) != 0 )
+    {
+        errorMessage = describeErrno( "Unable to replace " + path, errno );
+        return false;
+    }
+
+#ifndef _WIN32
+    // Make the rename itself durable
+    if ( isDurable )
+    {
+        const int directoryFd = ::open( getDirectory( path ).c_str(), O_RDONLY );
+        if ( directoryFd >= 0 )
+        {
+            fsync( directoryFd );
+            ::close( directoryFd );
+        }
+    }
+#endif
+
+    return true;
+}
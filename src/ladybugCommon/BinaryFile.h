@@ -0,0 +1,108 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __BINARYFILE_H__
+#define __BINARYFILE_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/**
+ * Helpers shared by the binary files written next to a stream (the GPS 
+ * track, time index, sensor log and HDR brackets) and the stream journal.
+ * Values are stored little endian, floating point as its IEEE bits.
+ */
+namespace binaryFile
+{
+    inline void putU32( unsigned char* p, unsigned int value )
+    {
+        for ( int i = 0; i < 4; i++ )
+        {
+            p[i] = (unsigned char)( value >> ( 8 * i ) );
+        }
+    }
+
+    inline unsigned int getU32( const unsigned char* p )
+    {
+        return p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int)p[3] << 24 );
+    }
+
+    inline void putU64( unsigned char* p, unsigned long long value )
+    {
+        putU32( p, (unsigned int)value );
+        putU32( p + 4, (unsigned int)( value >> 32 ) );
+    }
+
+    inline unsigned long long getU64( const unsigned char* p )
+    {
+        return getU32( p ) | ( (unsigned long long)getU32( p + 4 ) << 32 );
+    }
+
+    inline void putFloat( unsigned char* p, float value )
+    {
+        unsigned int bits = 0;
+        memcpy( &bits, &value, sizeof(bits) );
+        putU32( p, bits );
+    }
+
+    inline float getFloat( const unsigned char* p )
+    {
+        const unsigned int bits = getU32( p );
+        float value = 0.0f;
+        memcpy( &value, &bits, sizeof(value) );
+        return value;
+    }
+
+    inline void putDouble( unsigned char* p, double value )
+    {
+        unsigned long long bits = 0;
+        memcpy( &bits, &value, sizeof(bits) );
+        putU64( p, bits );
+    }
+
+    inline double getDouble( const unsigned char* p )
+    {
+        const unsigned long long bits = getU64( p );
+        double value = 0.0;
+        memcpy( &value, &bits, sizeof(value) );
+        return value;
+    }
+
+    /** CRC-32 (zlib) of the data. */
+    unsigned int computeCrc( const void* pData, size_t size );
+
+    /**
+     * Replace the file at path with the data by writing path.tmp and 
+     * renaming it into place, so that a crash or a concurrent reader sees 
+     * either the old or the new file. If isDurable is set, the data and 
+     * the rename are on disk before this returns.
+     */
+    bool writeAtomically( 
+        const std::string& path, 
+        const void* pData, 
+        size_t size, 
+        bool isDurable, 
+        std::string& errorMessage );
+}
+
+#endif // __BINARYFILE_H__
@@ -0,0 +1,255 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <winsock2.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "BinaryFile.h"
+#include "BufferCountTuner.h"
+
+namespace
+{
+    // Extra buffers on top of the worst stall, as a fraction and a minimum
+    const double k_headroomFraction = 0.25;
+    const unsigned int k_minimumHeadroom = 2;
+
+    const unsigned int k_minimumBufferCount = 4;
+    const unsigned int k_maximumBufferCount = 200;
+
+    std::string getHostName()
+    {
+        char hostName[256] = {0};
+        if ( gethostname( hostName, sizeof(hostName) - 1 ) != 0 )
+        {
+            return "localhost";
+        }
+        return hostName;
+    }
+
+    std::string getSettingsDirectory()
+    {
+#ifdef _WIN32
+        const char* pBase = getenv( "APPDATA" );
+        return std::string( pBase != NULL ? pBase : "." ) + "\\Ladybug";
+#else
+        const char* pBase = getenv( "HOME" );
+        return std::string( pBase != NULL ? pBase : "." ) + "/.ladybug";
+#endif
+    }
+
+    void makeDirectory( const std::string& path )
+    {
+#ifdef _WIN32
+        _mkdir( path.c_str() );
+#else
+        mkdir( path.c_str(), 0755 );
+#endif
+    }
+}
+
+BufferCountTuner::BufferCountTuner( const std::string& cameraModel, double warmupSeconds ) :
+m_cameraModel( cameraModel ),
+m_warmupSeconds( warmupSeconds ),
+m_started( false ),
+m_frames( 0 ),
+m_worstStallSeconds( 0.0 ),
+m_worstBacklog( 0 )
+{
+}
+
+std::string 
+BufferCountTuner::getStoragePath() const
+{
+#ifdef _WIN32
+    return getSettingsDirectory() + "\\buffer_counts.txt";
+#else
+    return getSettingsDirectory() + "/buffer_counts.txt";
+#endif
+}
+
+std::string 
+BufferCountTuner::getKey() const
+{
+    return getHostName() + "\t" + m_cameraModel;
+}
+
+bool 
+BufferCountTuner::loadBufferCount( unsigned int& bufferCount ) const
+{
+    std::ifstream file( getStoragePath().c_str() );
+    if ( !file.is_open() )
+    {
+        return false;
+    }
+
+    // Each line is: host <tab> model <tab> count <tab> worst stall (ms) <tab> frame rate
+    const std::string key = getKey() + "\t";
+    std::string line;
+    while ( std::getline( file, line ) )
+    {
+        if ( line.compare( 0, key.size(), key ) != 0 )
+        {
+            continue;
+        }
+
+        const unsigned int storedCount = (unsigned int)strtoul( line.c_str() + key.size(), NULL, 10 );
+        if ( storedCount == 0 )
+        {
+            return false;
+        }
+
+        bufferCount = storedCount;
+        return true;
+    }
+
+    return false;
+}
+
+bool 
+BufferCountTuner::saveBufferCount( unsigned int bufferCount ) const
+{
+    const std::string path = getStoragePath();
+    const std::string key = getKey() + "\t";
+
+    // Keep the entries of other hosts and models
+    std::vector<std::string> lines;
+    {
+        std::ifstream existing( path.c_str() );
+        std::string line;
+        while ( std::getline( existing, line ) )
+        {
+            if ( !line.empty() && line.compare( 0, key.size(), key ) != 0 )
+            {
+                lines.push_back( line );
+            }
+        }
+    }
+
+    std::stringstream entry;
+    entry << key << bufferCount << "\t" 
+        << (unsigned int)( m_worstStallSeconds * 1000.0 + 0.5 ) << "\t" 
+        << getObservedFrameRate();
+    lines.push_back( entry.str() );
+
+    makeDirectory( getSettingsDirectory() );
+
+    std::string contents;
+    for ( size_t i = 0; i < lines.size(); i++ )
+    {
+        contents += lines[i] + "\n";
+    }
+
+    // A crash never leaves the file half written
+    std::string errorMessage;
+    return binaryFile::writeAtomically( path, contents.data(), contents.size(), false, errorMessage );
+}
+
+void 
+BufferCountTuner::start()
+{
+    m_startTime = std::chrono::steady_clock::now();
+    m_started = true;
+    m_frames = 0;
+    m_worstStallSeconds = 0.0;
+    m_worstBacklog = 0;
+}
+
+void 
+BufferCountTuner::addSamples( unsigned int frames, double worstStallSeconds )
+{
+    if ( !m_started || isWarmupComplete() )
+    {
+        return;
+    }
+
+    m_frames += frames;
+    m_worstStallSeconds = std::max( m_worstStallSeconds, worstStallSeconds );
+}
+
+void 
+BufferCountTuner::addOverflow( unsigned int queueCapacity, unsigned int droppedFrames, double overflowSeconds )
+{
+    if ( !m_started || isWarmupComplete() )
+    {
+        return;
+    }
+
+    // The queue was already full when the drops began, so the consumer had
+    // been stalled for at least as long as it takes to fill it
+    const double frameRate = getObservedFrameRate();
+    const double fillSeconds = frameRate > 0.0 ? queueCapacity / frameRate : 0.0;
+
+    m_worstBacklog = std::max( m_worstBacklog, queueCapacity + droppedFrames );
+    m_worstStallSeconds = std::max( m_worstStallSeconds, fillSeconds + overflowSeconds );
+}
+
+bool 
+BufferCountTuner::isWarmupComplete() const
+{
+    if ( !m_started )
+    {
+        return false;
+    }
+
+    const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - m_startTime ).count();
+    return elapsed >= m_warmupSeconds;
+}
+
+double 
+BufferCountTuner::getObservedFrameRate() const
+{
+    if ( !m_started )
+    {
+        return 0.0;
+    }
+
+    const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - m_startTime ).count();
+    return elapsed > 0.0 ? m_frames / std::min( elapsed, m_warmupSeconds ) : 0.0;
+}
+
+unsigned int 
+BufferCountTuner::computeBufferCount() const
+{
+    // Frames that arrive while the consumer is stalled all need a buffer
+    const double framesDuringStall = m_worstStallSeconds * getObservedFrameRate();
+    const unsigned int needed = std::max( (unsigned int)ceil( framesDuringStall ), m_worstBacklog ) + 1;
+    const unsigned int headroom = std::max( k_minimumHeadroom, (unsigned int)ceil( needed * k_headroomFraction ) );
+
+    return std::min( k_maximumBufferCount, std::max( k_minimumBufferCount, needed + headroom ) );
+}
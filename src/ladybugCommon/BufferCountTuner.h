@@ -0,0 +1,92 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __BUFFERCOUNTTUNER_H__
+#define __BUFFERCOUNTTUNER_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <chrono>
+#include <string>
+
+/**
+ * Picks the number of image buffers to pass to ladybugInitializePlus().
+ *
+ * During a warm-up window the consumer reports how long it kept frames
+ * waiting, and the frames it had to drop because its queue was full. The 
+ * smallest count that covers the worst observed stall at the observed 
+ * frame rate, and the largest backlog, plus headroom, is then stored per 
+ * host and camera model in ~/.ladybug/buffer_counts.txt and used on the 
+ * next start.
+ */
+class BufferCountTuner
+{
+public:
+    BufferCountTuner( const std::string& cameraModel, double warmupSeconds );
+
+    /** Get the count stored for this host and camera model, if any. */
+    bool loadBufferCount( unsigned int& bufferCount ) const;
+
+    /** Store a count for this host and camera model. */
+    bool saveBufferCount( unsigned int bufferCount ) const;
+
+    /** Start the warm-up window. */
+    void start();
+
+    /** 
+     * Report consumed frames and the longest time any of them was kept 
+     * waiting by the consumer.
+     */
+    void addSamples( unsigned int frames, double worstStallSeconds );
+
+    /** 
+     * Report frames dropped in a row because the consumer's queue of 
+     * queueCapacity frames was full, and the seconds from the first drop
+     * until the queue took a frame again. Frames held in a queue never wait
+     * longer than the queue allows, so without these the count could not
+     * grow past the queue.
+     */
+    void addOverflow( unsigned int queueCapacity, unsigned int droppedFrames, double overflowSeconds );
+
+    bool isWarmupComplete() const;
+
+    /** Smallest buffer count covering the worst stall, with headroom. */
+    unsigned int computeBufferCount() const;
+
+    double getWorstStallSeconds() const { return m_worstStallSeconds; }
+    unsigned int getWorstBacklog() const { return m_worstBacklog; }
+    double getObservedFrameRate() const;
+
+    std::string getStoragePath() const;
+
+private:
+    std::string getKey() const;
+
+    const std::string m_cameraModel;
+    const double m_warmupSeconds;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    bool m_started;
+    unsigned long m_frames;
+    double m_worstStallSeconds;
+    unsigned int m_worstBacklog;
+};
+
+#endif // __BUFFERCOUNTTUNER_H__
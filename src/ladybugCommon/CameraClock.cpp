@@ -0,0 +1,215 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cmath>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CameraClock.h"
+
+namespace
+{
+    const unsigned long long k_ticksPerCycle = 3072;
+    const unsigned long long k_cyclesPerSecond = 8000;
+    const unsigned long long k_wrapTicks = 128 * CameraClock::k_ticksPerSecond;
+
+    // Locked timestamps further off the fit than this are not used
+    const double k_maxResidualSeconds = 0.002;
+    const unsigned int k_minSamplesToReject = 10;
+
+    // This many rejected samples in a row means the UTC of the camera 
+    // stepped, e.g. after locking again; the fit starts over
+    const unsigned int k_maxConsecutiveRejects = 30;
+
+    // The rate is only fitted once the samples span some time, and is 
+    // ignored when it is too far off to be an oscillator
+    const double k_minSpanSeconds = 1.0;
+    const double k_maxDrift = 1.0e-3;
+
+    unsigned long long getRawTick( const LadybugTimestamp& timeStamp )
+    {
+        return ( (unsigned long long)( timeStamp.ulCycleSeconds % 128 ) * k_cyclesPerSecond + 
+            timeStamp.ulCycleCount % k_cyclesPerSecond ) * k_ticksPerCycle + 
+            timeStamp.ulCycleOffset % k_ticksPerCycle;
+    }
+
+    // Signed, for ticks before the reference
+    double getSecondsBetween( unsigned long long tick, unsigned long long referenceTick )
+    {
+        return (double)(long long)( tick - referenceTick ) / CameraClock::k_ticksPerSecond;
+    }
+
+    double getSeconds( const LadybugTimestamp& timeStamp )
+    {
+        return timeStamp.ulSeconds + timeStamp.ulMicroSeconds / 1000000.0;
+    }
+}
+
+CameraClock::CameraClock()
+{
+    reset();
+}
+
+void 
+CameraClock::reset()
+{
+    m_hasImage = false;
+    m_lastRawTick = 0;
+    m_tick = 0;
+    m_lastPpsStatus = false;
+    m_lastSeconds = 0.0;
+    m_anchorTick = 0;
+    m_anchorSeconds = 0.0;
+    m_referenceTick = 0;
+    m_referenceUtc = 0.0;
+    m_numSamples = 0;
+    m_meanX = 0.0;
+    m_meanY = 0.0;
+    m_sumXX = 0.0;
+    m_sumXY = 0.0;
+    m_numRejected = 0;
+    m_consecutiveRejects = 0;
+}
+
+unsigned long long 
+CameraClock::addImage( const LadybugImage& image )
+{
+    const unsigned long long rawTick = getRawTick( image.timeStamp );
+    const double seconds = getSeconds( image.timeStamp );
+    const bool isLocked = image.imageInfo.bGpsStatus && image.imageInfo.bPpsStatus;
+
+    if ( !m_hasImage )
+    {
+        m_hasImage = true;
+        m_tick = rawTick;
+        m_anchorTick = rawTick;
+        m_anchorSeconds = seconds;
+    }
+    else
+    {
+        unsigned long long delta = ( rawTick + k_wrapTicks - m_lastRawTick ) % k_wrapTicks;
+
+        // The cycle time cannot tell a gap of more than one wrap, e.g. 
+        // after the camera stalled. The timestamps can, as long as both 
+        // are on the same time base, which changes when PPS locks.
+        const double elapsedSeconds = seconds - m_lastSeconds;
+        if ( isLocked == m_lastPpsStatus && elapsedSeconds > 64.0 )
+        {
+            const double missedWraps = floor( ( elapsedSeconds - toSeconds( delta ) ) / 128.0 + 0.5 );
+            if ( missedWraps > 0.0 )
+            {
+                delta += (unsigned long long)missedWraps * k_wrapTicks;
+            }
+        }
+
+        m_tick += delta;
+    }
+
+    m_lastRawTick = rawTick;
+    m_lastSeconds = seconds;
+    m_lastPpsStatus = isLocked;
+
+    if ( isLocked )
+    {
+        addUtcSample( m_tick, seconds );
+    }
+
+    return m_tick;
+}
+
+void 
+CameraClock::restartFit( unsigned long long tick, double utc )
+{
+    m_referenceTick = tick;
+    m_referenceUtc = utc;
+    m_numSamples = 0;
+    m_meanX = 0.0;
+    m_meanY = 0.0;
+    m_sumXX = 0.0;
+    m_sumXY = 0.0;
+    m_consecutiveRejects = 0;
+}
+
+bool 
+CameraClock::addUtcSample( unsigned long long tick, double utc )
+{
+    if ( m_numSamples == 0 )
+    {
+        restartFit( tick, utc );
+    }
+    else if ( m_numSamples >= k_minSamplesToReject && fabs( toUtc( tick ) - utc ) > k_maxResidualSeconds )
+    {
+        m_numRejected++;
+        if ( ++m_consecutiveRejects < k_maxConsecutiveRejects )
+        {
+            return false;
+        }
+        restartFit( tick, utc );
+    }
+
+    m_consecutiveRejects = 0;
+
+    // Welford's update, which keeps its precision over long recordings
+    const double x = getSecondsBetween( tick, m_referenceTick );
+    const double y = utc - m_referenceUtc;
+    m_numSamples++;
+    const double dx = x - m_meanX;
+    m_meanX += dx / m_numSamples;
+    m_meanY += ( y - m_meanY ) / m_numSamples;
+    m_sumXX += dx * ( x - m_meanX );
+    m_sumXY += dx * ( y - m_meanY );
+    return true;
+}
+
+double 
+CameraClock::getSlope() const
+{
+    if ( m_numSamples < 2 || m_sumXX < k_minSpanSeconds * k_minSpanSeconds )
+    {
+        return 1.0;
+    }
+
+    const double slope = m_sumXY / m_sumXX;
+    return fabs( slope - 1.0 ) <= k_maxDrift ? slope : 1.0;
+}
+
+double 
+CameraClock::toUtc( unsigned long long tick ) const
+{
+    if ( m_numSamples == 0 )
+    {
+        return m_anchorSeconds + getSecondsBetween( tick, m_anchorTick );
+    }
+
+    const double x = getSecondsBetween( tick, m_referenceTick );
+    return m_referenceUtc + m_meanY + getSlope() * ( x - m_meanX );
+}
+
+double 
+CameraClock::getDriftPpm() const
+{
+    // The slope is UTC seconds per camera second; a fast oscillator 
+    // counts more camera seconds per UTC second
+    return ( 1.0 / getSlope() - 1.0 ) * 1.0e6;
+}
@@ -0,0 +1,108 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __CAMERACLOCK_H__
+#define __CAMERACLOCK_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <ladybug.h>
+
+/**
+ * Time of the frames of one camera, from its cycle timer.
+ *
+ * The cycle time of a timestamp (ulCycleSeconds, ulCycleCount and 
+ * ulCycleOffset) counts 24.576 MHz ticks and wraps every 128 seconds. 
+ * Images passed in capture order are unwrapped into a 64 bit tick that 
+ * only moves forward.
+ *
+ * Frames taken while the camera is locked to GPS time and PPS (see 
+ * ladybugGPSTimeSync) carry UTC in their timestamp. A line through these
+ * frames maps ticks to UTC, so that the drift of the camera oscillator is
+ * corrected and frames before the lock or after losing it still get UTC.
+ * Until the first locked frame, ticks map onto the timestamp of the first
+ * image at the nominal rate.
+ */
+class CameraClock
+{
+public:
+    /** 8000 cycles per second, 3072 offsets per cycle. */
+    static const unsigned long long k_ticksPerSecond = 24576000ULL;
+
+    CameraClock();
+
+    void reset();
+
+    /** 
+     * Unwrap the cycle time of the next image and, if it is locked to 
+     * PPS, add its timestamp to the fit. Returns the tick of the image.
+     */
+    unsigned long long addImage( const LadybugImage& image );
+
+    /** 
+     * Add a known UTC time (seconds since 1970) of a tick. Returns false
+     * if the sample is too far off the fit of the earlier ones.
+     */
+    bool addUtcSample( unsigned long long tick, double utc );
+
+    /** UTC of a tick, in seconds since 1970. */
+    double toUtc( unsigned long long tick ) const;
+
+    static double toSeconds( unsigned long long ticks ) { return ticks / (double)k_ticksPerSecond; }
+
+    /** Whether any frame was locked to PPS, so that toUtc() gives UTC. */
+    bool isLocked() const { return m_numSamples > 0; }
+
+    /** Rate of the camera oscillator off nominal, in parts per million. */
+    double getDriftPpm() const;
+
+    unsigned int getNumSamples() const { return m_numSamples; }
+    unsigned int getNumRejected() const { return m_numRejected; }
+
+private:
+    void restartFit( unsigned long long tick, double utc );
+
+    double getSlope() const;
+
+    bool m_hasImage;
+    unsigned long long m_lastRawTick;
+    unsigned long long m_tick;
+    bool m_lastPpsStatus;
+    double m_lastSeconds;
+
+    // Timestamp of the first image, used until the first locked frame
+    unsigned long long m_anchorTick;
+    double m_anchorSeconds;
+
+    // Running least squares fit of UTC against seconds since the 
+    // reference tick, both relative to the first sample
+    unsigned long long m_referenceTick;
+    double m_referenceUtc;
+    unsigned int m_numSamples;
+    double m_meanX;
+    double m_meanY;
+    double m_sumXX;
+    double m_sumXY;
+
+    unsigned int m_numRejected;
+    unsigned int m_consecutiveRejects;
+};
+
+#endif // __CAMERACLOCK_H__
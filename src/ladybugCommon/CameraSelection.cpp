@@ -0,0 +1,264 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CameraSelection.h"
+
+namespace
+{
+    const unsigned int k_allCameras = ( 1u << LADYBUG_NUM_CAMERAS ) - 1;
+
+    // Side of the blocks averaged for the blurred fill, in pixels
+    const unsigned int k_blurBlock = 32;
+
+    template <typename T>
+    void fillConstant( T* pPixels, size_t numPixels, T value )
+    {
+        for ( size_t i = 0; i < numPixels; i++ )
+        {
+            pPixels[i * 4 + 0] = value;
+            pPixels[i * 4 + 1] = value;
+            pPixels[i * 4 + 2] = value;
+        }
+    }
+
+    /** 
+     * Average blocks of the image, then interpolate between the block 
+     * centers. Cheap, and smooth enough that no detail survives.
+     */
+    template <typename T>
+    void fillBlurred( T* pPixels, unsigned int cols, unsigned int rows )
+    {
+        const unsigned int blockCols = ( cols + k_blurBlock - 1 ) / k_blurBlock;
+        const unsigned int blockRows = ( rows + k_blurBlock - 1 ) / k_blurBlock;
+        std::vector<float> means( (size_t)blockCols * blockRows * 3, 0.0f );
+        std::vector<unsigned int> counts( (size_t)blockCols * blockRows, 0 );
+
+        for ( unsigned int y = 0; y < rows; y++ )
+        {
+            const T* pRow = pPixels + (size_t)y * cols * 4;
+            for ( unsigned int x = 0; x < cols; x++ )
+            {
+                const size_t block = (size_t)( y / k_blurBlock ) * blockCols + x / k_blurBlock;
+                means[block * 3 + 0] += pRow[x * 4 + 0];
+                means[block * 3 + 1] += pRow[x * 4 + 1];
+                means[block * 3 + 2] += pRow[x * 4 + 2];
+                counts[block]++;
+            }
+        }
+
+        for ( size_t block = 0; block < counts.size(); block++ )
+        {
+            for ( int channel = 0; channel < 3; channel++ )
+            {
+                means[block * 3 + channel] /= counts[block];
+            }
+        }
+
+        for ( unsigned int y = 0; y < rows; y++ )
+        {
+            // Position relative to the block centers
+            const float blockY = std::max( 0.0f, ( y + 0.5f ) / k_blurBlock - 0.5f );
+            const unsigned int y0 = std::min( (unsigned int)blockY, blockRows - 1 );
+            const unsigned int y1 = std::min( y0 + 1, blockRows - 1 );
+            const float wy = std::min( 1.0f, blockY - y0 );
+
+            T* pRow = pPixels + (size_t)y * cols * 4;
+            for ( unsigned int x = 0; x < cols; x++ )
+            {
+                const float blockX = std::max( 0.0f, ( x + 0.5f ) / k_blurBlock - 0.5f );
+                const unsigned int x0 = std::min( (unsigned int)blockX, blockCols - 1 );
+                const unsigned int x1 = std::min( x0 + 1, blockCols - 1 );
+                const float wx = std::min( 1.0f, blockX - x0 );
+
+                const float* p00 = &means[( (size_t)y0 * blockCols + x0 ) * 3];
+                const float* p01 = &means[( (size_t)y0 * blockCols + x1 ) * 3];
+                const float* p10 = &means[( (size_t)y1 * blockCols + x0 ) * 3];
+                const float* p11 = &means[( (size_t)y1 * blockCols + x1 ) * 3];
+                for ( int channel = 0; channel < 3; channel++ )
+                {
+                    const float top = p00[channel] * ( 1.0f - wx ) + p01[channel] * wx;
+                    const float bottom = p10[channel] * ( 1.0f - wx ) + p11[channel] * wx;
+                    pRow[x * 4 + channel] = (T)( top * ( 1.0f - wy ) + bottom * wy + 0.5f );
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    void fillCamera( T* pPixels, unsigned int cols, unsigned int rows, CameraSelection::Fill fill )
+    {
+        // Mid gray in the top bits, for both 8 and 16 bit samples
+        const T gray = (T)( 1u << ( sizeof(T) * 8 - 1 ) );
+
+        switch ( fill )
+        {
+        case CameraSelection::FILL_BLACK:
+            fillConstant( pPixels, (size_t)cols * rows, (T)0 );
+            break;
+        case CameraSelection::FILL_GRAY:
+            fillConstant( pPixels, (size_t)cols * rows, gray );
+            break;
+        default:
+            fillBlurred( pPixels, cols, rows );
+            break;
+        }
+    }
+}
+
+CameraSelection::CameraSelection() :
+m_mask( k_allCameras ),
+m_fill( FILL_BLUR ),
+m_filled( false )
+{
+}
+
+bool 
+CameraSelection::parse( const char* pszText )
+{
+    unsigned int mask = 0;
+    const char* pszChar = pszText;
+    for ( ; *pszChar != '\0' && *pszChar != ':'; pszChar++ )
+    {
+        const int camera = *pszChar - '0';
+        if ( camera < 0 || camera >= LADYBUG_NUM_CAMERAS )
+        {
+            return false;
+        }
+        mask |= 1u << camera;
+    }
+
+    if ( mask == 0 )
+    {
+        return false;
+    }
+
+    Fill fill = FILL_BLUR;
+    if ( *pszChar == ':' )
+    {
+        const char* pszFill = pszChar + 1;
+        if ( strcmp( pszFill, "black" ) == 0 )
+        {
+            fill = FILL_BLACK;
+        }
+        else if ( strcmp( pszFill, "gray" ) == 0 )
+        {
+            fill = FILL_GRAY;
+        }
+        else if ( strcmp( pszFill, "blur" ) != 0 )
+        {
+            return false;
+        }
+    }
+
+    m_mask = mask;
+    m_fill = fill;
+    m_filled = false;
+    return true;
+}
+
+bool 
+CameraSelection::isAllSelected() const
+{
+    return m_mask == k_allCameras;
+}
+
+unsigned int 
+CameraSelection::getNumSelected() const
+{
+    unsigned int count = 0;
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        count += isSelected( camera ) ? 1 : 0;
+    }
+    return count;
+}
+
+std::string 
+CameraSelection::describe() const
+{
+    std::string text = "cameras";
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        if ( isSelected( camera ) )
+        {
+            text += " ";
+            text += (char)( '0' + camera );
+        }
+    }
+
+    if ( !isAllSelected() )
+    {
+        const char* pszFill = m_fill == FILL_BLACK ? "black" : ( m_fill == FILL_GRAY ? "gray" : "blur" );
+        text += std::string( " (" ) + pszFill + " fill)";
+    }
+    return text;
+}
+
+void 
+CameraSelection::getActiveBuffers( unsigned char* const* arpAll, unsigned char** arpActive ) const
+{
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        arpActive[camera] = !m_filled || isSelected( camera ) ? arpAll[camera] : NULL;
+    }
+}
+
+void 
+CameraSelection::applyFill( 
+    unsigned char* const* arpBuffers, 
+    unsigned int cols, 
+    unsigned int rows, 
+    LadybugPixelFormat pixelFormat )
+{
+    if ( m_filled )
+    {
+        return;
+    }
+
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        if ( isSelected( camera ) || arpBuffers[camera] == NULL )
+        {
+            continue;
+        }
+
+        if ( pixelFormat == LADYBUG_BGRU16 )
+        {
+            fillCamera( reinterpret_cast<uint16_t*>( arpBuffers[camera] ), cols, rows, m_fill );
+        }
+        else
+        {
+            fillCamera( arpBuffers[camera], cols, rows, m_fill );
+        }
+    }
+
+    m_filled = true;
+}
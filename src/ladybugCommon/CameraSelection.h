@@ -0,0 +1,93 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __CAMERASELECTION_H__
+#define __CAMERASELECTION_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string>
+
+#include <ladybug.h>
+
+/**
+ * The cameras a processing tool keeps converting and uploading.
+ *
+ * All cameras are converted on the first frame, so that the alpha masks 
+ * are computed and a blurred fill can be taken from real content. The 
+ * color of the unselected cameras is then replaced by the fill and 
+ * uploaded once. On every later frame their buffer pointers are NULL, 
+ * which makes ladybugConvertImage(), DebayerEngine::convert() and 
+ * ladybugUpdateTextures() skip them, while the renderer keeps blending 
+ * in the fill from the textures it already has.
+ */
+class CameraSelection
+{
+public:
+    enum Fill
+    {
+        FILL_BLACK,
+        FILL_GRAY,
+        FILL_BLUR   /**< Heavily blurred copy of the first frame. */
+    };
+
+    /** All cameras selected. */
+    CameraSelection();
+
+    /** 
+     * Parse a list of camera indices with an optional fill, such as 
+     * "01234" or "01234:blur". The fill is black, gray or blur (default).
+     */
+    bool parse( const char* pszText );
+
+    bool isSelected( unsigned int camera ) const { return ( m_mask & ( 1u << camera ) ) != 0; }
+    bool isAllSelected() const;
+    unsigned int getMask() const { return m_mask; }
+    unsigned int getNumSelected() const;
+
+    /** For messages, e.g. "cameras 0 1 2 3 4 (blur fill)". */
+    std::string describe() const;
+
+    /**
+     * Fill arpActive from arpAll, with NULL for the cameras to skip. All 
+     * cameras are active until applyFill() has run.
+     */
+    void getActiveBuffers( unsigned char* const* arpAll, unsigned char** arpActive ) const;
+
+    /** 
+     * Replace the color of the unselected cameras in fully converted 
+     * BGRU or BGRU16 buffers, keeping the alpha channel. Later calls do 
+     * nothing.
+     */
+    void applyFill( 
+        unsigned char* const* arpBuffers, 
+        unsigned int cols, 
+        unsigned int rows, 
+        LadybugPixelFormat pixelFormat );
+
+    bool isFilled() const { return m_filled; }
+
+private:
+    unsigned int m_mask;
+    Fill m_fill;
+    bool m_filled;
+};
+
+#endif // __CAMERASELECTION_H__
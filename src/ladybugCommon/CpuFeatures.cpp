@@ -0,0 +1,67 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CpuFeatures.h"
+
+namespace
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    bool detectAvx2()
+    {
+        int info[4];
+        __cpuid( info, 1 );
+        const bool osSavesYmm = ( info[2] & ( 1 << 27 ) ) != 0 && ( _xgetbv( 0 ) & 0x6 ) == 0x6;
+        if ( !osSavesYmm )
+        {
+            return false;
+        }
+
+        __cpuidex( info, 7, 0 );
+        return ( info[1] & ( 1 << 5 ) ) != 0;
+    }
+#elif defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+    bool detectAvx2()
+    {
+        return __builtin_cpu_supports( "avx2" ) != 0;
+    }
+#else
+    bool detectAvx2()
+    {
+        return false;
+    }
+#endif
+}
+
+bool 
+cpuFeatures::hasAvx2()
+{
+    static const bool available = detectAvx2();
+    return available;
+}
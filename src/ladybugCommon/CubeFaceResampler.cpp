@@ -0,0 +1,280 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CpuFeatures.h"
+#include "CubeFaceResampler.h"
+#include "CubeFaceResamplerAvx2.h"
+
+namespace
+{
+    const double k_pi = 3.14159265358979323846;
+
+    // Rows sampled or copied per task
+    const unsigned int k_bandRows = 16;
+
+    // Bilinear weights are fractions of this
+    const unsigned int k_weightOne = 128;
+
+    /** Looking direction, right and up vectors of a face, in panorama coordinates. */
+    struct FaceAxes
+    {
+        double forward[3];
+        double right[3];
+        double up[3];
+    };
+
+    const FaceAxes k_faceAxes[CubeFaceResampler::NUM_FACES] = 
+    {
+        { {  1,  0,  0 }, {  0, -1,  0 }, {  0,  0,  1 } },
+        { {  0, -1,  0 }, { -1,  0,  0 }, {  0,  0,  1 } },
+        { { -1,  0,  0 }, {  0,  1,  0 }, {  0,  0,  1 } },
+        { {  0,  1,  0 }, {  1,  0,  0 }, {  0,  0,  1 } },
+        { {  0,  0,  1 }, {  0, -1,  0 }, { -1,  0,  0 } },
+        { {  0,  0, -1 }, {  0, -1,  0 }, {  1,  0,  0 } }
+    };
+
+    bool useAvx2()
+    {
+        static const bool available = cubeFaceResampler::avx2::isBuilt() && cpuFeatures::hasAvx2();
+        return available;
+    }
+
+    /** Split a source coordinate into a whole pixel and a weight out of k_weightOne. */
+    void splitCoordinate( double position, unsigned int& pixel, unsigned int& weight )
+    {
+        const double whole = floor( position );
+        pixel = (unsigned int)whole;
+        weight = (unsigned int)( ( position - whole ) * k_weightOne + 0.5 );
+        if ( weight == k_weightOne )
+        {
+            pixel++;
+            weight = 0;
+        }
+    }
+
+    template <typename T>
+    void sampleRow( 
+        const T* pSource, 
+        unsigned int stride, 
+        const uint32_t* pIndices, 
+        const uint16_t* pWeights, 
+        T* pDest, 
+        unsigned int first, 
+        unsigned int width )
+    {
+        for ( unsigned int x = first; x < width; x++ )
+        {
+            const T* p00 = pSource + (size_t)pIndices[x] * 4;
+            const T* p10 = p00 + (size_t)stride * 4;
+            const uint32_t fx = pWeights[x] & 0xFF;
+            const uint32_t fy = pWeights[x] >> 8;
+
+            for ( unsigned int c = 0; c < 4; c++ )
+            {
+                const uint32_t top = p00[c] * ( k_weightOne - fx ) + p00[4 + c] * fx;
+                const uint32_t bottom = p10[c] * ( k_weightOne - fx ) + p10[4 + c] * fx;
+                pDest[x * 4 + c] = (T)( ( top * ( k_weightOne - fy ) + bottom * fy + ( 1 << 13 ) ) >> 14 );
+            }
+        }
+    }
+}
+
+CubeFaceResampler::CubeFaceResampler( unsigned int numThreads ) :
+m_pool( numThreads ),
+m_panoramaWidth( 0 ),
+m_panoramaHeight( 0 ),
+m_faceSize( 0 ),
+m_bytesPerSample( 0 )
+{
+}
+
+bool 
+CubeFaceResampler::getUseAvx2() const
+{
+    return useAvx2();
+}
+
+void 
+CubeFaceResampler::initialize( unsigned int panoramaWidth, unsigned int panoramaHeight, unsigned int faceSize )
+{
+    if ( panoramaWidth == m_panoramaWidth && panoramaHeight == m_panoramaHeight && faceSize == m_faceSize )
+    {
+        return;
+    }
+
+    m_panoramaWidth = panoramaWidth;
+    m_panoramaHeight = panoramaHeight;
+    m_faceSize = faceSize;
+
+    for ( unsigned int face = 0; face < NUM_FACES; face++ )
+    {
+        m_tables[face].indices.resize( (size_t)faceSize * faceSize );
+        m_tables[face].weights.resize( (size_t)faceSize * faceSize );
+    }
+
+    m_pool.parallelFor( NUM_FACES * faceSize, [this]( unsigned int task )
+    {
+        buildTableRow( task / m_faceSize, task % m_faceSize );
+    });
+}
+
+void 
+CubeFaceResampler::buildTableRow( unsigned int face, unsigned int row )
+{
+    const FaceAxes& axes = k_faceAxes[face];
+    const unsigned int stride = m_panoramaWidth + 1;
+    uint32_t* pIndices = &m_tables[face].indices[(size_t)row * m_faceSize];
+    uint16_t* pWeights = &m_tables[face].weights[(size_t)row * m_faceSize];
+
+    const double b = 1.0 - 2.0 * ( row + 0.5 ) / m_faceSize;
+    for ( unsigned int col = 0; col < m_faceSize; col++ )
+    {
+        const double a = 2.0 * ( col + 0.5 ) / m_faceSize - 1.0;
+        double v[3];
+        for ( int i = 0; i < 3; i++ )
+        {
+            v[i] = axes.forward[i] + a * axes.right[i] + b * axes.up[i];
+        }
+
+        // The same mapping as the panorama: column 0 looks along -X and
+        // the columns turn towards -Y
+        const double phi = atan2( v[1], v[0] );
+        const double theta = atan2( sqrt( v[0] * v[0] + v[1] * v[1] ), v[2] );
+
+        double x = ( k_pi - phi ) / ( 2.0 * k_pi ) * m_panoramaWidth - 0.5;
+        if ( x < 0.0 )
+        {
+            x += m_panoramaWidth;
+        }
+        const double y = std::max( 0.0, theta / k_pi * m_panoramaHeight - 0.5 );
+
+        unsigned int pixelX = 0;
+        unsigned int weightX = 0;
+        splitCoordinate( x, pixelX, weightX );
+        if ( pixelX >= m_panoramaWidth )
+        {
+            pixelX -= m_panoramaWidth;
+        }
+
+        unsigned int pixelY = 0;
+        unsigned int weightY = 0;
+        splitCoordinate( y, pixelY, weightY );
+        if ( pixelY >= m_panoramaHeight - 1 )
+        {
+            pixelY = m_panoramaHeight - 1;
+            weightY = 0;
+        }
+
+        pIndices[col] = pixelY * stride + pixelX;
+        pWeights[col] = (uint16_t)( weightX | ( weightY << 8 ) );
+    }
+}
+
+void 
+CubeFaceResampler::copyPanoramaRows( const LadybugProcessedImage& panorama, unsigned int firstRow, unsigned int lastRow )
+{
+    const size_t pixelBytes = 4 * m_bytesPerSample;
+    const size_t rowBytes = m_panoramaWidth * pixelBytes;
+    const size_t paddedRowBytes = rowBytes + pixelBytes;
+
+    for ( unsigned int row = firstRow; row < lastRow; row++ )
+    {
+        const unsigned char* pSource = panorama.pData + std::min( row, m_panoramaHeight - 1 ) * rowBytes;
+        unsigned char* pDest = &m_paddedPanorama[row * paddedRowBytes];
+        memcpy( pDest, pSource, rowBytes );
+        memcpy( pDest + rowBytes, pSource, pixelBytes );
+    }
+}
+
+bool 
+CubeFaceResampler::resample( const LadybugProcessedImage& panorama, unsigned char* const* ppFaces )
+{
+    if ( panorama.pixelFormat == LADYBUG_BGRU )
+    {
+        m_bytesPerSample = 1;
+    }
+    else if ( panorama.pixelFormat == LADYBUG_BGRU16 )
+    {
+        m_bytesPerSample = 2;
+    }
+    else
+    {
+        return false;
+    }
+
+    if ( m_faceSize == 0 || panorama.pData == NULL || 
+        panorama.uiCols != m_panoramaWidth || panorama.uiRows != m_panoramaHeight )
+    {
+        return false;
+    }
+
+    const unsigned int stride = m_panoramaWidth + 1;
+    const unsigned int paddedRows = m_panoramaHeight + 1;
+    m_paddedPanorama.resize( (size_t)stride * paddedRows * 4 * m_bytesPerSample );
+
+    const unsigned int copyBands = ( paddedRows + k_bandRows - 1 ) / k_bandRows;
+    m_pool.parallelFor( copyBands, [&]( unsigned int band )
+    {
+        copyPanoramaRows( panorama, band * k_bandRows, std::min( paddedRows, ( band + 1 ) * k_bandRows ) );
+    });
+
+    const unsigned int bandsPerFace = ( m_faceSize + k_bandRows - 1 ) / k_bandRows;
+    m_pool.parallelFor( NUM_FACES * bandsPerFace, [&]( unsigned int task )
+    {
+        const unsigned int face = task / bandsPerFace;
+        const unsigned int firstRow = ( task % bandsPerFace ) * k_bandRows;
+        const unsigned int lastRow = std::min( m_faceSize, firstRow + k_bandRows );
+        const FaceTable& table = m_tables[face];
+
+        for ( unsigned int row = firstRow; row < lastRow; row++ )
+        {
+            const size_t offset = (size_t)row * m_faceSize;
+            const uint32_t* pIndices = &table.indices[offset];
+            const uint16_t* pWeights = &table.weights[offset];
+
+            if ( m_bytesPerSample == 1 )
+            {
+                const uint8_t* pSource = &m_paddedPanorama[0];
+                uint8_t* pDest = ppFaces[face] + offset * 4;
+                const unsigned int done = useAvx2() ? 
+                    cubeFaceResampler::avx2::sampleRow( pSource, stride, pIndices, pWeights, pDest, m_faceSize ) : 0;
+                sampleRow( pSource, stride, pIndices, pWeights, pDest, done, m_faceSize );
+            }
+            else
+            {
+                const uint16_t* pSource = reinterpret_cast<const uint16_t*>( &m_paddedPanorama[0] );
+                uint16_t* pDest = reinterpret_cast<uint16_t*>( ppFaces[face] ) + offset * 4;
+                sampleRow( pSource, stride, pIndices, pWeights, pDest, 0, m_faceSize );
+            }
+        }
+    });
+
+    return true;
+}
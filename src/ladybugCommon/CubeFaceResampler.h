@@ -0,0 +1,114 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __CUBEFACERESAMPLER_H__
+#define __CUBEFACERESAMPLER_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stdint.h>
+
+#include <vector>
+
+#include <ladybug.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "ThreadPool.h"
+
+/**
+ * Cuts the six faces of a cube map out of an equirectangular panorama 
+ * on the CPU, so a frame needs one panorama render instead of six 
+ * spherical views.
+ *
+ * The source position of every face pixel is computed once per size 
+ * and kept in a table per face: the top left source pixel and the 
+ * bilinear weights, to 1/128 of a pixel, in 6 bytes. The faces are then
+ * sampled in bands on a thread pool, with AVX2 gathers for 8 bit images.
+ *
+ * The panorama follows the library layout: +X at the center column, -Y
+ * a quarter turn to the right of it and +Z at the top row. The faces 
+ * look along +X, -Y, -X, +Y, +Z and -Z, in the orientation of common 
+ * cube map viewers: upright for the sides, and with the top face's top
+ * edge (and the bottom face's bottom edge) towards the back face.
+ */
+class CubeFaceResampler
+{
+public:
+    enum Face
+    {
+        FACE_FRONT,
+        FACE_RIGHT,
+        FACE_BACK,
+        FACE_LEFT,
+        FACE_TOP,
+        FACE_BOTTOM,
+        NUM_FACES
+    };
+
+    /** numThreads of 0 uses one thread per hardware thread. */
+    explicit CubeFaceResampler( unsigned int numThreads = 0 );
+
+    unsigned int getNumThreads() const { return m_pool.getNumThreads(); }
+    bool getUseAvx2() const;
+
+    /** Build the tables for a panorama and face size, unless they are already built. */
+    void initialize( unsigned int panoramaWidth, unsigned int panoramaHeight, unsigned int faceSize );
+
+    unsigned int getFaceSize() const { return m_faceSize; }
+
+    /**
+     * Sample the six faces of a LADYBUG_BGRU or LADYBUG_BGRU16 panorama 
+     * of the initialized size into ppFaces, indexed by Face, each 
+     * faceSize x faceSize pixels of the same format. Returns false for 
+     * other formats or sizes.
+     */
+    bool resample( const LadybugProcessedImage& panorama, unsigned char* const* ppFaces );
+
+private:
+    struct FaceTable
+    {
+        std::vector<uint32_t> indices;
+        std::vector<uint16_t> weights;
+    };
+
+    CubeFaceResampler( const CubeFaceResampler& );
+    CubeFaceResampler& operator=( const CubeFaceResampler& );
+
+    void buildTableRow( unsigned int face, unsigned int row );
+    void copyPanoramaRows( const LadybugProcessedImage& panorama, unsigned int firstRow, unsigned int lastRow );
+
+    ThreadPool m_pool;
+
+    unsigned int m_panoramaWidth;
+    unsigned int m_panoramaHeight;
+    unsigned int m_faceSize;
+    FaceTable m_tables[NUM_FACES];
+
+    /** 
+     * The panorama with its first column repeated after the last and its
+     * last row repeated below, so no sample needs wrapping or clamping.
+     */
+    std::vector<unsigned char> m_paddedPanorama;
+    unsigned int m_bytesPerSample;
+};
+
+#endif // __CUBEFACERESAMPLER_H__
@@ -0,0 +1,133 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//
+// Built with -mavx2. Keep standard library templates out of this file.
+//
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CubeFaceResamplerAvx2.h"
+
+#if defined(__AVX2__) || ( defined(_MSC_VER) && defined(_M_X64) )
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <immintrin.h>
+
+namespace
+{
+    /** 
+     * Blend the top and bottom rows of four pixels, given as 16 bit 
+     * channels of two pixels per half, by the vertical weights of those
+     * pixels (128 - w in the low and w in the high 16 bits).
+     */
+    inline __m256i blendRows( __m256i top, __m256i bottom, __m256i weightPairs )
+    {
+        const __m256i rounding = _mm256_set1_epi32( 1 << 13 );
+        const __m256i first = _mm256_madd_epi16( 
+            _mm256_unpacklo_epi16( top, bottom ), _mm256_unpacklo_epi64( weightPairs, weightPairs ) );
+        const __m256i second = _mm256_madd_epi16( 
+            _mm256_unpackhi_epi16( top, bottom ), _mm256_unpackhi_epi64( weightPairs, weightPairs ) );
+        return _mm256_packs_epi32( 
+            _mm256_srli_epi32( _mm256_add_epi32( first, rounding ), 14 ), 
+            _mm256_srli_epi32( _mm256_add_epi32( second, rounding ), 14 ) );
+    }
+}
+
+bool 
+cubeFaceResampler::avx2::isBuilt()
+{
+    return true;
+}
+
+unsigned int 
+cubeFaceResampler::avx2::sampleRow( 
+    const uint8_t* pSource, 
+    unsigned int stride, 
+    const uint32_t* pIndices, 
+    const uint16_t* pWeights, 
+    uint8_t* pDest, 
+    unsigned int width )
+{
+    const int* pBase = reinterpret_cast<const int*>( pSource );
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i right = _mm256_set1_epi32( 1 );
+    const __m256i down = _mm256_set1_epi32( (int)stride );
+    const __m256i full = _mm256_set1_epi32( 128 );
+
+    unsigned int x = 0;
+    for ( ; x + 8 <= width; x += 8 )
+    {
+        const __m256i index = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( pIndices + x ) );
+        const __m256i p00 = _mm256_i32gather_epi32( pBase, index, 4 );
+        const __m256i p01 = _mm256_i32gather_epi32( pBase, _mm256_add_epi32( index, right ), 4 );
+        const __m256i p10 = _mm256_i32gather_epi32( pBase, _mm256_add_epi32( index, down ), 4 );
+        const __m256i p11 = _mm256_i32gather_epi32( pBase, _mm256_add_epi32( _mm256_add_epi32( index, down ), right ), 4 );
+
+        // One weight per 32 bit pixel; the horizontal ones repeated in 
+        // both 16 bit halves, the vertical ones as 128 - w, w pairs
+        const __m256i weights = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( pWeights + x ) ) );
+        const __m256i fx = _mm256_and_si256( weights, _mm256_set1_epi32( 0xFF ) );
+        const __m256i fy = _mm256_srli_epi32( weights, 8 );
+        const __m256i wx = _mm256_or_si256( fx, _mm256_slli_epi32( fx, 16 ) );
+        const __m256i inverseFx = _mm256_sub_epi32( full, fx );
+        const __m256i wxInverse = _mm256_or_si256( inverseFx, _mm256_slli_epi32( inverseFx, 16 ) );
+        const __m256i wy = _mm256_or_si256( _mm256_sub_epi32( full, fy ), _mm256_slli_epi32( fy, 16 ) );
+
+        // Pixels 0 1 | 4 5 as 16 bit channels, and pixels 2 3 | 6 7
+        __m256i halves[2];
+        for ( int half = 0; half < 2; half++ )
+        {
+            const __m256i a00 = half == 0 ? _mm256_unpacklo_epi8( p00, zero ) : _mm256_unpackhi_epi8( p00, zero );
+            const __m256i a01 = half == 0 ? _mm256_unpacklo_epi8( p01, zero ) : _mm256_unpackhi_epi8( p01, zero );
+            const __m256i a10 = half == 0 ? _mm256_unpacklo_epi8( p10, zero ) : _mm256_unpackhi_epi8( p10, zero );
+            const __m256i a11 = half == 0 ? _mm256_unpacklo_epi8( p11, zero ) : _mm256_unpackhi_epi8( p11, zero );
+            const __m256i w = half == 0 ? _mm256_unpacklo_epi32( wx, wx ) : _mm256_unpackhi_epi32( wx, wx );
+            const __m256i wInverse = half == 0 ? _mm256_unpacklo_epi32( wxInverse, wxInverse ) : _mm256_unpackhi_epi32( wxInverse, wxInverse );
+            const __m256i wyPairs = half == 0 ? _mm256_unpacklo_epi32( wy, wy ) : _mm256_unpackhi_epi32( wy, wy );
+
+            const __m256i top = _mm256_add_epi16( _mm256_mullo_epi16( a00, wInverse ), _mm256_mullo_epi16( a01, w ) );
+            const __m256i bottom = _mm256_add_epi16( _mm256_mullo_epi16( a10, wInverse ), _mm256_mullo_epi16( a11, w ) );
+            halves[half] = blendRows( top, bottom, wyPairs );
+        }
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDest + x * 4 ), _mm256_packus_epi16( halves[0], halves[1] ) );
+    }
+    return x;
+}
+
+#else
+
+bool 
+cubeFaceResampler::avx2::isBuilt()
+{
+    return false;
+}
+
+unsigned int 
+cubeFaceResampler::avx2::sampleRow( const uint8_t*, unsigned int, const uint32_t*, const uint16_t*, uint8_t*, unsigned int )
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,56 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __CUBEFACERESAMPLERAVX2_H__
+#define __CUBEFACERESAMPLERAVX2_H__
+
+//
+// AVX2 bilinear sampling used by CubeFaceResampler.cpp, for BGRU8 
+// pixels. Returns the number of pixels done; the caller finishes the 
+// rest. Only call it when isBuilt() and cpuFeatures::hasAvx2() are 
+// both true.
+//
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stdint.h>
+
+namespace cubeFaceResampler
+{
+    namespace avx2
+    {
+        bool isBuilt();
+
+        /**
+         * Sample width pixels. pIndices holds the top left source pixel 
+         * of each, and pWeights its horizontal (low byte) and vertical 
+         * (high byte) weights out of 128. stride is in pixels.
+         */
+        unsigned int sampleRow( 
+            const uint8_t* pSource, 
+            unsigned int stride, 
+            const uint32_t* pIndices, 
+            const uint16_t* pWeights, 
+            uint8_t* pDest, 
+            unsigned int width );
+    }
+}
+
+#endif // __CUBEFACERESAMPLERAVX2_H__
@@ -0,0 +1,528 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <string.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CpuFeatures.h"
+#include "DebayerEngine.h"
+#include "DebayerKernels.h"
+
+using namespace debayer;
+
+namespace
+{
+    // Rows per work item. Small enough to spread six cameras over many 
+    // threads, large enough to amortize the two extra border rows.
+    const unsigned int k_bandRows = 32;
+
+    // Mirrored pixels on each side of the unpacked rows
+    const int k_border = 2;
+
+    enum Channel { CHANNEL_B = 0, CHANNEL_G = 1, CHANNEL_R = 2 };
+
+    /** Color of each site of a 2x2 Bayer tile, indexed [y][x]. */
+    bool getBayerTile( LadybugStippledFormat format, Channel tile[2][2] )
+    {
+        switch ( format )
+        {
+        case LADYBUG_BGGR:
+            tile[0][0] = CHANNEL_B; tile[0][1] = CHANNEL_G;
+            tile[1][0] = CHANNEL_G; tile[1][1] = CHANNEL_R;
+            return true;
+        case LADYBUG_GBRG:
+            tile[0][0] = CHANNEL_G; tile[0][1] = CHANNEL_B;
+            tile[1][0] = CHANNEL_R; tile[1][1] = CHANNEL_G;
+            return true;
+        case LADYBUG_GRBG:
+            tile[0][0] = CHANNEL_G; tile[0][1] = CHANNEL_R;
+            tile[1][0] = CHANNEL_B; tile[1][1] = CHANNEL_G;
+            return true;
+        case LADYBUG_RGGB:
+            tile[0][0] = CHANNEL_R; tile[0][1] = CHANNEL_G;
+            tile[1][0] = CHANNEL_G; tile[1][1] = CHANNEL_B;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    Formula makeFormula( FormulaKind kind, int dx = 0, int dy = 0 )
+    {
+        Formula formula = { kind, dx, dy };
+        return formula;
+    }
+
+    /** How to compute a channel at the site (x, y) of the Bayer tile. */
+    Formula chooseFormula( const Channel tile[2][2], DebayerEngine::Method method, Channel channel, int x, int y )
+    {
+        const Channel site = tile[y][x];
+        if ( site == channel )
+        {
+            return makeFormula( FORMULA_SAMPLE );
+        }
+
+        if ( method == DebayerEngine::METHOD_NEAREST )
+        {
+            // Prefer the same row, which also picks a single green
+            for ( int dy = 0; dy < 2; dy++ )
+            {
+                const int sampleY = dy == 0 ? y : 1 - y;
+                for ( int sampleX = 0; sampleX < 2; sampleX++ )
+                {
+                    if ( tile[sampleY][sampleX] == channel )
+                    {
+                        return makeFormula( FORMULA_SAMPLE, sampleX - x, sampleY - y );
+                    }
+                }
+            }
+        }
+
+        const bool hq = method == DebayerEngine::METHOD_HQ_LINEAR;
+        if ( channel == CHANNEL_G )
+        {
+            return makeFormula( hq ? FORMULA_HQ_CROSS : FORMULA_CROSS );
+        }
+
+        if ( site != CHANNEL_G )
+        {
+            return makeFormula( hq ? FORMULA_HQ_DIAGONAL : FORMULA_DIAGONAL );
+        }
+
+        if ( tile[y][1 - x] == channel )
+        {
+            return makeFormula( hq ? FORMULA_HQ_HORIZONTAL : FORMULA_HORIZONTAL );
+        }
+
+        return makeFormula( hq ? FORMULA_HQ_VERTICAL : FORMULA_VERTICAL );
+    }
+
+    unsigned int getBitDepth( LadybugDataFormat dataFormat )
+    {
+        switch ( dataFormat )
+        {
+        case LADYBUG_DATAFORMAT_RAW12: return 12;
+        case LADYBUG_DATAFORMAT_RAW16: return 16;
+        default: return 8;
+        }
+    }
+
+    /** Bytes of one camera image in the raw buffer. */
+    unsigned int getCameraSizeBytes( LadybugDataFormat dataFormat, unsigned int cols, unsigned int rows )
+    {
+        switch ( dataFormat )
+        {
+        case LADYBUG_DATAFORMAT_RAW12: return cols * rows * 3 / 2;
+        case LADYBUG_DATAFORMAT_RAW16: return cols * rows * 2;
+        default: return cols * rows;
+        }
+    }
+
+    /** Mirror an index into [0, size) without changing its Bayer parity. */
+    int reflect( int index, int size )
+    {
+        if ( index < 0 )
+        {
+            return -index;
+        }
+        if ( index >= size )
+        {
+            return 2 * size - 2 - index;
+        }
+        return index;
+    }
+
+    /** Unpack one source row at native bit depth and mirror its ends. */
+    void unpackRow( const unsigned char* pSource, LadybugDataFormat dataFormat, int cols, uint16_t* pDest )
+    {
+        switch ( dataFormat )
+        {
+        case LADYBUG_DATAFORMAT_RAW12:
+            // Two pixels in three bytes: high bits of each, then both low nibbles
+            for ( int x = 0; x + 1 < cols; x += 2, pSource += 3 )
+            {
+                pDest[x] = (uint16_t)( ( pSource[0] << 4 ) | ( pSource[1] & 0x0F ) );
+                pDest[x + 1] = (uint16_t)( ( pSource[2] << 4 ) | ( pSource[1] >> 4 ) );
+            }
+            break;
+
+        case LADYBUG_DATAFORMAT_RAW16:
+            for ( int x = 0; x < cols; x++ )
+            {
+                pDest[x] = (uint16_t)( pSource[2 * x] | ( pSource[2 * x + 1] << 8 ) );
+            }
+            break;
+
+        default:
+            for ( int x = 0; x < cols; x++ )
+            {
+                pDest[x] = pSource[x];
+            }
+            break;
+        }
+
+        for ( int i = 1; i <= k_border; i++ )
+        {
+            pDest[-i] = pDest[reflect( -i, cols )];
+            pDest[cols - 1 + i] = pDest[reflect( cols - 1 + i, cols )];
+        }
+    }
+
+    /** Everything that stays the same for all bands of one conversion. */
+    struct ConversionSetup
+    {
+        RowJob row;
+
+        /** Formulas for even and odd rows. */
+        Formula formulas[2][3][2];
+
+        unsigned int cameraSizeBytes;
+        unsigned int sourceRowBytes;
+        bool useAvx2;
+
+        /** The kernels write kernelFormat, which is converted to destFormat if they differ. */
+        ImageFormat kernelFormat;
+        ImageFormat destFormat;
+    };
+
+    LadybugError prepareConversion( 
+        const LadybugImage& image, 
+        DebayerEngine::Method method, 
+        ImageFormat destFormat, 
+        bool useAvx2, 
+        ConversionSetup& setup )
+    {
+        if ( !DebayerEngine::isSupported( image.dataFormat ) || image.pData == NULL )
+        {
+            return LADYBUG_INVALID_ARGUMENT;
+        }
+
+        Channel tile[2][2];
+        if ( !getBayerTile( image.stippledFormat, tile ) )
+        {
+            return LADYBUG_NOT_IMPLEMENTED;
+        }
+
+        setup.cameraSizeBytes = getCameraSizeBytes( image.dataFormat, image.uiCols, image.uiRows );
+        if ( image.uiCols < 4 || image.uiRows < 4 || 
+            image.uiDataSizeBytes < setup.cameraSizeBytes * LADYBUG_NUM_CAMERAS )
+        {
+            return LADYBUG_INVALID_ARGUMENT;
+        }
+
+        const int bitDepth = (int)getBitDepth( image.dataFormat );
+        setup.sourceRowBytes = setup.cameraSizeBytes / image.uiRows;
+        setup.useAvx2 = useAvx2;
+
+        memset( &setup.row, 0, sizeof(setup.row) );
+        setup.row.maxValue = ( 1 << bitDepth ) - 1;
+        setup.row.shiftRight8 = bitDepth - 8;
+        setup.row.shiftLeft16 = 16 - bitDepth;
+        setup.row.output16 = imageFormat::isHighBitDepth( destFormat );
+        setup.kernelFormat = setup.row.output16 ? IMAGE_FORMAT_BGRU16 : IMAGE_FORMAT_BGRU8;
+        setup.destFormat = destFormat;
+
+        for ( int y = 0; y < 2; y++ )
+        {
+            for ( int channel = 0; channel < 3; channel++ )
+            {
+                for ( int x = 0; x < 2; x++ )
+                {
+                    setup.formulas[y][channel][x] = chooseFormula( tile, method, (Channel)channel, x, y );
+                }
+            }
+        }
+
+        return LADYBUG_OK;
+    }
+
+    /** 
+     * Color process rows [firstRow, endRow) and columns [firstCol, endCol)
+     * of one camera. pDest points at the first output pixel.
+     */
+    void convertBand( 
+        const ConversionSetup& setup, 
+        const LadybugImage& image, 
+        unsigned int camera, 
+        unsigned int firstRow, 
+        unsigned int endRow, 
+        unsigned int firstCol, 
+        unsigned int endCol, 
+        unsigned char* pDest, 
+        size_t destRowBytes, 
+        const unsigned char* pAlphaMask )
+    {
+        const int cols = (int)image.uiCols;
+        const int rows = (int)image.uiRows;
+        const unsigned char* pSource = image.pData + (size_t)camera * setup.cameraSizeBytes;
+
+        // Unpacked rows with two extra rows above and below
+        const int stride = cols + 2 * k_border;
+        const int bandRows = (int)( endRow - firstRow ) + 2 * k_border;
+        thread_local std::vector<uint16_t> unpacked;
+        unpacked.resize( (size_t)stride * bandRows );
+
+        for ( int i = 0; i < bandRows; i++ )
+        {
+            const int sourceRow = reflect( (int)firstRow - k_border + i, rows );
+            unpackRow( 
+                pSource + (size_t)sourceRow * setup.sourceRowBytes, 
+                image.dataFormat, 
+                cols, 
+                &unpacked[(size_t)i * stride + k_border] );
+        }
+
+        RowJob job = setup.row;
+        job.cols = (int)( endCol - firstCol );
+
+        // Compact formats are converted from one four channel row at a time
+        const bool convertRows = setup.kernelFormat != setup.destFormat;
+        thread_local std::vector<unsigned char> kernelRow;
+        if ( convertRows )
+        {
+            kernelRow.resize( imageFormat::getRowBytes( setup.kernelFormat, job.cols ) );
+        }
+
+        for ( unsigned int y = firstRow; y < endRow; y++ )
+        {
+            for ( int i = 0; i < 5; i++ )
+            {
+                job.pRows[i] = &unpacked[(size_t)( y - firstRow + i ) * stride + k_border + firstCol];
+            }
+
+            // The kernels count columns from firstCol, so an odd start swaps the parity
+            for ( int channel = 0; channel < 3; channel++ )
+            {
+                job.formulas[channel][0] = setup.formulas[y & 1][channel][firstCol & 1];
+                job.formulas[channel][1] = setup.formulas[y & 1][channel][( firstCol & 1 ) ^ 1];
+            }
+
+            job.pAlpha = pAlphaMask != NULL ? pAlphaMask + (size_t)y * cols + firstCol : NULL;
+            unsigned char* pDestRow = pDest + ( y - firstRow ) * destRowBytes;
+            job.pDest = convertRows ? &kernelRow[0] : pDestRow;
+
+            if ( setup.useAvx2 )
+            {
+                processRowAvx2( job );
+            }
+            else
+            {
+                processRowScalar( job );
+            }
+
+            if ( convertRows )
+            {
+                imageFormat::convertRow( setup.kernelFormat, &kernelRow[0], setup.destFormat, pDestRow, job.cols );
+            }
+        }
+    }
+}
+
+void 
+debayer::processRowScalar( const RowJob& job )
+{
+    processRow<ScalarOps>( job, 0, job.cols );
+}
+
+DebayerEngine::DebayerEngine( unsigned int numThreads ) :
+m_pool( numThreads ),
+m_useAvx2( isAvx2Available() )
+{
+    for ( unsigned int i = 0; i < LADYBUG_NUM_CAMERAS; i++ )
+    {
+        m_alphaMasks[i].cols = 0;
+        m_alphaMasks[i].rows = 0;
+    }
+}
+
+bool 
+DebayerEngine::isSupported( LadybugDataFormat dataFormat )
+{
+    return dataFormat == LADYBUG_DATAFORMAT_RAW8 || 
+        dataFormat == LADYBUG_DATAFORMAT_RAW12 || 
+        dataFormat == LADYBUG_DATAFORMAT_RAW16;
+}
+
+bool 
+DebayerEngine::isAvx2Available()
+{
+    static const bool available = isAvx2KernelBuilt() && cpuFeatures::hasAvx2();
+    return available;
+}
+
+void 
+DebayerEngine::setAlphaMaskFromTexture( 
+    unsigned int camera, 
+    const unsigned char* pTexture, 
+    unsigned int cols, 
+    unsigned int rows, 
+    LadybugPixelFormat pixelFormat )
+{
+    if ( camera >= LADYBUG_NUM_CAMERAS || pTexture == NULL )
+    {
+        return;
+    }
+
+    AlphaMask& mask = m_alphaMasks[camera];
+    mask.cols = cols;
+    mask.rows = rows;
+    mask.data.resize( cols * rows );
+
+    if ( pixelFormat == LADYBUG_BGRU16 )
+    {
+        const uint16_t* pPixels = reinterpret_cast<const uint16_t*>( pTexture );
+        for ( size_t i = 0; i < mask.data.size(); i++ )
+        {
+            mask.data[i] = (unsigned char)( pPixels[i * 4 + 3] >> 8 );
+        }
+    }
+    else
+    {
+        for ( size_t i = 0; i < mask.data.size(); i++ )
+        {
+            mask.data[i] = pTexture[i * 4 + 3];
+        }
+    }
+}
+
+bool 
+DebayerEngine::hasAlphaMask( unsigned int camera ) const
+{
+    return camera < LADYBUG_NUM_CAMERAS && !m_alphaMasks[camera].data.empty();
+}
+
+LadybugError 
+DebayerEngine::convert( 
+    const LadybugImage& image, 
+    Method method, 
+    unsigned char** arpDest, 
+    LadybugPixelFormat pixelFormat )
+{
+    ImageFormat destFormat;
+    if ( arpDest == NULL || !imageFormat::fromLadybugPixelFormat( pixelFormat, destFormat ) )
+    {
+        return LADYBUG_INVALID_ARGUMENT;
+    }
+
+    return convert( image, method, arpDest, destFormat );
+}
+
+LadybugError 
+DebayerEngine::convert( 
+    const LadybugImage& image, 
+    Method method, 
+    unsigned char** arpDest, 
+    ImageFormat destFormat )
+{
+    if ( arpDest == NULL )
+    {
+        return LADYBUG_INVALID_ARGUMENT;
+    }
+
+    ConversionSetup setup;
+    const LadybugError error = prepareConversion( image, method, destFormat, m_useAvx2, setup );
+    if ( error != LADYBUG_OK )
+    {
+        return error;
+    }
+
+    const size_t destRowBytes = imageFormat::getRowBytes( destFormat, image.uiCols );
+    const unsigned int bandsPerCamera = ( image.uiRows + k_bandRows - 1 ) / k_bandRows;
+    const AlphaMask* pMasks = m_alphaMasks;
+
+    m_pool.parallelFor( 
+        bandsPerCamera * LADYBUG_NUM_CAMERAS, 
+        [&]( unsigned int task )
+    {
+        const unsigned int camera = task / bandsPerCamera;
+        const unsigned int firstRow = ( task % bandsPerCamera ) * k_bandRows;
+        if ( arpDest[camera] == NULL )
+        {
+            return;
+        }
+
+        const AlphaMask& mask = pMasks[camera];
+        const bool useMask = mask.cols == image.uiCols && mask.rows == image.uiRows && !mask.data.empty();
+
+        convertBand( 
+            setup, 
+            image, 
+            camera, 
+            firstRow, 
+            std::min( image.uiRows, firstRow + k_bandRows ), 
+            0, 
+            image.uiCols, 
+            arpDest[camera] + firstRow * destRowBytes, 
+            destRowBytes, 
+            useMask ? &mask.data[0] : NULL );
+    } );
+
+    return LADYBUG_OK;
+}
+
+LadybugError 
+DebayerEngine::convertRegion( 
+    const LadybugImage& image, 
+    Method method, 
+    unsigned int camera, 
+    unsigned int firstCol, 
+    unsigned int firstRow, 
+    unsigned int width, 
+    unsigned int height, 
+    unsigned char* pDest, 
+    size_t destRowBytes, 
+    ImageFormat destFormat ) const
+{
+    if ( pDest == NULL || camera >= LADYBUG_NUM_CAMERAS || 
+        firstCol + width > image.uiCols || firstRow + height > image.uiRows )
+    {
+        return LADYBUG_INVALID_ARGUMENT;
+    }
+
+    ConversionSetup setup;
+    const LadybugError error = prepareConversion( image, method, destFormat, m_useAvx2, setup );
+    if ( error != LADYBUG_OK )
+    {
+        return error;
+    }
+
+    for ( unsigned int row = firstRow; row < firstRow + height; row += k_bandRows )
+    {
+        convertBand( 
+            setup, 
+            image, 
+            camera, 
+            row, 
+            std::min( firstRow + height, row + k_bandRows ), 
+            firstCol, 
+            firstCol + width, 
+            pDest + ( row - firstRow ) * destRowBytes, 
+            destRowBytes, 
+            NULL );
+    }
+
+    return LADYBUG_OK;
+}
@@ -0,0 +1,135 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __DEBAYERENGINE_H__
+#define __DEBAYERENGINE_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <vector>
+
+#include <ladybug.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "ImageFormat.h"
+#include "ThreadPool.h"
+
+/**
+ * CPU color processing of uncompressed Ladybug images.
+ *
+ * Each of the six Bayer images is split into bands of rows and the bands 
+ * of all cameras are processed in parallel. The row kernels use AVX2 when 
+ * the processor supports it. The output has the same layout as the 
+ * texture buffers filled by ladybugConvertImage(), so it can be passed 
+ * to ladybugUpdateTextures() directly.
+ */
+class DebayerEngine
+{
+public:
+    enum Method
+    {
+        METHOD_NEAREST,     /**< Copy from the 2x2 Bayer quad. */
+        METHOD_BILINEAR,    /**< Average of the nearest samples. */
+        METHOD_HQ_LINEAR    /**< Gradient corrected linear (Malvar-He-Cutler). */
+    };
+
+    /** numThreads of 0 uses one thread per hardware thread. */
+    explicit DebayerEngine( unsigned int numThreads = 0 );
+
+    /** Whether images of this data format can be processed. */
+    static bool isSupported( LadybugDataFormat dataFormat );
+
+    /** Whether the AVX2 row kernels are built in and usable on this CPU. */
+    static bool isAvx2Available();
+
+    /** Use the portable row kernels even when AVX2 is available. */
+    void setUseAvx2( bool useAvx2 ) { m_useAvx2 = useAvx2 && isAvx2Available(); }
+    bool getUseAvx2() const { return m_useAvx2; }
+
+    unsigned int getNumThreads() const { return m_pool.getNumThreads(); }
+
+    /**
+     * Keep the alpha (U) channel of an image converted by the SDK, so that 
+     * later conversions carry the same stitching mask. Without a mask the 
+     * alpha channel is set to opaque.
+     */
+    void setAlphaMaskFromTexture( 
+        unsigned int camera, 
+        const unsigned char* pTexture, 
+        unsigned int cols, 
+        unsigned int rows, 
+        LadybugPixelFormat pixelFormat );
+
+    bool hasAlphaMask( unsigned int camera ) const;
+
+    /**
+     * Color process all six cameras of the image into arpDest, which 
+     * must hold uiCols x uiRows pixels of destFormat per camera.
+     */
+    LadybugError convert( 
+        const LadybugImage& image, 
+        Method method, 
+        unsigned char** arpDest, 
+        ImageFormat destFormat );
+
+    /** 
+     * The same, for texture buffers of LADYBUG_BGRU, LADYBUG_BGRU16, 
+     * LADYBUG_BGR or LADYBUG_BGR16.
+     */
+    LadybugError convert( 
+        const LadybugImage& image, 
+        Method method, 
+        unsigned char** arpDest, 
+        LadybugPixelFormat pixelFormat );
+
+    /**
+     * Color process a rectangle of one camera on the calling thread, for
+     * callers that work on small tiles and run their own threads. Rows 
+     * of the output are destRowBytes apart. The alpha channel, if 
+     * destFormat has one, is opaque.
+     */
+    LadybugError convertRegion( 
+        const LadybugImage& image, 
+        Method method, 
+        unsigned int camera, 
+        unsigned int firstCol, 
+        unsigned int firstRow, 
+        unsigned int width, 
+        unsigned int height, 
+        unsigned char* pDest, 
+        size_t destRowBytes, 
+        ImageFormat destFormat ) const;
+
+private:
+    struct AlphaMask
+    {
+        unsigned int cols;
+        unsigned int rows;
+        std::vector<unsigned char> data;
+    };
+
+    ThreadPool m_pool;
+    bool m_useAvx2;
+    AlphaMask m_alphaMasks[LADYBUG_NUM_CAMERAS];
+};
+
+#endif // __DEBAYERENGINE_H__
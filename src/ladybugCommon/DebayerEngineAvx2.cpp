@@ -0,0 +1,126 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//
+// AVX2 row kernels. This file is built with -mavx2 and must only be 
+// entered after DebayerEngine::isAvx2Available() returned true. Keep 
+// standard library templates out of it.
+//
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "DebayerKernels.h"
+
+#if defined(__AVX2__) || ( defined(_MSC_VER) && defined(_M_X64) )
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <immintrin.h>
+
+namespace
+{
+    /** Eight pixels, one per 32 bit lane. */
+    struct Avx2Ops
+    {
+        typedef __m256i Vec;
+        enum { LANES = 8 };
+
+        static Vec set( int value ) { return _mm256_set1_epi32( value ); }
+
+        static Vec load( const uint16_t* pRow, int x )
+        {
+            return _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( pRow + x ) ) );
+        }
+
+        static Vec loadAlpha( const uint8_t* pAlpha, int x )
+        {
+            return _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( pAlpha + x ) ) );
+        }
+
+        static Vec add( Vec a, Vec b ) { return _mm256_add_epi32( a, b ); }
+        static Vec sub( Vec a, Vec b ) { return _mm256_sub_epi32( a, b ); }
+        static Vec shiftLeft( Vec a, int bits ) { return _mm256_sll_epi32( a, _mm_cvtsi32_si128( bits ) ); }
+        static Vec shiftRight( Vec a, int bits ) { return _mm256_sra_epi32( a, _mm_cvtsi32_si128( bits ) ); }
+
+        static Vec selectOdd( Vec even, Vec odd )
+        {
+            return _mm256_blend_epi32( even, odd, 0xAA );
+        }
+
+        static Vec clamp( Vec a, Vec low, Vec high )
+        {
+            return _mm256_min_epi32( _mm256_max_epi32( a, low ), high );
+        }
+
+        static void store8( uint8_t* pDest, Vec b, Vec g, Vec r, Vec u )
+        {
+            const Vec packed = _mm256_or_si256( 
+                _mm256_or_si256( b, _mm256_slli_epi32( g, 8 ) ), 
+                _mm256_or_si256( _mm256_slli_epi32( r, 16 ), _mm256_slli_epi32( u, 24 ) ) );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDest ), packed );
+        }
+
+        static void store16( uint16_t* pDest, Vec b, Vec g, Vec r, Vec u )
+        {
+            const Vec bg = _mm256_or_si256( b, _mm256_slli_epi32( g, 16 ) );
+            const Vec ru = _mm256_or_si256( r, _mm256_slli_epi32( u, 16 ) );
+
+            // Pixels 0, 1, 4, 5 and 2, 3, 6, 7
+            const Vec low = _mm256_unpacklo_epi32( bg, ru );
+            const Vec high = _mm256_unpackhi_epi32( bg, ru );
+
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDest ), _mm256_permute2x128_si256( low, high, 0x20 ) );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDest + 16 ), _mm256_permute2x128_si256( low, high, 0x31 ) );
+        }
+    };
+}
+
+void 
+debayer::processRowAvx2( const RowJob& job )
+{
+    const int vectorEnd = job.cols - job.cols % Avx2Ops::LANES;
+
+    processRow<Avx2Ops>( job, 0, vectorEnd );
+    processRow<ScalarOps>( job, vectorEnd, job.cols );
+}
+
+bool 
+debayer::isAvx2KernelBuilt()
+{
+    return true;
+}
+
+#else
+
+void 
+debayer::processRowAvx2( const RowJob& job )
+{
+    processRowScalar( job );
+}
+
+bool 
+debayer::isAvx2KernelBuilt()
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,305 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __DEBAYERKERNELS_H__
+#define __DEBAYERKERNELS_H__
+
+//
+// Row kernels shared by DebayerEngine.cpp and DebayerEngineAvx2.cpp.
+//
+// The kernels are templates over a small set of vector operations, so the
+// portable and AVX2 builds run exactly the same arithmetic. Everything 
+// with code in it lives in an unnamed namespace: DebayerEngineAvx2.cpp is 
+// compiled with -mavx2, and the linker must never pick one of its copies 
+// for the portable path.
+//
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stddef.h>
+#include <stdint.h>
+
+namespace debayer
+{
+    /** How one output channel is computed at one Bayer site. */
+    enum FormulaKind
+    {
+        FORMULA_SAMPLE,     /**< Value at (dx, dy). */
+        FORMULA_CROSS,      /**< Average of N, S, E, W. */
+        FORMULA_HORIZONTAL, /**< Average of W, E. */
+        FORMULA_VERTICAL,   /**< Average of N, S. */
+        FORMULA_DIAGONAL,   /**< Average of NW, NE, SW, SE. */
+        FORMULA_HQ_CROSS,
+        FORMULA_HQ_HORIZONTAL,
+        FORMULA_HQ_VERTICAL,
+        FORMULA_HQ_DIAGONAL
+    };
+
+    struct Formula
+    {
+        FormulaKind kind;
+        int dx;
+        int dy;
+    };
+
+    /** One output row. */
+    struct RowJob
+    {
+        /** 
+         * Source rows y-2 .. y+2, each with two mirrored pixels on both 
+         * sides, so that pRows[i][x] is valid for x in [-2, cols + 2).
+         */
+        const uint16_t* pRows[5];
+
+        /** Per output channel (B, G, R), for even and odd columns. */
+        Formula formulas[3][2];
+
+        /** Alpha mask row, or NULL for opaque. */
+        const uint8_t* pAlpha;
+
+        int cols;
+        int maxValue;
+
+        /** Shift from the source bit depth to the output bit depth. */
+        int shiftRight8;
+        int shiftLeft16;
+
+        bool output16;
+        void* pDest;
+    };
+
+    /** Process one row with the portable kernel. */
+    void processRowScalar( const RowJob& job );
+
+    /** Process one row with the AVX2 kernel. Only call when available. */
+    void processRowAvx2( const RowJob& job );
+
+    /** Whether processRowAvx2() was built with AVX2 code. */
+    bool isAvx2KernelBuilt();
+
+    namespace
+    {
+        template <class Ops>
+        inline typename Ops::Vec
+        evaluate( const Formula& formula, const uint16_t* const* pRows, int x )
+        {
+            typedef typename Ops::Vec Vec;
+
+            const uint16_t* pNN = pRows[0];
+            const uint16_t* pN = pRows[1];
+            const uint16_t* pC = pRows[2];
+            const uint16_t* pS = pRows[3];
+            const uint16_t* pSS = pRows[4];
+
+            switch ( formula.kind )
+            {
+            case FORMULA_SAMPLE:
+                return Ops::load( pRows[2 + formula.dy], x + formula.dx );
+
+            case FORMULA_CROSS:
+                {
+                    Vec sum = Ops::add( 
+                        Ops::add( Ops::load( pN, x ), Ops::load( pS, x ) ), 
+                        Ops::add( Ops::load( pC, x - 1 ), Ops::load( pC, x + 1 ) ) );
+                    return Ops::shiftRight( Ops::add( sum, Ops::set( 2 ) ), 2 );
+                }
+
+            case FORMULA_HORIZONTAL:
+                {
+                    Vec sum = Ops::add( Ops::load( pC, x - 1 ), Ops::load( pC, x + 1 ) );
+                    return Ops::shiftRight( Ops::add( sum, Ops::set( 1 ) ), 1 );
+                }
+
+            case FORMULA_VERTICAL:
+                {
+                    Vec sum = Ops::add( Ops::load( pN, x ), Ops::load( pS, x ) );
+                    return Ops::shiftRight( Ops::add( sum, Ops::set( 1 ) ), 1 );
+                }
+
+            case FORMULA_DIAGONAL:
+                {
+                    Vec sum = Ops::add( 
+                        Ops::add( Ops::load( pN, x - 1 ), Ops::load( pN, x + 1 ) ), 
+                        Ops::add( Ops::load( pS, x - 1 ), Ops::load( pS, x + 1 ) ) );
+                    return Ops::shiftRight( Ops::add( sum, Ops::set( 2 ) ), 2 );
+                }
+
+            default:
+                break;
+            }
+
+            // Gradient corrected formulas, with weights scaled by 16
+            const Vec center = Ops::load( pC, x );
+            const Vec cross = Ops::add( 
+                Ops::add( Ops::load( pN, x ), Ops::load( pS, x ) ), 
+                Ops::add( Ops::load( pC, x - 1 ), Ops::load( pC, x + 1 ) ) );
+            const Vec farVertical = Ops::add( Ops::load( pNN, x ), Ops::load( pSS, x ) );
+            const Vec farHorizontal = Ops::add( Ops::load( pC, x - 2 ), Ops::load( pC, x + 2 ) );
+
+            Vec sum;
+            switch ( formula.kind )
+            {
+            case FORMULA_HQ_CROSS:
+                // 8C + 4(N + S + W + E) - 2(NN + SS + WW + EE)
+                sum = Ops::sub( 
+                    Ops::add( Ops::shiftLeft( center, 3 ), Ops::shiftLeft( cross, 2 ) ), 
+                    Ops::shiftLeft( Ops::add( farVertical, farHorizontal ), 1 ) );
+                break;
+
+            case FORMULA_HQ_HORIZONTAL:
+            case FORMULA_HQ_VERTICAL:
+                {
+                    const bool horizontal = formula.kind == FORMULA_HQ_HORIZONTAL;
+                    const Vec diagonal = Ops::add( 
+                        Ops::add( Ops::load( pN, x - 1 ), Ops::load( pN, x + 1 ) ), 
+                        Ops::add( Ops::load( pS, x - 1 ), Ops::load( pS, x + 1 ) ) );
+                    const Vec nearSum = horizontal 
+                        ? Ops::add( Ops::load( pC, x - 1 ), Ops::load( pC, x + 1 ) ) 
+                        : Ops::add( Ops::load( pN, x ), Ops::load( pS, x ) );
+                    const Vec farAlong = horizontal ? farHorizontal : farVertical;
+                    const Vec farAcross = horizontal ? farVertical : farHorizontal;
+
+                    // 10C + 8(near) - 2(far along + diagonal) + (far across)
+                    sum = Ops::add( 
+                        Ops::add( Ops::shiftLeft( center, 3 ), Ops::shiftLeft( center, 1 ) ), 
+                        Ops::shiftLeft( nearSum, 3 ) );
+                    sum = Ops::sub( sum, Ops::shiftLeft( Ops::add( farAlong, diagonal ), 1 ) );
+                    sum = Ops::add( sum, farAcross );
+                }
+                break;
+
+            default:
+                {
+                    const Vec diagonal = Ops::add( 
+                        Ops::add( Ops::load( pN, x - 1 ), Ops::load( pN, x + 1 ) ), 
+                        Ops::add( Ops::load( pS, x - 1 ), Ops::load( pS, x + 1 ) ) );
+                    const Vec farSum = Ops::add( farVertical, farHorizontal );
+
+                    // 12C + 4(diagonal) - 3(NN + SS + WW + EE)
+                    sum = Ops::add( 
+                        Ops::add( Ops::shiftLeft( center, 3 ), Ops::shiftLeft( center, 2 ) ), 
+                        Ops::shiftLeft( diagonal, 2 ) );
+                    sum = Ops::sub( sum, Ops::add( Ops::shiftLeft( farSum, 1 ), farSum ) );
+                }
+                break;
+            }
+
+            return Ops::shiftRight( Ops::add( sum, Ops::set( 8 ) ), 4 );
+        }
+
+        template <class Ops>
+        inline typename Ops::Vec
+        evaluateChannel( const RowJob& job, int channel, int x )
+        {
+            if ( Ops::LANES == 1 )
+            {
+                return evaluate<Ops>( job.formulas[channel][x & 1], job.pRows, x );
+            }
+
+            // Vectors always start on an even column
+            return Ops::selectOdd( 
+                evaluate<Ops>( job.formulas[channel][0], job.pRows, x ), 
+                evaluate<Ops>( job.formulas[channel][1], job.pRows, x ) );
+        }
+
+        /** Process columns [xBegin, xEnd) of a row, a whole vector at a time. */
+        template <class Ops>
+        void
+        processRow( const RowJob& job, int xBegin, int xEnd )
+        {
+            typedef typename Ops::Vec Vec;
+
+            const Vec zero = Ops::set( 0 );
+            const Vec maxValue = Ops::set( job.maxValue );
+            const Vec opaque = Ops::set( 0xFF );
+
+            for ( int x = xBegin; x + Ops::LANES <= xEnd; x += Ops::LANES )
+            {
+                Vec bgr[3];
+                for ( int channel = 0; channel < 3; channel++ )
+                {
+                    bgr[channel] = Ops::clamp( evaluateChannel<Ops>( job, channel, x ), zero, maxValue );
+                }
+
+                const Vec alpha = job.pAlpha != NULL ? Ops::loadAlpha( job.pAlpha, x ) : opaque;
+
+                if ( job.output16 )
+                {
+                    for ( int channel = 0; channel < 3; channel++ )
+                    {
+                        bgr[channel] = Ops::shiftLeft( bgr[channel], job.shiftLeft16 );
+                    }
+
+                    Ops::store16( 
+                        static_cast<uint16_t*>( job.pDest ) + x * 4, 
+                        bgr[0], bgr[1], bgr[2], Ops::add( Ops::shiftLeft( alpha, 8 ), alpha ) );
+                }
+                else
+                {
+                    for ( int channel = 0; channel < 3; channel++ )
+                    {
+                        bgr[channel] = Ops::shiftRight( bgr[channel], job.shiftRight8 );
+                    }
+
+                    Ops::store8( static_cast<uint8_t*>( job.pDest ) + x * 4, bgr[0], bgr[1], bgr[2], alpha );
+                }
+            }
+        }
+
+        /** One pixel at a time. */
+        struct ScalarOps
+        {
+            typedef int32_t Vec;
+            enum { LANES = 1 };
+
+            static Vec set( int value ) { return value; }
+            static Vec load( const uint16_t* pRow, int x ) { return pRow[x]; }
+            static Vec loadAlpha( const uint8_t* pAlpha, int x ) { return pAlpha[x]; }
+            static Vec add( Vec a, Vec b ) { return a + b; }
+            static Vec sub( Vec a, Vec b ) { return a - b; }
+            static Vec shiftLeft( Vec a, int bits ) { return a << bits; }
+            static Vec shiftRight( Vec a, int bits ) { return a >> bits; }
+            static Vec selectOdd( Vec even, Vec ) { return even; }
+
+            static Vec clamp( Vec a, Vec low, Vec high )
+            {
+                return a < low ? low : ( a > high ? high : a );
+            }
+
+            static void store8( uint8_t* pDest, Vec b, Vec g, Vec r, Vec u )
+            {
+                pDest[0] = (uint8_t)b;
+                pDest[1] = (uint8_t)g;
+                pDest[2] = (uint8_t)r;
+                pDest[3] = (uint8_t)u;
+            }
+
+            static void store16( uint16_t* pDest, Vec b, Vec g, Vec r, Vec u )
+            {
+                pDest[0] = (uint16_t)b;
+                pDest[1] = (uint16_t)g;
+                pDest[2] = (uint16_t)r;
+                pDest[3] = (uint16_t)u;
+            }
+        };
+    }
+}
+
+#endif // __DEBAYERKERNELS_H__
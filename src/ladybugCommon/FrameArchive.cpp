@@ -0,0 +1,520 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "BinaryFile.h"
+#include "FrameArchive.h"
+
+const char* const frameArchive::k_extension = ".lba";
+
+namespace
+{
+    using binaryFile::computeCrc;
+    using binaryFile::getU32;
+    using binaryFile::getU64;
+    using binaryFile::putU32;
+    using binaryFile::putU64;
+
+    const char k_headerMagic[4] = { 'L', 'B', 'F', 'A' };
+    const char k_entryMagic[4] = { 'L', 'B', 'F', 'E' };
+    const char k_footerMagic[4] = { 'L', 'B', 'F', 'I' };
+    const unsigned int k_version = 1;
+
+    const unsigned int k_headerSize = 8;
+    const unsigned int k_entryHeaderSize = 4 + 4 + 8 + 4;
+    const unsigned int k_indexRecordSize = 8 + 8 + 4 + 4;
+    const unsigned int k_footerSize = 8 + 4 + 4;
+
+    // Longer names are taken as a sign of a damaged entry
+    const unsigned int k_maxNameSize = 4096;
+
+    bool seekTo( std::FILE* pFile, unsigned long long offset )
+    {
+#ifdef _WIN32
+        return _fseeki64( pFile, (__int64)offset, SEEK_SET ) == 0;
+#else
+        return fseeko( pFile, (off_t)offset, SEEK_SET ) == 0;
+#endif
+    }
+
+    bool getFileSize( std::FILE* pFile, unsigned long long& size )
+    {
+#ifdef _WIN32
+        if ( _fseeki64( pFile, 0, SEEK_END ) != 0 )
+        {
+            return false;
+        }
+        size = (unsigned long long)_ftelli64( pFile );
+#else
+        if ( fseeko( pFile, 0, SEEK_END ) != 0 )
+        {
+            return false;
+        }
+        size = (unsigned long long)ftello( pFile );
+#endif
+        return true;
+    }
+
+    bool readBytes( std::FILE* pFile, void* pData, size_t size )
+    {
+        return size == 0 || fread( pData, 1, size, pFile ) == size;
+    }
+}
+
+bool 
+frameArchive::isArchivePath( const std::string& path )
+{
+    const size_t extensionSize = strlen( k_extension );
+    return path.size() > extensionSize && 
+        path.compare( path.size() - extensionSize, extensionSize, k_extension ) == 0;
+}
+
+//=============================================================================
+// FrameArchiveWriter
+//=============================================================================
+
+FrameArchiveWriter::FrameArchiveWriter() :
+m_pFile( NULL ),
+m_size( 0 ),
+m_writeFailed( false )
+{
+}
+
+FrameArchiveWriter::~FrameArchiveWriter()
+{
+    std::string errorMessage;
+    close( errorMessage );
+}
+
+bool 
+FrameArchiveWriter::open( const std::string& path, std::string& errorMessage )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( m_pFile != NULL )
+    {
+        errorMessage = "Archive " + m_path + " is already open";
+        return false;
+    }
+
+    m_pFile = fopen( path.c_str(), "wb" );
+    if ( m_pFile == NULL )
+    {
+        errorMessage = "Unable to create " + path;
+        return false;
+    }
+
+    unsigned char header[k_headerSize];
+    memcpy( header, k_headerMagic, 4 );
+    putU32( header + 4, k_version );
+    m_writeFailed = fwrite( header, 1, sizeof(header), m_pFile ) != sizeof(header);
+
+    m_path = path;
+    m_size = k_headerSize;
+    m_entries.clear();
+    return true;
+}
+
+bool 
+FrameArchiveWriter::resume( const std::string& path, std::string& errorMessage )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( m_pFile != NULL )
+    {
+        errorMessage = "Archive " + m_path + " is already open";
+        return false;
+    }
+
+    FrameArchiveReader reader;
+    if ( !reader.open( path, errorMessage ) )
+    {
+        return false;
+    }
+
+    const unsigned long long entriesEnd = reader.getEntriesEnd();
+    std::vector<frameArchive::Entry> entries;
+    for ( unsigned int i = 0; i < reader.getNumEntries(); i++ )
+    {
+        entries.push_back( reader.getEntry( i ) );
+    }
+    reader.close();
+
+    // Drop the index or the torn entry, if any, so that appending continues after the last entry
+#ifdef _WIN32
+    errorMessage = "Resuming archives is not supported on this platform";
+    return false;
+#else
+    if ( truncate( path.c_str(), (off_t)entriesEnd ) != 0 )
+    {
+        errorMessage = "Unable to truncate " + path;
+        return false;
+    }
+#endif
+
+    m_pFile = fopen( path.c_str(), "ab" );
+    if ( m_pFile == NULL )
+    {
+        errorMessage = "Unable to open " + path;
+        return false;
+    }
+
+    m_path = path;
+    m_size = entriesEnd;
+    m_entries.swap( entries );
+    m_writeFailed = false;
+    return true;
+}
+
+bool 
+FrameArchiveWriter::append( const std::string& name, const void* pData, size_t size )
+{
+    if ( name.empty() || name.size() > k_maxNameSize )
+    {
+        return false;
+    }
+
+    frameArchive::Entry entry;
+    entry.name = name;
+    entry.dataSize = size;
+    entry.crc = computeCrc( pData, size );
+
+    unsigned char header[k_entryHeaderSize];
+    memcpy( header, k_entryMagic, 4 );
+    putU32( header + 4, (unsigned int)name.size() );
+    putU64( header + 8, entry.dataSize );
+    putU32( header + 16, entry.crc );
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( m_pFile == NULL || m_writeFailed )
+    {
+        return false;
+    }
+
+    // After a failed write the file ends in a torn entry, so nothing more is appended
+    m_writeFailed = 
+        fwrite( header, 1, sizeof(header), m_pFile ) != sizeof(header) ||
+        fwrite( name.data(), 1, name.size(), m_pFile ) != name.size() ||
+        ( size > 0 && fwrite( pData, 1, size, m_pFile ) != size );
+    if ( m_writeFailed )
+    {
+        return false;
+    }
+
+    entry.dataOffset = m_size + k_entryHeaderSize + name.size();
+    m_size = entry.dataOffset + size;
+    m_entries.push_back( entry );
+    return true;
+}
+
+bool 
+FrameArchiveWriter::close( std::string& errorMessage )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( m_pFile == NULL )
+    {
+        return true;
+    }
+
+    bool isWritten = !m_writeFailed;
+    if ( isWritten )
+    {
+        std::vector<unsigned char> index;
+        for ( size_t i = 0; i < m_entries.size(); i++ )
+        {
+            const frameArchive::Entry& entry = m_entries[i];
+            const size_t recordOffset = index.size();
+            index.resize( recordOffset + k_indexRecordSize + entry.name.size() );
+
+            unsigned char* p = &index[recordOffset];
+            putU64( p, entry.dataOffset );
+            putU64( p + 8, entry.dataSize );
+            putU32( p + 16, entry.crc );
+            putU32( p + 20, (unsigned int)entry.name.size() );
+            memcpy( p + k_indexRecordSize, entry.name.data(), entry.name.size() );
+        }
+
+        unsigned char footer[k_footerSize];
+        putU64( footer, m_size );
+        putU32( footer + 8, (unsigned int)m_entries.size() );
+        memcpy( footer + 12, k_footerMagic, 4 );
+
+        isWritten = 
+            ( index.empty() || fwrite( &index[0], 1, index.size(), m_pFile ) == index.size() ) &&
+            fwrite( footer, 1, sizeof(footer), m_pFile ) == sizeof(footer);
+    }
+
+    isWritten = fclose( m_pFile ) == 0 && isWritten;
+    m_pFile = NULL;
+
+    if ( !isWritten )
+    {
+        errorMessage = "Unable to write " + m_path;
+    }
+    return isWritten;
+}
+
+unsigned int 
+FrameArchiveWriter::getNumEntries() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return (unsigned int)m_entries.size();
+}
+
+unsigned long long 
+FrameArchiveWriter::getSize() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_size;
+}
+
+//=============================================================================
+// FrameArchiveReader
+//=============================================================================
+
+FrameArchiveReader::FrameArchiveReader() :
+m_pFile( NULL ),
+m_entriesEnd( 0 ),
+m_isRecovered( false )
+{
+}
+
+FrameArchiveReader::~FrameArchiveReader()
+{
+    close();
+}
+
+bool 
+FrameArchiveReader::open( const std::string& path, std::string& errorMessage )
+{
+    close();
+
+    m_pFile = fopen( path.c_str(), "rb" );
+    if ( m_pFile == NULL )
+    {
+        errorMessage = "Unable to open " + path;
+        return false;
+    }
+
+    unsigned long long fileSize = 0;
+    unsigned char header[k_headerSize];
+    if ( !getFileSize( m_pFile, fileSize ) || 
+        !seekTo( m_pFile, 0 ) || 
+        !readBytes( m_pFile, header, sizeof(header) ) ||
+        memcmp( header, k_headerMagic, 4 ) != 0 )
+    {
+        errorMessage = path + " is not a frame archive";
+        close();
+        return false;
+    }
+
+    if ( getU32( header + 4 ) != k_version )
+    {
+        errorMessage = path + " has an unsupported version";
+        close();
+        return false;
+    }
+
+    m_isRecovered = !readIndex( fileSize );
+    if ( m_isRecovered )
+    {
+        scanEntries( fileSize );
+    }
+
+    for ( unsigned int i = 0; i < m_entries.size(); i++ )
+    {
+        m_entriesByName[ m_entries[i].name ] = i;
+    }
+    return true;
+}
+
+void 
+FrameArchiveReader::close()
+{
+    if ( m_pFile != NULL )
+    {
+        fclose( m_pFile );
+        m_pFile = NULL;
+    }
+    m_entries.clear();
+    m_entriesByName.clear();
+    m_entriesEnd = 0;
+    m_isRecovered = false;
+}
+
+bool 
+FrameArchiveReader::readIndex( unsigned long long fileSize )
+{
+    m_entries.clear();
+    if ( fileSize < k_headerSize + k_footerSize )
+    {
+        return false;
+    }
+
+    unsigned char footer[k_footerSize];
+    if ( !seekTo( m_pFile, fileSize - k_footerSize ) || 
+        !readBytes( m_pFile, footer, sizeof(footer) ) ||
+        memcmp( footer + 12, k_footerMagic, 4 ) != 0 )
+    {
+        return false;
+    }
+
+    const unsigned long long indexOffset = getU64( footer );
+    const unsigned int numEntries = getU32( footer + 8 );
+    const unsigned long long indexEnd = fileSize - k_footerSize;
+    if ( indexOffset < k_headerSize || indexOffset > indexEnd || 
+        (unsigned long long)numEntries * k_indexRecordSize > indexEnd - indexOffset )
+    {
+        return false;
+    }
+
+    std::vector<unsigned char> index( (size_t)( indexEnd - indexOffset ) );
+    if ( !seekTo( m_pFile, indexOffset ) || !readBytes( m_pFile, index.empty() ? NULL : &index[0], index.size() ) )
+    {
+        return false;
+    }
+
+    size_t position = 0;
+    for ( unsigned int i = 0; i < numEntries; i++ )
+    {
+        if ( index.size() - position < k_indexRecordSize )
+        {
+            return false;
+        }
+
+        const unsigned char* p = &index[position];
+        frameArchive::Entry entry;
+        entry.dataOffset = getU64( p );
+        entry.dataSize = getU64( p + 8 );
+        entry.crc = getU32( p + 16 );
+        const unsigned int nameSize = getU32( p + 20 );
+        position += k_indexRecordSize;
+
+        if ( nameSize > index.size() - position || 
+            entry.dataOffset > indexOffset || 
+            entry.dataSize > indexOffset - entry.dataOffset )
+        {
+            return false;
+        }
+
+        entry.name.assign( reinterpret_cast<const char*>( &index[position] ), nameSize );
+        position += nameSize;
+        m_entries.push_back( entry );
+    }
+
+    m_entriesEnd = indexOffset;
+    return position == index.size();
+}
+
+void 
+FrameArchiveReader::scanEntries( unsigned long long fileSize )
+{
+    m_entries.clear();
+
+    std::vector<unsigned char> data;
+    unsigned long long offset = k_headerSize;
+    for ( ;; )
+    {
+        unsigned char header[k_entryHeaderSize];
+        if ( fileSize - offset < k_entryHeaderSize ||
+            !seekTo( m_pFile, offset ) || 
+            !readBytes( m_pFile, header, sizeof(header) ) ||
+            memcmp( header, k_entryMagic, 4 ) != 0 )
+        {
+            break;
+        }
+
+        frameArchive::Entry entry;
+        const unsigned int nameSize = getU32( header + 4 );
+        entry.dataSize = getU64( header + 8 );
+        entry.crc = getU32( header + 16 );
+        entry.dataOffset = offset + k_entryHeaderSize + nameSize;
+        if ( nameSize == 0 || nameSize > k_maxNameSize || 
+            entry.dataOffset > fileSize || entry.dataSize > fileSize - entry.dataOffset )
+        {
+            break;
+        }
+
+        // The last entries may have been cut off or not reached the disk
+        entry.name.resize( nameSize );
+        data.resize( (size_t)entry.dataSize );
+        if ( !readBytes( m_pFile, &entry.name[0], nameSize ) ||
+            !readBytes( m_pFile, data.empty() ? NULL : &data[0], data.size() ) ||
+            computeCrc( data.empty() ? NULL : &data[0], data.size() ) != entry.crc )
+        {
+            break;
+        }
+
+        m_entries.push_back( entry );
+        offset = entry.dataOffset + entry.dataSize;
+    }
+
+    m_entriesEnd = offset;
+}
+
+bool 
+FrameArchiveReader::find( const std::string& name, unsigned int& index ) const
+{
+    std::map<std::string, unsigned int>::const_iterator it = m_entriesByName.find( name );
+    if ( it == m_entriesByName.end() )
+    {
+        return false;
+    }
+
+    index = it->second;
+    return true;
+}
+
+bool 
+FrameArchiveReader::read( unsigned int index, std::vector<unsigned char>& data, std::string& errorMessage )
+{
+    if ( m_pFile == NULL || index >= m_entries.size() )
+    {
+        errorMessage = "No such entry";
+        return false;
+    }
+
+    const frameArchive::Entry& entry = m_entries[index];
+    data.resize( (size_t)entry.dataSize );
+    if ( !seekTo( m_pFile, entry.dataOffset ) || !readBytes( m_pFile, data.empty() ? NULL : &data[0], data.size() ) )
+    {
+        errorMessage = "Unable to read " + entry.name;
+        return false;
+    }
+
+    if ( computeCrc( data.empty() ? NULL : &data[0], data.size() ) != entry.crc )
+    {
+        errorMessage = entry.name + " is damaged";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,148 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __FRAMEARCHIVE_H__
+#define __FRAMEARCHIVE_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A single append-only file holding the images a tool writes for every 
+ * frame, in place of one file per frame or cube face.
+ *
+ * Layout, with little endian integers:
+ *
+ *   header  "LBFA", version (4 bytes)
+ *   entry   "LBFE", name size (4), data size (8), CRC-32 of data (4), 
+ *           name, data
+ *   ...
+ *   index   for each entry: offset of its data (8), data size (8), 
+ *           CRC-32 (4), name size (4), name
+ *   footer  offset of the index (8), number of entries (4), "LBFI"
+ *
+ * The index is only written when the archive is closed. Without it, for
+ * example after a crash, the reader rebuilds it by scanning the entries 
+ * and stops at the first one that is incomplete or fails its CRC.
+ */
+namespace frameArchive
+{
+    struct Entry
+    {
+        std::string name;
+        unsigned long long dataOffset;
+        unsigned long long dataSize;
+        unsigned int crc;
+    };
+
+    /** Archive files are recognized by this extension, ".lba". */
+    extern const char* const k_extension;
+
+    /** Whether an output path names an archive rather than a file or directory. */
+    bool isArchivePath( const std::string& path );
+}
+
+class FrameArchiveWriter
+{
+public:
+    FrameArchiveWriter();
+
+    /** Closes the archive if it is still open. */
+    ~FrameArchiveWriter();
+
+    /** Create a new archive, replacing any file at path. */
+    bool open( const std::string& path, std::string& errorMessage );
+
+    /** 
+     * Continue an archive that was not closed: keep its complete entries,
+     * cut off anything after them and append from there. close() then
+     * writes the index, which repairs the archive.
+     */
+    bool resume( const std::string& path, std::string& errorMessage );
+
+    bool isOpen() const { return m_pFile != NULL; }
+
+    /** Append one entry. Can be called from several threads. */
+    bool append( const std::string& name, const void* pData, size_t size );
+
+    /** Write the index and close the file. */
+    bool close( std::string& errorMessage );
+
+    unsigned int getNumEntries() const;
+    unsigned long long getSize() const;
+
+private:
+    FrameArchiveWriter( const FrameArchiveWriter& );
+    FrameArchiveWriter& operator=( const FrameArchiveWriter& );
+
+    mutable std::mutex m_mutex;
+    std::FILE* m_pFile;
+    std::string m_path;
+    unsigned long long m_size;
+    std::vector<frameArchive::Entry> m_entries;
+    bool m_writeFailed;
+};
+
+/**
+ * Random access to the entries of an archive. Not thread safe.
+ */
+class FrameArchiveReader
+{
+public:
+    FrameArchiveReader();
+    ~FrameArchiveReader();
+
+    bool open( const std::string& path, std::string& errorMessage );
+    void close();
+
+    /** Whether the index had to be rebuilt because the archive was not closed. */
+    bool isRecovered() const { return m_isRecovered; }
+
+    /** End of the last complete entry. */
+    unsigned long long getEntriesEnd() const { return m_entriesEnd; }
+
+    unsigned int getNumEntries() const { return (unsigned int)m_entries.size(); }
+    const frameArchive::Entry& getEntry( unsigned int index ) const { return m_entries[index]; }
+
+    bool find( const std::string& name, unsigned int& index ) const;
+
+    /** Read the data of an entry and check its CRC. */
+    bool read( unsigned int index, std::vector<unsigned char>& data, std::string& errorMessage );
+
+private:
+    FrameArchiveReader( const FrameArchiveReader& );
+    FrameArchiveReader& operator=( const FrameArchiveReader& );
+
+    bool readIndex( unsigned long long fileSize );
+    void scanEntries( unsigned long long fileSize );
+
+    std::FILE* m_pFile;
+    std::vector<frameArchive::Entry> m_entries;
+    std::map<std::string, unsigned int> m_entriesByName;
+    unsigned long long m_entriesEnd;
+    bool m_isRecovered;
+};
+
+#endif // __FRAMEARCHIVE_H__
@@ -0,0 +1,347 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <ladybugGPS.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "BinaryFile.h"
+#include "GpsTrack.h"
+#include "NmeaParser.h"
+#include "StreamSegment.h"
+
+const char* const gpsTrack::k_extension = ".gpstrack";
+
+namespace
+{
+    using binaryFile::computeCrc;
+    using binaryFile::getDouble;
+    using binaryFile::getFloat;
+    using binaryFile::getU32;
+    using binaryFile::putDouble;
+    using binaryFile::putFloat;
+    using binaryFile::putU32;
+
+    const char k_headerMagic[4] = { 'L', 'B', 'G', 'T' };
+    const unsigned int k_version = 1;
+
+    const unsigned int k_headerSize = 4 + 4 + 4 + 4 + 4;
+    const unsigned int k_recordSize = 4 * 4 + 8 * 4 + 4 * 6 + 4;
+
+    // More records than this is taken as a damaged header
+    const unsigned int k_maxRecords = 100000000;
+
+    const double k_kmhPerKnot = 1.852;
+
+    void encodeRecord( const GpsTrackRecord& record, unsigned char* p )
+    {
+        putU32( p, record.frame );
+        putU32( p + 4, record.cameraSeconds );
+        putU32( p + 8, record.cameraMicroSeconds );
+        putU32( p + 12, record.flags );
+        putDouble( p + 16, record.utc );
+        putDouble( p + 24, record.latitude );
+        putDouble( p + 32, record.longitude );
+        putDouble( p + 40, record.altitude );
+        putFloat( p + 48, record.speedKmh );
+        putFloat( p + 52, record.courseDegrees );
+        putFloat( p + 56, record.roll );
+        putFloat( p + 60, record.pitch );
+        putFloat( p + 64, record.yaw );
+        putFloat( p + 68, record.hdop );
+        p[72] = record.fixQuality;
+        p[73] = record.satellites;
+        p[74] = 0;
+        p[75] = 0;
+    }
+
+    void decodeRecord( const unsigned char* p, GpsTrackRecord& record )
+    {
+        record.frame = getU32( p );
+        record.cameraSeconds = getU32( p + 4 );
+        record.cameraMicroSeconds = getU32( p + 8 );
+        record.flags = getU32( p + 12 );
+        record.utc = getDouble( p + 16 );
+        record.latitude = getDouble( p + 24 );
+        record.longitude = getDouble( p + 32 );
+        record.altitude = getDouble( p + 40 );
+        record.speedKmh = getFloat( p + 48 );
+        record.courseDegrees = getFloat( p + 52 );
+        record.roll = getFloat( p + 56 );
+        record.pitch = getFloat( p + 60 );
+        record.yaw = getFloat( p + 64 );
+        record.hdop = getFloat( p + 68 );
+        record.fixQuality = p[72];
+        record.satellites = p[73];
+    }
+
+    bool isEarlier( const GpsTrackRecord& a, const GpsTrackRecord& b )
+    {
+        return a.frame < b.frame;
+    }
+
+    void resetRecord( unsigned int frame, const LadybugImage& image, GpsTrackRecord& record )
+    {
+        memset( &record, 0, sizeof(record) );
+        record.frame = frame;
+        record.cameraSeconds = (unsigned int)image.timeStamp.ulSeconds;
+        record.cameraMicroSeconds = (unsigned int)image.timeStamp.ulMicroSeconds;
+    }
+
+    double toSecondOfDay( const NmeaTime& time )
+    {
+        return ( time.hour * 60.0 + time.minute ) * 60.0 + time.second + time.millisecond / 1000.0;
+    }
+
+    void fromNmea( const NmeaData& data, GpsTrackRecord& record )
+    {
+        if ( nmeaParser::getPosition( data, record.latitude, record.longitude ) )
+        {
+            record.flags |= gpsTrack::HAS_POSITION;
+        }
+
+        const NmeaTime* pTime = NULL;
+        if ( data.gga.valid )
+        {
+            record.flags |= gpsTrack::HAS_ALTITUDE | gpsTrack::HAS_FIX;
+            record.altitude = data.gga.altitude;
+            record.fixQuality = data.gga.fixQuality;
+            record.satellites = data.gga.satellites;
+            record.hdop = (float)data.gga.hdop;
+            pTime = &data.gga.time;
+        }
+        else if ( data.rmc.valid )
+        {
+            pTime = &data.rmc.time;
+        }
+        else if ( data.gll.valid )
+        {
+            pTime = &data.gll.time;
+        }
+
+        if ( pTime != NULL )
+        {
+            record.flags |= gpsTrack::HAS_TIME;
+            record.utc = toSecondOfDay( *pTime );
+
+            // The date only goes with the time of the same RMC sentence
+            if ( data.rmc.year != 0 && toSecondOfDay( data.rmc.time ) == record.utc )
+            {
+                record.flags |= gpsTrack::HAS_DATE;
+                record.utc += nmeaParser::getDayNumber( data.rmc.year, data.rmc.month, data.rmc.day ) * 86400.0;
+            }
+        }
+
+        if ( data.rmc.valid )
+        {
+            record.flags |= gpsTrack::HAS_SPEED | gpsTrack::HAS_COURSE;
+            record.speedKmh = (float)( data.rmc.speedKnots * k_kmhPerKnot );
+            record.courseDegrees = (float)data.rmc.courseDegrees;
+        }
+        else if ( data.vtg.valid )
+        {
+            record.flags |= gpsTrack::HAS_SPEED | gpsTrack::HAS_COURSE;
+            record.speedKmh = (float)data.vtg.speedKmh;
+            record.courseDegrees = (float)data.vtg.trueCourseDegrees;
+        }
+    }
+}
+
+bool 
+gpsTrack::isTrackPath( const std::string& path )
+{
+    const size_t extensionLength = strlen( k_extension );
+    return path.size() > extensionLength && 
+        path.compare( path.size() - extensionLength, extensionLength, k_extension ) == 0;
+}
+
+std::string 
+gpsTrack::getTrackPath( const std::string& segmentPath )
+{
+    return streamSegment::getSidecarPath( segmentPath, k_extension );
+}
+
+bool 
+gpsTrack::write( const std::string& path, std::vector<GpsTrackRecord> records, std::string& errorMessage )
+{
+    std::stable_sort( records.begin(), records.end(), isEarlier );
+
+    std::vector<unsigned char> data( k_headerSize + records.size() * k_recordSize );
+    for ( size_t i = 0; i < records.size(); i++ )
+    {
+        encodeRecord( records[i], &data[k_headerSize + i * k_recordSize] );
+    }
+
+    memcpy( &data[0], k_headerMagic, 4 );
+    putU32( &data[4], k_version );
+    putU32( &data[8], k_recordSize );
+    putU32( &data[12], (unsigned int)records.size() );
+    putU32( &data[16], computeCrc( data.data() + k_headerSize, data.size() - k_headerSize ) );
+
+    return binaryFile::writeAtomically( path, &data[0], data.size(), false, errorMessage );
+}
+
+bool 
+gpsTrack::read( const std::string& path, std::vector<GpsTrackRecord>& records, std::string& errorMessage )
+{
+    records.clear();
+
+    FILE* pFile = fopen( path.c_str(), "rb" );
+    if ( pFile == NULL )
+    {
+        errorMessage = "Unable to open " + path;
+        return false;
+    }
+
+    unsigned char header[k_headerSize];
+    const bool hasHeader = fread( header, 1, k_headerSize, pFile ) == k_headerSize;
+    const unsigned int recordSize = hasHeader ? getU32( header + 8 ) : 0;
+    const unsigned int numRecords = hasHeader ? getU32( header + 12 ) : 0;
+    if ( !hasHeader || memcmp( header, k_headerMagic, 4 ) != 0 )
+    {
+        fclose( pFile );
+        errorMessage = path + " is not a GPS track";
+        return false;
+    }
+
+    // Later versions may only append fields to a record
+    if ( getU32( header + 4 ) < k_version || recordSize < k_recordSize || numRecords > k_maxRecords )
+    {
+        fclose( pFile );
+        errorMessage = path + " has an unsupported version";
+        return false;
+    }
+
+    std::vector<unsigned char> body( (size_t)recordSize * numRecords );
+    const bool isRead = body.empty() || fread( &body[0], 1, body.size(), pFile ) == body.size();
+    fclose( pFile );
+    if ( !isRead || computeCrc( body.data(), body.size() ) != getU32( header + 16 ) )
+    {
+        errorMessage = path + " is truncated or damaged";
+        return false;
+    }
+
+    records.resize( numRecords );
+    for ( unsigned int i = 0; i < numRecords; i++ )
+    {
+        decodeRecord( &body[(size_t)i * recordSize], records[i] );
+    }
+    return true;
+}
+
+GpsTrackReader::GpsTrackReader() :
+m_isOpen( false )
+{
+}
+
+bool 
+GpsTrackReader::openForStream( const std::string& segmentPath, std::string& errorMessage )
+{
+    errorMessage.clear();
+    const std::string trackPath = gpsTrack::getTrackPath( segmentPath );
+    if ( !streamSegment::exists( trackPath ) )
+    {
+        return false;
+    }
+    return open( trackPath, errorMessage );
+}
+
+bool 
+GpsTrackReader::open( const std::string& trackPath, std::string& errorMessage )
+{
+    m_isOpen = gpsTrack::read( trackPath, m_records, errorMessage );
+    if ( !m_isOpen )
+    {
+        m_records.clear();
+    }
+    return m_isOpen;
+}
+
+GpsTrackReader::Source 
+GpsTrackReader::getFrameData( unsigned int frame, const LadybugImage& image, GpsTrackRecord& record ) const
+{
+    GpsTrackRecord key;
+    key.frame = frame;
+    const std::vector<GpsTrackRecord>::const_iterator it = 
+        std::lower_bound( m_records.begin(), m_records.end(), key, isEarlier );
+    if ( it != m_records.end() && it->frame == frame && 
+        it->cameraSeconds == (unsigned int)image.timeStamp.ulSeconds && 
+        it->cameraMicroSeconds == (unsigned int)image.timeStamp.ulMicroSeconds )
+    {
+        record = *it;
+        return SOURCE_TRACK;
+    }
+
+    return getEmbeddedData( frame, image, record );
+}
+
+GpsTrackReader::Source 
+GpsTrackReader::getEmbeddedData( unsigned int frame, const LadybugImage& image, GpsTrackRecord& record )
+{
+    resetRecord( frame, image, record );
+
+    const char* pText = NULL;
+    size_t length = 0;
+    NmeaData data;
+    if ( nmeaParser::findInImage( image, pText, length ) && nmeaParser::parse( pText, length, data ) > 0 )
+    {
+        fromNmea( data, record );
+        return SOURCE_NMEA;
+    }
+
+    // The library finds NMEA text that is not where findInImage() looks
+    LadybugNMEAGPGGA gga;
+    if ( ladybugGetGPSNMEADataFromImage( &image, "GPGGA", &gga ) == LADYBUG_OK && gga.bValidData )
+    {
+        record.flags = gpsTrack::HAS_POSITION | gpsTrack::HAS_ALTITUDE | gpsTrack::HAS_TIME;
+        record.latitude = gga.dGGALatitude;
+        record.longitude = gga.dGGALongitude;
+        record.altitude = gga.dGGAAltitude;
+        record.utc = ( gga.ucGGAHour * 60.0 + gga.ucGGAMinute ) * 60.0 + gga.ucGGASecond;
+        return SOURCE_NMEA;
+    }
+
+    const LadybugImageInfo& info = image.imageInfo;
+    if ( info.ulGpsFixQuality > 0 &&
+        info.dGPSLatitude != LADYBUG_INVALID_GPS_DATA &&
+        info.dGPSLongitude != LADYBUG_INVALID_GPS_DATA )
+    {
+        record.flags = gpsTrack::HAS_POSITION | gpsTrack::HAS_FIX;
+        record.latitude = info.dGPSLatitude;
+        record.longitude = info.dGPSLongitude;
+        record.fixQuality = (unsigned char)info.ulGpsFixQuality;
+        if ( info.dGPSAltitude != LADYBUG_INVALID_GPS_DATA )
+        {
+            record.flags |= gpsTrack::HAS_ALTITUDE;
+            record.altitude = info.dGPSAltitude;
+        }
+        return SOURCE_IMAGE_INFO;
+    }
+
+    return SOURCE_NONE;
+}
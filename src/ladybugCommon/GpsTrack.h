@@ -0,0 +1,155 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __GPSTRACK_H__
+#define __GPSTRACK_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string>
+#include <vector>
+
+#include <ladybug.h>
+
+/**
+ * GPS and pose data of one frame, kept outside the stream.
+ *
+ * Fields are only meaningful if their flag is set. Angles are in degrees,
+ * positions in decimal degrees, positive north and east.
+ */
+struct GpsTrackRecord
+{
+    unsigned int frame;
+
+    /** Camera timestamp of the frame, to check that the record belongs to it. */
+    unsigned int cameraSeconds;
+    unsigned int cameraMicroSeconds;
+
+    /** gpsTrack::HAS_... */
+    unsigned int flags;
+
+    /** Seconds since 1970 with HAS_DATE, seconds since midnight without. */
+    double utc;
+
+    double latitude;
+    double longitude;
+    double altitude;
+
+    float speedKmh;
+    float courseDegrees;
+    float roll;
+    float pitch;
+    float yaw;
+    float hdop;
+    unsigned char fixQuality;
+    unsigned char satellites;
+};
+
+/**
+ * A GPS track file (name.gpstrack next to name-000000.pgr) holds a record
+ * per frame. Tools that read GPS data from a stream take it from the track
+ * first and from the frame itself otherwise, so GPS data can be added or
+ * corrected by writing the track instead of rewriting the stream.
+ *
+ * Layout, with little endian integers and IEEE floating point:
+ *
+ *   header  "LBGT", version (4), record size (4), number of records (4),
+ *           CRC-32 of the records (4)
+ *   records sorted by frame: frame, camera seconds, camera microseconds,
+ *           flags (4 each), utc, latitude, longitude, altitude (8 each),
+ *           speed, course, roll, pitch, yaw, hdop (4 each), fix quality, 
+ *           satellites (1 each), 2 reserved bytes
+ */
+namespace gpsTrack
+{
+    enum Flags
+    {
+        HAS_POSITION = 1 << 0,
+        HAS_ALTITUDE = 1 << 1,
+        HAS_TIME = 1 << 2,
+        HAS_DATE = 1 << 3,
+        HAS_SPEED = 1 << 4,
+        HAS_COURSE = 1 << 5,
+        HAS_POSE = 1 << 6,
+        HAS_FIX = 1 << 7
+    };
+
+    /** Track files are recognized by this extension, ".gpstrack". */
+    extern const char* const k_extension;
+
+    bool isTrackPath( const std::string& path );
+
+    /** Track file that belongs to a stream segment. */
+    std::string getTrackPath( const std::string& segmentPath );
+
+    /** Sort the records by frame and replace the file at path atomically. */
+    bool write( const std::string& path, std::vector<GpsTrackRecord> records, std::string& errorMessage );
+
+    bool read( const std::string& path, std::vector<GpsTrackRecord>& records, std::string& errorMessage );
+}
+
+/**
+ * GPS data of the frames of a stream, with the track overlaid on the data
+ * embedded in the frames. Without a track it reads only the frames. Safe
+ * to use from several threads once opened.
+ */
+class GpsTrackReader
+{
+public:
+    /** Where the data of a frame came from. */
+    enum Source
+    {
+        SOURCE_NONE,
+        SOURCE_TRACK,
+        SOURCE_NMEA,
+        SOURCE_IMAGE_INFO
+    };
+
+    GpsTrackReader();
+
+    /** 
+     * Load the track of the stream whose first segment is segmentPath. 
+     * Returns false with an empty errorMessage if the stream has no track.
+     */
+    bool openForStream( const std::string& segmentPath, std::string& errorMessage );
+
+    bool open( const std::string& trackPath, std::string& errorMessage );
+
+    bool isOpen() const { return m_isOpen; }
+
+    unsigned int getNumRecords() const { return (unsigned int)m_records.size(); }
+
+    /**
+     * GPS data of a frame: the track record of the frame, or else what 
+     * is embedded in the image (NMEA text, then the image information).
+     * A track record whose camera timestamp differs from the image is 
+     * taken to belong to another stream and is ignored.
+     */
+    Source getFrameData( unsigned int frame, const LadybugImage& image, GpsTrackRecord& record ) const;
+
+    /** What is embedded in the image only. */
+    static Source getEmbeddedData( unsigned int frame, const LadybugImage& image, GpsTrackRecord& record );
+
+private:
+    bool m_isOpen;
+    std::vector<GpsTrackRecord> m_records;
+};
+
+#endif // __GPSTRACK_H__
@@ -0,0 +1,282 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "BinaryFile.h"
+#include "HdrBrackets.h"
+#include "StreamSegment.h"
+
+const char* const hdrBrackets::k_extension = ".hdrb";
+
+namespace
+{
+    using binaryFile::computeCrc;
+    using binaryFile::getDouble;
+    using binaryFile::getU32;
+    using binaryFile::putDouble;
+    using binaryFile::putU32;
+
+    const char k_headerMagic[4] = { 'L', 'B', 'H', 'B' };
+    const unsigned int k_version = 1;
+
+    const unsigned int k_headerSize = 4 + 4 + 4 + 4 + 4 + 4 + 4;
+    const unsigned int k_levelSize = 4 + 4 + 8 + 8;
+    const unsigned int k_entrySize = 4 + 4;
+
+    // More entries than this is taken as a damaged header
+    const unsigned int k_maxEntries = 100000000;
+
+    // The shutter and gain fields of an image hold the register value in 
+    // their low 12 bits
+    const unsigned int k_registerMask = 0xfff;
+}
+
+double 
+HdrBracketLevel::getExposure() const
+{
+    return shutterMs * pow( 10.0, gainDb / 20.0 );
+}
+
+std::string 
+hdrBrackets::getBracketPath( const std::string& segmentPath )
+{
+    return streamSegment::getSidecarPath( segmentPath, k_extension );
+}
+
+bool 
+hdrBrackets::write( 
+    const std::string& path, 
+    const std::vector<HdrBracketLevel>& levels, 
+    const std::vector<HdrBracketEntry>& entries, 
+    std::string& errorMessage )
+{
+    const size_t levelsSize = levels.size() * k_levelSize;
+    std::vector<unsigned char> data( k_headerSize + levelsSize + entries.size() * k_entrySize );
+    for ( size_t i = 0; i < levels.size(); i++ )
+    {
+        unsigned char* p = &data[k_headerSize + i * k_levelSize];
+        putU32( p, levels[i].shutterRegister );
+        putU32( p + 4, levels[i].gainRegister );
+        putDouble( p + 8, levels[i].shutterMs );
+        putDouble( p + 16, levels[i].gainDb );
+    }
+    for ( size_t i = 0; i < entries.size(); i++ )
+    {
+        unsigned char* p = &data[k_headerSize + levelsSize + i * k_entrySize];
+        putU32( p, entries[i].sequence );
+        putU32( p + 4, (unsigned int)entries[i].bracket );
+    }
+
+    memcpy( &data[0], k_headerMagic, 4 );
+    putU32( &data[4], k_version );
+    putU32( &data[8], k_levelSize );
+    putU32( &data[12], (unsigned int)levels.size() );
+    putU32( &data[16], k_entrySize );
+    putU32( &data[20], (unsigned int)entries.size() );
+    putU32( &data[24], computeCrc( data.data() + k_headerSize, data.size() - k_headerSize ) );
+
+    return binaryFile::writeAtomically( path, &data[0], data.size(), false, errorMessage );
+}
+
+bool 
+hdrBrackets::read( 
+    const std::string& path, 
+    std::vector<HdrBracketLevel>& levels, 
+    std::vector<HdrBracketEntry>& entries, 
+    std::string& errorMessage )
+{
+    levels.clear();
+    entries.clear();
+
+    FILE* pFile = fopen( path.c_str(), "rb" );
+    if ( pFile == NULL )
+    {
+        errorMessage = "Unable to open " + path;
+        return false;
+    }
+
+    unsigned char header[k_headerSize];
+    const bool hasHeader = fread( header, 1, k_headerSize, pFile ) == k_headerSize;
+    if ( !hasHeader || memcmp( header, k_headerMagic, 4 ) != 0 )
+    {
+        fclose( pFile );
+        errorMessage = path + " is not a bracket file";
+        return false;
+    }
+
+    // Later versions may only append fields to a level or an entry
+    const unsigned int levelSize = getU32( header + 8 );
+    const unsigned int numLevels = getU32( header + 12 );
+    const unsigned int entrySize = getU32( header + 16 );
+    const unsigned int numEntries = getU32( header + 20 );
+    if ( getU32( header + 4 ) < k_version || levelSize < k_levelSize || entrySize < k_entrySize || 
+        numLevels > k_maxLevels || numEntries > k_maxEntries )
+    {
+        fclose( pFile );
+        errorMessage = path + " has an unsupported version";
+        return false;
+    }
+
+    const size_t levelsSize = (size_t)levelSize * numLevels;
+    std::vector<unsigned char> body( levelsSize + (size_t)entrySize * numEntries );
+    const bool isRead = body.empty() || fread( &body[0], 1, body.size(), pFile ) == body.size();
+    fclose( pFile );
+    if ( !isRead || computeCrc( body.data(), body.size() ) != getU32( header + 24 ) )
+    {
+        errorMessage = path + " is truncated or damaged";
+        return false;
+    }
+
+    levels.resize( numLevels );
+    for ( unsigned int i = 0; i < numLevels; i++ )
+    {
+        const unsigned char* p = &body[(size_t)i * levelSize];
+        levels[i].shutterRegister = getU32( p );
+        levels[i].gainRegister = getU32( p + 4 );
+        levels[i].shutterMs = getDouble( p + 8 );
+        levels[i].gainDb = getDouble( p + 16 );
+    }
+
+    entries.resize( numEntries );
+    for ( unsigned int i = 0; i < numEntries; i++ )
+    {
+        const unsigned char* p = &body[levelsSize + (size_t)i * entrySize];
+        entries[i].sequence = getU32( p );
+        entries[i].bracket = (int)getU32( p + 4 );
+        if ( entries[i].bracket >= (int)numLevels )
+        {
+            entries[i].bracket = -1;
+        }
+    }
+    return true;
+}
+
+HdrBracketTagger::HdrBracketTagger()
+{
+    reset();
+}
+
+void 
+HdrBracketTagger::setLevels( const std::vector<HdrBracketLevel>& levels )
+{
+    m_levels.clear();
+    for ( size_t i = 0; i < levels.size() && m_levels.size() < hdrBrackets::k_maxLevels; i++ )
+    {
+        HdrBracketLevel level = levels[i];
+        level.shutterRegister &= k_registerMask;
+        level.gainRegister &= k_registerMask;
+        if ( findLevel( level.shutterRegister, level.gainRegister ) < 0 )
+        {
+            m_levels.push_back( level );
+        }
+    }
+    reset();
+}
+
+void 
+HdrBracketTagger::reset()
+{
+    m_hasPrevious = false;
+    m_previousBracket = -1;
+    m_previousTick = 0;
+    m_framePeriod = 0;
+    m_sequence = 0;
+    m_numTagged = 0;
+    m_numUnknown = 0;
+}
+
+int 
+HdrBracketTagger::findLevel( unsigned int shutterRegister, unsigned int gainRegister ) const
+{
+    for ( size_t i = 0; i < m_levels.size(); i++ )
+    {
+        if ( m_levels[i].shutterRegister == ( shutterRegister & k_registerMask ) && 
+            m_levels[i].gainRegister == ( gainRegister & k_registerMask ) )
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+HdrBracketEntry 
+HdrBracketTagger::tag( const LadybugImageInfo& imageInfo, unsigned long long tick )
+{
+    HdrBracketEntry entry;
+    entry.bracket = findLevel( (unsigned int)imageInfo.ulShutter[0], (unsigned int)imageInfo.arulGainAdjust[0] );
+    if ( entry.bracket < 0 )
+    {
+        // Counted with the current sequence, but it does not break it
+        entry.sequence = m_sequence;
+        m_numUnknown++;
+        return entry;
+    }
+
+    const int numLevels = (int)m_levels.size();
+    bool isNewSequence = false;
+    if ( m_hasPrevious )
+    {
+        const unsigned long long elapsed = tick > m_previousTick ? tick - m_previousTick : 0;
+        const int step = entry.bracket - m_previousBracket;
+        isNewSequence = step <= 0;
+
+        // Half a period of slack for jitter in the timestamps
+        if ( !isNewSequence && m_framePeriod > 0 )
+        {
+            isNewSequence = elapsed > step * m_framePeriod + m_framePeriod / 2;
+        }
+
+        // Only images of consecutive brackets tell the frame period. A 
+        // gap of whole sequences looks the same, so long steps are left out.
+        const bool isNextBracket = entry.bracket == ( m_previousBracket + 1 ) % numLevels;
+        if ( isNextBracket && elapsed > 0 && 
+            ( m_framePeriod == 0 || elapsed < m_framePeriod + m_framePeriod / 2 ) )
+        {
+            m_framePeriod = m_framePeriod == 0 ? elapsed : ( 7 * m_framePeriod + elapsed ) / 8;
+        }
+    }
+
+    if ( isNewSequence )
+    {
+        m_sequence++;
+    }
+
+    entry.sequence = m_sequence;
+    m_hasPrevious = true;
+    m_previousBracket = entry.bracket;
+    m_previousTick = tick;
+    m_numTagged++;
+    return entry;
+}
+
+unsigned int 
+HdrBracketTagger::getNumMissing() const
+{
+    return getNumSequences() * (unsigned int)m_levels.size() - m_numTagged;
+}
@@ -0,0 +1,148 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __HDRBRACKETS_H__
+#define __HDRBRACKETS_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string>
+#include <vector>
+
+#include <ladybug.h>
+
+/** One exposure setting of the HDR mode of the camera. */
+struct HdrBracketLevel
+{
+    /** Register values, as reported in LadybugImageInfo. */
+    unsigned int shutterRegister;
+    unsigned int gainRegister;
+
+    double shutterMs;
+    double gainDb;
+
+    /** Shutter in ms times the gain as a factor, as HdrMerger takes it. */
+    double getExposure() const;
+};
+
+/** The bracket of one frame of a stream. */
+struct HdrBracketEntry
+{
+    /** Frames of one pass through the brackets share a sequence number. */
+    unsigned int sequence;
+
+    /** Index into the levels, or -1 if the frame matches none of them. */
+    int bracket;
+};
+
+/**
+ * A bracket file (name.hdrb next to name-000000.pgr) tags every frame of 
+ * a stream recorded in HDR mode with the exposure it was taken with and 
+ * the bracket sequence it belongs to. It also keeps the absolute shutter 
+ * and gain of each bracket, which cannot be recovered from the register 
+ * values in the images without the camera.
+ *
+ * Layout, with little endian integers and IEEE floating point:
+ *
+ *   header  "LBHB", version (4), level size (4), number of levels (4),
+ *           entry size (4), number of entries (4), CRC-32 of the levels
+ *           and entries (4)
+ *   levels  shutter register (4), gain register (4), shutter ms (8),
+ *           gain dB (8)
+ *   entries sequence (4), bracket (4, signed)
+ */
+namespace hdrBrackets
+{
+    /** The camera cycles through this many register sets. */
+    const unsigned int k_maxLevels = 4;
+
+    /** Bracket files are recognized by this extension, ".hdrb". */
+    extern const char* const k_extension;
+
+    /** Bracket file that belongs to a stream segment. */
+    std::string getBracketPath( const std::string& segmentPath );
+
+    /** Replace the file at path atomically. */
+    bool write( 
+        const std::string& path, 
+        const std::vector<HdrBracketLevel>& levels, 
+        const std::vector<HdrBracketEntry>& entries, 
+        std::string& errorMessage );
+
+    bool read( 
+        const std::string& path, 
+        std::vector<HdrBracketLevel>& levels, 
+        std::vector<HdrBracketEntry>& entries, 
+        std::string& errorMessage );
+}
+
+/**
+ * Tags images with their bracket while they are grabbed.
+ *
+ * The bracket of an image is found from the shutter and gain registers 
+ * of its first camera. A new sequence starts when the bracket index does 
+ * not increase, or when more time has passed since the previous image 
+ * than the brackets between them account for. Dropped images therefore 
+ * leave gaps in a sequence instead of merging two of them. The frame 
+ * period is learned from images of consecutive brackets.
+ */
+class HdrBracketTagger
+{
+public:
+    HdrBracketTagger();
+
+    /** 
+     * The brackets in the order the camera cycles through them. Levels 
+     * with the same registers as an earlier one are dropped, since their 
+     * images cannot be told apart.
+     */
+    void setLevels( const std::vector<HdrBracketLevel>& levels );
+
+    const std::vector<HdrBracketLevel>& getLevels() const { return m_levels; }
+
+    /** Start over, keeping the levels. */
+    void reset();
+
+    /** Tag the next image, in capture order, with its tick (see CameraClock). */
+    HdrBracketEntry tag( const LadybugImageInfo& imageInfo, unsigned long long tick );
+
+    /** Index of the level with these registers, or -1. */
+    int findLevel( unsigned int shutterRegister, unsigned int gainRegister ) const;
+
+    unsigned int getNumSequences() const { return m_hasPrevious ? m_sequence + 1 : 0; }
+    unsigned int getNumUnknown() const { return m_numUnknown; }
+
+    /** Brackets missing from the sequences started so far. */
+    unsigned int getNumMissing() const;
+
+private:
+    std::vector<HdrBracketLevel> m_levels;
+
+    bool m_hasPrevious;
+    int m_previousBracket;
+    unsigned long long m_previousTick;
+    unsigned long long m_framePeriod;
+
+    unsigned int m_sequence;
+    unsigned int m_numTagged;
+    unsigned int m_numUnknown;
+};
+
+#endif // __HDRBRACKETS_H__
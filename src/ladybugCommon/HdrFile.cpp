@@ -0,0 +1,297 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "HdrFile.h"
+
+namespace
+{
+    // Radiance rows are only run length encoded between these widths
+    const unsigned int k_minRleWidth = 8;
+    const unsigned int k_maxRleWidth = 0x7fff;
+
+    // Shortest run worth encoding as a run
+    const unsigned int k_minRun = 4;
+
+    const unsigned char k_exrMagic[4] = { 0x76, 0x2f, 0x31, 0x01 };
+    const unsigned int k_exrVersion = 2;
+    const unsigned int k_exrPixelTypeFloat = 2;
+
+    void putU32( std::vector<unsigned char>& data, unsigned int value )
+    {
+        for ( unsigned int i = 0; i < 4; i++ )
+        {
+            data.push_back( (unsigned char)( value >> ( i * 8 ) ) );
+        }
+    }
+
+    void putU64( std::vector<unsigned char>& data, unsigned long long value )
+    {
+        for ( unsigned int i = 0; i < 8; i++ )
+        {
+            data.push_back( (unsigned char)( value >> ( i * 8 ) ) );
+        }
+    }
+
+    void putFloat( std::vector<unsigned char>& data, float value )
+    {
+        unsigned int bits = 0;
+        memcpy( &bits, &value, sizeof(bits) );
+        putU32( data, bits );
+    }
+
+    void putString( std::vector<unsigned char>& data, const char* pszText )
+    {
+        data.insert( data.end(), pszText, pszText + strlen( pszText ) + 1 );
+    }
+
+    void putAttribute( std::vector<unsigned char>& data, const char* pszName, const char* pszType, unsigned int size )
+    {
+        putString( data, pszName );
+        putString( data, pszType );
+        putU32( data, size );
+    }
+
+    /** Shared exponent of R, G and B; zero for black. */
+    void toRgbe( float red, float green, float blue, unsigned char* pRgbe )
+    {
+        const float largest = std::max( red, std::max( green, blue ) );
+        if ( !( largest > 1.0e-32f ) )
+        {
+            memset( pRgbe, 0, 4 );
+            return;
+        }
+
+        int exponent = 0;
+        const float scale = frexpf( largest, &exponent ) * 256.0f / largest;
+        pRgbe[0] = (unsigned char)std::max( 0.0f, red * scale );
+        pRgbe[1] = (unsigned char)std::max( 0.0f, green * scale );
+        pRgbe[2] = (unsigned char)std::max( 0.0f, blue * scale );
+        pRgbe[3] = (unsigned char)( exponent + 128 );
+    }
+
+    /** 
+     * Run length encode one component of a row: a byte over 128 is a run
+     * of that many minus 128 of the next byte, otherwise a count of 
+     * bytes copied as they are.
+     */
+    void encodeComponent( const unsigned char* pValues, unsigned int count, std::vector<unsigned char>& data )
+    {
+        unsigned int current = 0;
+        while ( current < count )
+        {
+            // Find the next run long enough to be worth encoding
+            unsigned int runStart = current;
+            unsigned int runCount = 0;
+            unsigned int previousRunCount = 0;
+            while ( runCount < k_minRun && runStart < count )
+            {
+                runStart += runCount;
+                previousRunCount = runCount;
+                runCount = 1;
+                while ( runStart + runCount < count && runCount < 127 && 
+                    pValues[runStart] == pValues[runStart + runCount] )
+                {
+                    runCount++;
+                }
+            }
+
+            // A short run right before it is still cheaper as a run
+            if ( previousRunCount > 1 && previousRunCount == runStart - current )
+            {
+                data.push_back( (unsigned char)( 128 + previousRunCount ) );
+                data.push_back( pValues[current] );
+                current = runStart;
+            }
+
+            while ( current < runStart )
+            {
+                const unsigned int literalCount = std::min( 128u, runStart - current );
+                data.push_back( (unsigned char)literalCount );
+                data.insert( data.end(), pValues + current, pValues + current + literalCount );
+                current += literalCount;
+            }
+
+            if ( runCount >= k_minRun )
+            {
+                data.push_back( (unsigned char)( 128 + runCount ) );
+                data.push_back( pValues[runStart] );
+                current += runCount;
+            }
+        }
+    }
+
+    bool writeFile( const std::string& path, const std::vector<unsigned char>& data, std::string& errorMessage )
+    {
+        FILE* pFile = fopen( path.c_str(), "wb" );
+        if ( pFile == NULL )
+        {
+            errorMessage = "Unable to create " + path;
+            return false;
+        }
+
+        const bool isWritten = fwrite( &data[0], 1, data.size(), pFile ) == data.size();
+        if ( fclose( pFile ) != 0 || !isWritten )
+        {
+            errorMessage = "Unable to write " + path;
+            remove( path.c_str() );
+            return false;
+        }
+        return true;
+    }
+}
+
+bool 
+hdrFile::writeRadiance( 
+    const std::string& path, 
+    const float* pPixels, 
+    unsigned int width, 
+    unsigned int height, 
+    std::string& errorMessage )
+{
+    std::vector<unsigned char> data;
+    char header[128];
+    snprintf( header, sizeof(header), "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y %u +X %u\n", height, width );
+    data.insert( data.end(), header, header + strlen( header ) );
+
+    const bool isEncoded = width >= k_minRleWidth && width <= k_maxRleWidth;
+    std::vector<unsigned char> rgbe( (size_t)width * 4 );
+    std::vector<unsigned char> component( width );
+    for ( unsigned int y = 0; y < height; y++ )
+    {
+        const float* pRow = pPixels + (size_t)y * width * 3;
+        for ( unsigned int x = 0; x < width; x++ )
+        {
+            toRgbe( pRow[x * 3 + 2], pRow[x * 3 + 1], pRow[x * 3], &rgbe[x * 4] );
+        }
+
+        if ( !isEncoded )
+        {
+            data.insert( data.end(), rgbe.begin(), rgbe.end() );
+            continue;
+        }
+
+        // Each component of the row on its own, after a marker with the width
+        data.push_back( 2 );
+        data.push_back( 2 );
+        data.push_back( (unsigned char)( width >> 8 ) );
+        data.push_back( (unsigned char)( width & 0xff ) );
+        for ( unsigned int channel = 0; channel < 4; channel++ )
+        {
+            for ( unsigned int x = 0; x < width; x++ )
+            {
+                component[x] = rgbe[x * 4 + channel];
+            }
+            encodeComponent( &component[0], width, data );
+        }
+    }
+
+    return writeFile( path, data, errorMessage );
+}
+
+bool 
+hdrFile::writeOpenExr( 
+    const std::string& path, 
+    const float* pPixels, 
+    unsigned int width, 
+    unsigned int height, 
+    std::string& errorMessage )
+{
+    if ( width == 0 || height == 0 )
+    {
+        errorMessage = "Empty image";
+        return false;
+    }
+
+    std::vector<unsigned char> data( k_exrMagic, k_exrMagic + 4 );
+    putU32( data, k_exrVersion );
+
+    // Channels in alphabetical order, as the format requires
+    const char* const channelNames[3] = { "B", "G", "R" };
+    putAttribute( data, "channels", "chlist", 3 * ( 2 + 16 ) + 1 );
+    for ( unsigned int channel = 0; channel < 3; channel++ )
+    {
+        putString( data, channelNames[channel] );
+        putU32( data, k_exrPixelTypeFloat );
+        putU32( data, 0 );  // not perceptually linear, reserved
+        putU32( data, 1 );  // x sampling
+        putU32( data, 1 );  // y sampling
+    }
+    data.push_back( 0 );
+
+    putAttribute( data, "compression", "compression", 1 );
+    data.push_back( 0 );
+
+    for ( unsigned int window = 0; window < 2; window++ )
+    {
+        putAttribute( data, window == 0 ? "dataWindow" : "displayWindow", "box2i", 16 );
+        putU32( data, 0 );
+        putU32( data, 0 );
+        putU32( data, width - 1 );
+        putU32( data, height - 1 );
+    }
+
+    putAttribute( data, "lineOrder", "lineOrder", 1 );
+    data.push_back( 0 );
+    putAttribute( data, "pixelAspectRatio", "float", 4 );
+    putFloat( data, 1.0f );
+    putAttribute( data, "screenWindowCenter", "v2f", 8 );
+    putFloat( data, 0.0f );
+    putFloat( data, 0.0f );
+    putAttribute( data, "screenWindowWidth", "float", 4 );
+    putFloat( data, 1.0f );
+    data.push_back( 0 );
+
+    // Offset of each row, then the rows: y, size, and each channel
+    const unsigned int rowBytes = width * 3 * 4;
+    const unsigned long long firstRow = data.size() + (unsigned long long)height * 8;
+    for ( unsigned int y = 0; y < height; y++ )
+    {
+        putU64( data, firstRow + (unsigned long long)y * ( 8 + rowBytes ) );
+    }
+
+    data.reserve( data.size() + (size_t)height * ( 8 + rowBytes ) );
+    for ( unsigned int y = 0; y < height; y++ )
+    {
+        putU32( data, y );
+        putU32( data, rowBytes );
+        const float* pRow = pPixels + (size_t)y * width * 3;
+        for ( unsigned int channel = 0; channel < 3; channel++ )
+        {
+            for ( unsigned int x = 0; x < width; x++ )
+            {
+                putFloat( data, pRow[x * 3 + channel] );
+            }
+        }
+    }
+
+    return writeFile( path, data, errorMessage );
+}
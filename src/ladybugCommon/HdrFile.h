@@ -0,0 +1,55 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __HDRFILE_H__
+#define __HDRFILE_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string>
+
+/**
+ * Writers of high dynamic range image files, from B, G, R float pixels
+ * stored row by row from the top.
+ *
+ *   Radiance  .hdr, RGBE with run length encoded rows
+ *   OpenEXR   .exr, uncompressed 32 bit float B, G and R channels
+ *
+ * Both are read by the usual HDR tools (pfstools, Photoshop, OpenCV, 
+ * ImageMagick); neither needs a library here.
+ */
+namespace hdrFile
+{
+    bool writeRadiance( 
+        const std::string& path, 
+        const float* pPixels, 
+        unsigned int width, 
+        unsigned int height, 
+        std::string& errorMessage );
+
+    bool writeOpenExr( 
+        const std::string& path, 
+        const float* pPixels, 
+        unsigned int width, 
+        unsigned int height, 
+        std::string& errorMessage );
+}
+
+#endif // __HDRFILE_H__
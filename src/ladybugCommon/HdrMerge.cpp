@@ -0,0 +1,211 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cmath>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "HdrMerge.h"
+
+namespace
+{
+    // Rows merged by one task
+    const unsigned int k_bandRows = 64;
+
+    // Samples at or above this level are taken as saturated
+    const float k_saturatedLevel = 0.98f;
+
+    // Below this total weight no exposure measured the sample well
+    const float k_minWeight = 1.0e-6f;
+
+    const float k_fullScale = 65535.0f;
+}
+
+HdrMerger::HdrMerger( unsigned int numThreads ) :
+m_pool( numThreads ),
+m_isRangeFixed( false ),
+m_minLog2( 0.0 ),
+m_maxLog2( 0.0 )
+{
+}
+
+bool 
+HdrMerger::merge( 
+    const std::vector<Exposure>& exposures, 
+    unsigned int cols, 
+    unsigned int rows, 
+    unsigned short* const* ppDest )
+{
+    if ( exposures.empty() )
+    {
+        return false;
+    }
+
+    // Shortest exposure first
+    std::vector<unsigned int> order;
+    for ( unsigned int i = 0; i < exposures.size(); i++ )
+    {
+        if ( !( exposures[i].exposure > 0.0 ) )
+        {
+            return false;
+        }
+        order.push_back( i );
+    }
+    std::sort( order.begin(), order.end(), [&exposures]( unsigned int a, unsigned int b ) { 
+        return exposures[a].exposure < exposures[b].exposure; } );
+
+    if ( !m_isRangeFixed )
+    {
+        // From one code in the longest exposure to full scale in the shortest
+        setLog2Range( 
+            log2( 1.0 / k_fullScale / exposures[order.back()].exposure ), 
+            log2( 1.0 / exposures[order.front()].exposure ) );
+    }
+
+    const unsigned int bandsPerCamera = ( rows + k_bandRows - 1 ) / k_bandRows;
+    m_pool.parallelFor( LADYBUG_NUM_CAMERAS * bandsPerCamera, [&]( unsigned int task ) {
+        const unsigned int camera = task / bandsPerCamera;
+        const unsigned int firstRow = ( task % bandsPerCamera ) * k_bandRows;
+        const unsigned int endRow = std::min( rows, firstRow + k_bandRows );
+        mergeBand( exposures, order, camera, (size_t)firstRow * cols, (size_t)endRow * cols, ppDest[camera] );
+    } );
+
+    return true;
+}
+
+bool 
+HdrMerger::setRange( double minExposure, double maxExposure )
+{
+    if ( !( minExposure > 0.0 ) || !( maxExposure >= minExposure ) )
+    {
+        return false;
+    }
+
+    setLog2Range( log2( 1.0 / k_fullScale / maxExposure ), log2( 1.0 / minExposure ) );
+    m_isRangeFixed = true;
+    return true;
+}
+
+void 
+HdrMerger::setLog2Range( double minLog2, double maxLog2 )
+{
+    if ( m_decodeTable.size() == 65536 && minLog2 == m_minLog2 && maxLog2 == m_maxLog2 )
+    {
+        return;
+    }
+
+    m_minLog2 = minLog2;
+    m_maxLog2 = maxLog2;
+    m_decodeTable.resize( 65536 );
+    m_decodeTable[0] = 0.0f;
+    for ( unsigned int code = 1; code < 65536; code++ )
+    {
+        m_decodeTable[code] = (float)exp2( m_minLog2 + ( m_maxLog2 - m_minLog2 ) * code / k_fullScale );
+    }
+}
+
+void 
+HdrMerger::mergeBand( 
+    const std::vector<Exposure>& exposures, 
+    const std::vector<unsigned int>& order, 
+    unsigned int camera, 
+    size_t firstPixel, 
+    size_t endPixel, 
+    unsigned short* pDest ) const
+{
+    const size_t numExposures = order.size();
+    std::vector<const unsigned short*> sources( numExposures );
+    std::vector<float> scales( numExposures );
+    std::vector<float> trust( numExposures );
+    for ( size_t i = 0; i < numExposures; i++ )
+    {
+        sources[i] = exposures[order[i]].textures[camera];
+        scales[i] = (float)( 1.0 / k_fullScale / exposures[order[i]].exposure );
+        trust[i] = (float)( exposures[order[i]].exposure / exposures[order.back()].exposure );
+    }
+
+    const unsigned short* pAlpha = exposures[0].textures[camera];
+    const float encodeScale = (float)( k_fullScale / ( m_maxLog2 - m_minLog2 ) );
+    const float minLog2 = (float)m_minLog2;
+
+    for ( size_t pixel = firstPixel; pixel < endPixel; pixel++ )
+    {
+        const size_t offset = pixel * 4;
+        for ( unsigned int channel = 0; channel < 3; channel++ )
+        {
+            float weightSum = 0.0f;
+            float radianceSum = 0.0f;
+            for ( size_t i = 0; i < numExposures; i++ )
+            {
+                const float value = sources[i][offset + channel];
+                const float level = value * ( 1.0f / k_fullScale );
+                if ( level < k_saturatedLevel )
+                {
+                    const float weight = ( level < 0.5f ? level : 1.0f - level ) * trust[i];
+                    weightSum += weight;
+                    radianceSum += weight * value * scales[i];
+                }
+            }
+
+            float radiance = 0.0f;
+            if ( weightSum >= k_minWeight )
+            {
+                radiance = radianceSum / weightSum;
+            }
+            else
+            {
+                // Black in all but maybe the longest, or saturated in all
+                const float longest = sources[numExposures - 1][offset + channel];
+                radiance = longest < 0.5f * k_fullScale ? 
+                    longest * scales[numExposures - 1] : 
+                    sources[0][offset + channel] * scales[0];
+            }
+
+            unsigned short code = 0;
+            if ( radiance > 0.0f )
+            {
+                const float scaled = ( log2f( radiance ) - minLog2 ) * encodeScale + 0.5f;
+                code = (unsigned short)std::max( 1.0f, std::min( k_fullScale, scaled ) );
+            }
+            pDest[offset + channel] = code;
+        }
+        pDest[offset + 3] = pAlpha[offset + 3];
+    }
+}
+
+void 
+HdrMerger::decode( const unsigned short* pSource, size_t pixelCount, float* pDest )
+{
+    const size_t bandPixels = 65536;
+    const unsigned int numBands = (unsigned int)( ( pixelCount + bandPixels - 1 ) / bandPixels );
+    m_pool.parallelFor( numBands, [&]( unsigned int band ) {
+        const size_t first = band * bandPixels * 3;
+        const size_t end = std::min( pixelCount, ( band + 1 ) * bandPixels ) * 3;
+        for ( size_t i = first; i < end; i++ )
+        {
+            pDest[i] = m_decodeTable[pSource[i]];
+        }
+    } );
+}
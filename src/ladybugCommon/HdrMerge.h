@@ -0,0 +1,121 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __HDRMERGE_H__
+#define __HDRMERGE_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <vector>
+
+#include <ladybug.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "ThreadPool.h"
+
+/**
+ * Merges bracketed exposures of the six cameras into one radiance image 
+ * per camera, before stitching.
+ *
+ * The exposures are LADYBUG_BGRU16 textures converted with gamma off, so
+ * that their values are linear in the light. Every sample divided by its
+ * exposure (shutter times gain) estimates the radiance; the estimates of 
+ * the exposures are averaged with the hat weight of Debevec and Malik, 
+ * which trusts mid-range values most and falls to zero at black and at 
+ * saturation, times the exposure, since a longer exposure measures the 
+ * same light with less noise. Where every exposure is saturated the 
+ * shortest one is used, and where every one is black the longest.
+ *
+ * The library renderer only takes 16 bit textures, so the radiance is 
+ * stored in them as its base 2 logarithm, over the range the exposures
+ * can measure; 65536 codes over 20-30 stops is a step of about 0.03%. 
+ * After rendering, decode() turns the panorama back into radiance. Blending
+ * at the seams is then a geometric mean, which is as good for a radiance 
+ * image.
+ */
+class HdrMerger
+{
+public:
+    struct Exposure
+    {
+        /** LADYBUG_BGRU16 texture of each camera. */
+        const unsigned short* textures[LADYBUG_NUM_CAMERAS];
+
+        /** Shutter in ms times linear gain. */
+        double exposure;
+    };
+
+    /** numThreads of 0 uses one thread per hardware thread. */
+    explicit HdrMerger( unsigned int numThreads = 0 );
+
+    /**
+     * Merge the exposures into log encoded LADYBUG_BGRU16 textures of 
+     * cols x rows, one per camera. The alpha channel is that of the first
+     * exposure. Returns false without exposures or with one that is not 
+     * positive.
+     */
+    bool merge( 
+        const std::vector<Exposure>& exposures, 
+        unsigned int cols, 
+        unsigned int rows, 
+        unsigned short* const* ppDest );
+
+    /**
+     * Encode over the range of exposures from minExposure to maxExposure 
+     * from now on, rather than over that of the exposures passed to 
+     * merge(). Mergers given the same range decode each other's images, 
+     * even of merges that miss some exposures.
+     */
+    bool setRange( double minExposure, double maxExposure );
+
+    /** 
+     * Radiance of pixelCount LADYBUG_BGR16 pixels rendered from merged 
+     * textures, as B, G, R floats, in units of full scale per ms.
+     */
+    void decode( const unsigned short* pSource, size_t pixelCount, float* pDest );
+
+    /** Stops between the darkest and the brightest radiance measured. */
+    double getRangeStops() const { return m_maxLog2 - m_minLog2; }
+
+    unsigned int getNumThreads() const { return m_pool.getNumThreads(); }
+
+private:
+    void setLog2Range( double minLog2, double maxLog2 );
+
+    void mergeBand( 
+        const std::vector<Exposure>& exposures, 
+        const std::vector<unsigned int>& order, 
+        unsigned int camera, 
+        size_t firstPixel, 
+        size_t endPixel, 
+        unsigned short* pDest ) const;
+
+    ThreadPool m_pool;
+    bool m_isRangeFixed;
+    double m_minLog2;
+    double m_maxLog2;
+
+    /** Radiance of every code. */
+    std::vector<float> m_decodeTable;
+};
+
+#endif // __HDRMERGE_H__
@@ -0,0 +1,229 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stdint.h>
+#include <string.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CpuFeatures.h"
+#include "ImageFormat.h"
+#include "ImageFormatAvx2.h"
+
+namespace
+{
+    // Pixels converted at a time between BGRU16 and BGR12_PACKED
+    const unsigned int k_chunkPixels = 256;
+
+    bool useAvx2()
+    {
+        static const bool available = imageFormat::avx2::isBuilt() && cpuFeatures::hasAvx2();
+        return available;
+    }
+
+    template <typename T>
+    void dropAlpha( const T* pSource, T* pDest, unsigned int first, unsigned int width )
+    {
+        for ( unsigned int x = first; x < width; x++ )
+        {
+            pDest[x * 3 + 0] = pSource[x * 4 + 0];
+            pDest[x * 3 + 1] = pSource[x * 4 + 1];
+            pDest[x * 3 + 2] = pSource[x * 4 + 2];
+        }
+    }
+
+    template <typename T>
+    void addAlpha( const T* pSource, T* pDest, unsigned int first, unsigned int width, T opaque )
+    {
+        for ( unsigned int x = first; x < width; x++ )
+        {
+            pDest[x * 4 + 0] = pSource[x * 3 + 0];
+            pDest[x * 4 + 1] = pSource[x * 3 + 1];
+            pDest[x * 4 + 2] = pSource[x * 3 + 2];
+            pDest[x * 4 + 3] = opaque;
+        }
+    }
+
+    /** Pack samples [first, count); first must be even. */
+    void packSamples12( const uint16_t* pSamples, uint8_t* pDest, unsigned int first, unsigned int count )
+    {
+        for ( unsigned int i = first; i < count; i += 2 )
+        {
+            const uint16_t a = pSamples[i];
+            const uint16_t b = i + 1 < count ? pSamples[i + 1] : 0;
+            uint8_t* pPair = pDest + i / 2 * 3;
+
+            pPair[0] = (uint8_t)( a >> 8 );
+            pPair[1] = (uint8_t)( ( ( a >> 4 ) & 0x0F ) | ( b & 0xF0 ) );
+            if ( i + 1 < count )
+            {
+                pPair[2] = (uint8_t)( b >> 8 );
+            }
+        }
+    }
+
+    /** Unpack samples [first, count); first must be even. */
+    void unpackSamples12( const uint8_t* pSource, uint16_t* pSamples, unsigned int first, unsigned int count )
+    {
+        for ( unsigned int i = first; i < count; i += 2 )
+        {
+            const uint8_t* pPair = pSource + i / 2 * 3;
+            pSamples[i] = (uint16_t)( ( pPair[0] << 8 ) | ( ( pPair[1] & 0x0F ) << 4 ) );
+            if ( i + 1 < count )
+            {
+                pSamples[i + 1] = (uint16_t)( ( pPair[2] << 8 ) | ( pPair[1] & 0xF0 ) );
+            }
+        }
+    }
+
+    void packRow12( const uint16_t* pSource, uint8_t* pDest, unsigned int width )
+    {
+        uint16_t samples[k_chunkPixels * 3];
+
+        for ( unsigned int x = 0; x < width; x += k_chunkPixels )
+        {
+            const unsigned int pixels = width - x < k_chunkPixels ? width - x : k_chunkPixels;
+            const unsigned int count = pixels * 3;
+            const uint16_t* pChunk = pSource + x * 4;
+
+            // Chunks start on an even sample, so they start on a whole byte
+            uint8_t* pPacked = pDest + x * 3 / 2 * 3;
+
+            unsigned int done = useAvx2() ? imageFormat::avx2::dropAlpha16( pChunk, samples, pixels ) : 0;
+            dropAlpha( pChunk, samples, done, pixels );
+
+            done = useAvx2() ? imageFormat::avx2::packSamples12( samples, pPacked, count ) : 0;
+            packSamples12( samples, pPacked, done, count );
+        }
+    }
+
+    void unpackRow12( const uint8_t* pSource, uint16_t* pDest, unsigned int width )
+    {
+        uint16_t samples[k_chunkPixels * 3];
+
+        for ( unsigned int x = 0; x < width; x += k_chunkPixels )
+        {
+            const unsigned int pixels = width - x < k_chunkPixels ? width - x : k_chunkPixels;
+            const unsigned int count = pixels * 3;
+            const uint8_t* pPacked = pSource + x * 3 / 2 * 3;
+            uint16_t* pChunk = pDest + x * 4;
+
+            unsigned int done = useAvx2() ? imageFormat::avx2::unpackSamples12( pPacked, samples, count ) : 0;
+            unpackSamples12( pPacked, samples, done, count );
+
+            done = useAvx2() ? imageFormat::avx2::addAlpha16( samples, pChunk, pixels ) : 0;
+            addAlpha( samples, pChunk, done, pixels, (uint16_t)0xFFFF );
+        }
+    }
+}
+
+size_t 
+imageFormat::getRowBytes( ImageFormat format, unsigned int width )
+{
+    switch ( format )
+    {
+    case IMAGE_FORMAT_BGRU16: return (size_t)width * 8;
+    case IMAGE_FORMAT_BGR8: return (size_t)width * 3;
+    case IMAGE_FORMAT_BGR16: return (size_t)width * 6;
+    case IMAGE_FORMAT_BGR12_PACKED: return ( (size_t)width * 3 * 3 + 1 ) / 2;
+    default: return (size_t)width * 4;
+    }
+}
+
+bool 
+imageFormat::isHighBitDepth( ImageFormat format )
+{
+    return format == IMAGE_FORMAT_BGRU16 || 
+        format == IMAGE_FORMAT_BGR16 || 
+        format == IMAGE_FORMAT_BGR12_PACKED;
+}
+
+bool 
+imageFormat::fromLadybugPixelFormat( LadybugPixelFormat pixelFormat, ImageFormat& format )
+{
+    switch ( pixelFormat )
+    {
+    case LADYBUG_BGRU: format = IMAGE_FORMAT_BGRU8; return true;
+    case LADYBUG_BGRU16: format = IMAGE_FORMAT_BGRU16; return true;
+    case LADYBUG_BGR: format = IMAGE_FORMAT_BGR8; return true;
+    case LADYBUG_BGR16: format = IMAGE_FORMAT_BGR16; return true;
+    default: return false;
+    }
+}
+
+bool 
+imageFormat::convertRow( 
+    ImageFormat sourceFormat, 
+    const void* pSource, 
+    ImageFormat destFormat, 
+    void* pDest, 
+    unsigned int width )
+{
+    if ( sourceFormat == destFormat )
+    {
+        memcpy( pDest, pSource, getRowBytes( sourceFormat, width ) );
+        return true;
+    }
+
+    const uint8_t* pSource8 = static_cast<const uint8_t*>( pSource );
+    const uint16_t* pSource16 = static_cast<const uint16_t*>( pSource );
+    uint8_t* pDest8 = static_cast<uint8_t*>( pDest );
+    uint16_t* pDest16 = static_cast<uint16_t*>( pDest );
+    unsigned int done = 0;
+
+    if ( sourceFormat == IMAGE_FORMAT_BGRU8 && destFormat == IMAGE_FORMAT_BGR8 )
+    {
+        done = useAvx2() ? avx2::dropAlpha8( pSource8, pDest8, width ) : 0;
+        dropAlpha( pSource8, pDest8, done, width );
+    }
+    else if ( sourceFormat == IMAGE_FORMAT_BGR8 && destFormat == IMAGE_FORMAT_BGRU8 )
+    {
+        done = useAvx2() ? avx2::addAlpha8( pSource8, pDest8, width ) : 0;
+        addAlpha( pSource8, pDest8, done, width, (uint8_t)0xFF );
+    }
+    else if ( sourceFormat == IMAGE_FORMAT_BGRU16 && destFormat == IMAGE_FORMAT_BGR16 )
+    {
+        done = useAvx2() ? avx2::dropAlpha16( pSource16, pDest16, width ) : 0;
+        dropAlpha( pSource16, pDest16, done, width );
+    }
+    else if ( sourceFormat == IMAGE_FORMAT_BGR16 && destFormat == IMAGE_FORMAT_BGRU16 )
+    {
+        done = useAvx2() ? avx2::addAlpha16( pSource16, pDest16, width ) : 0;
+        addAlpha( pSource16, pDest16, done, width, (uint16_t)0xFFFF );
+    }
+    else if ( sourceFormat == IMAGE_FORMAT_BGRU16 && destFormat == IMAGE_FORMAT_BGR12_PACKED )
+    {
+        packRow12( pSource16, pDest8, width );
+    }
+    else if ( sourceFormat == IMAGE_FORMAT_BGR12_PACKED && destFormat == IMAGE_FORMAT_BGRU16 )
+    {
+        unpackRow12( pSource8, pDest16, width );
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
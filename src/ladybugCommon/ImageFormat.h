@@ -0,0 +1,84 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __IMAGEFORMAT_H__
+#define __IMAGEFORMAT_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stddef.h>
+
+#include <ladybug.h>
+
+/**
+ * Pixel layouts of the color images handled on the CPU. 
+ *
+ * The library only takes the four channel formats. The three channel 
+ * and packed formats drop the alpha channel, and the packed format also
+ * the unused low bits of 12 bit data, so buffers that stay on the CPU 
+ * move fewer bytes:
+ *
+ *   BGRU8  4 bytes     BGR8  3 bytes (-25%)
+ *   BGRU16 8 bytes     BGR16 6 bytes (-25%)   BGR12P 4.5 bytes (-44%)
+ */
+enum ImageFormat
+{
+    IMAGE_FORMAT_BGRU8,
+    IMAGE_FORMAT_BGRU16,
+    IMAGE_FORMAT_BGR8,
+    IMAGE_FORMAT_BGR16,
+
+    /** 
+     * B, G, R samples of 12 bits, two samples in three bytes: the high 
+     * byte of the first, both low nibbles (first in bits 0-3), then the 
+     * high byte of the second. The same packing as RAW12 images.
+     */
+    IMAGE_FORMAT_BGR12_PACKED
+};
+
+namespace imageFormat
+{
+    /** Bytes of one row, rounded up to whole bytes. */
+    size_t getRowBytes( ImageFormat format, unsigned int width );
+
+    /** Whether samples are stored with more than 8 bits. */
+    bool isHighBitDepth( ImageFormat format );
+
+    /** The format matching a library pixel format, if any. */
+    bool fromLadybugPixelFormat( LadybugPixelFormat pixelFormat, ImageFormat& format );
+
+    /**
+     * Convert a row between a four channel format and a compact format 
+     * of the same bit depth (BGRU8 and BGR8, BGRU16 and BGR16 or 
+     * BGR12_PACKED), or copy it if the formats are equal. The alpha 
+     * channel is set to opaque when unpacking. 16 bit samples are left 
+     * aligned, so BGR12_PACKED keeps their top 12 bits.
+     *
+     * Returns false for other pairs of formats.
+     */
+    bool convertRow( 
+        ImageFormat sourceFormat, 
+        const void* pSource, 
+        ImageFormat destFormat, 
+        void* pDest, 
+        unsigned int width );
+}
+
+#endif // __IMAGEFORMAT_H__
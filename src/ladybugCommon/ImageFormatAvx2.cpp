@@ -0,0 +1,232 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//
+// Built with -mavx2. Keep standard library templates out of this file.
+//
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "ImageFormatAvx2.h"
+
+#if defined(__AVX2__) || ( defined(_MSC_VER) && defined(_M_X64) )
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <immintrin.h>
+
+namespace
+{
+    // The first six 32 bit words of a vector, which hold 24 bytes
+    inline __m256i sixWordMask()
+    {
+        return _mm256_setr_epi32( -1, -1, -1, -1, -1, -1, 0, 0 );
+    }
+
+    inline __m256i load32( const void* pSource )
+    {
+        return _mm256_loadu_si256( static_cast<const __m256i*>( pSource ) );
+    }
+
+    /** 
+     * Drop the fourth of every four bytes (or byte pairs) of a vector and
+     * store the 24 bytes left.
+     */
+    inline void compress32To24( __m256i value, void* pDest, __m256i byteShuffle )
+    {
+        const __m256i packed = _mm256_shuffle_epi8( value, byteShuffle );
+
+        // 12 bytes in each half, moved next to each other
+        const __m256i joined = _mm256_permutevar8x32_epi32( packed, _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 3, 7 ) );
+        _mm256_maskstore_epi32( static_cast<int*>( pDest ), sixWordMask(), joined );
+    }
+
+    /** Load 24 bytes and spread them over 32, with gaps set to zero. */
+    inline __m256i expand24To32( const void* pSource, __m256i byteShuffle )
+    {
+        const __m256i loaded = _mm256_maskload_epi32( static_cast<const int*>( pSource ), sixWordMask() );
+        const __m256i split = _mm256_permutevar8x32_epi32( loaded, _mm256_setr_epi32( 0, 1, 2, 0, 3, 4, 5, 0 ) );
+        return _mm256_shuffle_epi8( split, byteShuffle );
+    }
+
+    inline __m256i dropFourthByte()
+    {
+        return _mm256_setr_epi8( 
+            0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+            0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 );
+    }
+
+    inline __m256i insertFourthByte()
+    {
+        return _mm256_setr_epi8( 
+            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 );
+    }
+
+    inline __m256i dropFourthWord()
+    {
+        return _mm256_setr_epi8( 
+            0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1,
+            0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1 );
+    }
+
+    inline __m256i insertFourthWord()
+    {
+        return _mm256_setr_epi8( 
+            0, 1, 2, 3, 4, 5, -1, -1, 6, 7, 8, 9, 10, 11, -1, -1,
+            0, 1, 2, 3, 4, 5, -1, -1, 6, 7, 8, 9, 10, 11, -1, -1 );
+    }
+}
+
+bool 
+imageFormat::avx2::isBuilt()
+{
+    return true;
+}
+
+unsigned int 
+imageFormat::avx2::dropAlpha8( const uint8_t* pSource, uint8_t* pDest, unsigned int width )
+{
+    const __m256i shuffle = dropFourthByte();
+
+    unsigned int x = 0;
+    for ( ; x + 8 <= width; x += 8 )
+    {
+        compress32To24( load32( pSource + x * 4 ), pDest + x * 3, shuffle );
+    }
+    return x;
+}
+
+unsigned int 
+imageFormat::avx2::addAlpha8( const uint8_t* pSource, uint8_t* pDest, unsigned int width )
+{
+    const __m256i shuffle = insertFourthByte();
+    const __m256i alpha = _mm256_set1_epi32( (int)0xFF000000 );
+
+    unsigned int x = 0;
+    for ( ; x + 8 <= width; x += 8 )
+    {
+        const __m256i pixels = _mm256_or_si256( expand24To32( pSource + x * 3, shuffle ), alpha );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDest + x * 4 ), pixels );
+    }
+    return x;
+}
+
+unsigned int 
+imageFormat::avx2::dropAlpha16( const uint16_t* pSource, uint16_t* pDest, unsigned int width )
+{
+    const __m256i shuffle = dropFourthWord();
+
+    unsigned int x = 0;
+    for ( ; x + 4 <= width; x += 4 )
+    {
+        compress32To24( load32( pSource + x * 4 ), pDest + x * 3, shuffle );
+    }
+    return x;
+}
+
+unsigned int 
+imageFormat::avx2::addAlpha16( const uint16_t* pSource, uint16_t* pDest, unsigned int width )
+{
+    const __m256i shuffle = insertFourthWord();
+    const __m256i alpha = _mm256_set1_epi64x( (long long)0xFFFF000000000000ULL );
+
+    unsigned int x = 0;
+    for ( ; x + 4 <= width; x += 4 )
+    {
+        const __m256i pixels = _mm256_or_si256( expand24To32( pSource + x * 3, shuffle ), alpha );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDest + x * 4 ), pixels );
+    }
+    return x;
+}
+
+unsigned int 
+imageFormat::avx2::packSamples12( const uint16_t* pSamples, uint8_t* pDest, unsigned int count )
+{
+    const __m256i lowByte = _mm256_set1_epi32( 0xFF );
+    const __m256i lowNibble = _mm256_set1_epi32( 0x0F );
+    const __m256i highNibble = _mm256_set1_epi32( 0xF0 );
+    const __m256i shuffle = dropFourthByte();
+
+    unsigned int i = 0;
+    for ( ; i + 16 <= count; i += 16 )
+    {
+        // Each 32 bit word holds a pair of samples: first | second << 16
+        const __m256i pair = load32( pSamples + i );
+
+        const __m256i firstHigh = _mm256_and_si256( _mm256_srli_epi32( pair, 8 ), lowByte );
+        const __m256i nibbles = _mm256_or_si256( 
+            _mm256_and_si256( _mm256_srli_epi32( pair, 4 ), lowNibble ), 
+            _mm256_and_si256( _mm256_srli_epi32( pair, 16 ), highNibble ) );
+        const __m256i secondHigh = _mm256_srli_epi32( pair, 24 );
+
+        const __m256i packed = _mm256_or_si256( 
+            _mm256_or_si256( firstHigh, _mm256_slli_epi32( nibbles, 8 ) ), 
+            _mm256_slli_epi32( secondHigh, 16 ) );
+
+        compress32To24( packed, pDest + i / 2 * 3, shuffle );
+    }
+    return i;
+}
+
+unsigned int 
+imageFormat::avx2::unpackSamples12( const uint8_t* pSource, uint16_t* pSamples, unsigned int count )
+{
+    const __m256i shuffle = insertFourthByte();
+    const __m256i highByte = _mm256_set1_epi32( 0xFF00 );
+    const __m256i highNibble = _mm256_set1_epi32( 0xF0 );
+    const __m256i secondMask = _mm256_set1_epi32( 0xFFF0 );
+
+    unsigned int i = 0;
+    for ( ; i + 16 <= count; i += 16 )
+    {
+        // Three bytes per word: high byte of the first, nibbles, high byte of the second
+        const __m256i bytes = expand24To32( pSource + i / 2 * 3, shuffle );
+
+        const __m256i first = _mm256_or_si256( 
+            _mm256_and_si256( _mm256_slli_epi32( bytes, 8 ), highByte ), 
+            _mm256_and_si256( _mm256_srli_epi32( bytes, 4 ), highNibble ) );
+        const __m256i second = _mm256_and_si256( _mm256_srli_epi32( bytes, 8 ), secondMask );
+
+        _mm256_storeu_si256( 
+            reinterpret_cast<__m256i*>( pSamples + i ), 
+            _mm256_or_si256( first, _mm256_slli_epi32( second, 16 ) ) );
+    }
+    return i;
+}
+
+#else
+
+bool 
+imageFormat::avx2::isBuilt()
+{
+    return false;
+}
+
+unsigned int imageFormat::avx2::dropAlpha8( const uint8_t*, uint8_t*, unsigned int ) { return 0; }
+unsigned int imageFormat::avx2::addAlpha8( const uint8_t*, uint8_t*, unsigned int ) { return 0; }
+unsigned int imageFormat::avx2::dropAlpha16( const uint16_t*, uint16_t*, unsigned int ) { return 0; }
+unsigned int imageFormat::avx2::addAlpha16( const uint16_t*, uint16_t*, unsigned int ) { return 0; }
+unsigned int imageFormat::avx2::packSamples12( const uint16_t*, uint8_t*, unsigned int ) { return 0; }
+unsigned int imageFormat::avx2::unpackSamples12( const uint8_t*, uint16_t*, unsigned int ) { return 0; }
+
+#endif
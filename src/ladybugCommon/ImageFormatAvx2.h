@@ -0,0 +1,51 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __IMAGEFORMATAVX2_H__
+#define __IMAGEFORMATAVX2_H__
+
+//
+// AVX2 row conversions used by ImageFormat.cpp. Each function converts 
+// as many whole vectors as fit and returns the number of pixels (or 
+// samples) done; the caller finishes the rest. Only call them when 
+// isBuilt() and cpuFeatures::hasAvx2() are both true.
+//
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stdint.h>
+
+namespace imageFormat
+{
+    namespace avx2
+    {
+        bool isBuilt();
+
+        unsigned int dropAlpha8( const uint8_t* pSource, uint8_t* pDest, unsigned int width );
+        unsigned int addAlpha8( const uint8_t* pSource, uint8_t* pDest, unsigned int width );
+        unsigned int dropAlpha16( const uint16_t* pSource, uint16_t* pDest, unsigned int width );
+        unsigned int addAlpha16( const uint16_t* pSource, uint16_t* pDest, unsigned int width );
+
+        unsigned int packSamples12( const uint16_t* pSamples, uint8_t* pDest, unsigned int count );
+        unsigned int unpackSamples12( const uint8_t* pSource, uint16_t* pSamples, unsigned int count );
+    }
+}
+
+#endif // __IMAGEFORMATAVX2_H__
@@ -0,0 +1,483 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "ImuStabilizer.h"
+#include "CameraClock.h"
+
+namespace
+{
+    const double k_pi = 3.14159265358979323846;
+
+    // The gyroscope rate is held between readings, but not for longer 
+    // than this; frames in longer gaps are not corrected
+    const double k_maxGyroGapSeconds = 0.25;
+
+    // Accelerometer readings further than this from 1 g are taken while
+    // the camera accelerates and do not say where gravity is
+    const double k_gravityTolerance = 0.1;
+
+    // The starting tilt is the mean gravity over this time
+    const double k_initialGravitySeconds = 0.5;
+
+    // Longest step of the tilt correction, so that a gap in the readings
+    // does not make the tilt jump
+    const double k_maxTiltStepSeconds = 0.1;
+
+    struct Quaternion
+    {
+        double w;
+        double x;
+        double y;
+        double z;
+    };
+
+    typedef double Matrix[3][3];
+
+    Quaternion multiply( const Quaternion& a, const Quaternion& b )
+    {
+        Quaternion q;
+        q.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+        q.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+        q.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+        q.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+        return q;
+    }
+
+    void normalize( Quaternion& q )
+    {
+        const double norm = sqrt( q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z );
+        q.w /= norm;
+        q.x /= norm;
+        q.y /= norm;
+        q.z /= norm;
+    }
+
+    // Rotation by the angle |v| about v
+    Quaternion fromRotationVector( double x, double y, double z )
+    {
+        const double angle = sqrt( x * x + y * y + z * z );
+        const double scale = angle > 1.0e-12 ? sin( angle / 2.0 ) / angle : 0.5;
+        Quaternion q = { cos( angle / 2.0 ), x * scale, y * scale, z * scale };
+        return q;
+    }
+
+    // Turn the body by the rotation vector, in body coordinates
+    void rotateBody( Quaternion& orientation, double x, double y, double z )
+    {
+        orientation = multiply( orientation, fromRotationVector( x, y, z ) );
+        normalize( orientation );
+    }
+
+    void toMatrix( const Quaternion& q, Matrix m )
+    {
+        m[0][0] = 1.0 - 2.0 * ( q.y * q.y + q.z * q.z );
+        m[0][1] = 2.0 * ( q.x * q.y - q.w * q.z );
+        m[0][2] = 2.0 * ( q.x * q.z + q.w * q.y );
+        m[1][0] = 2.0 * ( q.x * q.y + q.w * q.z );
+        m[1][1] = 1.0 - 2.0 * ( q.x * q.x + q.z * q.z );
+        m[1][2] = 2.0 * ( q.y * q.z - q.w * q.x );
+        m[2][0] = 2.0 * ( q.x * q.z - q.w * q.y );
+        m[2][1] = 2.0 * ( q.y * q.z + q.w * q.x );
+        m[2][2] = 1.0 - 2.0 * ( q.x * q.x + q.y * q.y );
+    }
+
+    // m = Rz( rotZ ) * Ry( rotY ) * Rx( rotX )
+    void fromEuler( double rotX, double rotY, double rotZ, Matrix m )
+    {
+        const double cx = cos( rotX ), sx = sin( rotX );
+        const double cy = cos( rotY ), sy = sin( rotY );
+        const double cz = cos( rotZ ), sz = sin( rotZ );
+        m[0][0] = cz * cy;
+        m[0][1] = cz * sy * sx - sz * cx;
+        m[0][2] = cz * sy * cx + sz * sx;
+        m[1][0] = sz * cy;
+        m[1][1] = sz * sy * sx + cz * cx;
+        m[1][2] = sz * sy * cx - cz * sx;
+        m[2][0] = -sy;
+        m[2][1] = cy * sx;
+        m[2][2] = cy * cx;
+    }
+
+    void toEuler( const Matrix m, double& rotX, double& rotY, double& rotZ )
+    {
+        rotY = asin( std::max( -1.0, std::min( 1.0, -m[2][0] ) ) );
+        rotX = atan2( m[2][1], m[2][2] );
+        rotZ = atan2( m[1][0], m[0][0] );
+    }
+
+    // Orientation that has gravity along the body vector (x, y, z) and 
+    // turns as little as possible to get there
+    Quaternion fromGravity( double x, double y, double z )
+    {
+        const double norm = sqrt( x * x + y * y + z * z );
+        x /= norm;
+        y /= norm;
+        z /= norm;
+
+        // Upside down: any half turn about a horizontal axis
+        if ( z < -1.0 + 1.0e-9 )
+        {
+            Quaternion q = { 0.0, 1.0, 0.0, 0.0 };
+            return q;
+        }
+
+        // Half way between the body up and +Z, about their cross product
+        Quaternion q = { 1.0 + z, y, -x, 0.0 };
+        normalize( q );
+        return q;
+    }
+
+    bool isGravity( const SensorSample& sample )
+    {
+        const double norm = sqrt( sample.x * sample.x + sample.y * sample.y + sample.z * sample.z );
+        return fabs( norm - 1.0 ) <= k_gravityTolerance;
+    }
+
+    // Keep an angle within half a turn of the previous one
+    double unwrapAngle( double angle, double previous )
+    {
+        return angle - 2.0 * k_pi * floor( ( angle - previous ) / ( 2.0 * k_pi ) + 0.5 );
+    }
+
+    // Exponential smoothing forward and then backward in time, which 
+    // does not lag
+    void smooth( const std::vector<double>& seconds, std::vector<double>& values, double timeConstant )
+    {
+        if ( values.empty() || timeConstant <= 0.0 )
+        {
+            return;
+        }
+
+        for ( size_t i = 1; i < values.size(); i++ )
+        {
+            const double weight = 1.0 - exp( -( seconds[i] - seconds[i - 1] ) / timeConstant );
+            values[i] = values[i - 1] + weight * ( values[i] - values[i - 1] );
+        }
+        for ( size_t i = values.size() - 1; i > 0; i-- )
+        {
+            const double weight = 1.0 - exp( -( seconds[i] - seconds[i - 1] ) / timeConstant );
+            values[i - 1] = values[i] + weight * ( values[i - 1] - values[i] );
+        }
+    }
+}
+
+ImuStabilizer::ImuStabilizer() :
+m_firstFrame( 0 ),
+m_numCorrected( 0 ),
+m_maxCorrectionDegrees( 0.0 )
+{
+}
+
+ImuStabilizer::Settings 
+ImuStabilizer::getDefaultSettings()
+{
+    Settings settings;
+    settings.tiltSeconds = 2.0;
+    settings.smoothingSeconds = 1.0;
+    settings.levelHorizon = true;
+    return settings;
+}
+
+bool 
+ImuStabilizer::compute( 
+    const SensorLogReader& log, 
+    unsigned int firstFrame, 
+    unsigned int lastFrame, 
+    const Settings& settings, 
+    std::string& errorMessage )
+{
+    m_firstFrame = firstFrame;
+    m_corrections.clear();
+    m_numCorrected = 0;
+    m_maxCorrectionDegrees = 0.0;
+
+    const std::vector<SensorSample>& gyroscope = log.getSamples( sensorLog::SENSOR_GYROSCOPE );
+    const std::vector<SensorSample>& accelerometer = log.getSamples( sensorLog::SENSOR_ACCELEROMETER );
+    if ( gyroscope.empty() )
+    {
+        errorMessage = "The sensor log has no gyroscope readings";
+        return false;
+    }
+
+    if ( lastFrame < firstFrame )
+    {
+        errorMessage = "Invalid frame range";
+        return false;
+    }
+
+    //
+    // Follow the orientation of the camera (body to world) through the
+    // readings, and take it at the time of each frame
+    //
+    struct FrameOrientation
+    {
+        unsigned int frame;
+        unsigned long long tick;
+        Matrix rotation;
+    };
+    std::vector<FrameOrientation> frames;
+    for ( unsigned int frame = firstFrame; frame <= lastFrame; frame++ )
+    {
+        FrameOrientation frameOrientation;
+        frameOrientation.frame = frame;
+        if ( log.getFrameTick( frame, frameOrientation.tick ) )
+        {
+            frames.push_back( frameOrientation );
+        }
+    }
+
+    if ( frames.empty() )
+    {
+        errorMessage = "The sensor log has none of the frames";
+        return false;
+    }
+
+    // Start with the tilt of the mean gravity over the first readings
+    Quaternion orientation = { 1.0, 0.0, 0.0, 0.0 };
+    double gravityX = 0.0;
+    double gravityY = 0.0;
+    double gravityZ = 0.0;
+    bool hasGravity = false;
+    for ( size_t i = 0; i < accelerometer.size(); i++ )
+    {
+        if ( CameraClock::toSeconds( accelerometer[i].tick - accelerometer[0].tick ) > k_initialGravitySeconds )
+        {
+            break;
+        }
+        if ( isGravity( accelerometer[i] ) )
+        {
+            gravityX += accelerometer[i].x;
+            gravityY += accelerometer[i].y;
+            gravityZ += accelerometer[i].z;
+            hasGravity = true;
+        }
+    }
+    if ( hasGravity )
+    {
+        orientation = fromGravity( gravityX, gravityY, gravityZ );
+    }
+
+    const double degreesToRadians = k_pi / 180.0;
+    double rateX = 0.0;
+    double rateY = 0.0;
+    double rateZ = 0.0;
+    unsigned long long lastTick = std::min( gyroscope[0].tick, frames[0].tick );
+    unsigned long long lastGyroTick = 0;
+    unsigned long long lastGravityTick = 0;
+    bool hasRate = false;
+    bool hasLastGravity = false;
+    double errorIntegralX = 0.0;
+    double errorIntegralY = 0.0;
+    double errorIntegralZ = 0.0;
+
+    std::vector<bool> frameIsValid( frames.size(), false );
+    size_t gyroIndex = 0;
+    size_t accelIndex = 0;
+    size_t frameIndex = 0;
+    while ( frameIndex < frames.size() )
+    {
+        // Readings at the time of a frame are used before the frame
+        const unsigned long long gyroTick = gyroIndex < gyroscope.size() ? gyroscope[gyroIndex].tick : ULLONG_MAX;
+        const unsigned long long accelTick = accelIndex < accelerometer.size() ? accelerometer[accelIndex].tick : ULLONG_MAX;
+        const unsigned long long tick = std::min( std::min( gyroTick, accelTick ), frames[frameIndex].tick );
+
+        // Integrate the held rate up to now
+        if ( hasRate && tick > lastTick )
+        {
+            const unsigned long long endTick = std::min( tick, lastGyroTick + 
+                (unsigned long long)( k_maxGyroGapSeconds * CameraClock::k_ticksPerSecond ) );
+            if ( endTick > lastTick )
+            {
+                const double seconds = CameraClock::toSeconds( endTick - lastTick );
+                rotateBody( orientation, rateX * seconds, rateY * seconds, rateZ * seconds );
+            }
+        }
+        lastTick = std::max( lastTick, tick );
+
+        if ( tick == gyroTick )
+        {
+            const SensorSample& sample = gyroscope[gyroIndex++];
+            rateX = sample.x * degreesToRadians;
+            rateY = sample.y * degreesToRadians;
+            rateZ = sample.z * degreesToRadians;
+            lastGyroTick = sample.tick;
+            hasRate = true;
+        }
+        else if ( tick == accelTick )
+        {
+            const SensorSample& sample = accelerometer[accelIndex++];
+            if ( isGravity( sample ) )
+            {
+                // Turn the estimated up (the bottom row of the rotation) 
+                // toward the measured one
+                const double seconds = hasLastGravity ? 
+                    std::min( k_maxTiltStepSeconds, CameraClock::toSeconds( sample.tick - lastGravityTick ) ) : 0.0;
+                const double norm = sqrt( sample.x * sample.x + sample.y * sample.y + sample.z * sample.z );
+                const double upX = sample.x / norm;
+                const double upY = sample.y / norm;
+                const double upZ = sample.z / norm;
+
+                Matrix rotation;
+                toMatrix( orientation, rotation );
+                const double errorX = upY * rotation[2][2] - upZ * rotation[2][1];
+                const double errorY = upZ * rotation[2][0] - upX * rotation[2][2];
+                const double errorZ = upX * rotation[2][1] - upY * rotation[2][0];
+
+                // The integral of the error takes out the gyroscope bias 
+                // about the horizontal axes; critically damped
+                if ( settings.tiltSeconds > 0.0 )
+                {
+                    const double proportionalGain = 1.0 / settings.tiltSeconds;
+                    const double integralGain = proportionalGain * proportionalGain / 4.0;
+                    errorIntegralX += errorX * seconds;
+                    errorIntegralY += errorY * seconds;
+                    errorIntegralZ += errorZ * seconds;
+                    rotateBody( orientation, 
+                        ( proportionalGain * errorX + integralGain * errorIntegralX ) * seconds,
+                        ( proportionalGain * errorY + integralGain * errorIntegralY ) * seconds,
+                        ( proportionalGain * errorZ + integralGain * errorIntegralZ ) * seconds );
+                }
+
+                lastGravityTick = sample.tick;
+                hasLastGravity = true;
+            }
+        }
+        else
+        {
+            // Only frames between two close enough readings are corrected
+            FrameOrientation& frameOrientation = frames[frameIndex];
+            toMatrix( orientation, frameOrientation.rotation );
+            frameIsValid[frameIndex] = hasRate && gyroIndex < gyroscope.size() && 
+                CameraClock::toSeconds( gyroscope[gyroIndex].tick - lastGyroTick ) <= k_maxGyroGapSeconds;
+            frameIndex++;
+        }
+    }
+
+    //
+    // Smooth the orientation of the corrected frames into the motion the
+    // camera makes on purpose
+    //
+    std::vector<size_t> valid;
+    std::vector<double> seconds;
+    std::vector<double> anglesX;
+    std::vector<double> anglesY;
+    std::vector<double> anglesZ;
+    for ( size_t i = 0; i < frames.size(); i++ )
+    {
+        if ( !frameIsValid[i] )
+        {
+            continue;
+        }
+
+        double rotX = 0.0;
+        double rotY = 0.0;
+        double rotZ = 0.0;
+        toEuler( frames[i].rotation, rotX, rotY, rotZ );
+        if ( !valid.empty() )
+        {
+            rotX = unwrapAngle( rotX, anglesX.back() );
+            rotZ = unwrapAngle( rotZ, anglesZ.back() );
+        }
+
+        valid.push_back( i );
+        seconds.push_back( CameraClock::toSeconds( frames[i].tick - frames[0].tick ) );
+        anglesX.push_back( rotX );
+        anglesY.push_back( rotY );
+        anglesZ.push_back( rotZ );
+    }
+
+    const bool isLevel = settings.levelHorizon && hasGravity;
+    if ( isLevel )
+    {
+        std::fill( anglesX.begin(), anglesX.end(), 0.0 );
+        std::fill( anglesY.begin(), anglesY.end(), 0.0 );
+    }
+    else
+    {
+        smooth( seconds, anglesX, settings.smoothingSeconds );
+        smooth( seconds, anglesY, settings.smoothingSeconds );
+    }
+    smooth( seconds, anglesZ, settings.smoothingSeconds );
+
+    //
+    // The correction takes the scene seen in the smoothed orientation to
+    // the body: the transpose of the frame rotation times the smoothed one
+    //
+    Correction none = { false, 0.0, 0.0, 0.0 };
+    m_corrections.assign( lastFrame - firstFrame + 1, none );
+    for ( size_t i = 0; i < valid.size(); i++ )
+    {
+        const FrameOrientation& frameOrientation = frames[valid[i]];
+        Matrix smoothed;
+        fromEuler( anglesX[i], anglesY[i], anglesZ[i], smoothed );
+
+        Matrix correction;
+        for ( unsigned int row = 0; row < 3; row++ )
+        {
+            for ( unsigned int col = 0; col < 3; col++ )
+            {
+                correction[row][col] = 
+                    frameOrientation.rotation[0][row] * smoothed[0][col] + 
+                    frameOrientation.rotation[1][row] * smoothed[1][col] + 
+                    frameOrientation.rotation[2][row] * smoothed[2][col];
+            }
+        }
+
+        Correction& frameCorrection = m_corrections[frameOrientation.frame - firstFrame];
+        frameCorrection.isValid = true;
+        toEuler( correction, frameCorrection.rotX, frameCorrection.rotY, frameCorrection.rotZ );
+        m_numCorrected++;
+
+        const double trace = correction[0][0] + correction[1][1] + correction[2][2];
+        const double angle = acos( std::max( -1.0, std::min( 1.0, ( trace - 1.0 ) / 2.0 ) ) );
+        m_maxCorrectionDegrees = std::max( m_maxCorrectionDegrees, angle * 180.0 / k_pi );
+    }
+
+    return true;
+}
+
+bool 
+ImuStabilizer::getCorrection( unsigned int frame, double& rotX, double& rotY, double& rotZ ) const
+{
+    rotX = 0.0;
+    rotY = 0.0;
+    rotZ = 0.0;
+    if ( frame < m_firstFrame || frame - m_firstFrame >= m_corrections.size() || 
+        !m_corrections[frame - m_firstFrame].isValid )
+    {
+        return false;
+    }
+
+    const Correction& correction = m_corrections[frame - m_firstFrame];
+    rotX = correction.rotX;
+    rotY = correction.rotY;
+    rotZ = correction.rotZ;
+    return true;
+}
@@ -0,0 +1,110 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __IMUSTABILIZER_H__
+#define __IMUSTABILIZER_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string>
+#include <vector>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "SensorLog.h"
+
+/**
+ * Stabilizes the frames of a stream with the gyroscope and accelerometer
+ * readings of its sensor log, instead of matching image templates.
+ *
+ * The gyroscope rates are integrated into the orientation of the camera
+ * at the time of each frame. A complementary filter pulls the tilt of 
+ * that orientation slowly toward the gravity the accelerometer measures,
+ * while the camera is not otherwise accelerating, so that the bias of the
+ * gyroscope does not tilt the horizon over time.
+ *
+ * The motion the camera makes on purpose is taken to be its orientation 
+ * smoothed over the frames before and after, in both directions so that
+ * it does not lag. The correction of a frame rotates the scene from where
+ * the camera pointed to this smoothed orientation, with a level horizon 
+ * if the log has accelerometer readings. Heading drift of the gyroscope 
+ * is slow enough to be followed by the smoothing.
+ *
+ * The sensors are taken to be aligned with the Ladybug coordinate system 
+ * (+X through camera 0, +Z through the top camera), with the gyroscope 
+ * in degrees per second and the accelerometer in g.
+ */
+class ImuStabilizer
+{
+public:
+    struct Settings
+    {
+        /** Seconds over which the tilt follows the accelerometer. */
+        double tiltSeconds;
+
+        /** Seconds of camera motion smoothed away. */
+        double smoothingSeconds;
+
+        /** Correct roll and pitch to a level horizon, if there is an accelerometer. */
+        bool levelHorizon;
+    };
+
+    ImuStabilizer();
+
+    static Settings getDefaultSettings();
+
+    /** Compute the corrections of frames firstFrame to lastFrame. */
+    bool compute( 
+        const SensorLogReader& log, 
+        unsigned int firstFrame, 
+        unsigned int lastFrame, 
+        const Settings& settings, 
+        std::string& errorMessage );
+
+    /**
+     * Correction of a frame as rotations about X, Y and Z in radians, in
+     * this order, as ladybugSet3dMapRotation() takes them. Frames without
+     * gyroscope readings around them are not corrected; false and zero 
+     * angles for those.
+     */
+    bool getCorrection( unsigned int frame, double& rotX, double& rotY, double& rotZ ) const;
+
+    unsigned int getNumCorrected() const { return m_numCorrected; }
+
+    /** Largest correction of any frame, in degrees. */
+    double getMaxCorrectionDegrees() const { return m_maxCorrectionDegrees; }
+
+private:
+    struct Correction
+    {
+        bool isValid;
+        double rotX;
+        double rotY;
+        double rotZ;
+    };
+
+    unsigned int m_firstFrame;
+    std::vector<Correction> m_corrections;
+    unsigned int m_numCorrected;
+    double m_maxCorrectionDegrees;
+};
+
+#endif // __IMUSTABILIZER_H__
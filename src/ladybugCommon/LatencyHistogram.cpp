@@ -0,0 +1,166 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "LatencyHistogram.h"
+
+namespace
+{
+    const unsigned int k_barWidth = 50;
+}
+
+LatencyHistogram::LatencyHistogram( double binWidthUs, unsigned int numBins ) :
+m_binWidthUs( binWidthUs > 0.0 ? binWidthUs : 1.0 ),
+m_bins( std::max( 1u, numBins ) )
+{
+    reset();
+}
+
+void 
+LatencyHistogram::reset()
+{
+    std::fill( m_bins.begin(), m_bins.end(), 0 );
+    m_overflow = 0;
+    m_count = 0;
+    m_min = 0.0;
+    m_max = 0.0;
+    m_sum = 0.0;
+}
+
+void 
+LatencyHistogram::add( double us )
+{
+    const double bin = std::floor( std::max( 0.0, us ) / m_binWidthUs );
+    if ( bin < m_bins.size() )
+    {
+        m_bins[(size_t)bin]++;
+    }
+    else
+    {
+        m_overflow++;
+    }
+
+    m_min = m_count == 0 ? us : std::min( m_min, us );
+    m_max = m_count == 0 ? us : std::max( m_max, us );
+    m_sum += us;
+    m_count++;
+}
+
+double 
+LatencyHistogram::getPercentile( double fraction ) const
+{
+    if ( m_count == 0 )
+    {
+        return 0.0;
+    }
+
+    const unsigned long long target = std::max( 1ULL, 
+        (unsigned long long)std::ceil( std::min( 1.0, std::max( 0.0, fraction ) ) * m_count ) );
+    unsigned long long total = 0;
+    for ( size_t i = 0; i < m_bins.size(); i++ )
+    {
+        total += m_bins[i];
+        if ( total >= target )
+        {
+            return std::min( m_max, ( i + 1 ) * m_binWidthUs );
+        }
+    }
+    return m_max;
+}
+
+std::string 
+LatencyHistogram::getSummary() const
+{
+    char line[256];
+    snprintf( line, sizeof(line), "%llu samples, mean %.1f us, median %.1f us, p99 %.1f us, max %.1f us", 
+        m_count, getMean(), getPercentile( 0.5 ), getPercentile( 0.99 ), getMax() );
+    return line;
+}
+
+void 
+LatencyHistogram::print( FILE* pFile, const char* pszTitle, unsigned int maxLines ) const
+{
+    fprintf( pFile, "%s: %s\n", pszTitle, getSummary().c_str() );
+    if ( m_count == 0 )
+    {
+        return;
+    }
+
+    size_t first = m_bins.size();
+    size_t last = 0;
+    for ( size_t i = 0; i < m_bins.size(); i++ )
+    {
+        if ( m_bins[i] > 0 )
+        {
+            first = std::min( first, i );
+            last = i;
+        }
+    }
+
+    std::vector<unsigned long long> lines;
+    size_t binsPerLine = 1;
+    if ( first < m_bins.size() )
+    {
+        const size_t usedBins = last - first + 1;
+        binsPerLine = ( usedBins + std::max( 1u, maxLines ) - 1 ) / std::max( 1u, maxLines );
+        for ( size_t i = first; i <= last; i += binsPerLine )
+        {
+            unsigned long long count = 0;
+            for ( size_t j = i; j < std::min( last + 1, i + binsPerLine ); j++ )
+            {
+                count += m_bins[j];
+            }
+            lines.push_back( count );
+        }
+    }
+    if ( m_overflow > 0 )
+    {
+        lines.push_back( m_overflow );
+    }
+
+    const unsigned long long largest = *std::max_element( lines.begin(), lines.end() );
+    for ( size_t i = 0; i < lines.size(); i++ )
+    {
+        char bar[k_barWidth + 1];
+        const unsigned int length = (unsigned int)( ( lines[i] * k_barWidth + largest - 1 ) / largest );
+        memset( bar, '#', length );
+        bar[length] = '\0';
+
+        const bool isOverflow = m_overflow > 0 && i == lines.size() - 1;
+        if ( isOverflow )
+        {
+            fprintf( pFile, "  %10.1f -        ... us %10llu %s\n", m_bins.size() * m_binWidthUs, lines[i], bar );
+        }
+        else
+        {
+            const double low = ( first + i * binsPerLine ) * m_binWidthUs;
+            fprintf( pFile, "  %10.1f - %10.1f us %10llu %s\n", low, low + binsPerLine * m_binWidthUs, lines[i], bar );
+        }
+    }
+}
@@ -0,0 +1,76 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __LATENCYHISTOGRAM_H__
+#define __LATENCYHISTOGRAM_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Latencies in microseconds, counted in bins of equal width from zero. 
+ * Values past the last bin go to an overflow bin; the minimum, maximum 
+ * and mean are exact. Not thread safe.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram( double binWidthUs, unsigned int numBins );
+
+    void reset();
+
+    /** Negative values are counted in the first bin. */
+    void add( double us );
+
+    unsigned long long getCount() const { return m_count; }
+    double getMin() const { return m_count > 0 ? m_min : 0.0; }
+    double getMax() const { return m_count > 0 ? m_max : 0.0; }
+    double getMean() const { return m_count > 0 ? m_sum / m_count : 0.0; }
+
+    /** 
+     * Upper edge of the bin that the given fraction (0 to 1) of the values
+     * is at or below, or the maximum if that is in the overflow bin.
+     */
+    double getPercentile( double fraction ) const;
+
+    /** One line with the count, mean, median, 99th percentile and maximum. */
+    std::string getSummary() const;
+
+    /** 
+     * The summary and a bar per bin, from the lowest used bin to the 
+     * highest, with neighbouring bins merged to at most maxLines lines.
+     */
+    void print( FILE* pFile, const char* pszTitle, unsigned int maxLines = 20 ) const;
+
+private:
+    double m_binWidthUs;
+    std::vector<unsigned long long> m_bins;
+    unsigned long long m_overflow;
+
+    unsigned long long m_count;
+    double m_min;
+    double m_max;
+    double m_sum;
+};
+
+#endif // __LATENCYHISTOGRAM_H__
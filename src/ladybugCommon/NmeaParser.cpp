@@ -0,0 +1,623 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NMEA_USE_SSE2
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "NmeaParser.h"
+
+namespace
+{
+    // Where the frame header may hold GPS text, and its longest length
+    const size_t k_headerScanBytes = 4096;
+    const size_t k_maxBlockLength = 1024;
+
+    // Digits of a number beyond which precision is dropped
+    const int k_maxDigits = 17;
+
+    /** Splits the body of a sentence at commas, without copying. */
+    class FieldReader
+    {
+    public:
+        FieldReader( const char* pBegin, const char* pEnd ) : m_p( pBegin ), m_pEnd( pEnd ), m_done( false ) {}
+
+        /** The next field, which may be empty. False after the last one. */
+        bool next( const char*& pField, size_t& length )
+        {
+            if ( m_done )
+            {
+                return false;
+            }
+
+            const char* pComma = static_cast<const char*>( memchr( m_p, ',', m_pEnd - m_p ) );
+            const char* pFieldEnd = pComma != NULL ? pComma : m_pEnd;
+            pField = m_p;
+            length = pFieldEnd - m_p;
+            m_done = pComma == NULL;
+            m_p = pComma != NULL ? pComma + 1 : m_pEnd;
+            return true;
+        }
+
+        /** Skip a field; true if there was one. */
+        bool skip()
+        {
+            const char* pField = NULL;
+            size_t length = 0;
+            return next( pField, length );
+        }
+
+    private:
+        const char* m_p;
+        const char* m_pEnd;
+        bool m_done;
+    };
+
+    int hexValue( char c )
+    {
+        if ( c >= '0' && c <= '9' ) return c - '0';
+        if ( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+        if ( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+        return -1;
+    }
+
+    bool isDigit( char c )
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    /** A decimal number with an optional sign and fraction. Empty fields are false. */
+    bool parseNumber( const char* pField, size_t length, double& value )
+    {
+        const char* p = pField;
+        const char* pEnd = pField + length;
+        bool negative = false;
+        if ( p < pEnd && ( *p == '-' || *p == '+' ) )
+        {
+            negative = *p == '-';
+            p++;
+        }
+
+        long long mantissa = 0;
+        int digits = 0;
+        int fractionDigits = 0;
+        int droppedDigits = 0;
+        bool seenPoint = false;
+        for ( ; p < pEnd; p++ )
+        {
+            if ( *p == '.' && !seenPoint )
+            {
+                seenPoint = true;
+                continue;
+            }
+            if ( !isDigit( *p ) )
+            {
+                return false;
+            }
+
+            digits++;
+            if ( digits > k_maxDigits )
+            {
+                // Too precise to keep; whole digits still count
+                droppedDigits += seenPoint ? 0 : 1;
+                continue;
+            }
+            mantissa = mantissa * 10 + ( *p - '0' );
+            fractionDigits += seenPoint ? 1 : 0;
+        }
+
+        if ( digits == 0 )
+        {
+            return false;
+        }
+
+        double result = (double)mantissa;
+        for ( int i = 0; i < droppedDigits; i++ )
+        {
+            result *= 10.0;
+        }
+        for ( int i = 0; i < fractionDigits; i++ )
+        {
+            result /= 10.0;
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+    /** Exactly count digits, as an unsigned integer. */
+    bool parseDigits( const char* p, size_t count, unsigned int& value )
+    {
+        value = 0;
+        for ( size_t i = 0; i < count; i++ )
+        {
+            if ( !isDigit( p[i] ) )
+            {
+                return false;
+            }
+            value = value * 10 + ( p[i] - '0' );
+        }
+        return true;
+    }
+
+    /** hhmmss with an optional fraction of a second. */
+    bool parseTime( const char* pField, size_t length, NmeaTime& time )
+    {
+        unsigned int hour = 0;
+        unsigned int minute = 0;
+        unsigned int second = 0;
+        if ( length < 6 || 
+            !parseDigits( pField, 2, hour ) || 
+            !parseDigits( pField + 2, 2, minute ) || 
+            !parseDigits( pField + 4, 2, second ) || 
+            hour > 23 || minute > 59 || second > 60 )
+        {
+            return false;
+        }
+
+        double fraction = 0.0;
+        if ( length > 6 && ( pField[6] != '.' || !parseNumber( pField + 6, length - 6, fraction ) ) )
+        {
+            return false;
+        }
+
+        time.hour = (unsigned char)hour;
+        time.minute = (unsigned char)minute;
+        time.second = (unsigned char)second;
+        time.millisecond = (unsigned short)( fraction * 1000.0 + 0.5 > 999.0 ? 999 : fraction * 1000.0 + 0.5 );
+        return true;
+    }
+
+    /** ddmmyy, taking years before 80 as 20yy. */
+    bool parseDate( const char* pField, size_t length, NmeaRmc& rmc )
+    {
+        unsigned int day = 0;
+        unsigned int month = 0;
+        unsigned int year = 0;
+        if ( length != 6 || 
+            !parseDigits( pField, 2, day ) || 
+            !parseDigits( pField + 2, 2, month ) || 
+            !parseDigits( pField + 4, 2, year ) || 
+            day < 1 || day > 31 || month < 1 || month > 12 )
+        {
+            return false;
+        }
+
+        rmc.day = (unsigned char)day;
+        rmc.month = (unsigned char)month;
+        rmc.year = (unsigned short)( year < 80 ? 2000 + year : 1900 + year );
+        return true;
+    }
+
+    /** A [d]ddmm.mmmm field and its hemisphere field. */
+    bool parseCoordinate( FieldReader& fields, char positive, char negative, double maxDegrees, double& value )
+    {
+        const char* pField = NULL;
+        size_t length = 0;
+        const char* pHemisphere = NULL;
+        size_t hemisphereLength = 0;
+        double raw = 0.0;
+        if ( !fields.next( pField, length ) || 
+            !fields.next( pHemisphere, hemisphereLength ) || 
+            !parseNumber( pField, length, raw ) || 
+            raw < 0.0 || hemisphereLength != 1 || 
+            ( *pHemisphere != positive && *pHemisphere != negative ) )
+        {
+            return false;
+        }
+
+        const double degrees = (double)(long long)( raw / 100.0 );
+        const double minutes = raw - degrees * 100.0;
+        if ( minutes >= 60.0 || degrees + minutes / 60.0 > maxDegrees )
+        {
+            return false;
+        }
+
+        value = degrees + minutes / 60.0;
+        if ( *pHemisphere == negative )
+        {
+            value = -value;
+        }
+        return true;
+    }
+
+    bool parseLatitude( FieldReader& fields, double& latitude )
+    {
+        return parseCoordinate( fields, 'N', 'S', 90.0, latitude );
+    }
+
+    bool parseLongitude( FieldReader& fields, double& longitude )
+    {
+        return parseCoordinate( fields, 'E', 'W', 180.0, longitude );
+    }
+
+    /** A number field that may be empty, leaving value at 0. */
+    bool parseOptionalNumber( FieldReader& fields, double& value )
+    {
+        const char* pField = NULL;
+        size_t length = 0;
+        if ( !fields.next( pField, length ) )
+        {
+            return false;
+        }
+        return length == 0 || parseNumber( pField, length, value );
+    }
+
+    /** A single character field that may be empty. */
+    bool parseOptionalChar( FieldReader& fields, char& value )
+    {
+        const char* pField = NULL;
+        size_t length = 0;
+        if ( !fields.next( pField, length ) || length > 1 )
+        {
+            return false;
+        }
+        value = length == 1 ? *pField : '\0';
+        return true;
+    }
+
+    bool parseTimeField( FieldReader& fields, NmeaTime& time )
+    {
+        const char* pField = NULL;
+        size_t length = 0;
+        return fields.next( pField, length ) && parseTime( pField, length, time );
+    }
+
+    //
+    // Each sentence parser fills a local copy, so a malformed sentence 
+    // leaves the last good one of its type in place.
+    //
+
+    bool parseGga( FieldReader& fields, NmeaGga& result )
+    {
+        NmeaGga gga = NmeaGga();
+        double fixQuality = 0.0;
+        double satellites = 0.0;
+        char altitudeUnit = '\0';
+        char separationUnit = '\0';
+        if ( !parseTimeField( fields, gga.time ) || 
+            !parseLatitude( fields, gga.latitude ) || 
+            !parseLongitude( fields, gga.longitude ) || 
+            !parseOptionalNumber( fields, fixQuality ) || 
+            !parseOptionalNumber( fields, satellites ) || 
+            !parseOptionalNumber( fields, gga.hdop ) || 
+            !parseOptionalNumber( fields, gga.altitude ) || 
+            !parseOptionalChar( fields, altitudeUnit ) || 
+            !parseOptionalNumber( fields, gga.geoidSeparation ) || 
+            !parseOptionalChar( fields, separationUnit ) || 
+            fixQuality < 0.0 || fixQuality > 9.0 || satellites < 0.0 || satellites > 99.0 )
+        {
+            return false;
+        }
+
+        gga.fixQuality = (unsigned char)fixQuality;
+        gga.satellites = (unsigned char)satellites;
+        gga.valid = gga.fixQuality > 0;
+        result = gga;
+        return true;
+    }
+
+    bool parseRmc( FieldReader& fields, NmeaRmc& result )
+    {
+        NmeaRmc rmc = NmeaRmc();
+        char status = '\0';
+        const char* pDate = NULL;
+        size_t dateLength = 0;
+        if ( !parseTimeField( fields, rmc.time ) || 
+            !parseOptionalChar( fields, status ) || 
+            !parseLatitude( fields, rmc.latitude ) || 
+            !parseLongitude( fields, rmc.longitude ) || 
+            !parseOptionalNumber( fields, rmc.speedKnots ) || 
+            !parseOptionalNumber( fields, rmc.courseDegrees ) || 
+            !fields.next( pDate, dateLength ) || 
+            !parseDate( pDate, dateLength, rmc ) )
+        {
+            return false;
+        }
+
+        rmc.valid = status == 'A';
+        result = rmc;
+        return true;
+    }
+
+    bool parseGll( FieldReader& fields, NmeaGll& result )
+    {
+        NmeaGll gll = NmeaGll();
+        char status = '\0';
+        if ( !parseLatitude( fields, gll.latitude ) || 
+            !parseLongitude( fields, gll.longitude ) || 
+            !parseTimeField( fields, gll.time ) || 
+            !parseOptionalChar( fields, status ) )
+        {
+            return false;
+        }
+
+        gll.valid = status == 'A';
+        result = gll;
+        return true;
+    }
+
+    bool parseVtg( FieldReader& fields, NmeaVtg& result )
+    {
+        // Course T, course M, speed N, speed K, each followed by its unit
+        NmeaVtg vtg = NmeaVtg();
+        double* values[] = { &vtg.trueCourseDegrees, &vtg.magneticCourseDegrees, &vtg.speedKnots, &vtg.speedKmh };
+        for ( unsigned int i = 0; i < 4; i++ )
+        {
+            char unit = '\0';
+            if ( !parseOptionalNumber( fields, *values[i] ) || !parseOptionalChar( fields, unit ) )
+            {
+                return false;
+            }
+        }
+
+        vtg.valid = true;
+        result = vtg;
+        return true;
+    }
+
+    bool parseGsa( FieldReader& fields, NmeaGsa& result )
+    {
+        NmeaGsa gsa = NmeaGsa();
+        double fixType = 0.0;
+        if ( !parseOptionalChar( fields, gsa.mode ) || 
+            !parseOptionalNumber( fields, fixType ) || 
+            fixType < 0.0 || fixType > 3.0 )
+        {
+            return false;
+        }
+
+        for ( unsigned int i = 0; i < 12; i++ )
+        {
+            double satellite = 0.0;
+            if ( !parseOptionalNumber( fields, satellite ) || satellite < 0.0 || satellite > 255.0 )
+            {
+                return false;
+            }
+            if ( satellite > 0.0 )
+            {
+                gsa.satellites[gsa.numSatellites++] = (unsigned char)satellite;
+            }
+        }
+
+        if ( !parseOptionalNumber( fields, gsa.pdop ) || 
+            !parseOptionalNumber( fields, gsa.hdop ) || 
+            !parseOptionalNumber( fields, gsa.vdop ) )
+        {
+            return false;
+        }
+
+        gsa.fixType = (unsigned char)fixType;
+        gsa.valid = gsa.fixType >= 2;
+        result = gsa;
+        return true;
+    }
+
+    /** Parse the text between '$' and '*' of a sentence with a good checksum. */
+    bool parseSentence( const char* pBody, size_t length, NmeaData& data )
+    {
+        FieldReader fields( pBody, pBody + length );
+        const char* pAddress = NULL;
+        size_t addressLength = 0;
+        if ( !fields.next( pAddress, addressLength ) || addressLength != 5 )
+        {
+            return false;
+        }
+
+        // The talker is the first two characters; the type the last three
+        const char* pType = pAddress + 2;
+        if ( memcmp( pType, "GGA", 3 ) == 0 ) return parseGga( fields, data.gga );
+        if ( memcmp( pType, "RMC", 3 ) == 0 ) return parseRmc( fields, data.rmc );
+        if ( memcmp( pType, "GLL", 3 ) == 0 ) return parseGll( fields, data.gll );
+        if ( memcmp( pType, "VTG", 3 ) == 0 ) return parseVtg( fields, data.vtg );
+        if ( memcmp( pType, "GSA", 3 ) == 0 ) return parseGsa( fields, data.gsa );
+        return false;
+    }
+
+    /** Whether a sentence starts at p: '$', five letters or digits and a comma. */
+    bool isSentenceStart( const char* p, const char* pEnd )
+    {
+        if ( pEnd - p < 7 || p[0] != '$' || p[6] != ',' )
+        {
+            return false;
+        }
+        for ( int i = 1; i < 6; i++ )
+        {
+            if ( !( ( p[i] >= 'A' && p[i] <= 'Z' ) || isDigit( p[i] ) ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+unsigned char 
+nmeaParser::computeChecksum( const char* pText, size_t length )
+{
+    size_t i = 0;
+    unsigned char checksum = 0;
+
+#ifdef NMEA_USE_SSE2
+    if ( length >= 16 )
+    {
+        __m128i sum = _mm_setzero_si128();
+        for ( ; i + 16 <= length; i += 16 )
+        {
+            sum = _mm_xor_si128( sum, _mm_loadu_si128( reinterpret_cast<const __m128i*>( pText + i ) ) );
+        }
+        sum = _mm_xor_si128( sum, _mm_srli_si128( sum, 8 ) );
+        sum = _mm_xor_si128( sum, _mm_srli_si128( sum, 4 ) );
+        sum = _mm_xor_si128( sum, _mm_srli_si128( sum, 2 ) );
+        sum = _mm_xor_si128( sum, _mm_srli_si128( sum, 1 ) );
+        checksum = (unsigned char)_mm_cvtsi128_si32( sum );
+    }
+#endif
+
+    for ( ; i < length; i++ )
+    {
+        checksum ^= (unsigned char)pText[i];
+    }
+    return checksum;
+}
+
+unsigned int 
+nmeaParser::parse( const char* pText, size_t length, NmeaData& data )
+{
+    data = NmeaData();
+    if ( pText == NULL )
+    {
+        return 0;
+    }
+
+    unsigned int used = 0;
+    const char* p = pText;
+    const char* pEnd = pText + length;
+    while ( p < pEnd )
+    {
+        const char* pStart = static_cast<const char*>( memchr( p, '$', pEnd - p ) );
+        if ( pStart == NULL )
+        {
+            break;
+        }
+
+        // The sentence runs to its '*', unless another sentence or a 
+        // line break comes first
+        const char* pStar = NULL;
+        const char* q = pStart + 1;
+        for ( ; q < pEnd; q++ )
+        {
+            if ( *q == '*' )
+            {
+                pStar = q;
+                break;
+            }
+            if ( *q == '$' || *q == '\r' || *q == '\n' )
+            {
+                break;
+            }
+        }
+
+        if ( pStar == NULL || pEnd - pStar < 3 )
+        {
+            data.numRejected++;
+            p = q;
+            continue;
+        }
+
+        const int high = hexValue( pStar[1] );
+        const int low = hexValue( pStar[2] );
+        const char* pBody = pStart + 1;
+        const size_t bodyLength = pStar - pBody;
+        if ( high < 0 || low < 0 || computeChecksum( pBody, bodyLength ) != ( high << 4 | low ) )
+        {
+            data.numRejected++;
+            p = pStar + 1;
+            continue;
+        }
+
+        data.numSentences++;
+        if ( parseSentence( pBody, bodyLength, data ) )
+        {
+            used++;
+        }
+        p = pStar + 3;
+    }
+
+    return used;
+}
+
+bool 
+nmeaParser::findInImage( const LadybugImage& image, const char*& pText, size_t& length )
+{
+    if ( image.pData == NULL )
+    {
+        return false;
+    }
+
+    const char* pData = reinterpret_cast<const char*>( image.pData );
+    const size_t scanLength = image.uiDataSizeBytes < k_headerScanBytes ? image.uiDataSizeBytes : k_headerScanBytes;
+    const char* pScanEnd = pData + scanLength;
+
+    for ( const char* p = pData; p < pScanEnd; p++ )
+    {
+        p = static_cast<const char*>( memchr( p, '$', pScanEnd - p ) );
+        if ( p == NULL )
+        {
+            return false;
+        }
+        if ( !isSentenceStart( p, pScanEnd ) )
+        {
+            continue;
+        }
+
+        const size_t available = pScanEnd - p < (ptrdiff_t)k_maxBlockLength ? pScanEnd - p : k_maxBlockLength;
+        const char* pZero = static_cast<const char*>( memchr( p, '\0', available ) );
+        pText = p;
+        length = pZero != NULL ? pZero - p : available;
+        return true;
+    }
+
+    return false;
+}
+
+bool 
+nmeaParser::getPosition( const NmeaData& data, double& latitude, double& longitude )
+{
+    if ( data.gga.valid )
+    {
+        latitude = data.gga.latitude;
+        longitude = data.gga.longitude;
+        return true;
+    }
+    if ( data.rmc.valid )
+    {
+        latitude = data.rmc.latitude;
+        longitude = data.rmc.longitude;
+        return true;
+    }
+    if ( data.gll.valid )
+    {
+        latitude = data.gll.latitude;
+        longitude = data.gll.longitude;
+        return true;
+    }
+    return false;
+}
+
+long 
+nmeaParser::getDayNumber( unsigned int year, unsigned int month, unsigned int day )
+{
+    // Days from civil, counting years from March so that leap days come last
+    const int shiftedYear = (int)year - ( month <= 2 ? 1 : 0 );
+    const long era = ( shiftedYear >= 0 ? shiftedYear : shiftedYear - 399 ) / 400;
+    const unsigned int yearOfEra = (unsigned int)( shiftedYear - era * 400 );
+    const unsigned int dayOfYear = ( 153 * ( month > 2 ? month - 3 : month + 9 ) + 2 ) / 5 + day - 1;
+    const unsigned int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + (long)dayOfEra - 719468;
+}
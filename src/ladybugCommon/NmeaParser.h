@@ -0,0 +1,152 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __NMEAPARSER_H__
+#define __NMEAPARSER_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stddef.h>
+
+#include <ladybug.h>
+
+//
+// Positions are in decimal degrees, positive north and east, like the 
+// GPS data of LadybugImageInfo. Fields missing from a sentence are 0.
+//
+
+/** UTC time of day. */
+struct NmeaTime
+{
+    unsigned char hour;
+    unsigned char minute;
+    unsigned char second;
+    unsigned short millisecond;
+};
+
+struct NmeaGga
+{
+    /** Received, and reporting a fix. */
+    bool valid;
+    NmeaTime time;
+    double latitude;
+    double longitude;
+    unsigned char fixQuality;
+    unsigned char satellites;
+    double hdop;
+
+    /** Above mean sea level, and of the geoid above the ellipsoid, in meters. */
+    double altitude;
+    double geoidSeparation;
+};
+
+struct NmeaRmc
+{
+    /** Received with status A (active). */
+    bool valid;
+    NmeaTime time;
+    double latitude;
+    double longitude;
+    double speedKnots;
+    double courseDegrees;
+    unsigned char day;
+    unsigned char month;
+    unsigned short year;
+};
+
+struct NmeaGll
+{
+    /** Received with status A (active). */
+    bool valid;
+    NmeaTime time;
+    double latitude;
+    double longitude;
+};
+
+struct NmeaVtg
+{
+    bool valid;
+    double trueCourseDegrees;
+    double magneticCourseDegrees;
+    double speedKnots;
+    double speedKmh;
+};
+
+struct NmeaGsa
+{
+    /** Received with a 2D or 3D fix. */
+    bool valid;
+    char mode;
+    unsigned char fixType;
+    unsigned char numSatellites;
+    unsigned char satellites[12];
+    double pdop;
+    double hdop;
+    double vdop;
+};
+
+/** The last sentence of each type found in a block of NMEA text. */
+struct NmeaData
+{
+    NmeaGga gga;
+    NmeaRmc rmc;
+    NmeaGll gll;
+    NmeaVtg vtg;
+    NmeaGsa gsa;
+
+    /** Sentences with a good checksum, and sentences rejected as malformed. */
+    unsigned int numSentences;
+    unsigned int numRejected;
+};
+
+/**
+ * Single pass NMEA 0183 parser that does not allocate, for the GPS text
+ * of every frame.
+ *
+ * A block is any number of sentences, with or without line breaks 
+ * between them, as passed to ladybugWriteGPSDataToImage(). Bytes 
+ * outside sentences are skipped. A sentence must end with a checksum 
+ * that matches. Any talker is accepted (GP, GN, GL, ...), so GNGGA 
+ * fills the GGA fields.
+ */
+namespace nmeaParser
+{
+    /** Parse a block into data, replacing its contents. Returns the number of sentences used. */
+    unsigned int parse( const char* pText, size_t length, NmeaData& data );
+
+    /** XOR of the bytes, the NMEA checksum of the text between '$' and '*'. */
+    unsigned char computeChecksum( const char* pText, size_t length );
+
+    /**
+     * Find the NMEA text in the frame header of an image. The text runs 
+     * from the first sentence start to the first zero byte, within the 
+     * first 4 KB of the frame. Returns false if there is none there; 
+     * ladybugGetGPSNMEADataFromImage() still works for such images.
+     */
+    bool findInImage( const LadybugImage& image, const char*& pText, size_t& length );
+
+    /** The position from GGA, RMC or GLL, in that order of preference. */
+    bool getPosition( const NmeaData& data, double& latitude, double& longitude );
+
+    /** Days since 1970-01-01 of a date, such as the date of an RMC sentence. */
+    long getDayNumber( unsigned int year, unsigned int month, unsigned int day );
+}
+
+#endif // __NMEAPARSER_H__
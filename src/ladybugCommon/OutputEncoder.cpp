@@ -0,0 +1,673 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <turbojpeg.h>
+#include <zlib.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "FrameArchive.h"
+#include "OutputEncoder.h"
+
+namespace
+{
+    const int k_defaultJpegQuality = 90;
+    const int k_jpegSubsampling = TJSAMP_420;
+    const int k_pngCompressionLevel = 1;
+
+    const unsigned char k_pngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    const unsigned char k_pngFilterSub = 1;
+
+    const unsigned int k_tiffNumTags = 10;
+    const unsigned int k_tiffIfdOffset = 8;
+    const unsigned int k_tiffBitsPerSampleOffset = k_tiffIfdOffset + 2 + k_tiffNumTags * 12 + 4;
+    const unsigned int k_tiffDataOffset = k_tiffBitsPerSampleOffset + 3 * 2;
+
+    const unsigned int k_bmpHeaderBytes = 14 + 40;
+    const unsigned int k_bmpPixelsPerMeter = 2835; // 72 DPI
+
+    unsigned int resolveNumThreads( unsigned int numThreads )
+    {
+        return numThreads != 0 ? numThreads : std::max( 1u, std::thread::hardware_concurrency() );
+    }
+
+    double secondsSince( const std::chrono::steady_clock::time_point& start )
+    {
+        return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    bool getLayout( LadybugPixelFormat pixelFormat, unsigned int& channels, unsigned int& bytesPerSample )
+    {
+        switch ( pixelFormat )
+        {
+        case LADYBUG_BGR: channels = 3; bytesPerSample = 1; return true;
+        case LADYBUG_BGRU: channels = 4; bytesPerSample = 1; return true;
+        case LADYBUG_BGR16: channels = 3; bytesPerSample = 2; return true;
+        case LADYBUG_BGRU16: channels = 4; bytesPerSample = 2; return true;
+        default: return false;
+        }
+    }
+
+    unsigned char* putU16LE( unsigned char* p, unsigned int value )
+    {
+        p[0] = (unsigned char)value;
+        p[1] = (unsigned char)( value >> 8 );
+        return p + 2;
+    }
+
+    unsigned char* putU32LE( unsigned char* p, unsigned int value )
+    {
+        return putU16LE( putU16LE( p, value & 0xFFFF ), value >> 16 );
+    }
+
+    unsigned char* putU32BE( unsigned char* p, unsigned int value )
+    {
+        p[0] = (unsigned char)( value >> 24 );
+        p[1] = (unsigned char)( value >> 16 );
+        p[2] = (unsigned char)( value >> 8 );
+        p[3] = (unsigned char)value;
+        return p + 4;
+    }
+
+    unsigned char* putTiffTag( unsigned char* p, unsigned int tag, unsigned int type, unsigned int count, unsigned int value )
+    {
+        p = putU16LE( p, tag );
+        p = putU16LE( p, type );
+        p = putU32LE( p, count );
+
+        // A single SHORT is left aligned in the value field
+        return type == 3 && count == 1 ? putU32LE( p, value & 0xFFFF ) : putU32LE( p, value );
+    }
+
+    bool writeFile( const std::string& path, const unsigned char* pData, size_t size )
+    {
+        FILE* pFile = fopen( path.c_str(), "wb" );
+        if ( pFile == NULL )
+        {
+            return false;
+        }
+
+        const bool written = fwrite( pData, 1, size, pFile ) == size;
+        return fclose( pFile ) == 0 && written;
+    }
+}
+
+//
+// The state one worker reuses for every image it encodes
+//
+struct OutputEncoder::Encoder
+{
+    Encoder();
+    ~Encoder();
+
+    /** Encode the whole file into data. */
+    bool encode( const Job& job );
+
+    bool encodeJpeg( const Job& job );
+    bool encodePng( const Job& job );
+    bool encodeTiff( const Job& job );
+    bool encodeBmp( const Job& job );
+
+    /** One row as B, G, R bytes, taking the high byte of 16 bit samples. */
+    static void getRowBgr8( const Job& job, unsigned int row, unsigned char* pDest );
+
+    /** One row as R, G, B samples, 16 bit samples in the given byte order. */
+    static void getRowRgb( const Job& job, unsigned int row, bool bigEndian, unsigned char* pDest );
+
+    tjhandle jpegHandle;
+    z_stream zStream;
+    bool zStreamReady;
+
+    std::vector<unsigned char> data;
+    size_t dataSize;
+
+    std::vector<unsigned char> rows;
+    std::vector<unsigned char> filteredRow;
+};
+
+OutputEncoder::Encoder::Encoder() :
+jpegHandle( tjInitCompress() ),
+zStreamReady( false ),
+dataSize( 0 )
+{
+    memset( &zStream, 0, sizeof(zStream) );
+    zStreamReady = deflateInit( &zStream, k_pngCompressionLevel ) == Z_OK;
+}
+
+OutputEncoder::Encoder::~Encoder()
+{
+    if ( jpegHandle != NULL )
+    {
+        tjDestroy( jpegHandle );
+    }
+    if ( zStreamReady )
+    {
+        deflateEnd( &zStream );
+    }
+}
+
+bool 
+OutputEncoder::Encoder::encode( const Job& job )
+{
+    dataSize = 0;
+    switch ( job.format )
+    {
+    case FORMAT_JPEG: return encodeJpeg( job );
+    case FORMAT_PNG: return encodePng( job );
+    case FORMAT_TIFF: return encodeTiff( job );
+    case FORMAT_BMP: return encodeBmp( job );
+    default: return false;
+    }
+}
+
+void 
+OutputEncoder::Encoder::getRowBgr8( const Job& job, unsigned int row, unsigned char* pDest )
+{
+    const size_t rowSamples = (size_t)job.cols * job.channels;
+    if ( job.bytesPerSample == 1 )
+    {
+        const unsigned char* pSource = &job.pixels[ row * rowSamples ];
+        if ( job.channels == 3 )
+        {
+            memcpy( pDest, pSource, rowSamples );
+            return;
+        }
+
+        for ( unsigned int x = 0; x < job.cols; x++, pSource += 4, pDest += 3 )
+        {
+            pDest[0] = pSource[0];
+            pDest[1] = pSource[1];
+            pDest[2] = pSource[2];
+        }
+    }
+    else
+    {
+        const unsigned short* pSource = reinterpret_cast<const unsigned short*>( &job.pixels[0] ) + row * rowSamples;
+        for ( unsigned int x = 0; x < job.cols; x++, pSource += job.channels, pDest += 3 )
+        {
+            pDest[0] = (unsigned char)( pSource[0] >> 8 );
+            pDest[1] = (unsigned char)( pSource[1] >> 8 );
+            pDest[2] = (unsigned char)( pSource[2] >> 8 );
+        }
+    }
+}
+
+void 
+OutputEncoder::Encoder::getRowRgb( const Job& job, unsigned int row, bool bigEndian, unsigned char* pDest )
+{
+    const size_t rowSamples = (size_t)job.cols * job.channels;
+    if ( job.bytesPerSample == 1 )
+    {
+        const unsigned char* pSource = &job.pixels[ row * rowSamples ];
+        for ( unsigned int x = 0; x < job.cols; x++, pSource += job.channels, pDest += 3 )
+        {
+            pDest[0] = pSource[2];
+            pDest[1] = pSource[1];
+            pDest[2] = pSource[0];
+        }
+        return;
+    }
+
+    const int high = bigEndian ? 0 : 1;
+    const unsigned short* pSource = reinterpret_cast<const unsigned short*>( &job.pixels[0] ) + row * rowSamples;
+    for ( unsigned int x = 0; x < job.cols; x++, pSource += job.channels, pDest += 6 )
+    {
+        for ( int channel = 0; channel < 3; channel++ )
+        {
+            const unsigned short sample = pSource[ 2 - channel ];
+            pDest[ channel * 2 + high ] = (unsigned char)( sample >> 8 );
+            pDest[ channel * 2 + 1 - high ] = (unsigned char)sample;
+        }
+    }
+}
+
+bool 
+OutputEncoder::Encoder::encodeJpeg( const Job& job )
+{
+    if ( jpegHandle == NULL )
+    {
+        return false;
+    }
+
+    // 8 bit images are compressed from where they are
+    const unsigned char* pSource = &job.pixels[0];
+    int pitch = (int)( job.cols * job.channels );
+    int pixelFormat = job.channels == 4 ? TJPF_BGRX : TJPF_BGR;
+    if ( job.bytesPerSample != 1 )
+    {
+        const size_t rowBytes = (size_t)job.cols * 3;
+        rows.resize( rowBytes * job.rows );
+        for ( unsigned int row = 0; row < job.rows; row++ )
+        {
+            getRowBgr8( job, row, &rows[ row * rowBytes ] );
+        }
+
+        pSource = &rows[0];
+        pitch = (int)rowBytes;
+        pixelFormat = TJPF_BGR;
+    }
+
+    // Compress into the buffer kept from the previous image
+    unsigned long size = tjBufSize( (int)job.cols, (int)job.rows, k_jpegSubsampling );
+    data.resize( size );
+    unsigned char* pData = &data[0];
+    if ( tjCompress2( 
+        jpegHandle, 
+        pSource, 
+        (int)job.cols, 
+        pitch, 
+        (int)job.rows, 
+        pixelFormat, 
+        &pData, 
+        &size, 
+        k_jpegSubsampling, 
+        job.jpegQuality, 
+        TJFLAG_FASTDCT | TJFLAG_NOREALLOC ) != 0 )
+    {
+        return false;
+    }
+
+    dataSize = size;
+    return true;
+}
+
+bool 
+OutputEncoder::Encoder::encodePng( const Job& job )
+{
+    if ( !zStreamReady || deflateReset( &zStream ) != Z_OK )
+    {
+        return false;
+    }
+
+    const unsigned int pixelBytes = 3 * job.bytesPerSample;
+    const size_t rowBytes = (size_t)job.cols * pixelBytes;
+    const size_t maxCompressedSize = deflateBound( &zStream, (uLong)( ( rowBytes + 1 ) * job.rows ) );
+
+    // Signature, IHDR, IDAT header, compressed rows, IDAT CRC and IEND
+    const size_t idatOffset = 8 + 25;
+    const size_t compressedOffset = idatOffset + 8;
+    data.resize( compressedOffset + maxCompressedSize + 4 + 12 );
+
+    unsigned char* p = &data[0];
+    memcpy( p, k_pngSignature, sizeof(k_pngSignature) );
+    p += sizeof(k_pngSignature);
+
+    p = putU32BE( p, 13 );
+    memcpy( p, "IHDR", 4 );
+    p = putU32BE( p + 4, job.cols );
+    p = putU32BE( p, job.rows );
+    p[0] = (unsigned char)( job.bytesPerSample * 8 );
+    p[1] = 2; // Truecolor
+    p[2] = 0;
+    p[3] = 0;
+    p[4] = 0;
+    p = putU32BE( p + 5, (unsigned int)crc32( 0, &data[12], 4 + 13 ) );
+
+    // Each row is stored as the difference to the pixel on its left
+    rows.resize( rowBytes );
+    filteredRow.resize( rowBytes + 1 );
+    filteredRow[0] = k_pngFilterSub;
+
+    zStream.next_out = &data[ compressedOffset ];
+    zStream.avail_out = (uInt)maxCompressedSize;
+    for ( unsigned int row = 0; row < job.rows; row++ )
+    {
+        getRowRgb( job, row, true, &rows[0] );
+
+        unsigned char* pFiltered = &filteredRow[1];
+        memcpy( pFiltered, &rows[0], pixelBytes );
+        for ( size_t i = pixelBytes; i < rowBytes; i++ )
+        {
+            pFiltered[i] = (unsigned char)( rows[i] - rows[ i - pixelBytes ] );
+        }
+
+        zStream.next_in = &filteredRow[0];
+        zStream.avail_in = (uInt)filteredRow.size();
+        const int result = deflate( &zStream, row + 1 == job.rows ? Z_FINISH : Z_NO_FLUSH );
+        if ( result != Z_OK && result != Z_STREAM_END )
+        {
+            return false;
+        }
+    }
+
+    const unsigned int compressedSize = (unsigned int)zStream.total_out;
+    p = putU32BE( &data[ idatOffset ], compressedSize );
+    memcpy( p, "IDAT", 4 );
+    p = &data[ compressedOffset + compressedSize ];
+    p = putU32BE( p, (unsigned int)crc32( 0, &data[ idatOffset + 4 ], 4 + compressedSize ) );
+
+    p = putU32BE( p, 0 );
+    memcpy( p, "IEND", 4 );
+    p = putU32BE( p + 4, (unsigned int)crc32( 0, p, 4 ) );
+
+    dataSize = p - &data[0];
+    return true;
+}
+
+bool 
+OutputEncoder::Encoder::encodeTiff( const Job& job )
+{
+    // Baseline, uncompressed RGB in a single strip
+    const size_t rowBytes = (size_t)job.cols * 3 * job.bytesPerSample;
+    const unsigned int imageBytes = (unsigned int)( rowBytes * job.rows );
+    data.resize( k_tiffDataOffset + imageBytes );
+
+    unsigned char* p = &data[0];
+    p[0] = 'I';
+    p[1] = 'I';
+    p = putU16LE( p + 2, 42 );
+    p = putU32LE( p, k_tiffIfdOffset );
+
+    // Tags in ascending order; type 3 is SHORT, 4 is LONG
+    p = putU16LE( p, k_tiffNumTags );
+    p = putTiffTag( p, 256, 4, 1, job.cols );                  // ImageWidth
+    p = putTiffTag( p, 257, 4, 1, job.rows );                  // ImageLength
+    p = putTiffTag( p, 258, 3, 3, k_tiffBitsPerSampleOffset ); // BitsPerSample
+    p = putTiffTag( p, 259, 3, 1, 1 );                         // Compression: none
+    p = putTiffTag( p, 262, 3, 1, 2 );                         // PhotometricInterpretation: RGB
+    p = putTiffTag( p, 273, 4, 1, k_tiffDataOffset );          // StripOffsets
+    p = putTiffTag( p, 277, 3, 1, 3 );                         // SamplesPerPixel
+    p = putTiffTag( p, 278, 4, 1, job.rows );                  // RowsPerStrip
+    p = putTiffTag( p, 279, 4, 1, imageBytes );                // StripByteCounts
+    p = putTiffTag( p, 284, 3, 1, 1 );                         // PlanarConfiguration: chunky
+    p = putU32LE( p, 0 );
+
+    for ( int channel = 0; channel < 3; channel++ )
+    {
+        p = putU16LE( p, job.bytesPerSample * 8 );
+    }
+
+    for ( unsigned int row = 0; row < job.rows; row++ )
+    {
+        getRowRgb( job, row, false, p + row * rowBytes );
+    }
+
+    dataSize = data.size();
+    return true;
+}
+
+bool 
+OutputEncoder::Encoder::encodeBmp( const Job& job )
+{
+    // Rows are stored bottom up and padded to four bytes
+    const unsigned int rowBytes = ( job.cols * 3 + 3 ) & ~3u;
+    const unsigned int imageBytes = rowBytes * job.rows;
+    data.assign( k_bmpHeaderBytes + imageBytes, 0 );
+
+    unsigned char* p = &data[0];
+    p[0] = 'B';
+    p[1] = 'M';
+    p = putU32LE( p + 2, (unsigned int)data.size() );
+    p = putU32LE( p, 0 );
+    p = putU32LE( p, k_bmpHeaderBytes );
+
+    p = putU32LE( p, 40 );
+    p = putU32LE( p, job.cols );
+    p = putU32LE( p, job.rows );
+    p = putU16LE( p, 1 );
+    p = putU16LE( p, 24 );
+    p = putU32LE( p, 0 );
+    p = putU32LE( p, imageBytes );
+    p = putU32LE( p, k_bmpPixelsPerMeter );
+    p = putU32LE( p, k_bmpPixelsPerMeter );
+    p = putU32LE( p, 0 );
+    p = putU32LE( p, 0 );
+
+    for ( unsigned int row = 0; row < job.rows; row++ )
+    {
+        getRowBgr8( job, row, p + ( job.rows - 1 - row ) * rowBytes );
+    }
+
+    dataSize = data.size();
+    return true;
+}
+
+bool 
+OutputEncoder::fromSaveFileFormat( LadybugSaveFileFormat saveFormat, Format& format )
+{
+    switch ( saveFormat )
+    {
+    case LADYBUG_FILEFORMAT_JPG: format = FORMAT_JPEG; return true;
+    case LADYBUG_FILEFORMAT_PNG: format = FORMAT_PNG; return true;
+    case LADYBUG_FILEFORMAT_TIFF: format = FORMAT_TIFF; return true;
+    case LADYBUG_FILEFORMAT_BMP: format = FORMAT_BMP; return true;
+    default: return false;
+    }
+}
+
+OutputEncoder::OutputEncoder( unsigned int numThreads, unsigned int maxPending ) :
+m_maxPending( maxPending != 0 ? maxPending : 2 * resolveNumThreads( numThreads ) ),
+m_numPending( 0 ),
+m_stopRequested( false ),
+m_jpegQuality( k_defaultJpegQuality ),
+m_pArchive( NULL ),
+m_numWritten( 0 ),
+m_numFailed( 0 ),
+m_encodeSeconds( 0.0 ),
+m_writeSeconds( 0.0 )
+{
+    numThreads = resolveNumThreads( numThreads );
+    for ( unsigned int i = 0; i < numThreads; i++ )
+    {
+        m_workers.push_back( std::thread( &OutputEncoder::workerLoop, this ) );
+    }
+}
+
+OutputEncoder::~OutputEncoder()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stopRequested = true;
+    }
+    m_jobAvailable.notify_all();
+
+    for ( size_t i = 0; i < m_workers.size(); i++ )
+    {
+        m_workers[i].join();
+    }
+}
+
+void 
+OutputEncoder::setJpegQuality( int quality )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_jpegQuality = std::min( 100, std::max( 1, quality ) );
+}
+
+void 
+OutputEncoder::setArchive( FrameArchiveWriter* pArchive )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_pArchive = pArchive;
+}
+
+bool 
+OutputEncoder::submit( const LadybugProcessedImage& image, const std::string& path, Format format )
+{
+    return submitRegion( image, 0, 0, image.uiCols, image.uiRows, path, format );
+}
+
+bool 
+OutputEncoder::submitRegion( 
+    const LadybugProcessedImage& image, 
+    unsigned int x, 
+    unsigned int y, 
+    unsigned int cols, 
+    unsigned int rows, 
+    const std::string& path, 
+    Format format )
+{
+    unsigned int channels = 0;
+    unsigned int bytesPerSample = 0;
+    if ( !getLayout( image.pixelFormat, channels, bytesPerSample ) || 
+        image.pData == NULL || cols == 0 || rows == 0 || 
+        x + cols > image.uiCols || y + rows > image.uiRows )
+    {
+        return false;
+    }
+
+    std::unique_ptr<Job> job;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_jobDone.wait( lock, [this]{ return m_numPending < m_maxPending; } );
+        m_numPending++;
+
+        if ( !m_freeJobs.empty() )
+        {
+            job = std::move( m_freeJobs.back() );
+            m_freeJobs.pop_back();
+        }
+        else
+        {
+            job.reset( new Job );
+        }
+        job->jpegQuality = m_jpegQuality;
+        job->pArchive = m_pArchive;
+    }
+
+    // The caller may reuse the image as soon as this returns
+    const size_t pixelSize = (size_t)channels * bytesPerSample;
+    const size_t sourceStride = image.uiCols * pixelSize;
+    const size_t destStride = cols * pixelSize;
+    job->pixels.resize( destStride * rows );
+    for ( unsigned int row = 0; row < rows; row++ )
+    {
+        memcpy( 
+            &job->pixels[row * destStride], 
+            image.pData + ( y + row ) * sourceStride + x * pixelSize, 
+            destStride );
+    }
+    job->cols = cols;
+    job->rows = rows;
+    job->channels = channels;
+    job->bytesPerSample = bytesPerSample;
+    job->path = path;
+    job->format = format;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_queue.push_back( std::move( job ) );
+    }
+    m_jobAvailable.notify_one();
+
+    return true;
+}
+
+void 
+OutputEncoder::waitAll()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_jobDone.wait( lock, [this]{ return m_numPending == 0; } );
+}
+
+unsigned int 
+OutputEncoder::getNumWritten() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_numWritten;
+}
+
+unsigned int 
+OutputEncoder::getNumFailed() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_numFailed;
+}
+
+std::string 
+OutputEncoder::getLastFailedPath() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_lastFailedPath;
+}
+
+double 
+OutputEncoder::getEncodeSeconds() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_encodeSeconds;
+}
+
+double 
+OutputEncoder::getWriteSeconds() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_writeSeconds;
+}
+
+void 
+OutputEncoder::workerLoop()
+{
+    Encoder encoder;
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    for ( ;; )
+    {
+        // Pending images are still written once a stop is requested
+        m_jobAvailable.wait( lock, [this]{ return m_stopRequested || !m_queue.empty(); } );
+        if ( m_queue.empty() )
+        {
+            return;
+        }
+
+        std::unique_ptr<Job> job = std::move( m_queue.front() );
+        m_queue.pop_front();
+        lock.unlock();
+
+        const std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+        bool succeeded = encoder.encode( *job );
+        const double encodeSeconds = secondsSince( encodeStart );
+
+        const std::chrono::steady_clock::time_point writeStart = std::chrono::steady_clock::now();
+        if ( succeeded )
+        {
+            succeeded = job->pArchive != NULL ? 
+                job->pArchive->append( job->path, &encoder.data[0], encoder.dataSize ) :
+                writeFile( job->path, &encoder.data[0], encoder.dataSize );
+        }
+        const double writeSeconds = secondsSince( writeStart );
+
+        lock.lock();
+        m_encodeSeconds += encodeSeconds;
+        m_writeSeconds += writeSeconds;
+        if ( succeeded )
+        {
+            m_numWritten++;
+        }
+        else
+        {
+            m_numFailed++;
+            m_lastFailedPath = job->path;
+        }
+
+        m_freeJobs.push_back( std::move( job ) );
+        m_numPending--;
+        m_jobDone.notify_all();
+    }
+}
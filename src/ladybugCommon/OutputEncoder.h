@@ -0,0 +1,165 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __OUTPUTENCODER_H__
+#define __OUTPUTENCODER_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ladybug.h>
+
+class FrameArchiveWriter;
+
+/**
+ * Writes rendered images to JPEG, PNG, TIFF or BMP files on a set of 
+ * worker threads, in place of ladybugSaveImage().
+ *
+ * submit() copies the pixels and returns, so the caller can render the 
+ * next image while earlier ones are encoded. Each worker keeps its 
+ * turbojpeg handle, zlib stream and output buffer for its lifetime, and 
+ * the copies are recycled, so steady state encoding allocates nothing.
+ *
+ * Images can also be appended to a FrameArchiveWriter instead of 
+ * being written to files.
+ *
+ * JPEG files use the fast integer DCT without Huffman table 
+ * optimization. 16 bit images are written with 16 bit samples to PNG 
+ * and TIFF, and with their high bytes to JPEG and BMP.
+ */
+class OutputEncoder
+{
+public:
+    enum Format
+    {
+        FORMAT_JPEG,
+        FORMAT_PNG,
+        FORMAT_TIFF,
+        FORMAT_BMP
+    };
+
+    /** The format matching a library file format, if it is supported. */
+    static bool fromSaveFileFormat( LadybugSaveFileFormat saveFormat, Format& format );
+
+    /** 
+     * numThreads of 0 uses one thread per hardware thread. submit() 
+     * blocks while maxPending images wait or are being encoded; 0 allows
+     * two per thread.
+     */
+    explicit OutputEncoder( unsigned int numThreads = 0, unsigned int maxPending = 0 );
+
+    /** Writes the images still pending. */
+    ~OutputEncoder();
+
+    unsigned int getNumThreads() const { return (unsigned int)m_workers.size(); }
+
+    /** JPEG quality from 1 to 100, applied to images submitted afterwards. */
+    void setJpegQuality( int quality );
+
+    /** 
+     * Append the images submitted afterwards to an archive instead of 
+     * writing files; their paths are then the entry names. NULL writes 
+     * files again.
+     */
+    void setArchive( FrameArchiveWriter* pArchive );
+
+    /**
+     * Queue a copy of a LADYBUG_BGR, LADYBUG_BGRU, LADYBUG_BGR16 or 
+     * LADYBUG_BGRU16 image to be written to path. Returns false for 
+     * other pixel formats.
+     */
+    bool submit( const LadybugProcessedImage& image, const std::string& path, Format format );
+
+    /** Queue a copy of the cols x rows region of image with its top left corner at x, y. */
+    bool submitRegion( 
+        const LadybugProcessedImage& image, 
+        unsigned int x, 
+        unsigned int y, 
+        unsigned int cols, 
+        unsigned int rows, 
+        const std::string& path, 
+        Format format );
+
+    /** Wait until every submitted image has been written or has failed. */
+    void waitAll();
+
+    unsigned int getNumWritten() const;
+    unsigned int getNumFailed() const;
+
+    /** The path of the most recent image that could not be written. */
+    std::string getLastFailedPath() const;
+
+    /** Thread time spent encoding and writing files, summed over the workers. */
+    double getEncodeSeconds() const;
+    double getWriteSeconds() const;
+
+private:
+    struct Job
+    {
+        std::vector<unsigned char> pixels;
+        unsigned int cols;
+        unsigned int rows;
+        unsigned int channels;
+        unsigned int bytesPerSample;
+        std::string path;
+        Format format;
+        int jpegQuality;
+        FrameArchiveWriter* pArchive;
+    };
+
+    struct Encoder;
+
+    OutputEncoder( const OutputEncoder& );
+    OutputEncoder& operator=( const OutputEncoder& );
+
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    const unsigned int m_maxPending;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_jobDone;
+
+    std::deque< std::unique_ptr<Job> > m_queue;
+
+    /** Finished jobs, kept for their pixel buffers. */
+    std::vector< std::unique_ptr<Job> > m_freeJobs;
+
+    unsigned int m_numPending;
+    bool m_stopRequested;
+    int m_jpegQuality;
+    FrameArchiveWriter* m_pArchive;
+
+    unsigned int m_numWritten;
+    unsigned int m_numFailed;
+    std::string m_lastFailedPath;
+    double m_encodeSeconds;
+    double m_writeSeconds;
+};
+
+#endif // __OUTPUTENCODER_H__
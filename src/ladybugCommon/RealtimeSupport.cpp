@@ -0,0 +1,310 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "RealtimeSupport.h"
+
+namespace
+{
+#ifndef _WIN32
+    std::string describeErrno( const char* what, int errorNumber )
+    {
+        std::stringstream message;
+        message << what << " failed: " << strerror( errorNumber );
+        if ( errorNumber == EPERM )
+        {
+            message << " (missing privileges or resource limits)";
+        }
+        return message.str();
+    }
+
+    /** Find the NUMA node of a CPU from sysfs, or -1 if there is none. */
+    int numaNodeOfCpu( int cpu )
+    {
+        char cpuPath[128];
+        snprintf( cpuPath, sizeof(cpuPath), "/sys/devices/system/cpu/cpu%d", cpu );
+
+        DIR* pDir = opendir( cpuPath );
+        if ( pDir == NULL )
+        {
+            return -1;
+        }
+
+        int node = -1;
+        struct dirent* pEntry = NULL;
+        while ( ( pEntry = readdir( pDir ) ) != NULL )
+        {
+            int candidate = 0;
+            if ( sscanf( pEntry->d_name, "node%d", &candidate ) == 1 )
+            {
+                node = candidate;
+                break;
+            }
+        }
+
+        closedir( pDir );
+        return node;
+    }
+
+    double timespecDiffUs( const timespec& later, const timespec& earlier )
+    {
+        return ( later.tv_sec - earlier.tv_sec ) * 1e6 + ( later.tv_nsec - earlier.tv_nsec ) / 1e3;
+    }
+#endif
+}
+
+bool 
+realtime::setCurrentThreadFifoPriority( int priority, std::string& errorMessage )
+{
+#ifdef _WIN32
+    (void)priority;
+    errorMessage = "Realtime scheduling is not supported on this platform";
+    return false;
+#else
+    const int minPriority = sched_get_priority_min( SCHED_FIFO );
+    const int maxPriority = sched_get_priority_max( SCHED_FIFO );
+
+    sched_param param;
+    memset( &param, 0, sizeof(param) );
+    param.sched_priority = std::max( minPriority, std::min( maxPriority, priority ) );
+
+    const int result = pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+    if ( result != 0 )
+    {
+        errorMessage = describeErrno( "pthread_setschedparam(SCHED_FIFO)", result );
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+bool 
+realtime::setCurrentThreadNormalPriority( std::string& errorMessage )
+{
+#ifdef _WIN32
+    errorMessage = "Realtime scheduling is not supported on this platform";
+    return false;
+#else
+    sched_param param;
+    memset( &param, 0, sizeof(param) );
+
+    const int result = pthread_setschedparam( pthread_self(), SCHED_OTHER, &param );
+    if ( result != 0 )
+    {
+        errorMessage = describeErrno( "pthread_setschedparam(SCHED_OTHER)", result );
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+bool 
+realtime::pinCurrentThreadToCpu( int cpu, std::string& errorMessage )
+{
+#ifdef _WIN32
+    (void)cpu;
+    errorMessage = "CPU pinning is not supported on this platform";
+    return false;
+#else
+    const long cpuCount = sysconf( _SC_NPROCESSORS_CONF );
+    if ( cpu >= cpuCount )
+    {
+        std::stringstream message;
+        message << "CPU " << cpu << " does not exist (" << cpuCount << " CPUs configured)";
+        errorMessage = message.str();
+        return false;
+    }
+
+    cpu_set_t cpuSet;
+    CPU_ZERO( &cpuSet );
+    if ( cpu >= 0 )
+    {
+        CPU_SET( cpu, &cpuSet );
+    }
+    else
+    {
+        for ( long i = 0; i < cpuCount && i < CPU_SETSIZE; i++ )
+        {
+            CPU_SET( i, &cpuSet );
+        }
+    }
+
+    const int result = pthread_setaffinity_np( pthread_self(), sizeof(cpuSet), &cpuSet );
+    if ( result != 0 )
+    {
+        errorMessage = describeErrno( "pthread_setaffinity_np", result );
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+bool 
+realtime::preferNumaNodeOfCpu( int cpu, std::string& errorMessage )
+{
+#ifdef _WIN32
+    (void)cpu;
+    errorMessage = "NUMA placement is not supported on this platform";
+    return false;
+#else
+    const int node = numaNodeOfCpu( cpu );
+    if ( node < 0 )
+    {
+        errorMessage = "No NUMA node information for the CPU";
+        return false;
+    }
+
+    // Called through syscall() so that libnuma is not needed
+    unsigned long nodeMask[ 16 ];
+    memset( nodeMask, 0, sizeof(nodeMask) );
+    const unsigned long bitsPerWord = 8 * sizeof(unsigned long);
+    if ( (unsigned long)node >= bitsPerWord * 16 )
+    {
+        errorMessage = "NUMA node number out of range";
+        return false;
+    }
+    nodeMask[ node / bitsPerWord ] |= 1UL << ( node % bitsPerWord );
+
+    if ( syscall( SYS_set_mempolicy, MPOL_PREFERRED, nodeMask, bitsPerWord * 16 ) != 0 )
+    {
+        errorMessage = describeErrno( "set_mempolicy(MPOL_PREFERRED)", errno );
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+bool 
+realtime::lockAllMemory( std::string& errorMessage )
+{
+#ifdef _WIN32
+    errorMessage = "Locking memory is not supported on this platform";
+    return false;
+#else
+    if ( mlockall( MCL_CURRENT | MCL_FUTURE ) != 0 )
+    {
+        errorMessage = describeErrno( "mlockall", errno );
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+realtime::LatencyReport 
+realtime::measureWakeupLatency( unsigned int durationMs, unsigned int periodUs )
+{
+    LatencyReport report;
+    report.samples = 0;
+    report.medianUs = 0.0;
+    report.p99Us = 0.0;
+    report.maxUs = 0.0;
+
+#ifndef _WIN32
+    if ( periodUs == 0 )
+    {
+        periodUs = 1000;
+    }
+
+    const unsigned int sampleCount = (unsigned int)( ( durationMs * 1000ULL ) / periodUs );
+    if ( sampleCount == 0 )
+    {
+        return report;
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve( sampleCount );
+
+    timespec deadline;
+    clock_gettime( CLOCK_MONOTONIC, &deadline );
+
+    for ( unsigned int i = 0; i < sampleCount; i++ )
+    {
+        deadline.tv_nsec += periodUs * 1000L;
+        while ( deadline.tv_nsec >= 1000000000L )
+        {
+            deadline.tv_nsec -= 1000000000L;
+            deadline.tv_sec++;
+        }
+
+        while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL ) == EINTR )
+        {
+        }
+
+        timespec now;
+        clock_gettime( CLOCK_MONOTONIC, &now );
+        latencies.push_back( std::max( 0.0, timespecDiffUs( now, deadline ) ) );
+    }
+
+    std::sort( latencies.begin(), latencies.end() );
+    report.samples = (unsigned int)latencies.size();
+    report.medianUs = latencies[ latencies.size() / 2 ];
+    report.p99Us = latencies[ std::min( latencies.size() - 1, ( latencies.size() * 99 ) / 100 ) ];
+    report.maxUs = latencies.back();
+#else
+    (void)durationMs;
+    (void)periodUs;
+#endif
+
+    return report;
+}
+
+std::string 
+realtime::toString( const LatencyReport& report )
+{
+    if ( report.samples == 0 )
+    {
+        return "no samples";
+    }
+
+    std::stringstream output;
+    output.setf( std::ios::fixed );
+    output.precision( 1 );
+    output << report.samples << " wake-ups, median " << report.medianUs 
+        << "us, p99 " << report.p99Us << "us, max " << report.maxUs << "us";
+    return output.str();
+}
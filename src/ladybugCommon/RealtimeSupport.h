@@ -0,0 +1,78 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __REALTIMESUPPORT_H__
+#define __REALTIMESUPPORT_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string>
+
+/**
+ * Helpers for running an acquisition loop with bounded latency on Linux:
+ * realtime scheduling, CPU pinning, NUMA-local allocation and locked memory.
+ * All functions return false and fill in errorMessage on failure, and are
+ * no-ops that report "not supported" on other platforms.
+ *
+ * Realtime scheduling and locked memory usually need CAP_SYS_NICE and
+ * CAP_IPC_LOCK, or matching rtprio and memlock limits in
+ * /etc/security/limits.conf.
+ */
+namespace realtime
+{
+    /** Switch the calling thread to SCHED_FIFO with a priority of 1-99. */
+    bool setCurrentThreadFifoPriority( int priority, std::string& errorMessage );
+
+    /** Return the calling thread to the default time-sharing policy. */
+    bool setCurrentThreadNormalPriority( std::string& errorMessage );
+
+    /** Restrict the calling thread to one CPU, or to all CPUs if cpu is negative. */
+    bool pinCurrentThreadToCpu( int cpu, std::string& errorMessage );
+
+    /**
+     * Make memory allocated by the calling thread (and threads it creates
+     * afterwards) prefer the NUMA node that the given CPU belongs to.
+     * Call this before the camera allocates its image buffers.
+     */
+    bool preferNumaNodeOfCpu( int cpu, std::string& errorMessage );
+
+    /** Lock all current and future pages of the process into RAM. */
+    bool lockAllMemory( std::string& errorMessage );
+
+    /** Wake-up latency of the calling thread, in microseconds. */
+    struct LatencyReport
+    {
+        unsigned int samples;
+        double medianUs;
+        double p99Us;
+        double maxUs;
+    };
+
+    /**
+     * Measure how late the calling thread wakes up from absolute-deadline
+     * sleeps over durationMs, with one sample every periodUs. Run this after
+     * the scheduling settings have been applied to see the achieved bounds.
+     */
+    LatencyReport measureWakeupLatency( unsigned int durationMs, unsigned int periodUs = 1000 );
+
+    std::string toString( const LatencyReport& report );
+}
+
+#endif // __REALTIMESUPPORT_H__
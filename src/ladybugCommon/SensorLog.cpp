@@ -0,0 +1,818 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <ladybugsensors.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "BinaryFile.h"
+#include "CameraClock.h"
+#include "SensorLog.h"
+#include "StreamSegment.h"
+
+const char* const sensorLog::k_extension = ".sensors";
+
+namespace
+{
+    using binaryFile::computeCrc;
+    using binaryFile::getU32;
+    using binaryFile::getU64;
+    using binaryFile::putU32;
+
+    const char k_headerMagic[4] = { 'L', 'B', 'S', 'L' };
+    const unsigned int k_version = 1;
+    const unsigned int k_headerSize = 4 + 4;
+    const unsigned int k_blockHeaderSize = 4 + 4 + 4 + 4;
+    const unsigned char k_frameBlockType = 255;
+    const unsigned int k_maxBlockCount = 4096;
+
+    // Room for a second of readings at 64 kHz, or for the writer falling
+    // far behind
+    const size_t k_ringCapacity = 1 << 16;
+    const unsigned int k_writeIntervalMs = 20;
+
+    const double k_slowSensorPeriodSeconds = 0.5;
+
+    // Images within this time of a reading give the offset between the 
+    // host and camera clocks. Readings wait for these images, but not
+    // longer than k_maxHoldTicks.
+    const long long k_offsetWindowTicks = (long long)CameraClock::k_ticksPerSecond;
+    const long long k_maxHoldTicks = 5 * (long long)CameraClock::k_ticksPerSecond;
+
+    const LadybugSensorType k_sdkSensors[sensorLog::NUM_SENSORS] = 
+    {
+        TEMPERATURE, HUMIDITY, BAROMETER, COMPASS, ACCELEROMETER, GYROSCOPE
+    };
+
+    const char* const k_sensorNames[sensorLog::NUM_SENSORS] = 
+    {
+        "temperature", "humidity", "barometer", "compass", "accelerometer", "gyroscope"
+    };
+
+    bool isFastSensor( unsigned int sensor )
+    {
+        return sensor >= sensorLog::SENSOR_COMPASS;
+    }
+
+    void appendU32( std::vector<unsigned char>& data, unsigned int value )
+    {
+        unsigned char bytes[4];
+        putU32( bytes, value );
+        data.insert( data.end(), bytes, bytes + 4 );
+    }
+
+    void appendU64( std::vector<unsigned char>& data, unsigned long long value )
+    {
+        appendU32( data, (unsigned int)value );
+        appendU32( data, (unsigned int)( value >> 32 ) );
+    }
+
+    void appendFloat( std::vector<unsigned char>& data, float value )
+    {
+        unsigned int bits = 0;
+        memcpy( &bits, &value, sizeof(bits) );
+        appendU32( data, bits );
+    }
+
+    void appendVarint( std::vector<unsigned char>& data, unsigned long long value )
+    {
+        while ( value >= 0x80 )
+        {
+            data.push_back( (unsigned char)( value | 0x80 ) );
+            value >>= 7;
+        }
+        data.push_back( (unsigned char)value );
+    }
+
+    bool readVarint( const unsigned char*& p, const unsigned char* pEnd, unsigned long long& value )
+    {
+        value = 0;
+        for ( unsigned int shift = 0; p < pEnd && shift < 64; shift += 7 )
+        {
+            const unsigned char byte = *p++;
+            value |= (unsigned long long)( byte & 0x7f ) << shift;
+            if ( ( byte & 0x80 ) == 0 )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isEarlierTick( const SensorSample& sample, unsigned long long tick )
+    {
+        return sample.tick < tick;
+    }
+}
+
+const char* 
+sensorLog::getSensorName( Sensor sensor )
+{
+    return sensor < NUM_SENSORS ? k_sensorNames[sensor] : "unknown";
+}
+
+unsigned int 
+sensorLog::getNumAxes( Sensor sensor )
+{
+    return isFastSensor( sensor ) ? 3 : 1;
+}
+
+std::string 
+sensorLog::getLogPath( const std::string& segmentPath )
+{
+    return streamSegment::getSidecarPath( segmentPath, k_extension );
+}
+
+SensorLogger::SensorLogger() :
+m_context( NULL ),
+m_sensors( 0 ),
+m_rateHz( 0.0 ),
+m_readings( k_ringCapacity ),
+m_clockEvents( k_ringCapacity ),
+m_stopRequested( false ),
+m_pollStopped( false ),
+m_dropped( 0 ),
+m_readErrors( 0 ),
+m_pFile( NULL ),
+m_seconds( 0.0 )
+{
+    memset( m_samples, 0, sizeof(m_samples) );
+}
+
+SensorLogger::~SensorLogger()
+{
+    std::string errorMessage;
+    stop( errorMessage );
+}
+
+bool 
+SensorLogger::start( LadybugContext context, const std::string& logPath, double rateHz, std::string& errorMessage )
+{
+    if ( isRunning() )
+    {
+        errorMessage = "The sensor logger is already running";
+        return false;
+    }
+
+    m_sensors = 0;
+    for ( unsigned int sensor = 0; sensor < sensorLog::NUM_SENSORS; sensor++ )
+    {
+        LadybugSensorInfo info;
+        if ( ladybugGetSensorInfo( context, k_sdkSensors[sensor], &info ) == LADYBUG_OK && info.isSupported )
+        {
+            m_sensors |= 1 << sensor;
+        }
+    }
+
+    if ( m_sensors == 0 )
+    {
+        errorMessage = "The camera has no environmental sensors";
+        return false;
+    }
+
+    m_pFile = fopen( logPath.c_str(), "wb" );
+    if ( m_pFile == NULL )
+    {
+        errorMessage = "Unable to create " + logPath;
+        return false;
+    }
+
+    unsigned char header[k_headerSize];
+    memcpy( header, k_headerMagic, 4 );
+    putU32( header + 4, k_version );
+    if ( fwrite( header, 1, k_headerSize, m_pFile ) != k_headerSize )
+    {
+        fclose( m_pFile );
+        m_pFile = NULL;
+        errorMessage = "Unable to write " + logPath;
+        return false;
+    }
+
+    m_context = context;
+    m_rateHz = rateHz;
+    m_writeError.clear();
+    m_pending.clear();
+    m_anchors.clear();
+    for ( unsigned int sensor = 0; sensor < sensorLog::NUM_SENSORS; sensor++ )
+    {
+        Column& column = m_columns[sensor];
+        column.ticks.clear();
+        for ( unsigned int axis = 0; axis < 3; axis++ )
+        {
+            column.values[axis].clear();
+        }
+        column.lastTick = 0;
+    }
+    m_frames.clear();
+    m_frameTicks.clear();
+    memset( m_samples, 0, sizeof(m_samples) );
+    m_dropped = 0;
+    m_readErrors = 0;
+    m_seconds = 0.0;
+
+    m_startTime = std::chrono::steady_clock::now();
+    m_stopRequested = false;
+    m_pollStopped = false;
+    m_pollThread = std::thread( &SensorLogger::pollLoop, this );
+    m_writeThread = std::thread( &SensorLogger::writeLoop, this );
+    return true;
+}
+
+bool 
+SensorLogger::stop( std::string& errorMessage )
+{
+    errorMessage.clear();
+    if ( !isRunning() )
+    {
+        return true;
+    }
+
+    m_stopRequested = true;
+    m_pollThread.join();
+
+    // The writer drains the rings once more after this
+    m_pollStopped = true;
+    m_writeThread.join();
+
+    m_seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - m_startTime ).count();
+
+    if ( fclose( m_pFile ) != 0 && m_writeError.empty() )
+    {
+        m_writeError = "Unable to write the sensor log";
+    }
+    m_pFile = NULL;
+
+    errorMessage = m_writeError;
+    return m_writeError.empty();
+}
+
+long long 
+SensorLogger::getHostTick() const
+{
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - m_startTime ).count();
+    return (long long)( seconds * CameraClock::k_ticksPerSecond );
+}
+
+void 
+SensorLogger::addImage( unsigned long long tick )
+{
+    ClockEvent event;
+    event.hostTick = getHostTick();
+    event.tick = tick;
+    event.frame = 0;
+    event.isFrame = false;
+    m_clockEvents.push( event );
+}
+
+void 
+SensorLogger::addFrame( unsigned int frame, unsigned long long tick )
+{
+    ClockEvent event;
+    event.hostTick = 0;
+    event.tick = tick;
+    event.frame = frame;
+    event.isFrame = true;
+    m_clockEvents.push( event );
+}
+
+SensorLogger::Statistics 
+SensorLogger::getStatistics() const
+{
+    Statistics statistics;
+    for ( unsigned int sensor = 0; sensor < sensorLog::NUM_SENSORS; sensor++ )
+    {
+        statistics.samples[sensor] = m_samples[sensor];
+    }
+    statistics.dropped = m_dropped;
+    statistics.readErrors = m_readErrors;
+    statistics.seconds = m_seconds;
+    return statistics;
+}
+
+void 
+SensorLogger::pollLoop()
+{
+    const bool hasFastSensors = ( m_sensors & ( ( 1 << sensorLog::SENSOR_COMPASS ) | 
+        ( 1 << sensorLog::SENSOR_ACCELEROMETER ) | ( 1 << sensorLog::SENSOR_GYROSCOPE ) ) ) != 0;
+    const std::chrono::steady_clock::duration slowPeriod = 
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>( 
+            std::chrono::duration<double>( k_slowSensorPeriodSeconds ) );
+    const std::chrono::steady_clock::duration pollPeriod = m_rateHz > 0.0 ? 
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>( 
+            std::chrono::duration<double>( 1.0 / m_rateHz ) ) : 
+        std::chrono::steady_clock::duration::zero();
+
+    std::chrono::steady_clock::time_point nextPoll = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point nextSlowPoll = nextPoll;
+    while ( !m_stopRequested.load( std::memory_order_relaxed ) )
+    {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const bool isSlowPoll = now >= nextSlowPoll;
+        if ( isSlowPoll )
+        {
+            nextSlowPoll = now + slowPeriod;
+        }
+
+        for ( unsigned int sensor = 0; sensor < sensorLog::NUM_SENSORS; sensor++ )
+        {
+            if ( ( m_sensors & ( 1 << sensor ) ) == 0 || ( !isFastSensor( sensor ) && !isSlowPoll ) )
+            {
+                continue;
+            }
+
+            Reading reading;
+            reading.sensor = sensor;
+            reading.x = 0.0f;
+            reading.y = 0.0f;
+            reading.z = 0.0f;
+
+            const long long before = getHostTick();
+            LadybugError error = LADYBUG_OK;
+            if ( isFastSensor( sensor ) )
+            {
+                LadybugTriplet value;
+                error = ladybugGetSensorAxes( m_context, k_sdkSensors[sensor], &value );
+                reading.x = value.x;
+                reading.y = value.y;
+                reading.z = value.z;
+            }
+            else
+            {
+                error = ladybugGetSensor( m_context, k_sdkSensors[sensor], &reading.x );
+            }
+
+            if ( error != LADYBUG_OK )
+            {
+                m_readErrors++;
+                continue;
+            }
+
+            // Taken somewhere during the call
+            reading.hostTick = before + ( getHostTick() - before ) / 2;
+            if ( !m_readings.push( reading ) )
+            {
+                m_dropped++;
+            }
+        }
+
+        if ( !hasFastSensors )
+        {
+            std::this_thread::sleep_until( nextSlowPoll );
+        }
+        else if ( m_rateHz > 0.0 )
+        {
+            nextPoll += pollPeriod;
+            std::this_thread::sleep_until( nextPoll );
+        }
+    }
+}
+
+void 
+SensorLogger::writeLoop()
+{
+    while ( !m_pollStopped.load( std::memory_order_acquire ) )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( k_writeIntervalMs ) );
+        drainRings();
+        convertReadings( false );
+    }
+
+    drainRings();
+    convertReadings( true );
+    for ( unsigned int sensor = 0; sensor < sensorLog::NUM_SENSORS; sensor++ )
+    {
+        flushColumn( sensor );
+    }
+    flushFrames();
+}
+
+void 
+SensorLogger::drainRings()
+{
+    ClockEvent event;
+    while ( m_clockEvents.pop( event ) )
+    {
+        if ( !event.isFrame )
+        {
+            m_anchors.push_back( event );
+            continue;
+        }
+
+        // A block holds increasing frames and ticks only
+        if ( !m_frames.empty() && ( event.frame <= m_frames.back() || event.tick < m_frameTicks.back() ) )
+        {
+            flushFrames();
+        }
+
+        m_frames.push_back( event.frame );
+        m_frameTicks.push_back( event.tick );
+        if ( m_frames.size() >= k_maxBlockCount )
+        {
+            flushFrames();
+        }
+    }
+
+    Reading reading;
+    while ( m_readings.pop( reading ) )
+    {
+        m_pending.push_back( reading );
+    }
+}
+
+void 
+SensorLogger::convertReadings( bool isFinal )
+{
+    while ( !m_pending.empty() )
+    {
+        const Reading& reading = m_pending.front();
+
+        // Wait for the images around the reading
+        const bool isHeld = !isFinal && 
+            m_pending.back().hostTick - reading.hostTick < k_maxHoldTicks &&
+            ( m_anchors.empty() || m_anchors.back().hostTick < reading.hostTick + k_offsetWindowTicks );
+        if ( isHeld )
+        {
+            break;
+        }
+
+        // Host minus camera time. The image that arrived with the least
+        // delay gives the smallest difference.
+        long long offset = 0;
+        if ( !m_anchors.empty() )
+        {
+            bool hasOffset = false;
+            for ( size_t i = 0; i < m_anchors.size(); i++ )
+            {
+                const ClockEvent& anchor = m_anchors[i];
+                if ( anchor.hostTick < reading.hostTick - k_offsetWindowTicks || 
+                    anchor.hostTick > reading.hostTick + k_offsetWindowTicks )
+                {
+                    continue;
+                }
+
+                const long long anchorOffset = anchor.hostTick - (long long)anchor.tick;
+                if ( !hasOffset || anchorOffset < offset )
+                {
+                    offset = anchorOffset;
+                    hasOffset = true;
+                }
+            }
+
+            if ( !hasOffset )
+            {
+                const ClockEvent& nearest = 
+                    reading.hostTick < m_anchors.front().hostTick ? m_anchors.front() : m_anchors.back();
+                offset = nearest.hostTick - (long long)nearest.tick;
+            }
+        }
+
+        Column& column = m_columns[reading.sensor];
+        const unsigned long long tick = std::max( (unsigned long long)( reading.hostTick - offset ), column.lastTick );
+        column.lastTick = tick;
+        column.ticks.push_back( tick );
+        column.values[0].push_back( reading.x );
+        column.values[1].push_back( reading.y );
+        column.values[2].push_back( reading.z );
+        m_samples[reading.sensor]++;
+        if ( column.ticks.size() >= k_maxBlockCount )
+        {
+            flushColumn( reading.sensor );
+        }
+
+        m_pending.pop_front();
+    }
+
+    // Keep the images that later readings may still need, and at least 
+    // the last one
+    const long long oldestNeeded = 
+        ( m_pending.empty() ? getHostTick() : m_pending.front().hostTick ) - k_offsetWindowTicks;
+    while ( m_anchors.size() > 1 && m_anchors.front().hostTick < oldestNeeded )
+    {
+        m_anchors.pop_front();
+    }
+}
+
+bool 
+SensorLogger::flushColumn( unsigned int sensor )
+{
+    Column& column = m_columns[sensor];
+    const unsigned int count = (unsigned int)column.ticks.size();
+    if ( count == 0 )
+    {
+        return true;
+    }
+
+    const unsigned int numAxes = sensorLog::getNumAxes( (sensorLog::Sensor)sensor );
+    std::vector<unsigned char> payload;
+    payload.reserve( 8 + count * ( 3 + 4 * numAxes ) );
+    appendU64( payload, column.ticks[0] );
+    for ( unsigned int i = 1; i < count; i++ )
+    {
+        appendVarint( payload, column.ticks[i] - column.ticks[i - 1] );
+    }
+    for ( unsigned int axis = 0; axis < numAxes; axis++ )
+    {
+        for ( unsigned int i = 0; i < count; i++ )
+        {
+            appendFloat( payload, column.values[axis][i] );
+        }
+    }
+
+    column.ticks.clear();
+    for ( unsigned int axis = 0; axis < 3; axis++ )
+    {
+        column.values[axis].clear();
+    }
+
+    return writeBlock( (unsigned char)sensor, count, payload );
+}
+
+bool 
+SensorLogger::flushFrames()
+{
+    const unsigned int count = (unsigned int)m_frames.size();
+    if ( count == 0 )
+    {
+        return true;
+    }
+
+    std::vector<unsigned char> payload;
+    payload.reserve( 12 + count * 6 );
+    appendU32( payload, m_frames[0] );
+    appendU64( payload, m_frameTicks[0] );
+    for ( unsigned int i = 1; i < count; i++ )
+    {
+        appendVarint( payload, m_frames[i] - m_frames[i - 1] );
+    }
+    for ( unsigned int i = 1; i < count; i++ )
+    {
+        appendVarint( payload, m_frameTicks[i] - m_frameTicks[i - 1] );
+    }
+
+    m_frames.clear();
+    m_frameTicks.clear();
+
+    return writeBlock( k_frameBlockType, count, payload );
+}
+
+bool 
+SensorLogger::writeBlock( unsigned char type, unsigned int count, const std::vector<unsigned char>& payload )
+{
+    if ( !m_writeError.empty() )
+    {
+        return false;
+    }
+
+    unsigned char header[k_blockHeaderSize] = { 0 };
+    header[0] = type;
+    putU32( header + 4, count );
+    putU32( header + 8, (unsigned int)payload.size() );
+    putU32( header + 12, computeCrc( payload.data(), payload.size() ) );
+
+    // Flushed block by block, so that a crash loses little of the log
+    if ( fwrite( header, 1, k_blockHeaderSize, m_pFile ) != k_blockHeaderSize || 
+        fwrite( payload.data(), 1, payload.size(), m_pFile ) != payload.size() || 
+        fflush( m_pFile ) != 0 )
+    {
+        m_writeError = "Unable to write the sensor log";
+        return false;
+    }
+    return true;
+}
+
+SensorLogReader::SensorLogReader() :
+m_isOpen( false )
+{
+}
+
+bool 
+SensorLogReader::openForStream( const std::string& segmentPath, std::string& errorMessage )
+{
+    errorMessage.clear();
+    const std::string logPath = sensorLog::getLogPath( segmentPath );
+    if ( !streamSegment::exists( logPath ) )
+    {
+        return false;
+    }
+    return open( logPath, errorMessage );
+}
+
+bool 
+SensorLogReader::open( const std::string& logPath, std::string& errorMessage )
+{
+    m_isOpen = false;
+    for ( unsigned int sensor = 0; sensor < sensorLog::NUM_SENSORS; sensor++ )
+    {
+        m_samples[sensor].clear();
+    }
+    m_frames.clear();
+
+    FILE* pFile = fopen( logPath.c_str(), "rb" );
+    if ( pFile == NULL )
+    {
+        errorMessage = "Unable to open " + logPath;
+        return false;
+    }
+
+    std::vector<unsigned char> data;
+    unsigned char buffer[65536];
+    size_t bytesRead = 0;
+    while ( ( bytesRead = fread( buffer, 1, sizeof(buffer), pFile ) ) > 0 )
+    {
+        data.insert( data.end(), buffer, buffer + bytesRead );
+    }
+    fclose( pFile );
+
+    if ( data.size() < k_headerSize || memcmp( &data[0], k_headerMagic, 4 ) != 0 )
+    {
+        errorMessage = logPath + " is not a sensor log";
+        return false;
+    }
+
+    if ( getU32( &data[4] ) < k_version )
+    {
+        errorMessage = logPath + " has an unsupported version";
+        return false;
+    }
+
+    // Stop at the first block that is incomplete or damaged
+    size_t offset = k_headerSize;
+    while ( offset + k_blockHeaderSize <= data.size() )
+    {
+        const unsigned char* pHeader = &data[offset];
+        const unsigned int type = pHeader[0];
+        const unsigned int count = getU32( pHeader + 4 );
+        const unsigned int payloadSize = getU32( pHeader + 8 );
+        if ( payloadSize > data.size() - offset - k_blockHeaderSize || count == 0 || 
+            computeCrc( pHeader + k_blockHeaderSize, payloadSize ) != getU32( pHeader + 12 ) )
+        {
+            break;
+        }
+
+        const unsigned char* p = pHeader + k_blockHeaderSize;
+        const unsigned char* pEnd = p + payloadSize;
+        offset += k_blockHeaderSize + payloadSize;
+
+        if ( type == k_frameBlockType )
+        {
+            if ( payloadSize < 12 )
+            {
+                break;
+            }
+
+            std::vector<FrameTick> frames( count );
+            frames[0].frame = getU32( p );
+            frames[0].tick = getU64( p + 4 );
+            p += 12;
+
+            bool isValid = true;
+            unsigned long long increment = 0;
+            for ( unsigned int i = 1; i < count && isValid; i++ )
+            {
+                isValid = readVarint( p, pEnd, increment );
+                frames[i].frame = frames[i - 1].frame + (unsigned int)increment;
+            }
+            for ( unsigned int i = 1; i < count && isValid; i++ )
+            {
+                isValid = readVarint( p, pEnd, increment );
+                frames[i].tick = frames[i - 1].tick + increment;
+            }
+            if ( !isValid )
+            {
+                break;
+            }
+
+            m_frames.insert( m_frames.end(), frames.begin(), frames.end() );
+            continue;
+        }
+
+        if ( type >= sensorLog::NUM_SENSORS || payloadSize < 8 )
+        {
+            continue;
+        }
+
+        std::vector<SensorSample> samples( count );
+        memset( &samples[0], 0, count * sizeof(SensorSample) );
+        samples[0].tick = getU64( p );
+        p += 8;
+
+        bool isValid = true;
+        unsigned long long increment = 0;
+        for ( unsigned int i = 1; i < count && isValid; i++ )
+        {
+            isValid = readVarint( p, pEnd, increment );
+            samples[i].tick = samples[i - 1].tick + increment;
+        }
+
+        const unsigned int numAxes = sensorLog::getNumAxes( (sensorLog::Sensor)type );
+        if ( !isValid || (size_t)( pEnd - p ) < (size_t)count * 4 * numAxes )
+        {
+            break;
+        }
+
+        for ( unsigned int axis = 0; axis < numAxes; axis++ )
+        {
+            for ( unsigned int i = 0; i < count; i++, p += 4 )
+            {
+                const unsigned int bits = getU32( p );
+                float value = 0.0f;
+                memcpy( &value, &bits, sizeof(value) );
+                ( axis == 0 ? samples[i].x : axis == 1 ? samples[i].y : samples[i].z ) = value;
+            }
+        }
+
+        m_samples[type].insert( m_samples[type].end(), samples.begin(), samples.end() );
+    }
+
+    m_isOpen = true;
+    return true;
+}
+
+bool 
+SensorLogReader::getFrameTick( unsigned int frame, unsigned long long& tick ) const
+{
+    size_t first = 0;
+    size_t last = m_frames.size();
+    while ( first < last )
+    {
+        const size_t middle = first + ( last - first ) / 2;
+        if ( m_frames[middle].frame < frame )
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+
+    if ( first == m_frames.size() || m_frames[first].frame != frame )
+    {
+        return false;
+    }
+
+    tick = m_frames[first].tick;
+    return true;
+}
+
+void 
+SensorLogReader::getWindow( sensorLog::Sensor sensor, unsigned long long startTick, unsigned long long endTick, std::vector<SensorSample>& samples ) const
+{
+    const std::vector<SensorSample>& all = m_samples[sensor];
+    const std::vector<SensorSample>::const_iterator first = 
+        std::lower_bound( all.begin(), all.end(), startTick, isEarlierTick );
+    const std::vector<SensorSample>::const_iterator last = 
+        std::lower_bound( first, all.end(), endTick, isEarlierTick );
+    samples.assign( first, last );
+}
+
+bool 
+SensorLogReader::getFrameWindow( unsigned int frame, sensorLog::Sensor sensor, std::vector<SensorSample>& samples ) const
+{
+    samples.clear();
+
+    unsigned long long startTick = 0;
+    if ( !getFrameTick( frame, startTick ) )
+    {
+        return false;
+    }
+
+    unsigned long long endTick = ULLONG_MAX;
+    unsigned long long otherTick = 0;
+    if ( getFrameTick( frame + 1, otherTick ) && otherTick > startTick )
+    {
+        endTick = otherTick;
+    }
+    else if ( frame > 0 && getFrameTick( frame - 1, otherTick ) && otherTick < startTick )
+    {
+        endTick = startTick + ( startTick - otherTick );
+    }
+
+    getWindow( sensor, startTick, endTick, samples );
+    return true;
+}
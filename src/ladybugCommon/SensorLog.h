@@ -0,0 +1,263 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __SENSORLOG_H__
+#define __SENSORLOG_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ladybug.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "SpscRing.h"
+
+/** One reading of a sensor. Sensors with a single value only use x. */
+struct SensorSample
+{
+    /** Camera cycle time, unwrapped as by CameraClock. */
+    unsigned long long tick;
+    float x;
+    float y;
+    float z;
+};
+
+/**
+ * A sensor log (name.sensors next to name-000000.pgr) holds the readings
+ * of the environmental sensors of the camera during a recording, and the
+ * camera time of each frame of the stream, so that the readings during 
+ * any frame can be looked up.
+ *
+ * After a header, "LBSL" and version (4), the log is a sequence of blocks
+ * of up to 4096 readings of one sensor, or of frames. Each block has a 
+ * header: type (1, the sensor or 255 for frames), 3 reserved bytes, count
+ * (4), payload size (4) and CRC-32 of the payload (4). The payload stores
+ * each field as a column:
+ *
+ *   sensor  first tick (8), tick increments (varint), then the x, y and z
+ *           columns (4 bytes per value, only x for single value sensors)
+ *   frames  first frame (4), first tick (8), frame increments (varint),
+ *           tick increments (varint)
+ *
+ * Integers are little endian, values IEEE floats, varints LEB128. A log
+ * cut short by a crash is read up to its last complete block.
+ */
+namespace sensorLog
+{
+    enum Sensor
+    {
+        SENSOR_TEMPERATURE,
+        SENSOR_HUMIDITY,
+        SENSOR_BAROMETER,
+        SENSOR_COMPASS,
+        SENSOR_ACCELEROMETER,
+        SENSOR_GYROSCOPE,
+        NUM_SENSORS
+    };
+
+    const char* getSensorName( Sensor sensor );
+
+    /** 3 for the compass, accelerometer and gyroscope, 1 otherwise. */
+    unsigned int getNumAxes( Sensor sensor );
+
+    /** Log files are recognized by this extension, ".sensors". */
+    extern const char* const k_extension;
+
+    /** Log file that belongs to a stream segment. */
+    std::string getLogPath( const std::string& segmentPath );
+}
+
+/**
+ * Polls the environmental sensors of a camera on a background thread and
+ * writes them to a sensor log.
+ *
+ * The accelerometer, gyroscope and compass are read as fast as the camera
+ * answers, or at the given rate; temperature, humidity and pressure change
+ * slowly and are read twice a second. Readings go through a lock-free ring
+ * to a writer thread, so neither the polling nor the grab thread ever 
+ * waits on the disk.
+ *
+ * Readings are taken on the host clock. The grab thread reports the camera
+ * time of each image as it arrives; the difference between the two clocks
+ * is the smallest one seen within a second of a reading, i.e. that of the
+ * image that arrived with the least delay, and converts the reading to 
+ * camera time. Without any image, the log counts camera ticks from its 
+ * start on the host clock.
+ */
+class SensorLogger
+{
+public:
+    struct Statistics
+    {
+        unsigned long long samples[sensorLog::NUM_SENSORS];
+
+        /** Readings lost to a full ring or a failed read. */
+        unsigned long long dropped;
+        unsigned long long readErrors;
+
+        double seconds;
+    };
+
+    SensorLogger();
+    ~SensorLogger();
+
+    /** rateHz of 0 polls as fast as the camera answers. */
+    bool start( LadybugContext context, const std::string& logPath, double rateHz, std::string& errorMessage );
+
+    /** Stop polling and write the rest of the log. */
+    bool stop( std::string& errorMessage );
+
+    bool isRunning() const { return m_pollThread.joinable(); }
+
+    /** Bit ( 1 << sensor ) is set for each sensor the camera has. */
+    unsigned int getSensors() const { return m_sensors; }
+
+    /** Grab thread only: camera time of an image, as soon as it arrives. */
+    void addImage( unsigned long long tick );
+
+    /** Grab thread only: camera time of a frame written to the stream. */
+    void addFrame( unsigned int frame, unsigned long long tick );
+
+    Statistics getStatistics() const;
+
+private:
+    SensorLogger( const SensorLogger& );
+    SensorLogger& operator=( const SensorLogger& );
+
+    struct Reading
+    {
+        long long hostTick;
+        unsigned int sensor;
+        float x;
+        float y;
+        float z;
+    };
+
+    struct ClockEvent
+    {
+        long long hostTick;
+        unsigned long long tick;
+        unsigned int frame;
+        bool isFrame;
+    };
+
+    struct Column
+    {
+        std::vector<unsigned long long> ticks;
+        std::vector<float> values[3];
+        unsigned long long lastTick;
+    };
+
+    long long getHostTick() const;
+
+    void pollLoop();
+    void writeLoop();
+
+    void drainRings();
+    void convertReadings( bool isFinal );
+    bool flushColumn( unsigned int sensor );
+    bool flushFrames();
+    bool writeBlock( unsigned char type, unsigned int count, const std::vector<unsigned char>& payload );
+
+    LadybugContext m_context;
+    unsigned int m_sensors;
+    double m_rateHz;
+    std::chrono::steady_clock::time_point m_startTime;
+
+    SpscRing<Reading> m_readings;
+    SpscRing<ClockEvent> m_clockEvents;
+    std::atomic<bool> m_stopRequested;
+    std::atomic<bool> m_pollStopped;
+    std::thread m_pollThread;
+    std::thread m_writeThread;
+
+    // Poll thread
+    std::atomic<unsigned long long> m_dropped;
+    std::atomic<unsigned long long> m_readErrors;
+
+    // Writer thread
+    FILE* m_pFile;
+    std::string m_writeError;
+    std::deque<Reading> m_pending;
+    std::deque<ClockEvent> m_anchors;
+    Column m_columns[sensorLog::NUM_SENSORS];
+    std::vector<unsigned int> m_frames;
+    std::vector<unsigned long long> m_frameTicks;
+    unsigned long long m_samples[sensorLog::NUM_SENSORS];
+    double m_seconds;
+};
+
+/**
+ * The readings of a sensor log, looked up by frame or camera time.
+ */
+class SensorLogReader
+{
+public:
+    SensorLogReader();
+
+    /** 
+     * Load the log of the stream whose first segment is segmentPath.
+     * Returns false with an empty errorMessage if the stream has no log.
+     */
+    bool openForStream( const std::string& segmentPath, std::string& errorMessage );
+
+    bool open( const std::string& logPath, std::string& errorMessage );
+
+    bool isOpen() const { return m_isOpen; }
+
+    /** All readings of a sensor in time order. */
+    const std::vector<SensorSample>& getSamples( sensorLog::Sensor sensor ) const { return m_samples[sensor]; }
+
+    unsigned int getNumFrames() const { return (unsigned int)m_frames.size(); }
+
+    /** Camera time of a frame; false if the log has no such frame. */
+    bool getFrameTick( unsigned int frame, unsigned long long& tick ) const;
+
+    /** Readings with startTick <= tick < endTick. */
+    void getWindow( sensorLog::Sensor sensor, unsigned long long startTick, unsigned long long endTick, std::vector<SensorSample>& samples ) const;
+
+    /** 
+     * Readings from the time of a frame up to the time of the next frame.
+     * The last frame lasts as long as the one before it.
+     */
+    bool getFrameWindow( unsigned int frame, sensorLog::Sensor sensor, std::vector<SensorSample>& samples ) const;
+
+private:
+    struct FrameTick
+    {
+        unsigned int frame;
+        unsigned long long tick;
+    };
+
+    bool m_isOpen;
+    std::vector<SensorSample> m_samples[sensorLog::NUM_SENSORS];
+    std::vector<FrameTick> m_frames;
+};
+
+#endif // __SENSORLOG_H__
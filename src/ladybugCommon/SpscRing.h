@@ -0,0 +1,97 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __SPSCRING_H__
+#define __SPSCRING_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Fixed size queue between exactly one producer thread and one consumer
+ * thread, without locks. The producer never waits: push() fails when the
+ * ring is full, so a slow consumer costs data rather than stalling the 
+ * producer.
+ */
+template <typename T>
+class SpscRing
+{
+public:
+    /** The capacity is rounded up to a power of two. */
+    explicit SpscRing( size_t capacity ) :
+    m_head( 0 ),
+    m_tail( 0 )
+    {
+        size_t size = 2;
+        while ( size < capacity )
+        {
+            size *= 2;
+        }
+        m_items.resize( size );
+        m_mask = size - 1;
+    }
+
+    size_t getCapacity() const { return m_items.size(); }
+
+    /** Producer only. */
+    bool push( const T& item )
+    {
+        const size_t head = m_head.load( std::memory_order_relaxed );
+        if ( head - m_tail.load( std::memory_order_acquire ) >= m_items.size() )
+        {
+            return false;
+        }
+
+        m_items[head & m_mask] = item;
+        m_head.store( head + 1, std::memory_order_release );
+        return true;
+    }
+
+    /** Consumer only. */
+    bool pop( T& item )
+    {
+        const size_t tail = m_tail.load( std::memory_order_relaxed );
+        if ( tail == m_head.load( std::memory_order_acquire ) )
+        {
+            return false;
+        }
+
+        item = m_items[tail & m_mask];
+        m_tail.store( tail + 1, std::memory_order_release );
+        return true;
+    }
+
+private:
+    SpscRing( const SpscRing& );
+    SpscRing& operator=( const SpscRing& );
+
+    std::vector<T> m_items;
+    size_t m_mask;
+
+    // On separate cache lines, so that the two threads do not keep taking
+    // the line from each other
+    alignas( 64 ) std::atomic<size_t> m_head;
+    alignas( 64 ) std::atomic<size_t> m_tail;
+};
+
+#endif // __SPSCRING_H__
@@ -0,0 +1,387 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "BinaryFile.h"
+#include "StreamJournal.h"
+#include "StreamSegment.h"
+
+namespace
+{
+    const char* const k_journalHeader = "# Ladybug stream journal";
+
+    std::string describeErrno( const std::string& what, int errorNumber )
+    {
+        return what + ": " + strerror( errorNumber );
+    }
+}
+
+StreamJournal::StreamJournal() :
+m_segmentIndex( 0 ),
+m_intervalSeconds( 0.0 ),
+m_fd( -1 ),
+m_isOpen( false ),
+m_hasRequest( false ),
+m_requestedImages( 0 ),
+m_stopRequested( false )
+{
+}
+
+StreamJournal::~StreamJournal()
+{
+    stopSyncThread();
+
+#ifndef _WIN32
+    if ( m_fd >= 0 )
+    {
+        ::close( m_fd );
+    }
+#endif
+}
+
+std::string 
+StreamJournal::getJournalPath( const std::string& segmentPath )
+{
+    return streamSegment::getSidecarPath( segmentPath, ".journal" );
+}
+
+bool 
+StreamJournal::open( const std::string& firstSegmentPath, double intervalSeconds, std::string& errorMessage )
+{
+#ifdef _WIN32
+    (void)firstSegmentPath;
+    (void)intervalSeconds;
+    errorMessage = "not supported on this platform";
+    return false;
+#else
+    // A stream that was abandoned without close() keeps its last checkpoint
+    stopSyncThread();
+    m_isOpen = false;
+    if ( m_fd >= 0 )
+    {
+        ::close( m_fd );
+        m_fd = -1;
+    }
+
+    if ( !streamSegment::splitPath( firstSegmentPath, m_segmentPrefix, m_segmentIndex ) )
+    {
+        errorMessage = "unexpected stream file name " + firstSegmentPath;
+        return false;
+    }
+
+    // Keep the current segment open so that its size can be read cheaply
+    m_fd = ::open( firstSegmentPath.c_str(), O_RDONLY );
+    if ( m_fd < 0 )
+    {
+        errorMessage = describeErrno( firstSegmentPath, errno );
+        return false;
+    }
+
+    m_journalPath = getJournalPath( firstSegmentPath );
+    m_intervalSeconds = intervalSeconds;
+    m_lastCheckpoint = std::chrono::steady_clock::now();
+
+    if ( !checkpoint( 0, errorMessage ) )
+    {
+        return false;
+    }
+
+    m_isOpen = true;
+    m_hasRequest = false;
+    m_stopRequested = false;
+    m_syncError.clear();
+    m_syncThread = std::thread( &StreamJournal::syncLoop, this );
+    return true;
+#endif
+}
+
+bool 
+StreamJournal::update( unsigned long imagesWritten, std::string& errorMessage )
+{
+    if ( !m_isOpen )
+    {
+        return true;
+    }
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if ( std::chrono::duration<double>( now - m_lastCheckpoint ).count() < m_intervalSeconds )
+    {
+        return true;
+    }
+
+    m_lastCheckpoint = now;
+
+    // The sync thread only holds the lock to take the request, never 
+    // while it flushes
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_requestedImages = imagesWritten;
+    m_hasRequest = true;
+    m_condition.notify_one();
+
+    if ( !m_syncError.empty() )
+    {
+        errorMessage = m_syncError;
+        m_syncError.clear();
+        return false;
+    }
+    return true;
+}
+
+void 
+StreamJournal::syncLoop()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while ( true )
+    {
+        m_condition.wait( lock, [this]() { return m_hasRequest || m_stopRequested; } );
+        if ( m_stopRequested )
+        {
+            return;
+        }
+
+        // A request that arrives while this one is flushed replaces it
+        const unsigned long imagesWritten = m_requestedImages;
+        m_hasRequest = false;
+        lock.unlock();
+
+        std::string errorMessage;
+        const bool isCheckpointed = checkpoint( imagesWritten, errorMessage );
+
+        lock.lock();
+        if ( !isCheckpointed )
+        {
+            m_syncError = errorMessage;
+        }
+    }
+}
+
+void 
+StreamJournal::stopSyncThread()
+{
+    if ( !m_syncThread.joinable() )
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stopRequested = true;
+    }
+    m_condition.notify_one();
+    m_syncThread.join();
+}
+
+bool 
+StreamJournal::checkpoint( unsigned long imagesWritten, std::string& errorMessage )
+{
+#ifdef _WIN32
+    (void)imagesWritten;
+    errorMessage = "not supported on this platform";
+    return false;
+#else
+    if ( m_fd < 0 )
+    {
+        errorMessage = "journal is not open";
+        return false;
+    }
+
+    // Finish the segments the SDK has moved on from
+    while ( streamSegment::exists( streamSegment::makePath( m_segmentPrefix, m_segmentIndex + 1 ) ) )
+    {
+        if ( fdatasync( m_fd ) != 0 )
+        {
+            errorMessage = describeErrno( "fdatasync", errno );
+            return false;
+        }
+
+        const std::string nextPath = streamSegment::makePath( m_segmentPrefix, m_segmentIndex + 1 );
+        const int nextFd = ::open( nextPath.c_str(), O_RDONLY );
+        if ( nextFd < 0 )
+        {
+            errorMessage = describeErrno( nextPath, errno );
+            return false;
+        }
+
+        ::close( m_fd );
+        m_fd = nextFd;
+        m_segmentIndex++;
+    }
+
+    // Whatever is in the file when the size is taken is on disk after the sync
+    struct stat fileStatus;
+    if ( fstat( m_fd, &fileStatus ) != 0 )
+    {
+        errorMessage = describeErrno( "fstat", errno );
+        return false;
+    }
+
+    if ( fdatasync( m_fd ) != 0 )
+    {
+        errorMessage = describeErrno( "fdatasync", errno );
+        return false;
+    }
+
+    Checkpoint current;
+    current.segmentPath = streamSegment::makePath( m_segmentPrefix, m_segmentIndex );
+    current.durableBytes = (unsigned long long)fileStatus.st_size;
+    current.imagesWritten = imagesWritten;
+    current.isComplete = false;
+
+    return write( current, errorMessage );
+#endif
+}
+
+bool 
+StreamJournal::close( unsigned long imagesWritten, std::string& errorMessage )
+{
+#ifdef _WIN32
+    (void)imagesWritten;
+    errorMessage = "not supported on this platform";
+    return false;
+#else
+    if ( !m_isOpen )
+    {
+        return true;
+    }
+
+    // The stream has stopped, so the final checkpoint can wait for the disk
+    stopSyncThread();
+
+    bool isClosed = checkpoint( imagesWritten, errorMessage );
+    if ( isClosed )
+    {
+        // The SDK has written the final headers; nothing needs recovering
+        Checkpoint final;
+        final.segmentPath = streamSegment::makePath( m_segmentPrefix, m_segmentIndex );
+        final.imagesWritten = imagesWritten;
+        final.isComplete = true;
+
+        struct stat fileStatus;
+        if ( fstat( m_fd, &fileStatus ) == 0 )
+        {
+            final.durableBytes = (unsigned long long)fileStatus.st_size;
+        }
+
+        isClosed = write( final, errorMessage );
+    }
+
+    ::close( m_fd );
+    m_fd = -1;
+    m_isOpen = false;
+
+    return isClosed;
+#endif
+}
+
+bool 
+StreamJournal::write( const Checkpoint& checkpoint, std::string& errorMessage )
+{
+#ifdef _WIN32
+    (void)checkpoint;
+    errorMessage = "not supported on this platform";
+    return false;
+#else
+    std::stringstream contents;
+    contents << k_journalHeader << "\n"
+        << "segment=" << checkpoint.segmentPath << "\n"
+        << "durableBytes=" << checkpoint.durableBytes << "\n"
+        << "imagesWritten=" << checkpoint.imagesWritten << "\n"
+        << "complete=" << ( checkpoint.isComplete ? 1 : 0 ) << "\n";
+    const std::string text = contents.str();
+
+    // A crash leaves either the previous or the new checkpoint
+    return binaryFile::writeAtomically( m_journalPath, text.data(), text.size(), true, errorMessage );
+#endif
+}
+
+bool 
+StreamJournal::read( const std::string& journalPath, Checkpoint& checkpoint, std::string& errorMessage )
+{
+    std::ifstream file( journalPath.c_str() );
+    if ( !file.is_open() )
+    {
+        errorMessage = "unable to open " + journalPath;
+        return false;
+    }
+
+    std::string line;
+    if ( !std::getline( file, line ) || line != k_journalHeader )
+    {
+        errorMessage = journalPath + " is not a stream journal";
+        return false;
+    }
+
+    bool hasSegment = false;
+    while ( std::getline( file, line ) )
+    {
+        const size_t separator = line.find( '=' );
+        if ( separator == std::string::npos )
+        {
+            continue;
+        }
+
+        const std::string key = line.substr( 0, separator );
+        const std::string value = line.substr( separator + 1 );
+
+        if ( key == "segment" )
+        {
+            checkpoint.segmentPath = value;
+            hasSegment = true;
+        }
+        else if ( key == "durableBytes" )
+        {
+            checkpoint.durableBytes = strtoull( value.c_str(), NULL, 10 );
+        }
+        else if ( key == "imagesWritten" )
+        {
+            checkpoint.imagesWritten = strtoul( value.c_str(), NULL, 10 );
+        }
+        else if ( key == "complete" )
+        {
+            checkpoint.isComplete = value == "1";
+        }
+    }
+
+    if ( !hasSegment )
+    {
+        errorMessage = journalPath + " has no segment entry";
+        return false;
+    }
+
+    return true;
+}
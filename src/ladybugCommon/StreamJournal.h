@@ -0,0 +1,113 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __STREAMJOURNAL_H__
+#define __STREAMJOURNAL_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Periodic durable checkpoints of a stream that is being recorded.
+ *
+ * At each checkpoint the segments finished since the previous checkpoint
+ * and the segment being written are flushed with fdatasync(). Then a small
+ * journal (name.journal next to name-000000.pgr) is replaced atomically.
+ * After a power loss, the journal gives the segment that was being
+ * written, how many of its bytes are known to be on disk and how many
+ * images had been written by then. ladybugStreamRecover uses this to
+ * repair the stream without scanning it.
+ *
+ * The flushes and the journal write run on a thread of their own, so that
+ * update() never waits for the disk on the write path.
+ *
+ * Linux only; open() fails on other platforms.
+ */
+class StreamJournal
+{
+public:
+    struct Checkpoint
+    {
+        std::string segmentPath;
+        unsigned long long durableBytes;
+        unsigned long imagesWritten;
+        bool isComplete;
+
+        Checkpoint() : durableBytes( 0 ), imagesWritten( 0 ), isComplete( false ) {}
+    };
+
+    StreamJournal();
+    ~StreamJournal();
+
+    /** Start journaling the stream whose first segment is firstSegmentPath. */
+    bool open( const std::string& firstSegmentPath, double intervalSeconds, std::string& errorMessage );
+
+    bool isOpen() const { return m_isOpen; }
+
+    /** 
+     * Call after each write. Once the interval has elapsed, hands a 
+     * checkpoint to the sync thread without waiting for it. Returns false
+     * if an earlier checkpoint failed.
+     */
+    bool update( unsigned long imagesWritten, std::string& errorMessage );
+
+    /** Call after the stream has been stopped; marks the stream as complete. */
+    bool close( unsigned long imagesWritten, std::string& errorMessage );
+
+    /** Journal file that belongs to a stream segment. */
+    static std::string getJournalPath( const std::string& segmentPath );
+
+    static bool read( const std::string& journalPath, Checkpoint& checkpoint, std::string& errorMessage );
+
+private:
+    StreamJournal( const StreamJournal& );
+    StreamJournal& operator=( const StreamJournal& );
+
+    bool checkpoint( unsigned long imagesWritten, std::string& errorMessage );
+    bool write( const Checkpoint& checkpoint, std::string& errorMessage );
+
+    void syncLoop();
+    void stopSyncThread();
+
+    std::string m_segmentPrefix;
+    unsigned int m_segmentIndex;
+    std::string m_journalPath;
+    double m_intervalSeconds;
+    std::chrono::steady_clock::time_point m_lastCheckpoint;
+
+    // The segment being written; only the sync thread uses it while it runs
+    int m_fd;
+    bool m_isOpen;
+
+    std::thread m_syncThread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_hasRequest;
+    unsigned long m_requestedImages;
+    bool m_stopRequested;
+    std::string m_syncError;
+};
+
+#endif // __STREAMJOURNAL_H__
@@ -0,0 +1,95 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/stat.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "StreamSegment.h"
+
+namespace
+{
+    const char* const k_segmentExtension = ".pgr";
+    const size_t k_segmentDigits = 6;
+}
+
+bool 
+streamSegment::splitPath( const std::string& segmentPath, std::string& prefix, unsigned int& index )
+{
+    const size_t extensionLength = strlen( k_segmentExtension );
+    const size_t suffixLength = k_segmentDigits + extensionLength;
+    if ( segmentPath.size() <= suffixLength ||
+        segmentPath.compare( segmentPath.size() - extensionLength, std::string::npos, k_segmentExtension ) != 0 )
+    {
+        return false;
+    }
+
+    const std::string digits = segmentPath.substr( segmentPath.size() - suffixLength, k_segmentDigits );
+    if ( digits.find_first_not_of( "0123456789" ) != std::string::npos )
+    {
+        return false;
+    }
+
+    prefix = segmentPath.substr( 0, segmentPath.size() - suffixLength );
+    index = (unsigned int)strtoul( digits.c_str(), NULL, 10 );
+    return true;
+}
+
+std::string 
+streamSegment::makePath( const std::string& prefix, unsigned int index )
+{
+    char suffix[32];
+    sprintf( suffix, "%06u%s", index, k_segmentExtension );
+    return prefix + suffix;
+}
+
+bool 
+streamSegment::exists( const std::string& segmentPath )
+{
+    struct stat fileStatus;
+    return stat( segmentPath.c_str(), &fileStatus ) == 0;
+}
+
+std::string 
+streamSegment::getSidecarPath( const std::string& segmentPath, const std::string& extension )
+{
+    std::string prefix;
+    unsigned int index = 0;
+    if ( !splitPath( segmentPath, prefix, index ) )
+    {
+        return segmentPath + extension;
+    }
+
+    // Drop the dash that separates the prefix from the segment number
+    if ( !prefix.empty() && prefix[prefix.size() - 1] == '-' )
+    {
+        prefix.erase( prefix.size() - 1 );
+    }
+
+    return prefix + extension;
+}
@@ -0,0 +1,53 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __STREAMSEGMENT_H__
+#define __STREAMSEGMENT_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string>
+
+/**
+ * Naming of the files that make up a Ladybug stream. The SDK writes a
+ * stream as numbered segments that share a prefix: name-000000.pgr,
+ * name-000001.pgr, ...
+ */
+namespace streamSegment
+{
+    /** 
+     * Split a segment path into its prefix (including the dash) and index. 
+     * Returns false if the path does not look like a segment. 
+     */
+    bool splitPath( const std::string& segmentPath, std::string& prefix, unsigned int& index );
+
+    std::string makePath( const std::string& prefix, unsigned int index );
+
+    bool exists( const std::string& segmentPath );
+
+    /** 
+     * Path of a file that belongs to the whole stream, such as its journal
+     * or GPS track: name-000000.pgr gives name plus the extension. Other 
+     * paths get the extension appended.
+     */
+    std::string getSidecarPath( const std::string& segmentPath, const std::string& extension );
+}
+
+#endif // __STREAMSEGMENT_H__
@@ -0,0 +1,221 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "StreamSegment.h"
+#include "StreamWriteback.h"
+
+StreamWriteback::StreamWriteback() :
+m_segmentIndex( 0 ),
+m_chunkBytes( 0 ),
+m_fd( -1 ),
+m_submittedOffset( 0 ),
+m_droppedOffset( 0 ),
+m_retiredFd( -1 ),
+m_retiredOffset( 0 )
+{
+}
+
+StreamWriteback::~StreamWriteback()
+{
+    close();
+}
+
+bool 
+StreamWriteback::open( const std::string& firstSegmentPath, unsigned int chunkMB, std::string& errorMessage )
+{
+    close();
+
+    unsigned int firstIndex = 0;
+    if ( !streamSegment::splitPath( firstSegmentPath, m_segmentPrefix, firstIndex ) )
+    {
+        errorMessage = "unexpected stream file name " + firstSegmentPath;
+        return false;
+    }
+
+    m_chunkBytes = ( chunkMB > 0 ? chunkMB : 1 ) * 1024ULL * 1024ULL;
+
+#ifdef _WIN32
+    errorMessage = "not supported on this platform";
+    return false;
+#else
+    if ( !openSegment( firstIndex ) )
+    {
+        errorMessage = "unable to open " + firstSegmentPath + ": " + strerror( errno );
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+std::string 
+StreamWriteback::getSegmentPath() const
+{
+    return m_fd >= 0 ? streamSegment::makePath( m_segmentPrefix, m_segmentIndex ) : std::string();
+}
+
+bool 
+StreamWriteback::openSegment( unsigned int segmentIndex )
+{
+#ifndef _WIN32
+    // Read-only is enough for sync_file_range() and posix_fadvise()
+    const int fd = ::open( streamSegment::makePath( m_segmentPrefix, segmentIndex ).c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+        return false;
+    }
+
+    m_fd = fd;
+    m_segmentIndex = segmentIndex;
+    m_submittedOffset = 0;
+    m_droppedOffset = 0;
+    return true;
+#else
+    (void)segmentIndex;
+    return false;
+#endif
+}
+
+void 
+StreamWriteback::update()
+{
+#ifndef _WIN32
+    if ( m_fd < 0 )
+    {
+        return;
+    }
+
+    struct stat fileStatus;
+    if ( fstat( m_fd, &fileStatus ) != 0 )
+    {
+        return;
+    }
+
+    const unsigned long long fileSize = (unsigned long long)fileStatus.st_size;
+
+    while ( fileSize >= m_submittedOffset + m_chunkBytes )
+    {
+        // Start writeback of the new chunk without waiting for it
+        sync_file_range( m_fd, (off_t)m_submittedOffset, (off_t)m_chunkBytes, SYNC_FILE_RANGE_WRITE );
+
+        // The previous chunk had a whole chunk's worth of time to reach the 
+        // disk; wait for it and drop it from the page cache
+        if ( m_submittedOffset > m_droppedOffset )
+        {
+            const off_t length = (off_t)( m_submittedOffset - m_droppedOffset );
+            sync_file_range( m_fd, (off_t)m_droppedOffset, length, 
+                SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER );
+            posix_fadvise( m_fd, (off_t)m_droppedOffset, length, POSIX_FADV_DONTNEED );
+            m_droppedOffset = m_submittedOffset;
+        }
+
+        // So did the tail of the previous segment
+        finishRetiredSegment();
+
+        m_submittedOffset += m_chunkBytes;
+    }
+
+    // The SDK moves on to the next segment once a file is full
+    const unsigned int nextIndex = m_segmentIndex + 1;
+    if ( streamSegment::exists( streamSegment::makePath( m_segmentPrefix, nextIndex ) ) )
+    {
+        retireSegment();
+        openSegment( nextIndex );
+    }
+#endif
+}
+
+void 
+StreamWriteback::retireSegment()
+{
+#ifndef _WIN32
+    if ( m_fd < 0 )
+    {
+        return;
+    }
+
+    // Only start the writeback of the tail here; waiting for it on the 
+    // write path would bring back the stall at every segment change
+    sync_file_range( m_fd, (off_t)m_droppedOffset, 0, SYNC_FILE_RANGE_WRITE );
+
+    finishRetiredSegment();
+    m_retiredFd = m_fd;
+    m_retiredOffset = m_droppedOffset;
+    m_fd = -1;
+#endif
+}
+
+void 
+StreamWriteback::finishRetiredSegment()
+{
+#ifndef _WIN32
+    if ( m_retiredFd < 0 )
+    {
+        return;
+    }
+
+    sync_file_range( m_retiredFd, (off_t)m_retiredOffset, 0, 
+        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER );
+    posix_fadvise( m_retiredFd, (off_t)m_retiredOffset, 0, POSIX_FADV_DONTNEED );
+
+    ::close( m_retiredFd );
+    m_retiredFd = -1;
+#endif
+}
+
+void 
+StreamWriteback::finishSegment()
+{
+#ifndef _WIN32
+    if ( m_fd < 0 )
+    {
+        return;
+    }
+
+    sync_file_range( m_fd, (off_t)m_droppedOffset, 0, 
+        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER );
+    posix_fadvise( m_fd, (off_t)m_droppedOffset, 0, POSIX_FADV_DONTNEED );
+
+    ::close( m_fd );
+    m_fd = -1;
+#endif
+}
+
+void 
+StreamWriteback::close()
+{
+    finishRetiredSegment();
+    finishSegment();
+}
@@ -0,0 +1,84 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __STREAMWRITEBACK_H__
+#define __STREAMWRITEBACK_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string>
+
+/**
+ * Keeps a stream that is being recorded out of the page cache.
+ *
+ * ladybugWriteImageToStream() writes through the page cache, so a long
+ * recording fills memory with dirty pages. The kernel then flushes them in
+ * large bursts that stall the writer. This class follows the stream
+ * segments on disk (name-000000.pgr, name-000001.pgr, ...). It starts
+ * writeback of each new chunk as soon as the chunk is complete, waits for
+ * the chunk before it and drops that chunk from the cache. When the SDK
+ * moves on to the next segment, the tail of the old one is handled the 
+ * same way: its writeback starts at once and it is waited for and dropped
+ * once the first chunk of the new segment is complete. The files the SDK
+ * writes stay the same.
+ *
+ * Linux only; the functions do nothing on other platforms.
+ */
+class StreamWriteback
+{
+public:
+    StreamWriteback();
+    ~StreamWriteback();
+
+    /**
+     * Start following the stream whose first segment is firstSegmentPath,
+     * as returned by ladybugInitializeStreamForWriting().
+     */
+    bool open( const std::string& firstSegmentPath, unsigned int chunkMB, std::string& errorMessage );
+
+    /** Call after each write to the stream. */
+    void update();
+
+    /** Flush and drop what is left of the current segment. */
+    void close();
+
+    /** Current segment file, empty if none is open. */
+    std::string getSegmentPath() const;
+
+private:
+    bool openSegment( unsigned int segmentIndex );
+    void finishSegment();
+    void retireSegment();
+    void finishRetiredSegment();
+
+    std::string m_segmentPrefix;
+    unsigned int m_segmentIndex;
+    unsigned long long m_chunkBytes;
+
+    int m_fd;
+    unsigned long long m_submittedOffset;
+    unsigned long long m_droppedOffset;
+
+    // The previous segment, while the writeback of its tail is in flight
+    int m_retiredFd;
+    unsigned long long m_retiredOffset;
+};
+
+#endif // __STREAMWRITEBACK_H__
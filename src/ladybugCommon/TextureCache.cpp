@@ -0,0 +1,538 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <utime.h>
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "BinaryFile.h"
+#include "ImageFormat.h"
+#include "TextureCache.h"
+
+namespace
+{
+    const char k_magic[4] = { 'L', 'B', 'T', 'C' };
+    const uint32_t k_version = 1;
+    const char* const k_extension = ".ltc";
+
+    // Fastest zlib level; most of the gain comes from the delta filter
+    const int k_compressionLevel = 1;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t keyLength;
+        uint32_t cols;
+        uint32_t rows;
+        uint32_t format;
+        uint32_t cameraMask;
+    };
+
+    /** 64 bit FNV-1a. */
+    uint64_t hashKey( const std::string& key )
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for ( size_t i = 0; i < key.size(); i++ )
+        {
+            hash ^= (unsigned char)key[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /** Replace each sample of three channel rows by its difference to the left neighbour. */
+    template <typename T>
+    void subtractLeft( T* pSamples, unsigned int cols, unsigned int rows )
+    {
+        for ( unsigned int y = 0; y < rows; y++ )
+        {
+            T* pRow = pSamples + (size_t)y * cols * 3;
+            for ( unsigned int i = cols * 3 - 1; i >= 3; i-- )
+            {
+                pRow[i] = (T)( pRow[i] - pRow[i - 3] );
+            }
+        }
+    }
+
+    template <typename T>
+    void addLeft( T* pSamples, unsigned int cols, unsigned int rows )
+    {
+        for ( unsigned int y = 0; y < rows; y++ )
+        {
+            T* pRow = pSamples + (size_t)y * cols * 3;
+            for ( unsigned int i = 3; i < cols * 3; i++ )
+            {
+                pRow[i] = (T)( pRow[i] + pRow[i - 3] );
+            }
+        }
+    }
+
+    bool isHighBitDepth( LadybugPixelFormat pixelFormat )
+    {
+        return pixelFormat == LADYBUG_BGRU16;
+    }
+
+    long long getModificationTime( const std::string& path, unsigned long long* pSizeBytes )
+    {
+        struct stat info;
+        if ( stat( path.c_str(), &info ) != 0 )
+        {
+            return -1;
+        }
+
+        if ( pSizeBytes != NULL )
+        {
+            *pSizeBytes = (unsigned long long)info.st_size;
+        }
+        return (long long)info.st_mtime;
+    }
+
+    void touch( const std::string& path, long long now )
+    {
+        struct utimbuf times;
+        times.actime = (time_t)now;
+        times.modtime = (time_t)now;
+        utime( path.c_str(), &times );
+    }
+
+    void makeDirectory( const std::string& path )
+    {
+#ifdef _WIN32
+        _mkdir( path.c_str() );
+#else
+        mkdir( path.c_str(), 0755 );
+#endif
+    }
+}
+
+TextureCache::TextureCache( const std::string& directory, unsigned long long maxBytes, unsigned int numThreads ) :
+m_directory( directory ),
+m_maxBytes( maxBytes ),
+m_pool( numThreads ),
+m_totalBytes( 0 ),
+m_alphaCols( 0 ),
+m_alphaRows( 0 ),
+m_alphaFormat( LADYBUG_BGRU ),
+m_hits( 0 ),
+m_misses( 0 )
+{
+    makeDirectory( m_directory );
+    scanDirectory();
+}
+
+std::string 
+TextureCache::getFileName( const std::string& key ) const
+{
+    char fileName[32];
+    sprintf( fileName, "%016llx%s", (unsigned long long)hashKey( key ), k_extension );
+    return fileName;
+}
+
+std::string 
+TextureCache::getPath( const std::string& fileName ) const
+{
+#ifdef _WIN32
+    return m_directory + "\\" + fileName;
+#else
+    return m_directory + "/" + fileName;
+#endif
+}
+
+void 
+TextureCache::scanDirectory()
+{
+    std::vector<std::string> fileNames;
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA findData;
+    HANDLE hFind = FindFirstFileA( getPath( std::string( "*" ) + k_extension ).c_str(), &findData );
+    if ( hFind != INVALID_HANDLE_VALUE )
+    {
+        do
+        {
+            fileNames.push_back( findData.cFileName );
+        } while ( FindNextFileA( hFind, &findData ) );
+        FindClose( hFind );
+    }
+#else
+    DIR* pDir = opendir( m_directory.c_str() );
+    if ( pDir != NULL )
+    {
+        const size_t extensionLength = strlen( k_extension );
+        struct dirent* pEntry;
+        while ( ( pEntry = readdir( pDir ) ) != NULL )
+        {
+            const std::string name = pEntry->d_name;
+            if ( name.size() > extensionLength && 
+                name.compare( name.size() - extensionLength, extensionLength, k_extension ) == 0 )
+            {
+                fileNames.push_back( name );
+            }
+        }
+        closedir( pDir );
+    }
+#endif
+
+    for ( size_t i = 0; i < fileNames.size(); i++ )
+    {
+        Entry entry;
+        entry.lastUse = getModificationTime( getPath( fileNames[i] ), &entry.sizeBytes );
+        if ( entry.lastUse < 0 )
+        {
+            continue;
+        }
+
+        m_entries[fileNames[i]] = entry;
+        m_totalBytes += entry.sizeBytes;
+    }
+}
+
+void 
+TextureCache::evict( const std::string& keepFileName )
+{
+    while ( m_totalBytes > m_maxBytes && m_entries.size() > 1 )
+    {
+        std::map<std::string, Entry>::iterator oldest = m_entries.end();
+        for ( std::map<std::string, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it )
+        {
+            if ( it->first != keepFileName && 
+                ( oldest == m_entries.end() || it->second.lastUse < oldest->second.lastUse ) )
+            {
+                oldest = it;
+            }
+        }
+
+        remove( getPath( oldest->first ).c_str() );
+        m_totalBytes -= oldest->second.sizeBytes;
+        m_entries.erase( oldest );
+    }
+}
+
+void 
+TextureCache::setAlphaTemplate( 
+    unsigned char* const* arpTextures, 
+    unsigned int cols, 
+    unsigned int rows, 
+    LadybugPixelFormat pixelFormat )
+{
+    const size_t sampleBytes = isHighBitDepth( pixelFormat ) ? 2 : 1;
+    const size_t numPixels = (size_t)cols * rows;
+
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        std::vector<unsigned char>& alpha = m_alphaTemplate[camera];
+        if ( arpTextures[camera] == NULL )
+        {
+            alpha.clear();
+            continue;
+        }
+
+        alpha.resize( numPixels * sampleBytes );
+        for ( size_t i = 0; i < numPixels; i++ )
+        {
+            memcpy( &alpha[i * sampleBytes], arpTextures[camera] + ( i * 4 + 3 ) * sampleBytes, sampleBytes );
+        }
+    }
+
+    m_alphaCols = cols;
+    m_alphaRows = rows;
+    m_alphaFormat = pixelFormat;
+}
+
+bool 
+TextureCache::load( 
+    const std::string& key, 
+    unsigned char* const* arpTextures, 
+    unsigned int cols, 
+    unsigned int rows, 
+    LadybugPixelFormat pixelFormat )
+{
+    const std::string fileName = getFileName( key );
+    std::map<std::string, Entry>::iterator entry = m_entries.find( fileName );
+    if ( entry == m_entries.end() || !hasAlphaTemplate() || 
+        m_alphaCols != cols || m_alphaRows != rows || m_alphaFormat != pixelFormat )
+    {
+        m_misses++;
+        return false;
+    }
+
+    const std::string path = getPath( fileName );
+    FILE* pFile = fopen( path.c_str(), "rb" );
+    if ( pFile == NULL )
+    {
+        m_misses++;
+        return false;
+    }
+
+    const bool b16 = isHighBitDepth( pixelFormat );
+    const ImageFormat compactFormat = b16 ? IMAGE_FORMAT_BGR16 : IMAGE_FORMAT_BGR8;
+    const size_t compactBytes = imageFormat::getRowBytes( compactFormat, cols ) * rows;
+
+    FileHeader header;
+    std::string storedKey;
+    bool valid = fread( &header, sizeof(header), 1, pFile ) == 1 && 
+        memcmp( header.magic, k_magic, sizeof(k_magic) ) == 0 && 
+        header.version == k_version && 
+        header.keyLength == key.size() && 
+        header.cols == cols && 
+        header.rows == rows && 
+        header.format == (uint32_t)compactFormat;
+    if ( valid )
+    {
+        storedKey.resize( header.keyLength );
+        valid = fread( &storedKey[0], 1, header.keyLength, pFile ) == header.keyLength && storedKey == key;
+    }
+
+    // Read the compressed cameras, then decompress them in parallel
+    std::vector<unsigned char> compressed[LADYBUG_NUM_CAMERAS];
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS && valid; camera++ )
+    {
+        const bool stored = ( header.cameraMask & ( 1u << camera ) ) != 0;
+        if ( arpTextures[camera] != NULL && ( !stored || m_alphaTemplate[camera].empty() ) )
+        {
+            valid = false;
+        }
+        if ( !stored || !valid )
+        {
+            continue;
+        }
+
+        uint32_t compressedSize = 0;
+        valid = fread( &compressedSize, sizeof(compressedSize), 1, pFile ) == 1;
+        if ( valid )
+        {
+            compressed[camera].resize( compressedSize );
+            valid = compressedSize > 0 && fread( &compressed[camera][0], 1, compressedSize, pFile ) == compressedSize;
+        }
+    }
+    fclose( pFile );
+
+    if ( !valid )
+    {
+        m_misses++;
+        return false;
+    }
+
+    bool failed[LADYBUG_NUM_CAMERAS] = { false };
+    m_pool.parallelFor( LADYBUG_NUM_CAMERAS, [&]( unsigned int camera )
+    {
+        if ( arpTextures[camera] == NULL )
+        {
+            return;
+        }
+
+        thread_local std::vector<unsigned char> compact;
+        compact.resize( compactBytes );
+
+        uLongf size = (uLongf)compactBytes;
+        if ( uncompress( &compact[0], &size, &compressed[camera][0], (uLong)compressed[camera].size() ) != Z_OK || 
+            size != compactBytes )
+        {
+            failed[camera] = true;
+            return;
+        }
+
+        if ( b16 )
+        {
+            addLeft( reinterpret_cast<uint16_t*>( &compact[0] ), cols, rows );
+        }
+        else
+        {
+            addLeft( &compact[0], cols, rows );
+        }
+
+        const ImageFormat textureFormat = b16 ? IMAGE_FORMAT_BGRU16 : IMAGE_FORMAT_BGRU8;
+        const size_t compactRowBytes = imageFormat::getRowBytes( compactFormat, cols );
+        const size_t textureRowBytes = imageFormat::getRowBytes( textureFormat, cols );
+        const size_t sampleBytes = b16 ? 2 : 1;
+        const unsigned char* pAlpha = &m_alphaTemplate[camera][0];
+
+        for ( unsigned int y = 0; y < rows; y++ )
+        {
+            unsigned char* pRow = arpTextures[camera] + y * textureRowBytes;
+            imageFormat::convertRow( compactFormat, &compact[y * compactRowBytes], textureFormat, pRow, cols );
+
+            const unsigned char* pAlphaRow = pAlpha + (size_t)y * cols * sampleBytes;
+            for ( unsigned int x = 0; x < cols; x++ )
+            {
+                memcpy( pRow + ( x * 4 + 3 ) * sampleBytes, pAlphaRow + x * sampleBytes, sampleBytes );
+            }
+        }
+    } );
+
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        if ( failed[camera] )
+        {
+            m_misses++;
+            return false;
+        }
+    }
+
+    entry->second.lastUse = (long long)time( NULL );
+    touch( path, entry->second.lastUse );
+    m_hits++;
+    return true;
+}
+
+bool 
+TextureCache::store( 
+    const std::string& key, 
+    const unsigned char* const* arpTextures, 
+    unsigned int cols, 
+    unsigned int rows, 
+    LadybugPixelFormat pixelFormat )
+{
+    if ( pixelFormat != LADYBUG_BGRU && pixelFormat != LADYBUG_BGRU16 )
+    {
+        return false;
+    }
+
+    const bool b16 = isHighBitDepth( pixelFormat );
+    const ImageFormat textureFormat = b16 ? IMAGE_FORMAT_BGRU16 : IMAGE_FORMAT_BGRU8;
+    const ImageFormat compactFormat = b16 ? IMAGE_FORMAT_BGR16 : IMAGE_FORMAT_BGR8;
+    const size_t compactRowBytes = imageFormat::getRowBytes( compactFormat, cols );
+    const size_t textureRowBytes = imageFormat::getRowBytes( textureFormat, cols );
+    const size_t compactBytes = compactRowBytes * rows;
+
+    // Drop the alpha channel, filter and compress the cameras in parallel
+    std::vector<unsigned char> compressed[LADYBUG_NUM_CAMERAS];
+    bool failed[LADYBUG_NUM_CAMERAS] = { false };
+    m_pool.parallelFor( LADYBUG_NUM_CAMERAS, [&]( unsigned int camera )
+    {
+        if ( arpTextures[camera] == NULL )
+        {
+            return;
+        }
+
+        thread_local std::vector<unsigned char> compact;
+        compact.resize( compactBytes );
+        for ( unsigned int y = 0; y < rows; y++ )
+        {
+            imageFormat::convertRow( 
+                textureFormat, arpTextures[camera] + y * textureRowBytes, compactFormat, &compact[y * compactRowBytes], cols );
+        }
+
+        if ( b16 )
+        {
+            subtractLeft( reinterpret_cast<uint16_t*>( &compact[0] ), cols, rows );
+        }
+        else
+        {
+            subtractLeft( &compact[0], cols, rows );
+        }
+
+        uLongf size = compressBound( (uLong)compactBytes );
+        compressed[camera].resize( size );
+        if ( compress2( &compressed[camera][0], &size, &compact[0], (uLong)compactBytes, k_compressionLevel ) != Z_OK )
+        {
+            failed[camera] = true;
+            return;
+        }
+        compressed[camera].resize( size );
+    } );
+
+    FileHeader header;
+    memcpy( header.magic, k_magic, sizeof(k_magic) );
+    header.version = k_version;
+    header.keyLength = (uint32_t)key.size();
+    header.cols = cols;
+    header.rows = rows;
+    header.format = (uint32_t)compactFormat;
+    header.cameraMask = 0;
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        if ( failed[camera] )
+        {
+            return false;
+        }
+        if ( arpTextures[camera] != NULL )
+        {
+            header.cameraMask |= 1u << camera;
+        }
+    }
+
+    size_t totalBytes = sizeof(header) + key.size();
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        totalBytes += arpTextures[camera] != NULL ? sizeof(uint32_t) + compressed[camera].size() : 0;
+    }
+
+    std::vector<unsigned char> contents;
+    contents.reserve( totalBytes );
+    const unsigned char* pHeader = reinterpret_cast<const unsigned char*>( &header );
+    contents.insert( contents.end(), pHeader, pHeader + sizeof(header) );
+    contents.insert( contents.end(), key.begin(), key.end() );
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        if ( arpTextures[camera] == NULL )
+        {
+            continue;
+        }
+
+        const uint32_t compressedSize = (uint32_t)compressed[camera].size();
+        const unsigned char* pSize = reinterpret_cast<const unsigned char*>( &compressedSize );
+        contents.insert( contents.end(), pSize, pSize + sizeof(compressedSize) );
+        contents.insert( contents.end(), compressed[camera].begin(), compressed[camera].end() );
+    }
+
+    // No reader sees half an entry
+    const std::string fileName = getFileName( key );
+    const std::string path = getPath( fileName );
+    std::string errorMessage;
+    if ( !binaryFile::writeAtomically( path, &contents[0], contents.size(), false, errorMessage ) )
+    {
+        return false;
+    }
+
+    std::map<std::string, Entry>::iterator existing = m_entries.find( fileName );
+    if ( existing != m_entries.end() )
+    {
+        m_totalBytes -= existing->second.sizeBytes;
+    }
+
+    Entry& entry = m_entries[fileName];
+    entry.lastUse = getModificationTime( path, &entry.sizeBytes );
+    m_totalBytes += entry.sizeBytes;
+
+    evict( fileName );
+    return true;
+}
@@ -0,0 +1,128 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __TEXTURECACHE_H__
+#define __TEXTURECACHE_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ladybug.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "ThreadPool.h"
+
+/**
+ * On-disk cache of color processed texture buffers, so that runs which 
+ * only change rendering parameters can skip decoding and color 
+ * processing.
+ *
+ * Each entry holds the color channels of the cameras of one frame, 
+ * compressed losslessly with zlib after subtracting the left neighbour
+ * of every sample. The alpha channel is not stored: it comes from the 
+ * alpha masks, which depend on the blending width, so it is taken from 
+ * a texture converted in the current run instead (setAlphaTemplate()).
+ *
+ * Entries are files named after a hash of their key. The key is stored
+ * in the file and checked on load. When the files exceed the size cap, 
+ * the least recently used ones are deleted. A hit updates the file's 
+ * modification time, so the order carries over to later runs.
+ */
+class TextureCache
+{
+public:
+    /** numThreads of 0 uses one thread per hardware thread. */
+    TextureCache( const std::string& directory, unsigned long long maxBytes, unsigned int numThreads = 0 );
+
+    /** 
+     * Keep the alpha channel of textures converted in this run. Entries
+     * can only be loaded once this has been called.
+     */
+    void setAlphaTemplate( 
+        unsigned char* const* arpTextures, 
+        unsigned int cols, 
+        unsigned int rows, 
+        LadybugPixelFormat pixelFormat );
+
+    bool hasAlphaTemplate() const { return m_alphaCols != 0; }
+
+    /**
+     * Fill the non-NULL textures from the entry for key. Fails if there 
+     * is no such entry, it lacks one of the cameras or it was stored 
+     * with another size or format.
+     */
+    bool load( 
+        const std::string& key, 
+        unsigned char* const* arpTextures, 
+        unsigned int cols, 
+        unsigned int rows, 
+        LadybugPixelFormat pixelFormat );
+
+    /** Store the non-NULL textures of LADYBUG_BGRU or LADYBUG_BGRU16 under key. */
+    bool store( 
+        const std::string& key, 
+        const unsigned char* const* arpTextures, 
+        unsigned int cols, 
+        unsigned int rows, 
+        LadybugPixelFormat pixelFormat );
+
+    const std::string& getDirectory() const { return m_directory; }
+    unsigned long long getTotalBytes() const { return m_totalBytes; }
+    unsigned int getNumEntries() const { return (unsigned int)m_entries.size(); }
+    unsigned int getHits() const { return m_hits; }
+    unsigned int getMisses() const { return m_misses; }
+
+private:
+    struct Entry
+    {
+        unsigned long long sizeBytes;
+
+        /** Seconds since the epoch, as the file modification time. */
+        long long lastUse;
+    };
+
+    std::string getFileName( const std::string& key ) const;
+    std::string getPath( const std::string& fileName ) const;
+    void scanDirectory();
+    void evict( const std::string& keepFileName );
+
+    const std::string m_directory;
+    const unsigned long long m_maxBytes;
+    ThreadPool m_pool;
+
+    std::map<std::string, Entry> m_entries;
+    unsigned long long m_totalBytes;
+
+    /** The alpha samples of each camera, of the format they were taken from. */
+    std::vector<unsigned char> m_alphaTemplate[LADYBUG_NUM_CAMERAS];
+    unsigned int m_alphaCols;
+    unsigned int m_alphaRows;
+    LadybugPixelFormat m_alphaFormat;
+
+    unsigned int m_hits;
+    unsigned int m_misses;
+};
+
+#endif // __TEXTURECACHE_H__
@@ -0,0 +1,133 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool( unsigned int numThreads ) :
+m_pTask( NULL ),
+m_taskCount( 0 ),
+m_nextTask( 0 ),
+m_tasksRemaining( 0 ),
+m_generation( 0 ),
+m_stopRequested( false )
+{
+    if ( numThreads == 0 )
+    {
+        numThreads = std::thread::hardware_concurrency();
+    }
+
+    for ( unsigned int i = 1; i < numThreads; i++ )
+    {
+        m_workers.push_back( std::thread( &ThreadPool::workerLoop, this ) );
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stopRequested = true;
+    }
+    m_workAvailable.notify_all();
+
+    for ( size_t i = 0; i < m_workers.size(); i++ )
+    {
+        m_workers[i].join();
+    }
+}
+
+void 
+ThreadPool::parallelFor( unsigned int count, const std::function<void( unsigned int )>& task )
+{
+    if ( count == 0 )
+    {
+        return;
+    }
+
+    if ( m_workers.empty() || count == 1 )
+    {
+        for ( unsigned int i = 0; i < count; i++ )
+        {
+            task( i );
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_pTask = &task;
+        m_taskCount = count;
+        m_nextTask = 0;
+        m_tasksRemaining = count;
+        m_generation++;
+    }
+    m_workAvailable.notify_all();
+
+    runTasks();
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_workDone.wait( lock, [this] { return m_tasksRemaining == 0; } );
+    m_pTask = NULL;
+}
+
+void 
+ThreadPool::runTasks()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while ( m_pTask != NULL && m_nextTask < m_taskCount )
+    {
+        const unsigned int index = m_nextTask++;
+        const std::function<void( unsigned int )>& task = *m_pTask;
+
+        lock.unlock();
+        task( index );
+        lock.lock();
+
+        if ( --m_tasksRemaining == 0 )
+        {
+            m_workDone.notify_all();
+        }
+    }
+}
+
+void 
+ThreadPool::workerLoop()
+{
+    unsigned long lastGeneration = 0;
+
+    while ( true )
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_workAvailable.wait( lock, [&] { return m_stopRequested || m_generation != lastGeneration; } );
+            if ( m_stopRequested )
+            {
+                return;
+            }
+
+            lastGeneration = m_generation;
+        }
+
+        runTasks();
+    }
+}
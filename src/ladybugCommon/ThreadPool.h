@@ -0,0 +1,70 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads for data-parallel loops over image bands.
+ * The calling thread takes part in the work, so a pool of N threads keeps
+ * N - 1 workers.
+ */
+class ThreadPool
+{
+public:
+    /** numThreads of 0 uses one thread per hardware thread. */
+    explicit ThreadPool( unsigned int numThreads = 0 );
+    ~ThreadPool();
+
+    unsigned int getNumThreads() const { return (unsigned int)m_workers.size() + 1; }
+
+    /** Run task( i ) for every i in [0, count) and wait for all of them. */
+    void parallelFor( unsigned int count, const std::function<void( unsigned int )>& task );
+
+private:
+    ThreadPool( const ThreadPool& );
+    ThreadPool& operator=( const ThreadPool& );
+
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_workDone;
+
+    const std::function<void( unsigned int )>* m_pTask;
+    unsigned int m_taskCount;
+    unsigned int m_nextTask;
+    unsigned int m_tasksRemaining;
+    unsigned long m_generation;
+    bool m_stopRequested;
+};
+
+#endif // __THREADPOOL_H__
@@ -0,0 +1,360 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CpuFeatures.h"
+#include "TilePyramid.h"
+#include "TilePyramidAvx2.h"
+
+namespace
+{
+    const unsigned int k_lanczosTaps = 8;
+
+    // Pixels repeated before and after the filtered row, so that the 
+    // horizontal taps of every destination pixel stay inside it
+    const unsigned int k_rowPaddingBefore = 3;
+    const unsigned int k_rowPaddingAfter = 4;
+
+    bool useAvx2()
+    {
+        static const bool available = tilePyramid::avx2::isBuilt() && cpuFeatures::hasAvx2();
+        return available;
+    }
+
+    double sinc( double x )
+    {
+        if ( x == 0.0 )
+        {
+            return 1.0;
+        }
+        const double pi = 3.14159265358979323846;
+        return sin( pi * x ) / ( pi * x );
+    }
+
+    /** 
+     * Weights of source pixels 2x - 3 to 2x + 4 for destination pixel x, 
+     * whose center lies at 2x + 0.5: a Lanczos kernel of two lobes 
+     * stretched over the two source pixels of each destination pixel.
+     */
+    const float* getLanczosWeights()
+    {
+        static float weights[k_lanczosTaps];
+        static bool initialized = false;
+        if ( !initialized )
+        {
+            double total = 0.0;
+            double values[k_lanczosTaps];
+            for ( unsigned int i = 0; i < k_lanczosTaps; i++ )
+            {
+                const double t = ( i - 3.5 ) / 2.0;
+                values[i] = sinc( t ) * sinc( t / 2.0 );
+                total += values[i];
+            }
+            for ( unsigned int i = 0; i < k_lanczosTaps; i++ )
+            {
+                weights[i] = (float)( values[i] / total );
+            }
+            initialized = true;
+        }
+        return weights;
+    }
+
+    uint8_t toByte( float value )
+    {
+        // Round half to even, as the AVX2 path does
+        const long rounded = lrintf( value );
+        return (uint8_t)std::min( 255L, std::max( 0L, rounded ) );
+    }
+
+    void boxRow( const uint8_t* pTop, const uint8_t* pBottom, uint8_t* pDest, unsigned int first, unsigned int width )
+    {
+        for ( unsigned int x = first; x < width; x++ )
+        {
+            for ( unsigned int c = 0; c < 4; c++ )
+            {
+                const unsigned int sum = 
+                    pTop[x * 8 + c] + pTop[x * 8 + 4 + c] + 
+                    pBottom[x * 8 + c] + pBottom[x * 8 + 4 + c];
+                pDest[x * 4 + c] = (uint8_t)( ( sum + 2 ) >> 2 );
+            }
+        }
+    }
+
+    void lanczosColumn( const uint8_t* const* ppRows, const float* pWeights, float* pDest, unsigned int first, unsigned int count )
+    {
+        for ( unsigned int i = first; i < count; i++ )
+        {
+            float sum = 0.0f;
+            for ( unsigned int tap = 0; tap < k_lanczosTaps; tap++ )
+            {
+                sum += ppRows[tap][i] * pWeights[tap];
+            }
+            pDest[i] = sum;
+        }
+    }
+
+    void lanczosRow( const float* pSource, const float* pWeights, uint8_t* pDest, unsigned int first, unsigned int width )
+    {
+        for ( unsigned int x = first; x < width; x++ )
+        {
+            for ( unsigned int c = 0; c < 4; c++ )
+            {
+                float sum = 0.0f;
+                for ( unsigned int tap = 0; tap < k_lanczosTaps; tap++ )
+                {
+                    sum += pSource[( 2 * x + tap ) * 4 + c] * pWeights[tap];
+                }
+                pDest[x * 4 + c] = toByte( sum );
+            }
+        }
+    }
+}
+
+TilePyramid::TilePyramid( unsigned int tileSize, Filter filter ) :
+m_tileSize( std::max( 1u, tileSize ) ),
+m_filter( filter ),
+m_numTiles( 0 ),
+m_downsampleSeconds( 0.0 )
+{
+}
+
+unsigned int 
+TilePyramid::getNumLevels( unsigned int width, unsigned int height, unsigned int tileSize )
+{
+    unsigned int levels = 1;
+    while ( width > tileSize || height > tileSize )
+    {
+        width = ( width + 1 ) / 2;
+        height = ( height + 1 ) / 2;
+        levels++;
+    }
+    return levels;
+}
+
+bool 
+TilePyramid::write( 
+    const LadybugProcessedImage& image, 
+    const TilePathFunction& getTilePath, 
+    OutputEncoder& encoder, 
+    OutputEncoder::Format format )
+{
+    const unsigned int numLevels = getNumLevels( image.uiCols, image.uiRows, m_tileSize );
+    if ( m_levels.size() < numLevels )
+    {
+        m_levels.resize( numLevels );
+    }
+
+    if ( !loadTopLevel( image, m_levels[0] ) )
+    {
+        return false;
+    }
+
+    for ( unsigned int i = 0; i < numLevels; i++ )
+    {
+        if ( i > 0 )
+        {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if ( m_filter == FILTER_LANCZOS )
+            {
+                downsampleLanczos( m_levels[i - 1], m_levels[i] );
+            }
+            else
+            {
+                downsampleBox( m_levels[i - 1], m_levels[i] );
+            }
+            m_downsampleSeconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        }
+
+        // Level numbers count up from the smallest level
+        if ( !submitTiles( m_levels[i], numLevels - 1 - i, getTilePath, encoder, format ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool 
+TilePyramid::loadTopLevel( const LadybugProcessedImage& image, Level& level )
+{
+    unsigned int channels = 0;
+    bool highBitDepth = false;
+    switch ( image.pixelFormat )
+    {
+    case LADYBUG_BGR: channels = 3; break;
+    case LADYBUG_BGRU: channels = 4; break;
+    case LADYBUG_BGR16: channels = 3; highBitDepth = true; break;
+    case LADYBUG_BGRU16: channels = 4; highBitDepth = true; break;
+    default: return false;
+    }
+
+    if ( image.pData == NULL || image.uiCols == 0 || image.uiRows == 0 )
+    {
+        return false;
+    }
+
+    level.width = image.uiCols;
+    level.height = image.uiRows;
+    level.pixels.resize( (size_t)level.width * level.height * 4 );
+
+    const size_t numPixels = (size_t)level.width * level.height;
+    uint8_t* pDest = &level.pixels[0];
+    if ( image.pixelFormat == LADYBUG_BGRU )
+    {
+        std::copy( image.pData, image.pData + numPixels * 4, pDest );
+        return true;
+    }
+
+    for ( size_t i = 0; i < numPixels; i++ )
+    {
+        for ( unsigned int c = 0; c < 3; c++ )
+        {
+            if ( highBitDepth )
+            {
+                const uint16_t* pSource = reinterpret_cast<const uint16_t*>( image.pData );
+                pDest[i * 4 + c] = (uint8_t)( pSource[i * channels + c] >> 8 );
+            }
+            else
+            {
+                pDest[i * 4 + c] = image.pData[i * channels + c];
+            }
+        }
+        pDest[i * 4 + 3] = 0xFF;
+    }
+
+    return true;
+}
+
+void 
+TilePyramid::downsampleBox( const Level& source, Level& dest )
+{
+    dest.width = ( source.width + 1 ) / 2;
+    dest.height = ( source.height + 1 ) / 2;
+    dest.pixels.resize( (size_t)dest.width * dest.height * 4 );
+
+    // Odd sizes repeat the last column and row. The last column is done
+    // separately so that the whole pairs can be read straight from the 
+    // source rows.
+    const unsigned int pairs = source.width / 2;
+    const size_t sourceStride = (size_t)source.width * 4;
+    for ( unsigned int y = 0; y < dest.height; y++ )
+    {
+        const uint8_t* pTop = &source.pixels[2 * y * sourceStride];
+        const uint8_t* pBottom = 2 * y + 1 < source.height ? pTop + sourceStride : pTop;
+        uint8_t* pDest = &dest.pixels[(size_t)y * dest.width * 4];
+
+        const unsigned int done = useAvx2() ? tilePyramid::avx2::boxRow( pTop, pBottom, pDest, pairs ) : 0;
+        boxRow( pTop, pBottom, pDest, done, pairs );
+
+        if ( pairs < dest.width )
+        {
+            const uint8_t* pLastTop = pTop + ( source.width - 1 ) * 4;
+            const uint8_t* pLastBottom = pBottom + ( source.width - 1 ) * 4;
+            for ( unsigned int c = 0; c < 4; c++ )
+            {
+                const unsigned int sum = 2 * pLastTop[c] + 2 * pLastBottom[c];
+                pDest[pairs * 4 + c] = (uint8_t)( ( sum + 2 ) >> 2 );
+            }
+        }
+    }
+}
+
+void 
+TilePyramid::downsampleLanczos( const Level& source, Level& dest )
+{
+    dest.width = ( source.width + 1 ) / 2;
+    dest.height = ( source.height + 1 ) / 2;
+    dest.pixels.resize( (size_t)dest.width * dest.height * 4 );
+
+    const float* pWeights = getLanczosWeights();
+    const unsigned int samples = source.width * 4;
+    m_filteredRow.resize( ( k_rowPaddingBefore + source.width + k_rowPaddingAfter ) * 4 );
+    float* pRow = &m_filteredRow[k_rowPaddingBefore * 4];
+
+    for ( unsigned int y = 0; y < dest.height; y++ )
+    {
+        // Source rows 2y - 3 to 2y + 4, repeating the edge rows
+        const uint8_t* rows[k_lanczosTaps];
+        for ( unsigned int tap = 0; tap < k_lanczosTaps; tap++ )
+        {
+            const int row = std::min( (int)source.height - 1, std::max( 0, (int)( 2 * y + tap ) - 3 ) );
+            rows[tap] = &source.pixels[(size_t)row * samples];
+        }
+
+        const unsigned int done = useAvx2() ? tilePyramid::avx2::lanczosColumn( rows, pWeights, pRow, samples ) : 0;
+        lanczosColumn( rows, pWeights, pRow, done, samples );
+
+        for ( unsigned int i = 0; i < k_rowPaddingBefore; i++ )
+        {
+            std::copy( pRow, pRow + 4, &m_filteredRow[i * 4] );
+        }
+        for ( unsigned int i = 0; i < k_rowPaddingAfter; i++ )
+        {
+            std::copy( pRow + samples - 4, pRow + samples, pRow + samples + i * 4 );
+        }
+
+        const float* pSource = &m_filteredRow[0];
+        uint8_t* pDest = &dest.pixels[(size_t)y * dest.width * 4];
+        const unsigned int rowDone = useAvx2() ? tilePyramid::avx2::lanczosRow( pSource, pWeights, pDest, dest.width ) : 0;
+        lanczosRow( pSource, pWeights, pDest, rowDone, dest.width );
+    }
+}
+
+bool 
+TilePyramid::submitTiles( 
+    const Level& level, 
+    unsigned int levelIndex, 
+    const TilePathFunction& getTilePath, 
+    OutputEncoder& encoder, 
+    OutputEncoder::Format format )
+{
+    LadybugProcessedImage image;
+    image.uiCols = level.width;
+    image.uiRows = level.height;
+    image.pData = const_cast<unsigned char*>( &level.pixels[0] );
+    image.pixelFormat = LADYBUG_BGRU;
+
+    for ( unsigned int y = 0; y < level.height; y += m_tileSize )
+    {
+        for ( unsigned int x = 0; x < level.width; x += m_tileSize )
+        {
+            const unsigned int cols = std::min( m_tileSize, level.width - x );
+            const unsigned int rows = std::min( m_tileSize, level.height - y );
+            const std::string path = getTilePath( levelIndex, y / m_tileSize, x / m_tileSize );
+            if ( !encoder.submitRegion( image, x, y, cols, rows, path, format ) )
+            {
+                return false;
+            }
+            m_numTiles++;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,124 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __TILEPYRAMID_H__
+#define __TILEPYRAMID_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <ladybug.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "OutputEncoder.h"
+
+/**
+ * Cuts a rendered image into the square tiles of a multiresolution 
+ * pyramid, as read by web panorama viewers.
+ *
+ * The image is rendered once at full size. Each lower level is made by
+ * halving the one above, with a 2x2 box filter or a Lanczos filter of 
+ * two lobes, until the whole level fits in one tile. Level 0 
+ * is that smallest level and the full size image is the last.
+ *
+ * The tiles of a level are handed to an OutputEncoder as soon as the 
+ * level is made, so they are encoded while the next level is computed.
+ * Tiles at the right and bottom edges are cut short rather than padded.
+ */
+class TilePyramid
+{
+public:
+    enum Filter
+    {
+        FILTER_BOX,
+        FILTER_LANCZOS
+    };
+
+    /** The output path, or archive entry name, of a tile. */
+    typedef std::function<std::string( unsigned int level, unsigned int row, unsigned int column )> TilePathFunction;
+
+    TilePyramid( unsigned int tileSize, Filter filter );
+
+    /** Levels needed for an image of width x height, including the full size level. */
+    static unsigned int getNumLevels( unsigned int width, unsigned int height, unsigned int tileSize );
+
+    unsigned int getTileSize() const { return m_tileSize; }
+    Filter getFilter() const { return m_filter; }
+
+    /**
+     * Submit the tiles of every level of a LADYBUG_BGR, LADYBUG_BGRU, 
+     * LADYBUG_BGR16 or LADYBUG_BGRU16 image to encoder. Tiles are 8 bit;
+     * 16 bit images keep their high bytes. Returns false for other pixel
+     * formats or if a tile could not be submitted.
+     */
+    bool write( 
+        const LadybugProcessedImage& image, 
+        const TilePathFunction& getTilePath, 
+        OutputEncoder& encoder, 
+        OutputEncoder::Format format );
+
+    /** Tiles submitted and time spent downsampling, over all calls to write(). */
+    unsigned int getNumTiles() const { return m_numTiles; }
+    double getDownsampleSeconds() const { return m_downsampleSeconds; }
+
+private:
+    /** A level of the pyramid, as BGRU8 pixels. */
+    struct Level
+    {
+        std::vector<uint8_t> pixels;
+        unsigned int width;
+        unsigned int height;
+    };
+
+    TilePyramid( const TilePyramid& );
+    TilePyramid& operator=( const TilePyramid& );
+
+    bool loadTopLevel( const LadybugProcessedImage& image, Level& level );
+    void downsampleBox( const Level& source, Level& dest );
+    void downsampleLanczos( const Level& source, Level& dest );
+
+    bool submitTiles( 
+        const Level& level, 
+        unsigned int levelIndex, 
+        const TilePathFunction& getTilePath, 
+        OutputEncoder& encoder, 
+        OutputEncoder::Format format );
+
+    const unsigned int m_tileSize;
+    const Filter m_filter;
+
+    /** Levels from full size down, kept between calls for their buffers. */
+    std::vector<Level> m_levels;
+
+    /** One source row filtered vertically, with edge pixels repeated on both sides. */
+    std::vector<float> m_filteredRow;
+
+    unsigned int m_numTiles;
+    double m_downsampleSeconds;
+};
+
+#endif // __TILEPYRAMID_H__
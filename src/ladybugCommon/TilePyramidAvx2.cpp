@@ -0,0 +1,157 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//
+// Built with -mavx2. Keep standard library templates out of this file.
+//
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "TilePyramidAvx2.h"
+
+#if defined(__AVX2__) || ( defined(_MSC_VER) && defined(_M_X64) )
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <immintrin.h>
+
+namespace
+{
+    inline __m256i load32( const void* pSource )
+    {
+        return _mm256_loadu_si256( static_cast<const __m256i*>( pSource ) );
+    }
+
+    /** 
+     * Sum of two rows of four pixels, with pixels 0 + 1 in the low and 
+     * 2 + 3 in the high half, as 16 bit channels in the low 64 bits of 
+     * each half.
+     */
+    inline __m256i sumPairs( __m128i top, __m128i bottom )
+    {
+        const __m256i sum = _mm256_add_epi16( _mm256_cvtepu8_epi16( top ), _mm256_cvtepu8_epi16( bottom ) );
+        return _mm256_add_epi16( sum, _mm256_srli_si256( sum, 8 ) );
+    }
+
+    /** Round and pack the 16 bit sums of eight 2x2 blocks, as returned by sumPairs(). */
+    inline __m256i packSums( __m256i d01, __m256i d23, __m256i d45, __m256i d67 )
+    {
+        const __m256i rounding = _mm256_set1_epi16( 2 );
+        const __m256i low = _mm256_srli_epi16( _mm256_add_epi16( _mm256_unpacklo_epi64( d01, d23 ), rounding ), 2 );
+        const __m256i high = _mm256_srli_epi16( _mm256_add_epi16( _mm256_unpacklo_epi64( d45, d67 ), rounding ), 2 );
+
+        // d0 d2 d4 d6 in the low half, d1 d3 d5 d7 in the high half
+        return _mm256_permutevar8x32_epi32( 
+            _mm256_packus_epi16( low, high ), 
+            _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 ) );
+    }
+}
+
+bool 
+tilePyramid::avx2::isBuilt()
+{
+    return true;
+}
+
+unsigned int 
+tilePyramid::avx2::boxRow( const uint8_t* pTop, const uint8_t* pBottom, uint8_t* pDest, unsigned int width )
+{
+    // Eight destination pixels from sixteen pixels of each row
+    unsigned int x = 0;
+    for ( ; x + 8 <= width; x += 8 )
+    {
+        const __m256i top0 = load32( pTop + x * 8 );
+        const __m256i top1 = load32( pTop + x * 8 + 32 );
+        const __m256i bottom0 = load32( pBottom + x * 8 );
+        const __m256i bottom1 = load32( pBottom + x * 8 + 32 );
+
+        // Blocks 0 and 1 in the low half, 2 and 3 in the high half, and so on
+        const __m256i d01 = sumPairs( _mm256_castsi256_si128( top0 ), _mm256_castsi256_si128( bottom0 ) );
+        const __m256i d23 = sumPairs( _mm256_extracti128_si256( top0, 1 ), _mm256_extracti128_si256( bottom0, 1 ) );
+        const __m256i d45 = sumPairs( _mm256_castsi256_si128( top1 ), _mm256_castsi256_si128( bottom1 ) );
+        const __m256i d67 = sumPairs( _mm256_extracti128_si256( top1, 1 ), _mm256_extracti128_si256( bottom1, 1 ) );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDest + x * 4 ), packSums( d01, d23, d45, d67 ) );
+    }
+    return x;
+}
+
+unsigned int 
+tilePyramid::avx2::lanczosColumn( const uint8_t* const* ppRows, const float* pWeights, float* pDest, unsigned int count )
+{
+    unsigned int i = 0;
+    for ( ; i + 8 <= count; i += 8 )
+    {
+        __m256 sum = _mm256_setzero_ps();
+        for ( int tap = 0; tap < 8; tap++ )
+        {
+            const __m128i samples = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( ppRows[tap] + i ) );
+            const __m256 values = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( samples ) );
+            sum = _mm256_add_ps( sum, _mm256_mul_ps( values, _mm256_set1_ps( pWeights[tap] ) ) );
+        }
+        _mm256_storeu_ps( pDest + i, sum );
+    }
+    return i;
+}
+
+unsigned int 
+tilePyramid::avx2::lanczosRow( const float* pSource, const float* pWeights, uint8_t* pDest, unsigned int width )
+{
+    // Four destination pixels, two per vector with one in each half
+    unsigned int x = 0;
+    for ( ; x + 4 <= width; x += 4 )
+    {
+        __m256 sum01 = _mm256_setzero_ps();
+        __m256 sum23 = _mm256_setzero_ps();
+        for ( int tap = 0; tap < 8; tap++ )
+        {
+            const float* pTap = pSource + ( 2 * x + tap ) * 4;
+            const __m256 weight = _mm256_set1_ps( pWeights[tap] );
+            const __m256 pixels01 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( pTap ) ), _mm_loadu_ps( pTap + 8 ), 1 );
+            const __m256 pixels23 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( pTap + 16 ) ), _mm_loadu_ps( pTap + 24 ), 1 );
+            sum01 = _mm256_add_ps( sum01, _mm256_mul_ps( pixels01, weight ) );
+            sum23 = _mm256_add_ps( sum23, _mm256_mul_ps( pixels23, weight ) );
+        }
+
+        // 0 2 | 1 3 after packing, then in order
+        const __m256i words = _mm256_packs_epi32( _mm256_cvtps_epi32( sum01 ), _mm256_cvtps_epi32( sum23 ) );
+        const __m256i bytes = _mm256_permutevar8x32_epi32( 
+            _mm256_packus_epi16( words, words ), 
+            _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pDest + x * 4 ), _mm256_castsi256_si128( bytes ) );
+    }
+    return x;
+}
+
+#else
+
+bool 
+tilePyramid::avx2::isBuilt()
+{
+    return false;
+}
+
+unsigned int tilePyramid::avx2::boxRow( const uint8_t*, const uint8_t*, uint8_t*, unsigned int ) { return 0; }
+unsigned int tilePyramid::avx2::lanczosColumn( const uint8_t* const*, const float*, float*, unsigned int ) { return 0; }
+unsigned int tilePyramid::avx2::lanczosRow( const float*, const float*, uint8_t*, unsigned int ) { return 0; }
+
+#endif
@@ -0,0 +1,56 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __TILEPYRAMIDAVX2_H__
+#define __TILEPYRAMIDAVX2_H__
+
+//
+// AVX2 downsampling kernels used by TilePyramid.cpp, for BGRU8 pixels. 
+// Each function does as many whole vectors as fit and returns the number
+// of pixels (or samples) done; the caller finishes the rest. Only call 
+// them when isBuilt() and cpuFeatures::hasAvx2() are both true.
+//
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stdint.h>
+
+namespace tilePyramid
+{
+    namespace avx2
+    {
+        bool isBuilt();
+
+        /** Average 2x2 blocks of two rows of 2 * width pixels into width pixels. */
+        unsigned int boxRow( const uint8_t* pTop, const uint8_t* pBottom, uint8_t* pDest, unsigned int width );
+
+        /** Weighted sum of eight rows of samples. */
+        unsigned int lanczosColumn( const uint8_t* const* ppRows, const float* pWeights, float* pDest, unsigned int count );
+
+        /** 
+         * Eight tap filter along a row of float pixels, taking every other 
+         * pixel. Destination pixel x is taken from source pixels 2x to 
+         * 2x + 7, so pSource starts three pixels before the row.
+         */
+        unsigned int lanczosRow( const float* pSource, const float* pWeights, uint8_t* pDest, unsigned int width );
+    }
+}
+
+#endif // __TILEPYRAMIDAVX2_H__
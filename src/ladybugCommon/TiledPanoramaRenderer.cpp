@@ -0,0 +1,378 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cmath>
+
+#include <ladybuggeom.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "TiledPanoramaRenderer.h"
+
+namespace
+{
+    // Output pixels per tile side. 128 x 128 keeps the float accumulator 
+    // and a typical source rectangle within the L2 cache.
+    const unsigned int k_tileSize = 128;
+
+    // Output pixels between grid points of the mapping
+    const unsigned int k_gridStep = 16;
+
+    // Radius of the sphere the panorama is projected on, in meters
+    const double k_sphereRadius = 20.0;
+
+    // Grid points may land this far outside a camera image and still be
+    // used, so that cells along the image edges interpolate correctly
+    const double k_outsideMargin = 0.1;
+
+    // Extra source pixels around the rectangle a tile samples
+    const int k_sourceMargin = 2;
+
+    // Source rectangles are only sampled for color, so they drop the alpha channel
+    const ImageFormat k_scratchFormat = IMAGE_FORMAT_BGR8;
+    const unsigned int k_scratchPixelBytes = 3;
+
+    const double k_pi = 3.14159265358979323846;
+}
+
+TiledPanoramaRenderer::TiledPanoramaRenderer( DebayerEngine::Method method, unsigned int numThreads ) :
+m_debayerEngine( 1 ),
+m_method( method ),
+m_pool( numThreads ),
+m_cameraCols( 0 ),
+m_cameraRows( 0 ),
+m_outputWidth( 0 ),
+m_outputHeight( 0 ),
+m_blendingWidth( 0 ),
+m_gridCols( 0 ),
+m_gridRows( 0 ),
+m_tilesX( 0 ),
+m_tilesY( 0 ),
+m_peakScratchBytes( 0 ),
+m_cameraMask( ( 1u << LADYBUG_NUM_CAMERAS ) - 1 )
+{
+}
+
+LadybugError 
+TiledPanoramaRenderer::initialize( 
+    LadybugContext context, 
+    unsigned int cameraCols, 
+    unsigned int cameraRows, 
+    unsigned int outputWidth, 
+    unsigned int outputHeight, 
+    unsigned int blendingWidth )
+{
+    if ( cameraCols == 0 || cameraRows == 0 || outputWidth == 0 || outputHeight == 0 )
+    {
+        return LADYBUG_INVALID_ARGUMENT;
+    }
+
+    m_cameraCols = cameraCols;
+    m_cameraRows = cameraRows;
+    m_outputWidth = outputWidth;
+    m_outputHeight = outputHeight;
+    m_blendingWidth = blendingWidth;
+
+    //
+    // Project the grid points onto every camera
+    //
+    m_gridCols = ( outputWidth + k_gridStep - 1 ) / k_gridStep + 1;
+    m_gridRows = ( outputHeight + k_gridStep - 1 ) / k_gridStep + 1;
+    m_grid.assign( (size_t)m_gridCols * m_gridRows, GridPoint() );
+
+    const double marginCols = cameraCols * k_outsideMargin;
+    const double marginRows = cameraRows * k_outsideMargin;
+
+    for ( unsigned int gridY = 0; gridY < m_gridRows; gridY++ )
+    {
+        const double theta = k_pi * ( gridY * k_gridStep + 0.5 ) / outputHeight;
+        for ( unsigned int gridX = 0; gridX < m_gridCols; gridX++ )
+        {
+            const double phi = k_pi - 2.0 * k_pi * ( gridX * k_gridStep + 0.5 ) / outputWidth;
+            const double x = k_sphereRadius * sin( theta ) * cos( phi );
+            const double y = k_sphereRadius * sin( theta ) * sin( phi );
+            const double z = k_sphereRadius * cos( theta );
+
+            GridPoint& point = m_grid[(size_t)gridY * m_gridCols + gridX];
+            point.validCameras = 0;
+
+            for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+            {
+                if ( ( m_cameraMask & ( 1u << camera ) ) == 0 )
+                {
+                    continue;
+                }
+
+                double rectifiedRow = 0.0;
+                double rectifiedCol = 0.0;
+                double distance = 0.0;
+                LadybugError error = ladybugXYZtoRC( 
+                    context, x, y, z, camera, &rectifiedRow, &rectifiedCol, &distance );
+                if ( error != LADYBUG_OK || distance <= 0.0 )
+                {
+                    continue;
+                }
+
+                double rawRow = 0.0;
+                double rawCol = 0.0;
+                error = ladybugUnrectifyPixel( context, camera, rectifiedRow, rectifiedCol, &rawRow, &rawCol );
+                if ( error != LADYBUG_OK || 
+                    rawRow < -marginRows || rawRow > cameraRows + marginRows || 
+                    rawCol < -marginCols || rawCol > cameraCols + marginCols )
+                {
+                    continue;
+                }
+
+                point.rows[camera] = (float)rawRow;
+                point.cols[camera] = (float)rawCol;
+                point.validCameras |= (unsigned char)( 1 << camera );
+            }
+        }
+    }
+
+    //
+    // Find the source rectangles of every tile
+    //
+    m_tilesX = ( outputWidth + k_tileSize - 1 ) / k_tileSize;
+    m_tilesY = ( outputHeight + k_tileSize - 1 ) / k_tileSize;
+    m_tileSources.assign( (size_t)m_tilesX * m_tilesY, std::vector<TileSource>() );
+
+    size_t largestSource = 0;
+    for ( unsigned int tileY = 0; tileY < m_tilesY; tileY++ )
+    {
+        for ( unsigned int tileX = 0; tileX < m_tilesX; tileX++ )
+        {
+            std::vector<TileSource>& sources = m_tileSources[(size_t)tileY * m_tilesX + tileX];
+            findTileSources( tileX, tileY, sources );
+
+            for ( size_t i = 0; i < sources.size(); i++ )
+            {
+                largestSource = std::max( largestSource, (size_t)sources[i].width * sources[i].height );
+            }
+        }
+    }
+
+    // One color processed source rectangle and the accumulator at a time
+    m_peakScratchBytes = largestSource * k_scratchPixelBytes + (size_t)k_tileSize * k_tileSize * 4 * sizeof(float);
+
+    return LADYBUG_OK;
+}
+
+void 
+TiledPanoramaRenderer::findTileSources( unsigned int tileX, unsigned int tileY, std::vector<TileSource>& sources ) const
+{
+    sources.clear();
+
+    const unsigned int firstGridX = tileX * k_tileSize / k_gridStep;
+    const unsigned int firstGridY = tileY * k_tileSize / k_gridStep;
+    const unsigned int endGridX = std::min( m_gridCols, ( ( tileX + 1 ) * k_tileSize + k_gridStep - 1 ) / k_gridStep + 1 );
+    const unsigned int endGridY = std::min( m_gridRows, ( ( tileY + 1 ) * k_tileSize + k_gridStep - 1 ) / k_gridStep + 1 );
+
+    for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+    {
+        double minRow = m_cameraRows;
+        double maxRow = -1.0;
+        double minCol = m_cameraCols;
+        double maxCol = -1.0;
+
+        for ( unsigned int gridY = firstGridY; gridY < endGridY; gridY++ )
+        {
+            for ( unsigned int gridX = firstGridX; gridX < endGridX; gridX++ )
+            {
+                const GridPoint& point = m_grid[(size_t)gridY * m_gridCols + gridX];
+                if ( ( point.validCameras & ( 1 << camera ) ) == 0 )
+                {
+                    continue;
+                }
+
+                minRow = std::min( minRow, (double)point.rows[camera] );
+                maxRow = std::max( maxRow, (double)point.rows[camera] );
+                minCol = std::min( minCol, (double)point.cols[camera] );
+                maxCol = std::max( maxCol, (double)point.cols[camera] );
+            }
+        }
+
+        const int firstCol = std::max( 0, (int)floor( minCol ) - k_sourceMargin );
+        const int firstRow = std::max( 0, (int)floor( minRow ) - k_sourceMargin );
+        const int endCol = std::min( (int)m_cameraCols, (int)ceil( maxCol ) + k_sourceMargin + 1 );
+        const int endRow = std::min( (int)m_cameraRows, (int)ceil( maxRow ) + k_sourceMargin + 1 );
+        if ( endCol <= firstCol || endRow <= firstRow )
+        {
+            continue;
+        }
+
+        TileSource source;
+        source.camera = camera;
+        source.firstCol = firstCol;
+        source.firstRow = firstRow;
+        source.width = endCol - firstCol;
+        source.height = endRow - firstRow;
+        sources.push_back( source );
+    }
+}
+
+LadybugError 
+TiledPanoramaRenderer::render( const LadybugImage& image, unsigned char* pDest )
+{
+    if ( pDest == NULL || m_tileSources.empty() || 
+        image.uiCols != m_cameraCols || image.uiRows != m_cameraRows )
+    {
+        return LADYBUG_INVALID_ARGUMENT;
+    }
+
+    if ( !DebayerEngine::isSupported( image.dataFormat ) )
+    {
+        return LADYBUG_NOT_IMPLEMENTED;
+    }
+
+    m_pool.parallelFor( 
+        m_tilesX * m_tilesY, 
+        [&]( unsigned int tileIndex ) { renderTile( image, tileIndex, pDest ); } );
+
+    return LADYBUG_OK;
+}
+
+void 
+TiledPanoramaRenderer::renderTile( const LadybugImage& image, unsigned int tileIndex, unsigned char* pDest )
+{
+    const unsigned int firstX = ( tileIndex % m_tilesX ) * k_tileSize;
+    const unsigned int firstY = ( tileIndex / m_tilesX ) * k_tileSize;
+    const unsigned int endX = std::min( m_outputWidth, firstX + k_tileSize );
+    const unsigned int endY = std::min( m_outputHeight, firstY + k_tileSize );
+    const unsigned int tileWidth = endX - firstX;
+
+    // Weighted B, G, R and the sum of the weights
+    thread_local std::vector<float> accumulator;
+    accumulator.assign( (size_t)k_tileSize * k_tileSize * 4, 0.0f );
+
+    thread_local std::vector<unsigned char> scratch;
+
+    const float maxRow = (float)( m_cameraRows - 1 );
+    const float maxCol = (float)( m_cameraCols - 1 );
+    const float feather = m_blendingWidth > 0 ? 1.0f / m_blendingWidth : 0.0f;
+
+    const std::vector<TileSource>& sources = m_tileSources[tileIndex];
+    for ( size_t i = 0; i < sources.size(); i++ )
+    {
+        const TileSource& source = sources[i];
+        const unsigned int camera = source.camera;
+        const size_t scratchRowBytes = imageFormat::getRowBytes( k_scratchFormat, source.width );
+
+        scratch.resize( scratchRowBytes * source.height );
+        const LadybugError error = m_debayerEngine.convertRegion( 
+            image, 
+            m_method, 
+            camera, 
+            source.firstCol, 
+            source.firstRow, 
+            source.width, 
+            source.height, 
+            &scratch[0], 
+            scratchRowBytes, 
+            k_scratchFormat );
+        if ( error != LADYBUG_OK )
+        {
+            continue;
+        }
+
+        for ( unsigned int y = firstY; y < endY; y++ )
+        {
+            const unsigned int gridY = y / k_gridStep;
+            const float fy = (float)( y - gridY * k_gridStep ) / k_gridStep;
+
+            for ( unsigned int x = firstX; x < endX; x++ )
+            {
+                const unsigned int gridX = x / k_gridStep;
+                const float fx = (float)( x - gridX * k_gridStep ) / k_gridStep;
+
+                const GridPoint& p00 = m_grid[(size_t)gridY * m_gridCols + gridX];
+                const GridPoint& p01 = m_grid[(size_t)gridY * m_gridCols + gridX + 1];
+                const GridPoint& p10 = m_grid[(size_t)( gridY + 1 ) * m_gridCols + gridX];
+                const GridPoint& p11 = m_grid[(size_t)( gridY + 1 ) * m_gridCols + gridX + 1];
+                if ( ( p00.validCameras & p01.validCameras & p10.validCameras & p11.validCameras & ( 1 << camera ) ) == 0 )
+                {
+                    continue;
+                }
+
+                const float row = 
+                    ( p00.rows[camera] * ( 1.0f - fx ) + p01.rows[camera] * fx ) * ( 1.0f - fy ) + 
+                    ( p10.rows[camera] * ( 1.0f - fx ) + p11.rows[camera] * fx ) * fy;
+                const float col = 
+                    ( p00.cols[camera] * ( 1.0f - fx ) + p01.cols[camera] * fx ) * ( 1.0f - fy ) + 
+                    ( p10.cols[camera] * ( 1.0f - fx ) + p11.cols[camera] * fx ) * fy;
+                if ( row < 0.0f || col < 0.0f || row > maxRow || col > maxCol )
+                {
+                    continue;
+                }
+
+                // Fade out towards the image edges
+                const float edgeDistance = std::min( std::min( row, maxRow - row ), std::min( col, maxCol - col ) );
+                const float weight = feather > 0.0f ? std::min( 1.0f, edgeDistance * feather ) : 1.0f;
+                if ( weight <= 0.0f )
+                {
+                    continue;
+                }
+
+                // Bilinear sample from the source rectangle
+                const float localRow = std::min( std::max( row - source.firstRow, 0.0f ), source.height - 1.001f );
+                const float localCol = std::min( std::max( col - source.firstCol, 0.0f ), source.width - 1.001f );
+                const unsigned int sampleRow = (unsigned int)localRow;
+                const unsigned int sampleCol = (unsigned int)localCol;
+                const float wy = localRow - sampleRow;
+                const float wx = localCol - sampleCol;
+
+                const unsigned char* pTop = &scratch[sampleRow * scratchRowBytes + sampleCol * k_scratchPixelBytes];
+                const unsigned char* pBottom = source.height > 1 ? pTop + scratchRowBytes : pTop;
+                const unsigned int right = source.width > 1 ? k_scratchPixelBytes : 0;
+
+                float* pAccumulator = &accumulator[( (size_t)( y - firstY ) * k_tileSize + ( x - firstX ) ) * 4];
+                for ( int channel = 0; channel < 3; channel++ )
+                {
+                    const float top = pTop[channel] * ( 1.0f - wx ) + pTop[right + channel] * wx;
+                    const float bottom = pBottom[channel] * ( 1.0f - wx ) + pBottom[right + channel] * wx;
+                    pAccumulator[channel] += weight * ( top * ( 1.0f - wy ) + bottom * wy );
+                }
+                pAccumulator[3] += weight;
+            }
+        }
+    }
+
+    for ( unsigned int y = firstY; y < endY; y++ )
+    {
+        const float* pAccumulator = &accumulator[(size_t)( y - firstY ) * k_tileSize * 4];
+        unsigned char* pPixel = pDest + ( (size_t)y * m_outputWidth + firstX ) * 3;
+
+        for ( unsigned int x = 0; x < tileWidth; x++, pAccumulator += 4, pPixel += 3 )
+        {
+            const float weightSum = pAccumulator[3];
+            for ( int channel = 0; channel < 3; channel++ )
+            {
+                pPixel[channel] = weightSum > 0.0f 
+                    ? (unsigned char)std::min( 255.0f, pAccumulator[channel] / weightSum + 0.5f ) 
+                    : 0;
+            }
+        }
+    }
+}
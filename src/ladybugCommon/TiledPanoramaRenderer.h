@@ -0,0 +1,130 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __TILEDPANORAMARENDERER_H__
+#define __TILEDPANORAMARENDERER_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <vector>
+
+#include <ladybug.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "DebayerEngine.h"
+#include "ThreadPool.h"
+
+/**
+ * Renders equirectangular panoramas on the CPU straight from a RAW 
+ * image, without the six full resolution texture buffers the library 
+ * renderer needs.
+ *
+ * The panorama is cut into square tiles. For each tile, only the part 
+ * of each camera image that the tile sees is color processed, into a 
+ * scratch buffer of the worker thread, and then resampled and feathered
+ * into the output. The working memory of a thread therefore depends on
+ * the tile size and the angle a tile covers, not on the sensor size.
+ *
+ * Where each panorama pixel lands in the camera images is computed with
+ * ladybugXYZtoRC() and ladybugUnrectifyPixel() on a coarse grid at 
+ * initialization and interpolated in between. Column 0 of the panorama 
+ * looks along -X and the center column along +X (camera 0), with +Z at
+ * the top row.
+ */
+class TiledPanoramaRenderer
+{
+public:
+    /** numThreads of 0 uses one thread per hardware thread. */
+    TiledPanoramaRenderer( DebayerEngine::Method method, unsigned int numThreads = 0 );
+
+    /**
+     * Compute the mapping for the calibration loaded in context.
+     * blendingWidth is the feathering width, in camera image pixels, at 
+     * the edges of each camera image.
+     */
+    LadybugError initialize( 
+        LadybugContext context, 
+        unsigned int cameraCols, 
+        unsigned int cameraRows, 
+        unsigned int outputWidth, 
+        unsigned int outputHeight, 
+        unsigned int blendingWidth );
+
+    /** 
+     * Use only the cameras whose bits are set. Parts of the panorama 
+     * that no used camera sees are black. Call before initialize().
+     */
+    void setCameraMask( unsigned int cameraMask ) { m_cameraMask = cameraMask; }
+
+    /** Render into pDest, which holds outputWidth x outputHeight LADYBUG_BGR pixels. */
+    LadybugError render( const LadybugImage& image, unsigned char* pDest );
+
+    unsigned int getNumThreads() const { return m_pool.getNumThreads(); }
+
+    /** Working memory of one worker thread, in bytes. */
+    size_t getPeakScratchBytes() const { return m_peakScratchBytes; }
+
+private:
+    /** Where a grid point lands in each camera image. */
+    struct GridPoint
+    {
+        float rows[LADYBUG_NUM_CAMERAS];
+        float cols[LADYBUG_NUM_CAMERAS];
+        unsigned char validCameras;
+    };
+
+    /** Camera images a tile samples, and the source rectangle of each. */
+    struct TileSource
+    {
+        unsigned int camera;
+        unsigned int firstCol;
+        unsigned int firstRow;
+        unsigned int width;
+        unsigned int height;
+    };
+
+    void renderTile( const LadybugImage& image, unsigned int tileIndex, unsigned char* pDest );
+    void findTileSources( unsigned int tileX, unsigned int tileY, std::vector<TileSource>& sources ) const;
+
+    DebayerEngine m_debayerEngine;
+    DebayerEngine::Method m_method;
+    ThreadPool m_pool;
+
+    unsigned int m_cameraCols;
+    unsigned int m_cameraRows;
+    unsigned int m_outputWidth;
+    unsigned int m_outputHeight;
+    unsigned int m_blendingWidth;
+
+    unsigned int m_gridCols;
+    unsigned int m_gridRows;
+    std::vector<GridPoint> m_grid;
+
+    unsigned int m_tilesX;
+    unsigned int m_tilesY;
+    std::vector< std::vector<TileSource> > m_tileSources;
+
+    size_t m_peakScratchBytes;
+    unsigned int m_cameraMask;
+};
+
+#endif // __TILEDPANORAMARENDERER_H__
@@ -0,0 +1,216 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "BinaryFile.h"
+#include "NmeaParser.h"
+#include "StreamSegment.h"
+#include "TimeIndex.h"
+
+const char* const timeIndex::k_extension = ".tidx";
+
+namespace
+{
+    using binaryFile::computeCrc;
+    using binaryFile::getU32;
+    using binaryFile::getU64;
+    using binaryFile::putU32;
+    using binaryFile::putU64;
+
+    const char k_headerMagic[4] = { 'L', 'B', 'T', 'I' };
+    const unsigned int k_version = 1;
+
+    const unsigned int k_headerSize = 4 + 4 + 4 + 4 + 4 + 4;
+    const unsigned int k_entrySize = 8 + 8;
+
+    // More entries than this is taken as a damaged header
+    const unsigned int k_maxEntries = 100000000;
+
+    bool isEarlier( const TimeIndexEntry& entry, double utc )
+    {
+        return entry.utc < utc;
+    }
+}
+
+std::string 
+timeIndex::getIndexPath( const std::string& segmentPath )
+{
+    return streamSegment::getSidecarPath( segmentPath, k_extension );
+}
+
+bool 
+timeIndex::write( const std::string& path, const std::vector<TimeIndexEntry>& entries, unsigned int flags, std::string& errorMessage )
+{
+    std::vector<unsigned char> data( k_headerSize + entries.size() * k_entrySize );
+    for ( size_t i = 0; i < entries.size(); i++ )
+    {
+        unsigned char* p = &data[k_headerSize + i * k_entrySize];
+        unsigned long long utcBits = 0;
+        memcpy( &utcBits, &entries[i].utc, sizeof(utcBits) );
+        putU64( p, entries[i].tick );
+        putU64( p + 8, utcBits );
+    }
+
+    memcpy( &data[0], k_headerMagic, 4 );
+    putU32( &data[4], k_version );
+    putU32( &data[8], k_entrySize );
+    putU32( &data[12], (unsigned int)entries.size() );
+    putU32( &data[16], flags );
+    putU32( &data[20], computeCrc( data.data() + k_headerSize, data.size() - k_headerSize ) );
+
+    return binaryFile::writeAtomically( path, &data[0], data.size(), false, errorMessage );
+}
+
+bool 
+timeIndex::read( const std::string& path, std::vector<TimeIndexEntry>& entries, unsigned int& flags, std::string& errorMessage )
+{
+    entries.clear();
+    flags = 0;
+
+    FILE* pFile = fopen( path.c_str(), "rb" );
+    if ( pFile == NULL )
+    {
+        errorMessage = "Unable to open " + path;
+        return false;
+    }
+
+    unsigned char header[k_headerSize];
+    const bool hasHeader = fread( header, 1, k_headerSize, pFile ) == k_headerSize;
+    const unsigned int entrySize = hasHeader ? getU32( header + 8 ) : 0;
+    const unsigned int numEntries = hasHeader ? getU32( header + 12 ) : 0;
+    if ( !hasHeader || memcmp( header, k_headerMagic, 4 ) != 0 )
+    {
+        fclose( pFile );
+        errorMessage = path + " is not a time index";
+        return false;
+    }
+
+    // Later versions may only append fields to an entry
+    if ( getU32( header + 4 ) < k_version || entrySize < k_entrySize || numEntries > k_maxEntries )
+    {
+        fclose( pFile );
+        errorMessage = path + " has an unsupported version";
+        return false;
+    }
+
+    std::vector<unsigned char> body( (size_t)entrySize * numEntries );
+    const bool isRead = body.empty() || fread( &body[0], 1, body.size(), pFile ) == body.size();
+    fclose( pFile );
+    if ( !isRead || computeCrc( body.data(), body.size() ) != getU32( header + 20 ) )
+    {
+        errorMessage = path + " is truncated or damaged";
+        return false;
+    }
+
+    entries.resize( numEntries );
+    for ( unsigned int i = 0; i < numEntries; i++ )
+    {
+        const unsigned char* p = &body[(size_t)i * entrySize];
+        const unsigned long long utcBits = getU64( p + 8 );
+        entries[i].tick = getU64( p );
+        memcpy( &entries[i].utc, &utcBits, sizeof(utcBits) );
+    }
+    flags = getU32( header + 16 );
+    return true;
+}
+
+bool 
+timeIndex::parseUtc( const char* pText, double& utc )
+{
+    char* pEnd = NULL;
+    const double seconds = strtod( pText, &pEnd );
+    if ( pEnd != pText && *pEnd == '\0' && std::isfinite( seconds ) )
+    {
+        utc = seconds;
+        return true;
+    }
+
+    int year = 0;
+    unsigned int month = 0;
+    unsigned int day = 0;
+    unsigned int hour = 0;
+    unsigned int minute = 0;
+    double second = 0.0;
+    if ( sscanf( pText, "%d-%u-%uT%u:%u:%lf", &year, &month, &day, &hour, &minute, &second ) != 6 ||
+        year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 || 
+        hour > 23 || minute > 59 || second < 0.0 || second >= 61.0 )
+    {
+        return false;
+    }
+
+    utc = nmeaParser::getDayNumber( year, month, day ) * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+    return true;
+}
+
+TimeIndex::TimeIndex() :
+m_isOpen( false ),
+m_flags( 0 )
+{
+}
+
+bool 
+TimeIndex::openForStream( const std::string& segmentPath, std::string& errorMessage )
+{
+    errorMessage.clear();
+    const std::string indexPath = timeIndex::getIndexPath( segmentPath );
+    if ( !streamSegment::exists( indexPath ) )
+    {
+        return false;
+    }
+    return open( indexPath, errorMessage );
+}
+
+bool 
+TimeIndex::open( const std::string& indexPath, std::string& errorMessage )
+{
+    m_isOpen = timeIndex::read( indexPath, m_entries, m_flags, errorMessage );
+    if ( !m_isOpen )
+    {
+        m_entries.clear();
+        m_flags = 0;
+    }
+    return m_isOpen;
+}
+
+bool 
+TimeIndex::findFrame( double utc, unsigned int& frame ) const
+{
+    // Times only increase with the frame, so the index is sorted by time
+    const std::vector<TimeIndexEntry>::const_iterator it = 
+        std::lower_bound( m_entries.begin(), m_entries.end(), utc, isEarlier );
+    if ( it == m_entries.end() )
+    {
+        return false;
+    }
+
+    frame = (unsigned int)( it - m_entries.begin() );
+    return true;
+}
@@ -0,0 +1,109 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __TIMEINDEX_H__
+#define __TIMEINDEX_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <string>
+#include <vector>
+
+/** Time of one frame. */
+struct TimeIndexEntry
+{
+    /** Unwrapped cycle time, see CameraClock. */
+    unsigned long long tick;
+
+    /** Seconds since 1970. */
+    double utc;
+};
+
+/**
+ * A time index (name.tidx next to name-000000.pgr) holds the time of 
+ * every frame of a stream, in frame order, so that frames can be found by 
+ * absolute time without reading the stream.
+ *
+ * Layout, with little endian integers and IEEE floating point:
+ *
+ *   header  "LBTI", version (4), entry size (4), number of entries (4),
+ *           flags (4), CRC-32 of the entries (4)
+ *   entries tick (8), utc (8)
+ */
+namespace timeIndex
+{
+    enum Flags
+    {
+        /** The times are UTC from PPS locked frames, not camera time. */
+        IS_UTC = 1 << 0
+    };
+
+    /** Index files are recognized by this extension, ".tidx". */
+    extern const char* const k_extension;
+
+    /** Index file that belongs to a stream segment. */
+    std::string getIndexPath( const std::string& segmentPath );
+
+    /** Replace the file at path atomically. */
+    bool write( const std::string& path, const std::vector<TimeIndexEntry>& entries, unsigned int flags, std::string& errorMessage );
+
+    bool read( const std::string& path, std::vector<TimeIndexEntry>& entries, unsigned int& flags, std::string& errorMessage );
+
+    /** ISO 8601 UTC (2016-03-24T19:32:51.167Z) or seconds since 1970. */
+    bool parseUtc( const char* pText, double& utc );
+}
+
+/**
+ * The time index of a stream, with lookups of frames by time.
+ */
+class TimeIndex
+{
+public:
+    TimeIndex();
+
+    /** 
+     * Load the index of the stream whose first segment is segmentPath. 
+     * Returns false with an empty errorMessage if the stream has no index.
+     */
+    bool openForStream( const std::string& segmentPath, std::string& errorMessage );
+
+    bool open( const std::string& indexPath, std::string& errorMessage );
+
+    bool isOpen() const { return m_isOpen; }
+
+    bool isUtc() const { return ( m_flags & timeIndex::IS_UTC ) != 0; }
+
+    unsigned int getNumFrames() const { return (unsigned int)m_entries.size(); }
+
+    double getUtc( unsigned int frame ) const { return m_entries[frame].utc; }
+
+    /** 
+     * The first frame at or after utc. Returns false if every frame is 
+     * earlier.
+     */
+    bool findFrame( double utc, unsigned int& frame ) const;
+
+private:
+    bool m_isOpen;
+    unsigned int m_flags;
+    std::vector<TimeIndexEntry> m_entries;
+};
+
+#endif // __TIMEINDEX_H__
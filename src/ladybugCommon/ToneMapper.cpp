@@ -0,0 +1,165 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <cmath>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "CpuFeatures.h"
+#include "ToneMapper.h"
+#include "ToneMapperAvx2.h"
+
+namespace
+{
+    // Pixels mapped by one task
+    const size_t k_bandPixels = 65536;
+
+    // Rec. 709 luminance of B, G and R
+    const float k_blueWeight = 0.0722f;
+    const float k_greenWeight = 0.7152f;
+    const float k_redWeight = 0.2126f;
+
+    bool useAvx2()
+    {
+        static const bool available = toneMapper::avx2::isBuilt() && cpuFeatures::hasAvx2();
+        return available;
+    }
+
+    inline float getLuminance( const float* pPixel )
+    {
+        return k_blueWeight * pPixel[0] + k_greenWeight * pPixel[1] + k_redWeight * pPixel[2];
+    }
+
+    inline unsigned char encode( float value, const unsigned char* pGammaTable )
+    {
+        const float clipped = std::min( std::max( value, 0.0f ), 1.0f );
+        return pGammaTable[lrintf( clipped * 65535.0f )];
+    }
+}
+
+ToneMapper::ToneMapper( unsigned int numThreads ) :
+m_pool( numThreads ),
+m_gammaTableGamma( 0.0f ),
+m_logAverage( 0.0f )
+{
+}
+
+ToneMapper::Settings 
+ToneMapper::getDefaultSettings()
+{
+    Settings settings;
+    settings.op = OPERATOR_REINHARD;
+    settings.key = 0.18f;
+    settings.white = 0.0f;
+    settings.stops = 0.0f;
+    settings.gamma = 2.2f;
+    return settings;
+}
+
+void 
+ToneMapper::map( const float* pSource, size_t pixelCount, const Settings& settings, unsigned char* pDest )
+{
+    const unsigned int numBands = (unsigned int)( ( pixelCount + k_bandPixels - 1 ) / k_bandPixels );
+
+    //
+    // Log-average and largest luminance, leaving out black pixels such 
+    // as the parts of a panorama no camera sees
+    //
+    std::vector<double> logSums( numBands, 0.0 );
+    std::vector<size_t> counts( numBands, 0 );
+    std::vector<float> maxima( numBands, 0.0f );
+    m_pool.parallelFor( numBands, [&]( unsigned int band ) {
+        const size_t end = std::min( pixelCount, ( band + 1 ) * k_bandPixels );
+        for ( size_t i = band * k_bandPixels; i < end; i++ )
+        {
+            const float luminance = getLuminance( pSource + i * 3 );
+            if ( luminance > 0.0f )
+            {
+                logSums[band] += log( luminance );
+                counts[band]++;
+                maxima[band] = std::max( maxima[band], luminance );
+            }
+        }
+    } );
+
+    double logSum = 0.0;
+    size_t count = 0;
+    float maximum = 0.0f;
+    for ( unsigned int band = 0; band < numBands; band++ )
+    {
+        logSum += logSums[band];
+        count += counts[band];
+        maximum = std::max( maximum, maxima[band] );
+    }
+    m_logAverage = count > 0 ? (float)exp( logSum / count ) : 1.0f;
+
+    const float scale = settings.key / m_logAverage * exp2f( settings.stops );
+    const bool compress = settings.op == OPERATOR_REINHARD;
+    float white = settings.white > 0.0f ? settings.white : maximum * scale;
+    if ( !( white > 0.0f ) )
+    {
+        white = 1.0f;
+    }
+    const float invWhite2 = 1.0f / ( white * white );
+
+    //
+    // Gamma table, with 3 bytes of padding for the 4 byte AVX2 lookups
+    //
+    if ( m_gammaTableGamma != settings.gamma )
+    {
+        m_gammaTable.assign( 65536 + 3, 0 );
+        for ( unsigned int i = 0; i < 65536; i++ )
+        {
+            m_gammaTable[i] = (unsigned char)lrint( 255.0 * pow( i / 65535.0, 1.0 / settings.gamma ) );
+        }
+        m_gammaTableGamma = settings.gamma;
+    }
+    const unsigned char* pGammaTable = &m_gammaTable[0];
+
+    m_pool.parallelFor( numBands, [&]( unsigned int band ) {
+        const size_t first = band * k_bandPixels;
+        const unsigned int bandCount = (unsigned int)( std::min( pixelCount, first + k_bandPixels ) - first );
+        const float* pBandSource = pSource + first * 3;
+        unsigned char* pBandDest = pDest + first * 3;
+
+        unsigned int done = useAvx2() ? 
+            toneMapper::avx2::mapRow( pBandSource, bandCount, scale, compress, invWhite2, pGammaTable, pBandDest ) : 0;
+        for ( ; done < bandCount; done++ )
+        {
+            const float* pPixel = pBandSource + (size_t)done * 3;
+            float factor = scale;
+            if ( compress )
+            {
+                const float luminance = scale * getLuminance( pPixel );
+                factor = scale * ( 1.0f + luminance * invWhite2 ) / ( 1.0f + luminance );
+            }
+
+            unsigned char* pOut = pBandDest + (size_t)done * 3;
+            pOut[0] = encode( pPixel[0] * factor, pGammaTable );
+            pOut[1] = encode( pPixel[1] * factor, pGammaTable );
+            pOut[2] = encode( pPixel[2] * factor, pGammaTable );
+        }
+    } );
+}
@@ -0,0 +1,95 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __TONEMAPPER_H__
+#define __TONEMAPPER_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stddef.h>
+#include <vector>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "ThreadPool.h"
+
+/**
+ * Maps a radiance image (B, G, R floats) to 8 bit BGR for display.
+ *
+ * Both operators first scale the image so that its log-average luminance
+ * lands on the key (18% gray by default), as in Reinhard et al. The 
+ * Reinhard operator then compresses luminance L to L (1 + L / W^2) / (1 + L),
+ * which keeps the darks linear and brings luminance W to white; the 
+ * exposure operator clips at white instead. The result is gamma encoded
+ * through a table.
+ *
+ * The image is mapped in bands on a thread pool, with AVX2 where the 
+ * processor has it.
+ */
+class ToneMapper
+{
+public:
+    enum Operator
+    {
+        OPERATOR_REINHARD,
+        OPERATOR_EXPOSURE
+    };
+
+    struct Settings
+    {
+        Operator op;
+
+        /** Luminance the log-average maps to, 0 to 1. */
+        float key;
+
+        /** 
+         * Scaled luminance that maps to white with OPERATOR_REINHARD; 0 
+         * for the brightest pixel of the image.
+         */
+        float white;
+
+        /** Stops added to the exposure after scaling to the key. */
+        float stops;
+
+        float gamma;
+    };
+
+    /** numThreads of 0 uses one thread per hardware thread. */
+    explicit ToneMapper( unsigned int numThreads = 0 );
+
+    static Settings getDefaultSettings();
+
+    /** Map pixelCount pixels of pSource to 3 bytes each in pDest. */
+    void map( const float* pSource, size_t pixelCount, const Settings& settings, unsigned char* pDest );
+
+    /** Log-average luminance of the last image, over its pixels that are not black. */
+    float getLogAverage() const { return m_logAverage; }
+
+    unsigned int getNumThreads() const { return m_pool.getNumThreads(); }
+
+private:
+    ThreadPool m_pool;
+    std::vector<unsigned char> m_gammaTable;
+    float m_gammaTableGamma;
+    float m_logAverage;
+};
+
+#endif // __TONEMAPPER_H__
@@ -0,0 +1,116 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//
+// Built with -mavx2. Keep standard library templates out of this file.
+//
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "ToneMapperAvx2.h"
+
+#if defined(__AVX2__) || ( defined(_MSC_VER) && defined(_M_X64) )
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <immintrin.h>
+
+namespace
+{
+    /** Gamma encoded bytes of 8 linear values clipped to [0, 1]. */
+    inline __m256i encode( __m256 value, const uint8_t* pGammaTable )
+    {
+        const __m256 clipped = _mm256_min_ps( _mm256_max_ps( value, _mm256_setzero_ps() ), _mm256_set1_ps( 1.0f ) );
+        const __m256i index = _mm256_cvtps_epi32( _mm256_mul_ps( clipped, _mm256_set1_ps( 65535.0f ) ) );
+
+        // Four bytes from each entry, of which the first is the one
+        const __m256i entries = _mm256_i32gather_epi32( reinterpret_cast<const int*>( pGammaTable ), index, 1 );
+        return _mm256_and_si256( entries, _mm256_set1_epi32( 0xff ) );
+    }
+}
+
+bool 
+toneMapper::avx2::isBuilt()
+{
+    return true;
+}
+
+unsigned int 
+toneMapper::avx2::mapRow( 
+    const float* pSource, 
+    unsigned int count, 
+    float scale, 
+    bool compress, 
+    float invWhite2, 
+    const uint8_t* pGammaTable, 
+    uint8_t* pDest )
+{
+    const __m256i pixelOffsets = _mm256_setr_epi32( 0, 3, 6, 9, 12, 15, 18, 21 );
+    const __m256 scaleVector = _mm256_set1_ps( scale );
+    const __m256 invWhite2Vector = _mm256_set1_ps( invWhite2 );
+    const __m256 one = _mm256_set1_ps( 1.0f );
+
+    unsigned int i = 0;
+    for ( ; i + 8 <= count; i += 8 )
+    {
+        const float* pPixels = pSource + (size_t)i * 3;
+        const __m256 blue = _mm256_i32gather_ps( pPixels, pixelOffsets, 4 );
+        const __m256 green = _mm256_i32gather_ps( pPixels + 1, pixelOffsets, 4 );
+        const __m256 red = _mm256_i32gather_ps( pPixels + 2, pixelOffsets, 4 );
+
+        __m256 factor = scaleVector;
+        if ( compress )
+        {
+            const __m256 luminance = _mm256_mul_ps( scaleVector, _mm256_add_ps( 
+                _mm256_add_ps( _mm256_mul_ps( blue, _mm256_set1_ps( 0.0722f ) ), _mm256_mul_ps( green, _mm256_set1_ps( 0.7152f ) ) ), 
+                _mm256_mul_ps( red, _mm256_set1_ps( 0.2126f ) ) ) );
+            const __m256 numerator = _mm256_add_ps( one, _mm256_mul_ps( luminance, invWhite2Vector ) );
+            factor = _mm256_div_ps( _mm256_mul_ps( scaleVector, numerator ), _mm256_add_ps( one, luminance ) );
+        }
+
+        alignas( 32 ) int32_t bytes[3][8];
+        _mm256_store_si256( reinterpret_cast<__m256i*>( bytes[0] ), encode( _mm256_mul_ps( blue, factor ), pGammaTable ) );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( bytes[1] ), encode( _mm256_mul_ps( green, factor ), pGammaTable ) );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( bytes[2] ), encode( _mm256_mul_ps( red, factor ), pGammaTable ) );
+
+        uint8_t* pOut = pDest + (size_t)i * 3;
+        for ( unsigned int j = 0; j < 8; j++ )
+        {
+            pOut[j * 3] = (uint8_t)bytes[0][j];
+            pOut[j * 3 + 1] = (uint8_t)bytes[1][j];
+            pOut[j * 3 + 2] = (uint8_t)bytes[2][j];
+        }
+    }
+    return i;
+}
+
+#else
+
+bool 
+toneMapper::avx2::isBuilt()
+{
+    return false;
+}
+
+unsigned int toneMapper::avx2::mapRow( const float*, unsigned int, float, bool, float, const uint8_t*, uint8_t* ) { return 0; }
+
+#endif
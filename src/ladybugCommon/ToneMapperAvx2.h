@@ -0,0 +1,58 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __TONEMAPPERAVX2_H__
+#define __TONEMAPPERAVX2_H__
+
+//
+// AVX2 row mapping used by ToneMapper.cpp. Maps as many whole vectors of
+// 8 pixels as fit and returns the number of pixels done; the caller 
+// finishes the rest. Only call it when isBuilt() and cpuFeatures::hasAvx2()
+// are both true.
+//
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stdint.h>
+
+namespace toneMapper
+{
+    namespace avx2
+    {
+        bool isBuilt();
+
+        /**
+         * Each channel is multiplied by scale, and with compress also by
+         * ( 1 + L * invWhite2 ) / ( 1 + L ) for the scaled luminance L,
+         * then clipped to 1 and looked up in the 65536 entry gammaTable,
+         * which has 3 more bytes of padding.
+         */
+        unsigned int mapRow( 
+            const float* pSource, 
+            unsigned int count, 
+            float scale, 
+            bool compress, 
+            float invWhite2, 
+            const uint8_t* pGammaTable, 
+            uint8_t* pDest );
+    }
+}
+
+#endif // __TONEMAPPERAVX2_H__
@@ -0,0 +1,359 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <time.h>
+#endif
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "RealtimeSupport.h"
+#include "TriggerScheduler.h"
+
+namespace
+{
+    const long long k_nsPerSecond = 1000000000LL;
+
+    // Longest single sleep, so that stop() is not held up by a long period
+    const long long k_maxSleepNs = 100000000LL;
+
+    const size_t k_fireRingCapacity = 4096;
+
+    // Lateness in 1 us bins up to 2 ms; firing in 10 us bins up to 20 ms
+    const double k_latenessBinUs = 1.0;
+    const unsigned int k_latenessBins = 2000;
+    const double k_fireDurationBinUs = 10.0;
+    const unsigned int k_fireDurationBins = 2000;
+}
+
+TriggerScheduler::Settings 
+TriggerScheduler::getDefaultSettings()
+{
+    Settings settings;
+    settings.schedule = SCHEDULE_FIXED_RATE;
+    settings.rateHz = 10.0;
+    settings.burstCount = 1;
+    settings.burstPeriodSeconds = 1.0;
+    settings.minIntervalSeconds = 0.0;
+    settings.maxTriggers = 0;
+    settings.realtimePriority = 0;
+    settings.cpu = -1;
+    settings.spinMicroseconds = 0;
+    return settings;
+}
+
+long long 
+TriggerScheduler::getTimeNs()
+{
+#ifndef _WIN32
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (long long)now.tv_sec * k_nsPerSecond + now.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( 
+        std::chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+}
+
+TriggerScheduler::TriggerScheduler() :
+m_settings( getDefaultSettings() ),
+m_fires( k_fireRingCapacity ),
+m_isReady( false ),
+m_stopRequested( false ),
+m_isRunning( false ),
+m_hasFailed( false ),
+m_numFired( 0 ),
+m_numSkipped( 0 ),
+m_numDropped( 0 ),
+m_startNs( 0 ),
+m_lateness( k_latenessBinUs, k_latenessBins ),
+m_fireDuration( k_fireDurationBinUs, k_fireDurationBins )
+{
+}
+
+TriggerScheduler::~TriggerScheduler()
+{
+    stop();
+}
+
+bool 
+TriggerScheduler::start( const Settings& settings, const FireFunction& fire, std::string& errorMessage )
+{
+    if ( m_thread.joinable() )
+    {
+        errorMessage = "The trigger scheduler is already running.";
+        return false;
+    }
+
+    if ( settings.schedule != SCHEDULE_EXTERNAL && !( settings.rateHz > 0.0 ) )
+    {
+        errorMessage = "The trigger rate must be positive.";
+        return false;
+    }
+
+    if ( settings.schedule == SCHEDULE_BURST &&
+        ( settings.burstCount == 0 || settings.burstPeriodSeconds * settings.rateHz < settings.burstCount ) )
+    {
+        errorMessage = "A burst must have at least one trigger and fit in the burst period.";
+        return false;
+    }
+
+    if ( settings.minIntervalSeconds < 0.0 )
+    {
+        errorMessage = "The minimum trigger interval must not be negative.";
+        return false;
+    }
+
+    m_settings = settings;
+    m_fire = fire;
+    Fire stale;
+    while ( m_fires.pop( stale ) )
+    {
+    }
+    m_requests.clear();
+    m_isReady = false;
+    m_stopRequested = false;
+    m_hasFailed = false;
+    m_numFired = 0;
+    m_numSkipped = 0;
+    m_numDropped = 0;
+    m_schedulingWarning.clear();
+    m_lateness.reset();
+    m_fireDuration.reset();
+
+    m_isRunning = true;
+    m_thread = std::thread( &TriggerScheduler::run, this );
+
+    // The schedule starts once the thread has its priority, so that the 
+    // first deadlines are not missed while it is being set up
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_condition.wait( lock, [this]() { return m_isReady; } );
+    return true;
+}
+
+void 
+TriggerScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stopRequested = true;
+    }
+    m_condition.notify_all();
+
+    if ( m_thread.joinable() )
+    {
+        m_thread.join();
+    }
+    m_isRunning = false;
+}
+
+bool 
+TriggerScheduler::requestTrigger( long long deadlineNs )
+{
+    if ( !m_isRunning || m_settings.schedule != SCHEDULE_EXTERNAL )
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_requests.push_back( deadlineNs > 0 ? deadlineNs : getTimeNs() );
+    }
+    m_condition.notify_all();
+    return true;
+}
+
+bool 
+TriggerScheduler::popFire( Fire& fire )
+{
+    return m_fires.pop( fire );
+}
+
+void 
+TriggerScheduler::applyScheduling()
+{
+    std::ostringstream warning;
+    std::string errorMessage;
+
+    if ( m_settings.cpu >= 0 && !realtime::pinCurrentThreadToCpu( m_settings.cpu, errorMessage ) )
+    {
+        warning << "Could not pin the trigger thread to CPU " << m_settings.cpu << ": " << errorMessage << "\n";
+    }
+
+    if ( m_settings.realtimePriority > 0 && 
+        !realtime::setCurrentThreadFifoPriority( m_settings.realtimePriority, errorMessage ) )
+    {
+        warning << "Could not give the trigger thread realtime priority: " << errorMessage << "\n";
+    }
+
+    m_schedulingWarning = warning.str();
+}
+
+long long 
+TriggerScheduler::getScheduledDeadline( unsigned int slot ) const
+{
+    const double period = 1.0 / m_settings.rateHz;
+    double seconds = slot * period;
+    if ( m_settings.schedule == SCHEDULE_BURST )
+    {
+        const unsigned int burst = slot / m_settings.burstCount;
+        seconds = burst * m_settings.burstPeriodSeconds + ( slot % m_settings.burstCount ) * period;
+    }
+
+    // Computed from the start rather than accumulated, so rounding does not drift
+    return m_startNs + llround( seconds * k_nsPerSecond );
+}
+
+bool 
+TriggerScheduler::waitForRequest( long long& deadlineNs )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_condition.wait( lock, [this]() { return m_stopRequested || !m_requests.empty(); } );
+    if ( m_stopRequested )
+    {
+        return false;
+    }
+
+    deadlineNs = m_requests.front();
+    m_requests.pop_front();
+    return true;
+}
+
+bool 
+TriggerScheduler::sleepUntil( long long deadlineNs )
+{
+    const long long wakeNs = deadlineNs - (long long)m_settings.spinMicroseconds * 1000;
+
+    for ( long long now = getTimeNs(); now < wakeNs; now = getTimeNs() )
+    {
+        if ( m_stopRequested )
+        {
+            return false;
+        }
+
+        const long long untilNs = std::min( wakeNs, now + k_maxSleepNs );
+#ifndef _WIN32
+        struct timespec until;
+        until.tv_sec = (time_t)( untilNs / k_nsPerSecond );
+        until.tv_nsec = (long)( untilNs % k_nsPerSecond );
+        while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL ) == EINTR )
+        {
+        }
+#else
+        std::this_thread::sleep_until( std::chrono::steady_clock::time_point( std::chrono::nanoseconds( untilNs ) ) );
+#endif
+    }
+
+    while ( getTimeNs() < deadlineNs )
+    {
+    }
+
+    return !m_stopRequested;
+}
+
+void 
+TriggerScheduler::run()
+{
+    applyScheduling();
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_startNs = getTimeNs();
+        m_isReady = true;
+    }
+    m_condition.notify_all();
+
+    const long long minIntervalNs = llround( m_settings.minIntervalSeconds * k_nsPerSecond );
+    long long lastFiredNs = 0;
+    unsigned int slot = 0;
+
+    while ( m_settings.maxTriggers == 0 || m_numFired < m_settings.maxTriggers )
+    {
+        long long deadlineNs = 0;
+        if ( m_settings.schedule == SCHEDULE_EXTERNAL )
+        {
+            if ( !waitForRequest( deadlineNs ) )
+            {
+                break;
+            }
+            if ( m_numFired > 0 )
+            {
+                deadlineNs = std::max( deadlineNs, lastFiredNs + minIntervalNs );
+            }
+        }
+        else
+        {
+            deadlineNs = getScheduledDeadline( slot );
+        }
+
+        if ( !sleepUntil( deadlineNs ) )
+        {
+            break;
+        }
+
+        // After a stall, fire once for the latest deadline that has passed
+        // instead of catching up with a burst the camera cannot keep up with
+        if ( m_settings.schedule != SCHEDULE_EXTERNAL )
+        {
+            const long long now = getTimeNs();
+            while ( getScheduledDeadline( slot + 1 ) <= now )
+            {
+                slot++;
+                m_numSkipped++;
+            }
+            deadlineNs = getScheduledDeadline( slot );
+            slot++;
+        }
+
+        Fire fire;
+        fire.index = m_numFired;
+        fire.deadlineNs = deadlineNs;
+        fire.firedNs = getTimeNs();
+        const bool isFired = m_fire();
+        fire.returnedNs = getTimeNs();
+
+        if ( !isFired )
+        {
+            m_hasFailed = true;
+            break;
+        }
+
+        lastFiredNs = fire.firedNs;
+        m_lateness.add( ( fire.firedNs - fire.deadlineNs ) / 1000.0 );
+        m_fireDuration.add( ( fire.returnedNs - fire.firedNs ) / 1000.0 );
+        if ( !m_fires.push( fire ) )
+        {
+            m_numDropped++;
+        }
+        m_numFired++;
+    }
+
+    m_isRunning = false;
+}
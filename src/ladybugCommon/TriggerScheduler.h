@@ -0,0 +1,192 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+#ifndef __TRIGGERSCHEDULER_H__
+#define __TRIGGERSCHEDULER_H__
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "LatencyHistogram.h"
+#include "SpscRing.h"
+
+/**
+ * Fires a software trigger from a thread of its own at absolute deadlines
+ * on the monotonic clock, so that the time taken to fire one trigger does
+ * not delay the next. The thread can run with realtime priority on a 
+ * pinned CPU, and records how late each trigger was and how long firing it
+ * took.
+ *
+ * Deadlines come from one of three schedules: a fixed rate, bursts of 
+ * triggers at a fixed rate repeated at a longer period, or requests made 
+ * with requestTrigger() by another thread, e.g. on a time table or each
+ * time the vehicle has covered some distance.
+ */
+class TriggerScheduler
+{
+public:
+    enum Schedule
+    {
+        SCHEDULE_FIXED_RATE,
+        SCHEDULE_BURST,
+        SCHEDULE_EXTERNAL
+    };
+
+    struct Settings
+    {
+        Schedule schedule;
+
+        /** Triggers per second; within a burst for SCHEDULE_BURST. */
+        double rateHz;
+
+        /** Triggers in each burst, and seconds from one burst to the next. */
+        unsigned int burstCount;
+        double burstPeriodSeconds;
+
+        /** 
+         * Least time between triggers for SCHEDULE_EXTERNAL. Requests that
+         * come sooner are fired late rather than overrunning the camera.
+         */
+        double minIntervalSeconds;
+
+        /** Stop after this many triggers, or 0 to run until stop(). */
+        unsigned int maxTriggers;
+
+        /** SCHED_FIFO priority of the thread (1-99), or 0 to leave it as is. */
+        int realtimePriority;
+
+        /** CPU to pin the thread to, or -1 for any. */
+        int cpu;
+
+        /** 
+         * The thread sleeps until this long before each deadline and then
+         * polls the clock, which trades a CPU for less wake-up jitter.
+         */
+        unsigned int spinMicroseconds;
+    };
+
+    /** One trigger, in nanoseconds on the clock of getTimeNs(). */
+    struct Fire
+    {
+        unsigned int index;
+        long long deadlineNs;
+
+        /** Just before and just after the fire function ran. */
+        long long firedNs;
+        long long returnedNs;
+    };
+
+    /** Writes the trigger; returning false stops the scheduler. */
+    typedef std::function<bool()> FireFunction;
+
+    static Settings getDefaultSettings();
+
+    /** Nanoseconds on the monotonic clock. */
+    static long long getTimeNs();
+
+    TriggerScheduler();
+    ~TriggerScheduler();
+
+    /** 
+     * Start firing. Fails on invalid settings. Scheduling settings that 
+     * cannot be applied, usually for lack of privileges, do not stop the
+     * scheduler; they are reported by getSchedulingWarning().
+     */
+    bool start( const Settings& settings, const FireFunction& fire, std::string& errorMessage );
+
+    /** Stop firing and wait for the thread. Safe to call when stopped. */
+    void stop();
+
+    /** False once stopped, after maxTriggers, or after the fire function failed. */
+    bool isRunning() const { return m_isRunning; }
+
+    bool hasFailed() const { return m_hasFailed; }
+
+    /** When the schedule started; deadlines of the fixed schedules count from here. */
+    long long getStartNs() const { return m_startNs; }
+
+    /** 
+     * Queue a trigger for SCHEDULE_EXTERNAL at deadlineNs, or as soon as 
+     * possible if that has passed or is 0. Requests are fired in the order
+     * they are made. May be called from any thread.
+     */
+    bool requestTrigger( long long deadlineNs = 0 );
+
+    /** The triggers fired so far, oldest first. One consumer thread only. */
+    bool popFire( Fire& fire );
+
+    unsigned int getNumFired() const { return m_numFired; }
+
+    /** Deadlines of the fixed schedules that passed before the thread could fire them. */
+    unsigned int getNumSkipped() const { return m_numSkipped; }
+
+    /** Fires that were not recorded because popFire() fell behind. */
+    unsigned int getNumDropped() const { return m_numDropped; }
+
+    const std::string& getSchedulingWarning() const { return m_schedulingWarning; }
+
+    /** How late each trigger fired, and how long the fire function took. Read when stopped. */
+    const LatencyHistogram& getLateness() const { return m_lateness; }
+    const LatencyHistogram& getFireDuration() const { return m_fireDuration; }
+
+private:
+    TriggerScheduler( const TriggerScheduler& );
+    TriggerScheduler& operator=( const TriggerScheduler& );
+
+    void run();
+    void applyScheduling();
+    long long getScheduledDeadline( unsigned int slot ) const;
+    bool waitForRequest( long long& deadlineNs );
+    bool sleepUntil( long long deadlineNs );
+
+    Settings m_settings;
+    FireFunction m_fire;
+    std::thread m_thread;
+    SpscRing<Fire> m_fires;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<long long> m_requests;
+    bool m_isReady;
+    std::atomic<bool> m_stopRequested;
+
+    std::atomic<bool> m_isRunning;
+    std::atomic<bool> m_hasFailed;
+    std::atomic<unsigned int> m_numFired;
+    std::atomic<unsigned int> m_numSkipped;
+    std::atomic<unsigned int> m_numDropped;
+    long long m_startNs;
+    std::string m_schedulingWarning;
+
+    LatencyHistogram m_lateness;
+    LatencyHistogram m_fireDuration;
+};
+
+#endif // __TRIGGERSCHEDULER_H__
@@ -0,0 +1,126 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//=============================================================================
+// $Id$
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "NmeaParser.h"
+
+//
+// libFuzzer driver for the NMEA parser. The input is taken both as a 
+// block of GPS text and as the start of a frame, and every result must
+// stay inside the ranges the parser promises. Any violation aborts, so
+// that the fuzzer keeps the input.
+//
+
+namespace
+{
+    void check( bool condition )
+    {
+        if ( !condition )
+        {
+            abort();
+        }
+    }
+
+    void checkTime( const NmeaTime& time )
+    {
+        check( time.hour <= 23 && time.minute <= 59 && time.second <= 60 && time.millisecond <= 999 );
+    }
+
+    void checkPosition( double latitude, double longitude )
+    {
+        check( latitude >= -90.0 && latitude <= 90.0 );
+        check( longitude >= -180.0 && longitude <= 180.0 );
+    }
+
+    void checkData( const NmeaData& data, unsigned int used )
+    {
+        check( used <= data.numSentences );
+
+        checkTime( data.gga.time );
+        checkPosition( data.gga.latitude, data.gga.longitude );
+        check( data.gga.fixQuality <= 9 && data.gga.satellites <= 99 );
+        check( data.gga.valid == ( data.gga.fixQuality > 0 ) );
+
+        checkTime( data.rmc.time );
+        checkPosition( data.rmc.latitude, data.rmc.longitude );
+        if ( data.rmc.valid )
+        {
+            check( data.rmc.day >= 1 && data.rmc.day <= 31 && data.rmc.month >= 1 && data.rmc.month <= 12 );
+            check( data.rmc.year >= 1980 && data.rmc.year <= 2079 );
+            nmeaParser::getDayNumber( data.rmc.year, data.rmc.month, data.rmc.day );
+        }
+
+        checkTime( data.gll.time );
+        checkPosition( data.gll.latitude, data.gll.longitude );
+
+        check( data.gsa.fixType <= 3 && data.gsa.numSatellites <= 12 );
+
+        double latitude = 0.0;
+        double longitude = 0.0;
+        if ( nmeaParser::getPosition( data, latitude, longitude ) )
+        {
+            checkPosition( latitude, longitude );
+        }
+    }
+}
+
+extern "C" int 
+LLVMFuzzerTestOneInput( const unsigned char* pData, size_t size )
+{
+    // An exact copy, so that reading past the end is caught
+    std::vector<char> text( pData, pData + size );
+    const char* pText = text.empty() ? "" : &text[0];
+
+    // The wide and the byte at a time checksums must agree
+    unsigned char checksum = 0;
+    for ( size_t i = 0; i < size; i++ )
+    {
+        checksum ^= (unsigned char)pText[i];
+    }
+    check( nmeaParser::computeChecksum( pText, size ) == checksum );
+
+    NmeaData data;
+    checkData( data, nmeaParser::parse( pText, size, data ) );
+
+    // The same bytes as the start of a frame
+    LadybugImage image;
+    memset( &image, 0, sizeof(image) );
+    image.pData = text.empty() ? NULL : reinterpret_cast<unsigned char*>( &text[0] );
+    image.uiDataSizeBytes = (unsigned int)size;
+
+    const char* pFound = NULL;
+    size_t length = 0;
+    if ( nmeaParser::findInImage( image, pFound, length ) )
+    {
+        check( pFound >= pText && length <= size - ( pFound - pText ) );
+        checkData( data, nmeaParser::parse( pFound, length, data ) );
+    }
+
+    return 0;
+}
@@ -21,11 +21,17 @@
 
 #ifdef _WIN32
 
+#include <direct.h>
+
 #define TEMPNAM _tempnam
+#define MKDIR(path) _mkdir(path)
 
 #else 
 
+#include <sys/stat.h>
+
 #define TEMPNAM tempnam
+#define MKDIR(path) mkdir(path, 0755)
 
 #endif 
 
@@ -34,6 +40,11 @@ const std::string FILE_EXTENSION = "bmp";
 const std::string TEMP_CAL_FILE = "temp.cal";
 const std::string ERROR_OUTPUT = "Error: Ladybug library reported - %s\n";
 const std::string OUTPUT_FILE_NAME = "%s\\ladybug_cube_%06u_%d.%s";
+const std::string ARCHIVE_ENTRY_NAME = "ladybug_cube_%06u_%d.%s";
+
+// Frame, level, face, row and column, in the layout of Marzipano tiles
+const std::string TILE_NAME = "%06u/%u/%c/%u/%u.jpg";
+const char TILE_FACE_NAMES[] = { 'f', 'r', 'b', 'l', 'u', 'd' };
 
 const float FIELD_OF_VIEW = 90.0f;
 const float TRANSLATION = 0.0f;
@@ -98,7 +109,19 @@ CubeMap::CubeMap(std::string inputFile, std::string outputDir, int outputDimensi
 {
     m_readData.filePath = inputFile;
     m_renderData.outputDirectory = outputDir;
+    m_renderData.outputDimension = outputDimension;
     
+    if (frameArchive::isArchivePath(outputDir))
+    {
+        std::string errorMessage;
+        m_frameArchive.reset(new FrameArchiveWriter());
+        if (!m_frameArchive->open(outputDir, errorMessage))
+        {
+            std::cout << "Error: " << errorMessage << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        m_outputEncoder.setArchive(m_frameArchive.get());
+    }
 
     std::string tempPathString = getTempName(TEMP_CAL_FILE);
 
@@ -183,48 +206,202 @@ CubeMap::~CubeMap()
     }
 }
 
-LadybugError CubeMap::SaveCubeFrame(unsigned int frameIndex, LadybugDataFormat imageDataFormat)
+void CubeMap::UseCpuDebayer(unsigned int numThreads)
 {
-    LadybugError error = LADYBUG_OK;
-    LadybugSaveFileFormat fileFormat = LADYBUG_FILEFORMAT_BMP;
-    
-    for (int surface = FRONT; surface < NUMBER_OF_SURFACES; surface++)
+    m_debayerEngine.reset(new DebayerEngine(numThreads));
+
+    std::cout << "Color processing on the CPU with " << m_debayerEngine->getNumThreads() << " threads ("
+        << (m_debayerEngine->getUseAvx2() ? "AVX2" : "portable") << " kernels)." << std::endl;
+}
+
+void CubeMap::SelectCameras(const CameraSelection& cameraSelection)
+{
+    m_cameraSelection = cameraSelection;
+
+    std::cout << "Processing " << m_cameraSelection.describe() << "." << std::endl;
+}
+
+void CubeMap::UsePyramid(unsigned int tileSize, TilePyramid::Filter filter)
+{
+    m_tilePyramid.reset(new TilePyramid(tileSize, filter));
+
+    std::cout << "Writing faces as " << tileSize << " pixel tiles, downsampled with the " 
+        << (filter == TilePyramid::FILTER_LANCZOS ? "Lanczos" : "box") << " filter." << std::endl;
+}
+
+void CubeMap::UsePanoramaFaces(unsigned int numThreads)
+{
+    // Four faces around the equator keep the resolution of the faces
+    const unsigned int panoramaWidth = m_renderData.outputDimension * 4;
+    const unsigned int panoramaHeight = m_renderData.outputDimension * 2;
+
+    LadybugError error = ladybugConfigureOutputImages(m_renderData.context, LADYBUG_PANORAMIC);
+    HandleError(error);
+
+    error = ladybugSetOffScreenImageSize(m_renderData.context, LADYBUG_PANORAMIC, panoramaWidth, panoramaHeight);
+    HandleError(error);
+
+    m_faceResampler.reset(new CubeFaceResampler(numThreads));
+    m_faceResampler->initialize(panoramaWidth, panoramaHeight, m_renderData.outputDimension);
+
+    std::cout << "Cutting faces from a " << panoramaWidth << "x" << panoramaHeight << " panorama with " 
+        << m_faceResampler->getNumThreads() << " threads (" << (m_faceResampler->getUseAvx2() ? "AVX2" : "portable") << " kernels)." << std::endl;
+}
+
+std::string CubeMap::GetTilePath(unsigned int frameIndex, int surface, unsigned int level, unsigned int row, unsigned int column)
+{
+    char tileName[100];
+    sprintf(tileName, TILE_NAME.c_str(), frameIndex, level, TILE_FACE_NAMES[surface], row, column);
+
+    if (m_frameArchive)
     {
-        float rot_x = 0.0;
-        float rot_y = 0.0;
-        float rot_z = 0.0;
+        return tileName;
+    }
 
-        switch (surface)
+    const std::string path = m_renderData.outputDirectory + "/" + tileName;
+    MakeParentDirectories(path);
+    return path;
+}
+
+void CubeMap::MakeParentDirectories(const std::string& path)
+{
+    const size_t end = path.find_last_of("/\\");
+    if (end == std::string::npos || end == 0)
+    {
+        return;
+    }
+
+    const std::string directory = path.substr(0, end);
+    if (m_createdDirectories.count(directory) > 0)
+    {
+        return;
+    }
+
+    MakeParentDirectories(directory);
+    MKDIR(directory.c_str());
+    m_createdDirectories.insert(directory);
+}
+
+LadybugError CubeMap::ConvertImage(LadybugImage& image, LadybugPixelFormat pixelFormat, unsigned char** activeBuffers)
+{
+    if (!m_debayerEngine || !DebayerEngine::isSupported(image.dataFormat))
+    {
+        return ladybugConvertImage(
+            m_renderData.context, 
+            &image, 
+            activeBuffers,
+            pixelFormat);
+    }
+
+    // The library converts the first image so its alpha masks can be reused
+    if (!m_debayerEngine->hasAlphaMask(0))
+    {
+        LadybugError error = ladybugConvertImage(
+            m_renderData.context, 
+            &image, 
+            &m_renderData.textureBuffers[0],
+            pixelFormat);
+        HandleError(error);
+
+        for (unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++)
         {
-            case FRONT: rot_x = 0.0f; rot_y = 0.0f; rot_z = 0.0f; break;
-            case RIGHT: rot_x = 0.0f; rot_y = 0.0f; rot_z = 90.0f; break;
-            case BACK: rot_x = 0.0f; rot_y = 0.0f; rot_z = 180.0f; break;
-            case LEFT: rot_x = 0.0f; rot_y = 0.0f; rot_z = 270.0f; break;
-            case TOP: rot_x = 180.0f; rot_y = 90.0f; rot_z = 0.0f; break;
-            case BOTTOM: rot_x = 180.0f; rot_y = 270.0f; rot_z = 0.0f; break;
+            m_debayerEngine->setAlphaMaskFromTexture(
+                camera, m_renderData.textureBuffers[camera], image.uiCols, image.uiRows, pixelFormat);
         }
-        
-        error = ladybugSetSphericalViewParams(
-            m_renderData.context,
-            FIELD_OF_VIEW,
-            DegreesToRadians(rot_x),
-            DegreesToRadians(rot_y),
-            DegreesToRadians(rot_z),
-            TRANSLATION,
-            TRANSLATION,
-            TRANSLATION);
-        HandleError(error);
+    }
 
-        LadybugProcessedImage procImage;
-        error = ladybugRenderOffScreenImage(
-            m_renderData.context,
-            LADYBUG_SPHERICAL,
-            IsHighBitDepth(imageDataFormat) ? LADYBUG_BGR16 : LADYBUG_BGR,
-            &procImage);
-        HandleError(error);
-        
-        
-        char fileName[100];
+    return m_debayerEngine->convert(
+        image, 
+        DebayerEngine::METHOD_HQ_LINEAR, 
+        activeBuffers, 
+        pixelFormat);
+}
+
+LadybugError CubeMap::RenderFace(int surface, LadybugDataFormat imageDataFormat, LadybugProcessedImage& procImage)
+{
+    float rot_x = 0.0;
+    float rot_y = 0.0;
+    float rot_z = 0.0;
+
+    switch (surface)
+    {
+        case FRONT: rot_x = 0.0f; rot_y = 0.0f; rot_z = 0.0f; break;
+        case RIGHT: rot_x = 0.0f; rot_y = 0.0f; rot_z = 90.0f; break;
+        case BACK: rot_x = 0.0f; rot_y = 0.0f; rot_z = 180.0f; break;
+        case LEFT: rot_x = 0.0f; rot_y = 0.0f; rot_z = 270.0f; break;
+        case TOP: rot_x = 180.0f; rot_y = 90.0f; rot_z = 0.0f; break;
+        case BOTTOM: rot_x = 180.0f; rot_y = 270.0f; rot_z = 0.0f; break;
+    }
+    
+    LadybugError error = ladybugSetSphericalViewParams(
+        m_renderData.context,
+        FIELD_OF_VIEW,
+        DegreesToRadians(rot_x),
+        DegreesToRadians(rot_y),
+        DegreesToRadians(rot_z),
+        TRANSLATION,
+        TRANSLATION,
+        TRANSLATION);
+    HandleError(error);
+
+    return ladybugRenderOffScreenImage(
+        m_renderData.context,
+        LADYBUG_SPHERICAL,
+        IsHighBitDepth(imageDataFormat) ? LADYBUG_BGR16 : LADYBUG_BGR,
+        &procImage);
+}
+
+LadybugError CubeMap::ResampleFaces(LadybugDataFormat imageDataFormat)
+{
+    const LadybugPixelFormat pixelFormat = IsHighBitDepth(imageDataFormat) ? LADYBUG_BGRU16 : LADYBUG_BGRU;
+
+    LadybugProcessedImage panorama;
+    LadybugError error = ladybugRenderOffScreenImage(
+        m_renderData.context,
+        LADYBUG_PANORAMIC,
+        pixelFormat,
+        &panorama);
+    HandleError(error);
+
+    // The surfaces are in the order of the resampler's faces
+    unsigned char* faces[NUMBER_OF_SURFACES];
+    const size_t faceBytes = (size_t)m_renderData.outputDimension * m_renderData.outputDimension * NUMBER_OF_IMAGE_CHANNELS * (pixelFormat == LADYBUG_BGRU16 ? 2 : 1);
+    for (int surface = FRONT; surface < NUMBER_OF_SURFACES; surface++)
+    {
+        m_faceBuffers[surface].resize(faceBytes);
+        faces[surface] = &m_faceBuffers[surface][0];
+    }
+
+    return m_faceResampler->resample(panorama, faces) ? LADYBUG_OK : LADYBUG_FAILED;
+}
+
+LadybugError CubeMap::SaveFace(unsigned int frameIndex, int surface, const LadybugProcessedImage& procImage)
+{
+    if (m_tilePyramid)
+    {
+        const bool submitted = m_tilePyramid->write(
+            procImage,
+            [this, frameIndex, surface](unsigned int level, unsigned int row, unsigned int column)
+            {
+                return GetTilePath(frameIndex, surface, level, row, column);
+            },
+            m_outputEncoder,
+            OutputEncoder::FORMAT_JPEG);
+        return submitted ? LADYBUG_OK : LADYBUG_FAILED;
+    }
+
+    char fileName[100];
+    if (m_frameArchive)
+    {
+        sprintf(
+            fileName,
+            ARCHIVE_ENTRY_NAME.c_str(),
+            frameIndex,
+            surface,
+            FILE_EXTENSION.c_str());
+    }
+    else
+    {
         sprintf(
             fileName,
             OUTPUT_FILE_NAME.c_str(),
@@ -232,14 +409,38 @@ LadybugError CubeMap::SaveCubeFrame(unsigned int frameIndex, LadybugDataFormat i
             frameIndex,
             surface,
             FILE_EXTENSION.c_str());
+    }
 
+    return m_outputEncoder.submit(procImage, fileName, OutputEncoder::FORMAT_BMP) ? LADYBUG_OK : LADYBUG_FAILED;
+}
 
-        error = ladybugSaveImage(
-            m_renderData.context, 
-            &procImage, 
-            fileName, 
-            fileFormat, 
-            false);
+LadybugError CubeMap::SaveCubeFrame(unsigned int frameIndex, LadybugDataFormat imageDataFormat)
+{
+    LadybugError error = LADYBUG_OK;
+
+    if (m_faceResampler)
+    {
+        error = ResampleFaces(imageDataFormat);
+        HandleError(error);
+    }
+    
+    for (int surface = FRONT; surface < NUMBER_OF_SURFACES; surface++)
+    {
+        LadybugProcessedImage procImage;
+        if (m_faceResampler)
+        {
+            procImage.uiCols = m_renderData.outputDimension;
+            procImage.uiRows = m_renderData.outputDimension;
+            procImage.pData = &m_faceBuffers[surface][0];
+            procImage.pixelFormat = IsHighBitDepth(imageDataFormat) ? LADYBUG_BGRU16 : LADYBUG_BGRU;
+        }
+        else
+        {
+            error = RenderFace(surface, imageDataFormat, procImage);
+            HandleError(error);
+        }
+
+        error = SaveFace(frameIndex, surface, procImage);
         HandleError(error);
     }
     
@@ -251,11 +452,12 @@ LadybugError CubeMap::ProcessStream()
     LadybugError error = LADYBUG_OK;
     LadybugImage currentImage;
 
+    // The constructor read the first image; after that, read in order
+    error = ladybugGoToImage(m_readData.context, 0);
+    HandleError(error);
+
     for (unsigned int frameIndex = 0; frameIndex < m_readData.numberOfFrames; frameIndex++)
     {
-        error = ladybugGoToImage(m_readData.context, frameIndex);
-        HandleError(error);
-
         error = ladybugReadImageFromStream(
             m_readData.context,
             &currentImage);
@@ -263,23 +465,54 @@ LadybugError CubeMap::ProcessStream()
 
         const LadybugPixelFormat pixelFormatToUse = IsHighBitDepth(currentImage.dataFormat) ? LADYBUG_BGRU16 : LADYBUG_BGRU;
 
-        error = ladybugConvertImage(
-            m_renderData.context, 
-            &currentImage, 
-            &m_renderData.textureBuffers[0],
-            pixelFormatToUse);
+        unsigned char* activeBuffers[LADYBUG_NUM_CAMERAS];
+        m_cameraSelection.getActiveBuffers(&m_renderData.textureBuffers[0], activeBuffers);
+
+        error = ConvertImage(currentImage, pixelFormatToUse, activeBuffers);
         HandleError(error);
 
+        m_cameraSelection.applyFill(&m_renderData.textureBuffers[0], m_readData.width, m_readData.height, pixelFormatToUse);
+
         error = ladybugUpdateTextures(
             m_renderData.context, 
             LADYBUG_NUM_CAMERAS, 
-            (const unsigned char**) &m_renderData.textureBuffers[0],
+            (const unsigned char**) activeBuffers,
             pixelFormatToUse);
         HandleError(error);
         
         error = SaveCubeFrame(frameIndex, currentImage.dataFormat);
         HandleError(error);
 
+        if (m_outputEncoder.getNumFailed() > 0)
+        {
+            break;
+        }
+    }
+
+    m_outputEncoder.waitAll();
+    if (m_outputEncoder.getNumFailed() > 0)
+    {
+        std::cout << "Error: unable to write " << m_outputEncoder.getLastFailedPath() << std::endl;
+        return LADYBUG_FAILED;
+    }
+
+    if (m_outputEncoder.getNumWritten() > 0)
+    {
+        std::cout << "Encoded " << m_outputEncoder.getNumWritten() << " images on " << m_outputEncoder.getNumThreads() 
+            << " threads in " << m_outputEncoder.getEncodeSeconds() * 1000.0 / m_outputEncoder.getNumWritten() << " ms each" << std::endl;
+    }
+
+    if (m_tilePyramid && m_readData.numberOfFrames > 0)
+    {
+        std::cout << "Cut " << m_tilePyramid->getNumTiles() << " tiles, downsampling in " 
+            << m_tilePyramid->getDownsampleSeconds() * 1000.0 / (m_readData.numberOfFrames * NUMBER_OF_SURFACES) << " ms per face" << std::endl;
+    }
+
+    std::string errorMessage;
+    if (m_frameArchive && !m_frameArchive->close(errorMessage))
+    {
+        std::cout << "Error: " << errorMessage << std::endl;
+        return LADYBUG_FAILED;
     }
 
     return error;
@@ -19,6 +19,14 @@
 
 #include "ladybug.h"
 #include "ladybugstream.h"
+#include "CameraSelection.h"
+#include "CubeFaceResampler.h"
+#include "DebayerEngine.h"
+#include "FrameArchive.h"
+#include "OutputEncoder.h"
+#include "TilePyramid.h"
+#include <memory>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -30,6 +38,19 @@ public:
     
     LadybugError ProcessStream();
 
+    // Color process on the CPU instead of the library (0 threads = one per CPU)
+    void UseCpuDebayer(unsigned int numThreads);
+
+    // Convert and upload only the selected cameras after the first frame
+    void SelectCameras(const CameraSelection& cameraSelection);
+
+    // Write each face as a pyramid of JPEG tiles instead of one image
+    void UsePyramid(unsigned int tileSize, TilePyramid::Filter filter);
+
+    // Render one panorama per frame and cut the faces out of it on the 
+    // CPU, instead of rendering six spherical views (0 threads = one per CPU)
+    void UsePanoramaFaces(unsigned int numThreads);
+
 private:
     
     enum Surface { FRONT, RIGHT, BACK, LEFT, TOP, BOTTOM, NUMBER_OF_SURFACES };
@@ -50,10 +71,33 @@ private:
         LadybugContext context;
         std::vector<unsigned char*> textureBuffers;
         std::string outputDirectory;
+        int outputDimension;
 
     } m_renderData;
 
+    std::unique_ptr<DebayerEngine> m_debayerEngine;
+    CameraSelection m_cameraSelection;
+
+    // Set when the output directory is a frame archive (.lba)
+    std::unique_ptr<FrameArchiveWriter> m_frameArchive;
+
+    // Writes the faces while the next ones are rendered; declared after
+    // the archive so that it is destroyed first
+    OutputEncoder m_outputEncoder;
+
+    std::unique_ptr<TilePyramid> m_tilePyramid;
+    std::set<std::string> m_createdDirectories;
+
+    std::unique_ptr<CubeFaceResampler> m_faceResampler;
+    std::vector<unsigned char> m_faceBuffers[NUMBER_OF_SURFACES];
+
+    LadybugError ConvertImage(LadybugImage&, LadybugPixelFormat, unsigned char**);
     LadybugError SaveCubeFrame(unsigned int, LadybugDataFormat);
+    LadybugError RenderFace(int, LadybugDataFormat, LadybugProcessedImage&);
+    LadybugError ResampleFaces(LadybugDataFormat);
+    LadybugError SaveFace(unsigned int, int, const LadybugProcessedImage&);
+    std::string GetTilePath(unsigned int, int, unsigned int, unsigned int, unsigned int);
+    void MakeParentDirectories(const std::string&);
 
 };
 
@@ -25,8 +25,24 @@
 #include <stdlib.h>
 #include "CubeMap.h"
 
-enum ArgPositions { INPUT_FILE_ARG = 1, OUTPUT_DIR_ARG, OUTPUT_DIMENSION, NUM_OF_ARGS };
-const std::string USAGE = "ladybugCubeMap [INPUT_FILE] [OUTPUT_DIRECTORY] [OUTPUT_DIMENSION]";
+enum ArgPositions { INPUT_FILE_ARG = 1, OUTPUT_DIR_ARG, OUTPUT_DIMENSION, NUM_OF_ARGS, CPU_DEBAYER_THREADS_ARG = NUM_OF_ARGS, CAMERAS_ARG, TILES_ARG, FACES_ARG };
+const std::string USAGE = 
+    "ladybugCubeMap [INPUT_FILE] [OUTPUT_DIRECTORY] [OUTPUT_DIMENSION] [CPU_DEBAYER_THREADS] [CAMERAS[:FILL]]\n"
+    "               [TILE_SIZE[:FILTER]] [FACES[:THREADS]]\n"
+    "  CPU_DEBAYER_THREADS is optional. When given, RAW streams are color processed\n"
+    "  on the CPU with that many threads (0 for one per CPU). Use - for the library.\n"
+    "  CAMERAS is optional and lists the cameras to process, e.g. 01234. The others\n"
+    "  are converted for the first frame only and then show FILL: blur (default),\n"
+    "  gray or black. Use - for all cameras.\n"
+    "  TILE_SIZE is optional. When given, each face is written as a pyramid of\n"
+    "  JPEG tiles of that size for web viewers, as FRAME/LEVEL/FACE/ROW/COLUMN.jpg\n"
+    "  with level 0 the smallest. Lower levels are downsampled with FILTER: lanczos\n"
+    "  (default) or box. Use - for whole faces.\n"
+    "  FACES is optional: spherical (default) renders six views per frame, panorama\n"
+    "  renders one panorama and cuts the faces out of it on the CPU with THREADS\n"
+    "  threads (default 0, one per CPU).\n"
+    "  An OUTPUT_DIRECTORY ending in .lba is a frame archive that all faces are\n"
+    "  written to instead. Use ladybugFrameArchive to read it.";
 
 
 namespace
@@ -36,6 +52,57 @@ namespace
         std::cout << USAGE << std::endl;
     }
 
+    // TILE_SIZE[:FILTER]
+    bool ParseTiles(const std::string& argument, unsigned int& tileSize, TilePyramid::Filter& filter)
+    {
+        const size_t separator = argument.find(':');
+        tileSize = (unsigned int)atoi(argument.substr(0, separator).c_str());
+        if (tileSize == 0)
+        {
+            return false;
+        }
+
+        if (separator == std::string::npos)
+        {
+            return true;
+        }
+
+        const std::string filterName = argument.substr(separator + 1);
+        if (filterName == "lanczos")
+        {
+            filter = TilePyramid::FILTER_LANCZOS;
+        }
+        else if (filterName == "box")
+        {
+            filter = TilePyramid::FILTER_BOX;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // spherical or panorama[:THREADS]
+    bool ParseFaces(const std::string& argument, bool& usePanorama, unsigned int& numThreads)
+    {
+        const size_t separator = argument.find(':');
+        const std::string method = argument.substr(0, separator);
+        if (method == "spherical" && separator == std::string::npos)
+        {
+            usePanorama = false;
+            return true;
+        }
+        if (method != "panorama")
+        {
+            return false;
+        }
+
+        usePanorama = true;
+        numThreads = separator == std::string::npos ? 0 : (unsigned int)atoi(argument.substr(separator + 1).c_str());
+        return true;
+    }
+
     void verifyArguments(int numOfArguments)
     {
         if (numOfArguments < NUM_OF_ARGS)
@@ -54,7 +121,46 @@ int main(int  argc , char* argv[])
     const std::string inputFile = argv[INPUT_FILE_ARG];
     const std::string outputDirectory = argv[OUTPUT_DIR_ARG];
 
+    CameraSelection cameraSelection;
+    if (argc > CAMERAS_ARG && std::string(argv[CAMERAS_ARG]) != "-" && !cameraSelection.parse(argv[CAMERAS_ARG]))
+    {
+        PrintUsage();
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int tileSize = 0;
+    TilePyramid::Filter tileFilter = TilePyramid::FILTER_LANCZOS;
+    if (argc > TILES_ARG && std::string(argv[TILES_ARG]) != "-" && !ParseTiles(argv[TILES_ARG], tileSize, tileFilter))
+    {
+        PrintUsage();
+        exit(EXIT_FAILURE);
+    }
+
+    bool usePanoramaFaces = false;
+    unsigned int faceThreads = 0;
+    if (argc > FACES_ARG && !ParseFaces(argv[FACES_ARG], usePanoramaFaces, faceThreads))
+    {
+        PrintUsage();
+        exit(EXIT_FAILURE);
+    }
+
     CubeMap cubeMap(inputFile, outputDirectory, outputDimension);
+    if (argc > CPU_DEBAYER_THREADS_ARG && std::string(argv[CPU_DEBAYER_THREADS_ARG]) != "-")
+    {
+        cubeMap.UseCpuDebayer(atoi(argv[CPU_DEBAYER_THREADS_ARG]));
+    }
+    if (!cameraSelection.isAllSelected())
+    {
+        cubeMap.SelectCameras(cameraSelection);
+    }
+    if (tileSize > 0)
+    {
+        cubeMap.UsePyramid(tileSize, tileFilter);
+    }
+    if (usePanoramaFaces)
+    {
+        cubeMap.UsePanoramaFaces(faceThreads);
+    }
     cubeMap.ProcessStream();
 
 
@@ -28,8 +28,16 @@
 //  - query the compass sensor
 //  - query the accelerometer sensor
 //  - query the gyroscope sensor
+//  - optionally, log all sensors while grabbing images
 //  - destroy the context
 //
+// Usage: ladybugEnvironmentalSensors [SECONDS [LOG_FILE]]
+//
+// With SECONDS, the sensors are polled in the background for that long 
+// while images are grabbed, and logged to LOG_FILE (ladybugSensors.sensors
+// by default) on the camera clock. The readings during one of the frames
+// are then read back from the log.
+//
 //=============================================================================
 
 // This is needed for math.h constants like M_PI in MSVC.
@@ -40,8 +48,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
+#include <vector>
 #include "ladybug.h"
 #include "ladybugsensors.h"
+#include "CameraClock.h"
+#include "SensorLog.h"
 
 
 void temperatureExample(LadybugContext context);
@@ -50,12 +62,13 @@ void barometerExample(LadybugContext context);
 void compassExample(LadybugContext context);
 void accelerometerExample(LadybugContext context);
 void gyroscopeExample(LadybugContext context);
+void loggingExample(LadybugContext context, double seconds, const char* logPath);
 float compassHeading(float x, float y, float z);
 float RadToDeg(float x);
 void printSensorInfo(const LadybugSensorInfo & info);
 void handleError(LadybugError error, const char* message = NULL);
 
-int main( int /* argc */, char** /* argv[] */ )
+int main( int argc, char** argv )
 {    
     // Initialize context.
     LadybugContext context;
@@ -80,6 +93,11 @@ int main( int /* argc */, char** /* argv[] */ )
 	accelerometerExample(context);
 	gyroscopeExample(context);
 
+	if ( argc > 1 )
+	{
+		loggingExample(context, atof(argv[1]), argc > 2 ? argv[2] : "ladybugSensors.sensors");
+	}
+
     // Destroy the context
     printf( "Destroying context...\n" );
     error = ::ladybugDestroyContext(&context);
@@ -285,6 +303,88 @@ void gyroscopeExample(LadybugContext context)
 	printf("\n");
 }
 
+void loggingExample(LadybugContext context, double seconds, const char* logPath)
+{
+	printf("Logging sensors for %.1f seconds to %s...\n", seconds, logPath);
+
+	LadybugError error = ladybugStart( context, LADYBUG_DATAFORMAT_RAW8 );
+	handleError( error, "ladybugStart()" );
+
+	SensorLogger logger;
+	std::string errorMessage;
+	if ( !logger.start( context, logPath, 0.0, errorMessage ) )
+	{
+		printf("    %s\n\n", errorMessage.c_str());
+		ladybugStop( context );
+		return;
+	}
+
+	// Report the camera time of each image to the logger as soon as it 
+	// arrives; here every image is also a frame of the log.
+	CameraClock clock;
+	unsigned int numFrames = 0;
+	double elapsed = 0.0;
+	unsigned long long firstTick = 0;
+	while ( elapsed < seconds )
+	{
+		LadybugImage image;
+		error = ladybugGrabImage( context, &image );
+		handleError( error, "ladybugGrabImage()" );
+
+		const unsigned long long tick = clock.addImage( image );
+		logger.addImage( tick );
+		logger.addFrame( numFrames, tick );
+		if ( numFrames++ == 0 )
+		{
+			firstTick = tick;
+		}
+		elapsed = CameraClock::toSeconds( tick - firstTick );
+	}
+
+	if ( !logger.stop( errorMessage ) )
+	{
+		printf("    %s\n", errorMessage.c_str());
+	}
+	ladybugStop( context );
+
+	const SensorLogger::Statistics statistics = logger.getStatistics();
+	for ( unsigned int sensor = 0; sensor < sensorLog::NUM_SENSORS; sensor++ )
+	{
+		if ( statistics.samples[sensor] > 0 )
+		{
+			printf("    %-13s: %llu readings, %.1f Hz\n", sensorLog::getSensorName( (sensorLog::Sensor)sensor ),
+				statistics.samples[sensor], statistics.samples[sensor] / statistics.seconds);
+		}
+	}
+	printf("    Lost readings: %llu\n", statistics.dropped + statistics.readErrors);
+
+	// Read the gyroscope during the middle frame back from the log
+	SensorLogReader reader;
+	if ( !reader.open( logPath, errorMessage ) )
+	{
+		printf("    %s\n\n", errorMessage.c_str());
+		return;
+	}
+
+	const unsigned int frame = reader.getNumFrames() / 2;
+	std::vector<SensorSample> samples;
+	if ( reader.getFrameWindow( frame, sensorLog::SENSOR_GYROSCOPE, samples ) && !samples.empty() )
+	{
+		LadybugTriplet mean = { 0.0f, 0.0f, 0.0f };
+		for ( size_t i = 0; i < samples.size(); i++ )
+		{
+			mean.x += samples[i].x / samples.size();
+			mean.y += samples[i].y / samples.size();
+			mean.z += samples[i].z / samples.size();
+		}
+		printf("    Gyroscope during frame %u: %u readings, mean %e, %e, %e\n", 
+			frame, (unsigned int)samples.size(), mean.x, mean.y, mean.z);
+	}
+
+	// Newline at end.
+	printf("\n");
+}
+
 void printSensorInfo(const LadybugSensorInfo & info)
 {
 	printf("    isSupported       : %s\n", info.isSupported ? "true" : "false");
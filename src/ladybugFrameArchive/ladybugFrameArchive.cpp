@@ -0,0 +1,228 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//
+// ladybugFrameArchive.cpp
+// 
+// This program lists, extracts and repairs the frame archives (.lba) that 
+// ladybugProcessStream and ladybugCubeMap write when their output path
+// ends in .lba. An archive holds the images of a whole run in one file, 
+// under the names they would have had as separate files.
+//
+// An archive whose writer was killed has no index. It can still be read,
+// since the index is rebuilt by scanning it, and "repair" writes the index
+// so that later reads do not need the scan.
+//
+//=============================================================================
+
+#include <cstdio>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include "FrameArchive.h"
+
+namespace
+{
+    bool writeFile( const std::string& path, const std::vector<unsigned char>& data )
+    {
+        FILE* pFile = fopen( path.c_str(), "wb" );
+        if ( pFile == NULL )
+        {
+            return false;
+        }
+
+        const bool isWritten = data.empty() || fwrite( &data[0], 1, data.size(), pFile ) == data.size();
+        return fclose( pFile ) == 0 && isWritten;
+    }
+
+    bool openArchive( const char* pszPath, FrameArchiveReader& reader )
+    {
+        std::string errorMessage;
+        if ( !reader.open( pszPath, errorMessage ) )
+        {
+            printf( "Error! %s\n", errorMessage.c_str() );
+            return false;
+        }
+
+        if ( reader.isRecovered() )
+        {
+            fprintf( stderr, "%s was not closed; found %u complete entries by scanning it\n", 
+                pszPath, reader.getNumEntries() );
+        }
+        return true;
+    }
+
+    int listEntries( const char* pszPath )
+    {
+        FrameArchiveReader reader;
+        if ( !openArchive( pszPath, reader ) )
+        {
+            return 1;
+        }
+
+        unsigned long long totalBytes = 0;
+        for ( unsigned int i = 0; i < reader.getNumEntries(); i++ )
+        {
+            const frameArchive::Entry& entry = reader.getEntry( i );
+            printf( "%12llu %12llu  %s\n", entry.dataOffset, entry.dataSize, entry.name.c_str() );
+            totalBytes += entry.dataSize;
+        }
+
+        printf( "%u entries, %llu bytes\n", reader.getNumEntries(), totalBytes );
+        return 0;
+    }
+
+    int extractEntries( const char* pszPath, const std::string& directory, int numNames, char* names[] )
+    {
+        FrameArchiveReader reader;
+        if ( !openArchive( pszPath, reader ) )
+        {
+            return 1;
+        }
+
+        // Every entry, or only the named ones
+        std::vector<unsigned int> indices;
+        for ( int i = 0; i < numNames; i++ )
+        {
+            unsigned int index = 0;
+            if ( !reader.find( names[i], index ) )
+            {
+                printf( "Error! %s is not in %s\n", names[i], pszPath );
+                return 1;
+            }
+            indices.push_back( index );
+        }
+        if ( numNames == 0 )
+        {
+            for ( unsigned int i = 0; i < reader.getNumEntries(); i++ )
+            {
+                indices.push_back( i );
+            }
+        }
+
+        std::vector<unsigned char> data;
+        for ( size_t i = 0; i < indices.size(); i++ )
+        {
+            const frameArchive::Entry& entry = reader.getEntry( indices[i] );
+            const std::string outputPath = directory + "/" + entry.name;
+
+            std::string errorMessage;
+            if ( !reader.read( indices[i], data, errorMessage ) )
+            {
+                printf( "Error! %s\n", errorMessage.c_str() );
+                return 1;
+            }
+            if ( !writeFile( outputPath, data ) )
+            {
+                printf( "Error! Unable to write %s\n", outputPath.c_str() );
+                return 1;
+            }
+        }
+
+        printf( "Extracted %u entries to %s\n", (unsigned int)indices.size(), directory.c_str() );
+        return 0;
+    }
+
+    int printEntry( const char* pszPath, const char* pszName )
+    {
+        FrameArchiveReader reader;
+        if ( !openArchive( pszPath, reader ) )
+        {
+            return 1;
+        }
+
+        unsigned int index = 0;
+        std::vector<unsigned char> data;
+        std::string errorMessage;
+        if ( !reader.find( pszName, index ) )
+        {
+            fprintf( stderr, "Error! %s is not in %s\n", pszName, pszPath );
+            return 1;
+        }
+        if ( !reader.read( index, data, errorMessage ) )
+        {
+            fprintf( stderr, "Error! %s\n", errorMessage.c_str() );
+            return 1;
+        }
+
+#ifdef _WIN32
+        _setmode( _fileno( stdout ), _O_BINARY );
+#endif
+        return data.empty() || fwrite( &data[0], 1, data.size(), stdout ) == data.size() ? 0 : 1;
+    }
+
+    int repairArchive( const char* pszPath )
+    {
+        FrameArchiveWriter writer;
+        std::string errorMessage;
+        if ( !writer.resume( pszPath, errorMessage ) || !writer.close( errorMessage ) )
+        {
+            printf( "Error! %s\n", errorMessage.c_str() );
+            return 1;
+        }
+
+        printf( "Wrote the index of %s with %u entries\n", pszPath, writer.getNumEntries() );
+        return 0;
+    }
+}
+
+void usage()
+{
+    printf (
+        "Usage :\n"
+        "\t ladybugFrameArchive list ARCHIVE\n"
+        "\t ladybugFrameArchive extract ARCHIVE DIRECTORY [NAME ...]\n"
+        "\t ladybugFrameArchive cat ARCHIVE NAME\n"
+        "\t ladybugFrameArchive repair ARCHIVE\n"
+        "\n"
+        "where\n"
+        "\t list - prints the offset, size and name of every entry\n"
+        "\t extract - writes the named entries, or all of them, to files in DIRECTORY\n"
+        "\t cat - writes one entry to the standard output\n"
+        "\t repair - drops a torn last entry and writes the index of an archive\n"
+        "\t that was not closed\n"
+        "\n"
+        );
+}
+
+int main(int argc, char* argv[])
+{
+    if ( argc >= 3 && strcmp( argv[1], "list" ) == 0 )
+    {
+        return listEntries( argv[2] );
+    }
+    else if ( argc >= 4 && strcmp( argv[1], "extract" ) == 0 )
+    {
+        return extractEntries( argv[2], argv[3], argc - 4, argv + 4 );
+    }
+    else if ( argc == 4 && strcmp( argv[1], "cat" ) == 0 )
+    {
+        return printEntry( argv[2], argv[3] );
+    }
+    else if ( argc == 3 && strcmp( argv[1], "repair" ) == 0 )
+    {
+        return repairArchive( argv[2] );
+    }
+
+    usage();
+    return 0;
+}
@@ -16,6 +16,11 @@
 //=============================================================================
 
 #include "GPSInsert.h"
+#include "ladybugGPS.h"
+#include "NmeaParser.h"
+#include "StreamSegment.h"
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <limits>
 
@@ -35,6 +40,16 @@ namespace
     const std::string TMP_CONFIG_FILE = "config";
     const unsigned int NO_FRAME = std::numeric_limits<unsigned int>::max();
 
+    // Frames further than this from a log record, or inside a longer gap
+    // in the log, are copied without GPS data
+    const double MAX_LOG_GAP_SECONDS = 2.0;
+
+    // The SDK writes through the page cache; start writeback in chunks this large
+    const unsigned int WRITEBACK_CHUNK_MB = 64;
+
+    const double EARTH_RADIUS_METERS = 6371000.0;
+    const double PI = 3.14159265358979323846;
+
     std::string getTempName(std::string fallBackName)
     {
         char* tempPath = NULL;
@@ -55,6 +70,162 @@ namespace
         return tempPathString;
     }
 
+    void CivilFromDays(long days, int& year, unsigned int& month, unsigned int& day)
+    {
+        days += 719468;
+        const long era = (days >= 0 ? days : days - 146096) / 146097;
+        const unsigned int dayOfEra = (unsigned int)(days - era * 146097);
+        const unsigned int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const unsigned int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const unsigned int monthIndex = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        year = (int)(yearOfEra + era * 400) + (month <= 2 ? 1 : 0);
+    }
+
+    // NMEA ddmm.mmmmm with a hemisphere letter
+    std::string FormatCoordinate(double degrees, int degreeDigits, char positive, char negative)
+    {
+        const char hemisphere = degrees < 0.0 ? negative : positive;
+        degrees = fabs(degrees);
+        int wholeDegrees = (int)degrees;
+        double minutes = (degrees - wholeDegrees) * 60.0;
+        if (minutes >= 59.999995)
+        {
+            wholeDegrees++;
+            minutes = 0.0;
+        }
+
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%0*d%08.5f,%c", degreeDigits, wholeDegrees, minutes, hemisphere);
+        return buffer;
+    }
+
+    std::string AddSentence(const std::string& body)
+    {
+        char checksum[8];
+        snprintf(checksum, sizeof(checksum), "*%02X\r\n", nmeaParser::computeChecksum(body.c_str(), body.size()));
+        return "$" + body + checksum;
+    }
+
+    // GGA, RMC and VTG sentences for a log record
+    std::string FormatSentences(const GpsLog::Record& record)
+    {
+        char time[16] = {0};
+        char date[16] = {0};
+        if (record.utc >= 0.0)
+        {
+            const long long milliseconds = (long long)floor(record.utc * 1000.0 + 0.5);
+            const long days = (long)(milliseconds / 86400000);
+            const unsigned int millisecondOfDay = (unsigned int)(milliseconds % 86400000);
+            int year = 0;
+            unsigned int month = 0;
+            unsigned int day = 0;
+            CivilFromDays(days, year, month, day);
+
+            snprintf(time, sizeof(time), "%02u%02u%02u.%03u",
+                millisecondOfDay / 3600000, millisecondOfDay / 60000 % 60, millisecondOfDay / 1000 % 60, millisecondOfDay % 1000);
+            snprintf(date, sizeof(date), "%02u%02u%02d", day, month, year % 100);
+        }
+
+        const std::string latitude = FormatCoordinate(record.latitude, 2, 'N', 'S');
+        const std::string longitude = FormatCoordinate(record.longitude, 3, 'E', 'W');
+
+        char speed[64] = {0};
+        char course[16] = {0};
+        if (record.speedKmh >= 0.0)
+        {
+            snprintf(speed, sizeof(speed), "%.2f", record.speedKmh / 1.852);
+        }
+        if (record.courseDegrees >= 0.0)
+        {
+            snprintf(course, sizeof(course), "%.1f", record.courseDegrees);
+        }
+
+        char buffer[256];
+        std::string sentences;
+
+        snprintf(buffer, sizeof(buffer), "GPGGA,%s,%s,%s,%u,%02u,%.1f,",
+            time, latitude.c_str(), longitude.c_str(), record.fixQuality, record.satellites, record.hdop);
+        std::string gga = buffer;
+        if (record.hasAltitude)
+        {
+            snprintf(buffer, sizeof(buffer), "%.2f", record.altitude);
+            gga += buffer;
+        }
+        sentences += AddSentence(gga + ",M,,M,,");
+
+        snprintf(buffer, sizeof(buffer), "GPRMC,%s,%c,%s,%s,%s,%s,%s,,",
+            time, record.fixQuality > 0 ? 'A' : 'V', latitude.c_str(), longitude.c_str(), speed, course, date);
+        sentences += AddSentence(buffer);
+
+        if (record.speedKmh >= 0.0)
+        {
+            snprintf(buffer, sizeof(buffer), "GPVTG,%s,T,,M,%s,N,%.2f,K", course, speed, record.speedKmh);
+            sentences += AddSentence(buffer);
+        }
+
+        return sentences;
+    }
+
+    double DistanceMeters(double latitude1, double longitude1, double latitude2, double longitude2)
+    {
+        const double toRadians = PI / 180.0;
+        const double sinLatitude = sin((latitude2 - latitude1) * toRadians / 2);
+        const double sinLongitude = sin((longitude2 - longitude1) * toRadians / 2);
+        const double a = sinLatitude * sinLatitude +
+            cos(latitude1 * toRadians) * cos(latitude2 * toRadians) * sinLongitude * sinLongitude;
+        return 2 * EARTH_RADIUS_METERS * asin(std::min(1.0, sqrt(a)));
+    }
+
+    GpsTrackRecord ToTrackRecord(const GpsLog::Record& logRecord, unsigned int frame, const LadybugTimestamp& timeStamp)
+    {
+        GpsTrackRecord record;
+        memset(&record, 0, sizeof(record));
+        record.frame = frame;
+        record.cameraSeconds = (unsigned int)timeStamp.ulSeconds;
+        record.cameraMicroSeconds = (unsigned int)timeStamp.ulMicroSeconds;
+        record.flags = gpsTrack::HAS_POSITION;
+        if (logRecord.utc >= 0.0)
+        {
+            record.flags |= gpsTrack::HAS_TIME | gpsTrack::HAS_DATE;
+            record.utc = logRecord.utc;
+        }
+        if (logRecord.fixQuality > 0)
+        {
+            record.flags |= gpsTrack::HAS_FIX;
+        }
+        record.latitude = logRecord.latitude;
+        record.longitude = logRecord.longitude;
+        record.fixQuality = (unsigned char)std::min(logRecord.fixQuality, 255u);
+        record.satellites = (unsigned char)std::min(logRecord.satellites, 255u);
+        record.hdop = (float)logRecord.hdop;
+
+        if (logRecord.hasAltitude)
+        {
+            record.flags |= gpsTrack::HAS_ALTITUDE;
+            record.altitude = logRecord.altitude;
+        }
+        if (logRecord.speedKmh >= 0.0)
+        {
+            record.flags |= gpsTrack::HAS_SPEED;
+            record.speedKmh = (float)logRecord.speedKmh;
+        }
+        if (logRecord.courseDegrees >= 0.0)
+        {
+            record.flags |= gpsTrack::HAS_COURSE;
+            record.courseDegrees = (float)logRecord.courseDegrees;
+        }
+        if (logRecord.hasPose)
+        {
+            record.flags |= gpsTrack::HAS_POSE;
+            record.roll = (float)logRecord.roll;
+            record.pitch = (float)logRecord.pitch;
+            record.yaw = (float)logRecord.yaw;
+        }
+        return record;
+    }
+
     void HandleError(LadybugError e)
     {
         if (e != LADYBUG_OK)
@@ -66,10 +237,17 @@ namespace
 
 }
 
-GPSInsert::GPSInsert(std::string inputStreamPath, std::string outputStreamPath)
+GPSInsert::GPSInsert(std::string inputStreamPath, std::string outputStreamPath) :
+    m_writeContext(NULL),
+    m_isWritebackManaged(false),
+    m_trackPath(gpsTrack::isTrackPath(outputStreamPath) ? outputStreamPath : std::string()),
+    m_hasGpsLog(false),
+    m_logOffsetSeconds(0.0)
 {
     LadybugError error;
 
+    memset(&m_statistics, 0, sizeof(m_statistics));
+
     // read stream 
     error = ladybugCreateStreamContext(&m_readStream.context);
     HandleError(error);
@@ -88,6 +266,14 @@ GPSInsert::GPSInsert(std::string inputStreamPath, std::string outputStreamPath)
     error = ladybugGetStreamHeader(m_readStream.context, &m_readStream.headerInfo);
     HandleError(error);
 
+    SetNmeaSentences();
+
+    // A track is written after the last frame; there is no stream to write
+    if (!m_trackPath.empty())
+    {
+        return;
+    }
+
     error = ladybugGetStreamConfigFile(m_readStream.context, m_readStream.configFile.c_str());
     HandleError(error);
 
@@ -103,14 +289,19 @@ GPSInsert::GPSInsert(std::string inputStreamPath, std::string outputStreamPath)
         true);
     HandleError(error);
 
+    std::string errorMessage;
+    m_isWritebackManaged = m_writeback.open(streamSegment::makePath(outputStreamPath + "-", 0), WRITEBACK_CHUNK_MB, errorMessage);
+    if (!m_isWritebackManaged)
+    {
+        std::cout << "Warning: Unable to manage stream writeback (" << errorMessage << ")" << std::endl;
+    }
+
     // Delete temp config file 
     if (std::remove(m_readStream.configFile.c_str()) != 0)
     {
         //Failed to remove the file. Handle error?
         std::cout << "Warning: temp file " << m_readStream.configFile << " was unable to be deleted." << std::endl;
     }
-
-    SetNmeaSentences();
 }
 
 GPSInsert::~GPSInsert()
@@ -119,13 +310,21 @@ GPSInsert::~GPSInsert()
 
     error = ladybugStopStream(m_readStream.context);
     HandleError(error);
-    error = ladybugDestroyContext(&m_readStream.context);
+    error = ladybugDestroyStreamContext(&m_readStream.context);
     HandleError(error);
 
-    error = ladybugStopStream(m_writeContext);
-    HandleError(error);
-    error = ladybugDestroyContext(&m_writeContext);
-    HandleError(error);
+    if (m_writeContext != NULL)
+    {
+        error = ladybugStopStream(m_writeContext);
+        HandleError(error);
+        error = ladybugDestroyStreamContext(&m_writeContext);
+        HandleError(error);
+    }
+
+    if (m_isWritebackManaged)
+    {
+        m_writeback.close();
+    }
 }
 
 bool GPSInsert::GetNextImage()
@@ -144,8 +343,12 @@ bool GPSInsert::GetNextImage()
 
     if (m_readStream.currentFrameNumber < m_readStream.numberOfFrames)
     {
-        error = ladybugGoToImage(m_readStream.context, m_readStream.currentFrameNumber);
-        HandleError(error);
+        // Seek once; the frames are then read in order
+        if (m_readStream.currentFrameNumber == 0)
+        {
+            error = ladybugGoToImage(m_readStream.context, 0);
+            HandleError(error);
+        }
 
         error = ladybugReadImageFromStream(m_readStream.context, &m_readStream.image);
         HandleError(error);
@@ -163,25 +366,137 @@ LadybugError GPSInsert::InsertGPSData()
 {
     LadybugError error = LADYBUG_OK;
     
+    std::vector<GpsTrackRecord> trackRecords;
     while (GetNextImage())
     {
-        std::string nmeaSentence = GetNmeaSentence();
+        std::string nmeaSentence;
+        GpsLog::Record logRecord;
+        if (!m_hasGpsLog)
+        {
+            nmeaSentence = GetNmeaSentence();
+        }
+        else if (MatchLogRecord(logRecord))
+        {
+            if (!m_trackPath.empty())
+            {
+                trackRecords.push_back(ToTrackRecord(logRecord, m_readStream.currentFrameNumber, m_readStream.image.timeStamp));
+            }
+            else
+            {
+                nmeaSentence = FormatSentences(logRecord);
+            }
+        }
 
-        error = ladybugWriteGPSDataToImage(
-            m_readStream.context,
-            &m_readStream.image,
-            nmeaSentence.c_str(),
-            nmeaSentence.size());
-        HandleError(error);
+        // Frames the log does not cover keep their own GPS data, in the
+        // track by having no record and in a new stream by being copied
+        if (!m_trackPath.empty())
+        {
+            continue;
+        }
+
+        if (!nmeaSentence.empty())
+        {
+            error = ladybugWriteGPSDataToImage(
+                m_readStream.context,
+                &m_readStream.image,
+                nmeaSentence.c_str(),
+                nmeaSentence.size());
+            HandleError(error);
+        }
 
         error = ladybugWriteImageToStream(m_writeContext, &m_readStream.image);
         HandleError(error);
 
+        if (m_isWritebackManaged)
+        {
+            m_writeback.update();
+        }
+    }
+
+    if (m_hasGpsLog)
+    {
+        PrintAlignment();
+    }
+
+    if (!m_trackPath.empty())
+    {
+        std::string errorMessage;
+        if (!gpsTrack::write(m_trackPath, trackRecords, errorMessage))
+        {
+            printf("Error: %s\n", errorMessage.c_str());
+            exit(EXIT_FAILURE);
+        }
+        printf("Wrote %u records to %s\n", (unsigned int)trackRecords.size(), m_trackPath.c_str());
     }
 
     return error;
 }
 
+void GPSInsert::LoadGpsLog(const std::string& logPath, GpsLog::TimeBase timeBase, double offsetSeconds)
+{
+    std::string errorMessage;
+    if (!m_gpsLog.Load(logPath, timeBase, errorMessage))
+    {
+        printf("Error: %s\n", errorMessage.c_str());
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Loaded %u positions from %s\n", (unsigned int)m_gpsLog.GetNumRecords(), logPath.c_str());
+    m_hasGpsLog = true;
+    m_logOffsetSeconds = offsetSeconds;
+}
+
+bool GPSInsert::MatchLogRecord(GpsLog::Record& record)
+{
+    const LadybugTimestamp& timeStamp = m_readStream.image.timeStamp;
+    const double frameTime = timeStamp.ulSeconds + timeStamp.ulMicroSeconds * 1e-6 + m_logOffsetSeconds;
+
+    double residualSeconds = 0.0;
+    if (!m_gpsLog.Interpolate(frameTime, MAX_LOG_GAP_SECONDS, record, residualSeconds))
+    {
+        m_statistics.unmatchedFrames++;
+        return false;
+    }
+
+    m_statistics.matchedFrames++;
+    m_statistics.sumResidualSeconds += residualSeconds;
+    m_statistics.maxResidualSeconds = std::max(m_statistics.maxResidualSeconds, residualSeconds);
+
+    GpsTrackRecord recorded;
+    GpsTrackReader::getEmbeddedData(m_readStream.currentFrameNumber, m_readStream.image, recorded);
+    if ((recorded.flags & gpsTrack::HAS_POSITION) != 0)
+    {
+        const double distance = DistanceMeters(recorded.latitude, recorded.longitude, record.latitude, record.longitude);
+        m_statistics.framesWithPosition++;
+        m_statistics.sumSquaredDistance += distance * distance;
+        m_statistics.maxDistance = std::max(m_statistics.maxDistance, distance);
+    }
+
+    return true;
+}
+
+void GPSInsert::PrintAlignment() const
+{
+    const AlignmentStatistics& statistics = m_statistics;
+    printf("Frames with log data: %u, without: %u\n", statistics.matchedFrames, statistics.unmatchedFrames);
+
+    if (statistics.matchedFrames > 0)
+    {
+        printf("Time to the nearest log record: mean %.1f ms, max %.1f ms\n",
+            statistics.sumResidualSeconds / statistics.matchedFrames * 1000.0,
+            statistics.maxResidualSeconds * 1000.0);
+    }
+
+    // A large distance that grows with speed points at a clock offset
+    if (statistics.framesWithPosition > 0)
+    {
+        printf("Distance to the recorded position (%u frames): RMS %.2f m, max %.2f m\n",
+            statistics.framesWithPosition,
+            sqrt(statistics.sumSquaredDistance / statistics.framesWithPosition),
+            statistics.maxDistance);
+    }
+}
+
 void GPSInsert::SetNmeaSentences()
 {
     // single sentence examples
@@ -21,13 +21,22 @@
 #include <queue>
 #include "ladybugrenderer.h"
 #include "ladybugstream.h"
+#include "GpsLog.h"
+#include "GpsTrack.h"
+#include "StreamWriteback.h"
 
 class GPSInsert
 {
 public:
+    // An output path ending in .gpstrack writes a GPS track for the input
+    // stream instead of a new stream; it needs a GPS log.
     GPSInsert(std::string, std::string);
     virtual ~GPSInsert();
     
+    // Take the GPS data from a log instead of the example sentences.
+    // The log time of a frame is its timestamp plus offsetSeconds.
+    void LoadGpsLog(const std::string& logPath, GpsLog::TimeBase timeBase, double offsetSeconds);
+
     LadybugError InsertGPSData();
 
 private:
@@ -46,11 +55,34 @@ private:
     } m_readStream;
 
     LadybugStreamContext m_writeContext;
+    StreamWriteback m_writeback;
+    bool m_isWritebackManaged;
+    std::string m_trackPath;
     std::queue<std::string> m_nmeaSentences;
 
+    GpsLog m_gpsLog;
+    bool m_hasGpsLog;
+    double m_logOffsetSeconds;
+
+    // How well the frames line up with the log
+    struct AlignmentStatistics
+    {
+        unsigned int matchedFrames;
+        unsigned int unmatchedFrames;
+        double sumResidualSeconds;
+        double maxResidualSeconds;
+
+        // Against the position the frame already had, if any
+        unsigned int framesWithPosition;
+        double sumSquaredDistance;
+        double maxDistance;
+    } m_statistics;
+
     bool GetNextImage();
     void SetNmeaSentences();
     std::string GetNmeaSentence();
+    bool MatchLogRecord(GpsLog::Record& record);
+    void PrintAlignment() const;
 
 };
 
@@ -0,0 +1,602 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+#include "GpsLog.h"
+#include "NmeaParser.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const size_t MAX_LINE_LENGTH = 4096;
+
+    unsigned int MillisecondOfDay(const NmeaTime& time)
+    {
+        return ((time.hour * 60u + time.minute) * 60u + time.second) * 1000u + time.millisecond;
+    }
+
+    // The records of an NMEA log before they are dated
+    struct Epoch
+    {
+        unsigned int millisecond;
+        bool hasDate;
+        long day;
+        bool hasPosition;
+        GpsLog::Record record;
+    };
+
+    void ResetEpoch(Epoch& epoch, unsigned int millisecond)
+    {
+        memset(&epoch, 0, sizeof(epoch));
+        epoch.millisecond = millisecond;
+        epoch.record.utc = -1.0;
+        epoch.record.speedKmh = -1.0;
+        epoch.record.courseDegrees = -1.0;
+    }
+
+    // Give each epoch the date of the nearest RMC sentence, changing day
+    // where the time of day wraps. Returns false if no epoch has a date.
+    bool DateEpochs(std::vector<Epoch>& epochs)
+    {
+        size_t anchor = 0;
+        while (anchor < epochs.size() && !epochs[anchor].hasDate)
+        {
+            anchor++;
+        }
+
+        if (anchor == epochs.size())
+        {
+            return false;
+        }
+
+        long day = epochs[anchor].day;
+        for (size_t i = anchor; i-- > 0; )
+        {
+            if (epochs[i].millisecond > epochs[i + 1].millisecond)
+            {
+                day--;
+            }
+            epochs[i].day = day;
+        }
+
+        day = epochs[anchor].day;
+        for (size_t i = anchor + 1; i < epochs.size(); i++)
+        {
+            if (epochs[i].hasDate)
+            {
+                day = epochs[i].day;
+            }
+            else if (epochs[i].millisecond < epochs[i - 1].millisecond)
+            {
+                day++;
+            }
+            epochs[i].day = day;
+        }
+
+        return true;
+    }
+
+    std::string ToLower(const std::string& text)
+    {
+        std::string lower = text;
+        for (size_t i = 0; i < lower.size(); i++)
+        {
+            if (lower[i] >= 'A' && lower[i] <= 'Z')
+            {
+                lower[i] = lower[i] - 'A' + 'a';
+            }
+        }
+        return lower;
+    }
+
+    void SplitCsvLine(const char* pLine, std::vector<std::string>& fields)
+    {
+        fields.clear();
+        std::string field;
+        for (const char* p = pLine; *p != '\0' && *p != '\r' && *p != '\n'; p++)
+        {
+            if (*p == ',')
+            {
+                fields.push_back(field);
+                field.clear();
+            }
+            else if (*p != ' ' && *p != '"')
+            {
+                field += *p;
+            }
+        }
+        fields.push_back(field);
+    }
+
+    bool ParseNumber(const std::string& field, double& value)
+    {
+        if (field.empty())
+        {
+            return false;
+        }
+
+        char* pEnd = NULL;
+        value = strtod(field.c_str(), &pEnd);
+        return *pEnd == '\0' && std::isfinite(value);
+    }
+
+    // ISO 8601 UTC, or a plain number of seconds since 1970
+    bool ParseUtc(const std::string& field, double& utc)
+    {
+        if (ParseNumber(field, utc))
+        {
+            return true;
+        }
+
+        int year = 0;
+        unsigned int month = 0;
+        unsigned int day = 0;
+        unsigned int hour = 0;
+        unsigned int minute = 0;
+        double second = 0.0;
+        if (sscanf(field.c_str(), "%d-%u-%uT%u:%u:%lf", &year, &month, &day, &hour, &minute, &second) != 6 ||
+            month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second < 0.0 || second >= 61.0)
+        {
+            return false;
+        }
+
+        utc = nmeaParser::getDayNumber(year, month, day) * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+        return true;
+    }
+
+    enum CsvColumn
+    {
+        COLUMN_CAMERA_TIME,
+        COLUMN_UTC,
+        COLUMN_LATITUDE,
+        COLUMN_LONGITUDE,
+        COLUMN_ALTITUDE,
+        COLUMN_SPEED,
+        COLUMN_COURSE,
+        COLUMN_ROLL,
+        COLUMN_PITCH,
+        COLUMN_YAW,
+        COLUMN_FIX_QUALITY,
+        COLUMN_SATELLITES,
+        COLUMN_HDOP,
+        NUM_CSV_COLUMNS
+    };
+
+    int FindCsvColumn(const std::string& name)
+    {
+        static const struct
+        {
+            const char* pName;
+            CsvColumn column;
+        } names[] =
+        {
+            { "camera_time", COLUMN_CAMERA_TIME },
+            { "utc", COLUMN_UTC },
+            { "time", COLUMN_UTC },
+            { "latitude", COLUMN_LATITUDE },
+            { "lat", COLUMN_LATITUDE },
+            { "longitude", COLUMN_LONGITUDE },
+            { "lon", COLUMN_LONGITUDE },
+            { "altitude", COLUMN_ALTITUDE },
+            { "alt", COLUMN_ALTITUDE },
+            { "speed_kmh", COLUMN_SPEED },
+            { "course", COLUMN_COURSE },
+            { "heading", COLUMN_COURSE },
+            { "roll", COLUMN_ROLL },
+            { "pitch", COLUMN_PITCH },
+            { "yaw", COLUMN_YAW },
+            { "fix_quality", COLUMN_FIX_QUALITY },
+            { "satellites", COLUMN_SATELLITES },
+            { "hdop", COLUMN_HDOP },
+        };
+
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+        {
+            if (name == names[i].pName)
+            {
+                return names[i].column;
+            }
+        }
+        return -1;
+    }
+
+    bool IsEarlier(const GpsLog::Record& a, const GpsLog::Record& b)
+    {
+        return a.time < b.time;
+    }
+
+    // Interpolate between angles, the short way around
+    double InterpolateAngle(double a, double b, double fraction, double fullCircle)
+    {
+        double difference = b - a;
+        if (difference > fullCircle / 2)
+        {
+            difference -= fullCircle;
+        }
+        else if (difference < -fullCircle / 2)
+        {
+            difference += fullCircle;
+        }
+        return a + difference * fraction;
+    }
+}
+
+GpsLog::GpsLog() :
+    m_timeBase(TIMEBASE_UTC),
+    m_cursor(0)
+{
+}
+
+size_t GpsLog::GetNumRecords() const
+{
+    return m_records.size();
+}
+
+bool GpsLog::Load(const std::string& path, TimeBase timeBase, std::string& errorMessage)
+{
+    m_timeBase = timeBase;
+    m_records.clear();
+    m_cursor = 0;
+
+    FILE* pFile = fopen(path.c_str(), "r");
+    if (pFile == NULL)
+    {
+        errorMessage = "Unable to open " + path;
+        return false;
+    }
+
+    // NMEA logs start with a sentence, anything else is taken as CSV
+    int first = fgetc(pFile);
+    while (first == ' ' || first == '\r' || first == '\n')
+    {
+        first = fgetc(pFile);
+    }
+    rewind(pFile);
+
+    const bool isLoaded = first == '$' ? LoadNmea(pFile, errorMessage) : LoadCsv(pFile, errorMessage);
+    fclose(pFile);
+    if (!isLoaded)
+    {
+        return false;
+    }
+
+    if (m_records.empty())
+    {
+        errorMessage = "No positions in " + path;
+        return false;
+    }
+
+    // Logs are mostly in order already; drop repeated times after sorting
+    std::stable_sort(m_records.begin(), m_records.end(), IsEarlier);
+    std::vector<Record> unique;
+    unique.reserve(m_records.size());
+    for (size_t i = 0; i < m_records.size(); i++)
+    {
+        if (unique.empty() || m_records[i].time > unique.back().time)
+        {
+            unique.push_back(m_records[i]);
+        }
+    }
+    m_records.swap(unique);
+
+    return true;
+}
+
+bool GpsLog::LoadNmea(FILE* pFile, std::string& errorMessage)
+{
+    if (m_timeBase == TIMEBASE_CAMERA)
+    {
+        errorMessage = "NMEA logs have no camera time; use a CSV log with a camera_time column";
+        return false;
+    }
+
+    std::vector<Epoch> epochs;
+    Epoch epoch;
+    ResetEpoch(epoch, 0);
+    bool hasEpoch = false;
+
+    char line[MAX_LINE_LENGTH];
+    while (fgets(line, sizeof(line), pFile) != NULL)
+    {
+        NmeaData data;
+        if (nmeaParser::parse(line, strlen(line), data) == 0)
+        {
+            continue;
+        }
+
+        // Each sentence with a time starts a new epoch if its time differs
+        const NmeaTime* pTime = NULL;
+        if (data.gga.valid)
+        {
+            pTime = &data.gga.time;
+        }
+        else if (data.rmc.year != 0)
+        {
+            pTime = &data.rmc.time;
+        }
+        else if (data.gll.valid)
+        {
+            pTime = &data.gll.time;
+        }
+
+        if (pTime != NULL && (!hasEpoch || MillisecondOfDay(*pTime) != epoch.millisecond))
+        {
+            if (hasEpoch && epoch.hasPosition)
+            {
+                epochs.push_back(epoch);
+            }
+            ResetEpoch(epoch, MillisecondOfDay(*pTime));
+            hasEpoch = true;
+        }
+
+        if (!hasEpoch)
+        {
+            continue;
+        }
+
+        Record& record = epoch.record;
+        if (data.gga.valid)
+        {
+            epoch.hasPosition = true;
+            record.latitude = data.gga.latitude;
+            record.longitude = data.gga.longitude;
+            record.hasAltitude = true;
+            record.altitude = data.gga.altitude;
+            record.fixQuality = data.gga.fixQuality;
+            record.satellites = data.gga.satellites;
+            record.hdop = data.gga.hdop;
+        }
+
+        if (data.rmc.year != 0)
+        {
+            epoch.hasDate = true;
+            epoch.day = nmeaParser::getDayNumber(data.rmc.year, data.rmc.month, data.rmc.day);
+        }
+
+        if (data.rmc.valid)
+        {
+            if (!epoch.hasPosition)
+            {
+                epoch.hasPosition = true;
+                record.latitude = data.rmc.latitude;
+                record.longitude = data.rmc.longitude;
+                record.fixQuality = 1;
+            }
+            record.speedKmh = data.rmc.speedKnots * 1.852;
+            record.courseDegrees = data.rmc.courseDegrees;
+        }
+
+        if (data.gll.valid && !epoch.hasPosition)
+        {
+            epoch.hasPosition = true;
+            record.latitude = data.gll.latitude;
+            record.longitude = data.gll.longitude;
+            record.fixQuality = 1;
+        }
+
+        if (data.vtg.valid && record.speedKmh < 0.0)
+        {
+            record.speedKmh = data.vtg.speedKmh;
+            record.courseDegrees = data.vtg.trueCourseDegrees;
+        }
+    }
+
+    if (hasEpoch && epoch.hasPosition)
+    {
+        epochs.push_back(epoch);
+    }
+
+    if (!epochs.empty() && !DateEpochs(epochs))
+    {
+        errorMessage = "The NMEA log has no RMC sentences to take the date from";
+        return false;
+    }
+
+    m_records.reserve(epochs.size());
+    for (size_t i = 0; i < epochs.size(); i++)
+    {
+        Record record = epochs[i].record;
+        record.utc = epochs[i].day * 86400.0 + epochs[i].millisecond / 1000.0;
+        record.time = record.utc;
+        m_records.push_back(record);
+    }
+
+    return true;
+}
+
+bool GpsLog::LoadCsv(FILE* pFile, std::string& errorMessage)
+{
+    char line[MAX_LINE_LENGTH];
+    std::vector<std::string> fields;
+    if (fgets(line, sizeof(line), pFile) == NULL)
+    {
+        errorMessage = "The CSV log is empty";
+        return false;
+    }
+
+    int columns[NUM_CSV_COLUMNS];
+    std::fill(columns, columns + NUM_CSV_COLUMNS, -1);
+    SplitCsvLine(line, fields);
+    for (size_t i = 0; i < fields.size(); i++)
+    {
+        const int column = FindCsvColumn(ToLower(fields[i]));
+        if (column >= 0 && columns[column] < 0)
+        {
+            columns[column] = (int)i;
+        }
+    }
+
+    const size_t numHeaderFields = fields.size();
+    const int timeColumn = columns[m_timeBase == TIMEBASE_CAMERA ? COLUMN_CAMERA_TIME : COLUMN_UTC];
+    if (timeColumn < 0 || columns[COLUMN_LATITUDE] < 0 || columns[COLUMN_LONGITUDE] < 0)
+    {
+        errorMessage = std::string("The CSV header needs ") +
+            (m_timeBase == TIMEBASE_CAMERA ? "camera_time" : "utc") + ", latitude and longitude columns";
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), pFile) != NULL)
+    {
+        SplitCsvLine(line, fields);
+        fields.resize(std::max(fields.size(), numHeaderFields));
+
+        Record record;
+        memset(&record, 0, sizeof(record));
+        record.utc = -1.0;
+        record.speedKmh = -1.0;
+        record.courseDegrees = -1.0;
+
+        // Rows without a position, such as frames that had no fix, are skipped
+        const bool hasTime = m_timeBase == TIMEBASE_CAMERA ?
+            ParseNumber(fields[timeColumn], record.time) :
+            ParseUtc(fields[timeColumn], record.time);
+        if (!hasTime ||
+            !ParseNumber(fields[columns[COLUMN_LATITUDE]], record.latitude) ||
+            !ParseNumber(fields[columns[COLUMN_LONGITUDE]], record.longitude))
+        {
+            continue;
+        }
+
+        double value = 0.0;
+        if (columns[COLUMN_UTC] >= 0 && ParseUtc(fields[columns[COLUMN_UTC]], value))
+        {
+            record.utc = value;
+        }
+        if (columns[COLUMN_ALTITUDE] >= 0 && ParseNumber(fields[columns[COLUMN_ALTITUDE]], value))
+        {
+            record.hasAltitude = true;
+            record.altitude = value;
+        }
+        if (columns[COLUMN_SPEED] >= 0 && ParseNumber(fields[columns[COLUMN_SPEED]], value))
+        {
+            record.speedKmh = value;
+        }
+        if (columns[COLUMN_COURSE] >= 0 && ParseNumber(fields[columns[COLUMN_COURSE]], value))
+        {
+            record.courseDegrees = value;
+        }
+        if (columns[COLUMN_ROLL] >= 0 && columns[COLUMN_PITCH] >= 0 && columns[COLUMN_YAW] >= 0)
+        {
+            record.hasPose =
+                ParseNumber(fields[columns[COLUMN_ROLL]], record.roll) &&
+                ParseNumber(fields[columns[COLUMN_PITCH]], record.pitch) &&
+                ParseNumber(fields[columns[COLUMN_YAW]], record.yaw);
+        }
+        record.fixQuality = 1;
+        if (columns[COLUMN_FIX_QUALITY] >= 0 && ParseNumber(fields[columns[COLUMN_FIX_QUALITY]], value))
+        {
+            record.fixQuality = (unsigned int)value;
+        }
+        if (columns[COLUMN_SATELLITES] >= 0 && ParseNumber(fields[columns[COLUMN_SATELLITES]], value))
+        {
+            record.satellites = (unsigned int)value;
+        }
+        if (columns[COLUMN_HDOP] >= 0 && ParseNumber(fields[columns[COLUMN_HDOP]], value))
+        {
+            record.hdop = value;
+        }
+
+        if (record.fixQuality > 0)
+        {
+            m_records.push_back(record);
+        }
+    }
+
+    return true;
+}
+
+bool GpsLog::Interpolate(double time, double maxGapSeconds, Record& record, double& residualSeconds)
+{
+    if (m_records.empty())
+    {
+        return false;
+    }
+
+    // Find the last record at or before the time, walking from the last
+    // lookup since frames come in order
+    if (m_cursor >= m_records.size() || m_records[m_cursor].time > time)
+    {
+        Record key;
+        key.time = time;
+        const std::vector<Record>::const_iterator next = std::upper_bound(m_records.begin(), m_records.end(), key, IsEarlier);
+        m_cursor = next == m_records.begin() ? 0 : (size_t)(next - m_records.begin()) - 1;
+    }
+    while (m_cursor + 1 < m_records.size() && m_records[m_cursor + 1].time <= time)
+    {
+        m_cursor++;
+    }
+
+    const Record& before = m_records[m_cursor];
+    if (time <= before.time || m_cursor + 1 == m_records.size())
+    {
+        // Before the first or after the last record; not extrapolated
+        residualSeconds = fabs(time - before.time);
+        record = before;
+        record.time = time;
+        return residualSeconds <= maxGapSeconds;
+    }
+
+    const Record& after = m_records[m_cursor + 1];
+    residualSeconds = std::min(time - before.time, after.time - time);
+    if (after.time - before.time > maxGapSeconds)
+    {
+        return false;
+    }
+
+    const double fraction = (time - before.time) / (after.time - before.time);
+    const Record& nearest = fraction < 0.5 ? before : after;
+    record = nearest;
+    record.time = time;
+    record.latitude = before.latitude + (after.latitude - before.latitude) * fraction;
+    record.longitude = InterpolateAngle(before.longitude, after.longitude, fraction, 360.0);
+    if (record.longitude > 180.0)
+    {
+        record.longitude -= 360.0;
+    }
+    else if (record.longitude < -180.0)
+    {
+        record.longitude += 360.0;
+    }
+
+    if (before.hasAltitude && after.hasAltitude)
+    {
+        record.altitude = before.altitude + (after.altitude - before.altitude) * fraction;
+    }
+    if (before.utc >= 0.0 && after.utc >= 0.0)
+    {
+        record.utc = before.utc + (after.utc - before.utc) * fraction;
+    }
+    if (before.speedKmh >= 0.0 && after.speedKmh >= 0.0)
+    {
+        record.speedKmh = before.speedKmh + (after.speedKmh - before.speedKmh) * fraction;
+    }
+    if (before.courseDegrees >= 0.0 && after.courseDegrees >= 0.0)
+    {
+        record.courseDegrees = fmod(InterpolateAngle(before.courseDegrees, after.courseDegrees, fraction, 360.0) + 360.0, 360.0);
+    }
+    record.hasPose = before.hasPose && after.hasPose;
+    if (record.hasPose)
+    {
+        record.roll = InterpolateAngle(before.roll, after.roll, fraction, 360.0);
+        record.pitch = before.pitch + (after.pitch - before.pitch) * fraction;
+        record.yaw = InterpolateAngle(before.yaw, after.yaw, fraction, 360.0);
+    }
+
+    return true;
+}
@@ -0,0 +1,98 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//
+// A GPS/INS log recorded next to the camera, as a time ordered list of
+// positions that can be looked up at the time of each frame.
+//
+// Two formats are read:
+//  - NMEA logs, one sentence per line. Sentences with the same time of day
+//    make up one record. The date comes from RMC sentences.
+//  - CSV logs with a header row. Columns are found by name: camera_time,
+//    utc, latitude, longitude, altitude, speed_kmh, course, roll, pitch,
+//    yaw, fix_quality, satellites and hdop. Only latitude and longitude
+//    are required. Angles are in degrees. utc
+//    is either ISO 8601 (2016-03-24T19:32:51.167Z) or seconds since 1970.
+//    ladybugGpsExtract writes this format.
+//
+class GpsLog
+{
+public:
+    enum TimeBase
+    {
+        // Frames are matched by UTC. The camera timestamp must be UTC, as
+        // it is with GPS time sync (see ladybugGPSTimeSync).
+        TIMEBASE_UTC,
+
+        // Frames are matched by camera timestamp; needs a camera_time column
+        TIMEBASE_CAMERA
+    };
+
+    struct Record
+    {
+        // On the time base of the log
+        double time;
+
+        // Seconds since 1970, or negative if unknown
+        double utc;
+
+        double latitude;
+        double longitude;
+        bool hasAltitude;
+        double altitude;
+
+        // Negative if unknown
+        double speedKmh;
+        double courseDegrees;
+
+        // Attitude from an INS
+        bool hasPose;
+        double roll;
+        double pitch;
+        double yaw;
+
+        unsigned int fixQuality;
+        unsigned int satellites;
+        double hdop;
+    };
+
+    GpsLog();
+
+    bool Load(const std::string& path, TimeBase timeBase, std::string& errorMessage);
+
+    size_t GetNumRecords() const;
+
+    // Position at the given time, interpolated between the records around
+    // it. Fails if there is no record within maxGapSeconds on either side.
+    // residualSeconds is the distance to the nearest record. Lookups are
+    // fastest when times increase from call to call.
+    bool Interpolate(double time, double maxGapSeconds, Record& record, double& residualSeconds);
+
+private:
+    bool LoadNmea(FILE* pFile, std::string& errorMessage);
+    bool LoadCsv(FILE* pFile, std::string& errorMessage);
+
+    TimeBase m_timeBase;
+    std::vector<Record> m_records;
+    size_t m_cursor;
+};
@@ -18,6 +18,16 @@
 //=============================================================================
 // This example illustrates how to insert gps data into a pgr stream file.
 //
+// Without a log, example sentences are inserted. With a GPS/INS log (NMEA
+// or CSV, see GpsLog.h), each frame gets the position interpolated from
+// the log at the time of the frame, matched by UTC or by camera time.
+//
+// If the output path ends in .gpstrack, the GPS data is written to a GPS
+// track file instead of a copy of the stream. Named after the stream
+// (name.gpstrack for name-000000.pgr), the track is picked up by
+// ladybugProcessStream and ladybugGpsExtract in place of the GPS data in
+// the stream, without rewriting it.
+//
 //=============================================================================
 
 
@@ -26,9 +36,15 @@
 #include "GPSInsert.h"
 
 
-enum {INPUT_FILE_ARG = 1, OUTPUT_FILE_ARG, NUM_OF_ARGS};
+enum {INPUT_FILE_ARG = 1, OUTPUT_FILE_ARG, NUM_OF_ARGS, LOG_FILE_ARG = NUM_OF_ARGS, TIME_BASE_ARG, OFFSET_ARG};
 
-const std::string USAGE = "ladybugGPSInsert [INPUT_FILE] [OUTPUT_FILE_WITH_PATH]";
+const std::string USAGE = 
+    "ladybugGPSInsert [INPUT_FILE] [OUTPUT_FILE_WITH_PATH] [LOG_FILE] [utc|camera] [OFFSET_SECONDS]\n"
+    "  OUTPUT_FILE    - a new stream, or a GPS track if it ends in .gpstrack\n"
+    "  LOG_FILE       - NMEA or CSV log to take the GPS data from, needed for a track\n"
+    "  utc|camera     - match frames to the log by UTC (default, needs GPS time sync)\n"
+    "                   or by camera time (CSV logs with a camera_time column)\n"
+    "  OFFSET_SECONDS - added to the frame time before looking it up in the log";
 
 
 namespace
@@ -55,7 +71,34 @@ int main(int  argc , char* argv[])
     const std::string inputFile = argv[INPUT_FILE_ARG];
     const std::string outputFile = argv[OUTPUT_FILE_ARG];
 
+    GpsLog::TimeBase timeBase = GpsLog::TIMEBASE_UTC;
+    if (argc > TIME_BASE_ARG)
+    {
+        const std::string timeBaseName = argv[TIME_BASE_ARG];
+        if (timeBaseName == "camera")
+        {
+            timeBase = GpsLog::TIMEBASE_CAMERA;
+        }
+        else if (timeBaseName != "utc")
+        {
+            PrintUsage();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    const double offsetSeconds = argc > OFFSET_ARG ? atof(argv[OFFSET_ARG]) : 0.0;
+
+    if (argc <= LOG_FILE_ARG && gpsTrack::isTrackPath(outputFile))
+    {
+        PrintUsage();
+        exit(EXIT_FAILURE);
+    }
+
     GPSInsert gpsInsert(inputFile, outputFile);
+    if (argc > LOG_FILE_ARG)
+    {
+        gpsInsert.LoadGpsLog(argv[LOG_FILE_ARG], timeBase, offsetSeconds);
+    }
     gpsInsert.InsertGPSData();
    
     return EXIT_SUCCESS;
@@ -20,10 +20,12 @@
 #endif
 
 #include <stdlib.h>
+#include <iomanip>
 #include <iostream>
 #include <string>
 
 #include "ladybug.h"
+#include "CameraClock.h"
 
 #define _HANDLE_ERROR \
     if( error != LADYBUG_OK ) \
@@ -69,6 +71,21 @@ LadybugError setGpsTimeSync(LadybugContext context, bool enable)
     return error;
 }
 
+// Print the status of the lock and the time of the image from the clock model
+void printTime(CameraClock& clock, const LadybugImage& image)
+{
+    const unsigned long long tick = clock.addImage(image);
+
+    std::cout<< "GPS status: " << image.imageInfo.bGpsStatus << std::endl << "PPS status: "<< image.imageInfo.bPpsStatus << std::endl << "GPS fixing quality: " << image.imageInfo.ulGpsFixQuality << std::endl;
+
+    const std::ios::fmtflags flags = std::cout.flags();
+    std::cout << std::fixed << std::setprecision(6)
+        << "Camera time: " << CameraClock::toSeconds(tick) << " s" << std::endl
+        << (clock.isLocked() ? "UTC: " : "UTC (not locked yet): ") << clock.toUtc(tick) << std::endl
+        << std::setprecision(2) << "Clock drift: " << clock.getDriftPpm() << " ppm from " << clock.getNumSamples() << " PPS frames" << std::endl;
+    std::cout.flags(flags);
+}
+
 int main()
 {
     // Initialize context.
@@ -101,6 +118,11 @@ int main()
     std::cout << std::endl;
     LadybugImage image;
 
+    // Unwraps the cycle time of the images and fits it to UTC while the
+    // camera is locked to PPS. Once the lock is gone, the fit carries the
+    // UTC of the frames on.
+    CameraClock clock;
+
     // Frames captured within the first second will not contain GPS time sync info, as it will take a second to latch on to the PPS. 
     for (int i = 0; i < 500; i++)
     {
@@ -108,7 +130,7 @@ int main()
         error = ::ladybugGrabImage(context, &image);
         _HANDLE_ERROR;
 
-        std::cout<< "GPS status: " << image.imageInfo.bGpsStatus << std::endl << "PPS status: "<< image.imageInfo.bPpsStatus << std::endl << "GPS fixing quality: " << image.imageInfo.ulGpsFixQuality << std::endl;
+        printTime(clock, image);
     }
 
     // disable gps time sync
@@ -122,7 +144,7 @@ int main()
         error = ::ladybugGrabImage(context, &image);
         _HANDLE_ERROR;
 
-        std::cout<< "GPS status: " << image.imageInfo.bGpsStatus << std::endl << "PPS status: "<< image.imageInfo.bPpsStatus << std::endl << "GPS fixing quality: " << image.imageInfo.ulGpsFixQuality << std::endl;
+        printTime(clock, image);
     }
 
     // Destroy the context
@@ -0,0 +1,675 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//
+// ladybugGpsExtract.cpp
+//
+// This program writes the GPS track of a Ladybug stream as GPX, GeoJSON or
+// CSV, with the frame number, camera time, UTC time, speed and fix quality
+// of every frame.
+//
+// Images are read from the stream but never decoded or rendered. The GPS
+// data comes from the GPS track of the stream if it has one (see 
+// GpsTrack.h), else from the NMEA text in the frame header, or from the
+// position in the image information when a frame has no NMEA text. The
+// stream is
+// split into frame ranges that are read by separate threads, each with
+// its own stream context that seeks to the start of its range through the
+// stream index.
+//
+//=============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ladybugGPS.h>
+#include <ladybugstream.h>
+
+#include "GpsTrack.h"
+#include "NmeaParser.h"
+
+namespace
+{
+    enum OutputFormat
+    {
+        FORMAT_GPX,
+        FORMAT_GEOJSON,
+        FORMAT_CSV
+    };
+
+    struct TrackPoint
+    {
+        unsigned int frame;
+        unsigned long cameraSeconds;
+        unsigned long cameraMicroSeconds;
+
+        bool hasPosition;
+        double latitude;
+        double longitude;
+        bool hasAltitude;
+        double altitude;
+
+        /** UTC time of day, and the date if an RMC sentence gave it. */
+        bool hasTime;
+        NmeaTime time;
+        bool hasDate;
+        int year;
+        unsigned int month;
+        unsigned int day;
+
+        /** Negative if unknown. */
+        double speedKmh;
+        double courseDegrees;
+
+        bool hasPose;
+        double roll;
+        double pitch;
+        double yaw;
+
+        unsigned int fixQuality;
+        unsigned int satellites;
+        double hdop;
+    };
+
+    /** The frames of one thread, and what happened while reading them. */
+    struct FrameRange
+    {
+        unsigned int first;
+        unsigned int end;
+        std::vector<TrackPoint> points;
+        unsigned long long bytesRead;
+        unsigned int framesFromTrack;
+        unsigned int framesWithNmea;
+        LadybugError error;
+    };
+
+    // Civil date of a number of days since 1970-01-01
+    void civilFromDays( long days, int& year, unsigned int& month, unsigned int& day )
+    {
+        days += 719468;
+        const long era = ( days >= 0 ? days : days - 146096 ) / 146097;
+        const unsigned int dayOfEra = (unsigned int)( days - era * 146097 );
+        const unsigned int yearOfEra = ( dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096 ) / 365;
+        const unsigned int dayOfYear = dayOfEra - ( 365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100 );
+        const unsigned int monthIndex = ( 5 * dayOfYear + 2 ) / 153;
+        day = dayOfYear - ( 153 * monthIndex + 2 ) / 5 + 1;
+        month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        year = (int)( yearOfEra + era * 400 ) + ( month <= 2 ? 1 : 0 );
+    }
+
+    void toTrackPoint( const GpsTrackRecord& record, TrackPoint& point )
+    {
+        memset( &point, 0, sizeof(point) );
+        point.frame = record.frame;
+        point.cameraSeconds = record.cameraSeconds;
+        point.cameraMicroSeconds = record.cameraMicroSeconds;
+
+        point.hasPosition = ( record.flags & gpsTrack::HAS_POSITION ) != 0;
+        point.latitude = record.latitude;
+        point.longitude = record.longitude;
+        point.hasAltitude = ( record.flags & gpsTrack::HAS_ALTITUDE ) != 0;
+        point.altitude = record.altitude;
+
+        if ( ( record.flags & gpsTrack::HAS_TIME ) != 0 )
+        {
+            const long long milliseconds = (long long)floor( record.utc * 1000.0 + 0.5 );
+            const long long millisecondOfDay = ( milliseconds % 86400000 + 86400000 ) % 86400000;
+            point.hasTime = true;
+            point.time.hour = (unsigned char)( millisecondOfDay / 3600000 );
+            point.time.minute = (unsigned char)( millisecondOfDay / 60000 % 60 );
+            point.time.second = (unsigned char)( millisecondOfDay / 1000 % 60 );
+            point.time.millisecond = (unsigned short)( millisecondOfDay % 1000 );
+
+            if ( ( record.flags & gpsTrack::HAS_DATE ) != 0 )
+            {
+                point.hasDate = true;
+                civilFromDays( (long)( ( milliseconds - millisecondOfDay ) / 86400000 ), point.year, point.month, point.day );
+            }
+        }
+
+        point.speedKmh = ( record.flags & gpsTrack::HAS_SPEED ) != 0 ? record.speedKmh : -1.0;
+        point.courseDegrees = ( record.flags & gpsTrack::HAS_COURSE ) != 0 ? record.courseDegrees : -1.0;
+        point.hasPose = ( record.flags & gpsTrack::HAS_POSE ) != 0;
+        point.roll = record.roll;
+        point.pitch = record.pitch;
+        point.yaw = record.yaw;
+        point.fixQuality = record.fixQuality;
+        point.satellites = record.satellites;
+        point.hdop = record.hdop;
+    }
+
+    void readRange( const std::string& streamName, const GpsTrackReader& gpsTrackReader, FrameRange& range )
+    {
+        range.bytesRead = 0;
+        range.framesFromTrack = 0;
+        range.framesWithNmea = 0;
+        range.points.reserve( range.end - range.first );
+
+        LadybugStreamContext context = NULL;
+        range.error = ladybugCreateStreamContext( &context );
+        if ( range.error == LADYBUG_OK )
+        {
+            range.error = ladybugInitializeStreamForReading( context, streamName.c_str(), false );
+        }
+
+        if ( range.error == LADYBUG_OK )
+        {
+            range.error = ladybugGoToImage( context, range.first );
+        }
+
+        for ( unsigned int frame = range.first; range.error == LADYBUG_OK && frame < range.end; frame++ )
+        {
+            LadybugImage image;
+            range.error = ladybugReadImageFromStream( context, &image );
+            if ( range.error != LADYBUG_OK )
+            {
+                break;
+            }
+
+            GpsTrackRecord record;
+            const GpsTrackReader::Source source = gpsTrackReader.getFrameData( frame, image, record );
+            range.framesFromTrack += source == GpsTrackReader::SOURCE_TRACK ? 1 : 0;
+            range.framesWithNmea += source == GpsTrackReader::SOURCE_NMEA ? 1 : 0;
+
+            TrackPoint point;
+            toTrackPoint( record, point );
+            range.points.push_back( point );
+            range.bytesRead += image.uiDataSizeBytes;
+        }
+
+        if ( context != NULL )
+        {
+            ladybugStopStream( context );
+            ladybugDestroyStreamContext( &context );
+        }
+    }
+
+    unsigned int millisecondOfDay( const NmeaTime& time )
+    {
+        return ( ( time.hour * 60u + time.minute ) * 60u + time.second ) * 1000u + time.millisecond;
+    }
+
+    /**
+     * Give every point with a time of day the date of the nearest earlier
+     * RMC sentence, moving to the next day when the time of day wraps.
+     * Points before the first RMC sentence take its date the same way.
+     */
+    void fillDates( std::vector<TrackPoint>& points )
+    {
+        size_t firstDated = 0;
+        while ( firstDated < points.size() && !( points[firstDated].hasDate && points[firstDated].hasTime ) )
+        {
+            firstDated++;
+        }
+
+        if ( firstDated == points.size() )
+        {
+            return;
+        }
+
+        const TrackPoint& anchor = points[firstDated];
+        const long anchorDay = nmeaParser::getDayNumber( anchor.year, anchor.month, anchor.day );
+
+        long day = anchorDay;
+        unsigned int lastMillisecond = millisecondOfDay( anchor.time );
+        for ( size_t i = firstDated; i-- > 0; )
+        {
+            if ( !points[i].hasTime )
+            {
+                continue;
+            }
+
+            const unsigned int millisecond = millisecondOfDay( points[i].time );
+            if ( millisecond > lastMillisecond )
+            {
+                day--;
+            }
+            lastMillisecond = millisecond;
+
+            points[i].hasDate = true;
+            civilFromDays( day, points[i].year, points[i].month, points[i].day );
+        }
+
+        day = anchorDay;
+        lastMillisecond = millisecondOfDay( anchor.time );
+        for ( size_t i = firstDated + 1; i < points.size(); i++ )
+        {
+            if ( !points[i].hasTime )
+            {
+                continue;
+            }
+
+            const unsigned int millisecond = millisecondOfDay( points[i].time );
+            if ( points[i].hasDate )
+            {
+                day = nmeaParser::getDayNumber( points[i].year, points[i].month, points[i].day );
+            }
+            else
+            {
+                if ( millisecond < lastMillisecond )
+                {
+                    day++;
+                }
+
+                points[i].hasDate = true;
+                civilFromDays( day, points[i].year, points[i].month, points[i].day );
+            }
+            lastMillisecond = millisecond;
+        }
+    }
+
+    /** ISO 8601 UTC time, or just the time of day if the date is unknown. Empty if neither is. */
+    std::string formatUtc( const TrackPoint& point )
+    {
+        char buffer[64] = {0};
+        if ( point.hasTime && point.hasDate )
+        {
+            snprintf( buffer, sizeof(buffer), "%04d-%02u-%02uT%02u:%02u:%02u.%03uZ",
+                point.year, point.month, point.day,
+                point.time.hour, point.time.minute, point.time.second, point.time.millisecond );
+        }
+        else if ( point.hasTime )
+        {
+            snprintf( buffer, sizeof(buffer), "%02u:%02u:%02u.%03u",
+                point.time.hour, point.time.minute, point.time.second, point.time.millisecond );
+        }
+        return buffer;
+    }
+
+    std::string escapeXml( const std::string& text )
+    {
+        std::string escaped;
+        for ( size_t i = 0; i < text.size(); i++ )
+        {
+            switch ( text[i] )
+            {
+            case '&': escaped += "&amp;"; break;
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            default: escaped += text[i]; break;
+            }
+        }
+        return escaped;
+    }
+
+    std::string formatCameraTime( const TrackPoint& point )
+    {
+        char buffer[32];
+        snprintf( buffer, sizeof(buffer), "%lu.%06lu", point.cameraSeconds, point.cameraMicroSeconds );
+        return buffer;
+    }
+
+    void writeGpx( FILE* pFile, const std::vector<TrackPoint>& points, const std::string& trackName )
+    {
+        fprintf( pFile,
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<gpx version=\"1.1\" creator=\"ladybugGpsExtract\" "
+            "xmlns=\"http://www.topografix.com/GPX/1/1\" xmlns:lb=\"http://www.ptgrey.com/ladybug/gpx/1\">\n"
+            "  <trk>\n"
+            "    <name>%s</name>\n"
+            "    <trkseg>\n", escapeXml( trackName ).c_str() );
+
+        for ( size_t i = 0; i < points.size(); i++ )
+        {
+            const TrackPoint& point = points[i];
+            if ( !point.hasPosition )
+            {
+                continue;
+            }
+
+            fprintf( pFile, "      <trkpt lat=\"%.8f\" lon=\"%.8f\">\n", point.latitude, point.longitude );
+            if ( point.hasAltitude )
+            {
+                fprintf( pFile, "        <ele>%.2f</ele>\n", point.altitude );
+            }
+
+            // GPX times must have a date
+            if ( point.hasTime && point.hasDate )
+            {
+                fprintf( pFile, "        <time>%s</time>\n", formatUtc( point ).c_str() );
+            }
+
+            fprintf( pFile, "        <name>%u</name>\n", point.frame );
+            if ( point.fixQuality > 0 )
+            {
+                fprintf( pFile, "        <fix>%s</fix>\n", point.fixQuality == 2 ? "dgps" : "3d" );
+            }
+
+            if ( point.satellites > 0 )
+            {
+                fprintf( pFile, "        <sat>%u</sat>\n        <hdop>%.1f</hdop>\n", point.satellites, point.hdop );
+            }
+
+            fprintf( pFile,
+                "        <extensions>\n"
+                "          <lb:frame>%u</lb:frame>\n"
+                "          <lb:cameraTime>%s</lb:cameraTime>\n"
+                "          <lb:fixQuality>%u</lb:fixQuality>\n",
+                point.frame, formatCameraTime( point ).c_str(), point.fixQuality );
+            if ( point.speedKmh >= 0.0 )
+            {
+                fprintf( pFile, "          <lb:speedKmh>%.2f</lb:speedKmh>\n", point.speedKmh );
+            }
+            fprintf( pFile, "        </extensions>\n      </trkpt>\n" );
+        }
+
+        fprintf( pFile, "    </trkseg>\n  </trk>\n</gpx>\n" );
+    }
+
+    void writeGeoJson( FILE* pFile, const std::vector<TrackPoint>& points )
+    {
+        fprintf( pFile, "{\n  \"type\": \"FeatureCollection\",\n  \"features\": [" );
+
+        bool isFirst = true;
+        for ( size_t i = 0; i < points.size(); i++ )
+        {
+            const TrackPoint& point = points[i];
+            if ( !point.hasPosition )
+            {
+                continue;
+            }
+
+            fprintf( pFile, "%s\n    {\"type\": \"Feature\", \"geometry\": {\"type\": \"Point\", \"coordinates\": [%.8f, %.8f",
+                isFirst ? "" : ",", point.longitude, point.latitude );
+            if ( point.hasAltitude )
+            {
+                fprintf( pFile, ", %.2f", point.altitude );
+            }
+
+            fprintf( pFile, "]}, \"properties\": {\"frame\": %u, \"camera_time\": %s",
+                point.frame, formatCameraTime( point ).c_str() );
+
+            const std::string utc = formatUtc( point );
+            if ( !utc.empty() )
+            {
+                fprintf( pFile, ", \"utc\": \"%s\"", utc.c_str() );
+            }
+
+            if ( point.speedKmh >= 0.0 )
+            {
+                fprintf( pFile, ", \"speed_kmh\": %.2f", point.speedKmh );
+            }
+
+            fprintf( pFile, ", \"fix_quality\": %u, \"satellites\": %u}}", point.fixQuality, point.satellites );
+            isFirst = false;
+        }
+
+        fprintf( pFile, "\n  ]\n}\n" );
+    }
+
+    /** One row per frame; the GPS columns are empty for frames without a position. */
+    void writeCsv( FILE* pFile, const std::vector<TrackPoint>& points )
+    {
+        fprintf( pFile, "frame,camera_time,utc,latitude,longitude,altitude,speed_kmh,fix_quality,satellites,course,roll,pitch,yaw\n" );
+
+        for ( size_t i = 0; i < points.size(); i++ )
+        {
+            const TrackPoint& point = points[i];
+            fprintf( pFile, "%u,%s,%s,", point.frame, formatCameraTime( point ).c_str(), formatUtc( point ).c_str() );
+
+            if ( point.hasPosition )
+            {
+                fprintf( pFile, "%.8f,%.8f,", point.latitude, point.longitude );
+            }
+            else
+            {
+                fprintf( pFile, ",," );
+            }
+
+            if ( point.hasAltitude )
+            {
+                fprintf( pFile, "%.2f", point.altitude );
+            }
+            fprintf( pFile, "," );
+
+            if ( point.speedKmh >= 0.0 )
+            {
+                fprintf( pFile, "%.2f", point.speedKmh );
+            }
+            fprintf( pFile, ",%u,%u,", point.fixQuality, point.satellites );
+
+            if ( point.courseDegrees >= 0.0 )
+            {
+                fprintf( pFile, "%.2f", point.courseDegrees );
+            }
+
+            if ( point.hasPose )
+            {
+                fprintf( pFile, ",%.3f,%.3f,%.3f\n", point.roll, point.pitch, point.yaw );
+            }
+            else
+            {
+                fprintf( pFile, ",,,\n" );
+            }
+        }
+    }
+
+    bool endsWith( const std::string& text, const char* pszSuffix )
+    {
+        const size_t suffixLength = strlen( pszSuffix );
+        if ( text.size() < suffixLength )
+        {
+            return false;
+        }
+
+        for ( size_t i = 0; i < suffixLength; i++ )
+        {
+            const char c = text[text.size() - suffixLength + i];
+            if ( ( c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c ) != pszSuffix[i] )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool getOutputFormat( const std::string& outputName, OutputFormat& format )
+    {
+        if ( endsWith( outputName, ".gpx" ) )
+        {
+            format = FORMAT_GPX;
+        }
+        else if ( endsWith( outputName, ".geojson" ) || endsWith( outputName, ".json" ) )
+        {
+            format = FORMAT_GEOJSON;
+        }
+        else if ( endsWith( outputName, ".csv" ) )
+        {
+            format = FORMAT_CSV;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+}
+
+void usage()
+{
+    printf (
+        "Usage :\n"
+        "\t ladybugGpsExtract SrcFileName OutputFileName [Threads]\n"
+        "\n"
+        "where\n"
+        "\t SrcFileName - the first PGR stream file of the stream, \n"
+        "\t for example c:\\Recorded\\LadybugStream-000000.pgr \n\n"
+        "\t OutputFileName - the track to write. The format is chosen by the \n"
+        "\t extension: .gpx, .geojson (or .json) or .csv\n\n"
+        "\t [Threads] - optional, the number of threads reading the stream. \n"
+        "\t Defaults to the number of processors.\n"
+        "\n"
+        );
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        usage();
+        return 0;
+    }
+
+    const std::string srcStreamName = argv[1];
+    const std::string outputName = argv[2];
+
+    OutputFormat format;
+    if ( !getOutputFormat( outputName, format ) )
+    {
+        printf( "Unknown output format for %s; use .gpx, .geojson or .csv\n", outputName.c_str() );
+        return -1;
+    }
+
+    unsigned int uiNumThreads = (argc > 3) ? (unsigned int)atoi( argv[3] ) : std::thread::hardware_concurrency();
+    uiNumThreads = std::max( 1u, uiNumThreads );
+
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    // Only the image count is needed here; each thread opens its own context
+    unsigned int uiNumOfImages = 0;
+    {
+        LadybugStreamContext context = NULL;
+        LadybugError error = ladybugCreateStreamContext( &context );
+        if ( error == LADYBUG_OK )
+        {
+            printf( "Opening stream file : %s\n", srcStreamName.c_str() );
+            error = ladybugInitializeStreamForReading( context, srcStreamName.c_str(), false );
+        }
+
+        if ( error == LADYBUG_OK )
+        {
+            error = ladybugGetStreamNumOfImages( context, &uiNumOfImages );
+        }
+
+        if ( context != NULL )
+        {
+            ladybugStopStream( context );
+            ladybugDestroyStreamContext( &context );
+        }
+
+        if ( error != LADYBUG_OK )
+        {
+            printf( "Error! Ladybug library reported %s\n", ::ladybugErrorToString( error ) );
+            return -1;
+        }
+    }
+
+    GpsTrackReader gpsTrackReader;
+    {
+        std::string errorMessage;
+        if ( gpsTrackReader.openForStream( srcStreamName, errorMessage ) )
+        {
+            printf( "GPS track : %s (%u records)\n", 
+                gpsTrack::getTrackPath( srcStreamName ).c_str(), gpsTrackReader.getNumRecords() );
+        }
+        else if ( !errorMessage.empty() )
+        {
+            printf( "Ignoring the GPS track: %s\n", errorMessage.c_str() );
+        }
+    }
+
+    // A range per thread, but not so small that seeking dominates
+    const unsigned int k_minFramesPerRange = 256;
+    uiNumThreads = std::max( 1u, std::min( uiNumThreads, uiNumOfImages / k_minFramesPerRange ) );
+
+    std::vector<FrameRange> ranges( uiNumThreads );
+    std::vector<std::thread> threads;
+    for ( unsigned int i = 0; i < uiNumThreads; i++ )
+    {
+        ranges[i].first = (unsigned int)( (unsigned long long)uiNumOfImages * i / uiNumThreads );
+        ranges[i].end = (unsigned int)( (unsigned long long)uiNumOfImages * ( i + 1 ) / uiNumThreads );
+        threads.push_back( std::thread( readRange, std::cref( srcStreamName ), std::cref( gpsTrackReader ), std::ref( ranges[i] ) ) );
+    }
+
+    std::vector<TrackPoint> points;
+    points.reserve( uiNumOfImages );
+    unsigned long long bytesRead = 0;
+    unsigned int framesFromTrack = 0;
+    unsigned int framesWithNmea = 0;
+    for ( unsigned int i = 0; i < uiNumThreads; i++ )
+    {
+        threads[i].join();
+    }
+
+    // A range that fails stops the track there, since later frames would leave a gap
+    for ( unsigned int i = 0; i < uiNumThreads; i++ )
+    {
+        points.insert( points.end(), ranges[i].points.begin(), ranges[i].points.end() );
+        bytesRead += ranges[i].bytesRead;
+        framesFromTrack += ranges[i].framesFromTrack;
+        framesWithNmea += ranges[i].framesWithNmea;
+
+        if ( ranges[i].error != LADYBUG_OK )
+        {
+            printf( "Reading stopped at image %u of %u: %s\n",
+                ranges[i].first + (unsigned int)ranges[i].points.size(),
+                uiNumOfImages,
+                ::ladybugErrorToString( ranges[i].error ) );
+            break;
+        }
+    }
+
+    fillDates( points );
+
+    FILE* pFile = fopen( outputName.c_str(), "w" );
+    if ( pFile == NULL )
+    {
+        printf( "Unable to create %s\n", outputName.c_str() );
+        return -1;
+    }
+
+    switch ( format )
+    {
+    case FORMAT_GPX:
+        writeGpx( pFile, points, srcStreamName );
+        break;
+    case FORMAT_GEOJSON:
+        writeGeoJson( pFile, points );
+        break;
+    case FORMAT_CSV:
+        writeCsv( pFile, points );
+        break;
+    }
+
+    if ( fclose( pFile ) != 0 )
+    {
+        printf( "Unable to write %s\n", outputName.c_str() );
+        return -1;
+    }
+
+    unsigned int framesWithPosition = 0;
+    for ( size_t i = 0; i < points.size(); i++ )
+    {
+        framesWithPosition += points[i].hasPosition ? 1 : 0;
+    }
+
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - startTime ).count();
+    printf( "Wrote %u of %u frames to %s; %u from the GPS track, %u with NMEA text and %u with a position.\n",
+        (unsigned int)points.size(), uiNumOfImages, outputName.c_str(), framesFromTrack, framesWithNmea, framesWithPosition );
+    printf( "Read %.1f MB in %.2f s with %u threads (%.0f frames/s, %.1f MB/s).\n",
+        bytesRead / ( 1024.0 * 1024.0 ), seconds, uiNumThreads,
+        seconds > 0.0 ? points.size() / seconds : 0.0,
+        seconds > 0.0 ? bytesRead / ( 1024.0 * 1024.0 ) / seconds : 0.0 );
+
+    return points.size() == uiNumOfImages ? 0 : -1;
+}
@@ -61,6 +61,7 @@
 #include <ladybuggeom.h>
 #include <ladybugrenderer.h>
 #include <ladybugstream.h>
+#include "OutputEncoder.h"
 
 //=============================================================================
 // Macro Definitions
@@ -228,6 +229,9 @@ main( int /*argc*/, char* /*argv[]*/ )
     int retry = 10;
     LadybugImage image;
 
+    // Encodes the stitched images while the next ones are grabbed
+    OutputEncoder outputEncoder;
+
     // create ladybug context
     printf( "Creating ladybug context...\n" );
     error = ladybugCreateContext( &context );
@@ -304,10 +308,21 @@ main( int /*argc*/, char* /*argv[]*/ )
         const std::string outputPath = getWriteableDirectory() + std::string(pszOutputName);
         printf("Writing image %s...\n", outputPath.c_str());
 
-        error = ladybugSaveImage( context, &processedImage, outputPath.c_str(), LADYBUG_FILEFORMAT_JPG );
+        error = outputEncoder.submit( processedImage, outputPath, OutputEncoder::FORMAT_JPEG ) ? LADYBUG_OK : LADYBUG_FAILED;
         _HANDLE_ERROR
     }
 
+    outputEncoder.waitAll();
+    if ( outputEncoder.getNumFailed() > 0 )
+    {
+        printf( "Error! Failed writing %s\n", outputEncoder.getLastFailedPath().c_str() );
+    }
+    else
+    {
+        printf( "Encoded in %.1f ms per image\n", 
+            outputEncoder.getEncodeSeconds() * 1000.0 / IMAGES_TO_GRAB );
+    }
+
     printf("Done.\n");
 
 _EXIT:
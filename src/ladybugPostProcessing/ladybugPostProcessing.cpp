@@ -33,6 +33,8 @@
 #include "ladybugImageAdjustment.h"
 #include "ladybuggeom.h"
 #include "ladybugrenderer.h"
+#include "CameraSelection.h"
+#include "OutputEncoder.h"
 
 #ifdef _WIN32
 
@@ -92,8 +94,19 @@ namespace
 void handleError(LadybugError error, const char* message = NULL);
 void setPostProcessingOptions(LadybugContext context);
 
-int main( int /* argc */, char* /* argv[] */ )
+int main( int argc, char* argv[] )
 {
+    // The cameras to process, e.g. "01234" to leave out the top camera
+    CameraSelection cameraSelection;
+    if ( argc > 1 && !cameraSelection.parse( argv[1] ) )
+    {
+        printf( "Usage: %s [CAMERAS[:FILL]]\n", argv[0] );
+        printf( "  CAMERAS lists the cameras to process, e.g. 01234. The others are\n" );
+        printf( "  converted once and then show FILL: blur (default), gray or black.\n" );
+        return 1;
+    }
+    printf( "Processing %s.\n", cameraSelection.describe().c_str() );
+
     // Initialize context.
     LadybugContext context;
     handleError( ladybugCreateContext(&context) );
@@ -146,6 +159,9 @@ int main( int /* argc */, char* /* argv[] */ )
 	// Set conversion properties for post-procesing
 	setPostProcessingOptions( context );
 
+    // Write the panoramas on other threads while the next images are processed
+    OutputEncoder outputEncoder;
+
     // Grab images and process them
     LadybugProcessedImage processedImage;
     for (int i=0; i < 25; i++)
@@ -158,22 +174,29 @@ int main( int /* argc */, char* /* argv[] */ )
         // If the result is not desired, then ladybugConvertImage() can be used too
         printf("Converting image...\n");
 
+        // Skipped cameras have NULL buffers after the first image, so the
+        // library neither converts nor uploads them
+        unsigned char* arpActiveBuffers[LADYBUG_NUM_CAMERAS];
+        cameraSelection.getActiveBuffers(arpBuffers, arpActiveBuffers);
+
         bool outputDesired = true;
         if (outputDesired)
         {
             ConvertImageOutput convertedImageResults;
-            handleError( ladybugConvertImageEx(context, &image, arpBuffers, LADYBUG_BGRU16, convertedImageResults), "ladybugConvertImage()" );
+            handleError( ladybugConvertImageEx(context, &image, arpActiveBuffers, LADYBUG_BGRU16, convertedImageResults), "ladybugConvertImage()" );
 
             printf("Grabbed image %d - target mean was %s\n", i, convertedImageResults.targetMeanReach ? "reached" : "not reached");        
         }
         else
         {
-            handleError( ladybugConvertImage(context, &image, arpBuffers, LADYBUG_BGRU16), "ladybugConvertImage()" );
+            handleError( ladybugConvertImage(context, &image, arpActiveBuffers, LADYBUG_BGRU16), "ladybugConvertImage()" );
         }        
 
+        cameraSelection.applyFill(arpBuffers, image.uiCols, image.uiRows, LADYBUG_BGRU16);
+
         // Update textures
         printf("Updating textures...\n");
-        handleError(ladybugUpdateTextures(context, LADYBUG_NUM_CAMERAS, (const unsigned char**)arpBuffers, LADYBUG_BGRU16), "ladybugUpdateTextures");
+        handleError(ladybugUpdateTextures(context, LADYBUG_NUM_CAMERAS, (const unsigned char**)arpActiveBuffers, LADYBUG_BGRU16), "ladybugUpdateTextures");
 
         // Render panorama
         printf("Rendering panorama...\n");
@@ -183,11 +206,22 @@ int main( int /* argc */, char* /* argv[] */ )
         char filename[_MAX_PATH] = {0};
         sprintf(filename, "ladybugPostProcessing-panoramic-%d.jpg", i);
         const std::string outputPath = getWriteableDirectory() + std::string(filename);
-        handleError(ladybugSaveImage(context, &processedImage, outputPath.c_str(), LADYBUG_FILEFORMAT_JPG), "ladybugSaveImage");
+        const bool queued = outputEncoder.submit(processedImage, outputPath, OutputEncoder::FORMAT_JPEG);
+        handleError(queued ? LADYBUG_OK : LADYBUG_FAILED, "OutputEncoder::submit");
 
-        printf("Conversion successful - saved %s\n", outputPath.c_str());
+        printf("Conversion successful - saving %s\n", outputPath.c_str());
     }     
 
+    outputEncoder.waitAll();
+    if (outputEncoder.getNumFailed() > 0)
+    {
+        printf("Failed writing %u images, the last was %s\n", outputEncoder.getNumFailed(), outputEncoder.getLastFailedPath().c_str());
+    }
+    if (outputEncoder.getNumWritten() > 0)
+    {
+        printf("Encoded in %.1f ms per image\n", outputEncoder.getEncodeSeconds() * 1000.0 / outputEncoder.getNumWritten());
+    }
+
     printf("Stopping camera\n");
     handleError( ladybugStop(context), "ladybugStop()" );
 
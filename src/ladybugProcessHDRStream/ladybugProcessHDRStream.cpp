@@ -0,0 +1,898 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//
+// ladybugProcessHDRStream.cpp
+// 
+// This program processes streams that LadybugCaptureHDRImage recorded in 
+// HDR mode. The camera cycles through four shutter and gain settings, and
+// the bracket file next to the stream (name.hdrb) tells which setting each
+// frame was taken with and which pass through the settings, or sequence, 
+// it belongs to. The frames of each sequence are color processed, merged 
+// into radiance (see HdrMerger) and stitched into one HDR panorama, which 
+// is written as a Radiance .hdr, an OpenEXR .exr and a tone mapped .jpg.
+//
+// Frames dropped while recording leave sequences with fewer frames. They
+// are merged from the frames that are there, over the same encoding range
+// as full sequences. Sequences with fewer than -m frames are skipped.
+//
+// Sequences are processed by a pool of workers, each with its own Ladybug 
+// context and stream reader. Workers read, color process and merge a 
+// sequence, the main thread stitches it, and a worker writes the files. 
+// Each worker holds the textures of one sequence, about 1 GB at full 
+// resolution of a Ladybug5, so the number of workers is limited by -t.
+//
+// Use -? to display the usage help.
+//
+//=============================================================================
+
+//=============================================================================
+// System Includes
+//=============================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//=============================================================================
+// PGR Includes
+//=============================================================================
+#include <ladybug.h>
+#include <ladybugrenderer.h>
+#include <ladybugstream.h>
+
+//=============================================================================
+// Project Includes
+//=============================================================================
+#include "getopt.h"
+#include "HdrBrackets.h"
+#include "HdrFile.h"
+#include "HdrMerge.h"
+#include "ToneMapper.h"
+
+#ifndef _WIN32
+#define _MAX_PATH 4096
+#endif
+
+namespace
+{
+    const unsigned int k_defaultCols = 2048;
+    const unsigned int k_defaultRows = 1024;
+    const unsigned int k_defaultMaxWorkers = 4;
+    const unsigned int k_defaultMinFrames = 2;
+    const int k_jpegQuality = 95;
+
+    enum OutputFlags
+    {
+        OUTPUT_HDR = 1 << 0,
+        OUTPUT_EXR = 1 << 1,
+        OUTPUT_JPG = 1 << 2
+    };
+
+    struct Options
+    {
+        std::string inputPath;
+        std::string outputPrefix;
+        unsigned int cols;
+        unsigned int rows;
+        unsigned int outputs;
+        unsigned int numWorkers;
+        unsigned int minFrames;
+        unsigned int firstSequence;
+        unsigned int lastSequence;
+        LadybugColorProcessingMethod colorProcessingMethod;
+        ToneMapper::Settings toneMapping;
+    };
+
+    struct Sequence
+    {
+        unsigned int number;
+
+        /** Frame of each bracket, or -1 where it was dropped. */
+        int frames[hdrBrackets::k_maxLevels];
+        unsigned int numFrames;
+    };
+
+    /** A sequence on its way through the stages. */
+    struct Job
+    {
+        const Sequence* pSequence;
+
+        /** Merged textures of the six cameras. */
+        std::vector<unsigned short> textures;
+
+        /** The stitched panorama. */
+        std::vector<float> radiance;
+        unsigned int cols;
+        unsigned int rows;
+    };
+
+    /**
+     * Hands sequences to the workers and passes jobs between the stages. 
+     * Writing the files of a job comes before starting a new one, and no 
+     * more than maxJobs are in flight, which bounds the memory in use.
+     */
+    class Pipeline
+    {
+    public:
+        Pipeline( const std::vector<Sequence>& sequences, unsigned int maxJobs ) :
+        m_sequences( sequences ),
+        m_nextSequence( 0 ),
+        m_maxJobs( maxJobs ),
+        m_numJobs( 0 ),
+        m_numWritten( 0 ),
+        m_numFailed( 0 )
+        {
+        }
+
+        /** 
+         * Wait for a rendered job to write or a sequence to start. Returns 
+         * false when there is neither left.
+         */
+        bool takeWork( std::unique_ptr<Job>& pRendered, const Sequence*& pSequence )
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            for ( ;; )
+            {
+                if ( !m_rendered.empty() )
+                {
+                    pRendered = std::move( m_rendered.front() );
+                    m_rendered.pop_front();
+                    return true;
+                }
+                if ( m_nextSequence < m_sequences.size() && m_numJobs < m_maxJobs )
+                {
+                    pSequence = &m_sequences[m_nextSequence++];
+                    m_numJobs++;
+                    return true;
+                }
+                if ( m_nextSequence == m_sequences.size() && m_numJobs == 0 )
+                {
+                    return false;
+                }
+                m_changed.wait( lock );
+            }
+        }
+
+        void submitMerged( std::unique_ptr<Job> pJob )
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_merged.push_back( std::move( pJob ) );
+            m_changed.notify_all();
+        }
+
+        /** The next merged job to stitch, or NULL when all are done. */
+        std::unique_ptr<Job> takeMerged()
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            for ( ;; )
+            {
+                if ( !m_merged.empty() )
+                {
+                    std::unique_ptr<Job> pJob = std::move( m_merged.front() );
+                    m_merged.pop_front();
+                    return pJob;
+                }
+                if ( m_nextSequence == m_sequences.size() && m_numJobs == 0 )
+                {
+                    return std::unique_ptr<Job>();
+                }
+                m_changed.wait( lock );
+            }
+        }
+
+        void submitRendered( std::unique_ptr<Job> pJob )
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_rendered.push_back( std::move( pJob ) );
+            m_changed.notify_all();
+        }
+
+        /** A job has left the stages, written or not. */
+        void finish( bool isWritten )
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_numJobs--;
+            if ( isWritten )
+            {
+                m_numWritten++;
+            }
+            else
+            {
+                m_numFailed++;
+            }
+            m_changed.notify_all();
+        }
+
+        unsigned int getNumWritten() const { return m_numWritten; }
+        unsigned int getNumFailed() const { return m_numFailed; }
+
+    private:
+        const std::vector<Sequence>& m_sequences;
+        size_t m_nextSequence;
+        const unsigned int m_maxJobs;
+        unsigned int m_numJobs;
+        unsigned int m_numWritten;
+        unsigned int m_numFailed;
+
+        std::deque< std::unique_ptr<Job> > m_merged;
+        std::deque< std::unique_ptr<Job> > m_rendered;
+
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+    };
+
+    /** What each worker thread owns. */
+    struct Worker
+    {
+        explicit Worker( unsigned int numThreads ) :
+        context( NULL ),
+        streamContext( NULL ),
+        merger( numThreads ),
+        toneMapper( numThreads )
+        {
+        }
+
+        ~Worker()
+        {
+            if ( streamContext != NULL )
+            {
+                ladybugStopStream( streamContext );
+                ladybugDestroyStreamContext( &streamContext );
+            }
+            if ( context != NULL )
+            {
+                ladybugDestroyContext( &context );
+            }
+        }
+
+        LadybugContext context;
+        LadybugStreamContext streamContext;
+        HdrMerger merger;
+        ToneMapper toneMapper;
+
+        /** Color processed frames of the sequence, one set per bracket. */
+        std::vector<unsigned short> textures;
+    };
+
+    void printError( const char* pszWhat, LadybugError error )
+    {
+        printf( "Error! %s - %s\n", pszWhat, ladybugErrorToString( error ) );
+    }
+
+    void displayUsage( const char* pszProgramName )
+    {
+        printf( "Usage: \n\n" );
+        printf( "%s [OPTIONS]\n\n", pszProgramName );
+        printf( 
+            "OPTIONS\n\n"
+            "  -i STREAM_PATH     The PGR stream file to process, recorded by\n"
+            "                     LadybugCaptureHDRImage with its bracket file (.hdrb).\n"
+            "  -r NNN-NNN         The range of sequences to process. The first is 0.\n"
+            "                     Default setting is to process all of them.\n"
+            "  -o OUTPUT_PATH     Output file prefix. Files are named\n"
+            "                     OUTPUT_PATH_NNNNNN.hdr/.exr/.jpg by sequence.\n"
+            "                     Default is hdr\n"
+            "  -w NNNNxNNNN       Output image size (widthxheight) in pixel. \n"
+            "                     Default is %ux%u.\n"
+            "  -f hdr,exr,jpg     Output files, as a comma separated list. \n"
+            "                     Default is all three.\n"
+            "  -m N               Skip sequences with fewer than N frames left.\n"
+            "                     Default is %u.\n"
+            "  -t N               Number of workers. Default is one per hardware\n"
+            "                     thread, up to %u.\n"
+            "  -c METHOD          Color processing method: hq (default), edge or\n"
+            "                     directional.\n"
+            "  -k KEY             Key of the tone mapped image, 0 to 1. Default is %.2f.\n"
+            "  -x STOPS           Stops added to the exposure of the tone mapped image.\n"
+            "  -e                 Tone map by exposure only, without compressing the\n"
+            "                     highlights.\n"
+            "  -?                 Display this help.\n"
+            "\n"
+            "Example: %s -i hdr-000000.pgr -w 4096x2048 -f exr,jpg -o out/pano\n",
+            k_defaultCols, k_defaultRows, k_defaultMinFrames, k_defaultMaxWorkers,
+            ToneMapper::getDefaultSettings().key, pszProgramName );
+    }
+
+    bool parseOutputs( const char* pszList, unsigned int& outputs )
+    {
+        outputs = 0;
+        std::string list( pszList );
+        size_t start = 0;
+        while ( start <= list.size() )
+        {
+            size_t end = list.find( ',', start );
+            if ( end == std::string::npos )
+            {
+                end = list.size();
+            }
+
+            const std::string name = list.substr( start, end - start );
+            if ( name == "hdr" )
+            {
+                outputs |= OUTPUT_HDR;
+            }
+            else if ( name == "exr" )
+            {
+                outputs |= OUTPUT_EXR;
+            }
+            else if ( name == "jpg" )
+            {
+                outputs |= OUTPUT_JPG;
+            }
+            else
+            {
+                return false;
+            }
+            start = end + 1;
+        }
+        return outputs != 0;
+    }
+
+    /** 
+     * Group the frames by sequence. Frames of no known bracket are left 
+     * out, and so is all but the first frame of a bracket in a sequence.
+     */
+    void groupSequences( 
+        const std::vector<HdrBracketEntry>& entries, 
+        const Options& options, 
+        std::vector<Sequence>& sequences, 
+        unsigned int& numSkipped )
+    {
+        sequences.clear();
+        numSkipped = 0;
+
+        Sequence current;
+        bool hasCurrent = false;
+        for ( size_t frame = 0; frame <= entries.size(); frame++ )
+        {
+            const bool isEnd = frame == entries.size();
+            if ( !isEnd && entries[frame].bracket < 0 )
+            {
+                continue;
+            }
+
+            if ( hasCurrent && ( isEnd || entries[frame].sequence != current.number ) )
+            {
+                if ( current.number >= options.firstSequence && current.number <= options.lastSequence )
+                {
+                    if ( current.numFrames >= options.minFrames )
+                    {
+                        sequences.push_back( current );
+                    }
+                    else
+                    {
+                        numSkipped++;
+                    }
+                }
+                hasCurrent = false;
+            }
+            if ( isEnd )
+            {
+                break;
+            }
+
+            if ( !hasCurrent )
+            {
+                current.number = entries[frame].sequence;
+                current.numFrames = 0;
+                std::fill( current.frames, current.frames + hdrBrackets::k_maxLevels, -1 );
+                hasCurrent = true;
+            }
+
+            int& slot = current.frames[entries[frame].bracket];
+            if ( slot < 0 )
+            {
+                slot = (int)frame;
+                current.numFrames++;
+            }
+        }
+    }
+
+    /** Read, color process and merge the frames of a sequence. */
+    bool mergeSequence( 
+        Worker& worker, 
+        const std::vector<HdrBracketLevel>& levels, 
+        unsigned int textureCols, 
+        unsigned int textureRows, 
+        Job& job )
+    {
+        const Sequence& sequence = *job.pSequence;
+        const size_t textureSize = (size_t)textureCols * textureRows * 4;
+        worker.textures.resize( hdrBrackets::k_maxLevels * LADYBUG_NUM_CAMERAS * textureSize );
+        job.textures.resize( LADYBUG_NUM_CAMERAS * textureSize );
+
+        std::vector<HdrMerger::Exposure> exposures;
+        for ( unsigned int bracket = 0; bracket < levels.size(); bracket++ )
+        {
+            if ( sequence.frames[bracket] < 0 )
+            {
+                continue;
+            }
+
+            LadybugImage image;
+            LadybugError error = ladybugGoToImage( worker.streamContext, (unsigned int)sequence.frames[bracket] );
+            if ( error == LADYBUG_OK )
+            {
+                error = ladybugReadImageFromStream( worker.streamContext, &image );
+            }
+            if ( error != LADYBUG_OK )
+            {
+                printError( "Unable to read a frame", error );
+                return false;
+            }
+            if ( image.uiCols != textureCols || image.uiRows != textureRows )
+            {
+                printf( "Error! Frame %d has a different size\n", sequence.frames[bracket] );
+                return false;
+            }
+
+            HdrMerger::Exposure exposure;
+            unsigned short* arpTextures[LADYBUG_NUM_CAMERAS];
+            for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+            {
+                arpTextures[camera] = &worker.textures[( bracket * LADYBUG_NUM_CAMERAS + camera ) * textureSize];
+                exposure.textures[camera] = arpTextures[camera];
+            }
+            exposure.exposure = levels[bracket].getExposure();
+
+            // The alpha channel is only set in buffers converted after this
+            ladybugSetAlphaMasking( worker.context, true );
+            error = ladybugConvertImage( 
+                worker.context, &image, reinterpret_cast<unsigned char**>( arpTextures ), LADYBUG_BGRU16 );
+            if ( error != LADYBUG_OK )
+            {
+                printError( "Unable to color process a frame", error );
+                return false;
+            }
+            exposures.push_back( exposure );
+        }
+
+        unsigned short* arpMerged[LADYBUG_NUM_CAMERAS];
+        for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+        {
+            arpMerged[camera] = &job.textures[camera * textureSize];
+        }
+        return worker.merger.merge( exposures, textureCols, textureRows, arpMerged );
+    }
+
+    /** Write the files of a stitched sequence. */
+    bool writeSequence( Worker& worker, const Options& options, const Job& job )
+    {
+        char pszBaseName[_MAX_PATH];
+        snprintf( pszBaseName, sizeof(pszBaseName), "%s_%06u", 
+            options.outputPrefix.c_str(), job.pSequence->number );
+        const std::string baseName( pszBaseName );
+
+        std::string errorMessage;
+        if ( ( options.outputs & OUTPUT_HDR ) != 0 && 
+            !hdrFile::writeRadiance( baseName + ".hdr", &job.radiance[0], job.cols, job.rows, errorMessage ) )
+        {
+            printf( "Error! %s\n", errorMessage.c_str() );
+            return false;
+        }
+        if ( ( options.outputs & OUTPUT_EXR ) != 0 && 
+            !hdrFile::writeOpenExr( baseName + ".exr", &job.radiance[0], job.cols, job.rows, errorMessage ) )
+        {
+            printf( "Error! %s\n", errorMessage.c_str() );
+            return false;
+        }
+
+        if ( ( options.outputs & OUTPUT_JPG ) != 0 )
+        {
+            const size_t pixelCount = (size_t)job.cols * job.rows;
+            std::vector<unsigned char> toneMapped( pixelCount * 3 );
+            worker.toneMapper.map( &job.radiance[0], pixelCount, options.toneMapping, &toneMapped[0] );
+
+            LadybugProcessedImage image;
+            memset( &image, 0, sizeof(image) );
+            image.uiCols = job.cols;
+            image.uiRows = job.rows;
+            image.pData = &toneMapped[0];
+            image.pixelFormat = LADYBUG_BGR;
+
+            const std::string path = baseName + ".jpg";
+            ladybugSetImageSavingJpegQuality( worker.context, k_jpegQuality );
+            const LadybugError error = ladybugSaveImage( worker.context, &image, path.c_str(), LADYBUG_FILEFORMAT_JPG );
+            if ( error != LADYBUG_OK )
+            {
+                printError( ( "Unable to write " + path ).c_str(), error );
+                return false;
+            }
+        }
+
+        printf( "Sequence %u: %u of %u frames\n", 
+            job.pSequence->number, job.pSequence->numFrames, (unsigned int)hdrBrackets::k_maxLevels );
+        return true;
+    }
+
+    void runWorker( 
+        Worker& worker, 
+        Pipeline& pipeline, 
+        const Options& options, 
+        const std::vector<HdrBracketLevel>& levels, 
+        unsigned int textureCols, 
+        unsigned int textureRows )
+    {
+        std::unique_ptr<Job> pRendered;
+        const Sequence* pSequence = NULL;
+        while ( pipeline.takeWork( pRendered, pSequence ) )
+        {
+            if ( pRendered )
+            {
+                pipeline.finish( writeSequence( worker, options, *pRendered ) );
+                pRendered.reset();
+                continue;
+            }
+
+            std::unique_ptr<Job> pJob( new Job );
+            pJob->pSequence = pSequence;
+            if ( mergeSequence( worker, levels, textureCols, textureRows, *pJob ) )
+            {
+                pipeline.submitMerged( std::move( pJob ) );
+            }
+            else
+            {
+                printf( "Sequence %u skipped\n", pSequence->number );
+                pipeline.finish( false );
+            }
+        }
+    }
+
+    /** A context for the stream, with the calibration of its camera. */
+    LadybugError createContext( 
+        const Options& options, 
+        const char* pszConfigFile, 
+        LadybugContext& context, 
+        LadybugStreamContext& streamContext )
+    {
+        LadybugError error = ladybugCreateContext( &context );
+        if ( error == LADYBUG_OK )
+        {
+            error = ladybugCreateStreamContext( &streamContext );
+        }
+        if ( error == LADYBUG_OK )
+        {
+            error = ladybugInitializeStreamForReading( streamContext, options.inputPath.c_str(), true );
+        }
+        if ( error == LADYBUG_OK && pszConfigFile != NULL )
+        {
+            error = ladybugLoadConfig( context, pszConfigFile );
+        }
+        if ( error == LADYBUG_OK )
+        {
+            error = ladybugSetColorProcessingMethod( context, options.colorProcessingMethod );
+        }
+        return error;
+    }
+
+    int processStream( const Options& options )
+    {
+        //
+        // Find the sequences in the bracket file
+        //
+        std::vector<HdrBracketLevel> levels;
+        std::vector<HdrBracketEntry> entries;
+        std::string errorMessage;
+        const std::string bracketPath = hdrBrackets::getBracketPath( options.inputPath );
+        if ( !hdrBrackets::read( bracketPath, levels, entries, errorMessage ) )
+        {
+            printf( "Error! %s\n", errorMessage.c_str() );
+            printf( "Streams are processed with the bracket file that LadybugCaptureHDRImage writes.\n" );
+            return 1;
+        }
+        if ( levels.empty() )
+        {
+            printf( "Error! %s has no brackets\n", bracketPath.c_str() );
+            return 1;
+        }
+
+        std::vector<Sequence> sequences;
+        unsigned int numSkipped = 0;
+        groupSequences( entries, options, sequences, numSkipped );
+
+        unsigned int numFull = 0;
+        for ( size_t i = 0; i < sequences.size(); i++ )
+        {
+            numFull += sequences[i].numFrames == levels.size() ? 1 : 0;
+        }
+        printf( "%u brackets, %u frames: %u sequences to process, %u of them with dropped frames, %u skipped\n", 
+            (unsigned int)levels.size(), (unsigned int)entries.size(), (unsigned int)sequences.size(), 
+            (unsigned int)sequences.size() - numFull, numSkipped );
+        for ( size_t i = 0; i < levels.size(); i++ )
+        {
+            printf( "  [%u] shutter %.3f ms, gain %.2f dB\n", (unsigned int)i, levels[i].shutterMs, levels[i].gainDb );
+        }
+        if ( sequences.empty() )
+        {
+            return 0;
+        }
+
+        //
+        // The stitching context, with the calibration of the stream
+        //
+        LadybugContext context = NULL;
+        LadybugStreamContext streamContext = NULL;
+        LadybugError error = createContext( options, NULL, context, streamContext );
+        if ( error != LADYBUG_OK )
+        {
+            printError( "Unable to open the stream", error );
+            return 1;
+        }
+
+        char pszConfigFile[_MAX_PATH] = "hdrstream.cal";
+        error = ladybugGetStreamConfigFile( streamContext, pszConfigFile );
+        if ( error == LADYBUG_OK )
+        {
+            error = ladybugLoadConfig( context, pszConfigFile );
+        }
+
+        // Texture size from the first frame to process
+        LadybugImage image;
+        int firstFrame = 0;
+        for ( unsigned int bracket = 0; bracket < hdrBrackets::k_maxLevels; bracket++ )
+        {
+            firstFrame = std::max( firstFrame, sequences[0].frames[bracket] );
+        }
+        if ( error == LADYBUG_OK )
+        {
+            error = ladybugGoToImage( streamContext, (unsigned int)firstFrame );
+        }
+        if ( error == LADYBUG_OK )
+        {
+            error = ladybugReadImageFromStream( streamContext, &image );
+        }
+        const unsigned int textureCols = image.uiCols;
+        const unsigned int textureRows = image.uiRows;
+
+        // Initialize alpha mask size - this can take a long time if the
+        // masks are not present in the current directory.
+        if ( error == LADYBUG_OK )
+        {
+            printf( "Initialize alpha masks (this may take a long time)...\n" );
+            error = ladybugInitializeAlphaMasks( context, textureCols, textureRows );
+        }
+        if ( error == LADYBUG_OK )
+        {
+            error = ladybugConfigureOutputImages( context, LADYBUG_PANORAMIC );
+        }
+        if ( error == LADYBUG_OK )
+        {
+            error = ladybugSetOffScreenImageSize( context, LADYBUG_PANORAMIC, options.cols, options.rows );
+        }
+        if ( error != LADYBUG_OK )
+        {
+            printError( "Unable to set up stitching", error );
+            remove( pszConfigFile );
+            ladybugDestroyStreamContext( &streamContext );
+            ladybugDestroyContext( &context );
+            return 1;
+        }
+
+        //
+        // Workers, with their own contexts. The threads of the merge and 
+        // tone mapping pools are shared out among them.
+        //
+        double minExposure = levels[0].getExposure();
+        double maxExposure = minExposure;
+        for ( size_t i = 1; i < levels.size(); i++ )
+        {
+            minExposure = std::min( minExposure, levels[i].getExposure() );
+            maxExposure = std::max( maxExposure, levels[i].getExposure() );
+        }
+
+        const unsigned int numWorkers = std::max( 1u, std::min( options.numWorkers, (unsigned int)sequences.size() ) );
+        const unsigned int threadsPerWorker = std::max( 1u, std::thread::hardware_concurrency() / numWorkers );
+        std::vector< std::unique_ptr<Worker> > workers;
+        for ( unsigned int i = 0; i < numWorkers && error == LADYBUG_OK; i++ )
+        {
+            std::unique_ptr<Worker> pWorker( new Worker( threadsPerWorker ) );
+            error = createContext( options, pszConfigFile, pWorker->context, pWorker->streamContext );
+            if ( error == LADYBUG_OK )
+            {
+                error = ladybugInitializeAlphaMasks( pWorker->context, textureCols, textureRows );
+            }
+            pWorker->merger.setRange( minExposure, maxExposure );
+            workers.push_back( std::move( pWorker ) );
+        }
+        remove( pszConfigFile );
+        if ( error != LADYBUG_OK )
+        {
+            printError( "Unable to set up the workers", error );
+            workers.clear();
+            ladybugDestroyStreamContext( &streamContext );
+            ladybugDestroyContext( &context );
+            return 1;
+        }
+
+        // Decodes what any of the workers merged
+        HdrMerger decoder( 1 );
+        decoder.setRange( minExposure, maxExposure );
+        printf( "Processing with %u workers, %.1f stops of range...\n", numWorkers, decoder.getRangeStops() );
+
+        //
+        // Stitch on this thread, which owns the rendering context, while 
+        // the workers merge and write
+        //
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Pipeline pipeline( sequences, 2 * numWorkers );
+        std::vector<std::thread> threads;
+        for ( unsigned int i = 0; i < numWorkers; i++ )
+        {
+            threads.push_back( std::thread( runWorker, 
+                std::ref( *workers[i] ), std::ref( pipeline ), std::cref( options ), std::cref( levels ), 
+                textureCols, textureRows ) );
+        }
+
+        for ( std::unique_ptr<Job> pJob = pipeline.takeMerged(); pJob; pJob = pipeline.takeMerged() )
+        {
+            const size_t textureSize = (size_t)textureCols * textureRows * 4;
+            const unsigned char* arpTextures[LADYBUG_NUM_CAMERAS];
+            for ( unsigned int camera = 0; camera < LADYBUG_NUM_CAMERAS; camera++ )
+            {
+                arpTextures[camera] = reinterpret_cast<const unsigned char*>( &pJob->textures[camera * textureSize] );
+            }
+
+            LadybugProcessedImage processedImage;
+            error = ladybugUpdateTextures( context, LADYBUG_NUM_CAMERAS, arpTextures, LADYBUG_BGRU16 );
+            if ( error == LADYBUG_OK )
+            {
+                error = ladybugRenderOffScreenImage( context, LADYBUG_PANORAMIC, LADYBUG_BGR16, &processedImage );
+            }
+            if ( error != LADYBUG_OK )
+            {
+                printError( "Unable to stitch a sequence", error );
+                pipeline.finish( false );
+                continue;
+            }
+
+            // The textures are no longer needed once stitched
+            std::vector<unsigned short>().swap( pJob->textures );
+
+            pJob->cols = processedImage.uiCols;
+            pJob->rows = processedImage.uiRows;
+            pJob->radiance.resize( (size_t)pJob->cols * pJob->rows * 3 );
+            decoder.decode( 
+                reinterpret_cast<const unsigned short*>( processedImage.pData ), 
+                (size_t)pJob->cols * pJob->rows, 
+                &pJob->radiance[0] );
+            pipeline.submitRendered( std::move( pJob ) );
+        }
+
+        for ( size_t i = 0; i < threads.size(); i++ )
+        {
+            threads[i].join();
+        }
+
+        const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        printf( "%u sequences written, %u failed, in %.1f s (%.2f per second)\n", 
+            pipeline.getNumWritten(), pipeline.getNumFailed(), seconds, 
+            seconds > 0.0 ? pipeline.getNumWritten() / seconds : 0.0 );
+
+        workers.clear();
+        ladybugReleaseOffScreenImage( context, LADYBUG_PANORAMIC );
+        ladybugStopStream( streamContext );
+        ladybugDestroyStreamContext( &streamContext );
+        ladybugDestroyContext( &context );
+
+        return pipeline.getNumFailed() == 0 ? 0 : 1;
+    }
+}
+
+int 
+main( int argc, char* argv[] )
+{
+    Options options;
+    options.outputPrefix = "hdr";
+    options.cols = k_defaultCols;
+    options.rows = k_defaultRows;
+    options.outputs = OUTPUT_HDR | OUTPUT_EXR | OUTPUT_JPG;
+    options.numWorkers = std::max( 1u, std::min( k_defaultMaxWorkers, std::thread::hardware_concurrency() ) );
+    options.minFrames = k_defaultMinFrames;
+    options.firstSequence = 0;
+    options.lastSequence = 0xffffffff;
+    options.colorProcessingMethod = LADYBUG_HQLINEAR;
+    options.toneMapping = ToneMapper::getDefaultSettings();
+
+    if ( argc == 1 )
+    {
+        displayUsage( argv[0] );
+        return 0;
+    }
+
+    bool bBadArgs = false;
+    char* pszCurrParam = NULL;
+    char pszValidOpts[] = "i:r:o:w:f:m:t:c:k:x:e?";
+    int iOpt = 0;
+    while ( ( iOpt = GetOption( argc, argv, pszValidOpts, &pszCurrParam ) ) != 0 )
+    {
+        switch ( iOpt )
+        {
+        case 'i':
+            options.inputPath = pszCurrParam;
+            break;
+        case 'r':
+            bBadArgs |= sscanf( pszCurrParam, "%u-%u", &options.firstSequence, &options.lastSequence ) != 2;
+            break;
+        case 'o':
+            options.outputPrefix = pszCurrParam;
+            break;
+        case 'w':
+            bBadArgs |= sscanf( pszCurrParam, "%ux%u", &options.cols, &options.rows ) != 2 || 
+                options.cols == 0 || options.rows == 0;
+            break;
+        case 'f':
+            bBadArgs |= !parseOutputs( pszCurrParam, options.outputs );
+            break;
+        case 'm':
+            bBadArgs |= sscanf( pszCurrParam, "%u", &options.minFrames ) != 1 || options.minFrames == 0;
+            break;
+        case 't':
+            bBadArgs |= sscanf( pszCurrParam, "%u", &options.numWorkers ) != 1 || options.numWorkers == 0;
+            break;
+        case 'c':
+            if ( strcmp( pszCurrParam, "hq" ) == 0 )
+            {
+                options.colorProcessingMethod = LADYBUG_HQLINEAR;
+            }
+            else if ( strcmp( pszCurrParam, "edge" ) == 0 )
+            {
+                options.colorProcessingMethod = LADYBUG_EDGE_SENSING;
+            }
+            else if ( strcmp( pszCurrParam, "directional" ) == 0 )
+            {
+                options.colorProcessingMethod = LADYBUG_DIRECTIONAL_FILTER;
+            }
+            else
+            {
+                bBadArgs = true;
+            }
+            break;
+        case 'k':
+            options.toneMapping.key = (float)atof( pszCurrParam );
+            bBadArgs |= !( options.toneMapping.key > 0.0f && options.toneMapping.key <= 1.0f );
+            break;
+        case 'x':
+            options.toneMapping.stops = (float)atof( pszCurrParam );
+            break;
+        case 'e':
+            options.toneMapping.op = ToneMapper::OPERATOR_EXPOSURE;
+            break;
+        case '?':
+            displayUsage( argv[0] );
+            return 0;
+        default:
+            bBadArgs = true;
+            break;
+        }
+    }
+
+    if ( bBadArgs || options.inputPath.empty() || options.firstSequence > options.lastSequence )
+    {
+        displayUsage( argv[0] );
+        return 1;
+    }
+
+    return processStream( options );
+}
@@ -22,7 +22,9 @@
 // This example shows users how to process entire or part of a stream file.
 // The program processes each frame and outputs an image file sequentially.
 // If the stream file contains GPS information, the program outputs the 
-// information to a separate text file.
+// information to a separate text file. A GPS track written next to the
+// stream by ladybugGPSInsert takes precedence over the GPS data in the
+// images.
 //
 // This example reads processing parametere options from command line.
 // Use -? or -h option to display the usage help.
@@ -36,6 +38,10 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
 
 //=============================================================================
 // PGR Includes
@@ -47,6 +53,15 @@
 #include <ladybugGPS.h>
 #include <ladybugvideo.h>
 #include "getopt.h"
+#include "CameraSelection.h"
+#include "DebayerEngine.h"
+#include "FrameArchive.h"
+#include "GpsTrack.h"
+#include "ImuStabilizer.h"
+#include "OutputEncoder.h"
+#include "TextureCache.h"
+#include "TiledPanoramaRenderer.h"
+#include "TimeIndex.h"
 
 //=============================================================================
 // Platform specific indludes and definitions
@@ -62,18 +77,35 @@
 
 #endif
 
+//=============================================================================
+// Type Definitions
+//=============================================================================
+
+//
+// One image rendered and written for every frame
+//
+struct OutputSpec
+{
+    LadybugOutputImage type;
+    const char* pszName;
+    int iWidth;
+    int iHeight;
+    LadybugProcessedImage image;
+};
+
 //=============================================================================
 // Global variables
 //=============================================================================
 unsigned int iFrameFrom = 0;
 unsigned int iFrameTo = 0;
+char pszTimeRange[ 128 ] = "";
 char pszInputStream[ _MAX_PATH ] = "ladybug-000000.pgr";
 char pszOutputFilePrefix[ _MAX_PATH ] = "ladybugImageOutput";
 char pszOutputGPSPrefix[ _MAX_PATH ] = "ladybugGPSOutput";
 char pszConfigFile[ _MAX_PATH] = "";
 int iOutputImageWidth = 2048;
 int iOutputImageHeight = 1024;
-LadybugOutputImage outputImageType = LADYBUG_PANORAMIC;
+std::vector<OutputSpec> outputs;
 LadybugSaveFileFormat outputImageFormat = LADYBUG_FILEFORMAT_JPG;
 LadybugColorProcessingMethod colorProcessingMethod = LADYBUG_HQLINEAR;
 int iBlendingWidth = 100;
@@ -83,6 +115,9 @@ bool bEnableAntiAliasing = false;
 bool bEnableSoftwareRendering = false;
 bool bEnableStabilization = false;
 LadybugStabilizationParams stabilizationParams = { 6, 100, 0.95 };
+bool bImuStabilization = false;
+ImuStabilizer::Settings imuSettings = ImuStabilizer::getDefaultSettings();
+ImuStabilizer imuStabilizer;
 LadybugContext context;
 LadybugStreamContext readContext;
 LadybugStreamHeadInfo streamHeaderInfo;
@@ -94,6 +129,45 @@ float fRotY = 0.0f;
 float fRotZ = 0.0f;
 int iBitRate = 4000; // in kbps
 bool processH264 = false;
+bool bUseCpuDebayer = false;
+DebayerEngine::Method cpuDebayerMethod = DebayerEngine::METHOD_HQ_LINEAR;
+unsigned int iCpuDebayerThreads = 0;
+bool bCompareCpuDebayer = false;
+DebayerEngine* pDebayerEngine = NULL;
+unsigned char* arpReferenceBuffers[ LADYBUG_NUM_CAMERAS]= { NULL, NULL, NULL, NULL, NULL, NULL };
+bool bTiledRendering = false;
+TiledPanoramaRenderer* pTiledRenderer = NULL;
+unsigned char* pTiledPanorama = NULL;
+unsigned int iConvertedFrames = 0;
+double dTotalCpuConvertSeconds = 0.0;
+double dTotalSdkConvertSeconds = 0.0;
+OutputEncoder* pOutputEncoder = NULL;
+unsigned int iEncoderThreads = 0;
+int iJpegQuality = 90;
+FrameArchiveWriter* pFrameArchive = NULL;
+std::string outputNamePrefix;
+CameraSelection cameraSelection;
+char pszCacheDirectory[ _MAX_PATH ] = "";
+unsigned int iCacheSizeMB = 4096;
+TextureCache* pTextureCache = NULL;
+std::string streamIdentity;
+
+const struct
+{
+    const char* pszName;
+    LadybugOutputImage type;
+} outputTypeNames[] = 
+{
+    { "pano", LADYBUG_PANORAMIC },
+    { "dome", LADYBUG_DOME },
+    { "spherical", LADYBUG_SPHERICAL },
+    { "rectify-0", LADYBUG_RECTIFIED_CAM0 },
+    { "rectify-1", LADYBUG_RECTIFIED_CAM1 },
+    { "rectify-2", LADYBUG_RECTIFIED_CAM2 },
+    { "rectify-3", LADYBUG_RECTIFIED_CAM3 },
+    { "rectify-4", LADYBUG_RECTIFIED_CAM4 },
+    { "rectify-5", LADYBUG_RECTIFIED_CAM5 },
+};
 
 //=============================================================================
 // Macro Definitions
@@ -146,8 +220,15 @@ display_Usage( const char* pszProgramName )
         "  -i STREAM_PATH     The PGR stream file to process with an extension of .pgr\n"
         "  -r NNN-NNN         The frame range to process. The first frame is 0.\n"
         "                     Default setting is to process all the images.\n"
+        "  -T START[/END]     The time range to process, instead of -r, as ISO 8601\n"
+        "                     UTC (2016-03-24T19:32:51.5Z) or seconds since 1970.\n"
+        "                     Frames are looked up in the time index (.tidx) that\n"
+        "                     ladybugSimpleRecording writes next to the stream.\n"
         "  -o OUTPUT_PATH     Output file prefix. \n"
         "                     Default is %s\n"
+        "                     An OUTPUT_PATH ending in .lba is a frame archive that\n"
+        "                     all images are appended to, under the names they would\n"
+        "                     have as files. Use ladybugFrameArchive to read it.\n"
         "  -g GPS_OUTPUT_PATH Output GPS file prefix. \n"
         "                     Default is %s\n"
         "  -w NNNNxNNNN       Output image size (widthxheight) in pixel. \n"
@@ -162,12 +243,22 @@ display_Usage( const char* pszProgramName )
         "              rectify-3 - rectified image (camera 3)\n"
         "              rectify-4 - rectified image (camera 4)\n"
         "              rectify-5 - rectified image (camera 5)\n"
+        "              rectify-all - rectified images of all cameras\n"
+        "              Several types can be given as a comma separated list, each\n"
+        "              with an optional size, e.g. pano:4096x2048,rectify-all,dome.\n"
+        "              Every frame is then color processed once and all of them\n"
+        "              are rendered and written to OUTPUT_PATH_TYPE_NNNNNN files.\n"
+        "              Types without a size use the -w size.\n"
         "  -f FORMAT Output image format:\n"
         "              bmp      - Windows BMP image\n"
         "              jpg      - JPEG image (default)\n"
         "              tiff     - TIFF image\n"
         "              png      - PNG image\n"
         "              h264     - H.264 video\n"
+        "              Images are encoded on separate threads while the next\n"
+        "              frames are processed.\n"
+        "  -Q NNN      JPEG quality from 1 to 100. Default is %d.\n"
+        "  -W N        Number of threads encoding images. Default is one per CPU.\n"
         "  -c COLOR_PROCESS Debayering method:\n"
         "              hq       - High quality linear method (default)\n" 
         "              hq-gpu   - High quality linear method\n" 
@@ -179,6 +270,36 @@ display_Usage( const char* pszProgramName )
         "              mono     - Monochrome method\n"
         "              df       - Directional filter method\n"
         "              wdf       - Weighted Directional filter method\n"
+        "              cpu-hq       - High quality linear method on the CPU\n"
+        "              cpu-bilinear - Bilinear method on the CPU\n"
+        "              cpu-near     - Nearest neighbor method on the CPU\n"
+        "              The cpu-* methods need a RAW8, RAW12 or RAW16 stream and\n"
+        "              fall back to the library for JPEG streams.\n"
+        "  -j N     Number of threads for the cpu-* methods. Default is one per CPU.\n"
+        "  -p true/false   Compare the cpu-* methods with the library on every frame.\n"
+        "              true - Print the time taken by both and the difference.\n"
+        "              false - Disable.\n"
+        "              Default is %s.\n"
+        "  -u true/false   Render panoramas in tiles on the CPU.\n"
+        "              true - Only the parts of the camera images each tile needs are\n"
+        "                     color processed, so no full size texture buffers are\n"
+        "                     allocated. Needs a RAW stream and RENDER_TYPE pano.\n"
+        "                     Uses the cpu-* method (cpu-hq by default) and -j.\n"
+        "                     Stabilization, anti-aliasing and falloff correction\n"
+        "                     are not applied.\n"
+        "              false - Render with the library.\n"
+        "              Default is %s.\n"
+        "  -y CAMERAS[:FILL] Cameras to process, e.g. 01234 to leave out the top camera.\n"
+        "              The other cameras are converted for the first frame only, and\n"
+        "              then show FILL in the output: blur (of the first frame,\n"
+        "              default), gray or black. Default is all cameras.\n"
+        "  -C CACHE_DIR   Keep the color processed images of each frame in CACHE_DIR\n"
+        "              and use them on later runs with the same stream, frames and\n"
+        "              color processing settings (-c, -a, -v, -l). Runs that only\n"
+        "              change rendering settings such as -b, -t, -w, -q or -x then\n"
+        "              skip color processing. Default is no cache.\n"
+        "  -M NNN      Size cap of CACHE_DIR in MB. The least recently used frames are\n"
+        "              deleted above it. Default is %u.\n"
         "  -b NNN   Blending width in pixel. Default is %d.\n"
         "  -v X.XX  Falloff correction value. Default is %f.\n"
         "  -a true/false   Enable falloff correction. \n"
@@ -193,13 +314,20 @@ display_Usage( const char* pszProgramName )
         "              true - Enable.\n"
         "              false - Disable.\n"
         "              Default is %s.\n"
-        "  -z true/false   Enable stabilization.\n"
-        "              true - Enable.\n"
+        "  -z true/false/imu   Enable stabilization.\n"
+        "              true - Enable, by matching image templates.\n"
+        "              imu - Enable, with the gyroscope and accelerometer readings\n"
+        "                    of the sensor log of the stream (see\n"
+        "                    ladybugSimpleRecording). Much faster than template\n"
+        "                    matching, works on scenes without texture and\n"
+        "                    levels the horizon. Not applied with -u true.\n"
         "              false - Disable.\n"
         "              Default is %s.\n"
         "  -n N        Stabilization paramnter - Number of templates. Default is %d.\n"
         "  -m NNN      Stabilization paramnter - Maximum search region. Default is %d.\n"
         "  -d X.XX     Stabilization paramnter - Decay rate. Default is %f.\n"
+        "  -S X.XX     IMU stabilization - Seconds of camera motion smoothed away.\n"
+        "              Longer keeps the view steadier through turns. Default is %.1f.\n"
         "  -q XXX      Field of view in degrees when RENDER_TYPE is \"spherical\". Default is %f.\n"
         "  -x XXX-YYY-ZZZ   Euler rotation angle in degrees when RENDER_TYPE is \"spherical\". Default is %f-%f-%f.\n"
         "  -l CAL_FILE_PATH Path to calibration file to replace.\n"
@@ -207,14 +335,19 @@ display_Usage( const char* pszProgramName )
         "\n", 
         pszOutputFilePrefix, pszOutputGPSPrefix,
         iOutputImageWidth, iOutputImageHeight,
+        iJpegQuality,
+        bCompareCpuDebayer?"true":"false",
+        bTiledRendering?"true":"false",
+        iCacheSizeMB,
         iBlendingWidth, fFalloffCorrectionValue,
         bFalloffCorrectionFlagOn?"true":"false",
         bEnableSoftwareRendering?"true":"false",
         bEnableAntiAliasing?"true":"false",
-        bEnableStabilization?"true":"false",
+        bImuStabilization?"imu":(bEnableStabilization?"true":"false"),
         stabilizationParams.iNumTemplates, 
         stabilizationParams.iMaximumSearchRegion, 
         stabilizationParams.dDecayRate,
+        imuSettings.smoothingSeconds,
         fFOV,
         fRotX,
         fRotY,
@@ -251,10 +384,16 @@ display_Usage( const char* pszProgramName )
         "        Render panoramic images with blending width 80.\n"
         "        Use software rendering, where the image rendering process is not hardware\n" 
         "        accelerated regardless of the existence of the graphics card.\n\n\n"
+
+        "  %s -i lb-000000.pgr -o Out -t pano:8000x4000,rectify-all:1616x1232,dome \n\n"
+        "        Render a panoramic image, the six rectified images and a dome view\n"
+        "        from each frame in one pass. The files are named Out_pano_000000.jpg,\n"
+        "        Out_rectify-0_000000.jpg, ..., Out_dome_000000.jpg.\n\n\n"
         ,
         pszProgramName,
         pszProgramName,
         pszProgramName,
+        pszProgramName,
         pszProgramName
         );
 
@@ -372,6 +511,40 @@ initializeLadybug( void )
     error = ladybugReadImageFromStream( readContext, &image);
     _CHECK_ERROR;
 
+    if ( !cameraSelection.isAllSelected() )
+    {
+        printf( "Processing %s.\n", cameraSelection.describe().c_str() );
+    }
+
+    //
+    // Tiled rendering works from the raw image and needs neither texture
+    // buffers nor the library renderer
+    //
+    if ( bTiledRendering )
+    {
+        if ( outputs.size() != 1 || outputs[ 0 ].type != LADYBUG_PANORAMIC || 
+            !DebayerEngine::isSupported( image.dataFormat ) )
+        {
+            printf( "Tiled rendering needs a RAW stream and panoramic output only. The library renders instead.\n" );
+        }
+        else
+        {
+            printf( "Computing the panoramic mapping for tiled rendering...\n" );
+            pTiledRenderer = new TiledPanoramaRenderer( cpuDebayerMethod, iCpuDebayerThreads );
+            pTiledRenderer->setCameraMask( cameraSelection.getMask() );
+            error = pTiledRenderer->initialize( 
+                context, image.uiCols, image.uiRows, outputs[ 0 ].iWidth, outputs[ 0 ].iHeight, iBlendingWidth );
+            _CHECK_ERROR;
+
+            pTiledPanorama = new unsigned char[ outputs[ 0 ].iWidth * outputs[ 0 ].iHeight * 3 ];
+
+            printf( "Tiled rendering with %u threads, %u KB of working memory per thread.\n", 
+                pTiledRenderer->getNumThreads(), 
+                (unsigned int)( pTiledRenderer->getPeakScratchBytes() / 1024 ) );
+            return LADYBUG_OK;
+        }
+    }
+
     //
     // Allocate the texture buffers that hold the color-processed images for all cameras
     //
@@ -392,6 +565,57 @@ initializeLadybug( void )
 		arpTextureBuffers[ i ] = new unsigned char[ iTextureWidth * iTextureHeight * 4 * outputBytesPerPixel];
     }
 
+    //
+    // Set up CPU color processing. The library still converts the first
+    // image, so that its alpha masks can be reused for the CPU output.
+    //
+    if ( bUseCpuDebayer )
+    {
+        if ( DebayerEngine::isSupported( streamHeaderInfo.dataFormat ) )
+        {
+            pDebayerEngine = new DebayerEngine( iCpuDebayerThreads );
+            printf( "Color processing on the CPU with %u threads (%s kernels).\n", 
+                pDebayerEngine->getNumThreads(), 
+                pDebayerEngine->getUseAvx2() ? "AVX2" : "portable" );
+
+            for( int i = 0; i < LADYBUG_NUM_CAMERAS; i++)
+            {
+                arpReferenceBuffers[ i ] = new unsigned char[ iTextureWidth * iTextureHeight * 4 * outputBytesPerPixel];
+            }
+        }
+        else
+        {
+            printf( "The stream is not RAW8, RAW12 or RAW16. The library does the color processing.\n" );
+        }
+    }
+
+    //
+    // Set up the texture cache. Entries are only valid for this version
+    // of the stream file.
+    //
+    if ( pszCacheDirectory[ 0 ] != '\0' )
+    {
+        struct stat streamInfo;
+        char pszIdentity[ _MAX_PATH + 64 ];
+        if ( stat( pszInputStream, &streamInfo ) == 0 )
+        {
+            sprintf( pszIdentity, "%s|%lld|%lld", 
+                pszInputStream, (long long)streamInfo.st_size, (long long)streamInfo.st_mtime );
+        }
+        else
+        {
+            sprintf( pszIdentity, "%s", pszInputStream );
+        }
+        streamIdentity = pszIdentity;
+
+        pTextureCache = new TextureCache( pszCacheDirectory, (unsigned long long)iCacheSizeMB * 1024 * 1024 );
+        printf( "Texture cache in %s: %u frames, %.1f of %u MB.\n", 
+            pszCacheDirectory, 
+            pTextureCache->getNumEntries(), 
+            pTextureCache->getTotalBytes() / ( 1024.0 * 1024.0 ), 
+            iCacheSizeMB );
+    }
+
     //
     // Set blending width
     //
@@ -444,18 +668,27 @@ initializeLadybug( void )
     // Configure output images in Ladybug liabrary
     //
     printf( "Configure output images in Ladybug library...\n" );
+    unsigned int uiOutputTypes = 0;
+    for ( size_t i = 0; i < outputs.size(); i++ )
+    {
+        uiOutputTypes |= outputs[ i ].type;
+    }
     error = ladybugConfigureOutputImages( 
         context, 
-        outputImageType );
+        uiOutputTypes );
     _CHECK_ERROR;
 
-    printf("Set off-screen panoramic image size:%dx%d image.\n", iOutputImageWidth, iOutputImageHeight );
-    error = ladybugSetOffScreenImageSize(
-        context,
-        outputImageType,  
-        iOutputImageWidth, 
-        iOutputImageHeight );  
-    _CHECK_ERROR;
+    for ( size_t i = 0; i < outputs.size(); i++ )
+    {
+        printf("Set off-screen %s image size:%dx%d image.\n", 
+            outputs[ i ].pszName, outputs[ i ].iWidth, outputs[ i ].iHeight );
+        error = ladybugSetOffScreenImageSize(
+            context,
+            outputs[ i ].type,  
+            outputs[ i ].iWidth, 
+            outputs[ i ].iHeight );  
+        _CHECK_ERROR;
+    }
 
     error = ladybugSetSphericalViewParams(
         context,
@@ -484,10 +717,271 @@ cleanupLadybug( void )
             delete arpTextureBuffers[ i ];
             arpTextureBuffers[ i ] = NULL;
         }
+        if ( arpReferenceBuffers[ i ] != NULL )
+        {
+            delete [] arpReferenceBuffers[ i ];
+            arpReferenceBuffers[ i ] = NULL;
+        }
     }
+    delete pDebayerEngine;
+    pDebayerEngine = NULL;
+    delete pTiledRenderer;
+    pTiledRenderer = NULL;
+    delete [] pTiledPanorama;
+    pTiledPanorama = NULL;
+    delete pOutputEncoder;
+    pOutputEncoder = NULL;
+    delete pFrameArchive;
+    pFrameArchive = NULL;
+    delete pTextureCache;
+    pTextureCache = NULL;
     return true;
 }
 
+double 
+secondsSince( const std::chrono::steady_clock::time_point& start )
+{
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+//
+// OUTPUT_PATH_NNNNNN.ext, with the type name after OUTPUT_PATH when 
+// several outputs are written. In an archive the names start with the
+// archive's file name without .lba instead of OUTPUT_PATH.
+//
+void
+getOutputFileName( unsigned int iFrame, const OutputSpec& output, char* pszOutputName )
+{
+    char pszOutputBase[ _MAX_PATH + 32 ];
+    if ( outputs.size() > 1 )
+    {
+        sprintf( pszOutputBase, "%s_%s_%06u", outputNamePrefix.c_str(), output.pszName, iFrame );
+    }
+    else
+    {
+        sprintf( pszOutputBase, "%s_%06u", outputNamePrefix.c_str(), iFrame );
+    }
+
+    switch ( outputImageFormat ){
+    case LADYBUG_FILEFORMAT_BMP: 
+        sprintf( pszOutputName, "%s.bmp", pszOutputBase ); 
+        break;
+    case LADYBUG_FILEFORMAT_JPG: 
+        sprintf( pszOutputName, "%s.jpg", pszOutputBase ); 
+        break;
+    case LADYBUG_FILEFORMAT_TIFF: 
+        sprintf( pszOutputName, "%s.tiff", pszOutputBase ); 
+        break;
+    case LADYBUG_FILEFORMAT_PNG: 
+        sprintf( pszOutputName, "%s.png", pszOutputBase ); 
+        break;
+    default: 
+        sprintf( pszOutputName, "%s", pszOutputBase );
+    }
+}
+
+void
+printDebayerDifference( unsigned int iFrame, double cpuSeconds, double sdkSeconds )
+{
+    const bool b16 = isHighBitDepth( streamHeaderInfo.dataFormat );
+    const size_t numPixels = (size_t)iTextureWidth * iTextureHeight;
+
+    double dSum = 0.0;
+    unsigned int iMax = 0;
+    for( unsigned int i = 0; i < LADYBUG_NUM_CAMERAS; i++)
+    {
+        if ( !cameraSelection.isSelected( i ) )
+        {
+            continue;
+        }
+
+        for ( size_t j = 0; j < numPixels * 4; j++ )
+        {
+            // Skip the alpha channel
+            if ( ( j & 3 ) == 3 )
+            {
+                continue;
+            }
+
+            int iDiff;
+            if ( b16 )
+            {
+                iDiff = ((const unsigned short*)arpTextureBuffers[ i ])[ j ] - ((const unsigned short*)arpReferenceBuffers[ i ])[ j ];
+            }
+            else
+            {
+                iDiff = arpTextureBuffers[ i ][ j ] - arpReferenceBuffers[ i ][ j ];
+            }
+
+            const unsigned int iAbsDiff = iDiff < 0 ? -iDiff : iDiff;
+            dSum += iAbsDiff;
+            iMax = iAbsDiff > iMax ? iAbsDiff : iMax;
+        }
+    }
+
+    printf( "Frame %u: CPU %.1f ms, library %.1f ms (%.2fx), mean abs difference %.3f, max %u\n",
+        iFrame, 
+        cpuSeconds * 1000.0, 
+        sdkSeconds * 1000.0, 
+        cpuSeconds > 0.0 ? sdkSeconds / cpuSeconds : 0.0,
+        dSum / ( numPixels * 3 * cameraSelection.getNumSelected() ),
+        iMax );
+}
+
+//
+// The cache key of a frame: everything that changes the color processed
+// images, but none of the rendering settings
+//
+std::string
+getCacheKey( unsigned int iFrame )
+{
+    // The numbers have a bounded length; the calibration path is appended 
+    // as it is, however long
+    char pszKey[ 256 ];
+    snprintf( pszKey, sizeof(pszKey), "|frame=%u|method=%d|cpu=%d:%d|falloff=%d:%f|texture=%ux%u:%d|config=", 
+        iFrame, 
+        (int)colorProcessingMethod, 
+        pDebayerEngine != NULL ? 1 : 0, 
+        (int)cpuDebayerMethod, 
+        bFalloffCorrectionFlagOn ? 1 : 0, 
+        fFalloffCorrectionValue, 
+        iTextureWidth, 
+        iTextureHeight, 
+        (int)streamHeaderInfo.dataFormat );
+    return streamIdentity + pszKey + pszConfigFile;
+}
+
+//
+// Convert the image to BGRU format texture buffers, on the CPU when 
+// possible, and compare with the library when asked to. Only the 
+// cameras with a buffer in arpActiveBuffers are converted.
+//
+LadybugError
+convertImage( unsigned int iFrame, LadybugImage* pImage, unsigned char** arpActiveBuffers )
+{
+    LadybugError error;
+    const LadybugPixelFormat textureFormat = isHighBitDepth(streamHeaderInfo.dataFormat) ? LADYBUG_BGRU16 : LADYBUG_BGRU;
+
+    if ( pDebayerEngine == NULL || !DebayerEngine::isSupported( pImage->dataFormat ) )
+    {
+        return ladybugConvertImage( context, pImage, arpActiveBuffers, textureFormat );
+    }
+
+    double sdkSeconds = 0.0;
+    const bool bNeedAlphaMasks = !pDebayerEngine->hasAlphaMask( 0 );
+    if ( bCompareCpuDebayer || bNeedAlphaMasks )
+    {
+        unsigned char* arpActiveReferenceBuffers[ LADYBUG_NUM_CAMERAS ];
+        cameraSelection.getActiveBuffers( arpReferenceBuffers, arpActiveReferenceBuffers );
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        error = ladybugConvertImage( context, pImage, arpActiveReferenceBuffers, textureFormat );
+        _CHECK_ERROR;
+        sdkSeconds = secondsSince( start );
+
+        if ( bNeedAlphaMasks )
+        {
+            for( unsigned int i = 0; i < LADYBUG_NUM_CAMERAS; i++)
+            {
+                pDebayerEngine->setAlphaMaskFromTexture( 
+                    i, arpReferenceBuffers[ i ], iTextureWidth, iTextureHeight, textureFormat );
+            }
+        }
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    error = pDebayerEngine->convert( *pImage, cpuDebayerMethod, arpActiveBuffers, textureFormat );
+    _CHECK_ERROR;
+    const double cpuSeconds = secondsSince( start );
+
+    iConvertedFrames++;
+    dTotalCpuConvertSeconds += cpuSeconds;
+    dTotalSdkConvertSeconds += sdkSeconds;
+
+    if ( bCompareCpuDebayer )
+    {
+        printDebayerDifference( iFrame, cpuSeconds, sdkSeconds );
+    }
+
+    return LADYBUG_OK;
+}
+
+//
+// Parse a comma separated list of TYPE[:WxH] into outputs. Sizes left 
+// out are filled in from -w once all the options are read.
+//
+bool
+parseOutputTypes( const char* pszList )
+{
+    outputs.clear();
+
+    const char* pszItem = pszList;
+    while ( *pszItem != '\0' )
+    {
+        const char* pszEnd = strchr( pszItem, ',' );
+        const size_t itemLength = pszEnd != NULL ? (size_t)( pszEnd - pszItem ) : strlen( pszItem );
+
+        const char* pszSize = (const char*)memchr( pszItem, ':', itemLength );
+        const size_t nameLength = pszSize != NULL ? (size_t)( pszSize - pszItem ) : itemLength;
+
+        int iWidth = 0;
+        int iHeight = 0;
+        if ( pszSize != NULL && 
+            ( sscanf( pszSize + 1, "%dx%d", &iWidth, &iHeight ) != 2 || iWidth <= 0 || iHeight <= 0 ) )
+        {
+            return false;
+        }
+
+        const bool bAllRectified = 
+            nameLength == strlen( "rectify-all" ) && 
+            strncmpCaseInsensitive( pszItem, "rectify-all", (int)nameLength ) == 0;
+
+        bool bFound = false;
+        for ( size_t i = 0; i < sizeof(outputTypeNames) / sizeof(outputTypeNames[0]); i++ )
+        {
+            const bool bMatch = bAllRectified ? 
+                ( outputTypeNames[ i ].type & LADYBUG_ALL_RECTIFIED_IMAGES ) != 0 :
+                nameLength == strlen( outputTypeNames[ i ].pszName ) && 
+                strncmpCaseInsensitive( pszItem, outputTypeNames[ i ].pszName, (int)nameLength ) == 0;
+            if ( !bMatch )
+            {
+                continue;
+            }
+
+            for ( size_t j = 0; j < outputs.size(); j++ )
+            {
+                if ( outputs[ j ].type == outputTypeNames[ i ].type )
+                {
+                    printf( "Output type %s is given more than once.\n", outputTypeNames[ i ].pszName );
+                    return false;
+                }
+            }
+
+            OutputSpec output;
+            output.type = outputTypeNames[ i ].type;
+            output.pszName = outputTypeNames[ i ].pszName;
+            output.iWidth = iWidth;
+            output.iHeight = iHeight;
+            memset( &output.image, 0, sizeof( output.image ) );
+            outputs.push_back( output );
+            bFound = true;
+        }
+
+        if ( !bFound )
+        {
+            return false;
+        }
+
+        pszItem += itemLength;
+        if ( *pszItem == ',' )
+        {
+            pszItem++;
+        }
+    }
+
+    return !outputs.empty();
+}
+
 void processArguments( int argc, char* argv[])
 {
     const char* pszProgname = argv[ 0 ];
@@ -504,7 +998,7 @@ void processArguments( int argc, char* argv[])
         exit( 0);
     }
 
-    while( ( iOpt = GetOption( argc, argv, "i:r:o:g:w:t:f:c:b:a:v:s:z:n:m:d:h:q:x:l:k:e:?", &pszCurrParam ) ) != 0 )
+    while( ( iOpt = GetOption( argc, argv, "i:r:T:o:g:w:t:f:c:b:a:v:s:z:n:m:d:S:h:q:x:l:k:e:j:p:u:y:C:M:Q:W:?", &pszCurrParam ) ) != 0 )
     {
         switch( iOpt )
         {
@@ -523,6 +1017,12 @@ void processArguments( int argc, char* argv[])
                 bBadArgs = true;
             }
             break;
+        case 'T':  // processing range by time: START[/END]
+            if( sscanf( pszCurrParam, "%127s", pszTimeRange ) != 1 )
+            {
+                bBadArgs = true;
+            }
+            break;
         case 'o':
             if( sscanf( pszCurrParam, "%259s", pszOutputFilePrefix ) != 1 )
             {
@@ -548,43 +1048,7 @@ void processArguments( int argc, char* argv[])
             }
             break;
         case 't':
-            if( strncmpCaseInsensitive( pszCurrParam, "pano", 4 ) == 0 )
-            {
-                outputImageType = LADYBUG_PANORAMIC;
-            }
-            else if( strncmpCaseInsensitive( pszCurrParam, "dome", 4 ) == 0 )
-            {
-                outputImageType = LADYBUG_DOME;
-            }
-            else if( strncmpCaseInsensitive( pszCurrParam, "spherical", 9 ) == 0 )
-            {
-                outputImageType = LADYBUG_SPHERICAL;
-            }
-            else if( strncmpCaseInsensitive( pszCurrParam, "rectify-0", 9 ) == 0 )
-            {
-                outputImageType = LADYBUG_RECTIFIED_CAM0;
-            }
-            else if( strncmpCaseInsensitive( pszCurrParam, "rectify-1", 9 ) == 0 )
-            {
-                outputImageType = LADYBUG_RECTIFIED_CAM1;
-            }
-            else if( strncmpCaseInsensitive( pszCurrParam, "rectify-2", 9 ) == 0 )
-            {
-                outputImageType = LADYBUG_RECTIFIED_CAM2;
-            }
-            else if( strncmpCaseInsensitive( pszCurrParam, "rectify-3", 9 ) == 0 )
-            {
-                outputImageType = LADYBUG_RECTIFIED_CAM3;
-            }
-            else if( strncmpCaseInsensitive( pszCurrParam, "rectify-4", 9 ) == 0 )
-            {
-                outputImageType = LADYBUG_RECTIFIED_CAM4;
-            }
-            else if( strncmpCaseInsensitive( pszCurrParam, "rectify-5", 9 ) == 0 )
-            {
-                outputImageType = LADYBUG_RECTIFIED_CAM5;
-            }
-            else
+            if( !parseOutputTypes( pszCurrParam ) )
             {
                 bBadArgs = true;
             }
@@ -612,6 +1076,31 @@ void processArguments( int argc, char* argv[])
             }
             break;
         case 'c':
+            //
+            // The library method matching each cpu-* method converts the 
+            // first image and is used for comparison. It has no bilinear
+            // method, so HQ linear stands in for it.
+            //
+            bUseCpuDebayer = strncmpCaseInsensitive( pszCurrParam, "cpu-", 4 ) == 0;
+            if( strncmpCaseInsensitive( pszCurrParam, "cpu-hq", 6 ) == 0 )
+            {
+                cpuDebayerMethod = DebayerEngine::METHOD_HQ_LINEAR;
+                colorProcessingMethod = LADYBUG_HQLINEAR;
+                break;
+            }
+            else if( strncmpCaseInsensitive( pszCurrParam, "cpu-bilinear", 12 ) == 0 )
+            {
+                cpuDebayerMethod = DebayerEngine::METHOD_BILINEAR;
+                colorProcessingMethod = LADYBUG_HQLINEAR;
+                break;
+            }
+            else if( strncmpCaseInsensitive( pszCurrParam, "cpu-near", 8 ) == 0 )
+            {
+                cpuDebayerMethod = DebayerEngine::METHOD_NEAREST;
+                colorProcessingMethod = LADYBUG_NEAREST_NEIGHBOR_FAST;
+                break;
+            }
+
             if( strncmpCaseInsensitive( pszCurrParam, "edge", 4 ) == 0 )
             {
                 colorProcessingMethod = LADYBUG_EDGE_SENSING;
@@ -697,10 +1186,17 @@ void processArguments( int argc, char* argv[])
             if( strncmpCaseInsensitive( pszCurrParam, "true", 4 ) == 0 )
             {
                 bEnableStabilization = true;
+                bImuStabilization = false;
+            }
+            else if( strncmpCaseInsensitive( pszCurrParam, "imu", 3 ) == 0 )
+            {
+                bEnableStabilization = false;
+                bImuStabilization = true;
             }
             else if( strncmpCaseInsensitive( pszCurrParam, "false", 5 ) == 0 )
             {
                 bEnableStabilization = false;
+                bImuStabilization = false;
             }
             else
             {
@@ -728,6 +1224,13 @@ void processArguments( int argc, char* argv[])
                     stabilizationParams.dDecayRate = fDecay;
             }
             break;
+        case 'S':
+            if( sscanf( pszCurrParam, "%lf", &imuSettings.smoothingSeconds ) != 1 || 
+                imuSettings.smoothingSeconds <= 0.0 )
+            {
+                bBadArgs = true;
+            }
+            break;
         case 'q': // FOV for spherical view
             if( sscanf( pszCurrParam, "%f", &fFOV ) != 1 )
                 bBadArgs = true;
@@ -756,6 +1259,70 @@ void processArguments( int argc, char* argv[])
                 bBadArgs = true;
             }
             break;
+        case 'j': // threads for CPU color processing
+            if( sscanf( pszCurrParam, "%u", &iCpuDebayerThreads ) != 1 )
+            {
+                bBadArgs = true;
+            }
+            break;
+        case 'p':
+            if( strncmpCaseInsensitive( pszCurrParam, "true", 4 ) == 0 )
+            {
+                bCompareCpuDebayer = true;
+            }
+            else if( strncmpCaseInsensitive( pszCurrParam, "false", 5 ) == 0 )
+            {
+                bCompareCpuDebayer = false;
+            }
+            else
+            {
+                bBadArgs = true;
+            }
+            break;
+        case 'u':
+            if( strncmpCaseInsensitive( pszCurrParam, "true", 4 ) == 0 )
+            {
+                bTiledRendering = true;
+            }
+            else if( strncmpCaseInsensitive( pszCurrParam, "false", 5 ) == 0 )
+            {
+                bTiledRendering = false;
+            }
+            else
+            {
+                bBadArgs = true;
+            }
+            break;
+        case 'y':
+            if( !cameraSelection.parse( pszCurrParam ) )
+            {
+                bBadArgs = true;
+            }
+            break;
+        case 'C':
+            if( sscanf( pszCurrParam, "%259s", pszCacheDirectory ) != 1 )
+            {
+                bBadArgs = true;
+            }
+            break;
+        case 'M':
+            if( sscanf( pszCurrParam, "%u", &iCacheSizeMB ) != 1 )
+            {
+                bBadArgs = true;
+            }
+            break;
+        case 'Q':
+            if( sscanf( pszCurrParam, "%d", &iJpegQuality ) != 1 || iJpegQuality < 1 || iJpegQuality > 100 )
+            {
+                bBadArgs = true;
+            }
+            break;
+        case 'W':
+            if( sscanf( pszCurrParam, "%u", &iEncoderThreads ) != 1 )
+            {
+                bBadArgs = true;
+            }
+            break;
         case '?':
         case 'h':
         default:
@@ -764,6 +1331,32 @@ void processArguments( int argc, char* argv[])
         }
     }
 
+    if ( outputs.empty() )
+    {
+        parseOutputTypes( "pano" );
+    }
+
+    for ( size_t i = 0; i < outputs.size(); i++ )
+    {
+        if ( outputs[ i ].iWidth == 0 )
+        {
+            outputs[ i ].iWidth = iOutputImageWidth;
+            outputs[ i ].iHeight = iOutputImageHeight;
+        }
+    }
+
+    if ( processH264 && frameArchive::isArchivePath( pszOutputFilePrefix ) )
+    {
+        printf( "H.264 video cannot be written to a frame archive.\n" );
+        bBadArgs = true;
+    }
+
+    if ( processH264 && outputs.size() > 1 )
+    {
+        printf( "H.264 video output takes a single RENDER_TYPE.\n" );
+        bBadArgs = true;
+    }
+
     if( bBadArgs )
     {
         display_Usage( pszProgname );
@@ -771,6 +1364,99 @@ void processArguments( int argc, char* argv[])
     }
 }
 
+//=============================================================================
+// Set the frame range from the START[/END] time range, with the time index
+// of the stream
+//=============================================================================
+bool 
+selectFramesByTime()
+{
+    const std::string range = pszTimeRange;
+    const size_t separator = range.find( '/' );
+    const bool hasEnd = separator != std::string::npos;
+    double startUtc = 0.0;
+    double endUtc = 0.0;
+    if ( !timeIndex::parseUtc( range.substr( 0, separator ).c_str(), startUtc ) || 
+        ( hasEnd && !timeIndex::parseUtc( range.substr( separator + 1 ).c_str(), endUtc ) ) )
+    {
+        printf( "Invalid time range %s.\n", pszTimeRange );
+        return false;
+    }
+
+    TimeIndex index;
+    std::string errorMessage;
+    if ( !index.openForStream( pszInputStream, errorMessage ) )
+    {
+        printf( "Unable to select frames by time: %s\n", 
+            errorMessage.empty() ? "the stream has no time index" : errorMessage.c_str() );
+        return false;
+    }
+
+    if ( !index.isUtc() )
+    {
+        printf( "Warning: the time index holds camera time, the camera was not locked to PPS.\n" );
+    }
+
+    if ( !index.findFrame( startUtc, iFrameFrom ) )
+    {
+        printf( "No frame at or after %s.\n", range.substr( 0, separator ).c_str() );
+        return false;
+    }
+
+    iFrameTo = index.getNumFrames() - 1;
+    unsigned int endFrame = 0;
+    if ( hasEnd && index.findFrame( endUtc, endFrame ) )
+    {
+        // The first frame at or after the end is only in the range if it 
+        // is right at the end
+        if ( index.getUtc( endFrame ) > endUtc )
+        {
+            if ( endFrame == 0 )
+            {
+                printf( "No frame in the time range %s.\n", pszTimeRange );
+                return false;
+            }
+            endFrame--;
+        }
+        iFrameTo = endFrame;
+    }
+
+    printf( "Time range %s is frames %u-%u.\n", pszTimeRange, iFrameFrom, iFrameTo );
+    return true;
+}
+
+//=============================================================================
+// Compute the rotation that stabilizes each frame in the range from the
+// sensor log of the stream
+//=============================================================================
+bool 
+computeImuStabilization()
+{
+    SensorLogReader sensorLogReader;
+    std::string errorMessage;
+    if ( !sensorLogReader.openForStream( pszInputStream, errorMessage ) )
+    {
+        printf( "Unable to stabilize with the IMU: %s\n", 
+            errorMessage.empty() ? "the stream has no sensor log" : errorMessage.c_str() );
+        return false;
+    }
+
+    if ( !imuStabilizer.compute( sensorLogReader, iFrameFrom, iFrameTo, imuSettings, errorMessage ) )
+    {
+        printf( "Unable to stabilize with the IMU: %s\n", errorMessage.c_str() );
+        return false;
+    }
+
+    if ( sensorLogReader.getSamples( sensorLog::SENSOR_ACCELEROMETER ).empty() )
+    {
+        printf( "Warning: the sensor log has no accelerometer readings, the horizon is not leveled.\n" );
+    }
+
+    printf( "IMU stabilization: %u of %u frames corrected, by up to %.1f degrees.\n", 
+        imuStabilizer.getNumCorrected(), iFrameTo - iFrameFrom + 1, imuStabilizer.getMaxCorrectionDegrees() );
+    return true;
+}
+
 //=============================================================================
 // Main Routine
 //=============================================================================
@@ -804,6 +1490,12 @@ main( int argc, char* argv[] )
         iFrameTo = totalFrames - 1;
     }
 
+    if ( strlen( pszTimeRange ) > 0 && !selectFramesByTime() )
+    {
+        cleanupLadybug();
+        return 0;
+    }
+
     if ( ( iFrameFrom > totalFrames - 1) || 
         ( iFrameTo > totalFrames - 1) ||
         ( iFrameTo < iFrameFrom) )
@@ -813,14 +1505,20 @@ main( int argc, char* argv[] )
         return 0;
     }
 
+    if ( bImuStabilization && !computeImuStabilization() )
+    {
+        cleanupLadybug();
+        return 0;
+    }
+
     if ( processH264)
     {
         LadybugH264Option h264Option;
         memset( &h264Option, 0, sizeof( h264Option));
         h264Option.bitrate = iBitRate * 1024;
         h264Option.frameRate = 15; // TODO - this should be configurable through options.
-        h264Option.width = iOutputImageWidth;
-        h264Option.height = iOutputImageHeight;
+        h264Option.width = outputs[ 0 ].iWidth;
+        h264Option.height = outputs[ 0 ].iHeight;
 
         sprintf( videoPath, "%s.mp4", pszOutputFilePrefix); 
         error = ladybugCreateVideoContext( &videoContext);
@@ -829,6 +1527,59 @@ main( int argc, char* argv[] )
         _ON_ERROR_EXIT;
     }
 
+    OutputEncoder::Format encoderFormat = OutputEncoder::FORMAT_JPEG;
+    if ( !processH264 )
+    {
+        // Formats the encoder pool does not write are saved by the SDK on 
+        // this thread, as before the pool existed
+        if ( OutputEncoder::fromSaveFileFormat( outputImageFormat, encoderFormat ) )
+        {
+            pOutputEncoder = new OutputEncoder( iEncoderThreads );
+            pOutputEncoder->setJpegQuality( iJpegQuality );
+        }
+        else if ( frameArchive::isArchivePath( pszOutputFilePrefix ) )
+        {
+            printf( "This output format cannot be written to a frame archive.\n" );
+            cleanupLadybug();
+            return 0;
+        }
+    }
+
+    GpsTrackReader gpsTrackReader;
+    {
+        std::string errorMessage;
+        if ( gpsTrackReader.openForStream( pszInputStream, errorMessage ) )
+        {
+            printf( "Using the GPS track %s (%u records)\n", 
+                gpsTrack::getTrackPath( pszInputStream ).c_str(), gpsTrackReader.getNumRecords() );
+        }
+        else if ( !errorMessage.empty() )
+        {
+            printf( "Ignoring the GPS track: %s\n", errorMessage.c_str() );
+        }
+    }
+
+    outputNamePrefix = pszOutputFilePrefix;
+    if ( pOutputEncoder != NULL && frameArchive::isArchivePath( outputNamePrefix ) )
+    {
+        std::string errorMessage;
+        pFrameArchive = new FrameArchiveWriter();
+        if ( !pFrameArchive->open( pszOutputFilePrefix, errorMessage ) )
+        {
+            printf( "Error! %s\n", errorMessage.c_str() );
+            cleanupLadybug();
+            return 0;
+        }
+        pOutputEncoder->setArchive( pFrameArchive );
+
+        const size_t separator = outputNamePrefix.find_last_of( "/\\" );
+        if ( separator != std::string::npos )
+        {
+            outputNamePrefix.erase( 0, separator + 1 );
+        }
+        outputNamePrefix.erase( outputNamePrefix.size() - strlen( frameArchive::k_extension ) );
+    }
+
     //
     // fast-forward to the first frame to process in the stream
     //
@@ -848,27 +1599,74 @@ main( int argc, char* argv[] )
         error = ladybugReadImageFromStream( readContext, &image);
         _ON_ERROR_BREAK;
 
-        //
-        // Convert the image to BGRU format texture buffers
-        //
-		error = ladybugConvertImage( context, &image, arpTextureBuffers, isHighBitDepth(streamHeaderInfo.dataFormat) ? LADYBUG_BGRU16 : LADYBUG_BGRU);
-        _ON_ERROR_CONTINUE;
+        if ( pTiledRenderer == NULL )
+        {
+            //
+            // Cameras left out by -y are converted and uploaded once, with
+            // their color replaced by the fill, and skipped from then on
+            //
+            const LadybugPixelFormat textureFormat = isHighBitDepth(streamHeaderInfo.dataFormat) ? LADYBUG_BGRU16 : LADYBUG_BGRU;
+            unsigned char* arpActiveBuffers[ LADYBUG_NUM_CAMERAS ];
+            cameraSelection.getActiveBuffers( arpTextureBuffers, arpActiveBuffers );
 
-        //
-        // Update the textures on graphics card
-        //
-        error = ladybugUpdateTextures( 
-            context, LADYBUG_NUM_CAMERAS, (const unsigned char**)arpTextureBuffers, isHighBitDepth(streamHeaderInfo.dataFormat) ? LADYBUG_BGRU16 : LADYBUG_BGRU);
-        _ON_ERROR_BREAK;
+            //
+            // Convert the image to BGRU format texture buffers, unless an
+            // earlier run left them in the cache. The first frame is always
+            // converted, for the alpha channel of this run.
+            //
+            if ( pTextureCache != NULL && 
+                pTextureCache->load( getCacheKey( iFrame ), arpActiveBuffers, iTextureWidth, iTextureHeight, textureFormat ) )
+            {
+                printf( "Color processed images read from the cache\n" );
+            }
+            else
+            {
+                error = convertImage( iFrame, &image, arpActiveBuffers );
+                _ON_ERROR_CONTINUE;
+
+                if ( pTextureCache != NULL )
+                {
+                    if ( !pTextureCache->hasAlphaTemplate() )
+                    {
+                        pTextureCache->setAlphaTemplate( arpTextureBuffers, iTextureWidth, iTextureHeight, textureFormat );
+                    }
+                    pTextureCache->store( 
+                        getCacheKey( iFrame ), (const unsigned char* const*)arpActiveBuffers, iTextureWidth, iTextureHeight, textureFormat );
+                }
+            }
+
+            cameraSelection.applyFill( arpTextureBuffers, iTextureWidth, iTextureHeight, textureFormat );
+
+            //
+            // Update the textures on graphics card
+            //
+            error = ladybugUpdateTextures( 
+                context, LADYBUG_NUM_CAMERAS, (const unsigned char**)arpActiveBuffers, textureFormat);
+            _ON_ERROR_BREAK;
+
+            //
+            // Rotate the sphere all outputs are rendered from, so that the
+            // spherical view and the panorama both hold still
+            //
+            if ( bImuStabilization )
+            {
+                double dRotX = 0.0;
+                double dRotY = 0.0;
+                double dRotZ = 0.0;
+                imuStabilizer.getCorrection( iFrame, dRotX, dRotY, dRotZ );
+                error = ladybugSet3dMapRotation( context, dRotX, dRotY, dRotZ );
+                _ON_ERROR_BREAK;
+            }
+        }
 
         //
         // Output GPS information on text file if it exists in the image
         //
-        LadybugNMEAGPGGA gpsData;
-        error = ladybugGetGPSNMEADataFromImage( &image, "GPGGA", &gpsData);
-        if ( error == LADYBUG_OK && gpsData.bValidData)
+        GpsTrackRecord gpsRecord;
+        if ( gpsTrackReader.getFrameData( iFrame, image, gpsRecord ) != GpsTrackReader::SOURCE_NONE && 
+            ( gpsRecord.flags & gpsTrack::HAS_POSITION ) != 0 )
         {
-            printf( "GPS INFO: LAT %lf, LONG %lf\n", gpsData.dGGALatitude, gpsData.dGGALongitude);
+            printf( "GPS INFO: LAT %lf, LONG %lf\n", gpsRecord.latitude, gpsRecord.longitude);
             if ( fp == NULL)
             {
                 char pszGpsFilePath[ 256];
@@ -877,51 +1675,125 @@ main( int argc, char* argv[] )
             }
             if ( fp != NULL)
             {
-                fprintf( fp, "%u, LAT %lf, LONG %lf\n", iFrame, gpsData.dGGALatitude, gpsData.dGGALongitude);
+                fprintf( fp, "%u, LAT %lf, LONG %lf\n", iFrame, gpsRecord.latitude, gpsRecord.longitude);
             }
         }
 
         //
-        // Render and obtain the image in off-screen buffer
+        // Render every output. Image files are encoded from a copy on the 
+        // encoder threads, so the next output can be rendered right away.
         //
-        LadybugProcessedImage processedImage;
-        error = ladybugRenderOffScreenImage(
-            context, outputImageType, LADYBUG_BGR, &processedImage);
+        const std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+        for ( size_t i = 0; i < outputs.size(); i++ )
+        {
+            OutputSpec& output = outputs[ i ];
+            LadybugProcessedImage processedImage;
+            if ( pTiledRenderer != NULL )
+            {
+                const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                error = pTiledRenderer->render( image, pTiledPanorama );
+                if ( error != LADYBUG_OK )
+                {
+                    break;
+                }
+                printf( "Rendered in tiles in %.1f ms\n", secondsSince( start ) * 1000.0 );
+
+                memset( &processedImage, 0, sizeof( processedImage ) );
+                processedImage.uiCols = output.iWidth;
+                processedImage.uiRows = output.iHeight;
+                processedImage.pData = pTiledPanorama;
+                processedImage.pixelFormat = LADYBUG_BGR;
+            }
+            else
+            {
+                error = ladybugRenderOffScreenImage(
+                    context, output.type, LADYBUG_BGR, &processedImage);
+                if ( error != LADYBUG_OK )
+                {
+                    break;
+                }
+            }
+            output.image = processedImage;
+
+            if ( processH264 )
+            {
+                continue;
+            }
+
+            char pszOutputName[ _MAX_PATH + 40 ];
+            getOutputFileName( iFrame, output, pszOutputName );
+            printf("Getting %s image and writing it to %s...\n", output.pszName, pszOutputName);
+
+            if ( pOutputEncoder == NULL )
+            {
+                error = ladybugSaveImage( context, &output.image, pszOutputName, outputImageFormat, true );
+                if ( error != LADYBUG_OK )
+                {
+                    break;
+                }
+            }
+            else if ( !pOutputEncoder->submit( output.image, pszOutputName, encoderFormat ) )
+            {
+                error = LADYBUG_INVALID_ARGUMENT;
+                break;
+            }
+        }
         _ON_ERROR_BREAK;
 
-        //
-        // Write the rendered image to a file
-        //
+        if ( outputs.size() > 1 )
+        {
+            printf( "Rendered %u outputs in %.1f ms\n", 
+                (unsigned int)outputs.size(), 
+                secondsSince( renderStart ) * 1000.0 );
+        }
+
         if ( processH264)
         {
             printf("Getting panoramic image (%u) and appending it to %s...\n", iFrame, videoPath);
-            error = ladybugAppendVideoFrame( videoContext, &processedImage);
+            error = ladybugAppendVideoFrame( videoContext, &outputs[ 0 ].image);
             _ON_ERROR_BREAK;
         }
-        else
+        else if ( pOutputEncoder != NULL && pOutputEncoder->getNumFailed() > 0 )
         {
-            char pszOutputName[ 256];
-            switch ( outputImageFormat ){
-            case LADYBUG_FILEFORMAT_BMP: 
-                sprintf( pszOutputName, "%s_%06u.bmp", pszOutputFilePrefix, iFrame); 
-                break;
-            case LADYBUG_FILEFORMAT_JPG: 
-                sprintf( pszOutputName, "%s_%06u.jpg", pszOutputFilePrefix, iFrame); 
-                break;
-            case LADYBUG_FILEFORMAT_TIFF: 
-                sprintf( pszOutputName, "%s_%06u.tiff", pszOutputFilePrefix, iFrame); 
-                break;
-            case LADYBUG_FILEFORMAT_PNG: 
-                sprintf( pszOutputName, "%s_%06u.png", pszOutputFilePrefix, iFrame); 
-                break;
-            default: 
-                sprintf( pszOutputName, "%s_%06u", pszOutputFilePrefix, iFrame);
-            }
-            printf("Getting panoramic image and writing it to %s...\n", pszOutputName);
+            printf( "Error! Failed writing %s\n", pOutputEncoder->getLastFailedPath().c_str() );
+            break;
+        }
+    }
 
-            error = ladybugSaveImage( 
-                context, &processedImage, pszOutputName, outputImageFormat, true);
-            _ON_ERROR_BREAK;
+    if ( pOutputEncoder != NULL )
+    {
+        pOutputEncoder->waitAll();
+        if ( pOutputEncoder->getNumFailed() > 0 )
+        {
+            printf( "Error! Failed writing %u images, the last was %s\n", 
+                pOutputEncoder->getNumFailed(), 
+                pOutputEncoder->getLastFailedPath().c_str() );
+        }
+
+        const unsigned int iWritten = pOutputEncoder->getNumWritten();
+        if ( iWritten > 0 )
+        {
+            printf( "Wrote %u images on %u threads: %.1f ms encoding and %.1f ms writing per image\n", 
+                iWritten, 
+                pOutputEncoder->getNumThreads(), 
+                pOutputEncoder->getEncodeSeconds() * 1000.0 / iWritten, 
+                pOutputEncoder->getWriteSeconds() * 1000.0 / iWritten );
+        }
+    }
+
+    if ( pFrameArchive != NULL )
+    {
+        std::string errorMessage;
+        if ( pFrameArchive->close( errorMessage ) )
+        {
+            printf( "Wrote %u images, %.1f MB, to %s\n", 
+                pFrameArchive->getNumEntries(), 
+                pFrameArchive->getSize() / ( 1024.0 * 1024.0 ), 
+                pszOutputFilePrefix );
+        }
+        else
+        {
+            printf( "Error! %s\n", errorMessage.c_str() );
         }
     }
 
@@ -930,6 +1802,27 @@ main( int argc, char* argv[] )
         fclose( fp);
     }
 
+    if ( iConvertedFrames > 0 )
+    {
+        printf( "Average CPU color processing time: %.1f ms per frame\n", 
+            dTotalCpuConvertSeconds * 1000.0 / iConvertedFrames );
+        if ( bCompareCpuDebayer )
+        {
+            printf( "Average library color processing time: %.1f ms per frame (%.2fx)\n", 
+                dTotalSdkConvertSeconds * 1000.0 / iConvertedFrames,
+                dTotalSdkConvertSeconds / dTotalCpuConvertSeconds );
+        }
+    }
+
+    if ( pTextureCache != NULL )
+    {
+        printf( "Texture cache: %u frames read, %u color processed, %.1f MB in %s\n", 
+            pTextureCache->getHits(), 
+            pTextureCache->getMisses(), 
+            pTextureCache->getTotalBytes() / ( 1024.0 * 1024.0 ), 
+            pszCacheDirectory );
+    }
+
     if ( processH264)
     {
         error = ladybugCloseVideo( videoContext);
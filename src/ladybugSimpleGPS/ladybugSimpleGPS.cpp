@@ -62,6 +62,7 @@
 #include "ladybug.h"
 #include "ladybugGPS.h"
 #include "ladybugstream.h"
+#include "NmeaParser.h"
 
 #define _HANDLE_ERROR \
     if( error != LADYBUG_OK ) \
@@ -239,6 +240,71 @@ void Method3(const LadybugImage &image, int i )
     printf("%s", output.str().c_str());
 }
 
+// Time spent getting the GGA, RMC and GLL data of the frames, each way
+double parserSeconds = 0.0;
+double librarySeconds = 0.0;
+unsigned int timedFrames = 0;
+
+void Method4(const LadybugImage& image, int i )
+{
+    // 4. Parse all NMEA sentences of the LadybugImage in one pass
+    //
+    // ladybugGetGPSNMEADataFromImage() reads one sentence type per call.
+    // NmeaParser walks the NMEA text of the image once and fills the GGA,
+    // RMC, GLL, VTG and GSA data together, which is cheaper when a 
+    // program needs more than one of them.
+
+    const std::chrono::steady_clock::time_point parserStart = std::chrono::steady_clock::now();
+    NmeaData nmea;
+    const char* pText = NULL;
+    size_t length = 0;
+    const bool found = nmeaParser::findInImage( image, pText, length );
+    if ( found )
+    {
+        nmeaParser::parse( pText, length, nmea );
+    }
+    const std::chrono::steady_clock::time_point parserEnd = std::chrono::steady_clock::now();
+
+    // The same sentence types from the library, for comparison
+    LadybugNMEAGPGGA gga;
+    LadybugNMEAGPRMC rmc;
+    LadybugNMEAGPGLL gll;
+    ladybugGetGPSNMEADataFromImage( &image, "GPGGA", &gga );
+    ladybugGetGPSNMEADataFromImage( &image, "GPRMC", &rmc );
+    ladybugGetGPSNMEADataFromImage( &image, "GPGLL", &gll );
+    const std::chrono::steady_clock::time_point libraryEnd = std::chrono::steady_clock::now();
+
+    std::stringstream output;
+    output << i << ".4 --> ";
+    if ( !found )
+    {
+        output << "No NMEA text in the image" << std::endl;
+    }
+    else
+    {
+        parserSeconds += std::chrono::duration<double>( parserEnd - parserStart ).count();
+        librarySeconds += std::chrono::duration<double>( libraryEnd - parserEnd ).count();
+        timedFrames++;
+
+        if ( nmea.gga.valid )
+        {
+            output << (int)nmea.gga.time.hour << ":" << (int)nmea.gga.time.minute << ":" << (int)nmea.gga.time.second << "." << nmea.gga.time.millisecond;
+            output << " (" << (int)nmea.gga.satellites << " satellites";
+            if ( nmea.vtg.valid )
+            {
+                output << ", " << nmea.vtg.speedKmh << " km/h";
+            }
+            output << ") - " << GeneratePositionString( nmea.gga.latitude, nmea.gga.longitude, nmea.gga.altitude );
+        }
+        else
+        {
+            output << "GPS data is invalid (" << nmea.numSentences << " sentences, " << nmea.numRejected << " rejected)" << std::endl;
+        }
+    }
+
+    printf("%s", output.str().c_str());
+}
+
 int 
 main( int argc, char* argv[] )
 {
@@ -400,12 +466,22 @@ main( int argc, char* argv[] )
         // 2. Get a NMEA sentence from the GPS device.
         // 3. Get the latitude, longitude and altitude from the LadybugImageInfo
         //    structure in the returned LadybugImage.
+        // 4. Parse every NMEA sentence of the LadybugImage at once.
         //
-        // The 3 methods are executed below.
+        // The 4 methods are executed below.
 
         Method1(image, i);
         Method2(GPScontext, i);
         Method3(image, i);              
+        Method4(image, i);
+    }
+
+    if ( timedFrames > 0 )
+    {
+        printf( 
+            "GGA, RMC and GLL per image: %.1f us with NmeaParser, %.1f us with the library\n",
+            parserSeconds * 1e6 / timedFrames,
+            librarySeconds * 1e6 / timedFrames );
     }
 
     // Stop GPS
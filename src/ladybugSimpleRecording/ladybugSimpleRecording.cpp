@@ -39,6 +39,13 @@
 // in the .ini file. The accuracy of the result depends on the GPS device and 
 // the GPS data update rate.
 //
+// When recording stops, the time of every recorded frame is written to a 
+// time index (name.tidx) next to the stream. The times are UTC if the 
+// camera was locked to GPS time and PPS (see ladybugGPSTimeSync) for part
+// of the recording, and camera time otherwise. With RecordSensors in the
+// .ini file, the environmental sensors of the camera are logged during the
+// recording to name.sensors, aligned to the frames on the camera clock.
+//
 // Note: This example has to be run with freeglut.dll and Ladybug SDK 1.3Alpha02
 //     or later.
 // 
@@ -48,6 +55,8 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include <string>
+#include <vector>
 #include <GL/freeglut.h>
 
 #ifdef _WIN32
@@ -69,6 +78,14 @@
 #include <ladybugrenderer.h>
 #include <ladybugstream.h>
 
+#include "BufferCountTuner.h"
+#include "CameraClock.h"
+#include "NmeaParser.h"
+#include "RealtimeSupport.h"
+#include "SensorLog.h"
+#include "StreamJournal.h"
+#include "TimeIndex.h"
+
 // Macros to check, report on, and handle Ladybug API error codes.
 #define _HANDLE_ERROR \
     if( error != LADYBUG_OK ) \
@@ -116,6 +133,8 @@ struct GPSDATA
 #define INI_WINDOW_SIZE_WIDTH          "WindowSizeWidth"
 #define INI_WINDOW_SIZE_HEIGHT         "WindowSizeHeight"
 #define INI_NUMBER_OF_BUFFERS          "NumberOfBuffers"
+#define INI_AUTO_TUNE_BUFFERS          "AutoTuneBuffers"
+#define INI_BUFFER_TUNING_SECONDS      "BufferTuningSeconds"
 #define INI_RECORDING_AUTO_START       "RecordingAutoStart"
 #define INI_LADYBUG_RESOLUTION         "LadybugResolution"
 #define INI_DATA_FORMAT                "DataFormat"
@@ -128,6 +147,13 @@ struct GPSDATA
 #define INI_BAUD_RATE                  "BaudRate"
 #define INI_UPDATE_RATE                "UpdateRate"
 #define INI_DISTANCE_X                 "Distance_x"
+#define INI_GRAB_THREAD_CPU            "GrabThreadCpu"
+#define INI_LOCK_MEMORY                "LockMemory"
+#define INI_NUMA_LOCAL_BUFFERS         "NumaLocalBuffers"
+#define INI_LATENCY_CHECK_MS           "LatencyCheckMs"
+#define INI_CHECKPOINT_INTERVAL        "CheckpointIntervalSeconds"
+#define INI_RECORD_SENSORS             "RecordSensors"
+#define INI_SENSOR_RATE                "SensorRateHz"
 
 // Values in INI file
 char pszStreamBaseName[_MAX_PATH];
@@ -136,6 +162,8 @@ int iWindowPositionY;
 int iWindowSizeWidth;
 int iWindowSizeHeight;
 int iNumberOfBuffers;
+bool bAutoTuneBuffers = false;
+int iBufferTuningSeconds = 10;
 bool bRecordingAutoStart;
 LadybugDataFormat ladybugDataFormat;
 LadybugColorProcessingMethod  colorProcessingMethod;
@@ -144,6 +172,13 @@ int iPortNumber = 1;
 int iBaudRate = 4800;
 int iUpdateRate = 1;
 int iDistance_x = 10;
+int iGrabThreadCpu = -1;
+bool bLockMemory = false;
+bool bNumaLocalBuffers = false;
+int iLatencyCheckMs = 0;
+int iCheckpointIntervalSeconds = 5;
+bool bRecordSensors = false;
+int iSensorRateHz = 0;
 
 enum DisplayModes
 {
@@ -153,6 +188,14 @@ enum DisplayModes
 };
 
 static double lastIdleTime;
+static double lastLockReturnTime = 0.0;
+BufferCountTuner* pBufferTuner = NULL;
+StreamJournal streamJournal;
+CameraClock cameraClock;
+unsigned long long ullPrevTick = 0;
+std::string recordingStreamPath;
+std::vector<unsigned long long> recordedTicks;
+SensorLogger sensorLogger;
 unsigned int frameCounter = 0;
 double frameRate = 0.0;
 double totalMBWritten = 0.0;
@@ -407,6 +450,12 @@ loadIniFile( const char* pszINIFilename )
     iniFileError = iniFile.getInt( 
         INI_NUMBER_OF_BUFFERS, &iNumberOfBuffers, 30 );
     if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
+    iniFileError = iniFile.getBool( 
+        INI_AUTO_TUNE_BUFFERS, &bAutoTuneBuffers, false );
+    if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
+    iniFileError = iniFile.getInt( 
+        INI_BUFFER_TUNING_SECONDS, &iBufferTuningSeconds, 10 );
+    if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
     iniFileError = iniFile.getBool( 
         INI_RECORDING_AUTO_START, &bRecordingAutoStart, false );
     if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
@@ -427,6 +476,28 @@ loadIniFile( const char* pszINIFilename )
         INI_DISTANCE_X, &iDistance_x, 10 );
     if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
 
+    iniFileError = iniFile.getInt( 
+        INI_GRAB_THREAD_CPU, &iGrabThreadCpu, -1 );
+    if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
+    iniFileError = iniFile.getBool( 
+        INI_LOCK_MEMORY, &bLockMemory, false );
+    if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
+    iniFileError = iniFile.getBool( 
+        INI_NUMA_LOCAL_BUFFERS, &bNumaLocalBuffers, false );
+    if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
+    iniFileError = iniFile.getInt( 
+        INI_LATENCY_CHECK_MS, &iLatencyCheckMs, 0 );
+    if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
+    iniFileError = iniFile.getInt( 
+        INI_CHECKPOINT_INTERVAL, &iCheckpointIntervalSeconds, 5 );
+    if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
+    iniFileError = iniFile.getBool( 
+        INI_RECORD_SENSORS, &bRecordSensors, false );
+    if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
+    iniFileError = iniFile.getInt( 
+        INI_SENSOR_RATE, &iSensorRateHz, 0 );
+    if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
+
     iniFileError = iniFile.getInt( INI_DATA_FORMAT, &iItemIndex, 1 );
     if ( iniFileError != ReadINIFile::OK ) bErrorFound = true;
     switch ( iItemIndex )
@@ -608,12 +679,101 @@ cleanUp( void )
         streamContext = NULL;
     }
 
+    delete pBufferTuner;
+    pBufferTuner = NULL;
+
     glutDestroyMenu( menu );
 
     return;
 }
 
 
+//=============================================================================
+// Mark the stream as cleanly stopped so that it is not recovered later
+//=============================================================================
+void
+closeStreamJournal( void )
+{
+    std::string journalError;
+    if ( !streamJournal.close( totalNumberOfImagesWritten, journalError ) )
+    {
+        printf( "Warning: unable to close stream journal: %s\n", journalError.c_str() );
+    }
+}
+
+//=============================================================================
+// Write the time of every recorded frame next to the stream
+//=============================================================================
+void
+writeTimeIndex( void )
+{
+    if ( recordingStreamPath.empty() )
+    {
+        return;
+    }
+
+    // All frames get their time from the final fit, which has seen the
+    // most PPS locked frames
+    std::vector<TimeIndexEntry> entries( recordedTicks.size() );
+    for ( size_t i = 0; i < recordedTicks.size(); i++ )
+    {
+        entries[i].tick = recordedTicks[i];
+        entries[i].utc = cameraClock.toUtc( recordedTicks[i] );
+    }
+
+    const std::string indexPath = timeIndex::getIndexPath( recordingStreamPath );
+    std::string indexError;
+    if ( !timeIndex::write( indexPath, entries, cameraClock.isLocked() ? timeIndex::IS_UTC : 0, indexError ) )
+    {
+        printf( "Warning: unable to write time index: %s\n", indexError.c_str() );
+    }
+    else if ( cameraClock.isLocked() )
+    {
+        printf( "Time index %s: %u frames in UTC, clock drift %.2f ppm (%u PPS frames, %u rejected)\n",
+            indexPath.c_str(), (unsigned int)entries.size(), cameraClock.getDriftPpm(),
+            cameraClock.getNumSamples(), cameraClock.getNumRejected() );
+    }
+    else
+    {
+        printf( "Time index %s: %u frames in camera time, no PPS lock\n",
+            indexPath.c_str(), (unsigned int)entries.size() );
+    }
+
+    recordingStreamPath.clear();
+    recordedTicks.clear();
+}
+
+//=============================================================================
+// Stop logging the sensors and write the rest of the log
+//=============================================================================
+void
+closeSensorLog( void )
+{
+    if ( !sensorLogger.isRunning() )
+    {
+        return;
+    }
+
+    std::string sensorError;
+    if ( !sensorLogger.stop( sensorError ) )
+    {
+        printf( "Warning: unable to write sensor log: %s\n", sensorError.c_str() );
+        return;
+    }
+
+    const SensorLogger::Statistics statistics = sensorLogger.getStatistics();
+    printf( "Sensor log:" );
+    for ( unsigned int sensor = 0; sensor < sensorLog::NUM_SENSORS; sensor++ )
+    {
+        if ( statistics.samples[sensor] > 0 )
+        {
+            printf( " %s %.1fHz", sensorLog::getSensorName( (sensorLog::Sensor)sensor ), 
+                statistics.samples[sensor] / statistics.seconds );
+        }
+    }
+    printf( ", %llu readings lost\n", statistics.dropped + statistics.readErrors );
+}
+
 //=============================================================================
 // Process keyboard command
 //=============================================================================
@@ -630,6 +790,9 @@ keyboard( unsigned char k, int /*x*/, int /*y*/ )
         {
             error = ladybugStopStream( streamContext );
             _HANDLE_ERROR;      
+            closeStreamJournal();
+            closeSensorLog();
+            writeTimeIndex();
         }
 
         cleanUp();
@@ -729,6 +892,35 @@ keyboard( unsigned char k, int /*x*/, int /*y*/ )
             if ( bRecordingInProgress )
             {
                 printf( "Recording to %s\n", pszStreamNameOpened );
+                recordingStreamPath = pszStreamNameOpened;
+                recordedTicks.clear();
+
+                if ( bRecordSensors )
+                {
+                    std::string sensorError;
+                    if ( !sensorLogger.start( 
+                        context, sensorLog::getLogPath( pszStreamNameOpened ), iSensorRateHz, sensorError ) )
+                    {
+                        printf( "Warning: unable to log sensors: %s\n", sensorError.c_str() );
+                    }
+                }
+
+                if ( iCheckpointIntervalSeconds > 0 )
+                {
+                    std::string journalError;
+                    if ( !streamJournal.open( 
+                        pszStreamNameOpened, iCheckpointIntervalSeconds, journalError ) )
+                    {
+                        printf( "Warning: unable to start stream journal: %s\n", journalError.c_str() );
+                    }
+                }
+
+                // Stalls only matter while writing, so the warm-up 
+                // window starts with the first recording
+                if ( pBufferTuner != NULL && !pBufferTuner->isWarmupComplete() )
+                {
+                    pBufferTuner->start();
+                }
             }
             else
             {
@@ -742,6 +934,12 @@ keyboard( unsigned char k, int /*x*/, int /*y*/ )
             //
             error = ladybugStopStream( streamContext );
             bRecordingInProgress = false;
+            if ( error == LADYBUG_OK )
+            {
+                closeStreamJournal();
+            }
+            closeSensorLog();
+            writeTimeIndex();
         }
         _DISPLAY_ERROR_MSG_AND_RETURN;  
         break;
@@ -826,6 +1024,47 @@ startCamera( void)
     error = ::ladybugCreateContext( &context );
     _HANDLE_ERROR;
 
+    //
+    // Lock memory and pick the NUMA node before the image buffers are 
+    // allocated, so that grabbing never has to page in a buffer.
+    //
+    std::string realtimeError;
+    if ( bLockMemory && !realtime::lockAllMemory( realtimeError ) )
+    {
+        printf( "Warning: unable to lock memory: %s\n", realtimeError.c_str() );
+    }
+
+    if ( bNumaLocalBuffers && iGrabThreadCpu >= 0 && 
+        !realtime::preferNumaNodeOfCpu( iGrabThreadCpu, realtimeError ) )
+    {
+        printf( "Warning: unable to allocate buffers NUMA-locally: %s\n", realtimeError.c_str() );
+    }
+
+    //
+    // Use the buffer count tuned by an earlier run for this host and 
+    // camera model, if there is one.
+    //
+    if ( bAutoTuneBuffers )
+    {
+        LadybugCameraInfo enumeratedCameras[16];
+        unsigned int numCameras = 16;
+        error = ladybugBusEnumerateCameras( context, enumeratedCameras, &numCameras );
+        _HANDLE_ERROR;
+
+        if ( numCameras > 0 )
+        {
+            unsigned int uiNumberOfBuffers = 0;
+            pBufferTuner = new BufferCountTuner( 
+                enumeratedCameras[0].pszModelName, iBufferTuningSeconds );
+            if ( pBufferTuner->loadBufferCount( uiNumberOfBuffers ) )
+            {
+                iNumberOfBuffers = uiNumberOfBuffers;
+                printf( "Using tuned buffer count %d from %s\n", 
+                    iNumberOfBuffers, pBufferTuner->getStoragePath().c_str() );
+            }
+        }
+    }
+
     //
     // Initialize the first ladybug on the bus.
     //
@@ -898,6 +1137,7 @@ startCamera( void)
         error = ladybugLockNext( context, &image_Prev );
     } while ( ( error != LADYBUG_OK )  && ( iTryTimes++ < 10) );    
     _HANDLE_ERROR;
+    ullPrevTick = cameraClock.addImage( image_Prev );
 
     //
     // Load config file from the head
@@ -936,6 +1176,25 @@ startCamera( void)
     ladybugSetAlphaMasking( context, true );
 
 
+    //
+    // Grabbing runs on this thread from the GLUT idle function, together with
+    // writing the stream, drawing and keyboard handling, so it is only 
+    // pinned and never given realtime priority: that would run blocking disk
+    // writes and OpenGL ahead of everything else on the CPU. Pin it now that
+    // the SDK has created its own threads, so that those stay unpinned.
+    //
+    if ( iGrabThreadCpu >= 0 && 
+        !realtime::pinCurrentThreadToCpu( iGrabThreadCpu, realtimeError ) )
+    {
+        printf( "Warning: unable to pin grab thread: %s\n", realtimeError.c_str() );
+    }
+
+    if ( iLatencyCheckMs > 0 )
+    {
+        printf( "Grab thread wake-up latency: %s\n", 
+            realtime::toString( realtime::measureWakeupLatency( iLatencyCheckMs ) ).c_str() );
+    }
+
     // we will not use auto buffer usage feature, set it to a fixed percentage
     printf( "Disabling Auto JPEG Quality control...\n");
     error = ladybugSetAutoJPEGQualityControlFlag( context, false);
@@ -962,8 +1221,21 @@ void retrieveGPSData( const LadybugImage* pImage,  GPSDATA* pGPS_Data )
 {
     LadybugError gpsError;
 
-    LadybugNMEAGPGGA NMEAGGA_Data;
     pGPS_Data->bValidData = false;
+
+    // Parse the NMEA text of the frame once for all sentence types,
+    // rather than asking the library for each type in turn
+    const char* pNmeaText = NULL;
+    size_t nmeaLength = 0;
+    if ( nmeaParser::findInImage( *pImage, pNmeaText, nmeaLength ) )
+    {
+        NmeaData nmeaData;
+        nmeaParser::parse( pNmeaText, nmeaLength, nmeaData );
+        pGPS_Data->bValidData = nmeaParser::getPosition( nmeaData, pGPS_Data->dLatitude, pGPS_Data->dLongitude );
+        return;
+    }
+
+    LadybugNMEAGPGGA NMEAGGA_Data;
     gpsError = ladybugGetGPSNMEADataFromImage( pImage, "GPGGA", &NMEAGGA_Data );
     if ( gpsError == LADYBUG_OK &&  NMEAGGA_Data.bValidData )
     {
@@ -1089,18 +1361,57 @@ recordingImage( void )
     double dTimeDiff = 0;    
     bool bRecordingCurrentImage = false;
     double dDistance = 0;
+    unsigned long long ullCurrentTick = 0;
+
+    // Time spent processing, writing and drawing since the last image was
+    // locked. Waiting inside ladybugLockNext() for the next image is the 
+    // normal frame interval, not a stall, so it is not counted.
+    const double stallSeconds = 
+        lastLockReturnTime > 0.0 ? ( getCurrentMs() - lastLockReturnTime ) / 1000.0 : 0.0;
 
     error = ladybugLockNext( context, &image_Current );
+    lastLockReturnTime = error == LADYBUG_OK ? getCurrentMs() : 0.0;
 
     switch ( error )
     {
     case LADYBUG_OK:
-        // Calculate frame rate
-        dTimeDiff = (( image_Current.timeStamp.ulCycleSeconds * 8000.0 + 
-            image_Current.timeStamp.ulCycleCount ) -  
-            ( image_Prev.timeStamp.ulCycleSeconds * 8000.0 + 
-            image_Prev.timeStamp.ulCycleCount ) ) / 8000.0;
-        frameRate =  1.0 / dTimeDiff;
+        if ( pBufferTuner != NULL && bRecordingInProgress )
+        {
+            pBufferTuner->addSamples( 1, stallSeconds );
+            if ( pBufferTuner->isWarmupComplete() )
+            {
+                const unsigned int uiTunedBuffers = pBufferTuner->computeBufferCount();
+                printf( "Tuned buffer count: %u (worst stall %.1fms at %.1ffps), "
+                    "used from the next start\n",
+                    uiTunedBuffers,
+                    pBufferTuner->getWorstStallSeconds() * 1000.0,
+                    pBufferTuner->getObservedFrameRate() );
+                if ( !pBufferTuner->saveBufferCount( uiTunedBuffers ) )
+                {
+                    printf( "Warning: unable to store tuned buffer count in %s\n",
+                        pBufferTuner->getStoragePath().c_str() );
+                }
+
+                delete pBufferTuner;
+                pBufferTuner = NULL;
+            }
+        }
+
+
+        // Calculate frame rate from the unwrapped cycle time, which 
+        // stays right when the cycle seconds wrap
+        ullCurrentTick = cameraClock.addImage( image_Current );
+        dTimeDiff = CameraClock::toSeconds( ullCurrentTick - ullPrevTick );
+        ullPrevTick = ullCurrentTick;
+        if ( dTimeDiff > 0.0 )
+        {
+            frameRate =  1.0 / dTimeDiff;
+        }
+
+        if ( sensorLogger.isRunning() )
+        {
+            sensorLogger.addImage( ullCurrentTick );
+        }
 
         if ( bRecordingGPSData )
         {         
@@ -1155,8 +1466,22 @@ recordingImage( void )
                     //
                     bRecordingInProgress = false;
                     ladybugStopStream ( streamContext );
+                    closeSensorLog();
+                    writeTimeIndex();
                     _DISPLAY_ERROR_MSG_AND_RETURN;  
                 }
+
+                recordedTicks.push_back( ullCurrentTick );
+                if ( sensorLogger.isRunning() )
+                {
+                    sensorLogger.addFrame( (unsigned int)( totalNumberOfImagesWritten - 1 ), ullCurrentTick );
+                }
+
+                std::string journalError;
+                if ( !streamJournal.update( totalNumberOfImagesWritten, journalError ) )
+                {
+                    printf( "Warning: stream checkpoint failed: %s\n", journalError.c_str() );
+                }
             }
 
             char pszGPSStr[64];
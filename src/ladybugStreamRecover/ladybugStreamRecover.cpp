@@ -0,0 +1,627 @@
+//=============================================================================
+// Copyright (c) 2001-2018 FLIR Systems, Inc. All Rights Reserved.
+//
+// This software is the confidential and proprietary information of FLIR
+// Integrated Imaging Solutions, Inc. ("Confidential Information"). You
+// shall not disclose such Confidential Information and shall use it only in
+// accordance with the terms of the license agreement you entered into
+// with FLIR Integrated Imaging Solutions, Inc. (FLIR).
+//
+// FLIR MAKES NO REPRESENTATIONS OR WARRANTIES ABOUT THE SUITABILITY OF THE
+// SOFTWARE, EITHER EXPRESSED OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE, OR NON-INFRINGEMENT. FLIR SHALL NOT BE LIABLE FOR ANY DAMAGES
+// SUFFERED BY LICENSEE AS A RESULT OF USING, MODIFYING OR DISTRIBUTING
+// THIS SOFTWARE OR ITS DERIVATIVES.
+//=============================================================================
+//
+// ladybugStreamRecover.cpp
+// 
+// This program repairs a Ladybug stream that was being recorded when the 
+// recorder lost power or crashed. 
+//
+// The recorders keep a journal next to the stream (name.journal for 
+// name-000000.pgr) with the segment being written, how many of its bytes
+// were flushed to disk at the last checkpoint and how many images had been
+// written by then. This program finds the last readable image by reading 
+// on from the checkpoint instead of reading the whole stream, then cuts 
+// the stream after that image: the rest of its segment is saved to a .tail
+// file and segments started after it are renamed to .tail as well. The 
+// cut stream is then reopened to check that it ends at the last readable 
+// image; if not, the .tail data is put back. Optionally it copies the readable images to a new stream so that its 
+// header and index are rebuilt.
+//
+// Without a journal, the stream is left untouched and the last readable 
+// image is searched for in the whole stream.
+//
+//=============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string.h>
+#include <string>
+#include <stdlib.h>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <ladybugstream.h>
+
+#include "StreamJournal.h"
+#include "StreamSegment.h"
+
+#define _HANDLE_ERROR \
+    if( error != LADYBUG_OK ) \
+{ \
+    printf( "Error! Ladybug library reported %s\n", \
+    ::ladybugErrorToString( error ) ); \
+    goto _EXIT; \
+} 
+
+namespace
+{
+    // Images read past the checkpoint before giving up on finding more
+    const unsigned int k_maxImagesPastCheckpoint = 100000;
+
+    // The start of an image that identifies it in the segment files, and 
+    // how far before the checkpoint to start looking for it
+    const size_t k_signatureBytes = 4096;
+    const unsigned long long k_searchImagesBeforeCheckpoint = 4;
+    const size_t k_searchChunkBytes = 1 << 20;
+
+    bool isImageReadable( LadybugStreamContext context, unsigned int imageIndex )
+    {
+        LadybugImage image;
+        return ladybugGoToImage( context, imageIndex ) == LADYBUG_OK &&
+            ladybugReadImageFromStream( context, &image ) == LADYBUG_OK;
+    }
+
+    /** 
+     * Number of readable images, given that the first knownGood images are 
+     * readable and reading from firstBad onwards is known to fail.
+     * Readable images always form a prefix of the stream.
+     */
+    unsigned int countReadableImages( LadybugStreamContext context, unsigned int knownGood, unsigned int firstBad )
+    {
+        while ( knownGood < firstBad )
+        {
+            const unsigned int middle = knownGood + ( firstBad - knownGood ) / 2;
+            if ( isImageReadable( context, middle ) )
+            {
+                knownGood = middle + 1;
+            }
+            else
+            {
+                firstBad = middle;
+            }
+        }
+
+        return knownGood;
+    }
+
+    /** The journal stores absolute paths; fall back to the stream's directory if it moved. */
+    std::string locateSegment( const std::string& journaledPath, const std::string& streamPath )
+    {
+        FILE* pFile = fopen( journaledPath.c_str(), "rb" );
+        if ( pFile != NULL )
+        {
+            fclose( pFile );
+            return journaledPath;
+        }
+
+        const size_t journaledSeparator = journaledPath.find_last_of( "/\\" );
+        const size_t streamSeparator = streamPath.find_last_of( "/\\" );
+        const std::string directory = streamSeparator == std::string::npos ? "" : streamPath.substr( 0, streamSeparator + 1 );
+        const std::string fileName = journaledSeparator == std::string::npos ? journaledPath : journaledPath.substr( journaledSeparator + 1 );
+        return directory + fileName;
+    }
+
+#ifndef _WIN32
+    /** Offset of the first copy of pattern in a file, at or after startOffset. */
+    bool findBytes( const std::string& path, unsigned long long startOffset, const std::vector<unsigned char>& pattern, unsigned long long& offset )
+    {
+        FILE* pFile = fopen( path.c_str(), "rb" );
+        if ( pFile == NULL || pattern.empty() || fseeko( pFile, (off_t)startOffset, SEEK_SET ) != 0 )
+        {
+            if ( pFile != NULL ) fclose( pFile );
+            return false;
+        }
+
+        std::vector<unsigned char> buffer( k_searchChunkBytes + pattern.size() );
+        unsigned long long bufferOffset = startOffset;
+        size_t kept = 0;
+        bool isFound = false;
+        while ( !isFound )
+        {
+            const size_t bytesRead = fread( &buffer[kept], 1, k_searchChunkBytes, pFile );
+            const size_t available = kept + bytesRead;
+            const std::vector<unsigned char>::const_iterator match = 
+                std::search( buffer.begin(), buffer.begin() + available, pattern.begin(), pattern.end() );
+            if ( match != buffer.begin() + available )
+            {
+                offset = bufferOffset + ( match - buffer.begin() );
+                isFound = true;
+            }
+            else if ( bytesRead == 0 )
+            {
+                break;
+            }
+            else
+            {
+                // Keep the end of the chunk, which may hold the start of a match
+                kept = std::min( available, pattern.size() - 1 );
+                memmove( &buffer[0], &buffer[available - kept], kept );
+                bufferOffset += available - kept;
+            }
+        }
+
+        fclose( pFile );
+        return isFound;
+    }
+#endif
+
+    /** What cutStream changed, so that restoreStream can undo it. */
+    struct StreamCut
+    {
+        // The segment that was truncated, empty if none was
+        std::string truncatedPath;
+
+        // Segments renamed to .tail, in the order they were renamed
+        std::vector<std::string> movedPaths;
+
+        bool isEmpty() const
+        {
+            return truncatedPath.empty() && movedPaths.empty();
+        }
+    };
+
+    /** Move everything past keepBytes to segmentPath.tail and cut the segment there. */
+    bool truncateSegment( const std::string& segmentPath, unsigned long long keepBytes, unsigned long long& bytesRemoved )
+    {
+        bytesRemoved = 0;
+
+#ifdef _WIN32
+        (void)segmentPath;
+        (void)keepBytes;
+        printf( "Truncating segments is not supported on this platform.\n" );
+        return false;
+#else
+        struct stat fileStatus;
+        if ( stat( segmentPath.c_str(), &fileStatus ) != 0 )
+        {
+            printf( "Unable to find segment %s\n", segmentPath.c_str() );
+            return false;
+        }
+
+        const unsigned long long fileSize = (unsigned long long)fileStatus.st_size;
+        if ( fileSize <= keepBytes )
+        {
+            return true;
+        }
+
+        FILE* pSegment = fopen( segmentPath.c_str(), "rb" );
+        const std::string tailPath = segmentPath + ".tail";
+        FILE* pTail = fopen( tailPath.c_str(), "wb" );
+        if ( pSegment == NULL || pTail == NULL )
+        {
+            printf( "Unable to save the torn tail to %s\n", tailPath.c_str() );
+            if ( pSegment != NULL ) fclose( pSegment );
+            if ( pTail != NULL ) fclose( pTail );
+            return false;
+        }
+
+        bool isSaved = fseeko( pSegment, (off_t)keepBytes, SEEK_SET ) == 0;
+        char buffer[1 << 16];
+        size_t bytesRead = 0;
+        while ( isSaved && ( bytesRead = fread( buffer, 1, sizeof(buffer), pSegment ) ) > 0 )
+        {
+            isSaved = fwrite( buffer, 1, bytesRead, pTail ) == bytesRead;
+        }
+
+        fclose( pSegment );
+        isSaved = fflush( pTail ) == 0 && fsync( fileno( pTail ) ) == 0 && isSaved;
+        fclose( pTail );
+
+        if ( !isSaved )
+        {
+            printf( "Unable to save the torn tail to %s\n", tailPath.c_str() );
+            return false;
+        }
+
+        if ( truncate( segmentPath.c_str(), (off_t)keepBytes ) != 0 )
+        {
+            printf( "Unable to truncate %s\n", segmentPath.c_str() );
+            return false;
+        }
+
+        bytesRemoved = fileSize - keepBytes;
+        printf( "Moved %llu bytes past the last readable image to %s\n", bytesRemoved, tailPath.c_str() );
+        return true;
+#endif
+    }
+
+    /** 
+     * Cut the stream after the image that starts with signature and is 
+     * imageSize bytes long, searching from the checkpoint segment on. With
+     * no signature, cut the checkpoint segment at durableBytes. Segments 
+     * after the one the image is in are renamed to .tail.
+     */
+    bool cutStream( 
+        const std::string& checkpointSegmentPath, 
+        unsigned long long durableBytes, 
+        const std::vector<unsigned char>& signature, 
+        unsigned int imageSize,
+        StreamCut& cut )
+    {
+        cut = StreamCut();
+
+#ifdef _WIN32
+        (void)checkpointSegmentPath;
+        (void)durableBytes;
+        (void)signature;
+        (void)imageSize;
+        printf( "Truncating segments is not supported on this platform.\n" );
+        return false;
+#else
+        std::string prefix;
+        unsigned int checkpointIndex = 0;
+        if ( !streamSegment::splitPath( checkpointSegmentPath, prefix, checkpointIndex ) )
+        {
+            printf( "Unexpected segment name %s\n", checkpointSegmentPath.c_str() );
+            return false;
+        }
+
+        unsigned int lastIndex = checkpointIndex;
+        unsigned long long keepBytes = durableBytes;
+        if ( !signature.empty() )
+        {
+            // The image may have started a little before the checkpoint, 
+            // or in a segment started after it
+            const unsigned long long window = k_searchImagesBeforeCheckpoint * imageSize;
+            bool isFound = false;
+            for ( unsigned int index = checkpointIndex; 
+                !isFound && streamSegment::exists( streamSegment::makePath( prefix, index ) ); 
+                index++ )
+            {
+                const std::string segmentPath = streamSegment::makePath( prefix, index );
+                const unsigned long long searchFrom = index == checkpointIndex && durableBytes > window ? durableBytes - window : 0;
+                unsigned long long offset = 0;
+                isFound = findBytes( segmentPath, searchFrom, signature, offset ) || 
+                    ( searchFrom > 0 && findBytes( segmentPath, 0, signature, offset ) );
+                if ( isFound )
+                {
+                    lastIndex = index;
+                    keepBytes = offset + imageSize;
+                }
+            }
+
+            if ( !isFound )
+            {
+                printf( "The last readable image was not found in the segment files, leaving them as they are.\n" );
+                return true;
+            }
+        }
+
+        unsigned long long bytesRemoved = 0;
+        const std::string lastSegmentPath = streamSegment::makePath( prefix, lastIndex );
+        if ( !truncateSegment( lastSegmentPath, keepBytes, bytesRemoved ) )
+        {
+            return false;
+        }
+
+        if ( bytesRemoved > 0 )
+        {
+            cut.truncatedPath = lastSegmentPath;
+        }
+
+        for ( unsigned int index = lastIndex + 1; streamSegment::exists( streamSegment::makePath( prefix, index ) ); index++ )
+        {
+            const std::string segmentPath = streamSegment::makePath( prefix, index );
+            const std::string tailPath = segmentPath + ".tail";
+            if ( rename( segmentPath.c_str(), tailPath.c_str() ) != 0 )
+            {
+                printf( "Unable to move %s to %s\n", segmentPath.c_str(), tailPath.c_str() );
+                return false;
+            }
+            cut.movedPaths.push_back( segmentPath );
+            printf( "Moved %s, written after the last readable image, to %s\n", segmentPath.c_str(), tailPath.c_str() );
+        }
+
+        return true;
+#endif
+    }
+
+    /** Put the .tail data saved by cutStream back where it came from. */
+    bool restoreStream( const StreamCut& cut )
+    {
+#ifdef _WIN32
+        return cut.isEmpty();
+#else
+        bool isRestored = true;
+        for ( size_t i = cut.movedPaths.size(); i > 0; i-- )
+        {
+            const std::string& segmentPath = cut.movedPaths[i - 1];
+            const std::string tailPath = segmentPath + ".tail";
+            if ( rename( tailPath.c_str(), segmentPath.c_str() ) != 0 )
+            {
+                printf( "Unable to move %s back to %s\n", tailPath.c_str(), segmentPath.c_str() );
+                isRestored = false;
+            }
+        }
+
+        if ( !cut.truncatedPath.empty() )
+        {
+            const std::string tailPath = cut.truncatedPath + ".tail";
+            FILE* pTail = fopen( tailPath.c_str(), "rb" );
+            FILE* pSegment = fopen( cut.truncatedPath.c_str(), "ab" );
+            bool isAppended = pTail != NULL && pSegment != NULL;
+            char buffer[1 << 16];
+            size_t bytesRead = 0;
+            while ( isAppended && ( bytesRead = fread( buffer, 1, sizeof(buffer), pTail ) ) > 0 )
+            {
+                isAppended = fwrite( buffer, 1, bytesRead, pSegment ) == bytesRead;
+            }
+
+            isAppended = isAppended && !ferror( pTail );
+            if ( pSegment != NULL )
+            {
+                isAppended = fflush( pSegment ) == 0 && fsync( fileno( pSegment ) ) == 0 && isAppended;
+                fclose( pSegment );
+            }
+            if ( pTail != NULL ) fclose( pTail );
+
+            if ( isAppended )
+            {
+                std::remove( tailPath.c_str() );
+            }
+            else
+            {
+                printf( "Unable to append %s back to %s\n", tailPath.c_str(), cut.truncatedPath.c_str() );
+                isRestored = false;
+            }
+        }
+
+        if ( isRestored && !cut.isEmpty() )
+        {
+            printf( "Put the cut data back, the stream is as it was.\n" );
+        }
+        return isRestored;
+#endif
+    }
+
+    /** 
+     * Whether the stream reads up to image numImages - 1 and no further. 
+     * Leaves the context stopped.
+     */
+    bool isCutVerified( LadybugStreamContext context, const std::string& streamPath, unsigned int numImages )
+    {
+        if ( ladybugInitializeStreamForReading( context, streamPath.c_str(), true ) != LADYBUG_OK )
+        {
+            // A stream with no images left may not open at all
+            return numImages == 0;
+        }
+
+        const bool isVerified = 
+            ( numImages == 0 || isImageReadable( context, numImages - 1 ) ) &&
+            !isImageReadable( context, numImages );
+        ladybugStopStream( context );
+        return isVerified;
+    }
+}
+
+void usage()
+{
+    printf (
+        "Usage :\n"
+        "\t ladybugStreamRecover SrcFileName [OutputFileName]\n"
+        "\n"
+        "where\n"
+        "\t SrcFileName - the first PGR stream file of the stream to repair, \n"
+        "\t for example c:\\Recorded\\LadybugStream-000000.pgr \n\n"
+        "\t [OutputFileName] - optional, a new stream to copy the readable images to,\n"
+        "\t including the path to the destination directory. This rebuilds the stream\n"
+        "\t header so that tools relying on the image count can process it.\n"
+        "\n"
+        );
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        usage();
+        return 0;
+    }
+
+    const std::string srcStreamName = argv[1];
+    const char* pszDestStreamName = (argc > 2) ? argv[2] : NULL;
+
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    // Read the journal written during recording
+    StreamJournal::Checkpoint checkpoint;
+    std::string journalError;
+    const std::string journalPath = StreamJournal::getJournalPath( srcStreamName );
+    const bool hasJournal = StreamJournal::read( journalPath, checkpoint, journalError );
+    if ( hasJournal )
+    {
+        printf( "Journal %s: segment %s, %llu bytes and %lu images at the last checkpoint%s\n",
+            journalPath.c_str(),
+            checkpoint.segmentPath.c_str(),
+            checkpoint.durableBytes,
+            checkpoint.imagesWritten,
+            checkpoint.isComplete ? ", stream was stopped cleanly" : "" );
+
+        if ( checkpoint.isComplete && pszDestStreamName == NULL )
+        {
+            printf( "Nothing to recover.\n" );
+            return 0;
+        }
+    }
+    else
+    {
+        printf( "No usable journal (%s), searching the whole stream.\n", journalError.c_str() );
+    }
+
+    LadybugStreamContext readingContext = NULL;
+    LadybugStreamContext writingContext = NULL;
+    std::string configFileName;
+    unsigned int uiNumOfReadableImages = 0;
+    bool isCut = true;
+
+    LadybugError error = ladybugCreateStreamContext( &readingContext );
+    _HANDLE_ERROR
+
+    printf( "Opening stream file : %s\n", srcStreamName.c_str() );
+    error = ladybugInitializeStreamForReading( readingContext, srcStreamName.c_str(), true ); 
+    _HANDLE_ERROR
+
+    {
+        // The header of a torn stream may be stale, so it is only a hint
+        unsigned int uiNumOfImagesInHeader = 0;
+        if ( ladybugGetStreamNumOfImages( readingContext, &uiNumOfImagesInHeader ) != LADYBUG_OK )
+        {
+            uiNumOfImagesInHeader = 0;
+        }
+
+        printf( "The stream header reports %u images.\n", uiNumOfImagesInHeader );
+
+        if ( hasJournal )
+        {
+            // Images written up to the checkpoint are on disk; the writer 
+            // may have flushed a few more before the power went
+            const unsigned int uiCheckpointImages = (unsigned int)checkpoint.imagesWritten;
+            if ( uiCheckpointImages == 0 || isImageReadable( readingContext, uiCheckpointImages - 1 ) )
+            {
+                uiNumOfReadableImages = uiCheckpointImages;
+                while ( uiNumOfReadableImages < uiCheckpointImages + k_maxImagesPastCheckpoint &&
+                    isImageReadable( readingContext, uiNumOfReadableImages ) )
+                {
+                    uiNumOfReadableImages++;
+                }
+            }
+            else
+            {
+                uiNumOfReadableImages = countReadableImages( readingContext, 0, uiCheckpointImages - 1 );
+            }
+        }
+        else if ( uiNumOfImagesInHeader > 0 )
+        {
+            uiNumOfReadableImages = isImageReadable( readingContext, uiNumOfImagesInHeader - 1 ) ? 
+                uiNumOfImagesInHeader : countReadableImages( readingContext, 0, uiNumOfImagesInHeader - 1 );
+        }
+    }
+
+    printf( "%u images are readable (%.2f s).\n", 
+        uiNumOfReadableImages, 
+        std::chrono::duration<double>( std::chrono::steady_clock::now() - startTime ).count() );
+
+    if ( hasJournal && !checkpoint.isComplete )
+    {
+        // The start of the last readable image finds it in the segment files
+        std::vector<unsigned char> signature;
+        unsigned int uiImageSize = 0;
+        if ( uiNumOfReadableImages > 0 )
+        {
+            LadybugImage lastImage;
+            error = ladybugGoToImage( readingContext, uiNumOfReadableImages - 1 );
+            _HANDLE_ERROR
+
+            error = ladybugReadImageFromStream( readingContext, &lastImage );
+            _HANDLE_ERROR
+
+            uiImageSize = lastImage.uiDataSizeBytes;
+            signature.assign( lastImage.pData, lastImage.pData + std::min( (size_t)uiImageSize, k_signatureBytes ) );
+        }
+
+        // Release the segments before changing them
+        ladybugStopStream( readingContext );
+
+        StreamCut cut;
+        isCut = cutStream( locateSegment( checkpoint.segmentPath, srcStreamName ), checkpoint.durableBytes, signature, uiImageSize, cut );
+        if ( isCut && !cut.isEmpty() && !isCutVerified( readingContext, srcStreamName, uiNumOfReadableImages ) )
+        {
+            printf( "After cutting, the stream does not end at image %u.\n", uiNumOfReadableImages );
+            isCut = false;
+        }
+
+        if ( !isCut )
+        {
+            if ( !restoreStream( cut ) )
+            {
+                printf( "Unable to put back all of the cut data, see the .tail files next to the stream.\n" );
+            }
+            goto _EXIT;
+        }
+
+        if ( pszDestStreamName != NULL && uiNumOfReadableImages > 0 )
+        {
+            error = ladybugInitializeStreamForReading( readingContext, srcStreamName.c_str(), true ); 
+            _HANDLE_ERROR
+        }
+    }
+
+    if ( pszDestStreamName != NULL && uiNumOfReadableImages > 0 )
+    {
+        // Copy the readable images to a new stream with a fresh header
+        LadybugStreamHeadInfo streamHeaderInfo;  
+        error = ladybugGetStreamHeader( readingContext, &streamHeaderInfo );
+        _HANDLE_ERROR
+
+        configFileName = std::string( pszDestStreamName ) + ".cal";
+        error = ladybugGetStreamConfigFile( readingContext, configFileName.c_str() );
+        _HANDLE_ERROR
+
+        error = ladybugCreateStreamContext( &writingContext );
+        _HANDLE_ERROR
+
+        printf( "Opening destination stream file : %s\n", pszDestStreamName );
+        error = ladybugInitializeStreamForWritingEx( 
+            writingContext,
+            pszDestStreamName, 
+            &streamHeaderInfo, 
+            configFileName.c_str(), 
+            true );
+        _HANDLE_ERROR
+
+        error = ladybugGoToImage( readingContext, 0 );
+        _HANDLE_ERROR
+
+        for ( unsigned int currIndex = 0; currIndex < uiNumOfReadableImages; currIndex++ ) 
+        {
+            LadybugImage currentImage;
+            error = ladybugReadImageFromStream( readingContext, &currentImage );
+            _HANDLE_ERROR
+
+            error = ladybugWriteImageToStream( writingContext, &currentImage );
+            _HANDLE_ERROR
+        }
+
+        printf( "Copied %u images to %s-000000.pgr\n", uiNumOfReadableImages, pszDestStreamName );
+    }
+
+_EXIT:
+
+    if ( writingContext != NULL )
+    {
+        ladybugStopStream( writingContext );
+        ladybugDestroyStreamContext( &writingContext );
+    }
+
+    if ( readingContext != NULL )
+    {
+        ladybugStopStream( readingContext );
+        ladybugDestroyStreamContext( &readingContext );
+    }
+
+    if ( !configFileName.empty() )
+    {
+        std::remove( configFileName.c_str() );
+    }
+
+    return error == LADYBUG_OK && isCut ? 0 : -1;
+}
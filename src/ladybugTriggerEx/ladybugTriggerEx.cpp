@@ -23,6 +23,13 @@
 // Ladybug SDK.
 // In this example, the camera is set to trigger mode 0 and the source of the
 // trigger is set to software.
+//
+// Without options the example waits for IMAGES_TO_CAPTURE triggers and saves
+// camera 0 of each. With a schedule (-r, -b, -T or -D) it fires the software
+// trigger itself from a realtime thread at absolute deadlines, matches each
+// frame to the trigger that caused it and reports histograms of the trigger
+// timing and of the latency from trigger to frame. -s searches for the
+// highest trigger rate that the camera keeps up with.
 //=============================================================================
 
 //
@@ -42,9 +49,22 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 #include <ladybug.h>
+#include <ladybugGPS.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <deque>
+#include <string>
 #include <thread>
+#include <vector>
+
+#include "getopt.h"
+#include "CameraClock.h"
+#include "LatencyHistogram.h"
+#include "TriggerScheduler.h"
 
 //
 // Macros for customization
@@ -65,11 +85,89 @@
 
 #define COLOR_PROCESSING_METHOD LADYBUG_DOWNSAMPLE4
 
+// Grab timeout when the example fires the trigger itself, so that the grab
+// loop notices when the schedule has ended
+#define SCHEDULED_GRAB_TIMEOUT_MS 500
+
+#define DEFAULT_SCHEDULED_TRIGGERS 100
+#define DEFAULT_SWEEP_START_RATE 5.0
+#define SWEEP_RATE_STEP 1.1
+#define SWEEP_MAX_STEPS 50
+
+// Number of pending triggers searched for the one that matches a frame
+#define MATCH_WINDOW 8
+
+#define DEFAULT_GPS_BAUD_RATE 115200
+#define GPS_UPDATE_INTERVAL_MS 100
+#define GPS_POLL_INTERVAL_MS 10
+#define DEFAULT_MIN_DISTANCE_TRIGGER_INTERVAL 0.05
+
 //
 // Global variables
 //
 unsigned char*    arpBuffers[ LADYBUG_NUM_CAMERAS ];
 
+//
+// Types
+//
+struct ScheduleOptions
+{
+   bool bScheduled;
+   bool bSweep;
+   TriggerScheduler::Settings settings;
+
+   // -T: seconds from the start of the schedule
+   std::vector<double> fireTimes;
+
+   // -D: fire each time the GPS position has moved this far
+   double dDistanceMeters;
+   std::string gpsDevice;
+   unsigned int uiGpsBaudRate;
+};
+
+// A frame and the software trigger that caused it
+struct TriggeredFrame
+{
+   long long fireNs;
+   long long arrivalNs;
+   double dTimestampSeconds;
+};
+
+struct ScheduleResult
+{
+   ScheduleResult() :
+   uiFired( 0 ), uiSkipped( 0 ), uiFrames( 0 ), uiLost( 0 ), uiUnexpected( 0 ),
+   bFailed( false ), dArrivalGrowthUs( 0.0 ),
+   lateness( 1.0, 1 ), fireDuration( 1.0, 1 ),
+   arrival( 100.0, 1000 ), timestamp( 1.0, 2000 )
+   {
+   }
+
+   unsigned int uiFired;
+   unsigned int uiSkipped;
+   unsigned int uiFrames;
+
+   // Triggers without a frame, and frames without a trigger
+   unsigned int uiLost;
+   unsigned int uiUnexpected;
+
+   bool bFailed;
+
+   // How much later frames arrived at the end of the run than at the start;
+   // grows when the camera or the bus cannot keep up with the trigger rate
+   double dArrivalGrowthUs;
+
+   // From the scheduler: deadline to trigger, and the register write
+   LatencyHistogram lateness;
+   LatencyHistogram fireDuration;
+
+   // Trigger to ladybugGrabImage() returning the frame, on the host clock
+   LatencyHistogram arrival;
+
+   // Trigger to frame timestamp, relative to the shortest
+   LatencyHistogram timestamp;
+};
+
 //
 // Helper functions
 //
@@ -136,20 +234,567 @@ bool saveImage( LadybugContext context, LadybugImage *image, int index)
    return true;
 }
 
+void displayUsage( const char* pszProgramName )
+{
+   printf( "Usage: %s [options]\n"
+      "Without a schedule, waits for %d triggers and saves camera 0 of each image.\n"
+      "\n"
+      "Schedules:\n"
+      " -r RATE               Fire the software trigger at RATE Hz\n"
+      " -b COUNTxRATE/PERIOD  Fire bursts of COUNT triggers at RATE Hz every PERIOD seconds\n"
+      " -T FILE               Fire at the times in FILE, in seconds from the start, in order\n"
+      " -D METERS             Fire each time the GPS position has moved METERS (needs -G)\n"
+      " -s                    Raise the rate from -r (default %.0f Hz) by %.0f%% per step\n"
+      "                       until the camera stops keeping up, and report the highest\n"
+      "                       sustained rate\n"
+      "\n"
+      "Options:\n"
+#ifdef _WIN32
+      " -G PORT[:BAUD]        COM port of the GPS device (default baud %d)\n"
+#else
+      " -G DEVICE[:BAUD]      GPS device, e.g. /dev/ttyACM0 (default baud %d)\n"
+#endif
+      " -i SECONDS            Least time between distance triggers (default %.2f)\n"
+      " -n COUNT              Stop after COUNT triggers, per step with -s (default %d)\n"
+      " -p PRIORITY           Realtime priority of the trigger thread, 1-99\n"
+      " -c CPU                Pin the trigger thread to CPU\n"
+      " -w MICROSECONDS       Busy wait for the last MICROSECONDS before each trigger\n"
+      " -?                    Show this help\n",
+      pszProgramName, IMAGES_TO_CAPTURE, DEFAULT_SWEEP_START_RATE, ( SWEEP_RATE_STEP - 1.0 ) * 100.0,
+      DEFAULT_GPS_BAUD_RATE, DEFAULT_MIN_DISTANCE_TRIGGER_INTERVAL, DEFAULT_SCHEDULED_TRIGGERS );
+}
+
+bool readFireTimes( const char* pszPath, std::vector<double>& fireTimes )
+{
+   FILE* pFile = fopen( pszPath, "r" );
+   if ( pFile == NULL )
+   {
+      printf( "Could not open %s.\n", pszPath );
+      return false;
+   }
+
+   double dSeconds = 0.0;
+   while ( fscanf( pFile, "%lf", &dSeconds ) == 1 )
+   {
+      if ( dSeconds < 0.0 || ( !fireTimes.empty() && dSeconds < fireTimes.back() ) )
+      {
+         printf( "The times in %s must be positive and in order.\n", pszPath );
+         fclose( pFile );
+         return false;
+      }
+      fireTimes.push_back( dSeconds );
+   }
+
+   const bool bIsComplete = feof( pFile ) != 0;
+   fclose( pFile );
+   if ( !bIsComplete || fireTimes.empty() )
+   {
+      printf( "%s must contain times in seconds, separated by white space.\n", pszPath );
+      return false;
+   }
+
+   return true;
+}
+
+// Distance in meters between two positions, with the haversine formula
+double getDistanceMeters( double dLat1, double dLon1, double dLat2, double dLon2 )
+{
+   const double R = 6371000.0;
+   const double PI = 3.14159265358979323846;
+   double dLat = ( dLat2 - dLat1 ) * ( PI / 180.0 );
+   double dLon = ( dLon2 - dLon1 ) * ( PI / 180.0 );
+   double a = sin( dLat / 2 ) * sin( dLat / 2 ) +
+      cos( dLat1 * ( PI / 180.0 ) ) * cos( dLat2 * ( PI / 180.0 ) ) *
+      sin( dLon / 2 ) * sin( dLon / 2 );
+   return R * 2 * atan2( sqrt( a ), sqrt( 1 - a ) );
+}
+
+//
+// Polls the GPS and requests a trigger each time the position has moved the
+// given distance from the last trigger. The receiver only reports a position
+// every GPS_UPDATE_INTERVAL_MS, so when the distance will be reached before
+// the next fix, the trigger is requested for the time it is reached at the
+// current speed rather than at the next fix.
+//
+void pollGps( LadybugGPSContext gpsContext, TriggerScheduler* pScheduler, double dDistanceMeters,
+   const std::atomic<bool>* pbStop )
+{
+   bool bHasFix = false;
+   bool bHasTrigger = false;
+   LadybugNMEAGPGGA lastFix = LadybugNMEAGPGGA();
+   long long lastFixNs = 0;
+   double dTriggerLat = 0.0, dTriggerLon = 0.0;
+
+   while ( !*pbStop && pScheduler->isRunning() )
+   {
+      LadybugNMEAGPGGA gga;
+      if ( ladybugGetGPSNMEAData( gpsContext, "GPGGA", &gga ) != LADYBUG_OK || !gga.bValidData ||
+         ( bHasFix && gga.ucGGASecond == lastFix.ucGGASecond && gga.wGGASubSecond == lastFix.wGGASubSecond ) )
+      {
+         std::this_thread::sleep_for( std::chrono::milliseconds( GPS_POLL_INTERVAL_MS ) );
+         continue;
+      }
+
+      const long long nowNs = TriggerScheduler::getTimeNs();
+      if ( !bHasTrigger )
+      {
+         pScheduler->requestTrigger();
+         dTriggerLat = gga.dGGALatitude;
+         dTriggerLon = gga.dGGALongitude;
+         bHasTrigger = true;
+      }
+      else
+      {
+         const double dMoved = getDistanceMeters( dTriggerLat, dTriggerLon, gga.dGGALatitude, gga.dGGALongitude );
+         const double dStep = bHasFix ? 
+            getDistanceMeters( lastFix.dGGALatitude, lastFix.dGGALongitude, gga.dGGALatitude, gga.dGGALongitude ) : 0.0;
+         const double dSpeed = bHasFix ? dStep * 1e9 / (double)( nowNs - lastFixNs ) : 0.0;
+
+         if ( dMoved >= dDistanceMeters )
+         {
+            pScheduler->requestTrigger();
+            dTriggerLat = gga.dGGALatitude;
+            dTriggerLon = gga.dGGALongitude;
+         }
+         else if ( dSpeed > 0.0 && dMoved + dSpeed * GPS_UPDATE_INTERVAL_MS / 1000.0 >= dDistanceMeters )
+         {
+            // Fire when the rest of the distance is covered, and measure the
+            // next trigger from where the vehicle will be by then
+            const double dSeconds = ( dDistanceMeters - dMoved ) / dSpeed;
+            pScheduler->requestTrigger( nowNs + (long long)( dSeconds * 1e9 ) );
+
+            const double dFraction = dSpeed * dSeconds / dStep;
+            dTriggerLat = gga.dGGALatitude + ( gga.dGGALatitude - lastFix.dGGALatitude ) * dFraction;
+            dTriggerLon = gga.dGGALongitude + ( gga.dGGALongitude - lastFix.dGGALongitude ) * dFraction;
+         }
+      }
+
+      lastFix = gga;
+      lastFixNs = nowNs;
+      bHasFix = true;
+   }
+}
+
+//
+// Match a frame to one of the pending triggers. Frames are taken in trigger
+// order, but a trigger may not produce a frame. The pending trigger whose
+// interval from the last matched trigger best agrees with the interval of
+// the frame timestamps is taken, and the triggers before it count as lost.
+//
+bool matchFrame( std::deque<TriggerScheduler::Fire>& pending, const std::vector<TriggeredFrame>& frames,
+   double dTimestampSeconds, TriggerScheduler::Fire& fire, unsigned int& uiLost )
+{
+   if ( pending.empty() )
+   {
+      return false;
+   }
+
+   size_t best = 0;
+   if ( !frames.empty() )
+   {
+      const double dFrameInterval = dTimestampSeconds - frames.back().dTimestampSeconds;
+      double dBestError = 0.0;
+      for ( size_t i = 0; i < pending.size() && i < MATCH_WINDOW; i++ )
+      {
+         const double dFireInterval = ( pending[i].firedNs - frames.back().fireNs ) / 1e9;
+         const double dError = fabs( dFrameInterval - dFireInterval );
+         if ( i == 0 || dError < dBestError )
+         {
+            best = i;
+            dBestError = dError;
+         }
+      }
+   }
+
+   fire = pending[best];
+   uiLost += (unsigned int)best;
+   pending.erase( pending.begin(), pending.begin() + best + 1 );
+   return true;
+}
+
+//
+// The camera timestamps and the host clock run at slightly different rates
+// from an unknown offset. A line fitted through (trigger time, timestamp -
+// trigger time) removes both, and what is left is how the latency from 
+// trigger to exposure varies, shifted so that the shortest is zero.
+//
+void addTimestampLatencies( const std::vector<TriggeredFrame>& frames, LatencyHistogram& histogram )
+{
+   if ( frames.size() < 2 )
+   {
+      return;
+   }
+
+   const double dFirstFire = frames[0].fireNs / 1e9;
+   double dSumX = 0.0, dSumY = 0.0, dSumXX = 0.0, dSumXY = 0.0;
+   for ( size_t i = 0; i < frames.size(); i++ )
+   {
+      const double x = frames[i].fireNs / 1e9 - dFirstFire;
+      const double y = frames[i].dTimestampSeconds - x;
+      dSumX += x;
+      dSumY += y;
+      dSumXX += x * x;
+      dSumXY += x * y;
+   }
+
+   const double n = (double)frames.size();
+   const double dDenominator = n * dSumXX - dSumX * dSumX;
+   const double dSlope = dDenominator > 0.0 ? ( n * dSumXY - dSumX * dSumY ) / dDenominator : 0.0;
+   const double dOffset = ( dSumY - dSlope * dSumX ) / n;
+
+   std::vector<double> residuals( frames.size() );
+   double dMin = 0.0;
+   for ( size_t i = 0; i < frames.size(); i++ )
+   {
+      const double x = frames[i].fireNs / 1e9 - dFirstFire;
+      residuals[i] = frames[i].dTimestampSeconds - x - ( dOffset + dSlope * x );
+      dMin = i == 0 ? residuals[i] : std::min( dMin, residuals[i] );
+   }
+
+   for ( size_t i = 0; i < residuals.size(); i++ )
+   {
+      histogram.add( ( residuals[i] - dMin ) * 1e6 );
+   }
+}
+
+//
+// Run one schedule: fire from the scheduler thread and grab on this one
+// until the schedule has ended and no more frames arrive.
+//
+LadybugError runSchedule( LadybugContext context, LadybugGPSContext gpsContext, const ScheduleOptions& options,
+   const TriggerScheduler::Settings& settings, ScheduleResult& result )
+{
+   // Frames already queued, e.g. from a trigger of an earlier run, would be
+   // taken for the frames of the first triggers
+   LadybugImage image;
+   while ( ladybugGrabImage( context, &image ) == LADYBUG_OK )
+   {
+   }
+
+   TriggerScheduler scheduler;
+   std::string errorMessage;
+   if ( !scheduler.start( settings, [context]() { return fireSoftwareTrigger( context ); }, errorMessage ) )
+   {
+      printf( "%s\n", errorMessage.c_str() );
+      return LADYBUG_INVALID_ARGUMENT;
+   }
+
+   if ( !scheduler.getSchedulingWarning().empty() )
+   {
+      printf( "%s", scheduler.getSchedulingWarning().c_str() );
+   }
+
+   for ( size_t i = 0; i < options.fireTimes.size(); i++ )
+   {
+      scheduler.requestTrigger( scheduler.getStartNs() + (long long)( options.fireTimes[i] * 1e9 ) );
+   }
+
+   std::atomic<bool> bStopGps( false );
+   std::thread gpsThread;
+   if ( options.dDistanceMeters > 0.0 )
+   {
+      gpsThread = std::thread( pollGps, gpsContext, &scheduler, options.dDistanceMeters, &bStopGps );
+   }
+
+   CameraClock cameraClock;
+   std::deque<TriggerScheduler::Fire> pending;
+   std::vector<TriggeredFrame> frames;
+   LadybugError error = LADYBUG_OK;
+
+   for ( ;; )
+   {
+      // Stop on the first timeout that began after the last trigger, so 
+      // that the last frame has a full timeout to arrive
+      const bool bWasRunning = scheduler.isRunning();
+      error = ladybugGrabImage( context, &image );
+      const long long arrivalNs = TriggerScheduler::getTimeNs();
+
+      TriggerScheduler::Fire fire;
+      while ( scheduler.popFire( fire ) )
+      {
+         pending.push_back( fire );
+      }
+
+      if ( error == LADYBUG_TIMEOUT )
+      {
+         error = LADYBUG_OK;
+         if ( !bWasRunning )
+         {
+            break;
+         }
+         continue;
+      }
+      else if ( error != LADYBUG_OK )
+      {
+         break;
+      }
+
+      result.uiFrames++;
+
+      const double dTimestampSeconds = CameraClock::toSeconds( cameraClock.addImage( image ) );
+      if ( !matchFrame( pending, frames, dTimestampSeconds, fire, result.uiLost ) )
+      {
+         result.uiUnexpected++;
+         continue;
+      }
+
+      TriggeredFrame frame;
+      frame.fireNs = fire.firedNs;
+      frame.arrivalNs = arrivalNs;
+      frame.dTimestampSeconds = dTimestampSeconds;
+      frames.push_back( frame );
+   }
+
+   bStopGps = true;
+   if ( gpsThread.joinable() )
+   {
+      gpsThread.join();
+   }
+   scheduler.stop();
+
+   result.uiFired = scheduler.getNumFired();
+   result.uiSkipped = scheduler.getNumSkipped();
+   result.uiLost += (unsigned int)pending.size();
+   result.bFailed = scheduler.hasFailed();
+   result.lateness = scheduler.getLateness();
+   result.fireDuration = scheduler.getFireDuration();
+
+   for ( size_t i = 0; i < frames.size(); i++ )
+   {
+      result.arrival.add( ( frames[i].arrivalNs - frames[i].fireNs ) / 1000.0 );
+   }
+   addTimestampLatencies( frames, result.timestamp );
+
+   const size_t quarter = frames.size() / 4;
+   if ( quarter > 0 )
+   {
+      double dFirst = 0.0, dLast = 0.0;
+      for ( size_t i = 0; i < quarter; i++ )
+      {
+         dFirst += frames[i].arrivalNs - frames[i].fireNs;
+         dLast += frames[frames.size() - 1 - i].arrivalNs - frames[frames.size() - 1 - i].fireNs;
+      }
+      result.dArrivalGrowthUs = ( dLast - dFirst ) / quarter / 1000.0;
+   }
+
+   return error;
+}
+
+void displayScheduleResult( const ScheduleResult& result )
+{
+   printf( "Fired %u triggers (%u deadlines skipped), grabbed %u frames, %u triggers lost, %u frames without a trigger.\n",
+      result.uiFired, result.uiSkipped, result.uiFrames, result.uiLost, result.uiUnexpected );
+   if ( result.bFailed )
+   {
+      printf( "Firing the software trigger failed.\n" );
+   }
+   printf( "Frame arrival latency grew by %.1f us from the first to the last quarter of the run.\n", result.dArrivalGrowthUs );
+
+   result.lateness.print( stdout, "Trigger lateness (deadline to trigger)" );
+   result.fireDuration.print( stdout, "Trigger register write" );
+   result.arrival.print( stdout, "Trigger to frame grabbed" );
+   result.timestamp.print( stdout, "Trigger to frame timestamp, relative" );
+}
+
+// The camera keeps up if every trigger made a frame, the scheduler met every
+// deadline and frames did not queue up in the driver
+bool isSustained( const ScheduleResult& result, double dRateHz )
+{
+   return !result.bFailed && result.uiLost == 0 && result.uiSkipped == 0 && result.dArrivalGrowthUs < 0.5e6 / dRateHz;
+}
+
+LadybugError runSweep( LadybugContext context, const ScheduleOptions& options )
+{
+   TriggerScheduler::Settings settings = options.settings;
+   ScheduleResult best;
+   double dBestRate = 0.0;
+
+   printf( "%10s %8s %8s %8s %12s %12s %12s\n", "rate (Hz)", "fired", "frames", "lost", "grab p99", "jitter p99", "growth" );
+   for ( int i = 0; i < SWEEP_MAX_STEPS; i++ )
+   {
+      ScheduleResult result;
+      LadybugError error = runSchedule( context, NULL, options, settings, result );
+      if ( error != LADYBUG_OK )
+      {
+         return error;
+      }
+
+      printf( "%10.2f %8u %8u %8u %9.0f us %9.1f us %9.0f us\n", settings.rateHz, result.uiFired, result.uiFrames, 
+         result.uiLost, result.arrival.getPercentile( 0.99 ), result.timestamp.getPercentile( 0.99 ), result.dArrivalGrowthUs );
+      if ( !isSustained( result, settings.rateHz ) )
+      {
+         break;
+      }
+
+      best = result;
+      dBestRate = settings.rateHz;
+      settings.rateHz *= SWEEP_RATE_STEP;
+   }
+
+   if ( dBestRate == 0.0 )
+   {
+      printf( "The camera did not keep up with %.2f Hz; start the sweep lower with -r.\n", options.settings.rateHz );
+      return LADYBUG_OK;
+   }
+
+   printf( "Highest sustained trigger rate: %.2f Hz\n", dBestRate );
+   displayScheduleResult( best );
+   return LADYBUG_OK;
+}
+
+LadybugError startGps( LadybugContext context, const ScheduleOptions& options, LadybugGPSContext& gpsContext )
+{
+   LadybugError error = ladybugCreateGPSContext( &gpsContext );
+   if ( error != LADYBUG_OK )
+   {
+      return error;
+   }
+
+   error = ladybugRegisterGPS( context, &gpsContext );
+   if ( error != LADYBUG_OK )
+   {
+      return error;
+   }
+
+   printf( "Initializing GPS %s at %u baud...\n", options.gpsDevice.c_str(), options.uiGpsBaudRate );
+#ifdef _WIN32
+   error = ladybugInitializeGPS( gpsContext, atoi( options.gpsDevice.c_str() ), options.uiGpsBaudRate, GPS_UPDATE_INTERVAL_MS );
+#else
+   error = ladybugInitializeGPSEx( gpsContext, options.gpsDevice.c_str(), options.uiGpsBaudRate, GPS_UPDATE_INTERVAL_MS );
+#endif
+   if ( error != LADYBUG_OK )
+   {
+      return error;
+   }
+
+   return ladybugStartGPS( gpsContext );
+}
+
+bool parseOptions( int argc, char* argv[], ScheduleOptions& options )
+{
+   options.bSweep = false;
+   options.settings = TriggerScheduler::getDefaultSettings();
+   options.settings.rateHz = DEFAULT_SWEEP_START_RATE;
+   options.settings.maxTriggers = DEFAULT_SCHEDULED_TRIGGERS;
+   options.dDistanceMeters = 0.0;
+   options.uiGpsBaudRate = DEFAULT_GPS_BAUD_RATE;
+
+   bool bBadArgs = false;
+   bool bHasMinInterval = false;
+   int iSchedules = 0;
+   char* pszCurrParam = NULL;
+   char pszValidOpts[] = "r:b:T:D:sG:i:n:p:c:w:?";
+   int iOpt = 0;
+   while ( ( iOpt = GetOption( argc, argv, pszValidOpts, &pszCurrParam ) ) != 0 )
+   {
+      switch ( iOpt )
+      {
+      case 'r':
+         options.settings.schedule = TriggerScheduler::SCHEDULE_FIXED_RATE;
+         options.settings.rateHz = atof( pszCurrParam );
+         bBadArgs |= !( options.settings.rateHz > 0.0 );
+         iSchedules++;
+         break;
+      case 'b':
+         options.settings.schedule = TriggerScheduler::SCHEDULE_BURST;
+         bBadArgs |= sscanf( pszCurrParam, "%ux%lf/%lf", &options.settings.burstCount, 
+            &options.settings.rateHz, &options.settings.burstPeriodSeconds ) != 3;
+         iSchedules++;
+         break;
+      case 'T':
+         options.settings.schedule = TriggerScheduler::SCHEDULE_EXTERNAL;
+         bBadArgs |= !readFireTimes( pszCurrParam, options.fireTimes );
+         iSchedules++;
+         break;
+      case 'D':
+         options.settings.schedule = TriggerScheduler::SCHEDULE_EXTERNAL;
+         options.dDistanceMeters = atof( pszCurrParam );
+         bBadArgs |= !( options.dDistanceMeters > 0.0 );
+         iSchedules++;
+         break;
+      case 's':
+         options.bSweep = true;
+         break;
+      case 'G':
+         {
+            options.gpsDevice = pszCurrParam;
+            const size_t colon = options.gpsDevice.rfind( ':' );
+            if ( colon != std::string::npos )
+            {
+               options.uiGpsBaudRate = (unsigned int)atoi( options.gpsDevice.c_str() + colon + 1 );
+               options.gpsDevice.erase( colon );
+               bBadArgs |= options.uiGpsBaudRate == 0;
+            }
+         }
+         break;
+      case 'i':
+         options.settings.minIntervalSeconds = atof( pszCurrParam );
+         bBadArgs |= options.settings.minIntervalSeconds < 0.0;
+         bHasMinInterval = true;
+         break;
+      case 'n':
+         bBadArgs |= sscanf( pszCurrParam, "%u", &options.settings.maxTriggers ) != 1 || 
+            options.settings.maxTriggers == 0;
+         break;
+      case 'p':
+         bBadArgs |= sscanf( pszCurrParam, "%d", &options.settings.realtimePriority ) != 1 ||
+            options.settings.realtimePriority < 1 || options.settings.realtimePriority > 99;
+         break;
+      case 'c':
+         bBadArgs |= sscanf( pszCurrParam, "%d", &options.settings.cpu ) != 1 || options.settings.cpu < 0;
+         break;
+      case 'w':
+         bBadArgs |= sscanf( pszCurrParam, "%u", &options.settings.spinMicroseconds ) != 1;
+         break;
+      default:
+         bBadArgs = true;
+         break;
+      }
+   }
+
+   if ( !options.fireTimes.empty() )
+   {
+      options.settings.maxTriggers = (unsigned int)options.fireTimes.size();
+   }
+   if ( options.dDistanceMeters > 0.0 && !bHasMinInterval )
+   {
+      options.settings.minIntervalSeconds = DEFAULT_MIN_DISTANCE_TRIGGER_INTERVAL;
+   }
+
+   options.bScheduled = iSchedules > 0 || options.bSweep;
+   return !bBadArgs && iSchedules <= 1 &&
+      ( options.dDistanceMeters > 0.0 ) == !options.gpsDevice.empty() &&
+      ( !options.bSweep || options.settings.schedule == TriggerScheduler::SCHEDULE_FIXED_RATE );
+}
+
 //
 // The Main
 //
-int main(int /*argc*/, char* /*argv[]*/)
+int main(int argc, char* argv[])
 {
    LadybugContext context;
    LadybugError error;
    LadybugImage image;
+   LadybugGPSContext gpsContext = NULL;
    int i;
 
+   ScheduleOptions options;
+   if ( !parseOptions( argc, argv, options ) )
+   {
+      displayUsage( argv[0] );
+      return 1;
+   }
+
    try{
       error = ladybugCreateContext( &context);
       HANDLE_ERROR;
 
+      if ( options.dDistanceMeters > 0.0 )
+      {
+         error = startGps( context, options, gpsContext );
+         HANDLE_ERROR;
+      }
+
       error = ladybugInitializeFromIndex( context, 0);
       HANDLE_ERROR;
 
@@ -228,30 +873,47 @@ int main(int /*argc*/, char* /*argv[]*/)
 
       // Since Ladybug SDK version 1.6.0.1, This function needs to be called prior 
       // to the camera starting functions.
-      error = ladybugSetGrabTimeout( context, LADYBUG_INFINITE);
+      error = ladybugSetGrabTimeout( context, options.bScheduled ? SCHEDULED_GRAB_TIMEOUT_MS : LADYBUG_INFINITE);
       HANDLE_ERROR;
 
       // Start streaming
       error = ladybugStart( context, LADYBUG_DATAFORMAT_ANY);
       HANDLE_ERROR;
 
-      printf ("Grab loop...\n");
-      for ( i = 0; i < IMAGES_TO_CAPTURE; i++)
+      if ( options.bSweep )
+      {
+         error = runSweep( context, options );
+         HANDLE_ERROR;
+      }
+      else if ( options.bScheduled )
+      {
+         printf( "Firing the scheduled triggers...\n" );
+         ScheduleResult result;
+         error = runSchedule( context, gpsContext, options, options.settings, result );
+         HANDLE_ERROR;
+
+         displayScheduleResult( result );
+      }
+      else
       {
-         printf ("Waiting for a trigger...\n");
+         printf ("Grab loop...\n");
+         for ( i = 0; i < IMAGES_TO_CAPTURE; i++)
+         {
+            printf ("Waiting for a trigger...\n");
 
 #ifdef USE_SOFTWARE_TRIGGER
-         printf( "Firing software trigger.(%d)\n", i);
-         if ( !fireSoftwareTrigger( context)){
-            printf( "Error in firing software trigger.\n");
-            break;
-         }
+            printf( "Firing software trigger.(%d)\n", i);
+            if ( !fireSoftwareTrigger( context)){
+               printf( "Error in firing software trigger.\n");
+               break;
+            }
 #endif
-         error = ladybugGrabImage( context, &image);
-         HANDLE_ERROR;
-         printf( "Image grabbed.\n");
+            error = ladybugGrabImage( context, &image);
+            HANDLE_ERROR;
+            printf( "Image grabbed.\n");
 
-         saveImage( context, &image, i);
+            saveImage( context, &image, i);
+         }
       }
 
       error = ladybugStop( context);
@@ -268,6 +930,13 @@ int main(int /*argc*/, char* /*argv[]*/)
       printf( "Ladybug SDK reported an error : %s\n", ladybugErrorToString( e));
    }
 
+   if ( gpsContext != NULL )
+   {
+      ladybugStopGPS( gpsContext );
+      ladybugUnregisterGPS( context, &gpsContext );
+      ladybugDestroyGPSContext( &gpsContext );
+   }
+
    error = ladybugDestroyContext( &context);
 
    //